@@ -70,6 +70,7 @@ public class MassTraffic : ModuleRules
 				// Misc
 				"CoreUObject",
 				"GameplayTasks",
+				"Json",
 				"PointCloud",
 				"RHI",
 				"RenderCore",
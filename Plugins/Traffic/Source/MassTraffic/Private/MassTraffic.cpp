@@ -345,6 +345,104 @@ FAutoConsoleVariableRef CVarMassTrafficSpeedLimitScale(
 	ECVF_Cheat
 	);
 
+int32 GMassTrafficReplay = 0;
+FAutoConsoleVariableRef CVarMassTrafficReplay(
+	TEXT("MassTraffic.Replay"),
+	GMassTrafficReplay,
+	TEXT("Records or plays back traffic vehicle state to / from UMassTrafficSettings::ReplayFilename.\n")
+	TEXT("0 = Off (default.)\n")
+	TEXT("1 = Record - Append each simulated frame to the replay file\n")
+	TEXT("2 = Playback - Suspend traffic simulation and drive vehicle transforms from the replay file"),
+	ECVF_Cheat
+	);
+
+int32 GMassTrafficParallelValidation = 1;
+FAutoConsoleVariableRef CVarMassTrafficParallelValidation(
+	TEXT("MassTraffic.ParallelValidation"),
+	GMassTrafficParallelValidation,
+	TEXT("Run the validation processor's lane & vehicle checks in parallel, across lanes & chunks.\n")
+	TEXT("0 = Off, run all checks on the game thread\n")
+	TEXT("1 = On (default.)"),
+	ECVF_Cheat
+	);
+
+int32 GMassTrafficValidationSampleInterval = 1;
+FAutoConsoleVariableRef CVarMassTrafficValidationSampleInterval(
+	TEXT("MassTraffic.ValidationSampleInterval"),
+	GMassTrafficValidationSampleInterval,
+	TEXT("Only validate 1 in every N lanes & vehicles each frame, rotating through them so every lane is still validated\n")
+	TEXT("once every N frames, and every vehicle once every N times its chunk ticks. Keeps MassTraffic.Validation cheap\n")
+	TEXT("enough to leave on for long runs.\n")
+	TEXT("1 = Validate all lanes & vehicles every frame (default.)"),
+	ECVF_Cheat
+	);
+
+int32 GMassTrafficParallelVehicleBehavior = 1;
+FAutoConsoleVariableRef CVarMassTrafficParallelVehicleBehavior(
+	TEXT("MassTraffic.ParallelVehicleBehavior"),
+	GMassTrafficParallelVehicleBehavior,
+	TEXT("Process vehicle control, choose next lane & lane change update chunks in parallel. Shared lane state is\n")
+	TEXT("changed through FMassTrafficLaneReservations either way, so both give bit-identical results.\n")
+	TEXT("0 = Off, process chunks on the game thread\n")
+	TEXT("1 = On (default.)"),
+	ECVF_Cheat
+	);
+
+int32 GMassTrafficStaticInstances = 1;
+FAutoConsoleVariableRef CVarMassTrafficStaticInstances(
+	TEXT("MassTraffic.StaticInstances"),
+	GMassTrafficStaticInstances,
+	TEXT("Keep persistent ISM instances for parked vehicles & traffic lights, only changing them when their LOD or state\n")
+	TEXT("changes, instead of resubmitting them through the Mass ISM batches every frame. Traffic vehicles, trailers &\n")
+	TEXT("drivers are still added every frame, but to ISM components bucketed into the same cells, only updating cells\n")
+	TEXT("whose instances changed.\n")
+	TEXT("0 = Off, resubmit everything through the Mass ISM batches every frame\n")
+	TEXT("1 = On (default.)"),
+	ECVF_Cheat
+	);
+
+int32 GMassTrafficScheduleIntersections = 1;
+FAutoConsoleVariableRef CVarMassTrafficScheduleIntersections(
+	TEXT("MassTraffic.ScheduleIntersections"),
+	GMassTrafficScheduleIntersections,
+	TEXT("Skip traffic light intersections that can't change state until their next period deadline, only counting down\n")
+	TEXT("their period timer instead of visiting & querying the lanes of every intersection every frame.\n")
+	TEXT("0 = Off, fully update every intersection every frame\n")
+	TEXT("1 = On (default.)"),
+	ECVF_Cheat
+	);
+
+int32 GMassTrafficParallelFieldOperations = 1;
+FAutoConsoleVariableRef CVarMassTrafficParallelFieldOperations(
+	TEXT("MassTraffic.ParallelFieldOperations"),
+	GMassTrafficParallelFieldOperations,
+	TEXT("Perform traffic field operations that support it in parallel, across fields that don't overlap the same lanes\n")
+	TEXT("or intersections.\n")
+	TEXT("0 = Off, perform all field operations serially\n")
+	TEXT("1 = On (default.)"),
+	ECVF_Cheat
+	);
+
+float GMassTrafficPostPhysicsLaneSearchDistance = 500.0f;
+FAutoConsoleVariableRef CVarMassTrafficPostPhysicsLaneSearchDistance(
+	TEXT("MassTraffic.PostPhysicsLaneSearchDistance"),
+	GMassTrafficPostPhysicsLaneSearchDistance,
+	TEXT("Distance, on top of the distance travelled this frame, either side of physics vehicles' previous distance along\n")
+	TEXT("their lane to search for their new distance along the lane, before searching the whole lane.\n")
+	TEXT("<= 0 = Always search the whole lane"),
+	ECVF_Cheat
+	);
+
+float GMassTrafficStaticInstanceCellSize = 20000.0f;
+FAutoConsoleVariableRef CVarMassTrafficStaticInstanceCellSize(
+	TEXT("MassTraffic.StaticInstanceCellSize"),
+	GMassTrafficStaticInstanceCellSize,
+	TEXT("Size of the square grid cells static & moving instances (see MassTraffic.StaticInstances) are bucketed into,\n")
+	TEXT("each with ISM components of its own, so they're culled per cell & only cells with changed instances are updated.\n")
+	TEXT("<= 0 = A single cell for the whole world"),
+	ECVF_Cheat
+	);
+
 
 void FMassTrafficModule::StartupModule()
 {
@@ -0,0 +1,77 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "MassTrafficActorUpdateBatch.h"
+#include "MassTraffic.h"
+#include "MassTrafficFragments.h"
+#include "MassTrafficPhysics.h"
+#include "MassTrafficVehicleComponent.h"
+
+#include "MassCommandBuffer.h"
+#include "MassEntityManager.h"
+
+
+DECLARE_CYCLE_STAT(TEXT("Apply Actor Updates"), STAT_Traffic_ApplyActorUpdates, STATGROUP_Traffic);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Actor Transform Updates"), STAT_Traffic_ActorTransformUpdates, STATGROUP_Traffic);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Actor Wheel Updates"), STAT_Traffic_ActorWheelUpdates, STATGROUP_Traffic);
+
+
+void FMassTrafficActorUpdateBatch::Apply(const FMassEntityManager& EntityManager) const
+{
+	SCOPE_CYCLE_COUNTER(STAT_Traffic_ApplyActorUpdates);
+	INC_DWORD_STAT_BY(STAT_Traffic_ActorTransformUpdates, ActorTransforms.Num());
+	INC_DWORD_STAT_BY(STAT_Traffic_ActorWheelUpdates, WheelUpdates.Num());
+
+	// Teleport actors to simulated positions
+	for (const TPair<AActor*, FTransform>& ActorTransform : ActorTransforms)
+	{
+		ActorTransform.Key->SetActorTransform(ActorTransform.Value);
+	}
+
+	// Update wheel component transforms from simple vehicle physics sim
+	for (const TPair<UMassTrafficVehicleComponent*, FMassEntityHandle>& WheelUpdate : WheelUpdates)
+	{
+		if (!EntityManager.IsEntityValid(WheelUpdate.Value))
+		{
+			continue;
+		}
+
+		// If the simulation LOD changed this frame, removal of the FMassTrafficVehiclePhysicsFragment would have been
+		// queued and executed before this deferred command, thus actually removing the fragment we thought we had when
+		// the update was added. So we safely check again here.
+		const FMassTrafficVehiclePhysicsFragment* SimpleVehiclePhysicsFragment = EntityManager.GetFragmentDataPtr<FMassTrafficVehiclePhysicsFragment>(WheelUpdate.Value);
+		if (SimpleVehiclePhysicsFragment)
+		{
+			UMassTrafficVehicleComponent* MassTrafficVehicleComponent = WheelUpdate.Key;
+
+			// Init offsets?
+			if (MassTrafficVehicleComponent->WheelOffsets.IsEmpty())
+			{
+				MassTrafficVehicleComponent->InitWheelAttachmentOffsets(SimpleVehiclePhysicsFragment->VehicleSim);
+			}
+
+			// Update
+			MassTrafficVehicleComponent->UpdateWheelComponents(SimpleVehiclePhysicsFragment->VehicleSim);
+		}
+	}
+}
+
+void FMassTrafficActorUpdateBatch::Defer(FMassCommandBuffer& CommandBuffer)
+{
+	if (IsEmpty())
+	{
+		return;
+	}
+
+	CommandBuffer.PushCommand<FMassDeferredSetCommand>([Batch = MoveTemp(*this)](FMassEntityManager& EntityManager)
+	{
+		Batch.Apply(EntityManager);
+	});
+
+	Reset();
+}
+
+void FMassTrafficActorUpdateBatch::Reset()
+{
+	ActorTransforms.Reset();
+	WheelUpdates.Reset();
+}
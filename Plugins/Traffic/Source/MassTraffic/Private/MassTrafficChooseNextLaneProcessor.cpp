@@ -59,18 +59,33 @@ void UMassTrafficChooseNextLaneProcessor::ConfigureQueries()
 
 void UMassTrafficChooseNextLaneProcessor::Execute(FMassEntityManager& EntityManager, FMassExecutionContext& Context)
 {
+	// Skip during replay playback and on frames without fixed timestep substeps
+	if (!ShouldSimulateTrafficVehicles())
+	{
+		return;
+	}
+
 	// Use the Max of the Speed & Steering look ahead times & distances as our distance from lane exit to choose
 	// next lane. This ensures a next lane is chosen in time for the chase targets to move along.
 	const float ChooseNextLaneTime = FMath::Max(MassTrafficSettings->SpeedControlLaneLookAheadTime, MassTrafficSettings->SteeringControlLaneLookAheadTime);
 	const float ChooseNextLaneMinDistance = FMath::Max(MassTrafficSettings->SpeedControlMinLookAheadDistance, MassTrafficSettings->SteeringControlMinLookAheadDistance);
 
-	// Advance agents
-	EntityQuery_Conditional.ForEachEntityChunk(EntityManager, Context, [&, World = EntityManager.GetWorld()](FMassExecutionContext& QueryContext)
-	{	
-		UMassTrafficSubsystem& MassTrafficSubsystem = QueryContext.GetMutableSubsystemChecked<UMassTrafficSubsystem>(World);
+	UMassTrafficSubsystem& MassTrafficSubsystem = Context.GetMutableSubsystemChecked<UMassTrafficSubsystem>(EntityManager.GetWorld());
 #if WITH_MASSTRAFFIC_DEBUG
-		const UZoneGraphSubsystem& ZoneGraphSubsystem = QueryContext.GetSubsystemChecked<UZoneGraphSubsystem>(World);
+	const UZoneGraphSubsystem& ZoneGraphSubsystem = Context.GetSubsystemChecked<UZoneGraphSubsystem>(EntityManager.GetWorld());
 #endif // WITH_MASSTRAFFIC_DEBUG
+
+	// Vehicles draw from their own random streams, so their choices don't depend on the order chunks are processed in
+	const uint32 FrameSeed = RandomStream.GetUnsignedInt();
+
+	// Advance agents.
+	// Lane counters & densities are only read here, with changes to them recorded into LaneReservations and applied
+	// once every chunk has been processed. So vehicles choose from the same lane state, in parallel or not.
+	// (See FMassTrafficLaneReservations.)
+	auto ChooseNextLaneChunk = [&](FMassExecutionContext& QueryContext)
+	{	
+		FMassTrafficLaneReservationBuffer& Reservations = LaneReservations.AddBuffer();
+
 		const int32 NumEntities = QueryContext.GetNumEntities();
 		const TConstArrayView<FMassZoneGraphLaneLocationFragment> LaneLocationFragments = QueryContext.GetFragmentView<FMassZoneGraphLaneLocationFragment>();
 		const TConstArrayView<FAgentRadiusFragment> AgentRadiusFragments = QueryContext.GetFragmentView<FAgentRadiusFragment>();
@@ -94,6 +109,7 @@ void UMassTrafficChooseNextLaneProcessor::Execute(FMassEntityManager& EntityMana
 			FMassTrafficVehicleControlFragment& VehicleControlFragment = VehicleControlFragments[Index];
 			FMassTrafficVehicleLightsFragment& VehicleLightsFragment = VehicleLightsFragments[Index];
 			FMassTrafficNextVehicleFragment& NextVehicleFragment = NextVehicleFragments[Index];
+			const FMassEntityHandle VehicleEntity = QueryContext.GetEntity(Index);
 	
 		
 			// If the vehicle can't stop, it's already reserved itself on its next lane. If we choose a different lane
@@ -133,8 +149,7 @@ void UMassTrafficChooseNextLaneProcessor::Execute(FMassEntityManager& EntityMana
 			#if ENABLE_DRAW_DEBUG && WITH_MASSTRAFFIC_DEBUG
 			if (GMassTrafficDebugChooseNextLane)
 			{
-				const FMassEntityHandle Entity = Context.GetEntity(Index);
-				const FTransformFragment& TransformFragment = EntityManager.GetFragmentDataChecked<FTransformFragment>(Entity);
+				const FTransformFragment& TransformFragment = EntityManager.GetFragmentDataChecked<FTransformFragment>(VehicleEntity);
 				const FVector Location = TransformFragment.GetTransform().GetLocation();
 										
 				if (VehicleControlFragment.NextLane)
@@ -220,7 +235,7 @@ void UMassTrafficChooseNextLaneProcessor::Execute(FMassEntityManager& EntityMana
 			// will never happen if the lane is holding on to a high value so no cars end up attracted to that lane and end up
 			// going down it in the first place.
 			const EDensityToUseForChoosingLane DensityToUseForChoosingLane =
-				RandomStream.FRand() < MassTrafficSettings->DownstreamFlowDensityQueryFraction ?
+				UE::MassTraffic::MakeEntityRandomStream(FrameSeed, VehicleEntity).FRand() < MassTrafficSettings->DownstreamFlowDensityQueryFraction ?
 				ChooseLaneByFunctionalDensity /*rare*/ : 
 				ChooseLaneByDownstreamFlowDensity /*common*/;
 
@@ -229,7 +244,7 @@ void UMassTrafficChooseNextLaneProcessor::Execute(FMassEntityManager& EntityMana
 			// back further on.
 			if (VehicleControlFragment.NextLane)
 			{
-				--VehicleControlFragment.NextLane->NumVehiclesApproachingLane;
+				Reservations.Add(VehicleEntity, EMassTrafficLaneReservationType::LeaveApproachingLane, VehicleControlFragment.NextLane);
 			}
 
 			// Dead end check
@@ -258,19 +273,19 @@ void UMassTrafficChooseNextLaneProcessor::Execute(FMassEntityManager& EntityMana
 				VehicleControlFragment.NextLane = CurrentLane.NextLanes[0];
 				VehicleControlFragment.ChooseNextLanePreference = EMassTrafficChooseNextLanePreference::KeepCurrentNextLane;
 			
-				++VehicleControlFragment.NextLane->NumVehiclesApproachingLane;
+				Reservations.Add(VehicleEntity, EMassTrafficLaneReservationType::ApproachLane, VehicleControlFragment.NextLane);
 
 				VehicleLightsFragment.bLeftTurnSignalLights = VehicleControlFragment.NextLane->bTurnsLeft;
 				VehicleLightsFragment.bRightTurnSignalLights = VehicleControlFragment.NextLane->bTurnsRight;
 
 				// While we're here, update downstream traffic density.
-				CurrentLane.UpdateDownstreamFlowDensity(MassTrafficSettings->DownstreamFlowDensityMixtureFraction);
+				Reservations.Add(VehicleEntity, EMassTrafficLaneReservationType::UpdateDownstreamFlowDensity, &CurrentLane);
 
 				// Check trunk lane restrictions on next lane
 				if (!UE::MassTraffic::TrunkVehicleLaneCheck(VehicleControlFragment.NextLane, VehicleControlFragment))
 				{
 					UE_LOG(LogMassTraffic, Error, TEXT("%s - Trunk-lane-only vehicle %d, on lane %d, can only access a single non-trunk next lane %d."),
-						ANSI_TO_TCHAR(__FUNCTION__), QueryContext.GetEntity(Index).Index, CurrentLane.LaneHandle.Index, VehicleControlFragment.NextLane->LaneHandle.Index);
+						ANSI_TO_TCHAR(__FUNCTION__), VehicleEntity.Index, CurrentLane.LaneHandle.Index, VehicleControlFragment.NextLane->LaneHandle.Index);
 				}
 			
 				continue;
@@ -282,94 +297,50 @@ void UMassTrafficChooseNextLaneProcessor::Execute(FMassEntityManager& EntityMana
 				MassTrafficSettings->MinimumDistanceToNextVehicleRange);
 
 
-			FZoneGraphTrafficLaneData* BestNextTrafficLaneData = nullptr;
+			const FMassTrafficNextLaneRoute* BestNextLaneRoute = nullptr;
 			float BestNextLaneDensity = TNumericLimits<float>::Max();
 
 		
-			// This lane might be have intersection lanes as next lanes, so lets run through just those and asses the
-			// lane they are connected to.
-			for (FZoneGraphTrafficLaneData* NextLane : CurrentLane.NextLanes)
+			// Scan the current lane's precomputed routing table. Everything static about each route (trunk lane
+			// restrictions, turns, and for intersection lanes, the lane at the intersection exit we're actually
+			// interested in) is already resolved, leaving only the destination lanes' dynamic space & density to
+			// compare.
+			for (const FMassTrafficNextLaneRoute& NextLaneRoute : CurrentLane.NextLaneRoutes)
 			{
-				// Check trunk lane restrictions 
-				if (!UE::MassTraffic::TrunkVehicleLaneCheck(NextLane, VehicleControlFragment))
+				// Check trunk lane restrictions (See TrunkVehicleLaneCheck.)
+				if (VehicleControlFragment.bRestrictedToTrunkLanesOnly && !NextLaneRoute.bIsTrunkLane)
 				{
 					continue;
 				}
 
-				if (!NextLane->ConstData.bIsIntersectionLane)
+				// We want a different lane than this one.
+				if (VehicleControlFragment.ChooseNextLanePreference == EMassTrafficChooseNextLanePreference::ChooseDifferentNextLane &&
+					VehicleControlFragment.NextLane == NextLaneRoute.NextLane)
 				{
-					// This is not an intersection lane.
-				
-					// We want a different lane than this one.
-					if (VehicleControlFragment.ChooseNextLanePreference == EMassTrafficChooseNextLanePreference::ChooseDifferentNextLane &&
-						VehicleControlFragment.NextLane == NextLane)
-					{
-						continue;
-					}
-				
-					// Consider this lane if it has enough space -or- if it's too short (because if they're all too
-					// short, we still have to pick one.)
-					const bool bLaneHasEnoughSpaceForVehicle = (NextLane->SpaceAvailable >= SpaceTakenByVehicleOnLane);
-					const bool bLaneIsTooShortForVehicle = NextLane->Length < SpaceTakenByVehicleOnLane;
-					if (!bLaneHasEnoughSpaceForVehicle && !bLaneIsTooShortForVehicle)
-					{
-						continue;
-					}
-				
-					// Does this lane have more space than the others? If so, remember it.
-					const float NextLaneDensity =
-						DensityToUseForChoosingLane == ChooseLaneByDownstreamFlowDensity ?
-						NextLane->GetDownstreamFlowDensity() :
-						NextLane->FunctionalDensity();
-					if (NextLaneDensity <= BestNextLaneDensity)
-					{
-						BestNextLaneDensity = NextLaneDensity;
-						BestNextTrafficLaneData = NextLane;
-					}
+					continue;
 				}
-				else // This is an intersection lane.
-				{
-					// Intersection lanes must have exactly one next lane - at the intersection exit.
-					if (NextLane->NextLanes.Num() != 1)
-					{
-						UE_LOG(LogMassTraffic, Warning, TEXT("%s - Lane %s is an intersection lane, that should have only one next lane, but it has %d."),
-							ANSI_TO_TCHAR(__FUNCTION__), *NextLane->LaneHandle.ToString(), NextLane->NextLanes.Num());
 
-						continue;
-					}
-				
-					// So this is the lane *after* the intersection lane and are actually what we are interested in.
-					const FZoneGraphTrafficLaneData* PostIntersectionTrafficLaneData = NextLane->NextLanes[0];
+				// Consider this lane if it has enough space -or- if it's too short (because if they're all too
+				// short, we still have to pick one.)
+				const FZoneGraphTrafficLaneData& DestinationLane = *NextLaneRoute.DestinationLane;
+				const bool bLaneHasEnoughSpaceForVehicle = (DestinationLane.SpaceAvailable >= SpaceTakenByVehicleOnLane);
+				const bool bLaneIsTooShortForVehicle = NextLaneRoute.DestinationLaneLength < SpaceTakenByVehicleOnLane;
+				if (!bLaneHasEnoughSpaceForVehicle && !bLaneIsTooShortForVehicle)
+				{
+					continue;
+				}
 
-					// We want a different lane than this one.
-					if (VehicleControlFragment.ChooseNextLanePreference == EMassTrafficChooseNextLanePreference::ChooseDifferentNextLane &&
-						VehicleControlFragment.NextLane == NextLane)
-					{
-						continue;
-					}
-				
-					// Consider this lane if it has enough space -or- if it's too short (because if they're all too
-					// short, we still have to pick one.)
-					const bool bLaneHasEnoughSpaceForVehicle = (PostIntersectionTrafficLaneData->SpaceAvailable >= SpaceTakenByVehicleOnLane);
-					const bool bLaneIsTooShortForVehicle = PostIntersectionTrafficLaneData->Length < SpaceTakenByVehicleOnLane;
-					if (!bLaneHasEnoughSpaceForVehicle && !bLaneIsTooShortForVehicle)
-					{
-						continue;
-					}
-				
-					// Does this lane have more space than the others? If so, remember it.
-					const float PostIntersectionLaneDensity =	
-						DensityToUseForChoosingLane == ChooseLaneByDownstreamFlowDensity ?
-						PostIntersectionTrafficLaneData->GetDownstreamFlowDensity() :
-						PostIntersectionTrafficLaneData->FunctionalDensity();					
-					if (PostIntersectionLaneDensity <= BestNextLaneDensity)
-					{
-						// We are searching the lanes after the intersection so we know which
-						// intersection lane to take. That's why NextLane is being set to
-						// IntersectionTrafficLaneData and not PostIntersectionTrafficLaneData.
-						BestNextLaneDensity = PostIntersectionLaneDensity;
-						BestNextTrafficLaneData = NextLane;
-					}
+				// Does this lane have more space than the others? If so, remember it.
+				// NOTE - For intersection lanes, we search the lanes after the intersection so we know which
+				// intersection lane to take. That's why the route's NextLane is chosen, not its DestinationLane.
+				const float DestinationLaneDensity =
+					DensityToUseForChoosingLane == ChooseLaneByDownstreamFlowDensity ?
+					DestinationLane.GetDownstreamFlowDensity() :
+					DestinationLane.FunctionalDensity();
+				if (DestinationLaneDensity <= BestNextLaneDensity)
+				{
+					BestNextLaneDensity = DestinationLaneDensity;
+					BestNextLaneRoute = &NextLaneRoute;
 				}
 			}
 
@@ -377,12 +348,12 @@ void UMassTrafficChooseNextLaneProcessor::Execute(FMassEntityManager& EntityMana
 			// IMPORTANT - This is one crucial place where we update downstream lane density of a lane.
 			// NOTE - The above code should have brought all the current lane's next lanes into the cache, so this
 			// should not be expensive.
-			CurrentLane.UpdateDownstreamFlowDensity(MassTrafficSettings->DownstreamFlowDensityMixtureFraction);
+			Reservations.Add(VehicleEntity, EMassTrafficLaneReservationType::UpdateDownstreamFlowDensity, &CurrentLane);
 
 
-			if (BestNextTrafficLaneData)
+			if (BestNextLaneRoute)
 			{
-				VehicleControlFragment.NextLane = BestNextTrafficLaneData;
+				VehicleControlFragment.NextLane = BestNextLaneRoute->NextLane;
 				VehicleControlFragment.ChooseNextLanePreference = EMassTrafficChooseNextLanePreference::KeepCurrentNextLane;
 			}
 			else
@@ -399,19 +370,19 @@ void UMassTrafficChooseNextLaneProcessor::Execute(FMassEntityManager& EntityMana
 				check(VehicleControlFragment.ChooseNextLanePreference == EMassTrafficChooseNextLanePreference::KeepCurrentNextLane);
 			
 				// Add ourselves to the number of cars waiting to get onto that lane.
-				++VehicleControlFragment.NextLane->NumVehiclesApproachingLane;
+				Reservations.Add(VehicleEntity, EMassTrafficLaneReservationType::ApproachLane, VehicleControlFragment.NextLane);
 
 				// Update turn signals to reflect our next chosen lane
-				VehicleLightsFragment.bLeftTurnSignalLights = VehicleControlFragment.NextLane->bTurnsLeft;
-				VehicleLightsFragment.bRightTurnSignalLights = VehicleControlFragment.NextLane->bTurnsRight;
+				VehicleLightsFragment.bLeftTurnSignalLights = BestNextLaneRoute->bTurnsLeft;
+				VehicleLightsFragment.bRightTurnSignalLights = BestNextLaneRoute->bTurnsRight;
 
 				// If we don't have a current Next vehicle, set the new lane's Tail as our Next
 				if (!NextVehicleFragment.HasNextVehicle() && VehicleControlFragment.NextLane->TailVehicle.IsSet())
 				{
-					NextVehicleFragment.SetNextVehicle(QueryContext.GetEntity(Index), VehicleControlFragment.NextLane->TailVehicle);
+					NextVehicleFragment.SetNextVehicle(VehicleEntity, VehicleControlFragment.NextLane->TailVehicle);
 
 					// Sanity check (you can't be your own obstacle)
-					checkSlow(NextVehicleFragment.GetNextVehicle() != QueryContext.GetEntity(Index));
+					checkSlow(NextVehicleFragment.GetNextVehicle() != VehicleEntity);
 				}
 			}
 			else
@@ -454,8 +425,7 @@ void UMassTrafficChooseNextLaneProcessor::Execute(FMassEntityManager& EntityMana
 						const FZoneGraphStorage* ZoneGraphStorage = ZoneGraphSubsystem.GetZoneGraphStorage(VehicleControlFragment.NextLane->LaneHandle.DataHandle);
 						check(ZoneGraphStorage);
 						
-						const FMassEntityHandle Entity = Context.GetEntity(Index);
-						const FTransformFragment& TransformFragment = EntityManager.GetFragmentDataChecked<FTransformFragment>(Entity);
+						const FTransformFragment& TransformFragment = EntityManager.GetFragmentDataChecked<FTransformFragment>(VehicleEntity);
 						const FVector Location = TransformFragment.GetTransform().GetLocation();
 						const FVector LaneLocation = UE::MassTraffic::GetLaneEndPoint(VehicleControlFragment.NextLane->LaneHandle.Index, *ZoneGraphStorage);
 						const FVector Z(0.0f, 0.0f, 500.0f);
@@ -469,5 +439,20 @@ void UMassTrafficChooseNextLaneProcessor::Execute(FMassEntityManager& EntityMana
 				#endif
 			#endif
 		}
-	});
+	};
+
+	{
+		TRACE_CPUPROFILER_EVENT_SCOPE(TEXT("ChooseNextLane"));
+
+		if (ShouldProcessVehicleBehaviorInParallel())
+		{
+			EntityQuery_Conditional.ParallelForEachEntityChunk(EntityManager, Context, ChooseNextLaneChunk);
+		}
+		else
+		{
+			EntityQuery_Conditional.ForEachEntityChunk(EntityManager, Context, ChooseNextLaneChunk);
+		}
+	}
+
+	LaneReservations.SortAndApply(MassTrafficSettings->DownstreamFlowDensityMixtureFraction);
 }
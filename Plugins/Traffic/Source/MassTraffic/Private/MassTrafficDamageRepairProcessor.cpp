@@ -2,6 +2,7 @@
 
 #include "MassTrafficDamageRepairProcessor.h"
 #include "MassTraffic.h"
+#include "MassTrafficEntityTransitionBatch.h"
 #include "MassTrafficVehicleInterface.h"
 
 #include "GameFramework/PlayerController.h"
@@ -39,8 +40,15 @@ void UMassTrafficDamageRepairProcessor::Execute(FMassEntityManager& EntityManage
 		return;
 	}
 	
+	// Irreparable vehicles are all recycled or destroyed together, once we're done
+	FMassTrafficEntityTransitionBatch EntityTransitionBatch;
+	TArray<FMassEntityHandle> EntitiesToDestroy;
+	static const FMassTrafficEntityTransition RecycleTransition = FMassTrafficEntityTransition()
+		.RemoveTags<FMassTrafficVehicleTag>()
+		.AddTags<FMassTrafficRecyclableVehicleTag>();
+
 	// Block LOD changes to high LOD damaged vehicles, while we repair damage
-	DamagedVehicleEntityQuery.ForEachEntityChunk(EntityManager, Context, [](FMassExecutionContext& Context)
+	DamagedVehicleEntityQuery.ForEachEntityChunk(EntityManager, Context, [&EntityTransitionBatch, &EntitiesToDestroy](FMassExecutionContext& Context)
 	{
 		const int32 NumEntities = Context.GetNumEntities();
 		const TArrayView<FMassActorFragment> ActorFragments = Context.GetMutableFragmentView<FMassActorFragment>();
@@ -106,12 +114,12 @@ void UMassTrafficDamageRepairProcessor::Execute(FMassEntityManager& EntityManage
 						if (bIsDisturbedVehicle)
 						{
 							// Delete the entity.
-							Context.Defer().DestroyEntity(Context.GetEntity(EntityIndex));
+							EntitiesToDestroy.Add(Context.GetEntity(EntityIndex));
 						}
 						else
 						{
 							// Recycle the entity back into the system.
-							Context.Defer().SwapTags<FMassTrafficVehicleTag, FMassTrafficRecyclableVehicleTag>(Context.GetEntity(EntityIndex));
+							EntityTransitionBatch.AddTransition(RecycleTransition, Context.GetEntity(EntityIndex));
 						}
 					}
 				}
@@ -153,4 +161,10 @@ void UMassTrafficDamageRepairProcessor::Execute(FMassEntityManager& EntityManage
 			}
 		}
 	});
+
+	EntityTransitionBatch.Defer(Context.Defer());
+	if (!EntitiesToDestroy.IsEmpty())
+	{
+		Context.Defer().DestroyEntities(EntitiesToDestroy);
+	}
 }
\ No newline at end of file
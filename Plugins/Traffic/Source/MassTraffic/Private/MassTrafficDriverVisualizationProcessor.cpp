@@ -4,6 +4,7 @@
 #include "MassTraffic.h"
 #include "MassTrafficDrivers.h"
 #include "MassTrafficFragments.h"
+#include "MassTrafficSubsystem.h"
 #include "MassTrafficVehicleInterface.h"
 
 #include "AnimToTextureDataAsset.h"
@@ -38,10 +39,13 @@ void UMassTrafficDriverVisualizationProcessor::ConfigureQueries()
 	EntityQuery_Conditional.AddRequirement<FMassTrafficRandomFractionFragment>(EMassFragmentAccess::ReadOnly);
 	EntityQuery_Conditional.AddRequirement<FMassTrafficPIDVehicleControlFragment>(EMassFragmentAccess::ReadOnly, EMassFragmentPresence::Optional);
 	EntityQuery_Conditional.AddRequirement<FMassActorFragment>(EMassFragmentAccess::ReadWrite);
+	EntityQuery_Conditional.AddRequirement<FMassTrafficPreviousTransformFragment>(EMassFragmentAccess::ReadOnly, EMassFragmentPresence::Optional);
 	EntityQuery_Conditional.AddChunkRequirement<FMassVisualizationChunkFragment>(EMassFragmentAccess::ReadOnly);
 	EntityQuery_Conditional.AddConstSharedRequirement<FMassTrafficDriversParameters>();
 	EntityQuery_Conditional.AddSharedRequirement<FMassRepresentationSubsystemSharedFragment>(EMassFragmentAccess::ReadWrite);
 	EntityQuery_Conditional.SetChunkFilter(&FMassVisualizationChunkFragment::AreAnyEntitiesVisibleInChunk);
+
+	ProcessorRequirements.AddSubsystemRequirement<UMassTrafficSubsystem>(EMassFragmentAccess::ReadWrite);
 }
 
 void UMassTrafficDriverVisualizationProcessor::Initialize(UObject& Owner)
@@ -53,9 +57,16 @@ void UMassTrafficDriverVisualizationProcessor::Initialize(UObject& Owner)
 
 void UMassTrafficDriverVisualizationProcessor::Execute(FMassEntityManager& EntityManager, FMassExecutionContext& Context)
 {
+	UMassTrafficSubsystem& MassTrafficSubsystem = Context.GetMutableSubsystemChecked<UMassTrafficSubsystem>(World);
+	FMassTrafficMovingInstances& MovingInstances = MassTrafficSubsystem.GetMutableDriverMovingInstances();
+
 	// Skip driver vis?
 	if (!GMassTrafficDrivers)
 	{
+		if (MovingInstances.Num() > 0)
+		{
+			MovingInstances.Reset();
+		}
 		return;
 	}
 	
@@ -65,6 +76,18 @@ void UMassTrafficDriverVisualizationProcessor::Execute(FMassEntityManager& Entit
 	check(World);
 	const float GlobalTime = World->GetTimeSeconds();
 
+	const FMassTrafficSimulationClock& SimulationClock = MassTrafficSubsystem.GetSimulationClock();
+
+	const bool bUseMovingInstances = GMassTrafficStaticInstances != 0;
+	if (bUseMovingInstances)
+	{
+		MovingInstances.BeginUpdate(*World);
+	}
+	else if (MovingInstances.Num() > 0)
+	{
+		MovingInstances.Reset();
+	}
+
 	// Grab player's spatial data (assume single player)
 	FVector PlayerMeshLocation = FVector::ZeroVector;
 	if (const ACharacter* PlayerChar = UGameplayStatics::GetPlayerCharacter(this, 0))
@@ -94,6 +117,7 @@ void UMassTrafficDriverVisualizationProcessor::Execute(FMassEntityManager& Entit
 		const TConstArrayView<FMassTrafficVehicleDamageFragment> VehicleDamageFragments = QueryContext.GetFragmentView<FMassTrafficVehicleDamageFragment>();
 		const TConstArrayView<FMassTrafficRandomFractionFragment> RandomFractionFragments = QueryContext.GetFragmentView<FMassTrafficRandomFractionFragment>();
 		const TConstArrayView<FTransformFragment> TransformFragments = QueryContext.GetFragmentView<FTransformFragment>();
+		const TConstArrayView<FMassTrafficPreviousTransformFragment> PreviousTransformFragments = QueryContext.GetFragmentView<FMassTrafficPreviousTransformFragment>();
 		const TConstArrayView<FMassTrafficPIDVehicleControlFragment> PIDVehicleControlFragments = QueryContext.GetFragmentView<FMassTrafficPIDVehicleControlFragment>();
 		TArrayView<FMassTrafficDriverVisualizationFragment> DriverVisualizationFragments = QueryContext.GetMutableFragmentView<FMassTrafficDriverVisualizationFragment>();
 		TArrayView<FMassActorFragment> ActorFragments = QueryContext.GetMutableFragmentView<FMassActorFragment>();
@@ -121,9 +145,13 @@ void UMassTrafficDriverVisualizationProcessor::Execute(FMassEntityManager& Entit
 			const int16 DriverStaticMeshDescIndex = Params.DriverTypesStaticMeshDescIndex[DriverVisualizationFragment.DriverTypeIndex];
 			if (RepresentationLODFragment.LOD <= GMassTrafficMaxDriverVisualizationLOD && ViewerInfoFragment.ClosestViewerDistanceSq <= MaxDriverVisualizationDistanceSq && DriverStaticMeshDescIndex != INDEX_NONE)
 			{
-				const FTransform DriverTransform = Params.DriversSeatOffset * TransformFragment.GetTransform();
+				// Interpolate between fixed timestep simulation states
+				const FTransform VehicleTransform = PreviousTransformFragments.IsEmpty() ? TransformFragment.GetTransform() :
+					SimulationClock.GetInterpolatedTransform(PreviousTransformFragments[EntityIdx].Transform, PreviousTransformFragments[EntityIdx].Step, TransformFragment.GetTransform());
+
+				const FTransform DriverTransform = Params.DriversSeatOffset * VehicleTransform;
 				const FTransform DriverPrevTransform = Params.DriversSeatOffset * RepresentationFragment.PrevTransform;
-				RepresentationFragment.PrevTransform = TransformFragment.GetTransform();
+				RepresentationFragment.PrevTransform = VehicleTransform;
 
 				if (const UAnimToTextureDataAsset* AnimData = DriverType.AnimationData.Get())
 				{
@@ -240,13 +268,25 @@ void UMassTrafficDriverVisualizationProcessor::Execute(FMassEntityManager& Entit
 					}
 					else
 					{
-						ISMInfo[DriverStaticMeshDescIndex].AddBatchedTransform(GetTypeHash(QueryContext.GetEntity(EntityIdx)), DriverTransform, DriverPrevTransform, RepresentationLODFragment.LODSignificance);
-						ISMInfo[DriverStaticMeshDescIndex].AddBatchedCustomData(CustomData, RepresentationLODFragment.LODSignificance);
+						if (bUseMovingInstances)
+						{
+							MovingInstances.AddInstance(DriverStaticMeshDescIndex, ISMInfo[DriverStaticMeshDescIndex].GetDesc(), DriverTransform, RepresentationLODFragment.LODSignificance, CustomData);
+						}
+						else
+						{
+							ISMInfo[DriverStaticMeshDescIndex].AddBatchedTransform(GetTypeHash(QueryContext.GetEntity(EntityIdx)), DriverTransform, DriverPrevTransform, RepresentationLODFragment.LODSignificance);
+							ISMInfo[DriverStaticMeshDescIndex].AddBatchedCustomData(CustomData, RepresentationLODFragment.LODSignificance);
+						}
 					}
 				}
 			}
 		}
 	});
+
+	if (bUseMovingInstances)
+	{
+		MovingInstances.EndUpdate();
+	}
 }
 
 bool UMassTrafficDriverVisualizationProcessor::PopulateAnimEvalFromAnimState(
@@ -0,0 +1,121 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "MassTrafficEntityTransitionBatch.h"
+#include "MassTraffic.h"
+
+#include "MassCommandBuffer.h"
+#include "MassEntityManager.h"
+#include "MassEntityUtils.h"
+
+
+DECLARE_CYCLE_STAT(TEXT("Apply Entity Transitions"), STAT_Traffic_ApplyEntityTransitions, STATGROUP_Traffic);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Entity Transitions"), STAT_Traffic_EntityTransitions, STATGROUP_Traffic);
+
+
+void FMassTrafficEntityTransitionBatch::AddTransition(const FMassTrafficEntityTransition& Transition, const FMassEntityHandle Entity, TConstArrayView<FInstancedStruct> InFragmentInstances)
+{
+	// Only a handful of distinct transitions are ever made, so a linear search is cheapest
+	FTransitionEntities* TransitionEntities = Transitions.FindByPredicate([&Transition](const FTransitionEntities& Other)
+	{
+		return Other.Transition == Transition;
+	});
+	if (!TransitionEntities)
+	{
+		TransitionEntities = &Transitions.AddDefaulted_GetRef();
+		TransitionEntities->Transition = Transition;
+	}
+	TransitionEntities->Entities.Add(Entity);
+
+	for (const FInstancedStruct& FragmentInstance : InFragmentInstances)
+	{
+		FragmentInstances.Emplace(Entity, FragmentInstance);
+	}
+}
+
+int32 FMassTrafficEntityTransitionBatch::Num() const
+{
+	int32 NumEntities = 0;
+	for (const FTransitionEntities& TransitionEntities : Transitions)
+	{
+		NumEntities += TransitionEntities.Entities.Num();
+	}
+
+	return NumEntities;
+}
+
+void FMassTrafficEntityTransitionBatch::Apply(FMassEntityManager& EntityManager) const
+{
+	SCOPE_CYCLE_COUNTER(STAT_Traffic_ApplyEntityTransitions);
+	INC_DWORD_STAT_BY(STAT_Traffic_EntityTransitions, Num());
+
+	TArray<FMassEntityHandle> ValidEntities;
+	TArray<FMassArchetypeEntityCollection> EntityCollections;
+	for (const FTransitionEntities& TransitionEntities : Transitions)
+	{
+		// Entities may have been destroyed since they were added, e.g: by an earlier command in the same buffer
+		ValidEntities.Reset();
+		for (const FMassEntityHandle Entity : TransitionEntities.Entities)
+		{
+			if (EntityManager.IsEntityValid(Entity))
+			{
+				ValidEntities.Add(Entity);
+			}
+		}
+		if (ValidEntities.IsEmpty())
+		{
+			continue;
+		}
+
+		const FMassTrafficEntityTransition& Transition = TransitionEntities.Transition;
+		if (!Transition.FragmentsToAdd.IsEmpty() || !Transition.FragmentsToRemove.IsEmpty())
+		{
+			EntityCollections.Reset();
+			UE::Mass::Utils::CreateEntityCollections(EntityManager, ValidEntities, FMassArchetypeEntityCollection::FoldDuplicates, EntityCollections);
+			EntityManager.BatchChangeFragmentCompositionForEntities(EntityCollections, Transition.FragmentsToAdd, Transition.FragmentsToRemove);
+		}
+
+		// Collections have to be rebuilt, as entities will have moved archetypes if their fragments changed
+		if (!Transition.TagsToAdd.IsEmpty() || !Transition.TagsToRemove.IsEmpty())
+		{
+			EntityCollections.Reset();
+			UE::Mass::Utils::CreateEntityCollections(EntityManager, ValidEntities, FMassArchetypeEntityCollection::FoldDuplicates, EntityCollections);
+			EntityManager.BatchChangeTagsForEntities(EntityCollections, Transition.TagsToAdd, Transition.TagsToRemove);
+		}
+	}
+
+	for (const TPair<FMassEntityHandle, FInstancedStruct>& FragmentInstance : FragmentInstances)
+	{
+		if (!EntityManager.IsEntityValid(FragmentInstance.Key))
+		{
+			continue;
+		}
+
+		const UScriptStruct* FragmentType = FragmentInstance.Value.GetScriptStruct();
+		const FStructView Fragment = EntityManager.GetFragmentDataStruct(FragmentInstance.Key, FragmentType);
+		if (ensureMsgf(Fragment.IsValid(), TEXT("Entity transition didn't add a %s fragment to set"), *GetNameSafe(FragmentType)))
+		{
+			FragmentType->CopyScriptStruct(Fragment.GetMemory(), FragmentInstance.Value.GetMemory());
+		}
+	}
+}
+
+void FMassTrafficEntityTransitionBatch::Defer(FMassCommandBuffer& CommandBuffer)
+{
+	if (IsEmpty())
+	{
+		return;
+	}
+
+	CommandBuffer.PushCommand<FMassDeferredChangeCompositionCommand>([Batch = MoveTemp(*this)](FMassEntityManager& EntityManager)
+	{
+		Batch.Apply(EntityManager);
+	});
+
+	Reset();
+}
+
+void FMassTrafficEntityTransitionBatch::Reset()
+{
+	Transitions.Reset();
+	FragmentInstances.Reset();
+}
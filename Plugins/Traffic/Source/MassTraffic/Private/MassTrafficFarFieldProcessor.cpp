@@ -0,0 +1,607 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "MassTrafficFarFieldProcessor.h"
+#include "MassTraffic.h"
+#include "MassTrafficFragments.h"
+#include "MassTrafficInterpolation.h"
+#include "MassTrafficMovement.h"
+#include "MassTrafficOverseerProcessor.h"
+#include "MassTrafficSubsystem.h"
+
+#include "MassCommonFragments.h"
+#include "MassEntityView.h"
+#include "MassLODSubsystem.h"
+#include "MassRepresentationFragments.h"
+#include "MassZoneGraphNavigationFragments.h"
+#include "ZoneGraphSubsystem.h"
+
+// Stats
+DECLARE_DWORD_COUNTER_STAT(TEXT("Far Field Vehicles"), STAT_Traffic_FarFieldVehicles, STATGROUP_Traffic);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Far Field Lanes"), STAT_Traffic_FarFieldLanes, STATGROUP_Traffic);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Far Field Transitions"), STAT_Traffic_FarFieldTransitions, STATGROUP_Traffic);
+
+namespace
+{
+	// Far field flow is split between next lanes by their free downstream flow, but never fully blocked off from one
+	constexpr float MinNextLaneFlowWeight = 0.05f;
+
+	FORCEINLINE float GetFarFieldFreeFlowSpeed(const FZoneGraphTrafficLaneData& TrafficLaneData)
+	{
+		return FMath::Max(static_cast<float>(TrafficLaneData.ConstData.SpeedLimit), 100.0f);
+	}
+
+	FORCEINLINE float GetFarFieldOccupancy(const FZoneGraphTrafficLaneData& TrafficLaneData)
+	{
+		return TrafficLaneData.Length > 0.0f ? FMath::Clamp(TrafficLaneData.BasicDensity(), 0.0f, 1.0f) : 1.0f;
+	}
+}
+
+
+UMassTrafficFarFieldProcessor::UMassTrafficFarFieldProcessor()
+{
+	bAutoRegisterWithProcessingPhases = true;
+	ExecutionOrder.ExecuteInGroup = UE::MassTraffic::ProcessorGroupNames::FrameStart;
+	ExecutionOrder.ExecuteAfter.Add(UMassTrafficOverseerProcessor::StaticClass()->GetFName());
+}
+
+void UMassTrafficFarFieldProcessor::ConfigureQueries()
+{
+	ProcessorRequirements.AddSubsystemRequirement<UMassTrafficSubsystem>(EMassFragmentAccess::ReadWrite);
+	ProcessorRequirements.AddSubsystemRequirement<UZoneGraphSubsystem>(EMassFragmentAccess::ReadOnly);
+	ProcessorRequirements.AddSubsystemRequirement<UMassLODSubsystem>(EMassFragmentAccess::ReadOnly);
+}
+
+void UMassTrafficFarFieldProcessor::Execute(FMassEntityManager& EntityManager, FMassExecutionContext& Context)
+{
+	// Skip during replay playback and on frames without fixed timestep substeps
+	if (!ShouldSimulateTrafficVehicles())
+	{
+		return;
+	}
+
+	UWorld* World = GetWorld();
+	UMassTrafficSubsystem& LocalMassTrafficSubsystem = Context.GetMutableSubsystemChecked<UMassTrafficSubsystem>(World);
+
+	// When far field simulation is turned off, keep running until all far field vehicles have been materialised again
+	const bool bFarFieldSimulation = MassTrafficSettings->bFarFieldSimulation;
+	if (!bFarFieldSimulation && LocalMassTrafficSubsystem.GetFarFieldVehicles().IsEmpty())
+	{
+		return;
+	}
+
+	TRACE_CPUPROFILER_EVENT_SCOPE(TEXT("TrafficFarField"))
+
+	const UZoneGraphSubsystem& LocalZoneGraphSubsystem = Context.GetSubsystemChecked<UZoneGraphSubsystem>(World);
+	const UMassLODSubsystem& LODSubsystem = Context.GetSubsystemChecked<UMassLODSubsystem>(World);
+
+	ViewerLocations.Reset();
+	for (const FViewerInfo& Viewer : LODSubsystem.GetViewers())
+	{
+		if (Viewer.Handle.IsValid())
+		{
+			ViewerLocations.Add(Viewer.Location);
+		}
+	}
+
+	const float DeltaTime = LocalMassTrafficSubsystem.GetSimulationClock().GetDeltaTime();
+	const int32 MaxTransitions = MassTrafficSettings->MaxFarFieldTransitionsPerFrame;
+	int32 NumDematerialised = 0;
+	int32 NumMaterialised = 0;
+	int32 NumFarFieldLanes = 0;
+
+	for (FMassTrafficZoneGraphData* TrafficZoneGraphData : LocalMassTrafficSubsystem.GetMutableTrafficZoneGraphData())
+	{
+		if (!TrafficZoneGraphData)
+		{
+			continue;
+		}
+
+		const FZoneGraphStorage* ZoneGraphStorage = LocalZoneGraphSubsystem.GetZoneGraphStorage(TrafficZoneGraphData->DataHandle);
+		if (!ZoneGraphStorage)
+		{
+			continue;
+		}
+
+		UpdateFarFieldLanes(*TrafficZoneGraphData, ViewerLocations, bFarFieldSimulation);
+
+		UpdateFarFieldFlow(*TrafficZoneGraphData, DeltaTime);
+
+		for (FZoneGraphTrafficLaneData& TrafficLaneData : TrafficZoneGraphData->TrafficLaneDataArray)
+		{
+			if (TrafficLaneData.bIsFarField)
+			{
+				++NumFarFieldLanes;
+
+				// Dematerialise Off LOD vehicles from anywhere on the lane, walking back from its front so the indices
+				// of vehicles still to visit aren't changed by removals. Lanes with vehicles merging, splitting or lane
+				// changing are left alone, as their ghost vehicles still reference vehicles on them.
+				if (TrafficLaneData.MergingLanes.IsEmpty() && TrafficLaneData.SplittingLanes.IsEmpty()
+					&& TrafficLaneData.NumVehiclesLaneChangingOntoLane == 0 && TrafficLaneData.NumVehiclesLaneChangingOffOfLane == 0)
+				{
+					for (int32 VehicleIndex = TrafficLaneData.Vehicles.Num() - 1; VehicleIndex >= 0 && NumDematerialised < MaxTransitions; --VehicleIndex)
+					{
+						if (DematerialiseVehicle(EntityManager, Context, LocalZoneGraphSubsystem, LocalMassTrafficSubsystem, TrafficLaneData, VehicleIndex))
+						{
+							++NumDematerialised;
+						}
+					}
+				}
+			}
+			else
+			{
+				// Materialise vehicles that have flowed onto this near field lane
+				while (NumMaterialised < MaxTransitions && TrafficLaneData.FarFieldPendingVehicles >= 1.0f
+					&& MaterialiseVehicle(EntityManager, Context, *ZoneGraphStorage, LocalMassTrafficSubsystem, TrafficLaneData))
+				{
+					TrafficLaneData.FarFieldPendingVehicles -= 1.0f;
+					++NumMaterialised;
+				}
+			}
+		}
+
+		// Drop fractional flow that can no longer be backed by a pooled vehicle
+		if (LocalMassTrafficSubsystem.GetFarFieldVehicles().IsEmpty())
+		{
+			for (FZoneGraphTrafficLaneData& TrafficLaneData : TrafficZoneGraphData->TrafficLaneDataArray)
+			{
+				TrafficLaneData.FarFieldPendingVehicles = 0.0f;
+				TrafficLaneData.RemoveFarFieldVehicles(TrafficLaneData.FarFieldNumVehicles, MassTrafficSettings->FarFieldVehicleSpacing);
+			}
+		}
+	}
+
+	INC_DWORD_STAT_BY(STAT_Traffic_FarFieldVehicles, LocalMassTrafficSubsystem.GetFarFieldVehicles().Num());
+	INC_DWORD_STAT_BY(STAT_Traffic_FarFieldLanes, NumFarFieldLanes);
+	INC_DWORD_STAT_BY(STAT_Traffic_FarFieldTransitions, NumDematerialised + NumMaterialised);
+}
+
+void UMassTrafficFarFieldProcessor::UpdateFarFieldLanes(FMassTrafficZoneGraphData& TrafficZoneGraphData, TConstArrayView<FVector> InViewerLocations, const bool bFarFieldSimulation) const
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(TEXT("UpdateFarFieldLanes"))
+
+	const float FarFieldDistanceSquared = FMath::Square(MassTrafficSettings->FarFieldDistance);
+	const float FarFieldVehicleSpacing = MassTrafficSettings->FarFieldVehicleSpacing;
+
+	for (FZoneGraphTrafficLaneData& TrafficLaneData : TrafficZoneGraphData.TrafficLaneDataArray)
+	{
+		// Without any viewers, lanes keep their current state
+		bool bIsFarField = bFarFieldSimulation ? TrafficLaneData.bIsFarField : false;
+		if (bFarFieldSimulation && !InViewerLocations.IsEmpty())
+		{
+			bIsFarField = true;
+			for (const FVector& ViewerLocation : InViewerLocations)
+			{
+				const float DistanceFromLaneBounds = FMath::Max(FVector::Dist(ViewerLocation, TrafficLaneData.CenterLocation) - TrafficLaneData.Radius, 0.0f);
+				if (FMath::Square(DistanceFromLaneBounds) <= FarFieldDistanceSquared)
+				{
+					bIsFarField = false;
+					break;
+				}
+			}
+		}
+
+		if (bIsFarField == TrafficLaneData.bIsFarField)
+		{
+			continue;
+		}
+
+		if (bIsFarField)
+		{
+			// Vehicles still waiting to materialise join the flow
+			TrafficLaneData.AddFarFieldVehicles(TrafficLaneData.FarFieldPendingVehicles, FarFieldVehicleSpacing);
+			TrafficLaneData.FarFieldPendingVehicles = 0.0f;
+		}
+		else
+		{
+			// The lane's flow gets materialised as space allows
+			TrafficLaneData.FarFieldPendingVehicles += TrafficLaneData.FarFieldNumVehicles;
+			TrafficLaneData.RemoveFarFieldVehicles(TrafficLaneData.FarFieldNumVehicles, FarFieldVehicleSpacing);
+			TrafficLaneData.FarFieldSpeed = 0.0f;
+		}
+
+		TrafficLaneData.bIsFarField = bIsFarField;
+	}
+}
+
+void UMassTrafficFarFieldProcessor::UpdateFarFieldFlow(FMassTrafficZoneGraphData& TrafficZoneGraphData, const float DeltaTime)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(TEXT("UpdateFarFieldFlow"))
+
+	if (DeltaTime <= 0.0f)
+	{
+		return;
+	}
+
+	TArray<FZoneGraphTrafficLaneData>& TrafficLaneDataArray = TrafficZoneGraphData.TrafficLaneDataArray;
+	const int32 NumLanes = TrafficLaneDataArray.Num();
+	const float FarFieldVehicleSpacing = MassTrafficSettings->FarFieldVehicleSpacing;
+
+	// Lanes are cells with a triangular (Greenshields) fundamental diagram, where flow peaks at half occupancy
+	auto GetCapacity = [FarFieldVehicleSpacing, DeltaTime](const FZoneGraphTrafficLaneData& TrafficLaneData)
+	{
+		return GetFarFieldFreeFlowSpeed(TrafficLaneData) / (4.0f * FarFieldVehicleSpacing) * DeltaTime;
+	};
+
+	// Supply - How many vehicles each lane can receive this step
+	LaneSupplies.SetNumUninitialized(NumLanes);
+	for (int32 LaneIndex = 0; LaneIndex < NumLanes; ++LaneIndex)
+	{
+		const FZoneGraphTrafficLaneData& TrafficLaneData = TrafficLaneDataArray[LaneIndex];
+		if (TrafficLaneData.bIsFarField)
+		{
+			const float FreeSpaceFlow = GetFarFieldFreeFlowSpeed(TrafficLaneData) * (1.0f - GetFarFieldOccupancy(TrafficLaneData)) / FarFieldVehicleSpacing * DeltaTime;
+			LaneSupplies[LaneIndex] = FMath::Min(GetCapacity(TrafficLaneData), FreeSpaceFlow);
+		}
+		else
+		{
+			// Near field lanes can only take what will fit once materialised
+			const float FreeSpaceVehicles = TrafficLaneData.SpaceAvailable / FarFieldVehicleSpacing - TrafficLaneData.FarFieldPendingVehicles;
+			LaneSupplies[LaneIndex] = FMath::Clamp(FreeSpaceVehicles, 0.0f, GetCapacity(TrafficLaneData));
+		}
+	}
+
+	LaneInflows.Reset();
+	LaneInflows.SetNumZeroed(NumLanes);
+	LaneOutflows.Reset();
+	LaneOutflows.SetNumZeroed(NumLanes);
+
+	// Lanes a far field vehicle flows onto. Near field intersection lanes are skipped straight over, as vehicles
+	// can't be materialised part way through an intersection.
+	auto GetFlowTargetLane = [](FZoneGraphTrafficLaneData* NextTrafficLaneData) -> FZoneGraphTrafficLaneData*
+	{
+		if (!NextTrafficLaneData->bIsFarField && NextTrafficLaneData->ConstData.bIsIntersectionLane)
+		{
+			return NextTrafficLaneData->NextLanes.IsEmpty() ? nullptr : NextTrafficLaneData->NextLanes[0];
+		}
+
+		return NextTrafficLaneData;
+	};
+
+	// Demand - How many vehicles each far field lane sends onto its next lanes this step
+	for (int32 LaneIndex = 0; LaneIndex < NumLanes; ++LaneIndex)
+	{
+		const FZoneGraphTrafficLaneData& TrafficLaneData = TrafficLaneDataArray[LaneIndex];
+		if (!TrafficLaneData.bIsFarField || TrafficLaneData.FarFieldNumVehicles <= 0.0f || TrafficLaneData.NextLanes.IsEmpty())
+		{
+			continue;
+		}
+
+		const float DensityFlow = GetFarFieldFreeFlowSpeed(TrafficLaneData) * GetFarFieldOccupancy(TrafficLaneData) / FarFieldVehicleSpacing * DeltaTime;
+		const float Demand = FMath::Min3(DensityFlow, GetCapacity(TrafficLaneData), TrafficLaneData.FarFieldNumVehicles);
+
+		float TotalWeight = 0.0f;
+		for (FZoneGraphTrafficLaneData* NextTrafficLaneData : TrafficLaneData.NextLanes)
+		{
+			if (const FZoneGraphTrafficLaneData* TargetTrafficLaneData = GetFlowTargetLane(NextTrafficLaneData))
+			{
+				TotalWeight += FMath::Max(1.0f - TargetTrafficLaneData->GetDownstreamFlowDensity(), MinNextLaneFlowWeight);
+			}
+		}
+
+		if (TotalWeight <= 0.0f)
+		{
+			continue;
+		}
+
+		for (FZoneGraphTrafficLaneData* NextTrafficLaneData : TrafficLaneData.NextLanes)
+		{
+			const FZoneGraphTrafficLaneData* TargetTrafficLaneData = GetFlowTargetLane(NextTrafficLaneData);
+			if (!TargetTrafficLaneData)
+			{
+				continue;
+			}
+
+			const int32 TargetLaneIndex = UE_PTRDIFF_TO_INT32(TargetTrafficLaneData - TrafficLaneDataArray.GetData());
+			if (!ensure(TrafficLaneDataArray.IsValidIndex(TargetLaneIndex)))
+			{
+				continue;
+			}
+
+			const float Weight = FMath::Max(1.0f - TargetTrafficLaneData->GetDownstreamFlowDensity(), MinNextLaneFlowWeight);
+			const float Flow = FMath::Min(Demand * Weight / TotalWeight, LaneSupplies[TargetLaneIndex]);
+			LaneSupplies[TargetLaneIndex] -= Flow;
+			LaneInflows[TargetLaneIndex] += Flow;
+			LaneOutflows[LaneIndex] += Flow;
+		}
+	}
+
+	// Apply flows. Outflows first, so occupancy is freed before it's taken.
+	for (int32 LaneIndex = 0; LaneIndex < NumLanes; ++LaneIndex)
+	{
+		if (LaneOutflows[LaneIndex] > 0.0f)
+		{
+			TrafficLaneDataArray[LaneIndex].RemoveFarFieldVehicles(LaneOutflows[LaneIndex], FarFieldVehicleSpacing);
+		}
+	}
+
+	for (int32 LaneIndex = 0; LaneIndex < NumLanes; ++LaneIndex)
+	{
+		FZoneGraphTrafficLaneData& TrafficLaneData = TrafficLaneDataArray[LaneIndex];
+		if (LaneInflows[LaneIndex] > 0.0f)
+		{
+			if (TrafficLaneData.bIsFarField)
+			{
+				TrafficLaneData.AddFarFieldVehicles(LaneInflows[LaneIndex], FarFieldVehicleSpacing);
+			}
+			else
+			{
+				TrafficLaneData.FarFieldPendingVehicles += LaneInflows[LaneIndex];
+			}
+		}
+
+		if (TrafficLaneData.bIsFarField)
+		{
+			TrafficLaneData.FarFieldSpeed = GetFarFieldFreeFlowSpeed(TrafficLaneData) * (1.0f - GetFarFieldOccupancy(TrafficLaneData));
+			TrafficLaneData.UpdateDownstreamFlowDensity(MassTrafficSettings->DownstreamFlowDensityMixtureFraction);
+		}
+	}
+}
+
+bool UMassTrafficFarFieldProcessor::DematerialiseVehicle(
+	FMassEntityManager& EntityManager,
+	FMassExecutionContext& Context,
+	const UZoneGraphSubsystem& ZoneGraphSubsystem,
+	UMassTrafficSubsystem& MassTrafficSubsystem,
+	FZoneGraphTrafficLaneData& TrafficLaneData,
+	const int32 VehicleIndex)
+{
+	const FMassEntityHandle VehicleEntity = TrafficLaneData.Vehicles[VehicleIndex].Entity;
+	if (!EntityManager.IsEntityValid(VehicleEntity))
+	{
+		return false;
+	}
+
+	// Mid-lane vehicles are unlinked through the vehicle behind them, which has to be the previous entry in Vehicles
+	const bool bIsTailVehicle = TrafficLaneData.TailVehicle == VehicleEntity;
+	if (!bIsTailVehicle && (VehicleIndex == 0 || !EntityManager.IsEntityValid(TrafficLaneData.Vehicles[VehicleIndex - 1].Entity)))
+	{
+		return false;
+	}
+
+	// Only regular traffic vehicles, e.g: not ones already recycled or in the middle of being changed
+	const FMassArchetypeCompositionDescriptor& Composition = EntityManager.GetArchetypeComposition(EntityManager.GetArchetypeForEntity(VehicleEntity));
+	if (!Composition.Tags.Contains<FMassTrafficVehicleTag>())
+	{
+		return false;
+	}
+
+	const FMassEntityView VehicleEntityView(EntityManager, VehicleEntity);
+
+	// Vehicles that are visible, towing a trailer or committed to the next lane stay materialised
+	const FMassTrafficSimulationLODFragment& SimulationLODFragment = VehicleEntityView.GetFragmentData<FMassTrafficSimulationLODFragment>();
+	if (SimulationLODFragment.LOD != EMassLOD::Off)
+	{
+		return false;
+	}
+
+	const FMassTrafficConstrainedTrailerFragment* ConstrainedTrailerFragment = VehicleEntityView.GetFragmentDataPtr<FMassTrafficConstrainedTrailerFragment>();
+	if (ConstrainedTrailerFragment && ConstrainedTrailerFragment->Trailer.IsSet())
+	{
+		return false;
+	}
+
+	FMassTrafficVehicleControlFragment& VehicleControlFragment = VehicleEntityView.GetFragmentData<FMassTrafficVehicleControlFragment>();
+	if (VehicleControlFragment.bCantStopAtLaneExit)
+	{
+		return false;
+	}
+
+	const FMassTrafficVehicleLaneChangeFragment* LaneChangeFragment = VehicleEntityView.GetFragmentDataPtr<FMassTrafficVehicleLaneChangeFragment>();
+	if (LaneChangeFragment && LaneChangeFragment->IsLaneChangeInProgress())
+	{
+		return false;
+	}
+
+	const FAgentRadiusFragment& RadiusFragment = VehicleEntityView.GetFragmentData<FAgentRadiusFragment>();
+	const FMassTrafficRandomFractionFragment& RandomFractionFragment = VehicleEntityView.GetFragmentData<FMassTrafficRandomFractionFragment>();
+	FMassTrafficNextVehicleFragment& NextVehicleFragment = VehicleEntityView.GetFragmentData<FMassTrafficNextVehicleFragment>();
+
+	// Vehicles whose entries in Vehicles haven't been refreshed since they left the lane are left to their new lane
+	if (VehicleEntityView.GetFragmentData<FMassZoneGraphLaneLocationFragment>().LaneHandle != TrafficLaneData.LaneHandle)
+	{
+		return false;
+	}
+
+	const FMassEntityHandle NextVehicle = NextVehicleFragment.GetNextVehicle();
+	const bool bHasValidNextVehicle = NextVehicle.IsSet() && EntityManager.IsEntityValid(NextVehicle);
+	if (bIsTailVehicle)
+	{
+		// Remove vehicle from the tail of its lane
+		if (bHasValidNextVehicle && EntityManager.GetFragmentDataChecked<FMassZoneGraphLaneLocationFragment>(NextVehicle).LaneHandle == TrafficLaneData.LaneHandle)
+		{
+			TrafficLaneData.TailVehicle = NextVehicle;
+		}
+		else
+		{
+			TrafficLaneData.TailVehicle = FMassEntityHandle();
+		}
+	}
+	else
+	{
+		// Link the vehicle behind straight to the vehicle ahead, which may be on the next lane
+		const FMassEntityHandle BehindVehicle = TrafficLaneData.Vehicles[VehicleIndex - 1].Entity;
+		FMassTrafficNextVehicleFragment& BehindNextVehicleFragment = EntityManager.GetFragmentDataChecked<FMassTrafficNextVehicleFragment>(BehindVehicle);
+		if (bHasValidNextVehicle && NextVehicle != BehindVehicle)
+		{
+			BehindNextVehicleFragment.SetNextVehicle(BehindVehicle, NextVehicle);
+		}
+		else
+		{
+			BehindNextVehicleFragment.UnsetNextVehicle();
+		}
+	}
+	TrafficLaneData.Vehicles.RemoveAt(VehicleIndex, 1, /*bAllowShrinking*/false);
+
+	TrafficLaneData.RemoveVehicleOccupancy(UE::MassTraffic::GetSpaceTakenByVehicleOnLane(RadiusFragment.Radius, RandomFractionFragment.RandomFraction, MassTrafficSettings->MinimumDistanceToNextVehicleRange));
+
+	if (VehicleControlFragment.NextLane)
+	{
+		--VehicleControlFragment.NextLane->NumVehiclesApproachingLane;
+		VehicleControlFragment.NextLane = nullptr;
+	}
+
+	NextVehicleFragment.UnsetNextVehicle();
+
+	// Vehicles at the end of incoming lanes may still be following a tail vehicle
+	IncomingLanes.Reset();
+	if (bIsTailVehicle)
+	{
+		ZoneGraphSubsystem.GetLinkedLanes(TrafficLaneData.LaneHandle, EZoneLaneLinkType::Incoming, EZoneLaneLinkFlags::All, EZoneLaneLinkFlags::None, IncomingLanes);
+	}
+	for (const FZoneGraphLinkedLane& IncomingLane : IncomingLanes)
+	{
+		const FZoneGraphLaneHandle IncomingLaneHandle(IncomingLane.DestLane, TrafficLaneData.LaneHandle.DataHandle);
+		if (const FZoneGraphTrafficLaneData* IncomingTrafficLaneData = MassTrafficSubsystem.GetTrafficLaneData(IncomingLaneHandle))
+		{
+			IncomingTrafficLaneData->ForEachVehicleOnLane(EntityManager, [VehicleEntity](const FMassEntityView&, FMassTrafficNextVehicleFragment& IncomingNextVehicleFragment, FMassZoneGraphLaneLocationFragment&)
+			{
+				if (IncomingNextVehicleFragment.GetNextVehicle() == VehicleEntity)
+				{
+					IncomingNextVehicleFragment.UnsetNextVehicle();
+					return false;
+				}
+
+				return true;
+			});
+		}
+	}
+
+	// Hand vehicle over to the far field flow
+	TrafficLaneData.AddFarFieldVehicles(1.0f, MassTrafficSettings->FarFieldVehicleSpacing);
+	MassTrafficSubsystem.GetMutableFarFieldVehicles().Add(VehicleEntity);
+
+	Context.Defer().SwapTags<FMassTrafficVehicleTag, FMassTrafficFarFieldVehicleTag>(VehicleEntity);
+
+	return true;
+}
+
+bool UMassTrafficFarFieldProcessor::MaterialiseVehicle(
+	FMassEntityManager& EntityManager,
+	FMassExecutionContext& Context,
+	const FZoneGraphStorage& ZoneGraphStorage,
+	UMassTrafficSubsystem& MassTrafficSubsystem,
+	FZoneGraphTrafficLaneData& TrafficLaneData) const
+{
+	// Find the most recently dematerialised vehicle that's allowed on this lane
+	TArray<FMassEntityHandle>& FarFieldVehicles = MassTrafficSubsystem.GetMutableFarFieldVehicles();
+	int32 FarFieldVehicleIndex = INDEX_NONE;
+	for (int32 Index = FarFieldVehicles.Num() - 1; Index >= 0; --Index)
+	{
+		if (!EntityManager.IsEntityValid(FarFieldVehicles[Index]))
+		{
+			FarFieldVehicles.RemoveAtSwap(Index, 1, /*bAllowShrinking*/false);
+			continue;
+		}
+
+		const FMassTrafficVehicleControlFragment& CandidateVehicleControlFragment = EntityManager.GetFragmentDataChecked<FMassTrafficVehicleControlFragment>(FarFieldVehicles[Index]);
+		if (!CandidateVehicleControlFragment.bRestrictedToTrunkLanesOnly || TrafficLaneData.ConstData.bIsTrunkLane)
+		{
+			FarFieldVehicleIndex = Index;
+			break;
+		}
+	}
+
+	if (FarFieldVehicleIndex == INDEX_NONE)
+	{
+		return false;
+	}
+
+	const FMassEntityHandle VehicleEntity = FarFieldVehicles[FarFieldVehicleIndex];
+	const FMassEntityView VehicleEntityView(EntityManager, VehicleEntity);
+
+	const FAgentRadiusFragment& RadiusFragment = VehicleEntityView.GetFragmentData<FAgentRadiusFragment>();
+	const FMassTrafficRandomFractionFragment& RandomFractionFragment = VehicleEntityView.GetFragmentData<FMassTrafficRandomFractionFragment>();
+
+	// Wait for space to open up at the start of the lane
+	const float SpaceTakenByVehicle = UE::MassTraffic::GetSpaceTakenByVehicleOnLane(RadiusFragment.Radius, RandomFractionFragment.RandomFraction, MassTrafficSettings->MinimumDistanceToNextVehicleRange);
+	if (TrafficLaneData.SpaceAvailableFromStartOfLaneForVehicle(EntityManager, /*bCheckLaneChangeGhostVehicles*/true, /*bCheckSplittingAndMergingGhostTailVehicles*/true) < SpaceTakenByVehicle)
+	{
+		return false;
+	}
+
+	FarFieldVehicles.RemoveAtSwap(FarFieldVehicleIndex, 1, /*bAllowShrinking*/false);
+
+	FMassTrafficVehicleControlFragment& VehicleControlFragment = VehicleEntityView.GetFragmentData<FMassTrafficVehicleControlFragment>();
+	FMassTrafficNextVehicleFragment& NextVehicleFragment = VehicleEntityView.GetFragmentData<FMassTrafficNextVehicleFragment>();
+	FMassZoneGraphLaneLocationFragment& LaneLocationFragment = VehicleEntityView.GetFragmentData<FMassZoneGraphLaneLocationFragment>();
+	FMassTrafficObstacleAvoidanceFragment& AvoidanceFragment = VehicleEntityView.GetFragmentData<FMassTrafficObstacleAvoidanceFragment>();
+	FMassTrafficInterpolationFragment& InterpolationFragment = VehicleEntityView.GetFragmentData<FMassTrafficInterpolationFragment>();
+	const FMassTrafficLaneOffsetFragment& LaneOffsetFragment = VehicleEntityView.GetFragmentData<FMassTrafficLaneOffsetFragment>();
+	FTransformFragment& TransformFragment = VehicleEntityView.GetFragmentData<FTransformFragment>();
+	FMassRepresentationFragment& RepresentationFragment = VehicleEntityView.GetFragmentData<FMassRepresentationFragment>();
+
+	const float DistanceAlongLane = RadiusFragment.Radius;
+
+	// Break any stale NextVehicle references to this vehicle on the lane, so it can't end up following itself.
+	// (See TeleportVehicleToAnotherLane.)
+	TrafficLaneData.ForEachVehicleOnLane(EntityManager, [VehicleEntity](const FMassEntityView&, FMassTrafficNextVehicleFragment& LaneNextVehicleFragment, FMassZoneGraphLaneLocationFragment&)
+	{
+		if (LaneNextVehicleFragment.GetNextVehicle() == VehicleEntity)
+		{
+			LaneNextVehicleFragment.UnsetNextVehicle();
+			return false;
+		}
+
+		return true;
+	});
+
+	// Insert vehicle as the new lane tail
+	const FMassEntityHandle VehicleAhead = TrafficLaneData.TailVehicle;
+	AvoidanceFragment.DistanceToNext = TNumericLimits<float>::Max();
+	if (VehicleAhead.IsSet() && EntityManager.IsEntityValid(VehicleAhead))
+	{
+		NextVehicleFragment.SetNextVehicle(VehicleEntity, VehicleAhead);
+
+		const FMassEntityView VehicleAheadEntityView(EntityManager, VehicleAhead);
+		const float DistanceAlongLaneAhead = VehicleAheadEntityView.GetFragmentData<FMassZoneGraphLaneLocationFragment>().DistanceAlongLane;
+		const float RadiusAhead = VehicleAheadEntityView.GetFragmentData<FAgentRadiusFragment>().Radius;
+		AvoidanceFragment.DistanceToNext = FMath::Max(DistanceAlongLaneAhead - DistanceAlongLane - RadiusAhead - RadiusFragment.Radius, 0.0f);
+	}
+	else
+	{
+		NextVehicleFragment.UnsetNextVehicle();
+	}
+
+	TrafficLaneData.TailVehicle = VehicleEntity;
+	TrafficLaneData.AddTailVehicle(VehicleEntity, DistanceAlongLane, RadiusFragment.Radius);
+	TrafficLaneData.AddVehicleOccupancy(SpaceTakenByVehicle);
+
+	VehicleControlFragment.CurrentLaneConstData = TrafficLaneData.ConstData;
+	VehicleControlFragment.PreviousLaneIndex = INDEX_NONE;
+	VehicleControlFragment.Speed = GetFarFieldFreeFlowSpeed(TrafficLaneData) * (1.0f - GetFarFieldOccupancy(TrafficLaneData));
+
+	LaneLocationFragment.LaneHandle = TrafficLaneData.LaneHandle;
+	LaneLocationFragment.DistanceAlongLane = DistanceAlongLane;
+	LaneLocationFragment.LaneLength = TrafficLaneData.Length;
+
+	// As in TeleportVehicleToAnotherLane, pre-set the next lane if there is only one choice
+	if (TrafficLaneData.NextLanes.Num() == 1)
+	{
+		VehicleControlFragment.NextLane = TrafficLaneData.NextLanes[0];
+		++VehicleControlFragment.NextLane->NumVehiclesApproachingLane;
+	}
+
+	// Snap to the lane start, with no previous transform to interpolate or compute velocity from
+	FTransform LaneTransform;
+	UE::MassTraffic::InterpolatePositionAndOrientationAlongLane(
+		ZoneGraphStorage,
+		MassTrafficSubsystem.GetLaneSegmentTable(TrafficLaneData.LaneHandle.DataHandle),
+		TrafficLaneData.LaneHandle.Index,
+		DistanceAlongLane,
+		ETrafficVehicleMovementInterpolationMethod::CubicBezier,
+		InterpolationFragment.LaneLocationLaneSegment,
+		LaneTransform);
+	LaneTransform.AddToTranslation(LaneTransform.GetRotation().GetRightVector() * LaneOffsetFragment.LateralOffset);
+
+	TransformFragment.SetTransform(LaneTransform);
+	RepresentationFragment.PrevTransform = LaneTransform;
+	if (FMassTrafficPreviousTransformFragment* PreviousTransformFragment = VehicleEntityView.GetFragmentDataPtr<FMassTrafficPreviousTransformFragment>())
+	{
+		PreviousTransformFragment->Transform = LaneTransform;
+		PreviousTransformFragment->Step = INDEX_NONE;
+	}
+
+	Context.Defer().SwapTags<FMassTrafficFarFieldVehicleTag, FMassTrafficVehicleTag>(VehicleEntity);
+
+	return true;
+}
@@ -79,6 +79,25 @@ void UMassTrafficFieldComponent::PerformFieldOperation(TSubclassOf<UMassTrafficF
 	}
 }
 
+bool UMassTrafficFieldComponent::CanPerformFieldOperationInParallel(TSubclassOf<UMassTrafficFieldOperationBase> OperationType) const
+{
+	bool bHasOperation = false;
+	for (const UMassTrafficFieldOperationBase* Operation : Operations)
+	{
+		if (Operation && Operation->IsA(OperationType))
+		{
+			if (!Operation->CanExecuteInParallel())
+			{
+				return false;
+			}
+
+			bHasOperation = true;
+		}
+	}
+
+	return bHasOperation;
+}
+
 FPrimitiveSceneProxy* UMassTrafficFieldComponent::CreateSceneProxy() 
 {
 	return new FMassTrafficFieldSceneProxy( *this );
@@ -107,6 +126,7 @@ void UMassTrafficFieldComponent::UpdateOverlappedLanes(UMassTrafficSubsystem& Ma
 	const FBox QueryBounds = Bounds.GetBox();
 	TArray<FZoneGraphLaneHandle> ZoneGraphLanes;
 	ZoneGraphSubsystem->FindOverlappingLanes(QueryBounds, LaneTagFilter, ZoneGraphLanes);
+	OverlappedLanesQueryBounds = QueryBounds;
 	
 	for (const FZoneGraphLaneHandle LaneHandle : ZoneGraphLanes)
 	{
@@ -116,6 +136,21 @@ void UMassTrafficFieldComponent::UpdateOverlappedLanes(UMassTrafficSubsystem& Ma
 			TrafficLanes.Add(TrafficLaneData);
 		}
 	}
+
+	MassTrafficSubsystem.InvalidateFieldBatches();
+}
+
+bool UMassTrafficFieldComponent::UpdateOverlapsIfMoved(UMassTrafficSubsystem& MassTrafficSubsystem)
+{
+	if (Bounds.GetBox() == OverlappedLanesQueryBounds)
+	{
+		return false;
+	}
+
+	UpdateOverlappedLanes(MassTrafficSubsystem);
+	UpdateOverlappedIntersections(MassTrafficSubsystem);
+
+	return true;
 }
 
 void UMassTrafficFieldComponent::OnTrafficLaneDataChanged(UMassTrafficSubsystem* MassTrafficSubsystem)
@@ -129,7 +164,7 @@ void UMassTrafficFieldComponent::OnTrafficLaneDataChanged(UMassTrafficSubsystem*
 	UpdateOverlappedLanes(*MassTrafficSubsystem);
 }
 
-void UMassTrafficFieldComponent::UpdateOverlappedIntersections(const UMassTrafficSubsystem& MassTrafficSubsystem)
+void UMassTrafficFieldComponent::UpdateOverlappedIntersections(UMassTrafficSubsystem& MassTrafficSubsystem)
 {
 	TRACE_CPUPROFILER_EVENT_SCOPE(TEXT("MassTrafficFieldComponent Find Overlapped Lanes"))
 	
@@ -155,6 +190,8 @@ void UMassTrafficFieldComponent::UpdateOverlappedIntersections(const UMassTraffi
 			}
 		}
 	}
+
+	MassTrafficSubsystem.InvalidateFieldBatches();
 }
 
 void UMassTrafficFieldComponent::OnPostInitTrafficIntersections(UMassTrafficSubsystem* MassTrafficSubsystem)
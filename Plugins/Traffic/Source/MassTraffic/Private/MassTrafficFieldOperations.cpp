@@ -154,6 +154,12 @@ void UMassTrafficForceTrafficVehicleViewerLODFieldOperation::Execute(FMassTraffi
 	}
 }
 
+bool UMassTrafficForceTrafficVehicleViewerLODFieldOperation::CanExecuteInParallel() const
+{
+	// Debug drawing isn't thread safe
+	return !GMassTrafficDebugViewerLOD;
+}
+
 void UMassTrafficSetLaneSpeedLimitFieldOperation::Execute(FMassTrafficFieldOperationContext& Context)
 {
 	float SpeedLimit = Chaos::MPHToCmS(SpeedLimitMPH);
@@ -269,7 +275,7 @@ void UMassTrafficFrameStartFieldOperationsProcessor::ConfigureQueries()
 
 void UMassTrafficFrameStartFieldOperationsProcessor::Execute(FMassEntityManager& EntityManager, FMassExecutionContext& Context)
 {
-	// Re-cache lanes & intersections for Movable traffic fields
+	// Re-cache lanes & intersections for Movable traffic fields that have moved
 	{
 		TRACE_CPUPROFILER_EVENT_SCOPE(TEXT("UpdateMovableTrafficFields"))
 
@@ -280,8 +286,7 @@ void UMassTrafficFrameStartFieldOperationsProcessor::Execute(FMassEntityManager&
 		{
 			if (Field->Mobility == EComponentMobility::Movable && Field->bEnabled)
 			{
-				Field->UpdateOverlappedLanes(TrafficSubsystem);
-				Field->UpdateOverlappedIntersections(TrafficSubsystem);
+				Field->UpdateOverlapsIfMoved(TrafficSubsystem);
 			}
 		}
 	}
@@ -1,9 +1,11 @@
 // Copyright Epic Games, Inc. All Rights Reserved.
 
 #include "MassTrafficFindDeviantTrafficVehiclesProcessor.h"
+#include "MassTrafficEntityTransitionBatch.h"
 #include "MassTrafficFragments.h"
 #include "MassTrafficInterpolation.h"
 #include "MassTrafficLaneChange.h"
+#include "MassTrafficSubsystem.h"
 #include "MassTrafficUpdateVelocityProcessor.h"
 
 #include "MassNavigationTypes.h"
@@ -51,6 +53,7 @@ void UMassTrafficFindDeviantTrafficVehiclesProcessor::ConfigureQueries()
 	NominalTrafficVehicleEntityQuery.AddRequirement<FAgentRadiusFragment>(EMassFragmentAccess::ReadOnly);
 	NominalTrafficVehicleEntityQuery.AddConstSharedRequirement<FMassTrafficVehicleSimulationParameters>();
 	NominalTrafficVehicleEntityQuery.AddSubsystemRequirement<UZoneGraphSubsystem>(EMassFragmentAccess::ReadOnly);
+	NominalTrafficVehicleEntityQuery.AddSubsystemRequirement<UMassTrafficSubsystem>(EMassFragmentAccess::ReadOnly);
 
 	// Known deviant physics vehicles which we check for correction
 	DeviantTrafficVehicleEntityQuery.AddTagRequirement<FMassTrafficObstacleTag>(EMassFragmentPresence::All);
@@ -63,6 +66,7 @@ void UMassTrafficFindDeviantTrafficVehiclesProcessor::ConfigureQueries()
 	DeviantTrafficVehicleEntityQuery.AddRequirement<FMassTrafficVehicleLaneChangeFragment>(EMassFragmentAccess::ReadOnly);
 	DeviantTrafficVehicleEntityQuery.AddRequirement<FMassTrafficInterpolationFragment>(EMassFragmentAccess::ReadWrite);
 	DeviantTrafficVehicleEntityQuery.AddSubsystemRequirement<UZoneGraphSubsystem>(EMassFragmentAccess::ReadOnly);
+	DeviantTrafficVehicleEntityQuery.AddSubsystemRequirement<UMassTrafficSubsystem>(EMassFragmentAccess::ReadOnly);
 	DeviantTrafficVehicleEntityQuery.AddSubsystemRequirement<UMassNavigationSubsystem>(EMassFragmentAccess::ReadWrite);
 
 	// Implicitly corrected vehicles (low LOD vehicles can't deviate)
@@ -74,36 +78,57 @@ void UMassTrafficFindDeviantTrafficVehiclesProcessor::ConfigureQueries()
 	CorrectedTrafficVehicleEntityQuery.AddSubsystemRequirement<UMassNavigationSubsystem>(EMassFragmentAccess::ReadWrite);
 }
 
-static void RemoveDeviantFragments(const FMassEntityManager& EntityManager, const FMassExecutionContext& Context, UMassNavigationSubsystem& MovementSubsystem, const int32 Index)
+// Deviant vehicles have an FMassTrafficObstacleTag so they're considered for obstacle avoidance
+static const FMassTrafficEntityTransition& GetBecomeDeviantTransition()
+{
+	static const FMassTrafficEntityTransition BecomeDeviantTransition = FMassTrafficEntityTransition()
+		.AddTags<FMassTrafficObstacleTag, FMassLookAtTargetTag>()
+		.AddFragments<
+			FMassNavigationObstacleGridCellLocationFragment		// Needed to become an avoidance obstacle
+			, FMassCrowdObstacleFragment						// Needed to be a zone graph dynamic obstacle
+			, FMassAvoidanceColliderFragment>();
+	return BecomeDeviantTransition;
+}
+
+static const FMassTrafficEntityTransition& GetNoLongerDeviantTransition()
+{
+	static const FMassTrafficEntityTransition NoLongerDeviantTransition = FMassTrafficEntityTransition()
+		.RemoveTags<FMassTrafficObstacleTag, FMassLookAtTargetTag>()
+		.RemoveFragments<
+			FMassNavigationObstacleGridCellLocationFragment	// Not an avoidance obstacle anymore
+			, FMassCrowdObstacleFragment					// Not a zone graph dynamic obstacle anymore
+			, FMassAvoidanceColliderFragment>();
+	return NoLongerDeviantTransition;
+}
+
+static void RemoveDeviantFragments(const FMassEntityManager& EntityManager, const FMassExecutionContext& Context, UMassNavigationSubsystem& MovementSubsystem, const int32 Index, FMassTrafficEntityTransitionBatch& EntityTransitionBatch)
 {
 	// This vehicle is no longer deviant, remove the FTagFragment_MassTrafficObstacle tag from it so it's
 	// no longer considered for obstacle avoidance.
 	const FMassEntityHandle Entity = Context.GetEntity(Index);
-	Context.Defer().RemoveTag<FMassTrafficObstacleTag>(Entity);
-	Context.Defer().RemoveTag<FMassLookAtTargetTag>(Entity);
 
 	// Manually do the work of UMassAvoidanceObstacleRemoverFragmentDestructor because it's not called on fragment removal.
 	const FMassEntityView EntityView(EntityManager, Entity);
-	if (const FMassNavigationObstacleGridCellLocationFragment* GridCellLocationList = EntityView.GetFragmentDataPtr<FMassNavigationObstacleGridCellLocationFragment>())
+	if (const FMassNavigationObstacleGridCellLocationFragment* GridCellLocation = EntityView.GetFragmentDataPtr<FMassNavigationObstacleGridCellLocationFragment>())
 	{
 		FMassNavigationObstacleItem ObstacleItem;
 		ObstacleItem.Entity = Entity;
-		MovementSubsystem.GetObstacleGridMutable().Remove(ObstacleItem, GridCellLocationList[Index].CellLoc);
+		MovementSubsystem.GetObstacleGridMutable().Remove(ObstacleItem, GridCellLocation->CellLoc);
 	}
 
-	Context.Defer().PushCommand<FMassCommandRemoveFragments<
-		FMassNavigationObstacleGridCellLocationFragment	// Not an avoidance obstacle anymore
-		, FMassCrowdObstacleFragment					// Not a zone graph dynamic obstacle anymore
-		, FMassAvoidanceColliderFragment>>
-		(Entity);
+	EntityTransitionBatch.AddTransition(GetNoLongerDeviantTransition(), Entity);
 }
 
 void UMassTrafficFindDeviantTrafficVehiclesProcessor::Execute(FMassEntityManager& EntityManager, FMassExecutionContext& Context)
 {
+	// Vehicles becoming or ceasing to be deviant are all moved between archetypes together, once we're done
+	FMassTrafficEntityTransitionBatch EntityTransitionBatch;
+
 	// Look for deviant vehicles
 	NominalTrafficVehicleEntityQuery.ForEachEntityChunk(EntityManager, Context, [&, World = EntityManager.GetWorld()](FMassExecutionContext& QueryContext)
 	{
 		const UZoneGraphSubsystem& ZoneGraphSubsystem = QueryContext.GetSubsystemChecked<UZoneGraphSubsystem>(World);
+		const UMassTrafficSubsystem& MassTrafficSubsystem = QueryContext.GetSubsystemChecked<UMassTrafficSubsystem>(World);
 
 		const FMassTrafficVehicleSimulationParameters& SimulationParams = QueryContext.GetConstSharedFragment<FMassTrafficVehicleSimulationParameters>();
 		const TConstArrayView<FMassActorFragment> ActorFragments = QueryContext.GetFragmentView<FMassActorFragment>();
@@ -140,7 +165,7 @@ void UMassTrafficFindDeviantTrafficVehiclesProcessor::Execute(FMassEntityManager
 
 				// Get pure lane location
 				FTransform LaneLocationTransform;
-				UE::MassTraffic::InterpolatePositionAndOrientationAlongLane(*ZoneGraphStorage, ZoneGraphLaneLocationFragment.LaneHandle.Index, ZoneGraphLaneLocationFragment.DistanceAlongLane, ETrafficVehicleMovementInterpolationMethod::Linear, VehicleMovementInterpolationFragment.LaneLocationLaneSegment, LaneLocationTransform);
+				UE::MassTraffic::InterpolatePositionAndOrientationAlongLane(*ZoneGraphStorage, MassTrafficSubsystem.GetLaneSegmentTable(ZoneGraphLaneLocationFragment.LaneHandle.DataHandle), ZoneGraphLaneLocationFragment.LaneHandle.Index, ZoneGraphLaneLocationFragment.DistanceAlongLane, ETrafficVehicleMovementInterpolationMethod::Linear, VehicleMovementInterpolationFragment.LaneLocationLaneSegment, LaneLocationTransform);
 				
 				// Apply lateral offset
 				LaneLocationTransform.AddToTranslation(LaneLocationTransform.GetRotation().GetRightVector() * LaneOffsetFragment.LateralOffset);
@@ -163,17 +188,9 @@ void UMassTrafficFindDeviantTrafficVehiclesProcessor::Execute(FMassEntityManager
 					// This vehicle is deviant, add an FTagFragment_MassTrafficObstacle tag to it so it's
 					// considered for obstacle avoidance.
 					const FMassEntityHandle Entity = QueryContext.GetEntity(Index);
-					QueryContext.Defer().AddTag<FMassTrafficObstacleTag>(Entity);
-					QueryContext.Defer().AddTag<FMassLookAtTargetTag>(Entity);
-
-					QueryContext.Defer().PushCommand<FMassCommandAddFragments<
-						FMassNavigationObstacleGridCellLocationFragment		// Needed to become an avoidance obstacle
-						, FMassCrowdObstacleFragment>>						// Needed to be a zone graph dynamic obstacle
-						(Entity);
-
 					FMassPillCollider Pill(SimulationParams.HalfWidth, SimulationParams.HalfLength);
-					FMassAvoidanceColliderFragment ColliderFragment(Pill);
-					QueryContext.Defer().PushCommand<FMassCommandAddFragmentInstances>(Entity, ColliderFragment);
+					const FInstancedStruct ColliderFragment = FInstancedStruct::Make(FMassAvoidanceColliderFragment(Pill));
+					EntityTransitionBatch.AddTransition(GetBecomeDeviantTransition(), Entity, MakeArrayView(&ColliderFragment, 1));
 
 					// Debug
 					UE_VLOG_LOCATION(LogOwner, TEXT("MassTraffic Deviants"), Log, ActorLocation, 10.0f, FColor::Red, TEXT("%d Deviated by %f"), QueryContext.GetEntity(Index).Index, Deviation);
@@ -188,6 +205,7 @@ void UMassTrafficFindDeviantTrafficVehiclesProcessor::Execute(FMassEntityManager
 	{
 		UMassNavigationSubsystem& NavigationSubsystem = QueryContext.GetMutableSubsystemChecked<UMassNavigationSubsystem>(World);
 		const UZoneGraphSubsystem& ZoneGraphSubsystem = QueryContext.GetSubsystemChecked<UZoneGraphSubsystem>(World);
+		const UMassTrafficSubsystem& MassTrafficSubsystem = QueryContext.GetSubsystemChecked<UMassTrafficSubsystem>(World);
 
 		const TConstArrayView<FMassZoneGraphLaneLocationFragment> ZoneGraphLaneLocationFragments = QueryContext.GetFragmentView<FMassZoneGraphLaneLocationFragment>();
 		const TConstArrayView<FMassTrafficLaneOffsetFragment> LaneOffsetFragments = QueryContext.GetFragmentView<FMassTrafficLaneOffsetFragment>();
@@ -221,7 +239,7 @@ void UMassTrafficFindDeviantTrafficVehiclesProcessor::Execute(FMassEntityManager
 
 				// Get pure lane location
 				FTransform LaneLocationTransform;
-				UE::MassTraffic::InterpolatePositionAndOrientationAlongLane(*ZoneGraphStorage, ZoneGraphLaneLocationFragment.LaneHandle.Index, ZoneGraphLaneLocationFragment.DistanceAlongLane, ETrafficVehicleMovementInterpolationMethod::Linear, VehicleMovementInterpolationFragment.LaneLocationLaneSegment, LaneLocationTransform);
+				UE::MassTraffic::InterpolatePositionAndOrientationAlongLane(*ZoneGraphStorage, MassTrafficSubsystem.GetLaneSegmentTable(ZoneGraphLaneLocationFragment.LaneHandle.DataHandle), ZoneGraphLaneLocationFragment.LaneHandle.Index, ZoneGraphLaneLocationFragment.DistanceAlongLane, ETrafficVehicleMovementInterpolationMethod::Linear, VehicleMovementInterpolationFragment.LaneLocationLaneSegment, LaneLocationTransform);
 				
 				// Apply lateral offset
 				LaneLocationTransform.AddToTranslation(LaneLocationTransform.GetRotation().GetRightVector() * LaneOffsetFragment.LateralOffset);
@@ -249,7 +267,7 @@ void UMassTrafficFindDeviantTrafficVehiclesProcessor::Execute(FMassEntityManager
 
 			if (!bDeviant)
 			{
-				RemoveDeviantFragments(EntityManager, QueryContext, NavigationSubsystem, Index);
+				RemoveDeviantFragments(EntityManager, QueryContext, NavigationSubsystem, Index, EntityTransitionBatch);
 			}
 		}
 	});
@@ -262,7 +280,9 @@ void UMassTrafficFindDeviantTrafficVehiclesProcessor::Execute(FMassEntityManager
 		const int32 NumEntities = QueryContext.GetNumEntities();
 		for (int32 Index = 0; Index < NumEntities; ++Index)
 		{
-			RemoveDeviantFragments(EntityManager, QueryContext, NavigationSubsystem, Index);
+			RemoveDeviantFragments(EntityManager, QueryContext, NavigationSubsystem, Index, EntityTransitionBatch);
 		}
 	});
+
+	EntityTransitionBatch.Defer(Context.Defer());
 }
\ No newline at end of file
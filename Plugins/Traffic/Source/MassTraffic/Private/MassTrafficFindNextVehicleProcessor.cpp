@@ -1,8 +1,10 @@
 // Copyright Epic Games, Inc. All Rights Reserved.
 
 #include "MassTrafficFindNextVehicleProcessor.h"
+#include "MassTrafficFieldOperations.h"
 #include "MassTrafficFragments.h"
-#include "MassEntityView.h"
+#include "MassTrafficMovement.h"
+#include "MassCommonFragments.h"
 #include "MassZoneGraphNavigationFragments.h"
 
 
@@ -15,7 +17,10 @@ UMassTrafficFindNextVehicleProcessor::UMassTrafficFindNextVehicleProcessor()
 void UMassTrafficFindNextVehicleProcessor::ConfigureQueries()
 {
 	EntityQuery.AddRequirement<FMassZoneGraphLaneLocationFragment>(EMassFragmentAccess::ReadOnly);
+	EntityQuery.AddRequirement<FAgentRadiusFragment>(EMassFragmentAccess::ReadOnly);
 	EntityQuery.AddRequirement<FMassTrafficNextVehicleFragment>(EMassFragmentAccess::ReadWrite);
+	// Dematerialised far field vehicles keep their last lane location, but aren't on any lane
+	EntityQuery.AddTagRequirement<FMassTrafficFarFieldVehicleTag>(EMassFragmentPresence::None);
 	EntityQuery.AddSubsystemRequirement<UMassTrafficSubsystem>(EMassFragmentAccess::ReadWrite);
 
 	ProcessorRequirements.AddSubsystemRequirement<UMassTrafficSubsystem>(EMassFragmentAccess::ReadWrite);
@@ -35,128 +40,35 @@ void UMassTrafficFindNextVehicleProcessor::Execute(FMassEntityManager& EntityMan
 			AllVehicles.Add(QueryContext.GetEntity(Index));
 		}
 	});
-	if (AllVehicles.IsEmpty())
-	{
-		return;
-	}
-
-	// Sort first by lane, and then by distance
-	AllVehicles.Sort(
-		[&EntityManager](const FMassEntityHandle& EntityA, const FMassEntityHandle& EntityB)
-		{
-			const FMassZoneGraphLaneLocationFragment& A = EntityManager.GetFragmentDataChecked<FMassZoneGraphLaneLocationFragment>(EntityA);
-			const FMassZoneGraphLaneLocationFragment& B = EntityManager.GetFragmentDataChecked<FMassZoneGraphLaneLocationFragment>(EntityB);
-
-			if (A.LaneHandle == B.LaneHandle)
-			{
-				return A.DistanceAlongLane < B.DistanceAlongLane;
-			}
-			else if (A.LaneHandle.DataHandle == B.LaneHandle.DataHandle)
-			{
-				return A.LaneHandle.Index < B.LaneHandle.Index;
-			}
-			else
-			{
-				return A.LaneHandle.DataHandle.Index < B.LaneHandle.DataHandle.Index;
-			}
-		}
-	);
 
-	// Set Next pointers
-	bool bTail = true;
-	for (int32 Index = 0; Index < AllVehicles.Num() - 1; ++Index)
-	{
-		const FMassEntityHandle& VehicleEntity = AllVehicles[Index];
-		FMassEntityView VehicleEntityView(EntityManager, VehicleEntity);
-		FMassZoneGraphLaneLocationFragment& LaneLocationFragment = VehicleEntityView.GetFragmentData<FMassZoneGraphLaneLocationFragment>();
-		FMassTrafficNextVehicleFragment& NextVehicleFragment = VehicleEntityView.GetFragmentData<FMassTrafficNextVehicleFragment>();
-		
-		const FMassEntityHandle& NextVehicleEntity = AllVehicles[Index+1];
-		const FMassZoneGraphLaneLocationFragment& NextLaneLocationFragment = EntityManager.GetFragmentDataChecked<FMassZoneGraphLaneLocationFragment>(NextVehicleEntity);
-
-		// First in lane? 
-		if (bTail)
-		{
-			if (FZoneGraphTrafficLaneData* TrafficLaneData = MassTrafficSubsystem.GetMutableTrafficLaneData(LaneLocationFragment.LaneHandle))
-			{
-				TrafficLaneData->TailVehicle = VehicleEntity;
-			}
-			bTail = false;
-		}
+	UE::MassTraffic::RebuildLaneVehicles(EntityManager, MassTrafficSubsystem, AllVehicles);
+}
 
-		if (LaneLocationFragment.LaneHandle == NextLaneLocationFragment.LaneHandle)
-		{
-			NextVehicleFragment.SetNextVehicle(VehicleEntity, NextVehicleEntity);
-		}
-		else
-		{
-			NextVehicleFragment.UnsetNextVehicle();
 
-			bTail = true;
-		}
-	}
+UMassTrafficRefreshLaneVehiclesProcessor::UMassTrafficRefreshLaneVehiclesProcessor()
+{
+	bAutoRegisterWithProcessingPhases = true;
+	ExecutionOrder.ExecuteInGroup = UE::MassTraffic::ProcessorGroupNames::FrameStart;
+	ExecutionOrder.ExecuteBefore.Add(UMassTrafficFrameStartFieldOperationsProcessor::StaticClass()->GetFName());
+}
 
-	// Process last in list
-	const FMassEntityHandle& LastVehicleEntity = AllVehicles.Last();
-	const FMassEntityView LastVehicleEntityView(EntityManager, LastVehicleEntity);
-	const FMassZoneGraphLaneLocationFragment& LastLaneLocationFragment = LastVehicleEntityView.GetFragmentData<FMassZoneGraphLaneLocationFragment>();
-	FMassTrafficNextVehicleFragment& LastNextVehicleFragment = LastVehicleEntityView.GetFragmentData<FMassTrafficNextVehicleFragment>();
+void UMassTrafficRefreshLaneVehiclesProcessor::ConfigureQueries()
+{
+	ProcessorRequirements.AddSubsystemRequirement<UMassTrafficSubsystem>(EMassFragmentAccess::ReadWrite);
+}
 
-	// Last in list, implicitly has no next vehicle
-	LastNextVehicleFragment.UnsetNextVehicle();
+void UMassTrafficRefreshLaneVehiclesProcessor::Execute(FMassEntityManager& EntityManager, FMassExecutionContext& Context)
+{
+	UMassTrafficSubsystem& MassTrafficSubsystem = Context.GetMutableSubsystemChecked<UMassTrafficSubsystem>(EntityManager.GetWorld());
 
-	// It may be first in its lane though?
-	if (bTail)
-	{
-		if (FZoneGraphTrafficLaneData* TrafficLaneData = MassTrafficSubsystem.GetMutableTrafficLaneData(LastLaneLocationFragment.LaneHandle))
-		{
-			TrafficLaneData->TailVehicle = LastVehicleEntity;
-		}
-	}
-	
-	// Now that all the vehicles have been assigned to their lanes, go through and connect the last vehicle on each
-	// lane to the closest first vehicle in the next connected lanes 
-	EntityQuery.ForEachEntityChunk(EntityManager, Context, [&, World = EntityManager.GetWorld()](FMassExecutionContext& QueryContext)
+	for (FMassTrafficZoneGraphData* TrafficZoneGraphData : MassTrafficSubsystem.GetMutableTrafficZoneGraphData())
 	{
-		const UMassTrafficSubsystem& MassTrafficSubsystem = QueryContext.GetSubsystemChecked<UMassTrafficSubsystem>(World);
-		const int32 NumEntities = QueryContext.GetNumEntities();
-		const TConstArrayView<FMassZoneGraphLaneLocationFragment> LaneLocationFragments = QueryContext.GetFragmentView<FMassZoneGraphLaneLocationFragment>();
-		const TArrayView<FMassTrafficNextVehicleFragment> NextVehicleFragments = QueryContext.GetMutableFragmentView<FMassTrafficNextVehicleFragment>();
-
-		for (int32 Index = 0; Index < NumEntities; ++Index)
+		for (FZoneGraphTrafficLaneData& TrafficLaneData : TrafficZoneGraphData->TrafficLaneDataArray)
 		{
-			const FMassZoneGraphLaneLocationFragment& LaneLocationFragment = LaneLocationFragments[Index];
-			FMassTrafficNextVehicleFragment& NextVehicleFragment = NextVehicleFragments[Index];
-        	
-			// Is this the last vehicle in it's lane?
-			if (!NextVehicleFragment.HasNextVehicle())
+			if (!TrafficLaneData.Vehicles.IsEmpty())
 			{
-				if (const FZoneGraphTrafficLaneData* TrafficLaneData = MassTrafficSubsystem.GetTrafficLaneData(LaneLocationFragment.LaneHandle))
-				{
-					// Find the closest tail vehicle across all connected lanes
-					FMassEntityHandle ClosestTail = FMassEntityHandle();
-					float ClosestTailDistance = TNumericLimits<float>::Max();
-	            	
-					for (const FZoneGraphTrafficLaneData* NextTrafficLaneData : TrafficLaneData->NextLanes)
-					{
-						if (NextTrafficLaneData->TailVehicle.IsSet())
-						{
-							const FMassZoneGraphLaneLocationFragment& TailVehicleLaneLocation = EntityManager.GetFragmentDataChecked<FMassZoneGraphLaneLocationFragment>(NextTrafficLaneData->TailVehicle);
-							if (TailVehicleLaneLocation.DistanceAlongLane < ClosestTailDistance)
-							{
-								ClosestTailDistance = TailVehicleLaneLocation.DistanceAlongLane; 
-								ClosestTail = NextTrafficLaneData->TailVehicle;
-							}
-						}
-					}
- 
-					if (ClosestTail.IsSet())
-					{
-						// Set the closest subsequent tail as this vehicles Next
-						NextVehicleFragment.SetNextVehicle(QueryContext.GetEntity(Index), ClosestTail);
-					}
-				}
+				TrafficLaneData.RefreshVehicles(EntityManager);
 			}
 		}
-	});
+	}
 }
@@ -5,10 +5,12 @@
 #include "MassTrafficDebugHelpers.h"
 #include "MassTrafficLaneChange.h"
 #include "MassTrafficMovement.h"
+#include "MassTrafficVehicleComponent.h"
 
 #include "MassEntityView.h"
 #include "MassCommandBuffer.h"
 #include "MassZoneGraphNavigationFragments.h"
+#include "Components/PrimitiveComponent.h"
 
 using namespace UE::MassTraffic;
 
@@ -595,12 +597,9 @@ bool FMassTrafficVehicleLaneChangeFragment::BeginLaneChangeProgression(
 }
 
 
-void FMassTrafficVehicleLaneChangeFragment::UpdateLaneChange(
+bool FMassTrafficVehicleLaneChangeFragment::UpdateLaneChange(
 	const float DeltaTimeSeconds,
-	FMassTrafficVehicleLightsFragment& VehicleLightsFragment_Current,
-	FMassTrafficNextVehicleFragment& NextVehicleFragment_Current,
 	const FMassZoneGraphLaneLocationFragment& ZoneGraphLaneLocationFragment_Current,
-	const FMassEntityManager& EntityManager,
 	const UMassTrafficSettings& MassTrafficSettings,
 	const FRandomStream& RandomStream
 )
@@ -610,7 +609,7 @@ void FMassTrafficVehicleLaneChangeFragment::UpdateLaneChange(
 	{
 		LaneChangeCountdownSeconds = MassTrafficSettings.MaxSecondsUntilLaneChangeDecision * RandomStream.FRand();
 		
-		return; // ..and avoid possible giant delta time that often goes along with a first update
+		return false; // ..and avoid possible giant delta time that often goes along with a first update
 	}
 
 	
@@ -626,9 +625,7 @@ void FMassTrafficVehicleLaneChangeFragment::UpdateLaneChange(
 		// lane changes are stopped externally when then lane ends.
 		if (ZoneGraphLaneLocationFragment_Current.DistanceAlongLane > DistanceAlongLane_Final_End)
 		{
-			EndLaneChangeProgression(VehicleLightsFragment_Current, NextVehicleFragment_Current, EntityManager);
-
-			SetLaneChangeCountdownSecondsToBeAtLeast(MassTrafficSettings, EMassTrafficLaneChangeCountdownSeconds::AsNewTryUsingSettings, RandomStream); // ..not handled by Reset()
+			return true;
 		}
 	}
 	else if (LaneChangeCountdownSeconds > 0.0f)
@@ -637,6 +634,8 @@ void FMassTrafficVehicleLaneChangeFragment::UpdateLaneChange(
 		
 		LaneChangeCountdownSeconds = LaneChangeCountdownSeconds - DeltaTimeSeconds;
 	}
+
+	return false;
 }
 
 
@@ -726,3 +725,38 @@ void FMassTrafficVehicleLaneChangeFragment::EndLaneChangeProgression(
 	TrafficLaneData_Initial = nullptr;
 	TrafficLaneData_Final = nullptr;
 }
+
+
+//
+// FMassTrafficVehicleActorComponentsFragment
+//
+
+
+void FMassTrafficVehicleActorComponentsFragment::Resolve(AActor& InActor)
+{
+	if (IsResolvedFor(&InActor))
+	{
+		return;
+	}
+
+	Actor = &InActor;
+	VehicleComponent = InActor.FindComponentByClass<UMassTrafficVehicleComponent>();
+
+	PrimitiveComponents.Reset();
+	InActor.ForEachComponent<UPrimitiveComponent>(/*bIncludeFromChildActors*/true, [this](UPrimitiveComponent* PrimitiveComponent)
+	{
+		PrimitiveComponents.Add(PrimitiveComponent);
+	});
+}
+
+void FMassTrafficVehicleActorComponentsFragment::SetCustomPrimitiveDataFloat(const int32 DataIndex, const float Value) const
+{
+	for (const TWeakObjectPtr<UPrimitiveComponent>& PrimitiveComponent : PrimitiveComponents)
+	{
+		if (UPrimitiveComponent* PrimitiveComponentPtr = PrimitiveComponent.Get())
+		{
+			PrimitiveComponentPtr->SetCustomPrimitiveDataFloat(DataIndex, Value);
+		}
+	}
+}
+
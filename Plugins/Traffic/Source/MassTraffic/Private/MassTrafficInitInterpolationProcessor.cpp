@@ -6,6 +6,7 @@
 #include "MassTrafficFragments.h"
 #include "MassTrafficInterpolation.h"
 #include "MassTrafficLaneChangingProcessor.h"
+#include "MassTrafficSubsystem.h"
 
 #include "DrawDebugHelpers.h"
 #include "MassZoneGraphNavigationFragments.h"
@@ -26,6 +27,7 @@ void UMassTrafficInitInterpolationProcessor::ConfigureQueries()
 	EntityQuery.AddRequirement<FMassTrafficInterpolationFragment>(EMassFragmentAccess::ReadWrite);
 	EntityQuery.AddRequirement<FTransformFragment>(EMassFragmentAccess::ReadWrite);
 	EntityQuery.AddSubsystemRequirement<UZoneGraphSubsystem>(EMassFragmentAccess::ReadOnly);
+	EntityQuery.AddSubsystemRequirement<UMassTrafficSubsystem>(EMassFragmentAccess::ReadOnly);
 }
 
 void UMassTrafficInitInterpolationProcessor::Execute(FMassEntityManager& EntityManager, FMassExecutionContext& Context)
@@ -33,6 +35,7 @@ void UMassTrafficInitInterpolationProcessor::Execute(FMassEntityManager& EntityM
 	EntityQuery.ForEachEntityChunk(EntityManager, Context, [&, World = EntityManager.GetWorld()](FMassExecutionContext& QueryContext)
 	{
 		const UZoneGraphSubsystem& ZoneGraphSubsystem = QueryContext.GetSubsystemChecked<UZoneGraphSubsystem>(World);
+		const UMassTrafficSubsystem& MassTrafficSubsystem = QueryContext.GetSubsystemChecked<UMassTrafficSubsystem>(World);
 
 		const int32 NumEntities = QueryContext.GetNumEntities();
 		const TConstArrayView<FMassZoneGraphLaneLocationFragment> LaneLocationFragments = QueryContext.GetFragmentView<FMassZoneGraphLaneLocationFragment>();
@@ -49,7 +52,7 @@ void UMassTrafficInitInterpolationProcessor::Execute(FMassEntityManager& EntityM
 			check(ZoneGraphStorage);
 			
 			// Interpolate initial transform
-			UE::MassTraffic::InterpolatePositionAndOrientationAlongLane(*ZoneGraphStorage, LaneLocationFragment.LaneHandle.Index, LaneLocationFragment.DistanceAlongLane, ETrafficVehicleMovementInterpolationMethod::Linear, VehicleMovementInterpolationFragment.LaneLocationLaneSegment, TransformFragment.GetMutableTransform());
+			UE::MassTraffic::InterpolatePositionAndOrientationAlongLane(*ZoneGraphStorage, MassTrafficSubsystem.GetLaneSegmentTable(LaneLocationFragment.LaneHandle.DataHandle), LaneLocationFragment.LaneHandle.Index, LaneLocationFragment.DistanceAlongLane, ETrafficVehicleMovementInterpolationMethod::Linear, VehicleMovementInterpolationFragment.LaneLocationLaneSegment, TransformFragment.GetMutableTransform());
 
 			// Debug
 			if (GMassTrafficDebugInterpolation)
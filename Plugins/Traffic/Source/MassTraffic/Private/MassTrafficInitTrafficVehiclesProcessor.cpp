@@ -29,6 +29,7 @@ void UMassTrafficInitTrafficVehiclesProcessor::ConfigureQueries()
 	EntityQuery.AddRequirement<FMassRepresentationFragment>(EMassFragmentAccess::ReadWrite);
 	EntityQuery.AddRequirement<FMassTrafficRandomFractionFragment>(EMassFragmentAccess::ReadWrite);
 	EntityQuery.AddRequirement<FMassTrafficVehicleControlFragment>(EMassFragmentAccess::ReadWrite);
+	EntityQuery.AddRequirement<FMassTrafficVehicleIdFragment>(EMassFragmentAccess::ReadWrite);
 	EntityQuery.AddRequirement<FMassZoneGraphLaneLocationFragment>(EMassFragmentAccess::ReadWrite);
 	EntityQuery.AddRequirement<FMassNetworkIDFragment>(EMassFragmentAccess::ReadWrite, EMassFragmentPresence::Optional);
 	EntityQuery.AddConstSharedRequirement<FMassTrafficVehicleSimulationParameters>();
@@ -86,6 +87,7 @@ void UMassTrafficInitTrafficVehiclesProcessor::Execute(FMassEntityManager& Entit
 		const FMassTrafficVehicleSimulationParameters& SimulationParams = QueryContext.GetConstSharedFragment<FMassTrafficVehicleSimulationParameters>();
 		const TArrayView<FMassRepresentationFragment> RepresentationFragments = QueryContext.GetMutableFragmentView<FMassRepresentationFragment>();
 		const TArrayView<FMassTrafficVehicleControlFragment> VehicleControlFragments = QueryContext.GetMutableFragmentView<FMassTrafficVehicleControlFragment>();
+		const TArrayView<FMassTrafficVehicleIdFragment> VehicleIdFragments = QueryContext.GetMutableFragmentView<FMassTrafficVehicleIdFragment>();
 		const TArrayView<FMassZoneGraphLaneLocationFragment> LaneLocationFragments = QueryContext.GetMutableFragmentView<FMassZoneGraphLaneLocationFragment>();
 		const TArrayView<FMassTrafficRandomFractionFragment> RandomFractionFragments = QueryContext.GetMutableFragmentView<FMassTrafficRandomFractionFragment>();
 		const TArrayView<FTransformFragment> TransformFragments = QueryContext.GetMutableFragmentView<FTransformFragment>();
@@ -100,6 +102,9 @@ void UMassTrafficInitTrafficVehiclesProcessor::Execute(FMassEntityManager& Entit
 			FMassTrafficRandomFractionFragment& RandomFractionFragment = RandomFractionFragments[Index];
 			FTransformFragment& TransformFragment = TransformFragments[Index];
 
+			// Spawn order ID, stable across runs unlike the entity handle
+			VehicleIdFragments[Index].VehicleId = MassTrafficSubsystem.GetNextVehicleId();
+
 			// Init random fraction
 			RandomFractionFragment.RandomFraction = RandomStream.GetFraction();
 
@@ -8,6 +8,75 @@
 #include "BezierUtilities.h"
 
 
+void FMassTrafficLaneSegmentTable::Build(const FZoneGraphStorage& ZoneGraphStorage)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(TEXT("BuildLaneSegmentTable"))
+
+	NumLanes = ZoneGraphStorage.Lanes.Num();
+	NumPoints = ZoneGraphStorage.LanePoints.Num();
+
+	LaneBucketsBegin.SetNumUninitialized(NumLanes);
+	LaneInvBucketLengths.SetNumUninitialized(NumLanes);
+	BucketEndPointIndices.Reset(NumPoints);
+	SegmentStartControlPoints.SetNumZeroed(NumPoints);
+	SegmentEndControlPoints.SetNumZeroed(NumPoints);
+
+	for (int32 LaneIndex = 0; LaneIndex < NumLanes; ++LaneIndex)
+	{
+		const FZoneLaneData& LaneData = ZoneGraphStorage.Lanes[LaneIndex];
+		const int32 NumSegments = FMath::Max(LaneData.PointsEnd - LaneData.PointsBegin - 1, 1);
+		const float LaneLength = ZoneGraphStorage.LanePointProgressions[LaneData.PointsEnd - 1];
+		const float BucketLength = LaneLength / NumSegments;
+
+		LaneBucketsBegin[LaneIndex] = BucketEndPointIndices.Num();
+		LaneInvBucketLengths[LaneIndex] = BucketLength > UE_KINDA_SMALL_NUMBER ? 1.0f / BucketLength : 0.0f;
+
+		// First point at or beyond each bucket's start, as InitPositionOnlyLaneSegment would find it for that distance
+		int32 EndPointIndex = LaneData.PointsBegin + 1;
+		for (int32 BucketIndex = 0; BucketIndex < NumSegments; ++BucketIndex)
+		{
+			const float BucketStart = BucketIndex * BucketLength;
+			while (ZoneGraphStorage.LanePointProgressions[EndPointIndex] < BucketStart && EndPointIndex < LaneData.PointsEnd - 1)
+			{
+				++EndPointIndex;
+			}
+			BucketEndPointIndices.Add(EndPointIndex);
+		}
+
+		for (int32 StartPointIndex = LaneData.PointsBegin; StartPointIndex < LaneData.PointsEnd - 1; ++StartPointIndex)
+		{
+			const FVector& StartPoint = ZoneGraphStorage.LanePoints[StartPointIndex];
+			const FVector& EndPoint = ZoneGraphStorage.LanePoints[StartPointIndex + 1];
+			const float TangentDistance = FVector::Distance(StartPoint, EndPoint) / 3.0f;
+			SegmentStartControlPoints[StartPointIndex] = StartPoint + ZoneGraphStorage.LaneTangentVectors[StartPointIndex] * TangentDistance;
+			SegmentEndControlPoints[StartPointIndex] = EndPoint - ZoneGraphStorage.LaneTangentVectors[StartPointIndex + 1] * TangentDistance;
+		}
+	}
+}
+
+int32 FMassTrafficLaneSegmentTable::FindSegmentEndPointIndex(const FZoneGraphStorage& ZoneGraphStorage, int32 LaneIndex, float DistanceAlongLane) const
+{
+	const FZoneLaneData& LaneData = ZoneGraphStorage.Lanes[LaneIndex];
+	const int32 NumBuckets = FMath::Max(LaneData.PointsEnd - LaneData.PointsBegin - 1, 1);
+	const int32 BucketIndex = FMath::Clamp(FMath::FloorToInt32(DistanceAlongLane * LaneInvBucketLengths[LaneIndex]), 0, NumBuckets - 1);
+
+	int32 EndPointIndex = BucketEndPointIndices[LaneBucketsBegin[LaneIndex] + BucketIndex];
+
+	// Float rounding can put DistanceAlongLane just before the bucket's start, in which case the point before may be it 
+	while (EndPointIndex > LaneData.PointsBegin + 1 && ZoneGraphStorage.LanePointProgressions[EndPointIndex - 1] >= DistanceAlongLane)
+	{
+		--EndPointIndex;
+	}
+
+	// Find the first point beyond DistanceAlongLane, within the bucket
+	while (ZoneGraphStorage.LanePointProgressions[EndPointIndex] < DistanceAlongLane && EndPointIndex < LaneData.PointsEnd - 1)
+	{
+		++EndPointIndex;
+	}
+
+	return EndPointIndex;
+}
+
 namespace UE
 {
 namespace MassTraffic
@@ -23,8 +92,67 @@ FORCEINLINE bool IsValidLaneSegmentForDistanceAlongLane(
 	return LaneIndex == LaneSegment.LaneHandle.Index && ZoneGraphStorage.DataHandle == LaneSegment.LaneHandle.DataHandle && FMath::IsWithinInclusive(DistanceAlongLane, LaneSegment.StartProgression, LaneSegment.EndProgression);
 }
 	
+bool FindNearbyDistanceAlongLane(
+	const FZoneGraphStorage& ZoneGraphStorage,
+	const FMassTrafficLaneSegmentTable* LaneSegmentTable,
+	int32 LaneIndex,
+	const FVector& Location,
+	float PreviousDistanceAlongLane,
+	float SearchDistance,
+	float& OutDistanceAlongLane,
+	float& OutDistanceSq
+)
+{
+	if (!LaneSegmentTable || !ZoneGraphStorage.Lanes.IsValidIndex(LaneIndex))
+	{
+		return false;
+	}
+
+	const FZoneLaneData& LaneData = ZoneGraphStorage.Lanes[LaneIndex];
+	const int32 FirstEndPointIndex = LaneSegmentTable->FindSegmentEndPointIndex(ZoneGraphStorage, LaneIndex, PreviousDistanceAlongLane - SearchDistance);
+	const int32 LastEndPointIndex = LaneSegmentTable->FindSegmentEndPointIndex(ZoneGraphStorage, LaneIndex, PreviousDistanceAlongLane + SearchDistance);
+
+	// Project onto each segment in range, as UE::ZoneGraph::Query::FindNearestLocationOnLane does for the whole lane
+	int32 NearestEndPointIndex = INDEX_NONE;
+	float NearestSegmentAlpha = 0.0f;
+	float NearestDistanceSq = TNumericLimits<float>::Max();
+	for (int32 EndPointIndex = FirstEndPointIndex; EndPointIndex <= LastEndPointIndex; ++EndPointIndex)
+	{
+		const FVector& SegmentStart = ZoneGraphStorage.LanePoints[EndPointIndex - 1];
+		const FVector& SegmentEnd = ZoneGraphStorage.LanePoints[EndPointIndex];
+		const FVector ClosestPoint = FMath::ClosestPointOnSegment(Location, SegmentStart, SegmentEnd);
+		const float DistanceSq = FVector::DistSquared(Location, ClosestPoint);
+		if (DistanceSq < NearestDistanceSq)
+		{
+			const float SegmentLengthSq = FVector::DistSquared(SegmentStart, SegmentEnd);
+			NearestEndPointIndex = EndPointIndex;
+			NearestSegmentAlpha = SegmentLengthSq > UE_KINDA_SMALL_NUMBER ? FMath::Sqrt(FVector::DistSquared(SegmentStart, ClosestPoint) / SegmentLengthSq) : 0.0f;
+			NearestDistanceSq = DistanceSq;
+		}
+	}
+
+	if (NearestEndPointIndex == INDEX_NONE || NearestDistanceSq > FMath::Square(SearchDistance))
+	{
+		return false;
+	}
+
+	// Nearest at the edge of the searched range? The lane may well get nearer beyond it
+	const bool bAtSearchStart = NearestEndPointIndex == FirstEndPointIndex && NearestSegmentAlpha <= 0.0f && FirstEndPointIndex > LaneData.PointsBegin + 1;
+	const bool bAtSearchEnd = NearestEndPointIndex == LastEndPointIndex && NearestSegmentAlpha >= 1.0f && LastEndPointIndex < LaneData.PointsEnd - 1;
+	if (bAtSearchStart || bAtSearchEnd)
+	{
+		return false;
+	}
+
+	OutDistanceAlongLane = FMath::Lerp(ZoneGraphStorage.LanePointProgressions[NearestEndPointIndex - 1], ZoneGraphStorage.LanePointProgressions[NearestEndPointIndex], NearestSegmentAlpha);
+	OutDistanceSq = NearestDistanceSq;
+
+	return true;
+}
+
 void InitPositionOnlyLaneSegment(
 	const FZoneGraphStorage& ZoneGraphStorage,
+	const FMassTrafficLaneSegmentTable* LaneSegmentTable,
 	int32 LaneIndex,
 	float DistanceAlongLane,
 	FMassTrafficPositionOnlyLaneSegment& InOutLaneSegment
@@ -33,6 +161,26 @@ void InitPositionOnlyLaneSegment(
 	const FZoneLaneData& LaneData = ZoneGraphStorage.Lanes[LaneIndex];
 	const FZoneGraphLaneHandle LaneHandle = FZoneGraphLaneHandle(LaneIndex, ZoneGraphStorage.DataHandle);
 
+	// Use the precomputed lane segment table, if there is one
+	if (LaneSegmentTable)
+	{
+		const int32 LaneSegmentEndPointIndex = LaneSegmentTable->FindSegmentEndPointIndex(ZoneGraphStorage, LaneIndex, DistanceAlongLane);
+		const int32 LaneSegmentStartPointIndex = LaneSegmentEndPointIndex - 1;
+
+		InOutLaneSegment.LaneHandle = LaneHandle;
+		InOutLaneSegment.StartPointIndex = LaneSegmentStartPointIndex;
+
+		InOutLaneSegment.StartProgression = ZoneGraphStorage.LanePointProgressions[LaneSegmentStartPointIndex];
+		InOutLaneSegment.StartPoint = ZoneGraphStorage.LanePoints[LaneSegmentStartPointIndex];
+		InOutLaneSegment.StartControlPoint = LaneSegmentTable->SegmentStartControlPoints[LaneSegmentStartPointIndex];
+
+		InOutLaneSegment.EndProgression = ZoneGraphStorage.LanePointProgressions[LaneSegmentEndPointIndex];
+		InOutLaneSegment.EndPoint = ZoneGraphStorage.LanePoints[LaneSegmentEndPointIndex];
+		InOutLaneSegment.EndControlPoint = LaneSegmentTable->SegmentEndControlPoints[LaneSegmentStartPointIndex];
+
+		return;
+	}
+
 	// Ahead of current range?
 	int32 LaneSegmentEndPointIndex;
 	if (LaneHandle == InOutLaneSegment.LaneHandle && DistanceAlongLane > InOutLaneSegment.EndProgression)
@@ -71,12 +219,13 @@ void InitPositionOnlyLaneSegment(
 
 void InitLaneSegment(
     const FZoneGraphStorage& ZoneGraphStorage,
+    const FMassTrafficLaneSegmentTable* LaneSegmentTable,
     int32 LaneIndex,
     float DistanceAlongLane,
     FMassTrafficLaneSegment& InOutLaneSegment
 )
 {
-	InitPositionOnlyLaneSegment(ZoneGraphStorage, LaneIndex, DistanceAlongLane, InOutLaneSegment);
+	InitPositionOnlyLaneSegment(ZoneGraphStorage, LaneSegmentTable, LaneIndex, DistanceAlongLane, InOutLaneSegment);
 
 	InOutLaneSegment.LaneSegmentStartUp = ZoneGraphStorage.LaneUpVectors[InOutLaneSegment.StartPointIndex];
 	InOutLaneSegment.LaneSegmentEndUp = ZoneGraphStorage.LaneUpVectors[InOutLaneSegment.StartPointIndex + 1];
@@ -84,6 +233,7 @@ void InitLaneSegment(
 	
 void InterpolatePositionAlongLane(
     const FZoneGraphStorage& ZoneGraphStorage, 
+    const FMassTrafficLaneSegmentTable* LaneSegmentTable,
     int32 LaneIndex,
     float DistanceAlongLane,
     ETrafficVehicleMovementInterpolationMethod InterpolationMethod,
@@ -93,7 +243,7 @@ void InterpolatePositionAlongLane(
 	// Out of current segment range?
 	if (!IsValidLaneSegmentForDistanceAlongLane(InOutLaneSegment, ZoneGraphStorage, LaneIndex, DistanceAlongLane))
 	{
-		InitPositionOnlyLaneSegment(ZoneGraphStorage, LaneIndex, DistanceAlongLane, InOutLaneSegment);
+		InitPositionOnlyLaneSegment(ZoneGraphStorage, LaneSegmentTable, LaneIndex, DistanceAlongLane, InOutLaneSegment);
 	}
 	
 	// Segment alpha 
@@ -123,6 +273,7 @@ void InterpolatePositionAlongLane(
 
 void InterpolatePositionAndOrientationAlongLane(
     const FZoneGraphStorage& ZoneGraphStorage, 
+    const FMassTrafficLaneSegmentTable* LaneSegmentTable,
     int32 LaneIndex,
     float DistanceAlongLane,
     ETrafficVehicleMovementInterpolationMethod InterpolationMethod,
@@ -133,7 +284,7 @@ void InterpolatePositionAndOrientationAlongLane(
 	// Out of current segment range?
 	if (!IsValidLaneSegmentForDistanceAlongLane(InOutLaneSegment, ZoneGraphStorage, LaneIndex, DistanceAlongLane))
 	{
-		InitLaneSegment(ZoneGraphStorage, LaneIndex, DistanceAlongLane, InOutLaneSegment);
+		InitLaneSegment(ZoneGraphStorage, LaneSegmentTable, LaneIndex, DistanceAlongLane, InOutLaneSegment);
 	}
 	
 	// Segment alpha 
@@ -175,6 +326,7 @@ void InterpolatePositionAndOrientationAlongLane(
 
 void InterpolatePositionAlongContinuousLanes(
 	const FZoneGraphStorage& ZoneGraphStorage,
+	const FMassTrafficLaneSegmentTable* LaneSegmentTable,
 	int32 CurrentLaneIndex,
     float CurrentLaneLength,
 	int32 NextLaneIndex,
@@ -186,16 +338,17 @@ void InterpolatePositionAlongContinuousLanes(
 {
 	if (DistanceAlongCurrentLane > CurrentLaneLength && NextLaneIndex != INDEX_NONE)
 	{
-		InterpolatePositionAlongLane(ZoneGraphStorage, NextLaneIndex, DistanceAlongCurrentLane - CurrentLaneLength, InterpolationMethod, InOutLaneSegment, OutPosition);
+		InterpolatePositionAlongLane(ZoneGraphStorage, LaneSegmentTable, NextLaneIndex, DistanceAlongCurrentLane - CurrentLaneLength, InterpolationMethod, InOutLaneSegment, OutPosition);
 	}
 	else
 	{
-		InterpolatePositionAlongLane(ZoneGraphStorage, CurrentLaneIndex, DistanceAlongCurrentLane, InterpolationMethod, InOutLaneSegment, OutPosition);
+		InterpolatePositionAlongLane(ZoneGraphStorage, LaneSegmentTable, CurrentLaneIndex, DistanceAlongCurrentLane, InterpolationMethod, InOutLaneSegment, OutPosition);
 	}
 }
 
 void InterpolatePositionAndOrientationAlongContinuousLanes(
 	const FZoneGraphStorage& ZoneGraphStorage,
+	const FMassTrafficLaneSegmentTable* LaneSegmentTable,
 	int32 CurrentLaneIndex,
 	float CurrentLaneLength,
 	int32 NextLaneIndex,
@@ -208,16 +361,17 @@ void InterpolatePositionAndOrientationAlongContinuousLanes(
 {
 	if (DistanceAlongCurrentLane > CurrentLaneLength && NextLaneIndex != INDEX_NONE)
 	{
-		InterpolatePositionAndOrientationAlongLane(ZoneGraphStorage, NextLaneIndex, DistanceAlongCurrentLane - CurrentLaneLength, InterpolationMethod, InOutLaneSegment, OutPosition, OutOrientation);
+		InterpolatePositionAndOrientationAlongLane(ZoneGraphStorage, LaneSegmentTable, NextLaneIndex, DistanceAlongCurrentLane - CurrentLaneLength, InterpolationMethod, InOutLaneSegment, OutPosition, OutOrientation);
 	}
 	else
 	{
-		InterpolatePositionAndOrientationAlongLane(ZoneGraphStorage, CurrentLaneIndex, DistanceAlongCurrentLane, InterpolationMethod, InOutLaneSegment, OutPosition, OutOrientation);
+		InterpolatePositionAndOrientationAlongLane(ZoneGraphStorage, LaneSegmentTable, CurrentLaneIndex, DistanceAlongCurrentLane, InterpolationMethod, InOutLaneSegment, OutPosition, OutOrientation);
 	}
 }
 
 void InterpolatePositionAndOrientationAlongContinuousLanes(
 	const FZoneGraphStorage& ZoneGraphStorage,
+	const FMassTrafficLaneSegmentTable* LaneSegmentTable,
 	int32 PreviousLaneIndex,
 	float PreviousLaneLength,
 	int32 CurrentLaneIndex,
@@ -231,15 +385,15 @@ void InterpolatePositionAndOrientationAlongContinuousLanes(
 {
 	if (DistanceAlongCurrentLane > CurrentLaneLength && NextLaneIndex != INDEX_NONE)
 	{
-		InterpolatePositionAndOrientationAlongLane(ZoneGraphStorage, NextLaneIndex, DistanceAlongCurrentLane - CurrentLaneLength, InterpolationMethod, InOutLaneSegment, OutPosition, OutOrientation);
+		InterpolatePositionAndOrientationAlongLane(ZoneGraphStorage, LaneSegmentTable, NextLaneIndex, DistanceAlongCurrentLane - CurrentLaneLength, InterpolationMethod, InOutLaneSegment, OutPosition, OutOrientation);
 	}
 	else if (DistanceAlongCurrentLane < 0.0f && PreviousLaneIndex != INDEX_NONE)
 	{
-		InterpolatePositionAndOrientationAlongLane(ZoneGraphStorage, PreviousLaneIndex, PreviousLaneLength + DistanceAlongCurrentLane, InterpolationMethod, InOutLaneSegment, OutPosition, OutOrientation);
+		InterpolatePositionAndOrientationAlongLane(ZoneGraphStorage, LaneSegmentTable, PreviousLaneIndex, PreviousLaneLength + DistanceAlongCurrentLane, InterpolationMethod, InOutLaneSegment, OutPosition, OutOrientation);
 	}
 	else
 	{
-		InterpolatePositionAndOrientationAlongLane(ZoneGraphStorage, CurrentLaneIndex, DistanceAlongCurrentLane, InterpolationMethod, InOutLaneSegment, OutPosition, OutOrientation);
+		InterpolatePositionAndOrientationAlongLane(ZoneGraphStorage, LaneSegmentTable, CurrentLaneIndex, DistanceAlongCurrentLane, InterpolationMethod, InOutLaneSegment, OutPosition, OutOrientation);
 	}
 }
 	
@@ -7,6 +7,7 @@
 #include "MassTrafficInterpolation.h"
 #include "MassTrafficLaneChange.h"
 #include "MassTrafficLaneChangingProcessor.h"
+#include "MassTrafficSubsystem.h"
 #include "MassTrafficVehicleSimulationTrait.h"
 
 #include "MassLODUtils.h"
@@ -46,6 +47,7 @@ void UMassTrafficInterpolationProcessor::ConfigureQueries()
 	EntityQueryNonOffLOD_Conditional.SetChunkFilter(FMassSimulationVariableTickChunkFragment::ShouldTickChunkThisFrame);
 
 	EntityQueryNonOffLOD_Conditional.AddSubsystemRequirement<UZoneGraphSubsystem>(EMassFragmentAccess::ReadOnly);
+	EntityQueryNonOffLOD_Conditional.AddSubsystemRequirement<UMassTrafficSubsystem>(EMassFragmentAccess::ReadOnly);
 
 	EntityQueryOffLOD_Conditional = EntityQueryNonOffLOD_Conditional;
 
@@ -59,11 +61,18 @@ void UMassTrafficInterpolationProcessor::ConfigureQueries()
 
 void UMassTrafficInterpolationProcessor::Execute(FMassEntityManager& EntityManager, FMassExecutionContext& Context)
 {
+	// Skip during replay playback and on frames without fixed timestep substeps
+	if (!ShouldSimulateTrafficVehicles())
+	{
+		return;
+	}
+
 	UWorld* World = GetWorld();
 	
 	EntityQueryNonOffLOD_Conditional.ForEachEntityChunk(EntityManager, Context, [&, World = EntityManager.GetWorld()](FMassExecutionContext& QueryContext)
 	{
 		const UZoneGraphSubsystem& ZoneGraphSubsystem = QueryContext.GetSubsystemChecked<UZoneGraphSubsystem>(World);
+		const UMassTrafficSubsystem& MassTrafficSubsystem = QueryContext.GetSubsystemChecked<UMassTrafficSubsystem>(World);
 
 		// Get fragment lists
 		const int32 NumEntities = Context.GetNumEntities();
@@ -92,11 +101,13 @@ void UMassTrafficInterpolationProcessor::Execute(FMassEntityManager& EntityManag
 			check(!VehicleControlFragment.NextLane || VehicleControlFragment.NextLane->LaneHandle.DataHandle == ZoneGraphLaneLocationFragment.LaneHandle.DataHandle);
 			const FZoneGraphStorage* ZoneGraphStorage = ZoneGraphSubsystem.GetZoneGraphStorage(ZoneGraphLaneLocationFragment.LaneHandle.DataHandle);
 			check(ZoneGraphStorage);
+			const FMassTrafficLaneSegmentTable* LaneSegmentTable = MassTrafficSubsystem.GetLaneSegmentTable(ZoneGraphLaneLocationFragment.LaneHandle.DataHandle);
 		
 			// Interpolate rear axle position
 			FTransform RearAxleTransform;
 			UE::MassTraffic::InterpolatePositionAndOrientationAlongContinuousLanes(
 				*ZoneGraphStorage,
+				LaneSegmentTable,
 				VehicleControlFragment.PreviousLaneIndex,
 				VehicleControlFragment.PreviousLaneLength,
 				ZoneGraphLaneLocationFragment.LaneHandle.Index,
@@ -111,6 +122,7 @@ void UMassTrafficInterpolationProcessor::Execute(FMassEntityManager& EntityManag
 			FTransform FrontAxleTransform;
 			UE::MassTraffic::InterpolatePositionAndOrientationAlongContinuousLanes(
 				*ZoneGraphStorage,
+				LaneSegmentTable,
 				VehicleControlFragment.PreviousLaneIndex,
 				VehicleControlFragment.PreviousLaneLength,
 				ZoneGraphLaneLocationFragment.LaneHandle.Index,
@@ -148,6 +160,7 @@ void UMassTrafficInterpolationProcessor::Execute(FMassEntityManager& EntityManag
 	EntityQueryOffLOD_Conditional.ForEachEntityChunk(EntityManager, Context, [&, World = EntityManager.GetWorld()](FMassExecutionContext& QueryContext)
 	{
 		const UZoneGraphSubsystem& ZoneGraphSubsystem = QueryContext.GetSubsystemChecked<UZoneGraphSubsystem>(World);
+		const UMassTrafficSubsystem& MassTrafficSubsystem = QueryContext.GetSubsystemChecked<UMassTrafficSubsystem>(World);
 
 		// Get fragment lists
 		const int32 NumEntities = Context.GetNumEntities();
@@ -170,9 +183,10 @@ void UMassTrafficInterpolationProcessor::Execute(FMassEntityManager& EntityManag
 			// Get FZoneGraphStorage for lanes
 			const FZoneGraphStorage* ZoneGraphStorage = ZoneGraphSubsystem.GetZoneGraphStorage(ZoneGraphLaneLocationFragment.LaneHandle.DataHandle);
 			check(ZoneGraphStorage);
+			const FMassTrafficLaneSegmentTable* LaneSegmentTable = MassTrafficSubsystem.GetLaneSegmentTable(ZoneGraphLaneLocationFragment.LaneHandle.DataHandle);
 
 			// Interpolate position & orientation
-			UE::MassTraffic::InterpolatePositionAndOrientationAlongLane(*ZoneGraphStorage, ZoneGraphLaneLocationFragment.LaneHandle.Index
+			UE::MassTraffic::InterpolatePositionAndOrientationAlongLane(*ZoneGraphStorage, LaneSegmentTable, ZoneGraphLaneLocationFragment.LaneHandle.Index
 				, ZoneGraphLaneLocationFragment.DistanceAlongLane, ETrafficVehicleMovementInterpolationMethod::Linear
 				, VehicleMovementInterpolationFragment.LaneLocationLaneSegment, TransformFragment.GetMutableTransform());
 			
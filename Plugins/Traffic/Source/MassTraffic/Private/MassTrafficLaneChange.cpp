@@ -155,54 +155,45 @@ bool FindNearbyVehiclesOnLane_RelativeToDistanceAlongLane(
 	
 	check(TrafficLaneData->LaneHandle.IsValid());
 	
-	// Look for vehicles on the lane. Start at the last vehicle on the lane, and work our way up the lane,
-	// comparing to our given distance.
+	// Binary search the lane's vehicles for the first one ahead of our given distance. Their cached distances can be
+	// up to a frame behind, so vehicles just behind the split may have since moved past our distance - step back over
+	// them using their current distances. (Vehicles only move forward, so the split can't be too far back.)
+
+	const TArray<FMassTrafficLaneVehicle>& Vehicles = TrafficLaneData->Vehicles;
+	int32 AheadIndex = TrafficLaneData->FindFirstVehicleIndexAhead(DistanceAlongLane);
 	
-	FMassEntityHandle Entity_Marching = TrafficLaneData->TailVehicle; // ..start here
-	int32 MarchCount = 0;
-	while (Entity_Marching.IsSet())
+	while (AheadIndex > 0)
 	{
-		const FMassEntityView EntityView_Marching(EntityManager, Entity_Marching);
-		const FMassZoneGraphLaneLocationFragment& ZoneGraphLaneLocationFragment_Marching = EntityView_Marching.GetFragmentData<FMassZoneGraphLaneLocationFragment>();
-		const FMassTrafficNextVehicleFragment& NextVehicleFragment_Marching = EntityView_Marching.GetFragmentData<FMassTrafficNextVehicleFragment>();
-		const float DistanceAlongLane_Marching = ZoneGraphLaneLocationFragment_Marching.DistanceAlongLane;
-
-		if (ZoneGraphLaneLocationFragment_Marching.LaneHandle != TrafficLaneData->LaneHandle)
-		{				
-			// Marching vehicle has moved on to another lane. Given that, it should be ahead of us, but we are not
-			// interested in it. (When the current vehicle gets to the end of its lane, it
-			// will re-find a new next vehicle anyway.)
-			return true;
-		}
-		else if (DistanceAlongLane_Marching <= DistanceAlongLane)
+		const FMassEntityHandle Entity_Behind = Vehicles[AheadIndex - 1].Entity;
+		if (!EntityManager.IsEntityValid(Entity_Behind))
 		{
-			// Marching vehicle is (1) still on the lane (2) behind us (3) would be the closest one behind us that
-			// we've seen so far, since we're marching up the lane from the back -
-			OutEntity_Behind = Entity_Marching;
-		}
-		else if (DistanceAlongLane_Marching > DistanceAlongLane)
-		{
-			// Marching vehicle is ahead of us, and still on the lane.
-			OutEntity_Ahead = Entity_Marching;
-			return true; // ..done
+			UE_LOG(LogMassTraffic, Warning, TEXT("%s - Lane %s has invalid vehicle %d"), ANSI_TO_TCHAR(__FUNCTION__), *TrafficLaneData->LaneHandle.ToString(), Entity_Behind.Index);
+			return false;
 		}
 
-
-		// An OK optimization, but really prevents endless loops.
-		if (++MarchCount >= 200)
+		const FMassZoneGraphLaneLocationFragment& ZoneGraphLaneLocationFragment_Behind = EntityManager.GetFragmentDataChecked<FMassZoneGraphLaneLocationFragment>(Entity_Behind);
+		if (ZoneGraphLaneLocationFragment_Behind.LaneHandle == TrafficLaneData->LaneHandle && ZoneGraphLaneLocationFragment_Behind.DistanceAlongLane <= DistanceAlongLane)
 		{
-			UE_LOG(LogMassTraffic, Warning, TEXT("%s - March eject at %d"), ANSI_TO_TCHAR(__FUNCTION__), MarchCount); 
-			return false;
+			// (1) still on the lane (2) behind us (3) the closest one behind us, as everything after it is ahead.
+			OutEntity_Behind = Entity_Behind;
+			break;
 		}
-
-		// March to next vehicle.
-
-		Entity_Marching = NextVehicleFragment_Marching.GetNextVehicle();
 		
-		if (Entity_Marching == TrafficLaneData->TailVehicle)
+		// Either moved ahead of us, or moved on to another lane, which should also be ahead of us.
+		--AheadIndex;
+	}
+
+	// The first vehicle from there that's still on the lane is the one ahead. Any that have moved on to another lane we
+	// are not interested in, including the stale ones we just stepped back over. (When the current vehicle gets to the
+	// end of its lane, it will re-find a new next vehicle anyway.)
+	for (; AheadIndex < Vehicles.Num(); ++AheadIndex)
+	{
+		const FMassEntityHandle Entity_Ahead = Vehicles[AheadIndex].Entity;
+		if (EntityManager.IsEntityValid(Entity_Ahead) &&
+			EntityManager.GetFragmentDataChecked<FMassZoneGraphLaneLocationFragment>(Entity_Ahead).LaneHandle == TrafficLaneData->LaneHandle)
 		{
-			UE_LOG(LogMassTraffic, Warning, TEXT("%s - March eject at %d - rediscovered tail"), ANSI_TO_TCHAR(__FUNCTION__), MarchCount); 
-			return false;
+			OutEntity_Ahead = Entity_Ahead;
+			break;
 		}
 	}
 
@@ -253,8 +244,31 @@ bool FindNearbyVehiclesOnLane_RelativeToVehicleEntity(
 	}
 
 	
-	// Look for previous vehicle on the lane. Start at the last vehicle on the lane, and work our way up the lane,
-	// comparing to our given entity.
+	// Look for previous vehicle on the lane. Vehicles is in the same order as the NextVehicle links, so it's simply
+	// the entry before ours.
+
+	{
+		const float DistanceAlongLane_Current = EntityManager.GetFragmentDataChecked<FMassZoneGraphLaneLocationFragment>(Entity_Current).DistanceAlongLane;
+		const int32 VehicleIndex_Current = TrafficLaneData->FindVehicleIndex(Entity_Current, DistanceAlongLane_Current);
+		if (VehicleIndex_Current != INDEX_NONE)
+		{
+			if (VehicleIndex_Current > 0)
+			{
+				const FMassEntityHandle Entity_Behind = TrafficLaneData->Vehicles[VehicleIndex_Current - 1].Entity;
+				if (EntityManager.IsEntityValid(Entity_Behind) &&
+					EntityManager.GetFragmentDataChecked<FMassZoneGraphLaneLocationFragment>(Entity_Behind).LaneHandle == TrafficLaneData->LaneHandle)
+				{
+					OutEntity_Behind = Entity_Behind;
+				}
+			}
+			
+			return true;
+		}
+	}
+
+	
+	// Vehicles doesn't know about us, which shouldn't happen. Fall back to starting at the last vehicle on the lane,
+	// and working our way up the lane, comparing to our given entity.
 	
 	FMassEntityHandle Entity_Marching = TrafficLaneData->TailVehicle; // ..start here
 	int32 MarchCount = 0;
@@ -278,7 +278,7 @@ static void TryStartingNewLaneChange(
 
 	
 	// Find nearby vehicles on chosen lane.
-	// NOTE - This is expensive, so save it for as late as possible.
+	// NOTE - This binary searches the chosen lane's vehicles, but reads their fragments, so save it for as late as possible.
 	
 	FMassEntityHandle Entity_Chosen_Behind;
 	FMassEntityHandle Entity_Chosen_Ahead;
@@ -494,7 +494,7 @@ static void TryStartingNewLaneChange(
 
 		// For instant lane changes, we need to update the transform to the new lane position so that
 		// later processors like LOD calculation have the right transform to work with.
-		InterpolatePositionAndOrientationAlongLane(ZoneGraphStorage, ZoneGraphLaneLocationFragment_Current.LaneHandle.Index, ZoneGraphLaneLocationFragment_Current.DistanceAlongLane, ETrafficVehicleMovementInterpolationMethod::Linear, InterpolationFragment_Current.LaneLocationLaneSegment, TransformFragment_Current.GetMutableTransform());
+		InterpolatePositionAndOrientationAlongLane(ZoneGraphStorage, MassTrafficSubsystem.GetLaneSegmentTable(ZoneGraphLaneLocationFragment_Current.LaneHandle.DataHandle), ZoneGraphLaneLocationFragment_Current.LaneHandle.Index, ZoneGraphLaneLocationFragment_Current.DistanceAlongLane, ETrafficVehicleMovementInterpolationMethod::Linear, InterpolationFragment_Current.LaneLocationLaneSegment, TransformFragment_Current.GetMutableTransform());
 
 		//INC_DWORD_STAT(STAT_Traffic_LaneChangeInstant);
 	}
@@ -569,14 +569,11 @@ static void TryStartingNewLaneChange(
 }
 
 
-static void UpdateLaneChange(
-	FMassTrafficVehicleLightsFragment& VehicleLightsFragment_Current,
+static bool UpdateLaneChange(
 	const FMassZoneGraphLaneLocationFragment& ZoneGraphLaneLocationFragment_Current,
 	FMassTrafficVehicleLaneChangeFragment& LaneChangeFragment_Current,
-	FMassTrafficNextVehicleFragment& NextVehicleFragment_Current,
 	//
 	const float DeltaTimeSeconds,
-	const FMassEntityManager& EntityManager,
 	const UMassTrafficSettings& MassTrafficSettings,
 	const FRandomStream& RandomStream)
 {
@@ -584,10 +581,10 @@ static void UpdateLaneChange(
 	// Only count down the if we're in a lane changing lane. This prevents many cars changing lanes in the same place
 	// when they they re-enter a zone where they are allowed to change lanes.
 	
-	LaneChangeFragment_Current.UpdateLaneChange(
+	return LaneChangeFragment_Current.UpdateLaneChange(
 		DeltaTimeSeconds, 
-		VehicleLightsFragment_Current, NextVehicleFragment_Current, ZoneGraphLaneLocationFragment_Current,
-		EntityManager, MassTrafficSettings, RandomStream);
+		ZoneGraphLaneLocationFragment_Current,
+		MassTrafficSettings, RandomStream);
 }
 
 
@@ -635,6 +632,12 @@ void UMassTrafficLaneChangingProcessor::ConfigureQueries()
 
 void UMassTrafficLaneChangingProcessor::Execute(FMassEntityManager& EntityManager, FMassExecutionContext& Context)
 {
+	// Skip during replay playback and on frames without fixed timestep substeps
+	if (!ShouldSimulateTrafficVehicles())
+	{
+		return;
+	}
+
 	// Quick checks to see if we should bother being here.
 	if (GMassTrafficLaneChange == 0 /*lane changing forced off (no lane changing allowed at all)*/)
 	{
@@ -711,34 +714,64 @@ void UMassTrafficLaneChangingProcessor::Execute(FMassEntityManager& EntityManage
 
 	{
 		TRACE_CPUPROFILER_EVENT_SCOPE(TEXT("UpdateLaneChanges"));
+
+		// Finished lane changes are ended afterwards, in entity order, as ending one touches the fragments of the vehicles
+		// either side of it. (See FMassTrafficLaneReservations.)
+		const uint32 FrameSeed = RandomStream.GetUnsignedInt();
 		
-		UpdateLaneChangesEntityQuery_Conditional.ForEachEntityChunk(
-				EntityManager, Context, [&](FMassExecutionContext& ComponentSystemExecutionContext)
+		auto UpdateLaneChangesChunk = [&](FMassExecutionContext& QueryContext)
 			{
 				// NOTE - Don't check if we should skip this due to LOD. All lane changes, once started, should always be
 				// updated until finished. 
 
-				const TArrayView<FMassTrafficVehicleLightsFragment> VehicleLightsFragments = Context.GetMutableFragmentView<FMassTrafficVehicleLightsFragment>();
-				const TConstArrayView<FMassZoneGraphLaneLocationFragment> ZoneGraphLaneLocationFragments = Context.GetFragmentView<FMassZoneGraphLaneLocationFragment>();
-				const TConstArrayView<FMassSimulationVariableTickFragment> SimulationVariableTickFragments = Context.GetFragmentView<FMassSimulationVariableTickFragment>();
-				const TArrayView<FMassTrafficVehicleLaneChangeFragment> LaneChangeFragments = Context.GetMutableFragmentView<FMassTrafficVehicleLaneChangeFragment>();
-				const TArrayView<FMassTrafficNextVehicleFragment> NextVehicleFragments = Context.GetMutableFragmentView<FMassTrafficNextVehicleFragment>();
+				FMassTrafficLaneReservationBuffer& Reservations = LaneReservations.AddBuffer();
 
-				for (int32 EntityIndex = 0; EntityIndex < Context.GetNumEntities(); EntityIndex++)
+				const TConstArrayView<FMassZoneGraphLaneLocationFragment> ZoneGraphLaneLocationFragments = QueryContext.GetFragmentView<FMassZoneGraphLaneLocationFragment>();
+				const TConstArrayView<FMassSimulationVariableTickFragment> SimulationVariableTickFragments = QueryContext.GetFragmentView<FMassSimulationVariableTickFragment>();
+				const TArrayView<FMassTrafficVehicleLaneChangeFragment> LaneChangeFragments = QueryContext.GetMutableFragmentView<FMassTrafficVehicleLaneChangeFragment>();
+
+				for (int32 EntityIndex = 0; EntityIndex < QueryContext.GetNumEntities(); EntityIndex++)
 				{
-					FMassTrafficVehicleLightsFragment& VehicleLightsFragment = VehicleLightsFragments[EntityIndex]; 
+					const FMassEntityHandle Entity = QueryContext.GetEntity(EntityIndex);
 					const FMassZoneGraphLaneLocationFragment& ZoneGraphLaneLocationFragment = ZoneGraphLaneLocationFragments[EntityIndex]; 
 					const FMassSimulationVariableTickFragment& SimulationVariableTickFragment = SimulationVariableTickFragments[EntityIndex]; 
 					FMassTrafficVehicleLaneChangeFragment& LaneChangeFragment = LaneChangeFragments[EntityIndex]; 
-					FMassTrafficNextVehicleFragment& NextVehicleFragment = NextVehicleFragments[EntityIndex]; 
 
-					UpdateLaneChange(
-						VehicleLightsFragment,
+					const bool bLaneChangeFinished = UpdateLaneChange(
 						ZoneGraphLaneLocationFragment,
 						LaneChangeFragment,
-						NextVehicleFragment,
-						SimulationVariableTickFragment.DeltaTime, EntityManager, *MassTrafficSettings, RandomStream);
+						SimulationVariableTickFragment.DeltaTime, *MassTrafficSettings, MakeEntityRandomStream(FrameSeed, Entity));
+					if (bLaneChangeFinished)
+					{
+						Reservations.AddVehicleAction(Entity, EMassLOD::Max, 0, 0.0f);
+					}
 				}
-			});
+			};
+
+		if (ShouldProcessVehicleBehaviorInParallel())
+		{
+			UpdateLaneChangesEntityQuery_Conditional.ParallelForEachEntityChunk(EntityManager, Context, UpdateLaneChangesChunk);
+		}
+		else
+		{
+			UpdateLaneChangesEntityQuery_Conditional.ForEachEntityChunk(EntityManager, Context, UpdateLaneChangesChunk);
+		}
+
+		for (const FMassTrafficLaneReservation& Reservation : LaneReservations.Sort())
+		{
+			if (Reservation.Type != EMassTrafficLaneReservationType::VehicleAction)
+			{
+				continue;
+			}
+
+			const FMassEntityView VehicleEntityView(EntityManager, Reservation.Entity);
+			FMassTrafficVehicleLaneChangeFragment& LaneChangeFragment = VehicleEntityView.GetFragmentData<FMassTrafficVehicleLaneChangeFragment>();
+			FMassTrafficVehicleLightsFragment& VehicleLightsFragment = VehicleEntityView.GetFragmentData<FMassTrafficVehicleLightsFragment>();
+			FMassTrafficNextVehicleFragment& NextVehicleFragment = VehicleEntityView.GetFragmentData<FMassTrafficNextVehicleFragment>();
+
+			LaneChangeFragment.EndLaneChangeProgression(VehicleLightsFragment, NextVehicleFragment, EntityManager);
+
+			LaneChangeFragment.SetLaneChangeCountdownSecondsToBeAtLeast(*MassTrafficSettings, EMassTrafficLaneChangeCountdownSeconds::AsNewTryUsingSettings, MakeEntityRandomStream(FrameSeed, Reservation.Entity)); // ..not handled by Reset()
+		}
 	}
 }
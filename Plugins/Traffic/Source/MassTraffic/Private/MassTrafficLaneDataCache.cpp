@@ -0,0 +1,402 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "MassTrafficLaneDataCache.h"
+#include "MassTraffic.h"
+#include "MassTrafficSettings.h"
+#include "MassTrafficSpawnPointCache.h"
+#include "MassTrafficTypes.h"
+
+#include "HAL/FileManager.h"
+#include "Misc/Paths.h"
+#include "ZoneGraphTypes.h"
+
+
+namespace
+{
+	constexpr uint32 LaneDataCacheMagic = 0x444C4D54; // 'TMLD'
+	constexpr uint32 LaneDataCacheVersion = 1;
+
+	constexpr uint32 GroundSnapCacheMagic = 0x53474D54; // 'TMGS'
+	constexpr uint32 GroundSnapCacheVersion = 1;
+
+	enum class ELaneDataCacheFlags : uint8
+	{
+		None = 0,
+		TurnsLeft = 1 << 0,
+		TurnsRight = 1 << 1,
+		IsRightMostLane = 1 << 2,
+		IsDownstreamFromIntersection = 1 << 3,
+		IsIntersectionLane = 1 << 4,
+		IsTrunkLane = 1 << 5,
+		IsLaneChangingLane = 1 << 6,
+	};
+	ENUM_CLASS_FLAGS(ELaneDataCacheFlags);
+
+	FORCEINLINE int32 GetLaneIndex(const FZoneGraphTrafficLaneData* TrafficLaneData)
+	{
+		return TrafficLaneData ? TrafficLaneData->LaneHandle.Index : INDEX_NONE;
+	}
+
+	template<typename AllocatorType>
+	void SaveLaneLinks(FArchive& Archive, const TArray<FZoneGraphTrafficLaneData*, AllocatorType>& LinkedLanes)
+	{
+		int32 NumLinkedLanes = LinkedLanes.Num();
+		Archive << NumLinkedLanes;
+		for (const FZoneGraphTrafficLaneData* LinkedLane : LinkedLanes)
+		{
+			int32 LinkedLaneIndex = GetLaneIndex(LinkedLane);
+			Archive << LinkedLaneIndex;
+		}
+	}
+
+	/** Reads lane indices saved by SaveLaneLinks. They're resolved to lane data once all the lanes have been loaded. */
+	bool LoadLaneLinks(FArchive& Archive, TArray<int32>& OutLinkedLaneIndices)
+	{
+		int32 NumLinkedLanes = 0;
+		Archive << NumLinkedLanes;
+		if (Archive.IsError() || NumLinkedLanes < 0 || NumLinkedLanes > 255)
+		{
+			return false;
+		}
+
+		OutLinkedLaneIndices.SetNum(NumLinkedLanes);
+		for (int32& LinkedLaneIndex : OutLinkedLaneIndices)
+		{
+			Archive << LinkedLaneIndex;
+		}
+
+		return !Archive.IsError();
+	}
+
+	template<typename AllocatorType>
+	bool ResolveLaneLinks(FMassTrafficZoneGraphData& TrafficZoneGraphData, const TArray<int32>& LinkedLaneIndices, TArray<FZoneGraphTrafficLaneData*, AllocatorType>& OutLinkedLanes)
+	{
+		OutLinkedLanes.Reset();
+		for (const int32 LinkedLaneIndex : LinkedLaneIndices)
+		{
+			if (!TrafficZoneGraphData.TrafficLaneDataLookup.IsValidIndex(LinkedLaneIndex) || !TrafficZoneGraphData.TrafficLaneDataLookup[LinkedLaneIndex])
+			{
+				return false;
+			}
+			OutLinkedLanes.Add(TrafficZoneGraphData.TrafficLaneDataLookup[LinkedLaneIndex]);
+		}
+		return true;
+	}
+
+	bool ResolveLaneLink(FMassTrafficZoneGraphData& TrafficZoneGraphData, const int32 LinkedLaneIndex, FZoneGraphTrafficLaneData*& OutLinkedLane)
+	{
+		OutLinkedLane = nullptr;
+		if (LinkedLaneIndex == INDEX_NONE)
+		{
+			return true;
+		}
+		if (!TrafficZoneGraphData.TrafficLaneDataLookup.IsValidIndex(LinkedLaneIndex))
+		{
+			return false;
+		}
+		OutLinkedLane = TrafficZoneGraphData.TrafficLaneDataLookup[LinkedLaneIndex];
+		return OutLinkedLane != nullptr;
+	}
+
+	struct FLaneLinkIndices
+	{
+		int32 LeftLaneIndex = INDEX_NONE;
+		int32 RightLaneIndex = INDEX_NONE;
+		TArray<int32> NextLaneIndices;
+		TArray<int32> MergingLaneIndices;
+		TArray<int32> SplittingLaneIndices;
+	};
+}
+
+
+namespace UE::MassTraffic
+{
+
+uint32 GetLaneDataCacheKey(const FZoneGraphStorage& ZoneGraphStorage, const UMassTrafficSettings& MassTrafficSettings)
+{
+	uint32 Key = GetZoneGraphStorageHash(ZoneGraphStorage);
+
+	Key = HashCombine(Key, GetZoneGraphTagFilterHash(MassTrafficSettings.TrafficLaneFilter));
+	Key = HashCombine(Key, GetZoneGraphTagFilterHash(MassTrafficSettings.IntersectionLaneFilter));
+	Key = HashCombine(Key, GetZoneGraphTagFilterHash(MassTrafficSettings.TrunkLaneFilter));
+	Key = HashCombine(Key, GetZoneGraphTagFilterHash(MassTrafficSettings.LaneChangingLaneFilter));
+
+	for (const FMassTrafficLaneSpeedLimit& LaneSpeedLimit : MassTrafficSettings.SpeedLimits)
+	{
+		Key = HashCombine(Key, GetZoneGraphTagFilterHash(LaneSpeedLimit.LaneFilter));
+		Key = HashCombine(Key, GetTypeHash(LaneSpeedLimit.SpeedLimitMPH));
+	}
+
+	for (const FMassTrafficLaneDensity& LaneDensity : MassTrafficSettings.LaneDensities)
+	{
+		Key = HashCombine(Key, GetZoneGraphTagFilterHash(LaneDensity.LaneFilter));
+		Key = HashCombine(Key, GetTypeHash(LaneDensity.DensityMultiplier));
+	}
+
+	return Key;
+}
+
+FString GetLaneDataCacheFilename(const UMassTrafficSettings& MassTrafficSettings, const uint32 CacheKey)
+{
+	return FPaths::Combine(FPaths::ProjectSavedDir(), MassTrafficSettings.LaneDataCacheDirectory, FString::Printf(TEXT("LaneData_%08X.bin"), CacheKey));
+}
+
+bool LoadLaneDataCache(const FString& Filename, const uint32 CacheKey, const FZoneGraphStorage& ZoneGraphStorage, FMassTrafficZoneGraphData& TrafficZoneGraphData)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(TEXT("LoadLaneDataCache"))
+
+	TUniquePtr<FArchive> Archive(IFileManager::Get().CreateFileReader(*Filename, FILEREAD_Silent));
+	if (!Archive.IsValid())
+	{
+		return false;
+	}
+
+	uint32 Magic = 0;
+	uint32 Version = 0;
+	uint32 Key = 0;
+	int32 NumLanes = 0;
+	int32 NumTrafficLanes = 0;
+	*Archive << Magic;
+	*Archive << Version;
+	*Archive << Key;
+	*Archive << NumLanes;
+	*Archive << NumTrafficLanes;
+	if (Archive->IsError() || Magic != LaneDataCacheMagic || Version != LaneDataCacheVersion || Key != CacheKey
+		|| NumLanes != ZoneGraphStorage.Lanes.Num() || NumTrafficLanes < 0 || NumTrafficLanes > NumLanes)
+	{
+		UE_LOG(LogMassTraffic, Warning, TEXT("%s - Ignoring out of date lane data cache '%s'"), ANSI_TO_TCHAR(__FUNCTION__), *Filename);
+		return false;
+	}
+
+	auto LogCorrupt = [&Filename]()
+	{
+		UE_LOG(LogMassTraffic, Warning, TEXT("%s - Ignoring corrupt lane data cache '%s'"), ANSI_TO_TCHAR(__FUNCTION__), *Filename);
+		return false;
+	};
+
+	TrafficZoneGraphData.DataHandle = ZoneGraphStorage.DataHandle;
+	TrafficZoneGraphData.TrafficLaneDataArray.Reset();
+	TrafficZoneGraphData.TrafficLaneDataArray.SetNum(NumTrafficLanes);
+	TrafficZoneGraphData.TrafficLaneDataLookup.Reset();
+	TrafficZoneGraphData.TrafficLaneDataLookup.SetNumZeroed(NumLanes);
+
+	TArray<FLaneLinkIndices> LaneLinkIndices;
+	LaneLinkIndices.SetNum(NumTrafficLanes);
+
+	for (int32 TrafficLaneIndex = 0; TrafficLaneIndex < NumTrafficLanes; ++TrafficLaneIndex)
+	{
+		FZoneGraphTrafficLaneData& TrafficLaneData = TrafficZoneGraphData.TrafficLaneDataArray[TrafficLaneIndex];
+
+		int32 LaneIndex = INDEX_NONE;
+		ELaneDataCacheFlags Flags = ELaneDataCacheFlags::None;
+		*Archive << LaneIndex;
+		*Archive << Flags;
+		*Archive << TrafficLaneData.Length;
+		*Archive << TrafficLaneData.CenterLocation;
+		*Archive << TrafficLaneData.Radius;
+		*Archive << TrafficLaneData.ConstData.SpeedLimit;
+		*Archive << TrafficLaneData.ConstData.AverageNextLanesSpeedLimit;
+		Archive->Serialize(&TrafficLaneData.MaxDensity, sizeof(TrafficLaneData.MaxDensity));
+
+		FLaneLinkIndices& LinkIndices = LaneLinkIndices[TrafficLaneIndex];
+		*Archive << LinkIndices.LeftLaneIndex;
+		*Archive << LinkIndices.RightLaneIndex;
+		if (!LoadLaneLinks(*Archive, LinkIndices.NextLaneIndices)
+			|| !LoadLaneLinks(*Archive, LinkIndices.MergingLaneIndices)
+			|| !LoadLaneLinks(*Archive, LinkIndices.SplittingLaneIndices)
+			|| !TrafficZoneGraphData.TrafficLaneDataLookup.IsValidIndex(LaneIndex)
+			|| TrafficZoneGraphData.TrafficLaneDataLookup[LaneIndex] != nullptr)
+		{
+			TrafficZoneGraphData.Reset();
+			return LogCorrupt();
+		}
+
+		TrafficLaneData.LaneHandle = FZoneGraphLaneHandle(LaneIndex, ZoneGraphStorage.DataHandle);
+		TrafficLaneData.SpaceAvailable = TrafficLaneData.Length;
+		TrafficLaneData.bTurnsLeft = EnumHasAnyFlags(Flags, ELaneDataCacheFlags::TurnsLeft);
+		TrafficLaneData.bTurnsRight = EnumHasAnyFlags(Flags, ELaneDataCacheFlags::TurnsRight);
+		TrafficLaneData.bIsRightMostLane = EnumHasAnyFlags(Flags, ELaneDataCacheFlags::IsRightMostLane);
+		TrafficLaneData.bIsDownstreamFromIntersection = EnumHasAnyFlags(Flags, ELaneDataCacheFlags::IsDownstreamFromIntersection);
+		TrafficLaneData.ConstData.bIsIntersectionLane = EnumHasAnyFlags(Flags, ELaneDataCacheFlags::IsIntersectionLane);
+		TrafficLaneData.ConstData.bIsTrunkLane = EnumHasAnyFlags(Flags, ELaneDataCacheFlags::IsTrunkLane);
+		TrafficLaneData.ConstData.bIsLaneChangingLane = EnumHasAnyFlags(Flags, ELaneDataCacheFlags::IsLaneChangingLane);
+
+		// TrafficLaneDataArray was sized up front, so these addresses are stable
+		TrafficZoneGraphData.TrafficLaneDataLookup[LaneIndex] = &TrafficLaneData;
+	}
+
+	// Now all the lanes are loaded, restore the links between them
+	for (int32 TrafficLaneIndex = 0; TrafficLaneIndex < NumTrafficLanes; ++TrafficLaneIndex)
+	{
+		FZoneGraphTrafficLaneData& TrafficLaneData = TrafficZoneGraphData.TrafficLaneDataArray[TrafficLaneIndex];
+		const FLaneLinkIndices& LinkIndices = LaneLinkIndices[TrafficLaneIndex];
+		if (!ResolveLaneLink(TrafficZoneGraphData, LinkIndices.LeftLaneIndex, TrafficLaneData.LeftLane)
+			|| !ResolveLaneLink(TrafficZoneGraphData, LinkIndices.RightLaneIndex, TrafficLaneData.RightLane)
+			|| !ResolveLaneLinks(TrafficZoneGraphData, LinkIndices.NextLaneIndices, TrafficLaneData.NextLanes)
+			|| !ResolveLaneLinks(TrafficZoneGraphData, LinkIndices.MergingLaneIndices, TrafficLaneData.MergingLanes)
+			|| !ResolveLaneLinks(TrafficZoneGraphData, LinkIndices.SplittingLaneIndices, TrafficLaneData.SplittingLanes))
+		{
+			TrafficZoneGraphData.Reset();
+			return LogCorrupt();
+		}
+	}
+
+	// Routing tables are derived from the links, so are rebuilt rather than cached
+	TrafficZoneGraphData.BuildNextLaneRoutes();
+
+	return true;
+}
+
+bool SaveLaneDataCache(const FString& Filename, const uint32 CacheKey, const FMassTrafficZoneGraphData& TrafficZoneGraphData)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(TEXT("SaveLaneDataCache"))
+
+	TUniquePtr<FArchive> Archive(IFileManager::Get().CreateFileWriter(*Filename));
+	if (!Archive.IsValid())
+	{
+		UE_LOG(LogMassTraffic, Warning, TEXT("%s - Couldn't open lane data cache '%s' for writing"), ANSI_TO_TCHAR(__FUNCTION__), *Filename);
+		return false;
+	}
+
+	uint32 Magic = LaneDataCacheMagic;
+	uint32 Version = LaneDataCacheVersion;
+	uint32 Key = CacheKey;
+	int32 NumLanes = TrafficZoneGraphData.TrafficLaneDataLookup.Num();
+	int32 NumTrafficLanes = TrafficZoneGraphData.TrafficLaneDataArray.Num();
+	*Archive << Magic;
+	*Archive << Version;
+	*Archive << Key;
+	*Archive << NumLanes;
+	*Archive << NumTrafficLanes;
+
+	for (const FZoneGraphTrafficLaneData& TrafficLaneData : TrafficZoneGraphData.TrafficLaneDataArray)
+	{
+		int32 LaneIndex = TrafficLaneData.LaneHandle.Index;
+		ELaneDataCacheFlags Flags = ELaneDataCacheFlags::None;
+		Flags |= TrafficLaneData.bTurnsLeft ? ELaneDataCacheFlags::TurnsLeft : ELaneDataCacheFlags::None;
+		Flags |= TrafficLaneData.bTurnsRight ? ELaneDataCacheFlags::TurnsRight : ELaneDataCacheFlags::None;
+		Flags |= TrafficLaneData.bIsRightMostLane ? ELaneDataCacheFlags::IsRightMostLane : ELaneDataCacheFlags::None;
+		Flags |= TrafficLaneData.bIsDownstreamFromIntersection ? ELaneDataCacheFlags::IsDownstreamFromIntersection : ELaneDataCacheFlags::None;
+		Flags |= TrafficLaneData.ConstData.bIsIntersectionLane ? ELaneDataCacheFlags::IsIntersectionLane : ELaneDataCacheFlags::None;
+		Flags |= TrafficLaneData.ConstData.bIsTrunkLane ? ELaneDataCacheFlags::IsTrunkLane : ELaneDataCacheFlags::None;
+		Flags |= TrafficLaneData.ConstData.bIsLaneChangingLane ? ELaneDataCacheFlags::IsLaneChangingLane : ELaneDataCacheFlags::None;
+
+		float Length = TrafficLaneData.Length;
+		FVector CenterLocation = TrafficLaneData.CenterLocation;
+		FFloat16 Radius = TrafficLaneData.Radius;
+		FFloat16 SpeedLimit = TrafficLaneData.ConstData.SpeedLimit;
+		FFloat16 AverageNextLanesSpeedLimit = TrafficLaneData.ConstData.AverageNextLanesSpeedLimit;
+		UE::MassTraffic::TFraction<false, uint8> MaxDensity(TrafficLaneData.MaxDensity);
+		int32 LeftLaneIndex = GetLaneIndex(TrafficLaneData.LeftLane);
+		int32 RightLaneIndex = GetLaneIndex(TrafficLaneData.RightLane);
+
+		*Archive << LaneIndex;
+		*Archive << Flags;
+		*Archive << Length;
+		*Archive << CenterLocation;
+		*Archive << Radius;
+		*Archive << SpeedLimit;
+		*Archive << AverageNextLanesSpeedLimit;
+		Archive->Serialize(&MaxDensity, sizeof(MaxDensity));
+		*Archive << LeftLaneIndex;
+		*Archive << RightLaneIndex;
+		SaveLaneLinks(*Archive, TrafficLaneData.NextLanes);
+		SaveLaneLinks(*Archive, TrafficLaneData.MergingLanes);
+		SaveLaneLinks(*Archive, TrafficLaneData.SplittingLanes);
+	}
+
+	return Archive->Close();
+}
+
+FString GetGroundSnapCacheFilename(const UMassTrafficSettings& MassTrafficSettings, const FString& ZoneGraphDataPath)
+{
+	return FPaths::Combine(FPaths::ProjectSavedDir(), MassTrafficSettings.LaneDataCacheDirectory, FString::Printf(TEXT("GroundSnap_%08X.bin"), GetTypeHash(ZoneGraphDataPath)));
+}
+
+bool LoadGroundSnapCache(const FString& Filename, const uint32 CacheKey, FGroundSnapCache& OutGroundSnapCache)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(TEXT("LoadGroundSnapCache"))
+
+	OutGroundSnapCache.Reset();
+
+	TUniquePtr<FArchive> Archive(IFileManager::Get().CreateFileReader(*Filename, FILEREAD_Silent));
+	if (!Archive.IsValid())
+	{
+		return false;
+	}
+
+	uint32 Magic = 0;
+	uint32 Version = 0;
+	uint32 Key = 0;
+	int32 NumEntries = 0;
+	*Archive << Magic;
+	*Archive << Version;
+	*Archive << Key;
+	*Archive << NumEntries;
+	if (Archive->IsError() || Magic != GroundSnapCacheMagic || Version != GroundSnapCacheVersion || Key != CacheKey || NumEntries < 0)
+	{
+		UE_LOG(LogMassTraffic, Warning, TEXT("%s - Ignoring out of date ground snap cache '%s'"), ANSI_TO_TCHAR(__FUNCTION__), *Filename);
+		return false;
+	}
+
+	OutGroundSnapCache.Reserve(NumEntries);
+	for (int32 EntryIndex = 0; EntryIndex < NumEntries; ++EntryIndex)
+	{
+		FIntPoint LanePointKey;
+		FGroundSnapCacheEntry Entry;
+		*Archive << LanePointKey;
+		*Archive << Entry.SourcePoint;
+		*Archive << Entry.SnappedPoint;
+		*Archive << Entry.ImpactPoint;
+		*Archive << Entry.ImpactNormal;
+		*Archive << Entry.GeometryHash;
+		*Archive << Entry.bHit;
+		if (Archive->IsError())
+		{
+			OutGroundSnapCache.Reset();
+			UE_LOG(LogMassTraffic, Warning, TEXT("%s - Ignoring corrupt ground snap cache '%s'"), ANSI_TO_TCHAR(__FUNCTION__), *Filename);
+			return false;
+		}
+		OutGroundSnapCache.Add(LanePointKey, Entry);
+	}
+
+	return true;
+}
+
+bool SaveGroundSnapCache(const FString& Filename, const uint32 CacheKey, const FGroundSnapCache& GroundSnapCache)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(TEXT("SaveGroundSnapCache"))
+
+	TUniquePtr<FArchive> Archive(IFileManager::Get().CreateFileWriter(*Filename));
+	if (!Archive.IsValid())
+	{
+		UE_LOG(LogMassTraffic, Warning, TEXT("%s - Couldn't open ground snap cache '%s' for writing"), ANSI_TO_TCHAR(__FUNCTION__), *Filename);
+		return false;
+	}
+
+	uint32 Magic = GroundSnapCacheMagic;
+	uint32 Version = GroundSnapCacheVersion;
+	uint32 Key = CacheKey;
+	int32 NumEntries = GroundSnapCache.Num();
+	*Archive << Magic;
+	*Archive << Version;
+	*Archive << Key;
+	*Archive << NumEntries;
+
+	for (const TPair<FIntPoint, FGroundSnapCacheEntry>& CacheEntry : GroundSnapCache)
+	{
+		FIntPoint LanePointKey = CacheEntry.Key;
+		FGroundSnapCacheEntry Entry = CacheEntry.Value;
+		*Archive << LanePointKey;
+		*Archive << Entry.SourcePoint;
+		*Archive << Entry.SnappedPoint;
+		*Archive << Entry.ImpactPoint;
+		*Archive << Entry.ImpactNormal;
+		*Archive << Entry.GeometryHash;
+		*Archive << Entry.bHit;
+	}
+
+	return Archive->Close();
+}
+
+}
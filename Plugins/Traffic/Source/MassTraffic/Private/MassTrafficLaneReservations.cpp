@@ -0,0 +1,135 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "MassTrafficLaneReservations.h"
+#include "MassTrafficFragments.h"
+#include "MassTrafficTypes.h"
+
+#include "MassZoneGraphNavigationFragments.h"
+
+#include "Misc/ScopeLock.h"
+
+
+FMassTrafficLaneReservationBuffer& FMassTrafficLaneReservations::AddBuffer()
+{
+	FScopeLock ScopeLock(&BuffersCriticalSection);
+
+	if (NumUsedBuffers == Buffers.Num())
+	{
+		Buffers.Add(MakeUnique<FMassTrafficLaneReservationBuffer>());
+	}
+
+	FMassTrafficLaneReservationBuffer& Buffer = *Buffers[NumUsedBuffers++];
+	Buffer.Reservations.Reset();
+	Buffer.LaneLocationFragments = TArrayView<FMassZoneGraphLaneLocationFragment>();
+	Buffer.DistancesAlongLane.Reset();
+	return Buffer;
+}
+
+void FMassTrafficLaneReservations::ApplyDistancesAlongLane()
+{
+	// Each buffer only covers its own chunk's entities, so the order these are written in doesn't matter
+	for (int32 BufferIndex = 0; BufferIndex < NumUsedBuffers; ++BufferIndex)
+	{
+		FMassTrafficLaneReservationBuffer& Buffer = *Buffers[BufferIndex];
+		check(Buffer.DistancesAlongLane.IsEmpty() || Buffer.DistancesAlongLane.Num() == Buffer.LaneLocationFragments.Num());
+		for (int32 EntityIndex = 0; EntityIndex < Buffer.DistancesAlongLane.Num(); ++EntityIndex)
+		{
+			Buffer.LaneLocationFragments[EntityIndex].DistanceAlongLane = Buffer.DistancesAlongLane[EntityIndex];
+		}
+	}
+}
+
+TConstArrayView<FMassTrafficLaneReservation> FMassTrafficLaneReservations::Sort()
+{
+	SortedReservations.Reset();
+	for (int32 BufferIndex = 0; BufferIndex < NumUsedBuffers; ++BufferIndex)
+	{
+		SortedReservations.Append(Buffers[BufferIndex]->Reservations);
+		Buffers[BufferIndex]->Reservations.Reset();
+		Buffers[BufferIndex]->DistancesAlongLane.Reset();
+	}
+	NumUsedBuffers = 0;
+
+	// All of an entity's reservations are recorded by the one chunk it's in, so entity & sequence is a total order that
+	// doesn't depend on which buffer (or thread) recorded them.
+	SortedReservations.Sort([](const FMassTrafficLaneReservation& A, const FMassTrafficLaneReservation& B)
+	{
+		return A.Entity.Index != B.Entity.Index ? A.Entity.Index < B.Entity.Index : A.Sequence < B.Sequence;
+	});
+
+	return SortedReservations;
+}
+
+void FMassTrafficLaneReservations::Apply(const FMassTrafficLaneReservation& Reservation, const float DownstreamFlowDensityMixtureFraction)
+{
+	FZoneGraphTrafficLaneData* Lane = Reservation.Lane;
+	if (!Lane)
+	{
+		return;
+	}
+
+	switch (Reservation.Type)
+	{
+		case EMassTrafficLaneReservationType::ReserveLane:
+			++Lane->NumReservedVehiclesOnLane;
+			if (Reservation.VehicleControlFragment)
+			{
+				Reservation.VehicleControlFragment->bCantStopAtLaneExit = true; // (See all CANTSTOPLANEEXIT.)
+			}
+			break;
+
+		case EMassTrafficLaneReservationType::ReleaseLane:
+			--Lane->NumReservedVehiclesOnLane;
+			if (Reservation.VehicleControlFragment)
+			{
+				Reservation.VehicleControlFragment->bCantStopAtLaneExit = false; // (See all CANTSTOPLANEEXIT.)
+			}
+			break;
+
+		case EMassTrafficLaneReservationType::ApproachLane:
+			++Lane->NumVehiclesApproachingLane;
+			break;
+
+		case EMassTrafficLaneReservationType::LeaveApproachingLane:
+			--Lane->NumVehiclesApproachingLane;
+			break;
+
+		case EMassTrafficLaneReservationType::SetVehicleReadyToUseLane:
+			Lane->bIsVehicleReadyToUseLane = true;
+			break;
+
+		case EMassTrafficLaneReservationType::ClearVehicleReadyToUseLane:
+			Lane->bIsVehicleReadyToUseLane = false;
+			break;
+
+		case EMassTrafficLaneReservationType::SetStoppedVehicleOverlappingLane:
+			Lane->bIsStoppedVehicleInPreviousLaneOverlappingThisLane = true;
+			break;
+
+		case EMassTrafficLaneReservationType::UpdateDownstreamFlowDensity:
+			Lane->UpdateDownstreamFlowDensity(DownstreamFlowDensityMixtureFraction);
+			break;
+
+		case EMassTrafficLaneReservationType::VehicleAction:
+			break;
+	}
+}
+
+void FMassTrafficLaneReservations::SortAndApply(const float DownstreamFlowDensityMixtureFraction)
+{
+	for (const FMassTrafficLaneReservation& Reservation : Sort())
+	{
+		Apply(Reservation, DownstreamFlowDensityMixtureFraction);
+	}
+}
+
+void FMassTrafficLaneReservations::Reset()
+{
+	for (TUniquePtr<FMassTrafficLaneReservationBuffer>& Buffer : Buffers)
+	{
+		Buffer->Reservations.Reset();
+		Buffer->DistancesAlongLane.Reset();
+	}
+	NumUsedBuffers = 0;
+	SortedReservations.Reset();
+}
@@ -3,9 +3,11 @@
 #include "MassTrafficLightVisualizationProcessor.h"
 #include "MassTrafficLights.h"
 #include "MassTrafficSubsystem.h"
+#include "MassTraffic.h"
 
 #include "MassActorSubsystem.h"
 #include "MassLODCollectorProcessor.h"
+#include "MassLODFragments.h"
 #include "MassRepresentationSubsystem.h"
 #include "VisualLogger/VisualLogger.h"
 #include "Components/MeshComponent.h"
@@ -63,6 +65,7 @@ void UMassTrafficLightVisualizationProcessor::ConfigureQueries()
 
 UMassTrafficLightUpdateCustomVisualizationProcessor::UMassTrafficLightUpdateCustomVisualizationProcessor()
 	: EntityQuery(*this)
+	, CulledStaticInstancesEntityQuery(*this)
 {
 	ExecutionFlags = static_cast<int32>(EProcessorExecutionFlags::Client | EProcessorExecutionFlags::Standalone);
 	bAutoRegisterWithProcessingPhases = true;
@@ -82,26 +85,52 @@ void UMassTrafficLightUpdateCustomVisualizationProcessor::ConfigureQueries()
 	EntityQuery.AddChunkRequirement<FMassVisualizationChunkFragment>(EMassFragmentAccess::ReadWrite);
 	EntityQuery.AddSharedRequirement<FMassRepresentationSubsystemSharedFragment>(EMassFragmentAccess::ReadWrite);
 	EntityQuery.AddConstSharedRequirement<FMassTrafficLightsParameters>();
+	EntityQuery.AddRequirement<FMassTrafficStaticInstancesFragment>(EMassFragmentAccess::ReadWrite);
 
 	EntityQuery.SetChunkFilter(&FMassVisualizationChunkFragment::AreAnyEntitiesVisibleInChunk);
 #if ENABLE_VISUAL_LOG
 	EntityQuery.AddSubsystemRequirement<UMassTrafficSubsystem>(EMassFragmentAccess::ReadOnly);
 #endif // ENABLE_VISUAL_LOG
+
+	CulledStaticInstancesEntityQuery.AddRequirement<FMassTrafficIntersectionFragment>(EMassFragmentAccess::ReadOnly);
+	CulledStaticInstancesEntityQuery.AddTagRequirement<FMassTrafficHasStaticInstancesTag>(EMassFragmentPresence::All);
+	CulledStaticInstancesEntityQuery.AddTagRequirement<FMassVisibilityCulledByDistanceTag>(EMassFragmentPresence::All);
+	CulledStaticInstancesEntityQuery.AddRequirement<FMassTrafficStaticInstancesFragment>(EMassFragmentAccess::ReadWrite);
+
+	ProcessorRequirements.AddSubsystemRequirement<UMassTrafficSubsystem>(EMassFragmentAccess::ReadWrite);
 }
 
 void UMassTrafficLightUpdateCustomVisualizationProcessor::Execute(FMassEntityManager& EntityManager, FMassExecutionContext& Context)
 {
+	FMassTrafficStaticInstances& StaticInstances = Context.GetMutableSubsystemChecked<UMassTrafficSubsystem>(EntityManager.GetWorld()).GetMutableTrafficLightStaticInstances();
+
 	// Visualize traffic lights at all?
 	if (!GMassTrafficTrafficLights)
 	{
+		if (StaticInstances.Num() > 0)
+		{
+			StaticInstances.Reset();
+		}
 		return;
 	}
 
+	// Traffic light transforms never change, so by default we keep persistent instances for them which are only
+	// updated when their light state (custom data) or LOD changes, rather than resubmitting them every frame
+	const bool bUseStaticInstances = GMassTrafficStaticInstances != 0;
+	if (bUseStaticInstances)
+	{
+		StaticInstances.BeginUpdate(*EntityManager.GetWorld());
+	}
+	else if (StaticInstances.Num() > 0)
+	{
+		StaticInstances.Reset();
+	}
+
 	{
 		TRACE_CPUPROFILER_EVENT_SCOPE(TEXT("Visual Updates")) 
 
 		// Visualize entities
-		EntityQuery.ForEachEntityChunk(EntityManager, Context, [this](FMassExecutionContext& Context)
+		EntityQuery.ForEachEntityChunk(EntityManager, Context, [this, &StaticInstances, bUseStaticInstances](FMassExecutionContext& Context)
 		{
 			UMassRepresentationSubsystem* RepresentationSubsystem = Context.GetSharedFragment<FMassRepresentationSubsystemSharedFragment>().RepresentationSubsystem;
 			check(RepresentationSubsystem);
@@ -114,6 +143,8 @@ void UMassTrafficLightUpdateCustomVisualizationProcessor::Execute(FMassEntityMan
 			const TConstArrayView<FMassRepresentationLODFragment> VisualizationLODFragments = Context.GetFragmentView<FMassRepresentationLODFragment>();
 			const TArrayView<FMassRepresentationFragment> VisualizationFragments = Context.GetMutableFragmentView<FMassRepresentationFragment>(); 
 			const TArrayView<FMassActorFragment> ActorList = Context.GetMutableFragmentView<FMassActorFragment>();
+			const TArrayView<FMassTrafficStaticInstancesFragment> StaticInstancesFragments = Context.GetMutableFragmentView<FMassTrafficStaticInstancesFragment>();
+			const bool bHadStaticInstances = Context.DoesArchetypeHaveTag<FMassTrafficHasStaticInstancesTag>();
 
 			for (int32 Index = 0; Index < NumEntities; Index++)
 			{
@@ -124,12 +155,20 @@ void UMassTrafficLightUpdateCustomVisualizationProcessor::Execute(FMassEntityMan
 
 				AActor* Actor = ActorInfo.GetMutable();
 
+				// No longer instanced, e.g: switched to an actor
+				if (bHadStaticInstances && VisualizationFragment.CurrentRepresentation != EMassRepresentationType::StaticMeshInstance)
+				{
+					StaticInstances.RemoveInstances(StaticInstancesFragments[Index]);
+					Context.Defer().RemoveTag<FMassTrafficHasStaticInstancesTag>(Context.GetEntity(Index));
+				}
+
 				// We only support StaticMeshInstances for traffic lights.
 				if(VisualizationFragment.CurrentRepresentation == EMassRepresentationType::StaticMeshInstance)
 				{
 					// Visualize lights
-					for (const FMassTrafficLight& TrafficLight : TrafficIntersectionFragment.TrafficLights)
+					for (int32 LightIndex = 0; LightIndex < TrafficIntersectionFragment.TrafficLights.Num(); ++LightIndex)
 					{
+						const FMassTrafficLight& TrafficLight = TrafficIntersectionFragment.TrafficLights[LightIndex];
 						check(TrafficLightsParams.TrafficLightTypesStaticMeshDescIndex.IsValidIndex(TrafficLight.TrafficLightTypeIndex));
 						const int16 TrafficLightTypesStaticMeshDescIndex = TrafficLightsParams.TrafficLightTypesStaticMeshDescIndex[TrafficLight.TrafficLightTypeIndex];
 						if (TrafficLightTypesStaticMeshDescIndex != INDEX_NONE)
@@ -140,9 +179,17 @@ void UMassTrafficLightUpdateCustomVisualizationProcessor::Execute(FMassEntityMan
 							// Prepare custom data
 							const FMassTrafficLightInstanceCustomData PackedCustomData(TrafficLight.TrafficLightStateFlags);
 
-							// Add instance with custom data 
-							ISMInfo[TrafficLightTypesStaticMeshDescIndex].AddBatchedTransform(GetTypeHash(Context.GetEntity(Index)), IntersectionLightTransform, IntersectionLightTransform, VisualizationLODFragment.LODSignificance);
-							ISMInfo[TrafficLightTypesStaticMeshDescIndex].AddBatchedCustomData(PackedCustomData, VisualizationLODFragment.LODSignificance);
+							if (bUseStaticInstances)
+							{
+								// Keep instance, only updating it if its custom data or LOD changed
+								StaticInstances.SetInstance(StaticInstancesFragments[Index], /*SubIndex*/LightIndex, TrafficLightTypesStaticMeshDescIndex, ISMInfo[TrafficLightTypesStaticMeshDescIndex].GetDesc(), IntersectionLightTransform, VisualizationLODFragment.LODSignificance, PackedCustomData.PackedParam1);
+							}
+							else
+							{
+								// Add instance with custom data 
+								ISMInfo[TrafficLightTypesStaticMeshDescIndex].AddBatchedTransform(GetTypeHash(Context.GetEntity(Index)), IntersectionLightTransform, IntersectionLightTransform, VisualizationLODFragment.LODSignificance);
+								ISMInfo[TrafficLightTypesStaticMeshDescIndex].AddBatchedCustomData(PackedCustomData, VisualizationLODFragment.LODSignificance);
+							}
 
 							// Debug
 							#if WITH_MASSTRAFFIC_DEBUG
@@ -153,6 +200,11 @@ void UMassTrafficLightUpdateCustomVisualizationProcessor::Execute(FMassEntityMan
 							#endif
 						}
 					}
+
+					if (!bHadStaticInstances && StaticInstances.HasInstances(StaticInstancesFragments[Index]))
+					{
+						Context.Defer().AddTag<FMassTrafficHasStaticInstancesTag>(Context.GetEntity(Index));
+					}
 				}
 				else if (Actor)
 				{
@@ -176,6 +228,22 @@ void UMassTrafficLightUpdateCustomVisualizationProcessor::Execute(FMassEntityMan
 		});
 	}
 
+	if (bUseStaticInstances)
+	{
+		// Remove light instances of intersections that were culled by distance, whose chunks we no longer visit above
+		CulledStaticInstancesEntityQuery.ForEachEntityChunk(EntityManager, Context, [&StaticInstances](FMassExecutionContext& Context)
+		{
+			const TArrayView<FMassTrafficStaticInstancesFragment> StaticInstancesFragments = Context.GetMutableFragmentView<FMassTrafficStaticInstancesFragment>();
+			for (int32 Index = 0; Index < Context.GetNumEntities(); ++Index)
+			{
+				StaticInstances.RemoveInstances(StaticInstancesFragments[Index]);
+				Context.Defer().RemoveTag<FMassTrafficHasStaticInstancesTag>(Context.GetEntity(Index));
+			}
+		});
+
+		StaticInstances.EndUpdate();
+	}
+
 #if ENABLE_VISUAL_LOG
 
 	// Debug draw current visualization
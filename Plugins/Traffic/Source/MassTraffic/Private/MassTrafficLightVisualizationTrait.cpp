@@ -83,4 +83,5 @@ void UMassTrafficLightVisualizationTrait::BuildTemplate(FMassEntityTemplateBuild
 	BuildContext.AddConstSharedFragment(TrafficLightsParamsFragment);
 
 	BuildContext.AddFragment<FMassActorFragment>();
+	BuildContext.AddFragment<FMassTrafficStaticInstancesFragment>();
 }
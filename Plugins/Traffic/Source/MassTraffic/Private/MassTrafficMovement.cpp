@@ -264,6 +264,7 @@ void MoveVehicleToNextLane(
 		
 		CurrentLane.RemoveVehicleOccupancy(SpaceTakenByVehicleOnLane);
 	}
+	CurrentLane.RemoveVehicle(VehicleEntity);
 	
 	// Subtract the current lane length from distance, leaving how much overshot, as the distance on the next lane
 	LaneLocationFragment.DistanceAlongLane -= LaneLocationFragment.LaneLength;
@@ -375,6 +376,7 @@ void MoveVehicleToNextLane(
 	
 	// Make this the new tail vehicle of the next lane
 	NewCurrentLane.TailVehicle = VehicleEntity;
+	NewCurrentLane.AddTailVehicle(VehicleEntity, LaneLocationFragment.DistanceAlongLane, AgentRadiusFragment.Radius);
 
 	// Lane changing should be pre-clamped to complete at the lane's end. However, for Off LOD vehicles with large
 	// delta times, they can leapfrog the lane change end distance in a single frame & onto the next lane, never seeing
@@ -724,6 +726,8 @@ bool TeleportVehicleToAnotherLane(
 		{
 			TrafficLaneData_Current.TailVehicle = FMassEntityHandle();
 		}
+
+		TrafficLaneData_Current.RemoveVehicle(Entity_Current);
 	}
 
 	// Before inserting Entity_Current into Lane_Chosen, first we need to break any NextVehicle references to
@@ -784,6 +788,15 @@ bool TeleportVehicleToAnotherLane(
 
 			Lane_Chosen.TailVehicle = Entity_Current;
 		}
+
+		if (Entity_Chosen_Behind.IsSet())
+		{
+			Lane_Chosen.InsertVehicleAhead(Entity_Chosen_Behind, Entity_Current, DistanceAlongLane_Chosen, RadiusFragment_Current.Radius);
+		}
+		else
+		{
+			Lane_Chosen.AddTailVehicle(Entity_Current, DistanceAlongLane_Chosen, RadiusFragment_Current.Radius);
+		}
 	}		
 
 	// NOTE - VehicleControlFragment_Current.NextTrafficLaneData->AddVehicleApproachingLane() can't be set here, since
@@ -857,4 +870,148 @@ bool TeleportVehicleToAnotherLane(
 	return true;
 }
 
+void RebuildLaneVehicles(
+	FMassEntityManager& EntityManager,
+	UMassTrafficSubsystem& MassTrafficSubsystem,
+	TArray<FMassEntityHandle>& Vehicles)
+{
+	// Sort first by lane, and then by distance
+	Vehicles.Sort(
+		[&EntityManager](const FMassEntityHandle& EntityA, const FMassEntityHandle& EntityB)
+		{
+			const FMassZoneGraphLaneLocationFragment& A = EntityManager.GetFragmentDataChecked<FMassZoneGraphLaneLocationFragment>(EntityA);
+			const FMassZoneGraphLaneLocationFragment& B = EntityManager.GetFragmentDataChecked<FMassZoneGraphLaneLocationFragment>(EntityB);
+
+			if (A.LaneHandle == B.LaneHandle)
+			{
+				return A.DistanceAlongLane < B.DistanceAlongLane;
+			}
+			else if (A.LaneHandle.DataHandle == B.LaneHandle.DataHandle)
+			{
+				return A.LaneHandle.Index < B.LaneHandle.Index;
+			}
+			else
+			{
+				return A.LaneHandle.DataHandle.Index < B.LaneHandle.DataHandle.Index;
+			}
+		}
+	);
+
+	// Rebuild the per-lane vehicle arrays in lane order. Vehicles is already sorted by lane then distance, so
+	// appending keeps each lane's array ordered from its tail vehicle.
+	for (FMassTrafficZoneGraphData* TrafficZoneGraphData : MassTrafficSubsystem.GetMutableTrafficZoneGraphData())
+	{
+		for (FZoneGraphTrafficLaneData& TrafficLaneData : TrafficZoneGraphData->TrafficLaneDataArray)
+		{
+			TrafficLaneData.Vehicles.Reset();
+			TrafficLaneData.TailVehicle.Reset();
+		}
+	}
+	for (const FMassEntityHandle& VehicleEntity : Vehicles)
+	{
+		const FMassEntityView VehicleEntityView(EntityManager, VehicleEntity);
+		const FMassZoneGraphLaneLocationFragment& LaneLocationFragment = VehicleEntityView.GetFragmentData<FMassZoneGraphLaneLocationFragment>();
+		if (FZoneGraphTrafficLaneData* TrafficLaneData = MassTrafficSubsystem.GetMutableTrafficLaneData(LaneLocationFragment.LaneHandle))
+		{
+			const FAgentRadiusFragment& AgentRadiusFragment = VehicleEntityView.GetFragmentData<FAgentRadiusFragment>();
+			TrafficLaneData->Vehicles.Emplace(VehicleEntity, LaneLocationFragment.DistanceAlongLane, AgentRadiusFragment.Radius);
+		}
+	}
+	if (Vehicles.IsEmpty())
+	{
+		return;
+	}
+
+	// Set Next pointers
+	bool bTail = true;
+	for (int32 Index = 0; Index < Vehicles.Num() - 1; ++Index)
+	{
+		const FMassEntityHandle& VehicleEntity = Vehicles[Index];
+		FMassEntityView VehicleEntityView(EntityManager, VehicleEntity);
+		FMassZoneGraphLaneLocationFragment& LaneLocationFragment = VehicleEntityView.GetFragmentData<FMassZoneGraphLaneLocationFragment>();
+		FMassTrafficNextVehicleFragment& NextVehicleFragment = VehicleEntityView.GetFragmentData<FMassTrafficNextVehicleFragment>();
+		
+		const FMassEntityHandle& NextVehicleEntity = Vehicles[Index+1];
+		const FMassZoneGraphLaneLocationFragment& NextLaneLocationFragment = EntityManager.GetFragmentDataChecked<FMassZoneGraphLaneLocationFragment>(NextVehicleEntity);
+
+		// First in lane? 
+		if (bTail)
+		{
+			if (FZoneGraphTrafficLaneData* TrafficLaneData = MassTrafficSubsystem.GetMutableTrafficLaneData(LaneLocationFragment.LaneHandle))
+			{
+				TrafficLaneData->TailVehicle = VehicleEntity;
+			}
+			bTail = false;
+		}
+
+		if (LaneLocationFragment.LaneHandle == NextLaneLocationFragment.LaneHandle)
+		{
+			NextVehicleFragment.SetNextVehicle(VehicleEntity, NextVehicleEntity);
+		}
+		else
+		{
+			NextVehicleFragment.UnsetNextVehicle();
+
+			bTail = true;
+		}
+	}
+
+	// Process last in list
+	const FMassEntityHandle& LastVehicleEntity = Vehicles.Last();
+	const FMassEntityView LastVehicleEntityView(EntityManager, LastVehicleEntity);
+	const FMassZoneGraphLaneLocationFragment& LastLaneLocationFragment = LastVehicleEntityView.GetFragmentData<FMassZoneGraphLaneLocationFragment>();
+	FMassTrafficNextVehicleFragment& LastNextVehicleFragment = LastVehicleEntityView.GetFragmentData<FMassTrafficNextVehicleFragment>();
+
+	// Last in list, implicitly has no next vehicle
+	LastNextVehicleFragment.UnsetNextVehicle();
+
+	// It may be first in its lane though?
+	if (bTail)
+	{
+		if (FZoneGraphTrafficLaneData* TrafficLaneData = MassTrafficSubsystem.GetMutableTrafficLaneData(LastLaneLocationFragment.LaneHandle))
+		{
+			TrafficLaneData->TailVehicle = LastVehicleEntity;
+		}
+	}
+	
+	// Now that all the vehicles have been assigned to their lanes, go through and connect the last vehicle on each
+	// lane to the closest first vehicle in the next connected lanes 
+	for (const FMassEntityHandle& VehicleEntity : Vehicles)
+	{
+		const FMassEntityView VehicleEntityView(EntityManager, VehicleEntity);
+		const FMassZoneGraphLaneLocationFragment& LaneLocationFragment = VehicleEntityView.GetFragmentData<FMassZoneGraphLaneLocationFragment>();
+		FMassTrafficNextVehicleFragment& NextVehicleFragment = VehicleEntityView.GetFragmentData<FMassTrafficNextVehicleFragment>();
+
+		// Is this the last vehicle in it's lane?
+		if (!NextVehicleFragment.HasNextVehicle())
+		{
+			if (const FZoneGraphTrafficLaneData* TrafficLaneData = MassTrafficSubsystem.GetTrafficLaneData(LaneLocationFragment.LaneHandle))
+			{
+				// Find the closest tail vehicle across all connected lanes
+				FMassEntityHandle ClosestTail = FMassEntityHandle();
+				float ClosestTailDistance = TNumericLimits<float>::Max();
+
+				for (const FZoneGraphTrafficLaneData* NextTrafficLaneData : TrafficLaneData->NextLanes)
+				{
+					if (NextTrafficLaneData->TailVehicle.IsSet())
+					{
+						const FMassZoneGraphLaneLocationFragment& TailVehicleLaneLocation = EntityManager.GetFragmentDataChecked<FMassZoneGraphLaneLocationFragment>(NextTrafficLaneData->TailVehicle);
+						if (TailVehicleLaneLocation.DistanceAlongLane < ClosestTailDistance)
+						{
+							ClosestTailDistance = TailVehicleLaneLocation.DistanceAlongLane; 
+							ClosestTail = NextTrafficLaneData->TailVehicle;
+						}
+					}
+				}
+
+				if (ClosestTail.IsSet())
+				{
+					// Set the closest subsequent tail as this vehicles Next
+					NextVehicleFragment.SetNextVehicle(VehicleEntity, ClosestTail);
+				}
+			}
+		}
+	}
+}
+
 }
@@ -58,6 +58,12 @@ void UMassTrafficOverseerProcessor::ConfigureQueries()
 
 void UMassTrafficOverseerProcessor::Execute(FMassEntityManager& EntityManager, FMassExecutionContext& Context)
 {
+	// Skip during replay playback and on frames without fixed timestep substeps
+	if (!ShouldSimulateTrafficVehicles())
+	{
+		return;
+	}
+
 	// Skip density management?
 	if (GMassTrafficOverseer <= 0)
 	{
@@ -309,6 +315,7 @@ void UMassTrafficOverseerProcessor::Execute(FMassEntityManager& EntityManager, F
 
 				// Try and move the vehicle to one of the least busiest lanes off screen
 				const bool bTransferred = MoveVehicleToFreeSpaceOnRandomLane(EntityManager, *ZoneGraphStorage,
+					MassTrafficSubsystem.GetLaneSegmentTable(LaneLocationFragment.LaneHandle.DataHandle),
 					RecyclableTrafficVehicle,
 					RadiusFragment,
 					RandomFractionFragment,
@@ -428,6 +435,7 @@ void UMassTrafficOverseerProcessor::Execute(FMassEntityManager& EntityManager, F
 				
 				// Try and move the vehicle to one of the least busiest lanes
 				const bool bTransferred = MoveVehicleToFreeSpaceOnRandomLane(EntityManager, *ZoneGraphStorage,
+				                                                             LocalMassTrafficSubsystem.GetLaneSegmentTable(BusiestLaneVehicle_LaneLocationFragment.LaneHandle.DataHandle),
 				                                                             BusiestLaneVehicle_EntityView.GetEntity(),
 				                                                             BusiestLaneVehicle_RadiusFragment,
 				                                                             BusiestLaneVehicle_RandomFractionFragment,
@@ -473,6 +481,7 @@ void UMassTrafficOverseerProcessor::Execute(FMassEntityManager& EntityManager, F
 bool UMassTrafficOverseerProcessor::MoveVehicleToFreeSpaceOnRandomLane(
 	const FMassEntityManager& EntityManager,
 	const FZoneGraphStorage& ZoneGraphStorage,
+	const FMassTrafficLaneSegmentTable* LaneSegmentTable,
 	const FMassEntityHandle VehicleEntity,
 	const FAgentRadiusFragment& Vehicle_RadiusFragment,
 	const FMassTrafficRandomFractionFragment& Vehicle_RandomFractionFragment,
@@ -700,6 +709,7 @@ bool UMassTrafficOverseerProcessor::MoveVehicleToFreeSpaceOnRandomLane(
 		FTransform NewLaneLocationTransform;
 		UE::MassTraffic::InterpolatePositionAndOrientationAlongLane(
 			ZoneGraphStorage,
+			LaneSegmentTable,
 			Vehicle_LaneLocationFragment.LaneHandle.Index,
 			Vehicle_LaneLocationFragment.DistanceAlongLane,
 			ETrafficVehicleMovementInterpolationMethod::CubicBezier,
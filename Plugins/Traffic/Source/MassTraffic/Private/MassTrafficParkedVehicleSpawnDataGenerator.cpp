@@ -6,8 +6,26 @@
 #include "MassTrafficInitParkedVehiclesProcessor.h"
 #include "MassTrafficParkedVehicles.h"
 #include "MassTrafficSubsystem.h"
+#include "MassTrafficUtils.h"
 #include "Algo/Accumulate.h"
 
+void UMassTrafficParkedVehicleSpawnDataGenerator::RemoveParkingSpacesNearObstacles(TArray<FTransform>& ParkingSpaceTransforms, const UE::MassTraffic::FObstacleExclusionGrid& ObstacleExclusionGrid)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(TEXT("RemoveParkingSpacesNearObstacles"))
+
+	for (int32 ParkingSpaceIndex = 0; ParkingSpaceIndex < ParkingSpaceTransforms.Num(); )
+	{
+		if (ObstacleExclusionGrid.IsNearObstacle(ParkingSpaceTransforms[ParkingSpaceIndex].GetLocation()))
+		{
+			ParkingSpaceTransforms.RemoveAtSwap(ParkingSpaceIndex);
+		}
+		else
+		{
+			++ParkingSpaceIndex;
+		}
+	}
+}
+
 void UMassTrafficParkedVehicleSpawnDataGenerator::Generate(
 	UObject& QueryOwner,
 	TConstArrayView<FMassSpawnedEntityType> EntityTypes,
@@ -123,9 +141,9 @@ void UMassTrafficParkedVehicleSpawnDataGenerator::Generate(
 	}
 	
 	// Get a list of obstacles to avoid when spawning
-	const float ObstacleRadiusSquared = FMath::Square(ObstacleExclusionRadius);
 	TArray<FVector> ObstacleLocationsToAvoid;
 	MassTrafficSubsystem->GetAllObstacleLocations(ObstacleLocationsToAvoid);
+	const UE::MassTraffic::FObstacleExclusionGrid ObstacleExclusionGrid(ObstacleLocationsToAvoid, ObstacleExclusionRadius);
 
 	// Prepare results
 	TArray<FMassEntitySpawnDataGeneratorResult> Results;
@@ -157,29 +175,7 @@ void UMassTrafficParkedVehicleSpawnDataGenerator::Generate(
 			AvailableParkingSpacesForType.RightChopInline(SpawnData.Transforms.Num());
 
 			// Remove parking spaces overlapping obstacles
-			for (int32 ParkingSpaceIndex = 0; ParkingSpaceIndex < SpawnData.Transforms.Num(); )
-			{
-				const FVector ParkingSpacePosition = SpawnData.Transforms[ParkingSpaceIndex].GetLocation();
-
-				bool bOverlapsObstacle = false;
-				for(const FVector & ObstacleLocation : ObstacleLocationsToAvoid)
-				{
-					if (FVector::DistSquared(ParkingSpacePosition, ObstacleLocation) < ObstacleRadiusSquared)
-					{
-						bOverlapsObstacle = true;
-						break;
-					}
-				}
-
-				if (bOverlapsObstacle)
-				{
-					SpawnData.Transforms.RemoveAtSwap(ParkingSpaceIndex);
-				}
-				else
-				{
-					++ParkingSpaceIndex;
-				}
-			}
+			RemoveParkingSpacesNearObstacles(SpawnData.Transforms, ObstacleExclusionGrid);
 
 			// Spawn vehicles in remaining parking spaces
 			Result.NumEntities = SpawnData.Transforms.Num();
@@ -3,8 +3,10 @@
 #include "MassTrafficParkedVehicleVisualizationProcessor.h"
 #include "MassTrafficVehicleVisualizationProcessor.h"
 #include "MassTrafficSubsystem.h"
+#include "MassTraffic.h"
 #include "MassRepresentationSubsystem.h"
 #include "MassEntityManager.h"
+#include "MassLODFragments.h"
 #include "VisualLogger/VisualLogger.h"
 
 //----------------------------------------------------------------------//
@@ -33,6 +35,7 @@ void UMassTrafficParkedVehicleVisualizationProcessor::ConfigureQueries()
 //----------------------------------------------------------------------//
 UMassTrafficParkedVehicleUpdateCustomVisualizationProcessor::UMassTrafficParkedVehicleUpdateCustomVisualizationProcessor()
 	: EntityQuery(*this)
+	, CulledStaticInstancesEntityQuery(*this)
 {
 	bAutoRegisterWithProcessingPhases = true;
 	ExecutionFlags = (int32)(EProcessorExecutionFlags::Client | EProcessorExecutionFlags::Standalone);
@@ -53,22 +56,44 @@ void UMassTrafficParkedVehicleUpdateCustomVisualizationProcessor::ConfigureQueri
 	EntityQuery.AddRequirement<FMassRepresentationFragment>(EMassFragmentAccess::ReadWrite);
 	EntityQuery.AddRequirement<FMassRepresentationLODFragment>(EMassFragmentAccess::ReadOnly);
 	EntityQuery.AddSharedRequirement<FMassRepresentationSubsystemSharedFragment>(EMassFragmentAccess::ReadWrite);
+	EntityQuery.AddRequirement<FMassTrafficStaticInstancesFragment>(EMassFragmentAccess::ReadWrite);
 
 	EntityQuery.AddChunkRequirement<FMassVisualizationChunkFragment>(EMassFragmentAccess::ReadOnly);
 	EntityQuery.SetChunkFilter(&FMassVisualizationChunkFragment::AreAnyEntitiesVisibleInChunk);
 #if ENABLE_VISUAL_LOG
 	EntityQuery.AddSubsystemRequirement<UMassTrafficSubsystem>(EMassFragmentAccess::ReadOnly);
 #endif // ENABLE_VISUAL_LOG
+
+	CulledStaticInstancesEntityQuery.AddTagRequirement<FMassTrafficParkedVehicleTag>(EMassFragmentPresence::All);
+	CulledStaticInstancesEntityQuery.AddTagRequirement<FMassTrafficHasStaticInstancesTag>(EMassFragmentPresence::All);
+	CulledStaticInstancesEntityQuery.AddTagRequirement<FMassVisibilityCulledByDistanceTag>(EMassFragmentPresence::All);
+	CulledStaticInstancesEntityQuery.AddRequirement<FMassTrafficStaticInstancesFragment>(EMassFragmentAccess::ReadWrite);
+
+	ProcessorRequirements.AddSubsystemRequirement<UMassTrafficSubsystem>(EMassFragmentAccess::ReadWrite);
 }
 
 void UMassTrafficParkedVehicleUpdateCustomVisualizationProcessor::Execute(FMassEntityManager& EntityManager, FMassExecutionContext& Context)
 {
-	// As we are using the same Visualization.StaticMeshDescIndex here as traffic vehicles, we must
-	// add custom float values for parked instances too.
+	// Parked vehicles almost never move, so by default we keep persistent instances for them which only change when
+	// their LOD changes or they're disturbed or removed, rather than resubmitting every parked vehicle's instance to the
+	// Mass ISM batches every frame
+	FMassTrafficStaticInstances& StaticInstances = Context.GetMutableSubsystemChecked<UMassTrafficSubsystem>(EntityManager.GetWorld()).GetMutableParkedVehicleStaticInstances();
+	const bool bUseStaticInstances = GMassTrafficStaticInstances != 0;
+	if (bUseStaticInstances)
+	{
+		StaticInstances.BeginUpdate(*EntityManager.GetWorld());
+	}
+	else if (StaticInstances.Num() > 0)
+	{
+		StaticInstances.Reset();
+	}
+
+	// When batching instances, as we are using the same Visualization.StaticMeshDescIndex here as traffic vehicles, we
+	// must add custom float values for parked instances too.
 	// 
 	// Otherwise the total mesh instance count (e.g: 7 traffic + 3 parked) would be mismatched with the
 	// total custom data count (e.g: 7 traffic + 0 parked)
-	EntityQuery.ForEachEntityChunk(EntityManager, Context, [this](FMassExecutionContext& Context)
+	EntityQuery.ForEachEntityChunk(EntityManager, Context, [&StaticInstances, bUseStaticInstances](FMassExecutionContext& Context)
 		{
 			UMassRepresentationSubsystem* RepresentationSubsystem = Context.GetMutableSharedFragment<FMassRepresentationSubsystemSharedFragment>().RepresentationSubsystem;
 			check(RepresentationSubsystem);
@@ -79,6 +104,8 @@ void UMassTrafficParkedVehicleUpdateCustomVisualizationProcessor::Execute(FMassE
 			TConstArrayView<FMassTrafficRandomFractionFragment> RandomFractionFragments = Context.GetFragmentView<FMassTrafficRandomFractionFragment>();
 			TConstArrayView<FMassRepresentationLODFragment> VisualizationLODFragments = Context.GetFragmentView<FMassRepresentationLODFragment>();
 			TArrayView<FMassRepresentationFragment> VisualizationFragments = Context.GetMutableFragmentView<FMassRepresentationFragment>();
+			TArrayView<FMassTrafficStaticInstancesFragment> StaticInstancesFragments = Context.GetMutableFragmentView<FMassTrafficStaticInstancesFragment>();
+			const bool bHadStaticInstances = Context.DoesArchetypeHaveTag<FMassTrafficHasStaticInstancesTag>();
 			for (int32 Index = 0; Index < NumEntities; Index++)
 			{
 				const FTransformFragment& TransformFragment = TransformList[Index];
@@ -88,14 +115,47 @@ void UMassTrafficParkedVehicleUpdateCustomVisualizationProcessor::Execute(FMassE
 				if (Visualization.CurrentRepresentation == EMassRepresentationType::StaticMeshInstance)
 				{
 					const FMassTrafficPackedVehicleInstanceCustomData PackedCustomData = FMassTrafficVehicleInstanceCustomData::MakeParkedVehicleCustomData(RandomFractionFragment);
-					
-					ISMInfo[Visualization.StaticMeshDescIndex].AddBatchedTransform(GetTypeHash(Context.GetEntity(Index)), TransformFragment.GetTransform(), Visualization.PrevTransform, VisualizationLODFragment.LODSignificance);
-					ISMInfo[Visualization.StaticMeshDescIndex].AddBatchedCustomData(PackedCustomData, VisualizationLODFragment.LODSignificance);
+
+					if (bUseStaticInstances)
+					{
+						StaticInstances.SetInstance(StaticInstancesFragments[Index], /*SubIndex*/0, Visualization.StaticMeshDescIndex, ISMInfo[Visualization.StaticMeshDescIndex].GetDesc(), TransformFragment.GetTransform(), VisualizationLODFragment.LODSignificance, PackedCustomData.PackedParam1);
+						if (!bHadStaticInstances)
+						{
+							Context.Defer().AddTag<FMassTrafficHasStaticInstancesTag>(Context.GetEntity(Index));
+						}
+					}
+					else
+					{
+						ISMInfo[Visualization.StaticMeshDescIndex].AddBatchedTransform(GetTypeHash(Context.GetEntity(Index)), TransformFragment.GetTransform(), Visualization.PrevTransform, VisualizationLODFragment.LODSignificance);
+						ISMInfo[Visualization.StaticMeshDescIndex].AddBatchedCustomData(PackedCustomData, VisualizationLODFragment.LODSignificance);
+					}
+				}
+				else if (bHadStaticInstances)
+				{
+					// No longer instanced, e.g: switched to an actor
+					StaticInstances.RemoveInstances(StaticInstancesFragments[Index]);
+					Context.Defer().RemoveTag<FMassTrafficHasStaticInstancesTag>(Context.GetEntity(Index));
 				}
 				Visualization.PrevTransform = TransformFragment.GetTransform();
 			}
 		});
 
+	if (bUseStaticInstances)
+	{
+		// Remove instances of parked vehicles that were culled by distance, whose chunks we no longer visit above
+		CulledStaticInstancesEntityQuery.ForEachEntityChunk(EntityManager, Context, [&StaticInstances](FMassExecutionContext& Context)
+		{
+			const TArrayView<FMassTrafficStaticInstancesFragment> StaticInstancesFragments = Context.GetMutableFragmentView<FMassTrafficStaticInstancesFragment>();
+			for (int32 Index = 0; Index < Context.GetNumEntities(); ++Index)
+			{
+				StaticInstances.RemoveInstances(StaticInstancesFragments[Index]);
+				Context.Defer().RemoveTag<FMassTrafficHasStaticInstancesTag>(Context.GetEntity(Index));
+			}
+		});
+
+		StaticInstances.EndUpdate();
+	}
+
 #if ENABLE_VISUAL_LOG
 	
 	// Debug draw current visualization
@@ -132,3 +192,52 @@ void UMassTrafficParkedVehicleUpdateCustomVisualizationProcessor::Execute(FMassE
 	
 #endif
 }
+
+//----------------------------------------------------------------------//
+// UMassTrafficStaticInstancesDestructor 
+//----------------------------------------------------------------------//
+UMassTrafficStaticInstancesDestructor::UMassTrafficStaticInstancesDestructor()
+	: ParkedVehicleEntityQuery(*this)
+	, IntersectionEntityQuery(*this)
+{
+	ObservedType = FMassTrafficStaticInstancesFragment::StaticStruct();
+	Operation = EMassObservedOperation::Remove;
+	ExecutionFlags = (int32)(EProcessorExecutionFlags::Client | EProcessorExecutionFlags::Standalone);
+	bRequiresGameThreadExecution = true;
+}
+
+void UMassTrafficStaticInstancesDestructor::ConfigureQueries()
+{
+	ParkedVehicleEntityQuery.AddTagRequirement<FMassTrafficParkedVehicleTag>(EMassFragmentPresence::All);
+	ParkedVehicleEntityQuery.AddTagRequirement<FMassTrafficHasStaticInstancesTag>(EMassFragmentPresence::All);
+	ParkedVehicleEntityQuery.AddRequirement<FMassTrafficStaticInstancesFragment>(EMassFragmentAccess::ReadWrite);
+
+	IntersectionEntityQuery.AddTagRequirement<FMassTrafficIntersectionTag>(EMassFragmentPresence::All);
+	IntersectionEntityQuery.AddTagRequirement<FMassTrafficHasStaticInstancesTag>(EMassFragmentPresence::All);
+	IntersectionEntityQuery.AddRequirement<FMassTrafficStaticInstancesFragment>(EMassFragmentAccess::ReadWrite);
+
+	ProcessorRequirements.AddSubsystemRequirement<UMassTrafficSubsystem>(EMassFragmentAccess::ReadWrite);
+}
+
+void UMassTrafficStaticInstancesDestructor::Execute(FMassEntityManager& EntityManager, FMassExecutionContext& Context)
+{
+	UMassTrafficSubsystem& MassTrafficSubsystem = Context.GetMutableSubsystemChecked<UMassTrafficSubsystem>(EntityManager.GetWorld());
+
+	const auto RemoveInstances = [](FMassTrafficStaticInstances& StaticInstances, FMassExecutionContext& Context)
+	{
+		for (FMassTrafficStaticInstancesFragment& StaticInstancesFragment : Context.GetMutableFragmentView<FMassTrafficStaticInstancesFragment>())
+		{
+			StaticInstances.RemoveInstances(StaticInstancesFragment);
+		}
+	};
+
+	ParkedVehicleEntityQuery.ForEachEntityChunk(EntityManager, Context, [&](FMassExecutionContext& Context)
+	{
+		RemoveInstances(MassTrafficSubsystem.GetMutableParkedVehicleStaticInstances(), Context);
+	});
+
+	IntersectionEntityQuery.ForEachEntityChunk(EntityManager, Context, [&](FMassExecutionContext& Context)
+	{
+		RemoveInstances(MassTrafficSubsystem.GetMutableTrafficLightStaticInstances(), Context);
+	});
+}
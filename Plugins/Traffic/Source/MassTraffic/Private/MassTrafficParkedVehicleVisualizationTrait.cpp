@@ -51,4 +51,5 @@ void UMassTrafficParkedVehicleVisualizationTrait::BuildTemplate(FMassEntityTempl
 	
 	BuildContext.RequireFragment<FMassTrafficRandomFractionFragment>();
 	BuildContext.AddFragment<FMassActorFragment>();
+	BuildContext.AddFragment<FMassTrafficStaticInstancesFragment>();
 }
@@ -3,6 +3,7 @@
 #include "MassTrafficPostPhysicsUpdateTrafficVehiclesProcessor.h"
 #include "MassTrafficLaneChange.h"
 #include "MassTrafficDamage.h"
+#include "MassTrafficInterpolation.h"
 #include "MassTrafficMovement.h"
 #include "MassTrafficVehicleInterface.h"
 
@@ -14,6 +15,45 @@
 #include "MassGameplayExternalTraits.h"
 #include "VisualLogger/VisualLogger.h"
 
+namespace
+{
+
+/**
+ * Finds Location's distance along LaneHandle, searching the lane near PreviousDistanceAlongLane first, and the whole lane
+ * only if the vehicle has deviated from there.
+ */
+bool FindDistanceAlongLane(
+	const UZoneGraphSubsystem& ZoneGraphSubsystem,
+	const UMassTrafficSubsystem& MassTrafficSubsystem,
+	const FZoneGraphLaneHandle LaneHandle,
+	const FVector& Location,
+	const float PreviousDistanceAlongLane,
+	const float SearchDistance,
+	float& OutDistanceAlongLane)
+{
+	float DistanceSq;
+	if (SearchDistance > 0.0f)
+	{
+		const FZoneGraphStorage* ZoneGraphStorage = ZoneGraphSubsystem.GetZoneGraphStorage(LaneHandle.DataHandle);
+		if (ZoneGraphStorage && UE::MassTraffic::FindNearbyDistanceAlongLane(*ZoneGraphStorage, MassTrafficSubsystem.GetLaneSegmentTable(LaneHandle.DataHandle), LaneHandle.Index, Location, PreviousDistanceAlongLane, SearchDistance, OutDistanceAlongLane, DistanceSq))
+		{
+			return true;
+		}
+	}
+
+	const FBox SearchLocationAndExtent = FBox::BuildAABB(Location, FVector(100000.0f));
+	FZoneGraphLaneLocation NearestLaneLocation;
+	if (ZoneGraphSubsystem.FindNearestLocationOnLane(LaneHandle, SearchLocationAndExtent, NearestLaneLocation, DistanceSq))
+	{
+		OutDistanceAlongLane = NearestLaneLocation.DistanceAlongLane;
+		return true;
+	}
+
+	return false;
+}
+
+}
+
 UMassTrafficPostPhysicsUpdateTrafficVehiclesProcessor::UMassTrafficPostPhysicsUpdateTrafficVehiclesProcessor(const FObjectInitializer& ObjectInitializer)
 	: Super(ObjectInitializer)
 	, PIDControlTrafficVehicleQuery(*this)
@@ -52,11 +92,18 @@ void UMassTrafficPostPhysicsUpdateTrafficVehiclesProcessor::ConfigureQueries()
 
 void UMassTrafficPostPhysicsUpdateTrafficVehiclesProcessor::Execute(FMassEntityManager& EntityManager, FMassExecutionContext& Context)
 {
+	// Skip during replay playback and on frames without fixed timestep substeps
+	if (!ShouldSimulateTrafficVehicles())
+	{
+		return;
+	}
+
 	// Advance agents
 	PIDControlTrafficVehicleQuery.ForEachEntityChunk(EntityManager, Context, [&, World = EntityManager.GetWorld()](FMassExecutionContext& Context)
 	{
 		UMassTrafficSubsystem& MassTrafficSubsystem = Context.GetMutableSubsystemChecked<UMassTrafficSubsystem>(World);
 		const UZoneGraphSubsystem& ZoneGraphSubsystem = Context.GetSubsystemChecked<UZoneGraphSubsystem>(World);
+		const float DeltaTime = MassTrafficSubsystem.GetSimulationClock().GetDeltaTime();
 
 		const int32 NumEntities = Context.GetNumEntities();
 		const TConstArrayView<FAgentRadiusFragment> AgentRadiusFragments = Context.GetFragmentView<FAgentRadiusFragment>();
@@ -117,17 +164,18 @@ void UMassTrafficPostPhysicsUpdateTrafficVehiclesProcessor::Execute(FMassEntityM
 				}
 			}
 			
-			// Get new distance along lane after simulation of both ChaosVehiclePhysics and SimpleVehiclePhysics
-			FBox SearchLocationAndExtent = FBox::BuildAABB(TransformFragment.GetTransform().GetLocation(), FVector(100000.0f));
-			FZoneGraphLaneLocation NearestLaneLocation;
-			float DistanceSq;
-			if (ZoneGraphSubsystem.FindNearestLocationOnLane(LaneLocationFragment.LaneHandle, SearchLocationAndExtent, NearestLaneLocation, DistanceSq))
+			// Get new distance along lane after simulation of both ChaosVehiclePhysics and SimpleVehiclePhysics. The
+			// vehicle has usually only moved as far as its speed will have taken it, so search near where it was first 
+			const FVector Location = TransformFragment.GetTransform().GetLocation();
+			const float SearchDistance = GMassTrafficPostPhysicsLaneSearchDistance > 0.0f ? GMassTrafficPostPhysicsLaneSearchDistance + VehicleControlFragment.Speed * DeltaTime : 0.0f;
+			float NewDistanceAlongLane;
+			if (FindDistanceAlongLane(ZoneGraphSubsystem, MassTrafficSubsystem, LaneLocationFragment.LaneHandle, Location, LaneLocationFragment.DistanceAlongLane, SearchDistance, NewDistanceAlongLane))
 			{
 				// Advance distance based noise before updating LaneLocationFragment.DistanceAlongLane
-				VehicleControlFragment.NoiseInput += NearestLaneLocation.DistanceAlongLane - LaneLocationFragment.DistanceAlongLane;
+				VehicleControlFragment.NoiseInput += NewDistanceAlongLane - LaneLocationFragment.DistanceAlongLane;
 				
 				// Update distance along lane after simulation from the previous frame
-				LaneLocationFragment.DistanceAlongLane = NearestLaneLocation.DistanceAlongLane;
+				LaneLocationFragment.DistanceAlongLane = NewDistanceAlongLane;
 			}
 			else
 			{
@@ -160,9 +208,8 @@ void UMassTrafficPostPhysicsUpdateTrafficVehiclesProcessor::Execute(FMassEntityM
 						&LaneChangeFragments[Index],
 						bHasVehicleBecomeStuck_Ignored/*out*/);
 
-					// Re-eval position on next lane
-					ZoneGraphSubsystem.FindNearestLocationOnLane(LaneLocationFragment.LaneHandle, SearchLocationAndExtent, NearestLaneLocation, DistanceSq);
-					LaneLocationFragment.DistanceAlongLane = NearestLaneLocation.DistanceAlongLane;
+					// Re-eval position on next lane, near the overrun distance MoveVehicleToNextLane carried onto it
+					FindDistanceAlongLane(ZoneGraphSubsystem, MassTrafficSubsystem, LaneLocationFragment.LaneHandle, Location, LaneLocationFragment.DistanceAlongLane, SearchDistance, LaneLocationFragment.DistanceAlongLane);
 
 					// Advance distance based noise
 					VehicleControlFragment.NoiseInput += LaneLocationFragment.DistanceAlongLane;
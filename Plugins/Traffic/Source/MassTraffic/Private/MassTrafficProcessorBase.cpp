@@ -1,8 +1,10 @@
 // Copyright Epic Games, Inc. All Rights Reserved.
 
 #include "MassTrafficProcessorBase.h"
+#include "MassTraffic.h"
 
 #include "ZoneGraphSubsystem.h" 
+#include "VisualLogger/VisualLogger.h"
 
 void UMassTrafficProcessorBase::Initialize(UObject& InOwner)
 {
@@ -24,3 +26,39 @@ void UMassTrafficProcessorBase::Initialize(UObject& InOwner)
 		RandomStream.GenerateNewSeed();
 	}
 }
+
+bool UMassTrafficProcessorBase::ShouldSimulateTrafficVehicles() const
+{
+	// Vehicles are driven by UMassTrafficReplayPlaybackProcessor during replay playback
+	if (GMassTrafficReplay == 2 /*playback*/)
+	{
+		return false;
+	}
+
+	const UMassTrafficSubsystem* TrafficSubsystem = UWorld::GetSubsystem<UMassTrafficSubsystem>(GetWorld());
+	return !TrafficSubsystem || !TrafficSubsystem->GetSimulationClock().IsPaused();
+}
+
+bool UMassTrafficProcessorBase::ShouldProcessVehicleBehaviorInParallel() const
+{
+	if (!GMassTrafficParallelVehicleBehavior)
+	{
+		return false;
+	}
+
+#if WITH_MASSTRAFFIC_DEBUG
+	if (GMassTrafficDebugSpeed || GMassTrafficDebugShouldStop || GMassTrafficDebugChooseNextLane || GMassTrafficDebugLaneChanging)
+	{
+		return false;
+	}
+
+#if ENABLE_VISUAL_LOG
+	if (FVisualLogger::IsRecording())
+	{
+		return false;
+	}
+#endif
+#endif // WITH_MASSTRAFFIC_DEBUG
+
+	return true;
+}
@@ -0,0 +1,207 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "MassTrafficReplay.h"
+#include "MassTraffic.h"
+#include "MassTrafficSettings.h"
+
+#include "Algo/BinarySearch.h"
+#include "HAL/FileManager.h"
+#include "Misc/Paths.h"
+
+
+namespace
+{
+	constexpr uint32 ReplayMagic = 0x5052544D; // 'MTRP'
+	constexpr uint32 ReplayVersion = 3;
+}
+
+
+FArchive& operator<<(FArchive& Ar, FMassTrafficReplayVehicleState& State)
+{
+	Ar << State.VehicleId;
+	Ar << State.LaneHandle.DataHandle.Index;
+	Ar << State.LaneHandle.DataHandle.Generation;
+	Ar << State.LaneHandle.Index;
+	Ar << State.DistanceAlongLane;
+	Ar << State.Speed;
+	Ar << State.LateralOffset;
+	Ar << State.Location;
+	Ar << State.Rotation;
+
+	return Ar;
+}
+
+
+int32 FMassTrafficReplayFrame::FindVehicleIndex(const int32 VehicleId) const
+{
+	const int32 VehicleIndex = Algo::LowerBoundBy(Vehicles, VehicleId, &FMassTrafficReplayVehicleState::VehicleId);
+	if (Vehicles.IsValidIndex(VehicleIndex) && Vehicles[VehicleIndex].VehicleId == VehicleId)
+	{
+		return VehicleIndex;
+	}
+
+	return INDEX_NONE;
+}
+
+FArchive& operator<<(FArchive& Ar, FMassTrafficReplayFrame& Frame)
+{
+	Ar << Frame.FrameIndex;
+	Ar << Frame.SimulationTime;
+	Ar << Frame.DeltaTime;
+
+	int32 NumVehicles = Frame.Vehicles.Num();
+	Ar << NumVehicles;
+	if (Ar.IsLoading())
+	{
+		if (NumVehicles < 0)
+		{
+			Ar.SetError();
+			return Ar;
+		}
+		Frame.Vehicles.SetNum(NumVehicles);
+	}
+
+	for (FMassTrafficReplayVehicleState& State : Frame.Vehicles)
+	{
+		Ar << State;
+	}
+
+	return Ar;
+}
+
+
+FMassTrafficReplayWriter::~FMassTrafficReplayWriter()
+{
+	Close();
+}
+
+bool FMassTrafficReplayWriter::Open(const FString& Filename, const int32 RandomSeed)
+{
+	Close();
+
+	Archive.Reset(IFileManager::Get().CreateFileWriter(*Filename));
+	if (!Archive.IsValid())
+	{
+		UE_LOG(LogMassTraffic, Error, TEXT("%s - Couldn't open traffic replay '%s' for writing"), ANSI_TO_TCHAR(__FUNCTION__), *Filename);
+		return false;
+	}
+
+	uint32 Magic = ReplayMagic;
+	uint32 Version = ReplayVersion;
+	int32 Seed = RandomSeed;
+	*Archive << Magic;
+	*Archive << Version;
+	*Archive << Seed;
+
+	UE_LOG(LogMassTraffic, Log, TEXT("Recording traffic replay to '%s'"), *Filename);
+
+	return true;
+}
+
+void FMassTrafficReplayWriter::WriteFrame(FMassTrafficReplayFrame& Frame)
+{
+	if (Archive.IsValid())
+	{
+		*Archive << Frame;
+	}
+}
+
+void FMassTrafficReplayWriter::Close()
+{
+	if (Archive.IsValid())
+	{
+		Archive->Close();
+		Archive.Reset();
+	}
+}
+
+
+bool FMassTrafficReplay::Load(const FString& Filename)
+{
+	Reset();
+
+	TUniquePtr<FArchive> Archive(IFileManager::Get().CreateFileReader(*Filename));
+	if (!Archive.IsValid())
+	{
+		UE_LOG(LogMassTraffic, Error, TEXT("%s - Couldn't open traffic replay '%s' for reading"), ANSI_TO_TCHAR(__FUNCTION__), *Filename);
+		return false;
+	}
+
+	uint32 Magic = 0;
+	uint32 Version = 0;
+	*Archive << Magic;
+	*Archive << Version;
+	*Archive << RandomSeed;
+	if (Magic != ReplayMagic || Version != ReplayVersion)
+	{
+		UE_LOG(LogMassTraffic, Error, TEXT("%s - '%s' isn't a compatible traffic replay"), ANSI_TO_TCHAR(__FUNCTION__), *Filename);
+		return false;
+	}
+
+	// Frames are appended until the recording stops, so read until the end of the file. A truncated trailing frame
+	// (e.g. from a crash mid-write) is discarded.
+	while (!Archive->AtEnd())
+	{
+		FMassTrafficReplayFrame Frame;
+		*Archive << Frame;
+		if (Archive->IsError())
+		{
+			UE_LOG(LogMassTraffic, Warning, TEXT("%s - Discarding truncated frame at the end of traffic replay '%s'"), ANSI_TO_TCHAR(__FUNCTION__), *Filename);
+			break;
+		}
+		Frames.Add(MoveTemp(Frame));
+	}
+
+	UE_LOG(LogMassTraffic, Log, TEXT("Loaded traffic replay '%s' - %d frames, %.2fs, recorded with RandomSeed %d"), *Filename, Frames.Num(), GetDuration(), RandomSeed);
+
+	return true;
+}
+
+void FMassTrafficReplay::Reset()
+{
+	RandomSeed = 0;
+	Frames.Reset();
+}
+
+bool FMassTrafficReplay::FindFramesAtTime(const double SimulationTime, int32& OutFrameIndexA, int32& OutFrameIndexB, float& OutAlpha) const
+{
+	if (Frames.IsEmpty())
+	{
+		return false;
+	}
+
+	// First frame recorded at or after SimulationTime. Playing back at the recorded rate lands exactly on each frame, which
+	// is then used as is rather than blended with the one before.
+	const int32 FrameIndexB = Algo::LowerBoundBy(Frames, SimulationTime, &FMassTrafficReplayFrame::SimulationTime);
+	if (FrameIndexB == 0 || FrameIndexB >= Frames.Num() || Frames[FrameIndexB].SimulationTime == SimulationTime)
+	{
+		OutFrameIndexA = OutFrameIndexB = FMath::Clamp(FrameIndexB, 0, Frames.Num() - 1);
+		OutAlpha = 0.0f;
+		return true;
+	}
+
+	OutFrameIndexA = FrameIndexB - 1;
+	OutFrameIndexB = FrameIndexB;
+
+	const double FrameTimeA = Frames[OutFrameIndexA].SimulationTime;
+	const double FrameTimeB = Frames[OutFrameIndexB].SimulationTime;
+	OutAlpha = FrameTimeB > FrameTimeA ? static_cast<float>(FMath::Clamp((SimulationTime - FrameTimeA) / (FrameTimeB - FrameTimeA), 0.0, 1.0)) : 0.0f;
+
+	return true;
+}
+
+
+namespace UE::MassTraffic
+{
+
+FString GetReplayFilename(const UMassTrafficSettings& MassTrafficSettings)
+{
+	if (FPaths::IsRelative(MassTrafficSettings.ReplayFilename))
+	{
+		return FPaths::Combine(FPaths::ProjectSavedDir(), MassTrafficSettings.ReplayFilename);
+	}
+
+	return MassTrafficSettings.ReplayFilename;
+}
+
+}
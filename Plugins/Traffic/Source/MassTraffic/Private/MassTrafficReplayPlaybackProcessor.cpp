@@ -0,0 +1,167 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "MassTrafficReplayPlaybackProcessor.h"
+#include "MassTraffic.h"
+#include "MassTrafficFragments.h"
+#include "MassTrafficInterpolationProcessor.h"
+#include "MassTrafficMovement.h"
+
+#include "MassCommonFragments.h"
+#include "MassExecutionContext.h"
+#include "MassZoneGraphNavigationFragments.h"
+
+
+UMassTrafficReplayPlaybackProcessor::UMassTrafficReplayPlaybackProcessor()
+	: EntityQuery(*this)
+	, LaneVehiclesQuery(*this)
+{
+	bAutoRegisterWithProcessingPhases = true;
+	bRequiresGameThreadExecution = true; // due to file IO
+	ExecutionOrder.ExecuteInGroup = UE::MassTraffic::ProcessorGroupNames::VehicleBehavior;
+	ExecutionOrder.ExecuteAfter.Add(UMassTrafficInterpolationProcessor::StaticClass()->GetFName());
+}
+
+void UMassTrafficReplayPlaybackProcessor::ConfigureQueries()
+{
+	EntityQuery.AddTagRequirement<FMassTrafficVehicleTag>(EMassFragmentPresence::All);
+	EntityQuery.AddRequirement<FMassTrafficVehicleIdFragment>(EMassFragmentAccess::ReadOnly);
+	EntityQuery.AddRequirement<FMassZoneGraphLaneLocationFragment>(EMassFragmentAccess::ReadWrite);
+	EntityQuery.AddRequirement<FMassTrafficVehicleControlFragment>(EMassFragmentAccess::ReadWrite);
+	EntityQuery.AddRequirement<FMassTrafficLaneOffsetFragment>(EMassFragmentAccess::ReadWrite);
+	EntityQuery.AddRequirement<FTransformFragment>(EMassFragmentAccess::ReadWrite);
+
+	// Same vehicles UMassTrafficFindNextVehicleProcessor links up when they're spawned
+	LaneVehiclesQuery.AddRequirement<FMassZoneGraphLaneLocationFragment>(EMassFragmentAccess::ReadOnly);
+	LaneVehiclesQuery.AddRequirement<FAgentRadiusFragment>(EMassFragmentAccess::ReadOnly);
+	LaneVehiclesQuery.AddRequirement<FMassTrafficNextVehicleFragment>(EMassFragmentAccess::ReadWrite);
+	LaneVehiclesQuery.AddTagRequirement<FMassTrafficFarFieldVehicleTag>(EMassFragmentPresence::None);
+
+	ProcessorRequirements.AddSubsystemRequirement<UMassTrafficSubsystem>(EMassFragmentAccess::ReadWrite);
+}
+
+void UMassTrafficReplayPlaybackProcessor::Execute(FMassEntityManager& EntityManager, FMassExecutionContext& Context)
+{
+	// Stopped playing back?
+	if (GMassTrafficReplay != 2 /*playback*/)
+	{
+		if (bLoaded)
+		{
+			Replay.Reset();
+			bLoaded = false;
+		}
+		return;
+	}
+
+	UMassTrafficSubsystem& MassTrafficSubsystem = Context.GetMutableSubsystemChecked<UMassTrafficSubsystem>(EntityManager.GetWorld());
+
+	// Frames without any fixed timestep substeps weren't recorded
+	const FMassTrafficSimulationClock& SimulationClock = MassTrafficSubsystem.GetSimulationClock();
+	if (SimulationClock.IsPaused())
+	{
+		return;
+	}
+
+	// Start playback
+	bool bRebuildLaneVehicles = false;
+	if (!bLoaded)
+	{
+		// Only try loading once per playback, an empty replay simply leaves vehicles where they are
+		bLoaded = true;
+		bRebuildLaneVehicles = true;
+
+		// Count playback time from the same point in the frame as recording did, so frames are played back at the
+		// exact times they were recorded at. (See UMassTrafficReplayRecorderProcessor.)
+		PlaybackStartTime = SimulationClock.SimulationTime - SimulationClock.GetDeltaTime();
+		if (Replay.Load(UE::MassTraffic::GetReplayFilename(*MassTrafficSettings)) && Replay.RandomSeed != MassTrafficSettings->RandomSeed)
+		{
+			UE_LOG(LogMassTraffic, Warning, TEXT("Traffic replay was recorded with RandomSeed %d but the current RandomSeed is %d. Vehicles may not match up."), Replay.RandomSeed, MassTrafficSettings->RandomSeed);
+		}
+	}
+
+	PlaybackTime = FMath::Min((SimulationClock.SimulationTime - PlaybackStartTime) * MassTrafficSettings->ReplayPlaybackRate, Replay.GetDuration());
+
+	int32 FrameIndexA = INDEX_NONE;
+	int32 FrameIndexB = INDEX_NONE;
+	float Alpha = 0.0f;
+	if (!Replay.FindFramesAtTime(PlaybackTime, FrameIndexA, FrameIndexB, Alpha))
+	{
+		return;
+	}
+
+	TRACE_CPUPROFILER_EVENT_SCOPE(TEXT("MassTrafficReplayPlayback"))
+
+	const FMassTrafficReplayFrame& FrameA = Replay.Frames[FrameIndexA];
+	const FMassTrafficReplayFrame& FrameB = Replay.Frames[FrameIndexB];
+
+	EntityQuery.ForEachEntityChunk(EntityManager, Context, [&](FMassExecutionContext& QueryContext)
+	{
+		const int32 NumEntities = QueryContext.GetNumEntities();
+		const TConstArrayView<FMassTrafficVehicleIdFragment> VehicleIdFragments = QueryContext.GetFragmentView<FMassTrafficVehicleIdFragment>();
+		const TArrayView<FMassZoneGraphLaneLocationFragment> LaneLocationFragments = QueryContext.GetMutableFragmentView<FMassZoneGraphLaneLocationFragment>();
+		const TArrayView<FMassTrafficVehicleControlFragment> VehicleControlFragments = QueryContext.GetMutableFragmentView<FMassTrafficVehicleControlFragment>();
+		const TArrayView<FMassTrafficLaneOffsetFragment> LaneOffsetFragments = QueryContext.GetMutableFragmentView<FMassTrafficLaneOffsetFragment>();
+		const TArrayView<FTransformFragment> TransformFragments = QueryContext.GetMutableFragmentView<FTransformFragment>();
+
+		for (int32 Index = 0; Index < NumEntities; ++Index)
+		{
+			const int32 VehicleId = VehicleIdFragments[Index].VehicleId;
+
+			// Vehicles not in the replay are left untouched
+			const int32 VehicleIndexA = FrameA.FindVehicleIndex(VehicleId);
+			const int32 VehicleIndexB = FrameB.FindVehicleIndex(VehicleId);
+			if (VehicleIndexA == INDEX_NONE && VehicleIndexB == INDEX_NONE)
+			{
+				continue;
+			}
+
+			// Sample the nearest recorded state, then interpolate between the two frames. On a recorded frame, Alpha is 0
+			// and the recorded state is used as is.
+			const FMassTrafficReplayVehicleState& StateA = FrameA.Vehicles[VehicleIndexA != INDEX_NONE ? VehicleIndexA : VehicleIndexB];
+			const FMassTrafficReplayVehicleState& StateB = FrameB.Vehicles[VehicleIndexB != INDEX_NONE ? VehicleIndexB : VehicleIndexA];
+			FMassTrafficReplayVehicleState State = Alpha < 0.5f ? StateA : StateB;
+			if (Alpha > 0.0f)
+			{
+				// Continuous lane values only if the vehicle stayed on the same lane between the two frames
+				if (StateA.LaneHandle == StateB.LaneHandle)
+				{
+					State.DistanceAlongLane = FMath::Lerp(StateA.DistanceAlongLane, StateB.DistanceAlongLane, Alpha);
+					State.Speed = FMath::Lerp(StateA.Speed, StateB.Speed, Alpha);
+					State.LateralOffset = FMath::Lerp(StateA.LateralOffset, StateB.LateralOffset, Alpha);
+				}
+				State.Location = FMath::Lerp(StateA.Location, StateB.Location, static_cast<double>(Alpha));
+				State.Rotation = FQuat::Slerp(StateA.Rotation, StateB.Rotation, Alpha);
+			}
+
+			FTransform& Transform = TransformFragments[Index].GetMutableTransform();
+			Transform.SetLocation(State.Location);
+			Transform.SetRotation(State.Rotation);
+
+			const FZoneGraphTrafficLaneData* TrafficLaneData = MassTrafficSubsystem.GetTrafficLaneData(State.LaneHandle);
+			if (!TrafficLaneData)
+			{
+				continue;
+			}
+
+			FMassZoneGraphLaneLocationFragment& LaneLocationFragment = LaneLocationFragments[Index];
+			bRebuildLaneVehicles |= LaneLocationFragment.LaneHandle != State.LaneHandle;
+			LaneLocationFragment.LaneHandle = State.LaneHandle;
+			LaneLocationFragment.DistanceAlongLane = State.DistanceAlongLane;
+			LaneLocationFragment.LaneLength = TrafficLaneData->Length;
+			VehicleControlFragments[Index].Speed = State.Speed;
+			LaneOffsetFragments[Index].LateralOffset = State.LateralOffset;
+		}
+	});
+
+	// Lane vehicles are only maintained by the simulation as vehicles move from lane to lane, so have to be rebuilt when
+	// a replayed vehicle does
+	if (bRebuildLaneVehicles)
+	{
+		LaneVehicles.Reset();
+		LaneVehiclesQuery.ForEachEntityChunk(EntityManager, Context, [this](const FMassExecutionContext& QueryContext)
+		{
+			LaneVehicles.Append(QueryContext.GetEntities().GetData(), QueryContext.GetNumEntities());
+		});
+
+		UE::MassTraffic::RebuildLaneVehicles(EntityManager, MassTrafficSubsystem, LaneVehicles);
+	}
+}
@@ -0,0 +1,118 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "MassTrafficReplayRecorderProcessor.h"
+#include "MassTraffic.h"
+#include "MassTrafficFragments.h"
+
+#include "MassCommonFragments.h"
+#include "MassExecutionContext.h"
+#include "MassZoneGraphNavigationFragments.h"
+
+
+UMassTrafficReplayRecorderProcessor::UMassTrafficReplayRecorderProcessor()
+	: EntityQuery(*this)
+{
+	// Record the final state of each frame, after physics
+	ProcessingPhase = EMassProcessingPhase::FrameEnd;
+	bAutoRegisterWithProcessingPhases = true;
+	bRequiresGameThreadExecution = true; // due to file IO
+}
+
+void UMassTrafficReplayRecorderProcessor::BeginDestroy()
+{
+	Writer.Close();
+
+	Super::BeginDestroy();
+}
+
+void UMassTrafficReplayRecorderProcessor::ConfigureQueries()
+{
+	EntityQuery.AddTagRequirement<FMassTrafficVehicleTag>(EMassFragmentPresence::All);
+	EntityQuery.AddRequirement<FMassTrafficVehicleIdFragment>(EMassFragmentAccess::ReadOnly);
+	EntityQuery.AddRequirement<FMassZoneGraphLaneLocationFragment>(EMassFragmentAccess::ReadOnly);
+	EntityQuery.AddRequirement<FMassTrafficVehicleControlFragment>(EMassFragmentAccess::ReadOnly);
+	EntityQuery.AddRequirement<FMassTrafficLaneOffsetFragment>(EMassFragmentAccess::ReadOnly);
+	EntityQuery.AddRequirement<FTransformFragment>(EMassFragmentAccess::ReadOnly);
+}
+
+void UMassTrafficReplayRecorderProcessor::Execute(FMassEntityManager& EntityManager, FMassExecutionContext& Context)
+{
+	// Stopped recording?
+	if (GMassTrafficReplay != 1 /*record*/)
+	{
+		if (Writer.IsOpen())
+		{
+			UE_LOG(LogMassTraffic, Log, TEXT("Stopped recording traffic replay after %d frames"), Frame.FrameIndex + 1);
+			Writer.Close();
+		}
+		bOpenFailed = false;
+		return;
+	}
+
+	const UMassTrafficSubsystem* MassTrafficSubsystem = UWorld::GetSubsystem<UMassTrafficSubsystem>(EntityManager.GetWorld());
+	if (!MassTrafficSubsystem)
+	{
+		return;
+	}
+
+	// Nothing moved on frames without any fixed timestep substeps
+	const FMassTrafficSimulationClock& SimulationClock = MassTrafficSubsystem->GetSimulationClock();
+	if (SimulationClock.IsPaused())
+	{
+		return;
+	}
+
+	// Start recording
+	if (!Writer.IsOpen())
+	{
+		// Don't retry every frame if the file couldn't be opened
+		if (bOpenFailed || !Writer.Open(UE::MassTraffic::GetReplayFilename(*MassTrafficSettings), MassTrafficSettings->RandomSeed))
+		{
+			bOpenFailed = true;
+			return;
+		}
+
+		Frame.FrameIndex = INDEX_NONE;
+		RecordingStartTime = SimulationClock.SimulationTime - SimulationClock.GetDeltaTime();
+	}
+
+	TRACE_CPUPROFILER_EVENT_SCOPE(TEXT("MassTrafficReplayRecord"))
+
+	Frame.FrameIndex++;
+	Frame.DeltaTime = SimulationClock.GetDeltaTime();
+	Frame.SimulationTime = SimulationClock.SimulationTime - RecordingStartTime;
+	Frame.Vehicles.Reset();
+
+	EntityQuery.ForEachEntityChunk(EntityManager, Context, [&](FMassExecutionContext& QueryContext)
+	{
+		const int32 NumEntities = QueryContext.GetNumEntities();
+		const TConstArrayView<FMassTrafficVehicleIdFragment> VehicleIdFragments = QueryContext.GetFragmentView<FMassTrafficVehicleIdFragment>();
+		const TConstArrayView<FMassZoneGraphLaneLocationFragment> LaneLocationFragments = QueryContext.GetFragmentView<FMassZoneGraphLaneLocationFragment>();
+		const TConstArrayView<FMassTrafficVehicleControlFragment> VehicleControlFragments = QueryContext.GetFragmentView<FMassTrafficVehicleControlFragment>();
+		const TConstArrayView<FMassTrafficLaneOffsetFragment> LaneOffsetFragments = QueryContext.GetFragmentView<FMassTrafficLaneOffsetFragment>();
+		const TConstArrayView<FTransformFragment> TransformFragments = QueryContext.GetFragmentView<FTransformFragment>();
+
+		for (int32 Index = 0; Index < NumEntities; ++Index)
+		{
+			const FMassZoneGraphLaneLocationFragment& LaneLocationFragment = LaneLocationFragments[Index];
+			const FTransform& Transform = TransformFragments[Index].GetTransform();
+
+			FMassTrafficReplayVehicleState& State = Frame.Vehicles.AddDefaulted_GetRef();
+			State.VehicleId = VehicleIdFragments[Index].VehicleId;
+			State.LaneHandle = LaneLocationFragment.LaneHandle;
+			State.DistanceAlongLane = LaneLocationFragment.DistanceAlongLane;
+			State.Speed = VehicleControlFragments[Index].Speed;
+			State.LateralOffset = LaneOffsetFragments[Index].LateralOffset;
+			State.Location = Transform.GetLocation();
+			State.Rotation = Transform.GetRotation();
+		}
+	});
+
+	// Sort by vehicle ID so frames are independent of archetype / chunk layout and can be binary searched on playback
+	Frame.Vehicles.Sort([](const FMassTrafficReplayVehicleState& A, const FMassTrafficReplayVehicleState& B)
+	{
+		return A.VehicleId < B.VehicleId;
+	});
+
+	Writer.WriteFrame(Frame);
+}
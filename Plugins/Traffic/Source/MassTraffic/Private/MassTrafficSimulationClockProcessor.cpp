@@ -0,0 +1,60 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "MassTrafficSimulationClockProcessor.h"
+#include "MassTrafficFindNextVehicleProcessor.h"
+#include "MassTrafficFragments.h"
+
+#include "MassCommonFragments.h"
+#include "MassExecutionContext.h"
+
+
+UMassTrafficSimulationClockProcessor::UMassTrafficSimulationClockProcessor()
+	: EntityQuery(*this)
+{
+	bAutoRegisterWithProcessingPhases = true;
+	ExecutionFlags = static_cast<int32>(EProcessorExecutionFlags::All);
+	ExecutionOrder.ExecuteInGroup = UE::MassTraffic::ProcessorGroupNames::FrameStart;
+	ExecutionOrder.ExecuteBefore.Add(UMassTrafficRefreshLaneVehiclesProcessor::StaticClass()->GetFName());
+}
+
+void UMassTrafficSimulationClockProcessor::ConfigureQueries()
+{
+	EntityQuery.AddTagRequirement<FMassTrafficVehicleTag>(EMassFragmentPresence::Any);
+	EntityQuery.AddTagRequirement<FMassTrafficVehicleTrailerTag>(EMassFragmentPresence::Any);
+	EntityQuery.AddRequirement<FTransformFragment>(EMassFragmentAccess::ReadOnly);
+	EntityQuery.AddRequirement<FMassTrafficPreviousTransformFragment>(EMassFragmentAccess::ReadWrite);
+
+	ProcessorRequirements.AddSubsystemRequirement<UMassTrafficSubsystem>(EMassFragmentAccess::ReadWrite);
+}
+
+void UMassTrafficSimulationClockProcessor::Execute(FMassEntityManager& EntityManager, FMassExecutionContext& Context)
+{
+	UMassTrafficSubsystem& MassTrafficSubsystem = Context.GetMutableSubsystemChecked<UMassTrafficSubsystem>(EntityManager.GetWorld());
+	FMassTrafficSimulationClock& SimulationClock = MassTrafficSubsystem.GetMutableSimulationClock();
+
+	if (!MassTrafficSettings->bFixedTimestep)
+	{
+		SimulationClock.AdvanceVariable(Context.GetDeltaTimeSeconds());
+		return;
+	}
+
+	SimulationClock.Advance(Context.GetDeltaTimeSeconds(), 1.0f / MassTrafficSettings->FixedTimestepRate, MassTrafficSettings->MaxFixedTimestepSubsteps);
+
+	// Capture the transforms we'll interpolate away from, before this frame's substeps move vehicles
+	if (SimulationClock.NumSubsteps > 0)
+	{
+		const int64 Step = SimulationClock.GetInterpolationStartStep();
+		EntityQuery.ForEachEntityChunk(EntityManager, Context, [Step](FMassExecutionContext& QueryContext)
+		{
+			const TConstArrayView<FTransformFragment> TransformFragments = QueryContext.GetFragmentView<FTransformFragment>();
+			const TArrayView<FMassTrafficPreviousTransformFragment> PreviousTransformFragments = QueryContext.GetMutableFragmentView<FMassTrafficPreviousTransformFragment>();
+
+			const int32 NumEntities = QueryContext.GetNumEntities();
+			for (int32 Index = 0; Index < NumEntities; ++Index)
+			{
+				PreviousTransformFragments[Index].Transform = TransformFragments[Index].GetTransform();
+				PreviousTransformFragments[Index].Step = Step;
+			}
+		});
+	}
+}
@@ -0,0 +1,171 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "MassTrafficSpawnPointCache.h"
+#include "MassTraffic.h"
+
+#include "HAL/FileManager.h"
+#include "Misc/Paths.h"
+#include "ZoneGraphTypes.h"
+
+
+namespace
+{
+	constexpr uint32 SpawnPointCacheMagic = 0x50534D54; // 'TMSP'
+	constexpr uint32 SpawnPointCacheVersion = 1;
+
+	template<typename ElementType>
+	uint32 MemCrc32(const TArray<ElementType>& Array, const uint32 Crc)
+	{
+		return FCrc::MemCrc32(Array.GetData(), Array.Num() * Array.GetTypeSize(), Crc);
+	}
+}
+
+
+namespace UE::MassTraffic
+{
+
+uint32 GetZoneGraphStorageHash(const FZoneGraphStorage& ZoneGraphStorage)
+{
+	uint32 Hash = GetTypeHash(ZoneGraphStorage.Lanes.Num());
+	for (const FZoneLaneData& Lane : ZoneGraphStorage.Lanes)
+	{
+		Hash = HashCombine(Hash, GetTypeHash(Lane.Width));
+		Hash = HashCombine(Hash, GetTypeHash(Lane.Tags.GetValue()));
+		Hash = HashCombine(Hash, GetTypeHash(Lane.PointsBegin));
+		Hash = HashCombine(Hash, GetTypeHash(Lane.PointsEnd));
+		Hash = HashCombine(Hash, GetTypeHash(Lane.LinksBegin));
+		Hash = HashCombine(Hash, GetTypeHash(Lane.LinksEnd));
+	}
+
+	for (const FZoneLaneLinkData& LaneLink : ZoneGraphStorage.LaneLinks)
+	{
+		Hash = HashCombine(Hash, GetTypeHash(LaneLink.DestLaneIndex));
+		Hash = HashCombine(Hash, GetTypeHash(static_cast<uint8>(LaneLink.Type)));
+		Hash = HashCombine(Hash, GetTypeHash(LaneLink.Flags));
+	}
+
+	// Lane geometry is plain data, so hash it in bulk
+	Hash = MemCrc32(ZoneGraphStorage.LanePoints, Hash);
+	Hash = MemCrc32(ZoneGraphStorage.LaneUpVectors, Hash);
+	Hash = MemCrc32(ZoneGraphStorage.LaneTangentVectors, Hash);
+	Hash = MemCrc32(ZoneGraphStorage.LanePointProgressions, Hash);
+
+	return Hash;
+}
+
+uint32 GetZoneGraphTagFilterHash(const FZoneGraphTagFilter& TagFilter)
+{
+	uint32 Hash = GetTypeHash(TagFilter.AnyTags.GetValue());
+	Hash = HashCombine(Hash, GetTypeHash(TagFilter.AllTags.GetValue()));
+	Hash = HashCombine(Hash, GetTypeHash(TagFilter.NotTags.GetValue()));
+	return Hash;
+}
+
+FString GetSpawnPointCacheFilename(const TCHAR* CacheName, const uint32 CacheKey)
+{
+	return FPaths::Combine(FPaths::ProjectSavedDir(), TEXT("MassTraffic"), TEXT("SpawnPointCache"), FString::Printf(TEXT("%s_%08X.bin"), CacheName, CacheKey));
+}
+
+bool LoadSpawnPointCache(const FString& Filename, const uint32 CacheKey, const FZoneGraphStorage& ZoneGraphStorage, TArray<TArray<FZoneGraphLaneLocation>>& OutSpawnPointsPerSpacing)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(TEXT("LoadSpawnPointCache"))
+
+	TUniquePtr<FArchive> Archive(IFileManager::Get().CreateFileReader(*Filename, FILEREAD_Silent));
+	if (!Archive.IsValid())
+	{
+		return false;
+	}
+
+	uint32 Magic = 0;
+	uint32 Version = 0;
+	uint32 Key = 0;
+	int32 NumSpacings = 0;
+	*Archive << Magic;
+	*Archive << Version;
+	*Archive << Key;
+	*Archive << NumSpacings;
+	if (Archive->IsError() || Magic != SpawnPointCacheMagic || Version != SpawnPointCacheVersion || Key != CacheKey || NumSpacings < 0)
+	{
+		UE_LOG(LogMassTraffic, Warning, TEXT("%s - Ignoring out of date spawn point cache '%s'"), ANSI_TO_TCHAR(__FUNCTION__), *Filename);
+		return false;
+	}
+
+	TArray<TArray<FZoneGraphLaneLocation>> SpawnPointsPerSpacing;
+	SpawnPointsPerSpacing.SetNum(NumSpacings);
+	for (TArray<FZoneGraphLaneLocation>& SpawnPoints : SpawnPointsPerSpacing)
+	{
+		int32 NumSpawnPoints = 0;
+		*Archive << NumSpawnPoints;
+		if (Archive->IsError() || NumSpawnPoints < 0)
+		{
+			return false;
+		}
+
+		SpawnPoints.SetNum(NumSpawnPoints);
+		for (FZoneGraphLaneLocation& SpawnPoint : SpawnPoints)
+		{
+			int32 LaneIndex = INDEX_NONE;
+			*Archive << LaneIndex;
+			*Archive << SpawnPoint.Position;
+			*Archive << SpawnPoint.Direction;
+			*Archive << SpawnPoint.Tangent;
+			*Archive << SpawnPoint.Up;
+			*Archive << SpawnPoint.LaneSegment;
+			*Archive << SpawnPoint.DistanceAlongLane;
+
+			if (Archive->IsError() || !ZoneGraphStorage.Lanes.IsValidIndex(LaneIndex))
+			{
+				UE_LOG(LogMassTraffic, Warning, TEXT("%s - Ignoring corrupt spawn point cache '%s'"), ANSI_TO_TCHAR(__FUNCTION__), *Filename);
+				return false;
+			}
+			SpawnPoint.LaneHandle = FZoneGraphLaneHandle(LaneIndex, ZoneGraphStorage.DataHandle);
+		}
+	}
+
+	OutSpawnPointsPerSpacing = MoveTemp(SpawnPointsPerSpacing);
+
+	return true;
+}
+
+bool SaveSpawnPointCache(const FString& Filename, const uint32 CacheKey, const TArray<TArray<FZoneGraphLaneLocation>>& SpawnPointsPerSpacing)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(TEXT("SaveSpawnPointCache"))
+
+	TUniquePtr<FArchive> Archive(IFileManager::Get().CreateFileWriter(*Filename));
+	if (!Archive.IsValid())
+	{
+		UE_LOG(LogMassTraffic, Warning, TEXT("%s - Couldn't open spawn point cache '%s' for writing"), ANSI_TO_TCHAR(__FUNCTION__), *Filename);
+		return false;
+	}
+
+	uint32 Magic = SpawnPointCacheMagic;
+	uint32 Version = SpawnPointCacheVersion;
+	uint32 Key = CacheKey;
+	int32 NumSpacings = SpawnPointsPerSpacing.Num();
+	*Archive << Magic;
+	*Archive << Version;
+	*Archive << Key;
+	*Archive << NumSpacings;
+
+	for (const TArray<FZoneGraphLaneLocation>& SpawnPoints : SpawnPointsPerSpacing)
+	{
+		int32 NumSpawnPoints = SpawnPoints.Num();
+		*Archive << NumSpawnPoints;
+
+		for (FZoneGraphLaneLocation SpawnPoint : SpawnPoints)
+		{
+			int32 LaneIndex = SpawnPoint.LaneHandle.Index;
+			*Archive << LaneIndex;
+			*Archive << SpawnPoint.Position;
+			*Archive << SpawnPoint.Direction;
+			*Archive << SpawnPoint.Tangent;
+			*Archive << SpawnPoint.Up;
+			*Archive << SpawnPoint.LaneSegment;
+			*Archive << SpawnPoint.DistanceAlongLane;
+		}
+	}
+
+	return Archive->Close();
+}
+
+}
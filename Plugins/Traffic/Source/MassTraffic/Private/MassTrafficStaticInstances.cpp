@@ -0,0 +1,612 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "MassTrafficStaticInstances.h"
+#include "MassTraffic.h"
+#include "MassTrafficFragments.h"
+
+#include "MassRepresentationTypes.h"
+#include "Algo/Compare.h"
+#include "Components/InstancedStaticMeshComponent.h"
+#include "Engine/CollisionProfile.h"
+#include "Engine/World.h"
+#include "GameFramework/Actor.h"
+
+
+DECLARE_CYCLE_STAT(TEXT("Update Static Instances Render State"), STAT_Traffic_UpdateStaticInstancesRenderState, STATGROUP_Traffic);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Static Instances Added"), STAT_Traffic_StaticInstancesAdded, STATGROUP_Traffic);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Static Instances Updated"), STAT_Traffic_StaticInstancesUpdated, STATGROUP_Traffic);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Static Instances Removed"), STAT_Traffic_StaticInstancesRemoved, STATGROUP_Traffic);
+DECLARE_CYCLE_STAT(TEXT("Update Moving Instances Render State"), STAT_Traffic_UpdateMovingInstancesRenderState, STATGROUP_Traffic);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Moving Instance Components Updated"), STAT_Traffic_MovingInstanceComponentsUpdated, STATGROUP_Traffic);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Moving Instance Components Unchanged"), STAT_Traffic_MovingInstanceComponentsUnchanged, STATGROUP_Traffic);
+
+
+namespace
+{
+	FIntPoint GetInstanceCell(const FVector& Location, const float CellSize)
+	{
+		if (CellSize <= 0.0f)
+		{
+			return FIntPoint::ZeroValue;
+		}
+
+		return FIntPoint(FMath::FloorToInt32(Location.X / CellSize), FMath::FloorToInt32(Location.Y / CellSize));
+	}
+
+	/** Spawns a transient actor to own all of an instances' ISM components, if OwnerActor isn't already one. */
+	AActor& FindOrSpawnOwnerActor(TWeakObjectPtr<AActor>& OwnerActor, UWorld* World, const TCHAR* Label)
+	{
+		if (AActor* Actor = OwnerActor.Get())
+		{
+			return *Actor;
+		}
+
+		check(World);
+
+		FActorSpawnParameters SpawnParameters;
+		SpawnParameters.ObjectFlags = RF_Transient;
+		SpawnParameters.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+		AActor* Actor = World->SpawnActor<AActor>(SpawnParameters);
+		check(Actor);
+#if WITH_EDITOR
+		Actor->SetActorLabel(Label);
+#endif
+
+		USceneComponent* RootComponent = NewObject<USceneComponent>(Actor);
+		Actor->SetRootComponent(RootComponent);
+		RootComponent->RegisterComponent();
+
+		OwnerActor = Actor;
+		return *Actor;
+	}
+
+	/** Creates an ISM component for MeshDesc's instances, configured like the Mass representation subsystem would. */
+	UInstancedStaticMeshComponent* CreateMeshComponent(AActor& Actor, const FStaticMeshInstanceVisualizationMeshDesc& MeshDesc, const int32 NumCustomDataFloats)
+	{
+		UInstancedStaticMeshComponent* ISMComponent = NewObject<UInstancedStaticMeshComponent>(&Actor);
+		ISMComponent->SetStaticMesh(MeshDesc.Mesh);
+		for (int32 ElementIndex = 0; ElementIndex < MeshDesc.MaterialOverrides.Num(); ++ElementIndex)
+		{
+			if (UMaterialInterface* MaterialOverride = MeshDesc.MaterialOverrides[ElementIndex])
+			{
+				ISMComponent->SetMaterial(ElementIndex, MaterialOverride);
+			}
+		}
+		ISMComponent->SetCanEverAffectNavigation(false);
+		ISMComponent->SetCollisionProfileName(UCollisionProfile::NoCollision_ProfileName);
+		ISMComponent->SetCastShadow(MeshDesc.bCastShadows);
+		ISMComponent->SetReceivesDecals(false);
+		ISMComponent->SetMobility(MeshDesc.Mobility);
+		ISMComponent->SetNumCustomDataFloats(NumCustomDataFloats);
+
+		ISMComponent->SetupAttachment(Actor.GetRootComponent());
+		ISMComponent->RegisterComponent();
+		Actor.AddInstanceComponent(ISMComponent);
+
+		return ISMComponent;
+	}
+}
+
+
+void FMassTrafficStaticInstances::BeginUpdate(UWorld& InWorld)
+{
+	// Our components went away with their world (or were destroyed from under us), so start over
+	if (World.Get() != &InWorld || ((!MeshComponentsByKey.IsEmpty() || !PooledMeshComponentsByDesc.IsEmpty()) && !OwnerActor.IsValid()))
+	{
+		Reset();
+		World = &InWorld;
+	}
+
+	// Re-bucket everything when the cell size changes
+	if (CellSize != GMassTrafficStaticInstanceCellSize)
+	{
+		Reset();
+		World = &InWorld;
+		CellSize = GMassTrafficStaticInstanceCellSize;
+	}
+}
+
+void FMassTrafficStaticInstances::SetInstance(FMassTrafficStaticInstancesFragment& InstancesFragment, const int32 SubIndex, const int16 StaticMeshDescIndex, const FStaticMeshInstanceVisualizationDesc& StaticMeshDesc, const FTransform& Transform, const float LODSignificance, const float CustomData)
+{
+	ResetStaleHandles(InstancesFragment);
+
+	while (InstancesFragment.InstanceHandles.Num() <= SubIndex)
+	{
+		InstancesFragment.InstanceHandles.Add(INDEX_NONE);
+	}
+
+	// New instance?
+	int32& InstanceHandle = InstancesFragment.InstanceHandles[SubIndex];
+	if (InstanceHandle == INDEX_NONE)
+	{
+		FInstance NewInstance;
+		NewInstance.Transform = Transform;
+		NewInstance.CustomData = CustomData;
+		NewInstance.Cell = GetCell(Transform.GetLocation());
+		InstanceHandle = Instances.Add(MoveTemp(NewInstance));
+	}
+	const int32 Handle = InstanceHandle;
+	FInstance& Instance = Instances[Handle];
+
+	// New instance, or now using a different mesh desc?
+	bool bCustomDataChanged = Instance.CustomData != CustomData;
+	if (Instance.StaticMeshDescIndex != StaticMeshDescIndex)
+	{
+		RemoveMeshInstances(Handle);
+
+		Instance.StaticMeshDescIndex = StaticMeshDescIndex;
+		Instance.MeshInstanceIndices.Init(INDEX_NONE, StaticMeshDesc.Meshes.Num());
+		bCustomDataChanged = false;
+	}
+	Instance.CustomData = CustomData;
+	check(StaticMeshDesc.Meshes.Num() == Instance.MeshInstanceIndices.Num());
+
+	// Only look our mesh components up once something actually changed, which is rarely
+	TArray<FMeshComponent>* MeshComponents = nullptr;
+	for (int32 MeshIndex = 0; MeshIndex < Instance.MeshInstanceIndices.Num(); ++MeshIndex)
+	{
+		const FStaticMeshInstanceVisualizationMeshDesc& MeshDesc = StaticMeshDesc.Meshes[MeshIndex];
+
+		const bool bInLODSignificanceRange = LODSignificance >= MeshDesc.MinLODSignificance && LODSignificance < MeshDesc.MaxLODSignificance;
+		const int32 InstanceIndex = Instance.MeshInstanceIndices[MeshIndex];
+		if (bInLODSignificanceRange == (InstanceIndex != INDEX_NONE) && (InstanceIndex == INDEX_NONE || !bCustomDataChanged))
+		{
+			continue;
+		}
+
+		if (!MeshComponents)
+		{
+			MeshComponents = &FindOrAddMeshComponents({ StaticMeshDescIndex, Instance.Cell }, StaticMeshDesc);
+			check(MeshComponents->Num() == Instance.MeshInstanceIndices.Num());
+		}
+		FMeshComponent& MeshComponent = (*MeshComponents)[MeshIndex];
+
+		if (InstanceIndex == INDEX_NONE)
+		{
+			AddMeshInstance(MeshComponent, Handle);
+		}
+		else if (!bInLODSignificanceRange)
+		{
+			RemoveMeshInstance(MeshComponent, Handle);
+		}
+		else
+		{
+			if (UInstancedStaticMeshComponent* ISMComponent = MeshComponent.ISMComponent.Get())
+			{
+				ISMComponent->SetCustomDataValue(InstanceIndex, /*CustomDataIndex*/0, CustomData, /*bMarkRenderStateDirty*/false);
+				MarkRenderStateDirty(MeshComponent, Instance);
+			}
+
+			INC_DWORD_STAT(STAT_Traffic_StaticInstancesUpdated);
+		}
+	}
+}
+
+void FMassTrafficStaticInstances::RemoveInstances(FMassTrafficStaticInstancesFragment& InstancesFragment)
+{
+	ResetStaleHandles(InstancesFragment);
+
+	for (const int32 InstanceHandle : InstancesFragment.InstanceHandles)
+	{
+		if (InstanceHandle != INDEX_NONE)
+		{
+			RemoveMeshInstances(InstanceHandle);
+			Instances.RemoveAt(InstanceHandle);
+		}
+	}
+	InstancesFragment.InstanceHandles.Reset();
+}
+
+bool FMassTrafficStaticInstances::HasInstances(const FMassTrafficStaticInstancesFragment& InstancesFragment) const
+{
+	return InstancesFragment.ResetCount == ResetCount && InstancesFragment.InstanceHandles.ContainsByPredicate([](const int32 InstanceHandle)
+	{
+		return InstanceHandle != INDEX_NONE;
+	});
+}
+
+void FMassTrafficStaticInstances::EndUpdate()
+{
+	SCOPE_CYCLE_COUNTER(STAT_Traffic_UpdateStaticInstancesRenderState);
+
+	// Only the cells with changed instances have their instance buffers rebuilt
+	for (const FMeshComponentsKey& MeshComponentsKey : DirtyMeshComponentsKeys)
+	{
+		if (ReleaseMeshComponentsIfEmpty(MeshComponentsKey))
+		{
+			continue;
+		}
+
+		// Already updated, if this is a duplicate
+		TArray<FMeshComponent>* MeshComponents = MeshComponentsByKey.Find(MeshComponentsKey);
+		if (!MeshComponents)
+		{
+			continue;
+		}
+
+		for (FMeshComponent& MeshComponent : *MeshComponents)
+		{
+			if (MeshComponent.bRenderStateDirty)
+			{
+				if (UInstancedStaticMeshComponent* ISMComponent = MeshComponent.ISMComponent.Get())
+				{
+					ISMComponent->MarkRenderStateDirty();
+				}
+				MeshComponent.bRenderStateDirty = false;
+			}
+		}
+	}
+	DirtyMeshComponentsKeys.Reset();
+}
+
+bool FMassTrafficStaticInstances::ReleaseMeshComponentsIfEmpty(const FMeshComponentsKey& MeshComponentsKey)
+{
+	TArray<FMeshComponent>* MeshComponents = MeshComponentsByKey.Find(MeshComponentsKey);
+	if (!MeshComponents)
+	{
+		return false;
+	}
+
+	const bool bEmpty = !MeshComponents->ContainsByPredicate([](const FMeshComponent& MeshComponent)
+	{
+		return !MeshComponent.InstanceHandles.IsEmpty();
+	});
+	if (!bEmpty)
+	{
+		return false;
+	}
+
+	// Keep the components around for the next cell that needs them, rather than churning through components as
+	// instances come & go
+	for (FMeshComponent& MeshComponent : *MeshComponents)
+	{
+		if (UInstancedStaticMeshComponent* ISMComponent = MeshComponent.ISMComponent.Get())
+		{
+			ISMComponent->SetVisibility(false);
+		}
+		MeshComponent.bRenderStateDirty = false;
+	}
+	PooledMeshComponentsByDesc.FindOrAdd(MeshComponentsKey.StaticMeshDescIndex).Add(MoveTemp(*MeshComponents));
+	MeshComponentsByKey.Remove(MeshComponentsKey);
+
+	return true;
+}
+
+void FMassTrafficStaticInstances::Reset()
+{
+	if (AActor* Actor = OwnerActor.Get())
+	{
+		Actor->Destroy();
+	}
+	OwnerActor.Reset();
+	World.Reset();
+
+	Instances.Reset();
+	MeshComponentsByKey.Reset();
+	PooledMeshComponentsByDesc.Reset();
+	DirtyMeshComponentsKeys.Reset();
+
+	++ResetCount;
+}
+
+FIntPoint FMassTrafficStaticInstances::GetCell(const FVector& Location) const
+{
+	return GetInstanceCell(Location, CellSize);
+}
+
+void FMassTrafficStaticInstances::ResetStaleHandles(FMassTrafficStaticInstancesFragment& InstancesFragment) const
+{
+	if (InstancesFragment.ResetCount != ResetCount)
+	{
+		InstancesFragment.InstanceHandles.Reset();
+		InstancesFragment.ResetCount = ResetCount;
+	}
+}
+
+TArray<FMassTrafficStaticInstances::FMeshComponent>& FMassTrafficStaticInstances::FindOrAddMeshComponents(const FMeshComponentsKey& MeshComponentsKey, const FStaticMeshInstanceVisualizationDesc& StaticMeshDesc)
+{
+	if (TArray<FMeshComponent>* MeshComponents = MeshComponentsByKey.Find(MeshComponentsKey))
+	{
+		return *MeshComponents;
+	}
+
+	// Reuse the pooled components of a cell that was left empty, if there are any
+	if (TArray<TArray<FMeshComponent>>* PooledMeshComponents = PooledMeshComponentsByDesc.Find(MeshComponentsKey.StaticMeshDescIndex))
+	{
+		if (!PooledMeshComponents->IsEmpty())
+		{
+			TArray<FMeshComponent>& MeshComponents = MeshComponentsByKey.Add(MeshComponentsKey, PooledMeshComponents->Pop(/*bAllowShrinking*/false));
+			for (FMeshComponent& MeshComponent : MeshComponents)
+			{
+				check(MeshComponent.InstanceHandles.IsEmpty());
+				if (UInstancedStaticMeshComponent* ISMComponent = MeshComponent.ISMComponent.Get())
+				{
+					ISMComponent->SetVisibility(true);
+				}
+			}
+			return MeshComponents;
+		}
+	}
+
+	// Create an ISM component per mesh for this cell
+	AActor& Actor = FindOrSpawnOwnerActor(OwnerActor, World.Get(), TEXT("MassTrafficStaticInstances"));
+	TArray<FMeshComponent>& MeshComponents = MeshComponentsByKey.Add(MeshComponentsKey);
+	MeshComponents.SetNum(StaticMeshDesc.Meshes.Num());
+	for (int32 MeshIndex = 0; MeshIndex < StaticMeshDesc.Meshes.Num(); ++MeshIndex)
+	{
+		UInstancedStaticMeshComponent* ISMComponent = CreateMeshComponent(Actor, StaticMeshDesc.Meshes[MeshIndex], /*NumCustomDataFloats*/1);
+
+		// Keep removals O(1) by moving the last instance into the removed one's place, which we then fix up
+		ISMComponent->SetRemoveSwap();
+
+		MeshComponents[MeshIndex].ISMComponent = ISMComponent;
+		MeshComponents[MeshIndex].MeshIndex = MeshIndex;
+	}
+
+	return MeshComponents;
+}
+
+void FMassTrafficStaticInstances::MarkRenderStateDirty(FMeshComponent& MeshComponent, const FInstance& Instance)
+{
+	if (!MeshComponent.bRenderStateDirty)
+	{
+		MeshComponent.bRenderStateDirty = true;
+		DirtyMeshComponentsKeys.Add({ Instance.StaticMeshDescIndex, Instance.Cell });
+	}
+}
+
+void FMassTrafficStaticInstances::AddMeshInstance(FMeshComponent& MeshComponent, const int32 InstanceHandle)
+{
+	FInstance& Instance = Instances[InstanceHandle];
+	check(Instance.MeshInstanceIndices[MeshComponent.MeshIndex] == INDEX_NONE);
+
+	const int32 InstanceIndex = MeshComponent.InstanceHandles.Add(InstanceHandle);
+	Instance.MeshInstanceIndices[MeshComponent.MeshIndex] = InstanceIndex;
+
+	if (UInstancedStaticMeshComponent* ISMComponent = MeshComponent.ISMComponent.Get())
+	{
+		verify(ISMComponent->AddInstance(Instance.Transform, /*bWorldSpace*/true) == InstanceIndex);
+		ISMComponent->SetCustomDataValue(InstanceIndex, /*CustomDataIndex*/0, Instance.CustomData, /*bMarkRenderStateDirty*/false);
+		MarkRenderStateDirty(MeshComponent, Instance);
+	}
+
+	INC_DWORD_STAT(STAT_Traffic_StaticInstancesAdded);
+}
+
+void FMassTrafficStaticInstances::RemoveMeshInstance(FMeshComponent& MeshComponent, const int32 InstanceHandle)
+{
+	FInstance& Instance = Instances[InstanceHandle];
+	const int32 InstanceIndex = Instance.MeshInstanceIndices[MeshComponent.MeshIndex];
+	check(MeshComponent.InstanceHandles.IsValidIndex(InstanceIndex));
+
+	if (UInstancedStaticMeshComponent* ISMComponent = MeshComponent.ISMComponent.Get())
+	{
+		ISMComponent->RemoveInstance(InstanceIndex);
+	}
+
+	// Always track the removal, so emptied components are found in EndUpdate
+	MarkRenderStateDirty(MeshComponent, Instance);
+
+	// Mirror the ISM component's remove swap
+	MeshComponent.InstanceHandles.RemoveAtSwap(InstanceIndex, 1, /*bAllowShrinking*/false);
+	if (MeshComponent.InstanceHandles.IsValidIndex(InstanceIndex))
+	{
+		Instances[MeshComponent.InstanceHandles[InstanceIndex]].MeshInstanceIndices[MeshComponent.MeshIndex] = InstanceIndex;
+	}
+	Instance.MeshInstanceIndices[MeshComponent.MeshIndex] = INDEX_NONE;
+
+	INC_DWORD_STAT(STAT_Traffic_StaticInstancesRemoved);
+}
+
+void FMassTrafficStaticInstances::RemoveMeshInstances(const int32 InstanceHandle)
+{
+	const FInstance& Instance = Instances[InstanceHandle];
+	if (Instance.StaticMeshDescIndex == INDEX_NONE)
+	{
+		return;
+	}
+
+	// The cell's components may have been pooled while this instance was outside all its meshes' LOD significance ranges
+	TArray<FMeshComponent>* MeshComponents = MeshComponentsByKey.Find({ Instance.StaticMeshDescIndex, Instance.Cell });
+	if (!MeshComponents)
+	{
+		check(!Instance.MeshInstanceIndices.ContainsByPredicate([](const int32 InstanceIndex) { return InstanceIndex != INDEX_NONE; }));
+		return;
+	}
+
+	for (int32 MeshIndex = 0; MeshIndex < Instance.MeshInstanceIndices.Num(); ++MeshIndex)
+	{
+		if (Instance.MeshInstanceIndices[MeshIndex] != INDEX_NONE)
+		{
+			RemoveMeshInstance((*MeshComponents)[MeshIndex], InstanceHandle);
+		}
+	}
+}
+
+
+void FMassTrafficMovingInstances::BeginUpdate(UWorld& InWorld)
+{
+	// Our components went away with their world (or were destroyed from under us), so start over
+	if (World.Get() != &InWorld || ((!MeshComponentsByKey.IsEmpty() || !PooledMeshComponentsByDesc.IsEmpty()) && !OwnerActor.IsValid()))
+	{
+		Reset();
+		World = &InWorld;
+	}
+
+	// Re-bucket everything when the cell size changes
+	if (CellSize != GMassTrafficStaticInstanceCellSize)
+	{
+		Reset();
+		World = &InWorld;
+		CellSize = GMassTrafficStaticInstanceCellSize;
+	}
+
+	NumInstances = 0;
+}
+
+void FMassTrafficMovingInstances::AddInstance(const int16 StaticMeshDescIndex, const FStaticMeshInstanceVisualizationDesc& StaticMeshDesc, const FTransform& Transform, const float LODSignificance, TConstArrayView<float> CustomData)
+{
+	TArray<FMeshComponent>& MeshComponents = FindOrAddMeshComponents({ StaticMeshDescIndex, GetCell(Transform.GetLocation()) }, StaticMeshDesc, CustomData.Num());
+	check(MeshComponents.Num() == StaticMeshDesc.Meshes.Num());
+
+	for (int32 MeshIndex = 0; MeshIndex < MeshComponents.Num(); ++MeshIndex)
+	{
+		const FStaticMeshInstanceVisualizationMeshDesc& MeshDesc = StaticMeshDesc.Meshes[MeshIndex];
+		if (LODSignificance >= MeshDesc.MinLODSignificance && LODSignificance < MeshDesc.MaxLODSignificance)
+		{
+			FMeshComponent& MeshComponent = MeshComponents[MeshIndex];
+			MeshComponent.Transforms.Add(Transform);
+			MeshComponent.CustomData.Append(CustomData.GetData(), CustomData.Num());
+		}
+	}
+
+	++NumInstances;
+}
+
+void FMassTrafficMovingInstances::EndUpdate()
+{
+	SCOPE_CYCLE_COUNTER(STAT_Traffic_UpdateMovingInstancesRenderState);
+
+	for (auto It = MeshComponentsByKey.CreateIterator(); It; ++It)
+	{
+		const int16 StaticMeshDescIndex = It.Key().StaticMeshDescIndex;
+		TArray<FMeshComponent>& MeshComponents = It.Value();
+
+		const bool bEmpty = !MeshComponents.ContainsByPredicate([](const FMeshComponent& MeshComponent)
+		{
+			return !MeshComponent.Transforms.IsEmpty();
+		});
+
+		// Keep the components of cells nothing is in anymore around for the next cell that needs them, rather than
+		// churning through components as instances move between cells
+		if (bEmpty)
+		{
+			for (FMeshComponent& MeshComponent : MeshComponents)
+			{
+				if (UInstancedStaticMeshComponent* ISMComponent = MeshComponent.ISMComponent.Get())
+				{
+					ISMComponent->ClearInstances();
+					ISMComponent->SetVisibility(false);
+				}
+				MeshComponent.SubmittedTransforms.Reset();
+				MeshComponent.SubmittedCustomData.Reset();
+			}
+			PooledMeshComponentsByDesc.FindOrAdd(StaticMeshDescIndex).Add(MoveTemp(MeshComponents));
+			It.RemoveCurrent();
+			continue;
+		}
+
+		const int32 NumCustomDataFloats = NumCustomDataFloatsByDesc.FindChecked(StaticMeshDescIndex);
+		for (FMeshComponent& MeshComponent : MeshComponents)
+		{
+			SubmitMeshInstances(MeshComponent, NumCustomDataFloats);
+		}
+	}
+}
+
+void FMassTrafficMovingInstances::Reset()
+{
+	if (AActor* Actor = OwnerActor.Get())
+	{
+		Actor->Destroy();
+	}
+	OwnerActor.Reset();
+	World.Reset();
+
+	MeshComponentsByKey.Reset();
+	PooledMeshComponentsByDesc.Reset();
+	NumCustomDataFloatsByDesc.Reset();
+	NumInstances = 0;
+}
+
+FIntPoint FMassTrafficMovingInstances::GetCell(const FVector& Location) const
+{
+	return GetInstanceCell(Location, CellSize);
+}
+
+TArray<FMassTrafficMovingInstances::FMeshComponent>& FMassTrafficMovingInstances::FindOrAddMeshComponents(const FMeshComponentsKey& MeshComponentsKey, const FStaticMeshInstanceVisualizationDesc& StaticMeshDesc, const int32 NumCustomDataFloats)
+{
+	if (TArray<FMeshComponent>* MeshComponents = MeshComponentsByKey.Find(MeshComponentsKey))
+	{
+		return *MeshComponents;
+	}
+
+	// Every instance of a mesh desc shares its components' custom data layout
+	const int32& DescNumCustomDataFloats = NumCustomDataFloatsByDesc.FindOrAdd(MeshComponentsKey.StaticMeshDescIndex, NumCustomDataFloats);
+	checkf(DescNumCustomDataFloats == NumCustomDataFloats, TEXT("Instances of mesh desc %d have %d custom data floats, expected %d"), MeshComponentsKey.StaticMeshDescIndex, NumCustomDataFloats, DescNumCustomDataFloats);
+
+	// Reuse the pooled components of a cell that was left empty, if there are any
+	if (TArray<TArray<FMeshComponent>>* PooledMeshComponents = PooledMeshComponentsByDesc.Find(MeshComponentsKey.StaticMeshDescIndex))
+	{
+		if (!PooledMeshComponents->IsEmpty())
+		{
+			TArray<FMeshComponent>& MeshComponents = MeshComponentsByKey.Add(MeshComponentsKey, PooledMeshComponents->Pop(/*bAllowShrinking*/false));
+			for (FMeshComponent& MeshComponent : MeshComponents)
+			{
+				check(MeshComponent.SubmittedTransforms.IsEmpty());
+				if (UInstancedStaticMeshComponent* ISMComponent = MeshComponent.ISMComponent.Get())
+				{
+					ISMComponent->SetVisibility(true);
+				}
+			}
+			return MeshComponents;
+		}
+	}
+
+	// Create an ISM component per mesh for this cell
+	AActor& Actor = FindOrSpawnOwnerActor(OwnerActor, World.Get(), TEXT("MassTrafficMovingInstances"));
+	TArray<FMeshComponent>& MeshComponents = MeshComponentsByKey.Add(MeshComponentsKey);
+	MeshComponents.SetNum(StaticMeshDesc.Meshes.Num());
+	for (int32 MeshIndex = 0; MeshIndex < StaticMeshDesc.Meshes.Num(); ++MeshIndex)
+	{
+		MeshComponents[MeshIndex].ISMComponent = CreateMeshComponent(Actor, StaticMeshDesc.Meshes[MeshIndex], NumCustomDataFloats);
+	}
+
+	return MeshComponents;
+}
+
+void FMassTrafficMovingInstances::SubmitMeshInstances(FMeshComponent& MeshComponent, const int32 NumCustomDataFloats)
+{
+	// Cells whose instances all stood still, e.g: queued at a red light, keep their instance buffers as they are
+	const bool bTransformsUnchanged = Algo::CompareByPredicate(MeshComponent.Transforms, MeshComponent.SubmittedTransforms, [](const FTransform& Transform, const FTransform& SubmittedTransform)
+	{
+		return Transform.Equals(SubmittedTransform, /*Tolerance*/0.0);
+	});
+	if (bTransformsUnchanged && MeshComponent.CustomData == MeshComponent.SubmittedCustomData)
+	{
+		MeshComponent.Transforms.Reset();
+		MeshComponent.CustomData.Reset();
+		INC_DWORD_STAT(STAT_Traffic_MovingInstanceComponentsUnchanged);
+		return;
+	}
+
+	if (UInstancedStaticMeshComponent* ISMComponent = MeshComponent.ISMComponent.Get())
+	{
+		if (MeshComponent.Transforms.Num() == ISMComponent->GetInstanceCount())
+		{
+			ISMComponent->BatchUpdateInstancesTransforms(/*StartInstanceIndex*/0, MeshComponent.Transforms, /*bWorldSpace*/true, /*bMarkRenderStateDirty*/false, /*bTeleport*/true);
+		}
+		else
+		{
+			ISMComponent->ClearInstances();
+			ISMComponent->AddInstances(MeshComponent.Transforms, /*bShouldReturnIndices*/false, /*bWorldSpace*/true);
+		}
+
+		if (NumCustomDataFloats > 0)
+		{
+			for (int32 InstanceIndex = 0; InstanceIndex < MeshComponent.Transforms.Num(); ++InstanceIndex)
+			{
+				ISMComponent->SetCustomData(InstanceIndex, MakeArrayView(MeshComponent.CustomData.GetData() + InstanceIndex * NumCustomDataFloats, NumCustomDataFloats), /*bMarkRenderStateDirty*/false);
+			}
+		}
+
+		ISMComponent->MarkRenderStateDirty();
+	}
+
+	Swap(MeshComponent.Transforms, MeshComponent.SubmittedTransforms);
+	Swap(MeshComponent.CustomData, MeshComponent.SubmittedCustomData);
+	MeshComponent.Transforms.Reset();
+	MeshComponent.CustomData.Reset();
+
+	INC_DWORD_STAT(STAT_Traffic_MovingInstanceComponentsUpdated);
+}
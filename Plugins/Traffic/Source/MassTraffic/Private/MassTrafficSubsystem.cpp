@@ -5,9 +5,12 @@
 #include "MassTrafficDelegates.h"
 #include "MassTrafficFieldOperations.h"
 #include "MassTrafficFragments.h"
+#include "MassTrafficInterpolation.h"
+#include "MassTrafficLaneDataCache.h"
 #include "MassTrafficTypes.h"
 #include "MassTrafficRecycleVehiclesOverlappingPlayersProcessor.h"
 
+#include "Async/ParallelFor.h"
 #include "EngineUtils.h"
 #include "MassEntityManager.h"
 #include "MassEntitySubsystem.h"
@@ -126,6 +129,12 @@ void UMassTrafficSubsystem::Deinitialize()
 
 	EntityManager.Reset();
 
+	ParkedVehicleStaticInstances.Reset();
+	TrafficLightStaticInstances.Reset();
+	TrafficVehicleMovingInstances.Reset();
+	TrailerMovingInstances.Reset();
+	DriverMovingInstances.Reset();
+
 	Super::Deinitialize();
 }
 
@@ -185,10 +194,33 @@ void UMassTrafficSubsystem::RegisterZoneGraphData(const AZoneGraphData* ZoneGrap
 	if (LaneData.DataHandle != Storage.DataHandle)
 	{
 		// Initialize lane data if here the first time.
-		BuildLaneData(LaneData, Storage);
+		LoadOrBuildLaneData(LaneData, Storage, UE::MassTraffic::GetLaneDataCacheKey(Storage, *MassTrafficSettings));
 	}
 }
 
+void UMassTrafficSubsystem::LoadOrBuildLaneData(FMassTrafficZoneGraphData& TrafficZoneGraphData, const FZoneGraphStorage& ZoneGraphStorage, const uint32 SourceKey)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(TEXT("LoadOrBuildLaneData"))
+
+	if (MassTrafficSettings->bCacheLaneData)
+	{
+		const FString CacheFilename = UE::MassTraffic::GetLaneDataCacheFilename(*MassTrafficSettings, SourceKey);
+		if (!UE::MassTraffic::LoadLaneDataCache(CacheFilename, SourceKey, ZoneGraphStorage, TrafficZoneGraphData))
+		{
+			BuildLaneData(TrafficZoneGraphData, ZoneGraphStorage);
+			UE::MassTraffic::SaveLaneDataCache(CacheFilename, SourceKey, TrafficZoneGraphData);
+		}
+	}
+	else
+	{
+		BuildLaneData(TrafficZoneGraphData, ZoneGraphStorage);
+	}
+	TrafficZoneGraphData.SourceKey = SourceKey;
+
+	// Not cached, as it's quick to build & depends only on ZoneGraphStorage
+	TrafficZoneGraphData.LaneSegmentTable.Build(ZoneGraphStorage);
+}
+
 // Returns true if LaneIndex has both a merging and splitting lane that forms a Z shape
 bool IsZigLagLane(const FZoneGraphStorage& ZoneGraphStorage, const int32 LaneIndex, int32& OutMergingLaneIndex, int32& OutSplittingLaneIndex, bool& bOutSplittingRight)
 {
@@ -539,16 +571,80 @@ void UMassTrafficSubsystem::BuildLaneData(FMassTrafficZoneGraphData& TrafficZone
 			TrafficLaneData.ConstData.AverageNextLanesSpeedLimit = 0.0f;
 		}
 	}
+
+	// Now all lane links are set, precompute the routing tables vehicles choose their next lane from
+	TrafficZoneGraphData.BuildNextLaneRoutes();
 }
 
 void UMassTrafficSubsystem::RegisterField(UMassTrafficFieldComponent* Field)
 {
 	Fields.AddUnique(Field);
+	InvalidateFieldBatches();
 }
 
 void UMassTrafficSubsystem::UnregisterField(UMassTrafficFieldComponent* Field)
 {
 	Fields.Remove(Field);
+	InvalidateFieldBatches();
+}
+
+void UMassTrafficSubsystem::UpdateFieldBatches()
+{
+	if (!bFieldBatchesDirty)
+	{
+		return;
+	}
+
+	TRACE_CPUPROFILER_EVENT_SCOPE(TEXT("UpdateFieldBatches"))
+
+	FieldBatches.Reset();
+
+	// Put each field in the batch after the latest batch of any earlier field it shares lanes or intersections with, so
+	// overlapping fields always run in registration order. (Rather than in the first batch it doesn't overlap, which
+	// could run it before an earlier field it overlaps that had to go in a later batch.)
+	TMap<const FZoneGraphTrafficLaneData*, int32> LaneLatestBatchIndices;
+	TMap<FMassEntityHandle, int32> IntersectionLatestBatchIndices;
+	for (int32 FieldIndex = 0; FieldIndex < Fields.Num(); ++FieldIndex)
+	{
+		const UMassTrafficFieldComponent* Field = Fields[FieldIndex];
+		if (!Field)
+		{
+			continue;
+		}
+
+		int32 BatchIndex = 0;
+		for (const FZoneGraphTrafficLaneData* TrafficLane : Field->GetTrafficLanes())
+		{
+			if (const int32* LatestBatchIndex = LaneLatestBatchIndices.Find(TrafficLane))
+			{
+				BatchIndex = FMath::Max(BatchIndex, *LatestBatchIndex + 1);
+			}
+		}
+		for (const FMassEntityHandle IntersectionEntity : Field->GetTrafficIntersectionEntities())
+		{
+			if (const int32* LatestBatchIndex = IntersectionLatestBatchIndices.Find(IntersectionEntity))
+			{
+				BatchIndex = FMath::Max(BatchIndex, *LatestBatchIndex + 1);
+			}
+		}
+
+		if (BatchIndex == FieldBatches.Num())
+		{
+			FieldBatches.AddDefaulted();
+		}
+
+		FieldBatches[BatchIndex].Add(FieldIndex);
+		for (const FZoneGraphTrafficLaneData* TrafficLane : Field->GetTrafficLanes())
+		{
+			LaneLatestBatchIndices.Add(TrafficLane, BatchIndex);
+		}
+		for (const FMassEntityHandle IntersectionEntity : Field->GetTrafficIntersectionEntities())
+		{
+			IntersectionLatestBatchIndices.Add(IntersectionEntity, BatchIndex);
+		}
+	}
+
+	bFieldBatchesDirty = false;
 }
 
 const TMap<int32, FMassEntityHandle>& UMassTrafficSubsystem::GetTrafficIntersectionEntities() const
@@ -658,7 +754,7 @@ FZoneGraphTrafficLaneData* UMassTrafficSubsystem::GetMutableTrafficLaneData(cons
 int32 UMassTrafficSubsystem::GetNumTrafficVehicleAgents()
 {
 	check(EntityManager);
-	return TrafficVehicleEntityQuery.GetNumMatchingEntities(*EntityManager.Get());
+	return TrafficVehicleEntityQuery.GetNumMatchingEntities(*EntityManager.Get()) + FarFieldVehicles.Num();
 }
 
 bool UMassTrafficSubsystem::HasTrafficVehicleAgents()
@@ -688,6 +784,8 @@ void UMassTrafficSubsystem::ClearAllTrafficLanes()
 			TrafficLaneData.ClearVehicles();
 		}
 	}
+
+	FarFieldVehicles.Reset();
 }
 
 void UMassTrafficSubsystem::PerformFieldOperation(TSubclassOf<UMassTrafficFieldOperationBase> OperationType)
@@ -698,12 +796,49 @@ void UMassTrafficSubsystem::PerformFieldOperation(TSubclassOf<UMassTrafficFieldO
 		*EntityManager.Get(),
 		*ZoneGraphSubsystem);
 					
-	for (UMassTrafficFieldComponent* Field : Fields)
+	if (!GMassTrafficParallelFieldOperations)
 	{
-		if (Field->bEnabled)
+		for (UMassTrafficFieldComponent* Field : Fields)
 		{
-			Field->PerformFieldOperation(OperationType, FieldOperationBaseContext);
+			if (Field->bEnabled)
+			{
+				Field->PerformFieldOperation(OperationType, FieldOperationBaseContext);
+			}
 		}
+
+		return;
+	}
+
+	// Run each batch of fields that don't overlap each other in turn, so overlapping fields keep their registration order
+	UpdateFieldBatches();
+
+	TArray<UMassTrafficFieldComponent*> ParallelFields;
+	for (const TArray<int32>& FieldBatch : FieldBatches)
+	{
+		ParallelFields.Reset();
+		for (const int32 FieldIndex : FieldBatch)
+		{
+			UMassTrafficFieldComponent* Field = Fields[FieldIndex];
+			if (!Field->bEnabled)
+			{
+				continue;
+			}
+
+			// Fields with operations that must run serially do so here, as no other field in the batch overlaps them
+			if (Field->CanPerformFieldOperationInParallel(OperationType))
+			{
+				ParallelFields.Add(Field);
+			}
+			else
+			{
+				Field->PerformFieldOperation(OperationType, FieldOperationBaseContext);
+			}
+		}
+
+		ParallelFor(ParallelFields.Num(), [&](const int32 ParallelFieldIndex)
+		{
+			ParallelFields[ParallelFieldIndex]->PerformFieldOperation(OperationType, FieldOperationBaseContext);
+		}, ParallelFields.Num() <= 1 ? EParallelForFlags::ForceSingleThread : EParallelForFlags::None);
 	}
 }
 
@@ -803,12 +938,23 @@ void UMassTrafficSubsystem::RebuildLaneData()
 
 	for (FMassTrafficZoneGraphData& LaneData : RegisteredTrafficZoneGraphData)
 	{
-		LaneData.Reset();
 		const FZoneGraphStorage* Storage = ZoneGraphSubsystem->GetZoneGraphStorage(LaneData.DataHandle);
-		if (Storage)
+		if (!Storage)
 		{
-			BuildLaneData(LaneData, *Storage);
+			LaneData.Reset();
+			continue;
 		}
+
+		// Lanes never link across ZoneGraph storages, so lane data for storages that (along with the lane settings)
+		// haven't changed is still valid
+		const uint32 SourceKey = UE::MassTraffic::GetLaneDataCacheKey(*Storage, *MassTrafficSettings);
+		if (LaneData.SourceKey == SourceKey)
+		{
+			continue;
+		}
+
+		LaneData.Reset();
+		LoadOrBuildLaneData(LaneData, *Storage, SourceKey);
 	}
 
 	UE::MassTrafficDelegates::OnTrafficLaneDataChanged.Broadcast(this);
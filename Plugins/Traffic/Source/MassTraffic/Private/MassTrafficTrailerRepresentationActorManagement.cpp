@@ -29,6 +29,13 @@ EMassActorSpawnRequestAction  UMassTrafficTrailerRepresentationActorManagement::
 	FMassEntityView TrailerMassEntityView(*EntityManager, MassActorSpawnRequest.MassAgent);
 	FMassTrafficRandomFractionFragment& TrailerRandomFractionFragment = TrailerMassEntityView.GetFragmentData<FMassTrafficRandomFractionFragment>();  
 
+	// Resolve the components visualization updates every frame, once
+	FMassTrafficVehicleActorComponentsFragment* TrailerActorComponentsFragment = TrailerMassEntityView.GetFragmentDataPtr<FMassTrafficVehicleActorComponentsFragment>();
+	if (TrailerActorComponentsFragment)
+	{
+		TrailerActorComponentsFragment->Resolve(*MassActorSpawnRequest.SpawnedActor);
+	}
+
 	// Backup custom instance data in case we don't have a truck pulling us.
 	FMassTrafficPackedVehicleInstanceCustomData PackedCustomData = FMassTrafficVehicleInstanceCustomData::MakeTrafficVehicleTrailerCustomData(TrailerRandomFractionFragment);
 
@@ -151,7 +158,7 @@ EMassActorSpawnRequestAction  UMassTrafficTrailerRepresentationActorManagement::
 		const FMassTrafficVehiclePhysicsFragment* TrailerSimpleVehiclePhysicsFragment = TrailerMassEntityView.GetFragmentDataPtr<FMassTrafficVehiclePhysicsFragment>();
 		if (TrailerSimpleVehiclePhysicsFragment)
 		{
-			UMassTrafficVehicleComponent* MassTrafficVehicleComponent = MassActorSpawnRequest.SpawnedActor->FindComponentByClass<UMassTrafficVehicleComponent>();
+			UMassTrafficVehicleComponent* MassTrafficVehicleComponent = TrailerActorComponentsFragment ? TrailerActorComponentsFragment->VehicleComponent.Get() : MassActorSpawnRequest.SpawnedActor->FindComponentByClass<UMassTrafficVehicleComponent>();
 			if (MassTrafficVehicleComponent)
 			{
 				// Init offsets?
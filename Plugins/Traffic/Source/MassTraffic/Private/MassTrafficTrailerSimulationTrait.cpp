@@ -55,6 +55,7 @@ void UMassTrafficTrailerSimulationTrait::BuildTemplate(FMassEntityTemplateBuildC
 	BuildContext.AddFragment<FMassTrafficAngularVelocityFragment>();
 	BuildContext.AddFragment<FMassTrafficConstrainedVehicleFragment>();
 	BuildContext.AddFragment<FMassTrafficInterpolationFragment>();
+	BuildContext.AddFragment<FMassTrafficPreviousTransformFragment>();
 	BuildContext.RequireFragment<FMassTrafficRandomFractionFragment>();
 	BuildContext.AddFragment<FMassVelocityFragment>();
 
@@ -52,16 +52,20 @@ void UMassTrafficTrailerUpdateCustomVisualizationProcessor::ConfigureQueries()
 	EntityQuery.AddRequirement<FMassRepresentationFragment>(EMassFragmentAccess::ReadWrite);
 	EntityQuery.AddRequirement<FMassRepresentationLODFragment>(EMassFragmentAccess::ReadOnly);
 	EntityQuery.AddRequirement<FMassActorFragment>(EMassFragmentAccess::ReadWrite);
+	EntityQuery.AddRequirement<FMassTrafficVehicleActorComponentsFragment>(EMassFragmentAccess::ReadWrite);
 	EntityQuery.AddChunkRequirement<FMassVisualizationChunkFragment>(EMassFragmentAccess::ReadWrite);
 	EntityQuery.AddSharedRequirement<FMassRepresentationSubsystemSharedFragment>(EMassFragmentAccess::ReadWrite);
 
 	EntityQuery.AddRequirement<FMassTrafficRandomFractionFragment>(EMassFragmentAccess::ReadOnly);
 	EntityQuery.AddRequirement<FMassTrafficVehiclePhysicsFragment>(EMassFragmentAccess::ReadOnly, EMassFragmentPresence::Optional);
 	EntityQuery.AddRequirement<FMassTrafficConstrainedVehicleFragment>(EMassFragmentAccess::ReadOnly);
+	EntityQuery.AddRequirement<FMassTrafficPreviousTransformFragment>(EMassFragmentAccess::ReadOnly, EMassFragmentPresence::Optional);
 	EntityQuery.SetChunkFilter(&FMassVisualizationChunkFragment::AreAnyEntitiesVisibleInChunk);
 #if ENABLE_VISUAL_LOG
 	EntityQuery.AddSubsystemRequirement<UMassTrafficSubsystem>(EMassFragmentAccess::ReadOnly);
 #endif // ENABLE_VISUAL_LOG
+
+	ProcessorRequirements.AddSubsystemRequirement<UMassTrafficSubsystem>(EMassFragmentAccess::ReadWrite);
 }
 
 void UMassTrafficTrailerUpdateCustomVisualizationProcessor::Execute(FMassEntityManager& EntityManager, FMassExecutionContext& Context)
@@ -71,7 +75,21 @@ void UMassTrafficTrailerUpdateCustomVisualizationProcessor::Execute(FMassEntityM
 	// 
 	// Otherwise the total mesh instance count (e.g: 7 traffic + 3 parked) would be mismatched with the
 	// total custom data count (e.g: 7 traffic + 0 parked)
-	EntityQuery.ForEachEntityChunk(EntityManager, Context, [this, &EntityManager](FMassExecutionContext& QueryContext)
+	UMassTrafficSubsystem& MassTrafficSubsystem = Context.GetMutableSubsystemChecked<UMassTrafficSubsystem>(EntityManager.GetWorld());
+	const FMassTrafficSimulationClock& SimulationClock = MassTrafficSubsystem.GetSimulationClock();
+
+	FMassTrafficMovingInstances& MovingInstances = MassTrafficSubsystem.GetMutableTrailerMovingInstances();
+	const bool bUseMovingInstances = GMassTrafficStaticInstances != 0;
+	if (bUseMovingInstances)
+	{
+		MovingInstances.BeginUpdate(*EntityManager.GetWorld());
+	}
+	else if (MovingInstances.Num() > 0)
+	{
+		MovingInstances.Reset();
+	}
+
+	EntityQuery.ForEachEntityChunk(EntityManager, Context, [this, &EntityManager, &SimulationClock, &MovingInstances, bUseMovingInstances](FMassExecutionContext& QueryContext)
 	{
 		UMassRepresentationSubsystem* RepresentationSubsystem = QueryContext.GetMutableSharedFragment<FMassRepresentationSubsystemSharedFragment>().RepresentationSubsystem;
 		check(RepresentationSubsystem);
@@ -82,9 +100,11 @@ void UMassTrafficTrailerUpdateCustomVisualizationProcessor::Execute(FMassEntityM
 		const TConstArrayView<FMassTrafficRandomFractionFragment> RandomFractionFragments = QueryContext.GetFragmentView<FMassTrafficRandomFractionFragment>();
 		const TConstArrayView<FMassRepresentationLODFragment> RepresentationLODFragments = QueryContext.GetFragmentView<FMassRepresentationLODFragment>();
 		const TConstArrayView<FTransformFragment> TransformFragments = QueryContext.GetFragmentView<FTransformFragment>();
+		const TConstArrayView<FMassTrafficPreviousTransformFragment> PreviousTransformFragments = QueryContext.GetFragmentView<FMassTrafficPreviousTransformFragment>();
 		const TConstArrayView<FMassTrafficVehiclePhysicsFragment> SimpleVehiclePhysicsFragments = QueryContext.GetFragmentView<FMassTrafficVehiclePhysicsFragment>();
 		const TArrayView<FMassRepresentationFragment> RepresentationFragments = QueryContext.GetMutableFragmentView<FMassRepresentationFragment>();
 		const TArrayView<FMassActorFragment> ActorFragments = QueryContext.GetMutableFragmentView<FMassActorFragment>();
+		const TArrayView<FMassTrafficVehicleActorComponentsFragment> ActorComponentsFragments = QueryContext.GetMutableFragmentView<FMassTrafficVehicleActorComponentsFragment>();
 		for (int32 EntityIndex = 0; EntityIndex < NumEntities; EntityIndex++)
 		{
 			const FMassTrafficConstrainedVehicleFragment& ConstrainedVehicleFragment = ConstrainedVehicleFragments[EntityIndex];
@@ -93,6 +113,11 @@ void UMassTrafficTrailerUpdateCustomVisualizationProcessor::Execute(FMassEntityM
 			const FTransformFragment& TransformFragment = TransformFragments[EntityIndex];
 			FMassRepresentationFragment& RepresentationFragment = RepresentationFragments[EntityIndex];
 			FMassActorFragment& ActorFragment = ActorFragments[EntityIndex];
+			FMassTrafficVehicleActorComponentsFragment& ActorComponentsFragment = ActorComponentsFragments[EntityIndex];
+
+			// Interpolate between fixed timestep simulation states
+			const FTransform VisualTransform = PreviousTransformFragments.IsEmpty() ? TransformFragment.GetTransform() :
+				SimulationClock.GetInterpolatedTransform(PreviousTransformFragments[EntityIndex].Transform, PreviousTransformFragments[EntityIndex].Step, TransformFragment.GetTransform());
 
 			// Prepare custom instance data. All we really need this for is to toggle break lights.
 			FMassEntityView VehicleMassEntityView(EntityManager, ConstrainedVehicleFragment.Vehicle);
@@ -109,63 +134,42 @@ void UMassTrafficTrailerUpdateCustomVisualizationProcessor::Execute(FMassEntityM
 				{
 					if (AActor* Actor = ActorFragment.GetMutable())
 					{
+						// Components are resolved when the actor is spawned, but actors can also be swapped in from
+						// elsewhere (e.g: pooled), in which case resolve them now
+						ActorComponentsFragment.Resolve(*Actor);
+
 						// Update actor transform
-						QueryContext.Defer().PushCommand<FMassDeferredSetCommand>([Actor, NewActorTransform = TransformFragment.GetTransform()](FMassEntityManager& System)
-						{
-							Actor->SetActorTransform(NewActorTransform);
-						});
+						ActorUpdateBatch.AddActorTransform(*Actor, VisualTransform);
 						
-						// Has simple vehicle physics?
+						// Has simple vehicle physics & a UMassTrafficVehicleComponent with wheel mesh references?
 						if (!SimpleVehiclePhysicsFragments.IsEmpty())
 						{
-							// Has a UMassTrafficVehicleComponent with wheel mesh references? 
-							UMassTrafficVehicleComponent* MassTrafficVehicleComponent = Actor->FindComponentByClass<UMassTrafficVehicleComponent>();
-							if (MassTrafficVehicleComponent)
+							if (UMassTrafficVehicleComponent* MassTrafficVehicleComponent = ActorComponentsFragment.VehicleComponent.Get())
 							{
-								// Update wheel component transforms from simple vehicle physics sim.
-								// This should be safe to reference SimpleVehiclePhysicsFragment directly as
-								// we should be done writing to the VehicleSim this frame.
-								QueryContext.Defer().PushCommand<FMassDeferredSetCommand>([MassTrafficVehicleComponent, Entity = QueryContext.GetEntity(EntityIndex)](FMassEntityManager& CallbackEntitySubsystem)
-								{
-									if (CallbackEntitySubsystem.IsEntityValid(Entity))
-									{
-										// If the simulation LOD changed this frame, removal of the
-										// FDataFragment_SimpleVehiclePhysics would have been queued and executed 
-										// before this deferred command, thus actually removing the fragment we
-										// thought we had via the check above. So we safely check again here for
-										// FDataFragment_SimpleVehiclePhysics using an FMassEntityView    
-										const FMassTrafficVehiclePhysicsFragment* SimpleVehiclePhysicsFragment = CallbackEntitySubsystem.GetFragmentDataPtr<FMassTrafficVehiclePhysicsFragment>(Entity);
-										if (SimpleVehiclePhysicsFragment)
-										{
-											// Init offsets?
-											if (MassTrafficVehicleComponent->WheelOffsets.IsEmpty())
-											{
-												MassTrafficVehicleComponent->InitWheelAttachmentOffsets(SimpleVehiclePhysicsFragment->VehicleSim);
-											}
-							
-											// Update
-											MassTrafficVehicleComponent->UpdateWheelComponents(SimpleVehiclePhysicsFragment->VehicleSim);
-										}
-									}
-								});
+								// Update wheel component transforms from simple vehicle physics sim
+								ActorUpdateBatch.AddWheelUpdate(*MassTrafficVehicleComponent, QueryContext.GetEntity(EntityIndex));
 							}
 						}
 
 						// Update primitive component custom data
-						Actor->ForEachComponent<UPrimitiveComponent>(/*bIncludeFromChildActors*/true, [&PackedCustomData](UPrimitiveComponent* PrimitiveComponent)
-						{
-							PrimitiveComponent->SetCustomPrimitiveDataFloat(/*DataIndex*/1, PackedCustomData.PackedParam1);
-						});
+						ActorComponentsFragment.SetCustomPrimitiveDataFloat(/*DataIndex*/1, PackedCustomData.PackedParam1);
 					}
 
 					break;
 				}
 				case EMassRepresentationType::StaticMeshInstance:
 				{
-					// Add batched instance transform & custom data
-					const int32 InstanceId = GetTypeHash(QueryContext.GetEntity(EntityIndex));
-					ISMInfo[RepresentationFragment.StaticMeshDescIndex].AddBatchedTransform(InstanceId, TransformFragment.GetTransform(), RepresentationFragment.PrevTransform, RepresentationLODFragment.LODSignificance);
-					ISMInfo[RepresentationFragment.StaticMeshDescIndex].AddBatchedCustomData(PackedCustomData, RepresentationLODFragment.LODSignificance);
+					if (bUseMovingInstances)
+					{
+						MovingInstances.AddInstance(RepresentationFragment.StaticMeshDescIndex, ISMInfo[RepresentationFragment.StaticMeshDescIndex].GetDesc(), VisualTransform, RepresentationLODFragment.LODSignificance, PackedCustomData);
+					}
+					else
+					{
+						// Add batched instance transform & custom data
+						const int32 InstanceId = GetTypeHash(QueryContext.GetEntity(EntityIndex));
+						ISMInfo[RepresentationFragment.StaticMeshDescIndex].AddBatchedTransform(InstanceId, VisualTransform, RepresentationFragment.PrevTransform, RepresentationLODFragment.LODSignificance);
+						ISMInfo[RepresentationFragment.StaticMeshDescIndex].AddBatchedCustomData(PackedCustomData, RepresentationLODFragment.LODSignificance);
+					}
 
 					break;
 				}
@@ -175,10 +179,18 @@ void UMassTrafficTrailerUpdateCustomVisualizationProcessor::Execute(FMassEntityM
 				}
 			}
 			
-			RepresentationFragment.PrevTransform = TransformFragment.GetTransform();
+			RepresentationFragment.PrevTransform = VisualTransform;
 		}
 	});
 
+	if (bUseMovingInstances)
+	{
+		MovingInstances.EndUpdate();
+	}
+
+	// Apply this frame's actor transform & wheel updates together
+	ActorUpdateBatch.Defer(Context.Defer());
+
 #if ENABLE_VISUAL_LOG
 	
 	// Debug draw current visualization
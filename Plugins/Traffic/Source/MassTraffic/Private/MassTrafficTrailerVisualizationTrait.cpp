@@ -49,4 +49,5 @@ void UMassTrafficTrailerVisualizationTrait::BuildTemplate(FMassEntityTemplateBui
 	
 	BuildContext.RequireFragment<FMassTrafficRandomFractionFragment>();
 	BuildContext.AddFragment<FMassActorFragment>();
+	BuildContext.AddFragment<FMassTrafficVehicleActorComponentsFragment>();
 }
@@ -1,13 +1,13 @@
 // Copyright Epic Games, Inc. All Rights Reserved.
 
 #include "MassTrafficTypes.h"
+#include "MassTraffic.h"
 #include "MassTrafficFragments.h"
-#include "MassTrafficDebugHelpers.h"
-#include "MassTrafficSubsystem.h"
 
 #include "MassCommonFragments.h"
 #include "MassEntityView.h"
 #include "MassZoneGraphNavigationFragments.h"
+#include "Algo/BinarySearch.h"
 
 FZoneGraphTrafficLaneData::FZoneGraphTrafficLaneData():
 	bIsOpen(true),
@@ -19,6 +19,7 @@ FZoneGraphTrafficLaneData::FZoneGraphTrafficLaneData():
 	bIsDownstreamFromIntersection(false),
 	bIsStoppedVehicleInPreviousLaneOverlappingThisLane(false),
 	bIsVehicleReadyToUseLane(false),
+	bIsFarField(false),
 	MaxDensity(1.0f)
 {
 }
@@ -36,55 +37,114 @@ void FZoneGraphTrafficLaneData::ClearVehicles()
 	NumVehiclesLaneChangingOntoLane = 0;
 	NumVehiclesLaneChangingOffOfLane = 0;
 	NumReservedVehiclesOnLane = 0;
+	Vehicles.Reset();
+	bIsFarField = false;
+	FarFieldNumVehicles = 0.0f;
+	FarFieldPendingVehicles = 0.0f;
+	FarFieldSpeed = 0.0f;
 }
 
-void FZoneGraphTrafficLaneData::ForEachVehicleOnLane(const FMassEntityManager& EntityManager, FTrafficVehicleExecuteFunction Function) const
+void FZoneGraphTrafficLaneData::AddTailVehicle(const FMassEntityHandle Entity, const float DistanceAlongLane, const float VehicleRadius)
 {
-	int32 IterationCounter = 0;
+	InsertVehicle(0, Entity, DistanceAlongLane, VehicleRadius);
+}
 
-	FMassEntityHandle VehicleEntity = TailVehicle;
-	while (VehicleEntity.IsSet())
+void FZoneGraphTrafficLaneData::InsertVehicleAhead(const FMassEntityHandle BehindEntity, const FMassEntityHandle Entity, const float DistanceAlongLane, const float VehicleRadius)
+{
+	const int32 BehindIndex = Vehicles.IndexOfByPredicate([BehindEntity](const FMassTrafficLaneVehicle& LaneVehicle)
 	{
-		FMassEntityView VehicleEntityView(EntityManager, VehicleEntity);
-		FMassZoneGraphLaneLocationFragment& LaneLocationFragment = VehicleEntityView.GetFragmentData<FMassZoneGraphLaneLocationFragment>();
-		if (LaneLocationFragment.LaneHandle != LaneHandle)
-		{
-			break;
-		}
-		FMassTrafficNextVehicleFragment& NextVehicleFragment = VehicleEntityView.GetFragmentData<FMassTrafficNextVehicleFragment>();
+		return LaneVehicle.Entity == BehindEntity;
+	});
+
+	const int32 InsertIndex = (BehindIndex != INDEX_NONE) ? BehindIndex + 1 : FindFirstVehicleIndexAhead(DistanceAlongLane);
+	InsertVehicle(InsertIndex, Entity, DistanceAlongLane, VehicleRadius);
+}
 
-		// Execute callback
-		const bool bContinue = Function(VehicleEntityView, NextVehicleFragment, LaneLocationFragment);
-		if (!bContinue)
+void FZoneGraphTrafficLaneData::InsertVehicle(const int32 Index, const FMassEntityHandle Entity, const float DistanceAlongLane, const float VehicleRadius)
+{
+	// The vehicle ahead's cached distance may be behind DistanceAlongLane, as it has moved since it was cached.
+	const float CachedDistanceAlongLane = Vehicles.IsValidIndex(Index) ? FMath::Min(DistanceAlongLane, Vehicles[Index].DistanceAlongLane) : DistanceAlongLane;
+	Vehicles.Insert(FMassTrafficLaneVehicle(Entity, CachedDistanceAlongLane, VehicleRadius), Index);
+
+	// Vehicles behind may be further along than us, e.g. a vehicle lane changing in behind the one it was level with.
+	for (int32 BehindIndex = Index - 1; BehindIndex >= 0 && Vehicles[BehindIndex].DistanceAlongLane > CachedDistanceAlongLane; --BehindIndex)
+	{
+		Vehicles[BehindIndex].DistanceAlongLane = CachedDistanceAlongLane;
+	}
+}
+
+bool FZoneGraphTrafficLaneData::RemoveVehicle(const FMassEntityHandle Entity)
+{
+	// Vehicles usually leave from the front of the lane, so search from the back of the array.
+	for (int32 Index = Vehicles.Num() - 1; Index >= 0; --Index)
+	{
+		if (Vehicles[Index].Entity == Entity)
 		{
-			break;
+			Vehicles.RemoveAt(Index, 1, /*bAllowShrinking*/false);
+			return true;
 		}
+	}
+
+	return false;
+}
 
-		// Infinite loop check
-		if (!ensureMsgf(VehicleEntity != NextVehicleFragment.GetNextVehicle(), TEXT("ForEachVehicleOnLane on %d detected an infinite loop where a vehicle's NextVehicle is itself (%d). The loop will now be terminated"), LaneHandle.Index, VehicleEntity.Index))
+void FZoneGraphTrafficLaneData::RefreshVehicles(const FMassEntityManager& EntityManager)
+{
+	for (int32 Index = 0; Index < Vehicles.Num(); )
+	{
+		FMassTrafficLaneVehicle& LaneVehicle = Vehicles[Index];
+		if (EntityManager.IsEntityValid(LaneVehicle.Entity))
 		{
-			break;
+			const FMassEntityView VehicleEntityView(EntityManager, LaneVehicle.Entity);
+			const FMassZoneGraphLaneLocationFragment& LaneLocationFragment = VehicleEntityView.GetFragmentData<FMassZoneGraphLaneLocationFragment>();
+			if (LaneLocationFragment.LaneHandle == LaneHandle)
+			{
+				LaneVehicle.DistanceAlongLane = LaneLocationFragment.DistanceAlongLane;
+				LaneVehicle.Radius = VehicleEntityView.GetFragmentData<FAgentRadiusFragment>().Radius;
+				++Index;
+				continue;
+			}
 		}
 
-		// Advance to next vehicle
-		VehicleEntity = NextVehicleFragment.GetNextVehicle();
+		// Vehicle was destroyed, or left this lane without telling us.
+		Vehicles.RemoveAt(Index, 1, /*bAllowShrinking*/false);
+	}
+
+	// Vehicles can be slightly out of order along the lane, e.g. just after lane changing in level with another vehicle.
+	// Cache no further than the vehicle ahead, so cached distances stay in ascending order.
+	for (int32 Index = Vehicles.Num() - 2; Index >= 0; --Index)
+	{
+		Vehicles[Index].DistanceAlongLane = FMath::Min(Vehicles[Index].DistanceAlongLane, Vehicles[Index + 1].DistanceAlongLane);
+	}
+}
 
-		// Infinite loop check
-		if (VehicleEntity == TailVehicle)
+int32 FZoneGraphTrafficLaneData::FindFirstVehicleIndexAhead(const float DistanceAlongLane) const
+{
+	return Algo::UpperBoundBy(Vehicles, DistanceAlongLane, &FMassTrafficLaneVehicle::DistanceAlongLane);
+}
+
+int32 FZoneGraphTrafficLaneData::FindVehicleIndex(const FMassEntityHandle Entity, const float DistanceAlongLane) const
+{
+	// Entity's cached distance is at most its current one, so it should be at or before the first vehicle ahead of it
+	const int32 SearchStartIndex = FMath::Min(FindFirstVehicleIndexAhead(DistanceAlongLane), Vehicles.Num() - 1);
+	for (int32 Index = SearchStartIndex; Index >= 0; --Index)
+	{
+		if (Vehicles[Index].Entity == Entity)
 		{
-			// Infinite following loop detected along a single lane. This can happen legally if traffic can
-			// travel in a small loop but should be extremely rare in realistic traffic scenarios.
-			break;
+			return Index;
 		}
+	}
 
-		if (!ensureMsgf(++IterationCounter < 10000, TEXT("ForEachVehicleOnLane on %d reached iteration limit %d, which likely indicates an infinite loop bug. The loop will now be terminated."), LaneHandle.Index, IterationCounter))
+	// Only if the cache is out of order, e.g. Entity was moved back along the lane since it was last refreshed.
+	for (int32 Index = SearchStartIndex + 1; Index < Vehicles.Num(); ++Index)
+	{
+		if (Vehicles[Index].Entity == Entity)
 		{
-			const UMassTrafficSubsystem* MassTrafficSubsystem = UWorld::GetSubsystem<UMassTrafficSubsystem>(EntityManager.GetWorld());
-			UE::MassTraffic::VisLogMalformedNextLaneLinks(EntityManager, LaneHandle.Index, TailVehicle, FMassEntityHandle(), /*MarchEjectAt*/10000, MassTrafficSubsystem);
-			
-			break;
+			return Index;
 		}
 	}
+
+	return INDEX_NONE;
 }
 
 
@@ -125,6 +185,18 @@ void FZoneGraphTrafficLaneData::AddVehicleOccupancy(const float SpaceToRemove)
 	SpaceAvailable -= SpaceToRemove;
 }
 
+void FZoneGraphTrafficLaneData::AddFarFieldVehicles(const float NumVehicles, const float VehicleSpacing)
+{
+	FarFieldNumVehicles += NumVehicles;
+	SpaceAvailable -= NumVehicles * VehicleSpacing;
+}
+
+void FZoneGraphTrafficLaneData::RemoveFarFieldVehicles(const float NumVehicles, const float VehicleSpacing)
+{
+	FarFieldNumVehicles = FMath::Max(FarFieldNumVehicles - NumVehicles, 0.0f);
+	SpaceAvailable = FMath::Min(SpaceAvailable + NumVehicles * VehicleSpacing, Length);
+}
+
 float FZoneGraphTrafficLaneData::SpaceAvailableFromStartOfLaneForVehicle(const FMassEntityManager& EntityManager, const bool bCheckLaneChangeGhostVehicles, const bool bCheckSplittingAndMergingGhostTailVehicles) const 
 {
 	float SpaceAvailableFromStartOfLane = SpaceAvailable;
@@ -174,6 +246,37 @@ float FZoneGraphTrafficLaneData::SpaceAvailableFromStartOfLaneForVehicle(const F
 }
 
 
+void FZoneGraphTrafficLaneData::BuildNextLaneRoutes()
+{
+	NextLaneRoutes.Reset();
+	for (FZoneGraphTrafficLaneData* NextLane : NextLanes)
+	{
+		FMassTrafficNextLaneRoute& Route = NextLaneRoutes.AddDefaulted_GetRef();
+		Route.NextLane = NextLane;
+		Route.DestinationLane = NextLane;
+		Route.bIsTrunkLane = NextLane->ConstData.bIsTrunkLane;
+		Route.bTurnsLeft = NextLane->bTurnsLeft;
+		Route.bTurnsRight = NextLane->bTurnsRight;
+
+		// Intersection lanes are judged by the lane at the intersection exit, so must have exactly one next lane
+		if (NextLane->ConstData.bIsIntersectionLane)
+		{
+			if (NextLane->NextLanes.Num() != 1)
+			{
+				UE_LOG(LogMassTraffic, Warning, TEXT("%s - Lane %s is an intersection lane, that should have only one next lane, but it has %d."),
+					ANSI_TO_TCHAR(__FUNCTION__), *NextLane->LaneHandle.ToString(), NextLane->NextLanes.Num());
+
+				NextLaneRoutes.Pop(/*bAllowShrinking*/false);
+				continue;
+			}
+
+			Route.DestinationLane = NextLane->NextLanes[0];
+		}
+
+		Route.DestinationLaneLength = Route.DestinationLane->Length;
+	}
+}
+
 void FZoneGraphTrafficLaneData::UpdateDownstreamFlowDensity(float DownstreamFlowDensityMixtureFraction)
 {
 	float NextLanesDownstreamFlowDensity_Total = 0.0f;
@@ -219,3 +322,69 @@ void FZoneGraphTrafficLaneData::UpdateDownstreamFlowDensity(float DownstreamFlow
 			Alpha);
 	}
 }
+
+
+void FMassTrafficSimulationClock::Advance(const float FrameDeltaTime, const float InFixedDeltaTime, const int32 MaxSubsteps)
+{
+	check(InFixedDeltaTime > 0.0f);
+	
+	bFixedTimestep = true;
+	FixedDeltaTime = InFixedDeltaTime;
+	VariableDeltaTime = 0.0f;
+
+	Accumulator += FrameDeltaTime;
+	NumSubsteps = FMath::FloorToInt(Accumulator / FixedDeltaTime);
+	if (NumSubsteps > MaxSubsteps)
+	{
+		// Drop the time we can't catch up on, rather than falling further behind every frame
+		NumSubsteps = FMath::Max(MaxSubsteps, 0);
+		Accumulator = 0.0f;
+	}
+	else
+	{
+		Accumulator = FMath::Max(Accumulator - NumSubsteps * FixedDeltaTime, 0.0f);
+	}
+
+	SimulationTime += NumSubsteps * FixedDeltaTime;
+	StepIndex += NumSubsteps;
+
+	if (NumSubsteps > 0)
+	{
+		NumInterpolatedSubsteps = NumSubsteps;
+	}
+
+	// Visualization is rendered one substep behind the simulation, across the substeps simulated on the last frame
+	// that had any. i.e: When a single substep is simulated per frame, this is the usual Accumulator / FixedDeltaTime.
+	if (NumInterpolatedSubsteps > 0)
+	{
+		const float InterpolationSpan = NumInterpolatedSubsteps * FixedDeltaTime;
+		InterpolationAlpha = FMath::Clamp((InterpolationSpan - FixedDeltaTime + Accumulator) / InterpolationSpan, 0.0f, 1.0f);
+	}
+	else
+	{
+		// Nothing to interpolate from yet
+		InterpolationAlpha = 1.0f;
+	}
+}
+
+void FMassTrafficSimulationClock::AdvanceVariable(const float FrameDeltaTime)
+{
+	bFixedTimestep = false;
+	VariableDeltaTime = FrameDeltaTime;
+	SimulationTime += FrameDeltaTime;
+	Accumulator = 0.0f;
+	NumSubsteps = 1;
+	NumInterpolatedSubsteps = 0;
+	InterpolationAlpha = 1.0f;
+}
+
+int32 FMassTrafficSimulationClock::GetNumSteps(const float DeltaTime, const EMassLOD::Type LOD, const EMassLOD::Type MaxSubstepLOD) const
+{
+	// Lower LODs integrate their whole delta time in one coarse step
+	if (!bFixedTimestep || LOD > MaxSubstepLOD)
+	{
+		return 1;
+	}
+
+	return FMath::Max(FMath::RoundToInt(DeltaTime / FixedDeltaTime), 1);
+}
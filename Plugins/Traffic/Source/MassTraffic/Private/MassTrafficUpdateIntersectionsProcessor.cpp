@@ -4,6 +4,7 @@
 #include "MassTrafficUpdateIntersectionsProcessor.h"
 #include "MassTraffic.h"
 #include "MassTrafficFragments.h"
+#include "MassTrafficSubsystem.h"
 #include "MassTrafficDebugHelpers.h"
 #include "MassRepresentationFragments.h"
 
@@ -22,6 +23,10 @@
 #define DEBUG_INTERSECTION_STALLS 0
 
 
+DECLARE_DWORD_COUNTER_STAT(TEXT("Intersections Updated"), STAT_Traffic_IntersectionsUpdated, STATGROUP_Traffic);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Intersections Waiting For Period Deadline"), STAT_Traffic_IntersectionsWaitingForPeriodDeadline, STATGROUP_Traffic);
+
+
 namespace 
 {
 	FORCEINLINE void CloseLaneAndAllItsSplitLanes(FZoneGraphTrafficLaneData& TrafficLaneData)
@@ -459,13 +464,14 @@ UMassTrafficUpdateIntersectionsProcessor::UMassTrafficUpdateIntersectionsProcess
 void UMassTrafficUpdateIntersectionsProcessor::ConfigureQueries()
 {
 	EntityQuery.AddRequirement<FMassTrafficIntersectionFragment>(EMassFragmentAccess::ReadWrite);
-	EntityQuery.AddSubsystemRequirement<UZoneGraphSubsystem>(EMassFragmentAccess::ReadOnly);
-	EntityQuery.AddSubsystemRequirement<UMassCrowdSubsystem>(EMassFragmentAccess::ReadWrite);
+	EntityQuery.AddTagRequirement<FMassTrafficIntersectionWaitingForPeriodDeadlineTag>(EMassFragmentPresence::None);
 #if WITH_MASSTRAFFIC_DEBUG
 	EntityQuery.AddRequirement<FMassRepresentationLODFragment>(EMassFragmentAccess::ReadOnly);
 	EntityQuery.AddRequirement<FTransformFragment>(EMassFragmentAccess::ReadOnly);
 #endif
 
+	ProcessorRequirements.AddSubsystemRequirement<UZoneGraphSubsystem>(EMassFragmentAccess::ReadOnly);
+	ProcessorRequirements.AddSubsystemRequirement<UMassCrowdSubsystem>(EMassFragmentAccess::ReadWrite);
 	ProcessorRequirements.AddSubsystemRequirement<UMassTrafficSubsystem>(EMassFragmentAccess::ReadWrite);
 }
 
@@ -484,343 +490,440 @@ void UMassTrafficUpdateIntersectionsProcessor::Execute(FMassEntityManager& Entit
 	// Get world
 	const UWorld* World = GetWorld();
 
-	// Process chunks -
-	EntityQuery.ForEachEntityChunk(EntityManager, Context, [&, World](FMassExecutionContext& QueryContext)
+	UMassCrowdSubsystem& MassCrowdSubsystem = Context.GetMutableSubsystemChecked<UMassCrowdSubsystem>(World);
+	const UZoneGraphSubsystem& ZoneGraphSubsystem = Context.GetSubsystemChecked<UZoneGraphSubsystem>(World);
+
+	// Advance intersection periods in step with the traffic simulation clock
+	const float DeltaTimeSeconds = MassTrafficSubsystem.GetSimulationClock().GetDeltaTime();
+
+	const bool bScheduleIntersections = GMassTrafficScheduleIntersections && !GMassTrafficDebugIntersections;
+
+	IntersectionUpdates.Reset();
+
+	// INTERSECTIONDEADLINE - Count down the waiting intersections just as a full update would, in FFloat16, so their
+	// timings don't drift from intersections that are never skipped. Those that reach their deadline this frame (or all of
+	// them, if scheduling has been turned off) are woken with the time they had remaining before this frame, for their
+	// full update to count down.
+	for (int32 WaitingIndex = WaitingIntersections.Num() - 1; WaitingIndex >= 0; --WaitingIndex)
 	{
-		UMassCrowdSubsystem& MassCrowdSubsystem = QueryContext.GetMutableSubsystemChecked<UMassCrowdSubsystem>(World);
-		const UZoneGraphSubsystem& ZoneGraphSubsystem = QueryContext.GetSubsystemChecked<UZoneGraphSubsystem>(World);
+		FWaitingIntersection& WaitingIntersection = WaitingIntersections[WaitingIndex];
+		const FFloat16 PeriodTimeRemaining_AfterUpdate(WaitingIntersection.PeriodTimeRemaining - DeltaTimeSeconds);
+		if (bScheduleIntersections && PeriodTimeRemaining_AfterUpdate > MassTrafficSettings->StandardTrafficPrepareToStopSeconds)
+		{
+			WaitingIntersection.PeriodTimeRemaining = PeriodTimeRemaining_AfterUpdate;
+			continue;
+		}
+
+		const FWaitingIntersection WokenIntersection = WaitingIntersection;
+		WaitingIntersections.RemoveAtSwap(WaitingIndex, 1, /*bAllowShrinking*/false);
+		if (!EntityManager.IsEntityValid(WokenIntersection.Entity))
+		{
+			continue;
+		}
+
+		const FMassEntityView IntersectionEntityView(EntityManager, WokenIntersection.Entity);
+		FMassTrafficIntersectionFragment& IntersectionFragment = IntersectionEntityView.GetFragmentData<FMassTrafficIntersectionFragment>();
+		IntersectionFragment.PeriodTimeRemaining = WokenIntersection.PeriodTimeRemaining;
+		Context.Defer().RemoveTag<FMassTrafficIntersectionWaitingForPeriodDeadlineTag>(WokenIntersection.Entity);
 
+		FIntersectionUpdate& IntersectionUpdate = IntersectionUpdates.AddDefaulted_GetRef();
+		IntersectionUpdate.Entity = WokenIntersection.Entity;
+		IntersectionUpdate.IntersectionFragment = &IntersectionFragment;
+		#if WITH_MASSTRAFFIC_DEBUG
+		IntersectionUpdate.TransformFragment = &IntersectionEntityView.GetFragmentData<FTransformFragment>();
+		IntersectionUpdate.RepresentationLODFragment = &IntersectionEntityView.GetFragmentData<FMassRepresentationLODFragment>();
+		#endif
+	}
+	INC_DWORD_STAT_BY(STAT_Traffic_IntersectionsWaitingForPeriodDeadline, WaitingIntersections.Num());
+
+	// Gather all the intersections that aren't waiting for their deadline
+	EntityQuery.ForEachEntityChunk(EntityManager, Context, [this](FMassExecutionContext& QueryContext)
+	{
 		const int32 NumEntities = QueryContext.GetNumEntities();
-		const float DeltaTimeSeconds = QueryContext.GetDeltaTimeSeconds();
 		const TArrayView<FMassTrafficIntersectionFragment> TrafficIntersectionFragments = QueryContext.GetMutableFragmentView<FMassTrafficIntersectionFragment>();
 		#if WITH_MASSTRAFFIC_DEBUG
 		const TConstArrayView<FMassRepresentationLODFragment> RepresentationLODFragments = QueryContext.GetFragmentView<FMassRepresentationLODFragment>();
 		const TConstArrayView<FTransformFragment> TransformFragments = QueryContext.GetFragmentView<FTransformFragment>();
 		#endif
 
-		// Process all the intersections in this chunk -
 		for (int32 Index = 0; Index < NumEntities; ++Index)
 		{
-			FMassTrafficIntersectionFragment& IntersectionFragment = TrafficIntersectionFragments[Index];
+			FIntersectionUpdate& IntersectionUpdate = IntersectionUpdates.AddDefaulted_GetRef();
+			IntersectionUpdate.Entity = QueryContext.GetEntity(Index);
+			IntersectionUpdate.IntersectionFragment = &TrafficIntersectionFragments[Index];
 			#if WITH_MASSTRAFFIC_DEBUG
-			const FTransformFragment& TransformFragment = TransformFragments[Index];
+			IntersectionUpdate.TransformFragment = &TransformFragments[Index];
+			IntersectionUpdate.RepresentationLODFragment = &RepresentationLODFragments[Index];
 			#endif
+		}
+	});
 
-			const FZoneGraphStorage* ZoneGraphStorage = ZoneGraphSubsystem.GetZoneGraphStorage(IntersectionFragment.ZoneGraphDataHandle);
-			
-			if (GMassTrafficDebugIntersections)
+	// Woken intersections come from a different archetype, so when scheduling, update in entity order to keep the order
+	// independent of which intersections were waiting. Otherwise keep the query's order.
+	if (bScheduleIntersections)
+	{
+		IntersectionUpdates.Sort([](const FIntersectionUpdate& A, const FIntersectionUpdate& B)
+		{
+			return A.Entity.Index < B.Entity.Index;
+		});
+	}
+
+	// Batch the crowd lane state queries for all the intersections being updated. Only an intersection itself opens or
+	// closes its crosswalk lanes, so these don't change while other intersections are updated.
+	for (FIntersectionUpdate& IntersectionUpdate : IntersectionUpdates)
+	{
+		FMassTrafficIntersectionFragment& IntersectionFragment = *IntersectionUpdate.IntersectionFragment;
+		if (IntersectionFragment.Periods.IsEmpty())
+		{
+			continue;
+		}
+
+		// See if any of this period's pedestrian lanes are actually open. (Just need to check waiting lanes.)
+		for (const int32 CrosswalkLaneIndex : IntersectionFragment.GetCurrentPeriod().CrosswalkLanes)
+		{
+			const FZoneGraphLaneHandle LaneHandle(CrosswalkLaneIndex, IntersectionFragment.ZoneGraphDataHandle);
+			if (MassCrowdSubsystem.GetLaneState(LaneHandle) == ECrowdLaneState::Opened)
 			{
+				IntersectionUpdate.bPeriodHasAnyOpenCrosswalkLanes = true;
+				break;
+			}
+		}
+	}
+
+	// Process all the intersections -
+	for (const FIntersectionUpdate& IntersectionUpdate : IntersectionUpdates)
+	{
+		FMassTrafficIntersectionFragment& IntersectionFragment = *IntersectionUpdate.IntersectionFragment;
+		#if WITH_MASSTRAFFIC_DEBUG
+		const FTransformFragment& TransformFragment = *IntersectionUpdate.TransformFragment;
+		#endif
+
+		INC_DWORD_STAT(STAT_Traffic_IntersectionsUpdated);
+
+		const FZoneGraphStorage* ZoneGraphStorage = ZoneGraphSubsystem.GetZoneGraphStorage(IntersectionFragment.ZoneGraphDataHandle);
+		
+		if (GMassTrafficDebugIntersections)
+		{
 #if WITH_MASSTRAFFIC_DEBUG
-				const bool bIsStoppedVehicleBlockingCrosswalk = IsStoppedVehicleBlockingCrosswalk(IntersectionFragment, false);
-				
-				constexpr float Lifetime = 0.0f;
-				const FVector Z(0.0f, 0.0f, 100.0f);
-				const FString Str = FString::Printf(TEXT("%d - P:%d/%d - TL?%d - Vw:%d Pw:%d - V:%d Vx:%d - Pclr?%d - Cblock?%d - PTR:%.1f"),
-					IntersectionFragment.ZoneIndex,
-					IntersectionFragment.CurrentPeriodIndex, IntersectionFragment.Periods.Num(),
-					IntersectionFragment.bHasTrafficLights,
-					NumVehiclesWaitingForIntersection(IntersectionFragment),
-					NumPedestriansWaitingForIntersection(IntersectionFragment, *ZoneGraphStorage, &MassCrowdSubsystem),
-					NumVehiclesInIntersection(IntersectionFragment, EMassTrafficIntersectionVehicleLaneType::VehicleLane),
-					NumVehiclesInIntersection(IntersectionFragment, EMassTrafficIntersectionVehicleLaneType::VehicleLane_ClosedInNextPeriod),
-					ArePedestriansClearOfIntersection(IntersectionFragment, *ZoneGraphStorage, &MassCrowdSubsystem),
-					bIsStoppedVehicleBlockingCrosswalk, // (See all CROSSWALKOVERLAP.)
-					IntersectionFragment.PeriodTimeRemaining.GetFloat());
-
-				DebugDrawOccupiedVehicleLanes(World, *ZoneGraphStorage, IntersectionFragment, EMassTrafficIntersectionVehicleLaneType::VehicleLane);
-				
-				UE::MassTraffic::DrawDebugStringNearPlayerLocation(World, TransformFragment.GetTransform().GetLocation() + Z
-						, Str, nullptr, FColor::White, Lifetime, true, 1.0f);
-				
-				if (bIsStoppedVehicleBlockingCrosswalk)
-				{
-					UE::MassTraffic::DrawDebugZLine(World, TransformFragment.GetTransform().GetLocation(), FColor::Purple, false, 0.0f, 50.0f, 200000.0f);
-				}
-#endif // WITH_MASSTRAFFIC_DEBUG
+			const bool bIsStoppedVehicleBlockingCrosswalk = IsStoppedVehicleBlockingCrosswalk(IntersectionFragment, false);
+			
+			constexpr float Lifetime = 0.0f;
+			const FVector Z(0.0f, 0.0f, 100.0f);
+			const FString Str = FString::Printf(TEXT("%d - P:%d/%d - TL?%d - Vw:%d Pw:%d - V:%d Vx:%d - Pclr?%d - Cblock?%d - PTR:%.1f"),
+				IntersectionFragment.ZoneIndex,
+				IntersectionFragment.CurrentPeriodIndex, IntersectionFragment.Periods.Num(),
+				IntersectionFragment.bHasTrafficLights,
+				NumVehiclesWaitingForIntersection(IntersectionFragment),
+				NumPedestriansWaitingForIntersection(IntersectionFragment, *ZoneGraphStorage, &MassCrowdSubsystem),
+				NumVehiclesInIntersection(IntersectionFragment, EMassTrafficIntersectionVehicleLaneType::VehicleLane),
+				NumVehiclesInIntersection(IntersectionFragment, EMassTrafficIntersectionVehicleLaneType::VehicleLane_ClosedInNextPeriod),
+				ArePedestriansClearOfIntersection(IntersectionFragment, *ZoneGraphStorage, &MassCrowdSubsystem),
+				bIsStoppedVehicleBlockingCrosswalk, // (See all CROSSWALKOVERLAP.)
+				IntersectionFragment.PeriodTimeRemaining.GetFloat());
+
+			DebugDrawOccupiedVehicleLanes(World, *ZoneGraphStorage, IntersectionFragment, EMassTrafficIntersectionVehicleLaneType::VehicleLane);
+			
+			UE::MassTraffic::DrawDebugStringNearPlayerLocation(World, TransformFragment.GetTransform().GetLocation() + Z
+					, Str, nullptr, FColor::White, Lifetime, true, 1.0f);
+			
+			if (bIsStoppedVehicleBlockingCrosswalk)
+			{
+				UE::MassTraffic::DrawDebugZLine(World, TransformFragment.GetTransform().GetLocation(), FColor::Purple, false, 0.0f, 50.0f, 200000.0f);
 			}
+#endif // WITH_MASSTRAFFIC_DEBUG
+		}
 
-			// Skip empty intersections.
-			if (IntersectionFragment.Periods.IsEmpty())
+		// Skip empty intersections.
+		if (IntersectionFragment.Periods.IsEmpty())
+		{
+			continue;
+		}
+
+		#if WITH_MASSTRAFFIC_DEBUG
+			// Limit debug drawing to the High LOD of the intersections.
+			const FMassRepresentationLODFragment& RepresentationLODFragment = *IntersectionUpdate.RepresentationLODFragment;
+			const bool bDoDrawDebug = GMassTrafficDebugIntersections && (RepresentationLODFragment.LOD <= EMassLOD::High);
+			if (bDoDrawDebug)
 			{
-				continue;
+				DrawDebugNumberOfPedestrians(GetWorld(), IntersectionFragment, *ZoneGraphStorage, &MassCrowdSubsystem, TransformFragment.GetTransform().GetLocation());
 			}
+		#endif
 
-			#if WITH_MASSTRAFFIC_DEBUG
-				// Limit debug drawing to the High LOD of the intersections.
-				const FMassRepresentationLODFragment& RepresentationLODFragment = RepresentationLODFragments[Index];
-				const bool bDoDrawDebug = GMassTrafficDebugIntersections && (RepresentationLODFragment.LOD <= EMassLOD::High);
-				if (bDoDrawDebug)
-				{
-					DrawDebugNumberOfPedestrians(GetWorld(), IntersectionFragment, *ZoneGraphStorage, &MassCrowdSubsystem, TransformFragment.GetTransform().GetLocation());
-				}
-			#endif
+		const float PeriodTimeRemaining_BeforeUpdate = IntersectionFragment.PeriodTimeRemaining;
 
-			const float PeriodTimeRemaining_BeforeUpdate = IntersectionFragment.PeriodTimeRemaining;
+		FMassTrafficPeriod& CurrentPeriod = IntersectionFragment.GetCurrentPeriod();
 
-			FMassTrafficPeriod& CurrentPeriod = IntersectionFragment.GetCurrentPeriod();
+		bool bIsWaitingForPeriodDeadline = false;
 
-			// See if any of this period's vehicle lanes are actually open.
-			bool bPeriodHasAnyOpenVehicleLanes = false;
+		// See if any of this period's vehicle lanes are actually open.
+		bool bPeriodHasAnyOpenVehicleLanes = false;
+		{
+			for (int32 VehicleLaneLaneIndex = 0;
+				VehicleLaneLaneIndex < CurrentPeriod.NumVehicleLanes(EMassTrafficIntersectionVehicleLaneType::VehicleLane);
+				VehicleLaneLaneIndex++)
 			{
-				for (int32 VehicleLaneLaneIndex = 0;
-					VehicleLaneLaneIndex < CurrentPeriod.NumVehicleLanes(EMassTrafficIntersectionVehicleLaneType::VehicleLane);
-					VehicleLaneLaneIndex++)
+				const FZoneGraphTrafficLaneData* VehicleLane = CurrentPeriod.GetVehicleLane(VehicleLaneLaneIndex, EMassTrafficIntersectionVehicleLaneType::VehicleLane);
+				if (VehicleLane->bIsOpen)
 				{
-					const FZoneGraphTrafficLaneData* VehicleLane = CurrentPeriod.GetVehicleLane(VehicleLaneLaneIndex, EMassTrafficIntersectionVehicleLaneType::VehicleLane);
-					if (VehicleLane->bIsOpen)
-					{
-						bPeriodHasAnyOpenVehicleLanes = true;
-						break;
-					}
+					bPeriodHasAnyOpenVehicleLanes = true;
+					break;
 				}
 			}
+		}
 
-			// See if any of this period's pedestrian lanes are actually open. (Just need to check waiting lanes.)
-			bool bPeriodHasAnyOpenCrosswalkLanes = false;
-			{
-				for (const int32 CrosswalkLaneIndex : CurrentPeriod.CrosswalkLanes)
-				{
-					const FZoneGraphLaneHandle LaneHandle(CrosswalkLaneIndex, IntersectionFragment.ZoneGraphDataHandle);
-					if (MassCrowdSubsystem.GetLaneState(LaneHandle) == ECrowdLaneState::Opened)
-					{
-						bPeriodHasAnyOpenCrosswalkLanes = true;
-						break;
-					}
-				}
-			}
+		// (Gathered above, with all the other intersections' crowd lane states.)
+		const bool bPeriodHasAnyOpenCrosswalkLanes = IntersectionUpdate.bPeriodHasAnyOpenCrosswalkLanes;
+
+		
+		// Count down time remaining for this period.
+		
+		if (IntersectionFragment.PeriodTimeRemaining > 0.0f)
+		{
+			const float CountDownSpeedSeconds = DeltaTimeSeconds;
 
 			
-			// Count down time remaining for this period.
-			
-			if (IntersectionFragment.PeriodTimeRemaining > 0.0f)
+			// Check if we can zoom by this period, or if we need to wait.
+			if ((IsCurrentPeriodPedestrianOnly(IntersectionFragment) && !bPeriodHasAnyOpenCrosswalkLanes) ||
+				(!IsCurrentPeriodPedestrianOnly(IntersectionFragment) && !bPeriodHasAnyOpenCrosswalkLanes && !bPeriodHasAnyOpenVehicleLanes))
+			{
+				IntersectionFragment.PeriodTimeRemaining = -DeltaTimeSeconds;
+			}
+			else if (IntersectionFragment.bHasTrafficLights)
 			{
-				const float CountDownSpeedSeconds = DeltaTimeSeconds;
 
-				
-				// Check if we can zoom by this period, or if we need to wait.
-				if ((IsCurrentPeriodPedestrianOnly(IntersectionFragment) && !bPeriodHasAnyOpenCrosswalkLanes) ||
-					(!IsCurrentPeriodPedestrianOnly(IntersectionFragment) && !bPeriodHasAnyOpenCrosswalkLanes && !bPeriodHasAnyOpenVehicleLanes))
+				// This intersection has traffic lights.
+
+				// End this traffic light vehicle and/or pedestrian period if..
+				// (Cheapest tests first, so we only query the crowd subsystem when the period could actually end.)
+				if (// ..we're not showing a yellow light..
+					IntersectionFragment.PeriodTimeRemaining > MassTrafficSettings->StandardTrafficPrepareToStopSeconds &&
+					// ..AND intersection has no open pedestrian lanes..
+					!bPeriodHasAnyOpenCrosswalkLanes &&
+					// ..AND intersection has no cars waiting to enter the it..
+					!AreVehiclesWaitingForIntersection(IntersectionFragment) &&
+					// ..AND cars are no longer entering the intersection from this period..
+					IsIntersectionClear(IntersectionFragment, EMassTrafficIntersectionVehicleLaneType::VehicleLane, *ZoneGraphStorage, &MassCrowdSubsystem))
 				{
-					IntersectionFragment.PeriodTimeRemaining = -DeltaTimeSeconds;
+					// Go to yellow light.
+					IntersectionFragment.PeriodTimeRemaining = MassTrafficSettings->StandardTrafficPrepareToStopSeconds - DeltaTimeSeconds;
 				}
-				else if (IntersectionFragment.bHasTrafficLights)
+				// INTERSECTIONDEADLINE - While this period's crosswalk lanes are open, the period can't be zoomed by or
+				// ended early, and only this intersection opens or closes its lanes. So if we're not yet showing a
+				// yellow light, nothing but the timer changes until it's time to prepare to stop. (Lights computed
+				// below stay the same until then too.)
+				else if (bScheduleIntersections && bPeriodHasAnyOpenCrosswalkLanes &&
+					PeriodTimeRemaining_BeforeUpdate > MassTrafficSettings->StandardTrafficPrepareToStopSeconds)
 				{
-
-					// This intersection has traffic lights.
-
-					// End this traffic light vehicle and/or pedestrian period if..
-					if (// ..cars are no longer entering the intersection from this period..
-						IsIntersectionClear(IntersectionFragment, EMassTrafficIntersectionVehicleLaneType::VehicleLane, *ZoneGraphStorage, &MassCrowdSubsystem) &&
-						// ..AND intersection has no cars waiting to enter the it..
-						!AreVehiclesWaitingForIntersection(IntersectionFragment) &&
-						// ..AND intersection has no open pedestrian lanes..
-						!bPeriodHasAnyOpenCrosswalkLanes &&
-						// ..AND we're not showing a yellow light..
-						IntersectionFragment.PeriodTimeRemaining > MassTrafficSettings->StandardTrafficPrepareToStopSeconds)
-					{
-						// Go to yellow light.
-						IntersectionFragment.PeriodTimeRemaining = MassTrafficSettings->StandardTrafficPrepareToStopSeconds - DeltaTimeSeconds;
-					}
+					bIsWaitingForPeriodDeadline = true;
 				}
-				else // ..no traffic lights, means stop-sign intersection
+			}
+			else // ..no traffic lights, means stop-sign intersection
+			{
+				
+				// This intersection does not have traffic lights. It functions as a stop-sign intersection.
+				
+				// A vehicle has entered the intersection. Close the lane it's on, and all the lanes from the
+				// same intersection side (using it's splitting lanes.)
+				for (FZoneGraphTrafficLaneData* TrafficLaneData : CurrentPeriod.VehicleLanes)
 				{
-					
-					// This intersection does not have traffic lights. It functions as a stop-sign intersection.
-					
-					// A vehicle has entered the intersection. Close the lane it's on, and all the lanes from the
-					// same intersection side (using it's splitting lanes.)
-					for (FZoneGraphTrafficLaneData* TrafficLaneData : CurrentPeriod.VehicleLanes)
+					if (TrafficLaneData->NumVehiclesOnLane)
 					{
-						if (TrafficLaneData->NumVehiclesOnLane)
-						{
-							CloseLaneAndAllItsSplitLanes(*TrafficLaneData);
-						}
+						CloseLaneAndAllItsSplitLanes(*TrafficLaneData);
 					}
+				}
 
-					bool bAreVehicleLanesInThisPeriodOpenAndReady = false;
-					for (const FZoneGraphTrafficLaneData* IntersectionTrafficLaneData : CurrentPeriod.VehicleLanes)
-					{
-						if (IntersectionTrafficLaneData->bIsOpen && IntersectionTrafficLaneData->bIsVehicleReadyToUseLane) // (See all READYLANE.)
-						{
-							bAreVehicleLanesInThisPeriodOpenAndReady = true;
-							break;
-						}
-					}
-					
-					if (!bAreVehicleLanesInThisPeriodOpenAndReady && !bPeriodHasAnyOpenCrosswalkLanes)
+				bool bAreVehicleLanesInThisPeriodOpenAndReady = false;
+				for (const FZoneGraphTrafficLaneData* IntersectionTrafficLaneData : CurrentPeriod.VehicleLanes)
+				{
+					if (IntersectionTrafficLaneData->bIsOpen && IntersectionTrafficLaneData->bIsVehicleReadyToUseLane) // (See all READYLANE.)
 					{
-						IntersectionFragment.PeriodTimeRemaining = -DeltaTimeSeconds;
+						bAreVehicleLanesInThisPeriodOpenAndReady = true;
+						break;
 					}
 				}
+				
+				if (!bAreVehicleLanesInThisPeriodOpenAndReady && !bPeriodHasAnyOpenCrosswalkLanes)
+				{
+					IntersectionFragment.PeriodTimeRemaining = -DeltaTimeSeconds;
+				}
+			}
 
 
-				// Update traffic lights.
-				// (Do this before we count down period time remaining, so lights don't flash red if yellow light is done.)
-				IntersectionFragment.UpdateTrafficLightsForCurrentPeriod();
+			// Update traffic lights.
+			// (Do this before we count down period time remaining, so lights don't flash red if yellow light is done.)
+			IntersectionFragment.UpdateTrafficLightsForCurrentPeriod();
 
-				
-				IntersectionFragment.PeriodTimeRemaining = IntersectionFragment.PeriodTimeRemaining - CountDownSpeedSeconds;
-			}
 			
+			IntersectionFragment.PeriodTimeRemaining = IntersectionFragment.PeriodTimeRemaining - CountDownSpeedSeconds;
 
-			
-			// Lambda, so it has access to everything here.
-			auto DrawDebugPeriod = [&]()
+			// INTERSECTIONDEADLINE - Skip this intersection until it's time to prepare to stop.
+			const float TimeUntilDeadline = IntersectionFragment.PeriodTimeRemaining - MassTrafficSettings->StandardTrafficPrepareToStopSeconds;
+			if (bIsWaitingForPeriodDeadline && TimeUntilDeadline > 0.0f)
 			{
-				#if WITH_MASSTRAFFIC_DEBUG
-				if (bDoDrawDebug) 
-				{
-					DebugDrawAllOpenLaneArrowsAndTrafficLights(World, *ZoneGraphStorage, &MassCrowdSubsystem, IntersectionFragment, TransformFragment, EMassTrafficPeriodLanesAction::Open);
-				}
-				#endif
-			};
-
-			
+				WaitingIntersections.Add({ IntersectionUpdate.Entity, IntersectionFragment.PeriodTimeRemaining });
+				Context.Defer().AddTag<FMassTrafficIntersectionWaitingForPeriodDeadlineTag>(IntersectionUpdate.Entity);
+				continue; // ..next intersection
+			}
+		}
+		
 
-			// Tell all the lanes in this period they will close soon.
-			if (IntersectionFragment.PeriodTimeRemaining <= MassTrafficSettings->StandardTrafficPrepareToStopSeconds &&
-				IntersectionFragment.PeriodTimeRemaining > 0.0f/*optimization*/)
+		
+		// Lambda, so it has access to everything here.
+		auto DrawDebugPeriod = [&]()
+		{
+			#if WITH_MASSTRAFFIC_DEBUG
+			if (bDoDrawDebug) 
 			{
+				DebugDrawAllOpenLaneArrowsAndTrafficLights(World, *ZoneGraphStorage, &MassCrowdSubsystem, IntersectionFragment, TransformFragment, EMassTrafficPeriodLanesAction::Open);
+			}
+			#endif
+		};
 
-				IntersectionFragment.ApplyLanesActionToCurrentPeriod(
-					EMassTrafficPeriodLanesAction::SoftPrepareToClose, EMassTrafficPeriodLanesAction::None,
-					&MassCrowdSubsystem, false);
+		
 
-				
-				IntersectionFragment.UpdateTrafficLightsForCurrentPeriod();
+		// Tell all the lanes in this period they will close soon.
+		if (IntersectionFragment.PeriodTimeRemaining <= MassTrafficSettings->StandardTrafficPrepareToStopSeconds &&
+			IntersectionFragment.PeriodTimeRemaining > 0.0f/*optimization*/)
+		{
 
-				
-				// Tell lanes how long they have until they close.
-				for (int32 I = 0; I < CurrentPeriod.NumVehicleLanes(EMassTrafficIntersectionVehicleLaneType::VehicleLane_ClosedInNextPeriod); I++)
-				{
-					FZoneGraphTrafficLaneData* OpenVehicleLane = CurrentPeriod.GetVehicleLane(I, EMassTrafficIntersectionVehicleLaneType::VehicleLane_ClosedInNextPeriod);
+			IntersectionFragment.ApplyLanesActionToCurrentPeriod(
+				EMassTrafficPeriodLanesAction::SoftPrepareToClose, EMassTrafficPeriodLanesAction::None,
+				&MassCrowdSubsystem, false);
 
-					OpenVehicleLane->FractionUntilClosed =
-						MassTrafficSettings->StandardTrafficPrepareToStopSeconds > 0.0f ?
-						IntersectionFragment.PeriodTimeRemaining / MassTrafficSettings->StandardTrafficPrepareToStopSeconds :
-						0.0f;
-				}
-			}
+			
+			IntersectionFragment.UpdateTrafficLightsForCurrentPeriod();
 
 			
-			if (IntersectionFragment.PeriodTimeRemaining <= 0.0f && PeriodTimeRemaining_BeforeUpdate > 0.0f)
+			// Tell lanes how long they have until they close.
+			for (int32 I = 0; I < CurrentPeriod.NumVehicleLanes(EMassTrafficIntersectionVehicleLaneType::VehicleLane_ClosedInNextPeriod); I++)
 			{
+				FZoneGraphTrafficLaneData* OpenVehicleLane = CurrentPeriod.GetVehicleLane(I, EMassTrafficIntersectionVehicleLaneType::VehicleLane_ClosedInNextPeriod);
 
-				// Close all lanes that close in next period.
-				IntersectionFragment.ApplyLanesActionToCurrentPeriod(
-					EMassTrafficPeriodLanesAction::SoftClose, EMassTrafficPeriodLanesAction::HardClose,
-					&MassCrowdSubsystem, false);
-				
+				OpenVehicleLane->FractionUntilClosed =
+					MassTrafficSettings->StandardTrafficPrepareToStopSeconds > 0.0f ?
+					IntersectionFragment.PeriodTimeRemaining / MassTrafficSettings->StandardTrafficPrepareToStopSeconds :
+					0.0f;
+			}
+		}
 
-				IntersectionFragment.UpdateTrafficLightsForCurrentPeriod();
-				IntersectionFragment.PedestrianLightsShowStop();
+		
+		if (IntersectionFragment.PeriodTimeRemaining <= 0.0f && PeriodTimeRemaining_BeforeUpdate > 0.0f)
+		{
 
-				
-				// IMPORTANT - We have just closed lanes. Some vehicles may be overlapping the crosswalks, and will
-				// want to keep going, and will register their occupancy on one of the intersection lanes. We need to
-				// not advance to the next period quite yet, to give them a chance to do this.
-				DrawDebugPeriod();
-				continue; // ..next intersection
-			}
+			// Close all lanes that close in next period.
+			IntersectionFragment.ApplyLanesActionToCurrentPeriod(
+				EMassTrafficPeriodLanesAction::SoftClose, EMassTrafficPeriodLanesAction::HardClose,
+				&MassCrowdSubsystem, false);
+			
+
+			IntersectionFragment.UpdateTrafficLightsForCurrentPeriod();
+			IntersectionFragment.PedestrianLightsShowStop();
 
 			
-			if (IntersectionFragment.PeriodTimeRemaining <= 0.0f && PeriodTimeRemaining_BeforeUpdate <= 0.0f)
-			{
+			// IMPORTANT - We have just closed lanes. Some vehicles may be overlapping the crosswalks, and will
+			// want to keep going, and will register their occupancy on one of the intersection lanes. We need to
+			// not advance to the next period quite yet, to give them a chance to do this.
+			DrawDebugPeriod();
+			continue; // ..next intersection
+		}
+
+		
+		if (IntersectionFragment.PeriodTimeRemaining <= 0.0f && PeriodTimeRemaining_BeforeUpdate <= 0.0f)
+		{
 
-				// Should we open another period yet? Or wait for this one to clear?
+			// Should we open another period yet? Or wait for this one to clear?
 
 #if DEBUG_INTERSECTION_STALLS
-				// See all INTERSTALL.
-				// 1min at 30fps..
-				const int32 StallCounterAlert = 1800;
+			// See all INTERSTALL.
+			// 1min at 30fps..
+			const int32 StallCounterAlert = 1800;
 #endif
-				
-				if (!IsIntersectionClear(IntersectionFragment, EMassTrafficIntersectionVehicleLaneType::VehicleLane_ClosedInNextPeriod, *ZoneGraphStorage, &MassCrowdSubsystem))
-				{
-#if DEBUG_INTERSECTION_STALLS
-					// See all INTERSTALL.
-					++IntersectionFragment.StallCounter;
-					if (IntersectionFragment.StallCounter == StallCounterAlert)
-					{
-						UE_LOG(LogTemp, Warning, TEXT("INTERSECTION STALL %d"), IntersectionFragment.ZoneIndex);										
-						const FString Str = FString::Printf(TEXT("STALL %d - LOD:%d - TL?%d"),
-							IntersectionFragment.ZoneIndex,
-							static_cast<int32>(RepresentationLODFragment.LOD),
-							IntersectionFragment.bHasTrafficLights);
-						UE::MassTraffic::LogBugItGo(TransformFragment.GetTransform().GetLocation(), Str);
-					}
-					if (IntersectionFragment.StallCounter >= StallCounterAlert)
-					{
-						UE::MassTraffic::DrawDebugZLine(World, TransformFragment.GetTransform().GetLocation(), FColor::Orange, false, 0.0f, 50.0f, 20000.0f);
-					}
-#endif
-
-					DrawDebugPeriod();
-					continue; // ..next intersection entity
-				}
-
+			
+			if (!IsIntersectionClear(IntersectionFragment, EMassTrafficIntersectionVehicleLaneType::VehicleLane_ClosedInNextPeriod, *ZoneGraphStorage, &MassCrowdSubsystem))
+			{
 #if DEBUG_INTERSECTION_STALLS
 				// See all INTERSTALL.
+				++IntersectionFragment.StallCounter;
+				if (IntersectionFragment.StallCounter == StallCounterAlert)
+				{
+					UE_LOG(LogTemp, Warning, TEXT("INTERSECTION STALL %d"), IntersectionFragment.ZoneIndex);										
+					const FString Str = FString::Printf(TEXT("STALL %d - LOD:%d - TL?%d"),
+						IntersectionFragment.ZoneIndex,
+						static_cast<int32>(RepresentationLODFragment.LOD),
+						IntersectionFragment.bHasTrafficLights);
+					UE::MassTraffic::LogBugItGo(TransformFragment.GetTransform().GetLocation(), Str);
+				}
 				if (IntersectionFragment.StallCounter >= StallCounterAlert)
 				{
-					UE_LOG(LogTemp, Warning, TEXT("INTERSECTION UNSTALL %d"), IntersectionFragment.ZoneIndex);										
+					UE::MassTraffic::DrawDebugZLine(World, TransformFragment.GetTransform().GetLocation(), FColor::Orange, false, 0.0f, 50.0f, 20000.0f);
 				}
-				IntersectionFragment.StallCounter = 0;
 #endif
-				
-		
-				// Move on to the next period.
-				IntersectionFragment.AdvancePeriod();
 
+				DrawDebugPeriod();
+				continue; // ..next intersection entity
+			}
 
-				// Open the next period.
-				// We only open the vehicle lanes if at least one vehicle has stated it's 'ready' to use one of them
-				// We only open the crosswalk lanes if there are actually enough pedestrians waiting.
-				// We do this, because we don't want them to start walking if the next period ends up getting ended early.
-				// It takes them a while to get off the curb onto the crosswalk, and the intersection won't sense this in time.
-				{
-					const EMassTrafficPeriodLanesAction VehicleLanesAction =
-						AreVehiclesWaitingForIntersection(IntersectionFragment) ?
-						EMassTrafficPeriodLanesAction::Open :
-						EMassTrafficPeriodLanesAction::SoftClose; 
+#if DEBUG_INTERSECTION_STALLS
+			// See all INTERSTALL.
+			if (IntersectionFragment.StallCounter >= StallCounterAlert)
+			{
+				UE_LOG(LogTemp, Warning, TEXT("INTERSECTION UNSTALL %d"), IntersectionFragment.ZoneIndex);										
+			}
+			IntersectionFragment.StallCounter = 0;
+#endif
+			
 	
-					
-					const int32 MinPedestrians =
-						IntersectionFragment.bHasTrafficLights ?
-						MassTrafficSettings->MinPedestriansForCrossingAtTrafficLights :
-						MassTrafficSettings->MinPedestriansForCrossingAtStopSigns;
-
-					// Stop-sign intersections get too blocked up too slowly if we let pedestrians cross too often.
-					// But made option for traffic-light intersections too.
-					const bool bCanOpenPedestrianLanesByProbability =
-						IntersectionFragment.bHasTrafficLights ?
-						RandomStream.FRand() <= MassTrafficSettings->TrafficLightPedestrianLaneOpenProbability :
-						RandomStream.FRand() <= MassTrafficSettings->StopSignPedestrianLaneOpenProbability;
-					
-					const EMassTrafficPeriodLanesAction PedestrianLanesAction =
-							bCanOpenPedestrianLanesByProbability &&
-							NumPedestriansWaitingForIntersection(IntersectionFragment, *ZoneGraphStorage, &MassCrowdSubsystem) >= MinPedestrians &&
-							// WARNING - If there are no pedestrians in the level, this will never end up being executed, so the value will never be cleared -
-							!IsStoppedVehicleBlockingCrosswalk(IntersectionFragment, true) /*(See all CROSSWALKOVERLAP.)*/ ?
-						EMassTrafficPeriodLanesAction::Open :
-						EMassTrafficPeriodLanesAction::HardClose;
+			// Move on to the next period.
+			IntersectionFragment.AdvancePeriod();
 
-					
-					IntersectionFragment.ApplyLanesActionToCurrentPeriod(
-						VehicleLanesAction, PedestrianLanesAction,
-						&MassCrowdSubsystem, false);
 
+			// Open the next period.
+			// We only open the vehicle lanes if at least one vehicle has stated it's 'ready' to use one of them
+			// We only open the crosswalk lanes if there are actually enough pedestrians waiting.
+			// We do this, because we don't want them to start walking if the next period ends up getting ended early.
+			// It takes them a while to get off the curb onto the crosswalk, and the intersection won't sense this in time.
+			{
+				const EMassTrafficPeriodLanesAction VehicleLanesAction =
+					AreVehiclesWaitingForIntersection(IntersectionFragment) ?
+					EMassTrafficPeriodLanesAction::Open :
+					EMassTrafficPeriodLanesAction::SoftClose; 
+	
+				
+				const int32 MinPedestrians =
+					IntersectionFragment.bHasTrafficLights ?
+					MassTrafficSettings->MinPedestriansForCrossingAtTrafficLights :
+					MassTrafficSettings->MinPedestriansForCrossingAtStopSigns;
+
+				// Stop-sign intersections get too blocked up too slowly if we let pedestrians cross too often.
+				// But made option for traffic-light intersections too.
+				const bool bCanOpenPedestrianLanesByProbability =
+					IntersectionFragment.bHasTrafficLights ?
+					RandomStream.FRand() <= MassTrafficSettings->TrafficLightPedestrianLaneOpenProbability :
+					RandomStream.FRand() <= MassTrafficSettings->StopSignPedestrianLaneOpenProbability;
+				
+				const EMassTrafficPeriodLanesAction PedestrianLanesAction =
+						bCanOpenPedestrianLanesByProbability &&
+						NumPedestriansWaitingForIntersection(IntersectionFragment, *ZoneGraphStorage, &MassCrowdSubsystem) >= MinPedestrians &&
+						// WARNING - If there are no pedestrians in the level, this will never end up being executed, so the value will never be cleared -
+						!IsStoppedVehicleBlockingCrosswalk(IntersectionFragment, true) /*(See all CROSSWALKOVERLAP.)*/ ?
+					EMassTrafficPeriodLanesAction::Open :
+					EMassTrafficPeriodLanesAction::HardClose;
 
-					IntersectionFragment.UpdateTrafficLightsForCurrentPeriod();
+				
+				IntersectionFragment.ApplyLanesActionToCurrentPeriod(
+					VehicleLanesAction, PedestrianLanesAction,
+					&MassCrowdSubsystem, false);
 
-					
-					IntersectionFragment.AddTimeRemainingToCurrentPeriod();
-				}
-			}
 
-			
-			// NOTE - This will run only if we have not skipped to the next intersection. (See the 'continue' above.)
-			DrawDebugPeriod();
+				IntersectionFragment.UpdateTrafficLightsForCurrentPeriod();
+
+				
+				IntersectionFragment.AddTimeRemainingToCurrentPeriod();
+			}
 		}
-	});
+
+		
+		// NOTE - This will run only if we have not skipped to the next intersection. (See the 'continue' above.)
+		DrawDebugPeriod();
+	}
 }
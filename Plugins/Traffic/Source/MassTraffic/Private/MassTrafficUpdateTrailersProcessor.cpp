@@ -1,6 +1,7 @@
 // Copyright Epic Games, Inc. All Rights Reserved.
 
 #include "MassTrafficUpdateTrailersProcessor.h"
+#include "MassTrafficEntityTransitionBatch.h"
 #include "MassTrafficFragments.h"
 
 #include "MassCommonFragments.h"
@@ -30,6 +31,13 @@ void UMassTrafficUpdateTrailersProcessor::ConfigureQueries()
 
 void UMassTrafficUpdateTrailersProcessor::Execute(FMassEntityManager& EntityManager, FMassExecutionContext& Context)
 {
+	// Trailers starting or stopping simulation are all moved between archetypes together, once we're done
+	FMassTrafficEntityTransitionBatch EntityTransitionBatch;
+	static const FMassTrafficEntityTransition StartSimulatingTransition = FMassTrafficEntityTransition()
+		.AddFragments<FMassTrafficVehiclePhysicsFragment>();
+	static const FMassTrafficEntityTransition StopSimulatingTransition = FMassTrafficEntityTransition()
+		.RemoveFragments<FMassTrafficVehiclePhysicsFragment>();
+
 	// Advance agents
 	EntityQuery.ForEachEntityChunk(EntityManager, Context, [&](FMassExecutionContext& ComponentSystemExecutionContext)
 	{
@@ -77,7 +85,8 @@ void UMassTrafficUpdateTrailersProcessor::Execute(FMassEntityManager& EntityMana
 					{
 						if (PhysicsParams.Template)
 						{
-							Context.Defer().PushCommand<FMassCommandAddFragmentInstances>(Context.GetEntity(EntityIndex), PhysicsParams.Template->SimpleVehiclePhysicsFragmentTemplate);
+							const FInstancedStruct SimpleVehiclePhysicsFragment = FInstancedStruct::Make(PhysicsParams.Template->SimpleVehiclePhysicsFragmentTemplate);
+							EntityTransitionBatch.AddTransition(StartSimulatingTransition, Context.GetEntity(EntityIndex), MakeArrayView(&SimpleVehiclePhysicsFragment, 1));
 						}
 					}
 				}
@@ -88,7 +97,7 @@ void UMassTrafficUpdateTrailersProcessor::Execute(FMassEntityManager& EntityMana
 				// Remove simulation fragment 
 				if (!SimpleVehiclePhysicsFragments.IsEmpty())
 				{
-					Context.Defer().RemoveFragment<FMassTrafficVehiclePhysicsFragment>(Context.GetEntity(EntityIndex));
+					EntityTransitionBatch.AddTransition(StopSimulatingTransition, Context.GetEntity(EntityIndex));
 				}
 			}
 
@@ -106,4 +115,6 @@ void UMassTrafficUpdateTrailersProcessor::Execute(FMassEntityManager& EntityMana
 			}
 		}
 	});
+
+	EntityTransitionBatch.Defer(Context.Defer());
 }
@@ -115,6 +115,42 @@ bool PointIsNearSegment(
 }
 
 
+FObstacleExclusionGrid::FObstacleExclusionGrid(TConstArrayView<FVector> InObstacleLocations, const float InExclusionRadius)
+	: ObstacleLocations(InObstacleLocations)
+	// Cells the size of the exclusion radius mean a query only ever touches the 3x3 cells around it
+	, Grid(FMath::Max(FMath::Abs(InExclusionRadius), 100.0f))
+	, ExclusionRadius(FMath::Abs(InExclusionRadius))
+{
+	for (int32 ObstacleIndex = 0; ObstacleIndex < ObstacleLocations.Num(); ++ObstacleIndex)
+	{
+		Grid.Add(ObstacleIndex, FBox::BuildAABB(ObstacleLocations[ObstacleIndex], FVector::ZeroVector));
+	}
+}
+
+bool FObstacleExclusionGrid::IsNearObstacle(const FVector& Location) const
+{
+	if (ObstacleLocations.IsEmpty())
+	{
+		return false;
+	}
+
+	// The grid is 2D, so candidates are then tested in 3D as usual
+	TArray<int32> CandidateObstacleIndices;
+	Grid.Query(FBox::BuildAABB(Location, FVector(ExclusionRadius)), CandidateObstacleIndices);
+
+	const float ExclusionRadiusSquared = FMath::Square(ExclusionRadius);
+	for (const int32 ObstacleIndex : CandidateObstacleIndices)
+	{
+		if (FVector::DistSquared(Location, ObstacleLocations[ObstacleIndex]) < ExclusionRadiusSquared)
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
+
+
 // Lane points.
 
 FVector GetLaneBeginPoint(const uint32 LaneIndex, const FZoneGraphStorage& ZoneGraphStorage, const uint32 CountFromBegin, bool* bIsValid)
@@ -14,6 +14,7 @@
 #include "ZoneGraphSubsystem.h"
 #include "MassGameplayExternalTraits.h"
 #include "VisualLogger/VisualLogger.h"
+#include "Async/ParallelFor.h"
 
 
 using namespace UE::MassTraffic;
@@ -42,6 +43,7 @@ void UMassTrafficValidationProcessor::ConfigureQueries()
 	EntityQuery_Conditional.AddRequirement<FMassRepresentationFragment>(EMassFragmentAccess::ReadOnly);
 	EntityQuery_Conditional.AddChunkRequirement<FMassSimulationVariableTickChunkFragment>(EMassFragmentAccess::ReadOnly);
 	EntityQuery_Conditional.SetChunkFilter(&FMassSimulationVariableTickChunkFragment::ShouldTickChunkThisFrame);
+	EntityQuery_Conditional.AddChunkRequirement<FMassTrafficValidationChunkFragment>(EMassFragmentAccess::ReadWrite);
 
 	EntityQuery_Conditional.AddRequirement<FMassTrafficDebugFragment>(EMassFragmentAccess::ReadWrite, EMassFragmentPresence::Optional);
 	EntityQuery_Conditional.AddSubsystemRequirement<UZoneGraphSubsystem>(EMassFragmentAccess::ReadOnly);
@@ -56,6 +58,12 @@ void UMassTrafficValidationProcessor::Execute(FMassEntityManager& EntityManager,
 	}
 
 	const UMassTrafficSubsystem& MassTrafficSubsystem = Context.GetSubsystemChecked<UMassTrafficSubsystem>(EntityManager.GetWorld());
+	const UZoneGraphSubsystem& ZoneGraphSubsystem = Context.GetSubsystemChecked<UZoneGraphSubsystem>(EntityManager.GetWorld());
+
+	// Validate a rotating 1 in SampleInterval of the lanes each frame, and of each chunk's vehicles each time it ticks
+	const int32 SampleInterval = FMath::Max(GMassTrafficValidationSampleInterval, 1);
+	const int32 SampleOffset = static_cast<int32>(ValidationFrame++ % static_cast<uint32>(SampleInterval));
+	const bool bParallel = GMassTrafficParallelValidation > 0;
 	
 	// Init density debugging?
 	if (GMassTrafficDebugFlowDensity >= 1 && GMassTrafficDebugFlowDensity <= 3)
@@ -90,47 +98,62 @@ void UMassTrafficValidationProcessor::Execute(FMassEntityManager& EntityManager,
 
 	
 	// Lane validation
-	const UZoneGraphSubsystem& ZoneGraphSubsystem = Context.GetSubsystemChecked<UZoneGraphSubsystem>(EntityManager.GetWorld());
-	for (const FMassTrafficZoneGraphData& TrafficZoneData : MassTrafficSubsystem.GetTrafficZoneGraphData())
 	{
-		const FZoneGraphStorage* ZoneGraphStorage = ZoneGraphSubsystem.GetZoneGraphStorage(TrafficZoneData.DataHandle);
-		check(ZoneGraphStorage);
-		
-		for (const FZoneGraphTrafficLaneData& TrafficLaneData : TrafficZoneData.TrafficLaneDataArray)
+		TRACE_CPUPROFILER_EVENT_SCOPE(TEXT("ValidateLanes"));
+
+		for (const FMassTrafficZoneGraphData& TrafficZoneData : MassTrafficSubsystem.GetTrafficZoneGraphData())
 		{
-			// Check tail
-			if (TrafficLaneData.TailVehicle.IsSet())
+			const FZoneGraphStorage* ZoneGraphStorage = ZoneGraphSubsystem.GetZoneGraphStorage(TrafficZoneData.DataHandle);
+			check(ZoneGraphStorage);
+
+			const TArray<FZoneGraphTrafficLaneData>& TrafficLaneDataArray = TrafficZoneData.TrafficLaneDataArray;
+			const int32 NumSampledLanes = (TrafficLaneDataArray.Num() - SampleOffset + SampleInterval - 1) / SampleInterval;
+			ParallelFor(NumSampledLanes, [&](const int32 SampledLaneIndex)
 			{
-				FMassZoneGraphLaneLocationFragment& TailVehicleLaneLocationFragment = EntityManager.GetFragmentDataChecked<FMassZoneGraphLaneLocationFragment>(TrafficLaneData.TailVehicle);
+				const FZoneGraphTrafficLaneData& TrafficLaneData = TrafficLaneDataArray[SampleOffset + SampledLaneIndex * SampleInterval];
 
-				// Is the tail vehicle actually on a different lane?
-				if (!ensure(TailVehicleLaneLocationFragment.LaneHandle == TrafficLaneData.LaneHandle))
+				// Check tail
+				if (TrafficLaneData.TailVehicle.IsSet())
 				{
-					FVector LaneBeginPoint = GetLaneBeginPoint(TrafficLaneData.LaneHandle.Index, *ZoneGraphStorage);
-					FZoneGraphLaneLocation TailVehicleLaneLocation;
-					UE::ZoneGraph::Query::CalculateLocationAlongLane(*ZoneGraphStorage, TailVehicleLaneLocationFragment.LaneHandle, TailVehicleLaneLocationFragment.DistanceAlongLane, TailVehicleLaneLocation);
+					const FMassZoneGraphLaneLocationFragment& TailVehicleLaneLocationFragment = EntityManager.GetFragmentDataChecked<FMassZoneGraphLaneLocationFragment>(TrafficLaneData.TailVehicle);
 
+					// Is the tail vehicle actually on a different lane?
+					if (!ensure(TailVehicleLaneLocationFragment.LaneHandle == TrafficLaneData.LaneHandle))
+					{
+						FVector LaneBeginPoint = GetLaneBeginPoint(TrafficLaneData.LaneHandle.Index, *ZoneGraphStorage);
+						FZoneGraphLaneLocation TailVehicleLaneLocation;
+						UE::ZoneGraph::Query::CalculateLocationAlongLane(*ZoneGraphStorage, TailVehicleLaneLocationFragment.LaneHandle, TailVehicleLaneLocationFragment.DistanceAlongLane, TailVehicleLaneLocation);
+
+						#if ENABLE_VISUAL_LOG
+							FScopeLock VisLogLock(&VisLogCriticalSection);
+							UE_VLOG_LOCATION(LogOwner, TEXT("MassTraffic Validation"), Warning, LaneBeginPoint, 10.0f, FColor::Red, TEXT("%s tail vehicle (%d) is on different lane %d"), *TrafficLaneData.LaneHandle.ToString(), TrafficLaneData.TailVehicle.Index, TailVehicleLaneLocationFragment.LaneHandle.Index);
+							UE_VLOG_SEGMENT_THICK(LogOwner, TEXT("MassTraffic Validation"), Warning, LaneBeginPoint, TailVehicleLaneLocation.Position, FColor::Red, 5.0f, TEXT(""));
+						#endif
+					}
+				}
+
+				// Check space available
+				if (TrafficLaneData.SpaceAvailable < TrafficLaneData.Length - 1.0f && !TrafficLaneData.TailVehicle.IsSet())
+				{
+					FVector LaneMidPoint = GetLaneMidPoint(TrafficLaneData.LaneHandle.Index, *ZoneGraphStorage);
 					#if ENABLE_VISUAL_LOG
-						UE_VLOG_LOCATION(LogOwner, TEXT("MassTraffic Validation"), Warning, LaneBeginPoint, 10.0f, FColor::Red, TEXT("%s tail vehicle (%d) is on different lane %d"), *TrafficLaneData.LaneHandle.ToString(), TrafficLaneData.TailVehicle.Index, TailVehicleLaneLocationFragment.LaneHandle.Index);
-						UE_VLOG_SEGMENT_THICK(LogOwner, TEXT("MassTraffic Validation"), Warning, LaneBeginPoint, TailVehicleLaneLocation.Position, FColor::Red, 5.0f, TEXT(""));
+						FScopeLock VisLogLock(&VisLogCriticalSection);
+						UE_VLOG_LOCATION(LogOwner, TEXT("MassTraffic Validation"), Warning, LaneMidPoint, 10.0f, FColor::Red, TEXT("%s is empty but doesn't have full space available (Available: %0.2f  Length: %0.2f)"), *TrafficLaneData.LaneHandle.ToString(), TrafficLaneData.SpaceAvailable, TrafficLaneData.Length);
 					#endif
 				}
-			}
-			
+			}, bParallel ? EParallelForFlags::None : EParallelForFlags::ForceSingleThread);
+		}
+	}
 
-			// Check space available
-			if (TrafficLaneData.SpaceAvailable < TrafficLaneData.Length - 1.0f && !TrafficLaneData.TailVehicle.IsSet())
-			{
-				FVector LaneMidPoint = GetLaneMidPoint(TrafficLaneData.LaneHandle.Index, *ZoneGraphStorage);
-				#if ENABLE_VISUAL_LOG
-					UE_VLOG_LOCATION(LogOwner, TEXT("MassTraffic Validation"), Warning, LaneMidPoint, 10.0f, FColor::Red, TEXT("%s is empty but doesn't have full space available (Available: %0.2f  Length: %0.2f)"), *TrafficLaneData.LaneHandle.ToString(), TrafficLaneData.SpaceAvailable, TrafficLaneData.Length);
-				#endif
-			}
+	// Traffic flow density, drawn for every lane each frame on the game thread
+	if (GMassTrafficDebugFlowDensity >= 1 && GMassTrafficDebugFlowDensity <= 3)
+	{
+		for (const FMassTrafficZoneGraphData& TrafficZoneData : MassTrafficSubsystem.GetTrafficZoneGraphData())
+		{
+			const FZoneGraphStorage* ZoneGraphStorage = ZoneGraphSubsystem.GetZoneGraphStorage(TrafficZoneData.DataHandle);
+			check(ZoneGraphStorage);
 
-			
-			// Traffic flow density
-			
-			if (GMassTrafficDebugFlowDensity >= 1 && GMassTrafficDebugFlowDensity <= 3)
+			for (const FZoneGraphTrafficLaneData& TrafficLaneData : TrafficZoneData.TrafficLaneDataArray)
 			{
 				if (!TrafficLaneData.ConstData.bIsIntersectionLane)
 				{
@@ -230,150 +253,190 @@ void UMassTrafficValidationProcessor::Execute(FMassEntityManager& EntityManager,
 	}
 
 	// Vehicle validation
-	EntityQuery_Conditional.ForEachEntityChunk(EntityManager, Context, [&, World = EntityManager.GetWorld()](FMassExecutionContext& ComponentSystemExecutionContext)
+	auto ValidateVehiclesChunk = [&](FMassExecutionContext& ChunkContext)
+	{
+		TConstArrayView<FMassTrafficSimulationLODFragment> SimulationLODFragments = ChunkContext.GetFragmentView<FMassTrafficSimulationLODFragment>();
+		TConstArrayView<FMassActorFragment> ActorFragments = ChunkContext.GetFragmentView<FMassActorFragment>();
+		TConstArrayView<FMassTrafficObstacleAvoidanceFragment> AvoidanceFragments = ChunkContext.GetMutableFragmentView<FMassTrafficObstacleAvoidanceFragment>();
+		TConstArrayView<FAgentRadiusFragment> RadiusFragments = ChunkContext.GetFragmentView<FAgentRadiusFragment>();
+		TConstArrayView<FMassTrafficVehicleControlFragment> VehicleControlFragments = ChunkContext.GetFragmentView<FMassTrafficVehicleControlFragment>();
+		TConstArrayView<FMassZoneGraphLaneLocationFragment> LaneLocationFragments = ChunkContext.GetFragmentView<FMassZoneGraphLaneLocationFragment>();
+		TConstArrayView<FMassTrafficLaneOffsetFragment> LaneOffsetFragments = ChunkContext.GetFragmentView<FMassTrafficLaneOffsetFragment>();
+		TConstArrayView<FTransformFragment> TransformFragments = ChunkContext.GetFragmentView<FTransformFragment>();
+		TConstArrayView<FMassTrafficVehicleLaneChangeFragment> LaneChangeFragments = ChunkContext.GetFragmentView<FMassTrafficVehicleLaneChangeFragment>();
+		TConstArrayView<FMassRepresentationFragment> VisualizationFragments = ChunkContext.GetFragmentView<FMassRepresentationFragment>();
+		TConstArrayView<FMassTrafficNextVehicleFragment> NextVehicleFragments = ChunkContext.GetFragmentView<FMassTrafficNextVehicleFragment>();
+		TArrayView<FMassTrafficDebugFragment> DebugFragments = ChunkContext.GetMutableFragmentView<FMassTrafficDebugFragment>();
+
+		// Chunks are filtered by variable tick, so rotate on the chunk's own validations rather than on frames, which
+		// it could keep skipping the same sample of
+		FMassTrafficValidationChunkFragment& ValidationChunkFragment = ChunkContext.GetMutableChunkFragment<FMassTrafficValidationChunkFragment>();
+		const int32 ChunkSampleOffset = static_cast<int32>(ValidationChunkFragment.NumValidations++ % static_cast<uint32>(SampleInterval));
+
+		const int32 NumEntities = ChunkContext.GetNumEntities();
+		for (int32 Index = 0; Index < NumEntities; ++Index)
 		{
-			const UZoneGraphSubsystem& ZoneGraphSubsystem = ComponentSystemExecutionContext.GetSubsystemChecked<UZoneGraphSubsystem>(World);
-
-			TConstArrayView<FMassTrafficSimulationLODFragment> SimulationLODFragments = Context.GetFragmentView<FMassTrafficSimulationLODFragment>();
-			TConstArrayView<FMassActorFragment> ActorFragments = Context.GetFragmentView<FMassActorFragment>();
-			TConstArrayView<FMassTrafficObstacleAvoidanceFragment> AvoidanceFragments = Context.GetMutableFragmentView<FMassTrafficObstacleAvoidanceFragment>();
-			TConstArrayView<FAgentRadiusFragment> RadiusFragments = Context.GetFragmentView<FAgentRadiusFragment>();
-			TConstArrayView<FMassTrafficVehicleControlFragment> VehicleControlFragments = Context.GetFragmentView<FMassTrafficVehicleControlFragment>();
-			TConstArrayView<FMassZoneGraphLaneLocationFragment> LaneLocationFragments = Context.GetFragmentView<FMassZoneGraphLaneLocationFragment>();
-			TConstArrayView<FMassTrafficLaneOffsetFragment> LaneOffsetFragments = Context.GetFragmentView<FMassTrafficLaneOffsetFragment>();
-			TConstArrayView<FTransformFragment> TransformFragments = Context.GetFragmentView<FTransformFragment>();
-			TConstArrayView<FMassTrafficVehicleLaneChangeFragment> LaneChangeFragments = Context.GetFragmentView<FMassTrafficVehicleLaneChangeFragment>();
-			TConstArrayView<FMassRepresentationFragment> VisualizationFragments = Context.GetFragmentView<FMassRepresentationFragment>();
-			TConstArrayView<FMassTrafficNextVehicleFragment> NextVehicleFragments = Context.GetFragmentView<FMassTrafficNextVehicleFragment>();
-			TArrayView<FMassTrafficDebugFragment> DebugFragments = Context.GetMutableFragmentView<FMassTrafficDebugFragment>();
-
-			const int32 NumEntities = Context.GetNumEntities();
-			for (int32 Index = 0; Index < NumEntities; ++Index)
-			{
-				FMassEntityHandle VehicleEntity = Context.GetEntity(Index);
-			
-				const FMassTrafficSimulationLODFragment& SimulationLODFragment = SimulationLODFragments[Index];
-				const FMassActorFragment& ActorFragment = ActorFragments[Index];
-				const FAgentRadiusFragment& RadiusFragment = RadiusFragments[Index];
-				const FMassTrafficObstacleAvoidanceFragment& AvoidanceFragment = AvoidanceFragments[Index];
-				const FMassTrafficVehicleControlFragment& VehicleControlFragment = VehicleControlFragments[Index];
-				const FMassZoneGraphLaneLocationFragment& LaneLocationFragment = LaneLocationFragments[Index];
-				const FMassTrafficLaneOffsetFragment& LaneOffsetFragment = LaneOffsetFragments[Index];
-				const FTransformFragment& TransformFragment = TransformFragments[Index];
-				const FMassTrafficVehicleLaneChangeFragment& LaneChangeFragment = LaneChangeFragments[Index];
-				const FMassRepresentationFragment& RepresentationFragment = VisualizationFragments[Index];
-				const FMassTrafficNextVehicleFragment& NextVehicleFragment = NextVehicleFragments[Index];
-				#if WITH_MASSTRAFFIC_DEBUG
-					FMassTrafficDebugFragment& DebugFragment = DebugFragments[Index];
-				#endif
-
-				// Raw lane location
-				FZoneGraphLaneLocation RawLaneLocation;
-				ZoneGraphSubsystem.CalculateLocationAlongLane(LaneLocationFragment.LaneHandle, LaneLocationFragment.DistanceAlongLane, RawLaneLocation);
-				FTransform LaneLocationTransform(FRotationMatrix::MakeFromX(RawLaneLocation.Direction).ToQuat(), RawLaneLocation.Position);
+			FMassEntityHandle VehicleEntity = ChunkContext.GetEntity(Index);
 
-				// Apply lateral offset
-				LaneLocationTransform.AddToTranslation(LaneLocationTransform.GetRotation().GetRightVector() * LaneOffsetFragment.LateralOffset);
+			// Clear bVisLog for fields to re-enable for matching vehicles next frame
+			#if WITH_MASSTRAFFIC_DEBUG
+				DebugFragments[Index].bVisLog = false;
+			#endif
 
-				// Adjust lane location for lane changing
-				AdjustVehicleTransformDuringLaneChange(LaneChangeFragment, LaneLocationFragment.DistanceAlongLane, LaneLocationTransform);
+			// Only validate this tick's sample of the chunk's vehicles
+			if (Index % SampleInterval != ChunkSampleOffset)
+			{
+				continue;
+			}
 
-				// Actor checks
-				const AActor* Actor = ActorFragment.Get();
-				if (Actor && (RepresentationFragment.CurrentRepresentation == EMassRepresentationType::LowResSpawnedActor || RepresentationFragment.CurrentRepresentation == EMassRepresentationType::HighResSpawnedActor))
+			const FMassTrafficSimulationLODFragment& SimulationLODFragment = SimulationLODFragments[Index];
+			const FMassActorFragment& ActorFragment = ActorFragments[Index];
+			const FAgentRadiusFragment& RadiusFragment = RadiusFragments[Index];
+			const FMassTrafficObstacleAvoidanceFragment& AvoidanceFragment = AvoidanceFragments[Index];
+			const FMassTrafficVehicleControlFragment& VehicleControlFragment = VehicleControlFragments[Index];
+			const FMassZoneGraphLaneLocationFragment& LaneLocationFragment = LaneLocationFragments[Index];
+			const FMassTrafficLaneOffsetFragment& LaneOffsetFragment = LaneOffsetFragments[Index];
+			const FTransformFragment& TransformFragment = TransformFragments[Index];
+			const FMassTrafficVehicleLaneChangeFragment& LaneChangeFragment = LaneChangeFragments[Index];
+			const FMassRepresentationFragment& RepresentationFragment = VisualizationFragments[Index];
+			const FMassTrafficNextVehicleFragment& NextVehicleFragment = NextVehicleFragments[Index];
+
+			// Raw lane location
+			FZoneGraphLaneLocation RawLaneLocation;
+			ZoneGraphSubsystem.CalculateLocationAlongLane(LaneLocationFragment.LaneHandle, LaneLocationFragment.DistanceAlongLane, RawLaneLocation);
+			FTransform LaneLocationTransform(FRotationMatrix::MakeFromX(RawLaneLocation.Direction).ToQuat(), RawLaneLocation.Position);
+
+			// Apply lateral offset
+			LaneLocationTransform.AddToTranslation(LaneLocationTransform.GetRotation().GetRightVector() * LaneOffsetFragment.LateralOffset);
+
+			// Adjust lane location for lane changing
+			AdjustVehicleTransformDuringLaneChange(LaneChangeFragment, LaneLocationFragment.DistanceAlongLane, LaneLocationTransform);
+
+			// Actor checks
+			const AActor* Actor = ActorFragment.Get();
+			if (Actor && (RepresentationFragment.CurrentRepresentation == EMassRepresentationType::LowResSpawnedActor || RepresentationFragment.CurrentRepresentation == EMassRepresentationType::HighResSpawnedActor))
+			{
+				// Is actor far from raw lane location?
+				const float VehicleDeviationDistance = FVector::Distance(LaneLocationTransform.GetLocation(), Actor->GetActorLocation());
+				if (!ensure(VehicleDeviationDistance < VehicleMajorDeviationDistanceThreshold) ||
+					(!LaneChangeFragment.IsLaneChangeInProgress() && !ensure(VehicleDeviationDistance < VehicleDeviationDistanceThreshold)))
 				{
-					// Is actor far from raw lane location?
-					const float VehicleDeviationDistance = FVector::Distance(LaneLocationTransform.GetLocation(), Actor->GetActorLocation());
-					if (!ensure(VehicleDeviationDistance < VehicleMajorDeviationDistanceThreshold) ||
-						(!LaneChangeFragment.IsLaneChangeInProgress() && !ensure(VehicleDeviationDistance < VehicleDeviationDistanceThreshold)))
-					{
+					#if ENABLE_VISUAL_LOG
+						FScopeLock VisLogLock(&VisLogCriticalSection);
 						UE_VLOG_LOCATION(LogOwner, TEXT("MassTraffic Validation"), Warning, LaneLocationTransform.GetLocation(), 10.0f, FColor::Orange, TEXT("%d actor deviated from lane"), VehicleEntity.Index);
 						UE_VLOG_LOCATION(LogOwner, TEXT("MassTraffic Validation"), Warning, TransformFragment.GetTransform().GetLocation(), 10.0f, FColor::Blue, TEXT("%d"), VehicleEntity.Index);
 						UE_VLOG_SEGMENT_THICK(LogOwner, TEXT("MassTraffic Validation"), Warning, LaneLocationTransform.GetLocation(), Actor->GetActorLocation(), FColor::Orange, 5.0f, TEXT(""));
-					}
+					#endif
 				}
-				else
+			}
+			else
+			{
+				// Is transform far from raw lane location? (Indicating a problem with interpolation)
+				const float VehicleDeviationDistance = FVector::Distance(LaneLocationTransform.GetLocation(), TransformFragment.GetTransform().GetLocation());
+				if (!ensure(VehicleDeviationDistance < VehicleMajorDeviationDistanceThreshold) ||
+					(!LaneChangeFragment.IsLaneChangeInProgress() && !ensure(VehicleDeviationDistance < VehicleDeviationDistanceThreshold)))
 				{
-					// Is transform far from raw lane location? (Indicating a problem with interpolation)
-					const float VehicleDeviationDistance = FVector::Distance(LaneLocationTransform.GetLocation(), TransformFragment.GetTransform().GetLocation());
-					if (!ensure(VehicleDeviationDistance < VehicleMajorDeviationDistanceThreshold) ||
-						(!LaneChangeFragment.IsLaneChangeInProgress() && !ensure(VehicleDeviationDistance < VehicleDeviationDistanceThreshold)))
-					{
+					#if ENABLE_VISUAL_LOG
+						FScopeLock VisLogLock(&VisLogCriticalSection);
 						UE_VLOG_LOCATION(LogOwner, TEXT("MassTraffic Validation"), Warning, LaneLocationTransform.GetLocation(), 10.0f, FColor::Orange, TEXT("%d deviated from lane"), VehicleEntity.Index);
 						UE_VLOG_SEGMENT_THICK(LogOwner, TEXT("MassTraffic Validation"), Warning, LaneLocationTransform.GetLocation(), TransformFragment.GetTransform().GetLocation(), FColor::Orange, 5.0f, TEXT(""));
-					}
+					#endif
 				}
-			
-				// Check DistanceAlongLane
-				if (!ensure(FMath::IsWithinInclusive(LaneLocationFragment.DistanceAlongLane, 0.0f, LaneLocationFragment.LaneLength)))
-				{
+			}
+		
+			// Check DistanceAlongLane
+			if (!ensure(FMath::IsWithinInclusive(LaneLocationFragment.DistanceAlongLane, 0.0f, LaneLocationFragment.LaneLength)))
+			{
+				#if ENABLE_VISUAL_LOG
+					FScopeLock VisLogLock(&VisLogCriticalSection);
 					UE_VLOG_LOCATION(LogOwner, TEXT("MassTraffic Validation"), Error, LaneLocationTransform.GetLocation(), 10.0f, FColor::Red, TEXT("%d lane location distance (%f) is outside the lane range (0 to %f)"), VehicleEntity.Index, LaneLocationFragment.DistanceAlongLane, LaneLocationFragment.LaneLength);
-				}
+				#endif
+			}
 
-				// Check speed
-				if (!ensure(VehicleControlFragment.Speed < VehicleMaxSpeed))
-				{
+			// Check speed
+			if (!ensure(VehicleControlFragment.Speed < VehicleMaxSpeed))
+			{
+				#if ENABLE_VISUAL_LOG
+					FScopeLock VisLogLock(&VisLogCriticalSection);
 					UE_VLOG_LOCATION(LogOwner, TEXT("MassTraffic Validation"), Error, TransformFragment.GetTransform().GetLocation(), 10.0f, FColor::Red, TEXT("%d speed (%0.2f) exceeds VehicleMaxSpeed (%0.2f)"), VehicleEntity.Index, VehicleControlFragment.Speed, VehicleMaxSpeed);
-				}
+				#endif
+			}
 
-				// Make sure we don't see Off LOD's for more than 1 frame (the first frame is fine, but if the second
-				// is still off LOD then we wouldn't have simulated forward since this first frame)   
-				if (SimulationLODFragment.LOD >= EMassLOD::Off && SimulationLODFragment.PrevLOD >= EMassLOD::Off)
+			// Make sure we don't see Off LOD's for more than 1 frame (the first frame is fine, but if the second
+			// is still off LOD then we wouldn't have simulated forward since this first frame)   
+			if (SimulationLODFragment.LOD >= EMassLOD::Off && SimulationLODFragment.PrevLOD >= EMassLOD::Off)
+			{
+				if (!ensure(RepresentationFragment.CurrentRepresentation == EMassRepresentationType::None))
 				{
-					if (!ensure(RepresentationFragment.CurrentRepresentation == EMassRepresentationType::None))
-					{
+					#if ENABLE_VISUAL_LOG
+						FScopeLock VisLogLock(&VisLogCriticalSection);
 						UE_VLOG_LOCATION(LogOwner, TEXT("MassTraffic Validation"), Warning, TransformFragment.GetTransform().GetLocation(), 10.0f, FColor::Red, TEXT("%d shouldn't be drawn"), VehicleEntity.Index);
-					}
+					#endif
 				}
+			}
 
-				// Next vehicle checks
-				if (NextVehicleFragment.HasNextVehicle())
+			// Next vehicle checks
+			if (NextVehicleFragment.HasNextVehicle())
+			{
+				// Make sure we're not pointing to ourselves
+				if (!ensure(NextVehicleFragment.GetNextVehicle() != VehicleEntity))
 				{
-					// Make sure we're not pointing to ourselves
-					if (!ensure(NextVehicleFragment.GetNextVehicle() != VehicleEntity))
-					{
+					#if ENABLE_VISUAL_LOG
+						FScopeLock VisLogLock(&VisLogCriticalSection);
 						UE_VLOG_LOCATION(LogOwner, TEXT("MassTraffic Validation"), Error, TransformFragment.GetTransform().GetLocation(), 10.0f, FColor::Red, TEXT("%d's NextVehicle is itself"), VehicleEntity.Index);
-					}
-					else
+					#endif
+				}
+				else
+				{
+					// Make sure we don't go past our next vehicle
+					FMassEntityView NextVehicleEntityView(EntityManager, NextVehicleFragment.GetNextVehicle());
+					const FMassZoneGraphLaneLocationFragment& NextVehicleLaneLocationFragment = NextVehicleEntityView.GetFragmentData<FMassZoneGraphLaneLocationFragment>();
+					const FTransformFragment& NextVehicleTransformFragment = NextVehicleEntityView.GetFragmentData<FTransformFragment>();
+					const FAgentRadiusFragment& NextVehicleRadiusFragment = NextVehicleEntityView.GetFragmentData<FAgentRadiusFragment>();
+					const FMassTrafficVehicleLaneChangeFragment& NextVehicleLaneChangeFragment = NextVehicleEntityView.GetFragmentData<FMassTrafficVehicleLaneChangeFragment>();
+					if (LaneLocationFragment.LaneHandle == NextVehicleLaneLocationFragment.LaneHandle)
 					{
-						// Make sure we don't go past our next vehicle
-						FMassEntityView NextVehicleEntityView(EntityManager, NextVehicleFragment.GetNextVehicle());
-						const FMassZoneGraphLaneLocationFragment& NextVehicleLaneLocationFragment = NextVehicleEntityView.GetFragmentData<FMassZoneGraphLaneLocationFragment>();
-						const FTransformFragment& NextVehicleTransformFragment = NextVehicleEntityView.GetFragmentData<FTransformFragment>();
-						const FAgentRadiusFragment& NextVehicleRadiusFragment = NextVehicleEntityView.GetFragmentData<FAgentRadiusFragment>();
-						const FMassTrafficVehicleLaneChangeFragment& NextVehicleLaneChangeFragment = NextVehicleEntityView.GetFragmentData<FMassTrafficVehicleLaneChangeFragment>();
-						if (LaneLocationFragment.LaneHandle == NextVehicleLaneLocationFragment.LaneHandle)
+						if (!ensure(LaneLocationFragment.DistanceAlongLane <= NextVehicleLaneLocationFragment.DistanceAlongLane) &&
+							// Lane changes my cause false positives. A car has teleported to another lane, and briefly
+							// the other car might be ahead of that position.
+							!LaneChangeFragment.IsLaneChangeInProgress() &&
+							!NextVehicleLaneChangeFragment.IsLaneChangeInProgress())
 						{
-							if (!ensure(LaneLocationFragment.DistanceAlongLane <= NextVehicleLaneLocationFragment.DistanceAlongLane) &&
-								// Lane changes my cause false positives. A car has teleported to another lane, and briefly
-								// the other car might be ahead of that position.
-								!LaneChangeFragment.IsLaneChangeInProgress() &&
-								!NextVehicleLaneChangeFragment.IsLaneChangeInProgress())
-							{
-								// Raw lane location
-								FZoneGraphLaneLocation NextVehicleRawLaneLocation;
-								ZoneGraphSubsystem.CalculateLocationAlongLane(NextVehicleLaneLocationFragment.LaneHandle, NextVehicleLaneLocationFragment.DistanceAlongLane, NextVehicleRawLaneLocation);
-							
+							// Raw lane location
+							FZoneGraphLaneLocation NextVehicleRawLaneLocation;
+							ZoneGraphSubsystem.CalculateLocationAlongLane(NextVehicleLaneLocationFragment.LaneHandle, NextVehicleLaneLocationFragment.DistanceAlongLane, NextVehicleRawLaneLocation);
+						
+							#if ENABLE_VISUAL_LOG
+								FScopeLock VisLogLock(&VisLogCriticalSection);
 								UE_VLOG_LOCATION(LogOwner, TEXT("MassTraffic Validation"), Error, TransformFragment.GetTransform().GetLocation(), RadiusFragment.Radius, FColor::Red, TEXT("%d @ %0.2f is further along the lane than it's next vehicle %d @ %0.2f (Sim LOD %d)"), VehicleEntity.Index, LaneLocationFragment.DistanceAlongLane, NextVehicleFragment.GetNextVehicle().Index, NextVehicleLaneLocationFragment.DistanceAlongLane, SimulationLODFragment.LOD.GetValue());
 								UE_VLOG_SEGMENT(LogOwner, TEXT("MassTraffic Validation"), Error, TransformFragment.GetTransform().GetLocation() + FVector(0,0,100), NextVehicleTransformFragment.GetTransform().GetLocation() + FVector(0,0,100), FColor::Red, TEXT("%0.2f"), AvoidanceFragment.DistanceToNext);
 								UE_VLOG_LOCATION(LogOwner, TEXT("MassTraffic Validation"), Error, NextVehicleTransformFragment.GetTransform().GetLocation(), NextVehicleRadiusFragment.Radius, FColor::White, TEXT(""));
 								UE_VLOG_LOCATION(LogOwner, TEXT("MassTraffic Validation"), Error, RawLaneLocation.Position, 10.0f, FColor::Red, TEXT(""));
 								UE_VLOG_LOCATION(LogOwner, TEXT("MassTraffic Validation"), Error, NextVehicleRawLaneLocation.Position, 10.0f, FColor::White, TEXT(""));
-							}
+							#endif
 						}
 					}
-
-					// Check if a vehicle's next vehicle reference is pointing backwards (and not super far away.)
-					if (GMassTrafficDebugNextOrderValidation && NextVehicleFragment.HasNextVehicle())
-					{
-						CheckNextVehicle(VehicleEntity, NextVehicleFragment.GetNextVehicle(), EntityManager);
-					}
 				}
 
-				// Clear bVisLog for fields to re-enable for matching vehicles next frame 
-				#if WITH_MASSTRAFFIC_DEBUG
-					DebugFragment.bVisLog = false;
-				#endif
+				// Check if a vehicle's next vehicle reference is pointing backwards (and not super far away.)
+				if (GMassTrafficDebugNextOrderValidation && NextVehicleFragment.HasNextVehicle())
+				{
+					CheckNextVehicle(VehicleEntity, NextVehicleFragment.GetNextVehicle(), EntityManager);
+				}
 			}
-		});
+		}
+	};
+
+	{
+		TRACE_CPUPROFILER_EVENT_SCOPE(TEXT("ValidateVehicles"));
+
+		if (bParallel)
+		{
+			EntityQuery_Conditional.ParallelForEachEntityChunk(EntityManager, Context, ValidateVehiclesChunk);
+		}
+		else
+		{
+			EntityQuery_Conditional.ForEachEntityChunk(EntityManager, Context, ValidateVehiclesChunk);
+		}
+	}
 }
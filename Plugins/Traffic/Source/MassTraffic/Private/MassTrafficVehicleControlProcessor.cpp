@@ -18,14 +18,40 @@
 
 namespace
 {
+	// Changes shared lane state straight away without Reservations, otherwise records the change to be applied once all
+	// chunks have been processed. (See FMassTrafficLaneReservations.)
+	void ReserveLaneState(
+		FMassTrafficLaneReservationBuffer* Reservations,
+		const FMassEntityHandle VehicleEntity,
+		const EMassTrafficLaneReservationType Type,
+		FZoneGraphTrafficLaneData* Lane,
+		FMassTrafficVehicleControlFragment* VehicleControlFragment = nullptr)
+	{
+		if (Reservations)
+		{
+			Reservations->Add(VehicleEntity, Type, Lane, VehicleControlFragment);
+		}
+		else
+		{
+			FMassTrafficLaneReservation Reservation;
+			Reservation.Entity = VehicleEntity;
+			Reservation.Type = Type;
+			Reservation.Lane = Lane;
+			Reservation.VehicleControlFragment = VehicleControlFragment;
+			FMassTrafficLaneReservations::Apply(Reservation, /*DownstreamFlowDensityMixtureFraction*/0.0f);
+		}
+	}
+
 	// (See all READYLANE.)
 	void SetIsVehicleReadyToUseNextIntersectionLane(
+		const FMassEntityHandle VehicleEntity,
 		const FMassTrafficVehicleControlFragment& VehicleControlFragment,
 		const FMassZoneGraphLaneLocationFragment& LaneLocationFragment,
 		const FAgentRadiusFragment& RadiusFragment,
 		const FMassTrafficRandomFractionFragment& RandomFractionFragment,
 		const FVector2D& StoppingDistanceRange,
-		const bool bVehicleHasNoRoom)
+		const bool bVehicleHasNoRoom,
+		FMassTrafficLaneReservationBuffer* Reservations)
 	{
 		if (!VehicleControlFragment.NextLane ||
 			!VehicleControlFragment.NextLane->ConstData.bIsIntersectionLane)
@@ -44,21 +70,27 @@ namespace
 			return;
 		}
 
-		VehicleControlFragment.NextLane->bIsVehicleReadyToUseLane = !bVehicleHasNoRoom; // (See all READYLANE.)
+		// (See all READYLANE.)
+		ReserveLaneState(Reservations, VehicleEntity,
+			bVehicleHasNoRoom ? EMassTrafficLaneReservationType::ClearVehicleReadyToUseLane : EMassTrafficLaneReservationType::SetVehicleReadyToUseLane,
+			VehicleControlFragment.NextLane);
 	}
 
 	
 	// (See all CANTSTOPLANEEXIT.)
 	void SetVehicleCantStopAtLaneExit(
+		const FMassEntityHandle VehicleEntity,
 		FMassTrafficVehicleControlFragment& VehicleControlFragment,
+		bool& bCantStopAtLaneExit,
 		const FMassZoneGraphLaneLocationFragment& LaneLocationFragment,
 		const FMassTrafficNextVehicleFragment& NextVehicleFragment,
-		const FMassEntityManager& EntityManager)
+		const FMassEntityManager& EntityManager,
+		FMassTrafficLaneReservationBuffer* Reservations)
 	{
 		// Return if -
 		//		- This vehicle is already marked as being unable to stop at the lane exit.
 		//		- Or, it has no next lane.
-		if (VehicleControlFragment.bCantStopAtLaneExit || !VehicleControlFragment.NextLane)			
+		if (bCantStopAtLaneExit || !VehicleControlFragment.NextLane)			
 		{
 			return;
 		}
@@ -83,24 +115,28 @@ namespace
 			}
 		}
 		
-		VehicleControlFragment.bCantStopAtLaneExit = true; // (See all CANTSTOPLANEEXIT.)		
-		++VehicleControlFragment.NextLane->NumReservedVehiclesOnLane;
+		bCantStopAtLaneExit = true; // (See all CANTSTOPLANEEXIT.)		
+		ReserveLaneState(Reservations, VehicleEntity, EMassTrafficLaneReservationType::ReserveLane, VehicleControlFragment.NextLane, &VehicleControlFragment);
 	}
 
 	// (See all CANTSTOPLANEEXIT.)
-	void UnsetVehicleCantStopAtLaneExit(FMassTrafficVehicleControlFragment& VehicleControlFragment)
+	void UnsetVehicleCantStopAtLaneExit(
+		const FMassEntityHandle VehicleEntity,
+		FMassTrafficVehicleControlFragment& VehicleControlFragment,
+		bool& bCantStopAtLaneExit,
+		FMassTrafficLaneReservationBuffer* Reservations)
 	{
 		// Return if -
 		//		- This vehicle is not marked as being unable to stop at the lane exit.
 		//		- Or, it has no next lane.
-		if (!VehicleControlFragment.bCantStopAtLaneExit || !VehicleControlFragment.NextLane)			
+		if (!bCantStopAtLaneExit || !VehicleControlFragment.NextLane)			
 		{
-			UE_LOG(LogTemp, Warning, TEXT("UNSET FAIL (cantstop:%d, next:0x%x)"), VehicleControlFragment.bCantStopAtLaneExit, VehicleControlFragment.NextLane);
+			UE_LOG(LogTemp, Warning, TEXT("UNSET FAIL (cantstop:%d, next:0x%x)"), bCantStopAtLaneExit, VehicleControlFragment.NextLane);
 			return;
 		}
 
-		VehicleControlFragment.bCantStopAtLaneExit = false; // (See all CANTSTOPLANEEXIT.)
-		--VehicleControlFragment.NextLane->NumReservedVehiclesOnLane;
+		bCantStopAtLaneExit = false; // (See all CANTSTOPLANEEXIT.)
+		ReserveLaneState(Reservations, VehicleEntity, EMassTrafficLaneReservationType::ReleaseLane, VehicleControlFragment.NextLane, &VehicleControlFragment);
 	}
 }
 
@@ -159,80 +195,154 @@ void UMassTrafficVehicleControlProcessor::ConfigureQueries()
 
 void UMassTrafficVehicleControlProcessor::Execute(FMassEntityManager& EntityManager, FMassExecutionContext& Context)
 {
-	// Advance simple agents
-	SimpleVehicleControlEntityQuery_Conditional.ForEachEntityChunk(EntityManager, Context, [&, World = EntityManager.GetWorld()](FMassExecutionContext& ComponentSystemExecutionContext)
+	// Skip during replay playback and on frames without fixed timestep substeps
+	if (!ShouldSimulateTrafficVehicles())
+	{
+		return;
+	}
+
+	UMassTrafficSubsystem& MassTrafficSubsystem = Context.GetMutableSubsystemChecked<UMassTrafficSubsystem>(EntityManager.GetWorld());
+	const FMassTrafficSimulationClock& SimulationClock = MassTrafficSubsystem.GetSimulationClock();
+
+	// Advance simple agents.
+	// Chunks only read shared lane state and other vehicles, recording their changes to them into LaneReservations. So
+	// whether they're processed in parallel or not, every vehicle sees the same start of loop state and the changes are
+	// applied below in the same order. (See FMassTrafficLaneReservations.)
+	auto SimpleVehicleControlChunk = [&](FMassExecutionContext& QueryContext)
 		{
-			UMassTrafficSubsystem& MassTrafficSubsystem = ComponentSystemExecutionContext.GetMutableSubsystemChecked<UMassTrafficSubsystem>(World);
-			const TConstArrayView<FMassSimulationVariableTickFragment> VariableTickFragments = Context.GetFragmentView<FMassSimulationVariableTickFragment>();
-			const TConstArrayView<FMassTrafficRandomFractionFragment> RandomFractionFragments = Context.GetFragmentView<FMassTrafficRandomFractionFragment>();
-			const TConstArrayView<FTransformFragment> TransformFragments = Context.GetFragmentView<FTransformFragment>();
-			const TConstArrayView<FAgentRadiusFragment> RadiusFragments = Context.GetFragmentView<FAgentRadiusFragment>();
-			const TArrayView<FMassTrafficVehicleControlFragment> VehicleControlFragments = Context.GetMutableFragmentView<FMassTrafficVehicleControlFragment>();
-			const TArrayView<FMassTrafficVehicleLightsFragment> VehicleLightsFragments = Context.GetMutableFragmentView<FMassTrafficVehicleLightsFragment>();
-			const TArrayView<FMassZoneGraphLaneLocationFragment> LaneLocationFragments = Context.GetMutableFragmentView<FMassZoneGraphLaneLocationFragment>();
-			const TArrayView<FMassTrafficLaneOffsetFragment> LaneOffsetFragments = Context.GetMutableFragmentView<FMassTrafficLaneOffsetFragment>();
-			const TArrayView<FMassTrafficObstacleAvoidanceFragment> AvoidanceFragments = Context.GetMutableFragmentView<FMassTrafficObstacleAvoidanceFragment>();
-			const TConstArrayView<FMassTrafficDebugFragment> DebugFragments = Context.GetFragmentView<FMassTrafficDebugFragment>();
-			const TArrayView<FMassTrafficVehicleLaneChangeFragment> LaneChangeFragments = Context.GetMutableFragmentView<FMassTrafficVehicleLaneChangeFragment>();
-			const TConstArrayView<FMassTrafficNextVehicleFragment> NextVehicleFragments = Context.GetMutableFragmentView<FMassTrafficNextVehicleFragment>();
-
-			const int32 NumEntities = Context.GetNumEntities();
+			FMassTrafficLaneReservationBuffer& Reservations = LaneReservations.AddBuffer();
+
+			const EMassLOD::Type LOD = UE::MassLOD::GetLODFromArchetype(QueryContext);
+			const TConstArrayView<FMassSimulationVariableTickFragment> VariableTickFragments = QueryContext.GetFragmentView<FMassSimulationVariableTickFragment>();
+			const TConstArrayView<FMassTrafficRandomFractionFragment> RandomFractionFragments = QueryContext.GetFragmentView<FMassTrafficRandomFractionFragment>();
+			const TConstArrayView<FTransformFragment> TransformFragments = QueryContext.GetFragmentView<FTransformFragment>();
+			const TConstArrayView<FAgentRadiusFragment> RadiusFragments = QueryContext.GetFragmentView<FAgentRadiusFragment>();
+			const TArrayView<FMassTrafficVehicleControlFragment> VehicleControlFragments = QueryContext.GetMutableFragmentView<FMassTrafficVehicleControlFragment>();
+			const TArrayView<FMassTrafficVehicleLightsFragment> VehicleLightsFragments = QueryContext.GetMutableFragmentView<FMassTrafficVehicleLightsFragment>();
+			const TArrayView<FMassZoneGraphLaneLocationFragment> LaneLocationFragments = QueryContext.GetMutableFragmentView<FMassZoneGraphLaneLocationFragment>();
+			const TArrayView<FMassTrafficLaneOffsetFragment> LaneOffsetFragments = QueryContext.GetMutableFragmentView<FMassTrafficLaneOffsetFragment>();
+			const TArrayView<FMassTrafficObstacleAvoidanceFragment> AvoidanceFragments = QueryContext.GetMutableFragmentView<FMassTrafficObstacleAvoidanceFragment>();
+			const TConstArrayView<FMassTrafficDebugFragment> DebugFragments = QueryContext.GetFragmentView<FMassTrafficDebugFragment>();
+			const TArrayView<FMassTrafficVehicleLaneChangeFragment> LaneChangeFragments = QueryContext.GetMutableFragmentView<FMassTrafficVehicleLaneChangeFragment>();
+			const TArrayView<FMassTrafficNextVehicleFragment> NextVehicleFragments = QueryContext.GetMutableFragmentView<FMassTrafficNextVehicleFragment>();
+
+			const int32 NumEntities = QueryContext.GetNumEntities();
+			Reservations.LaneLocationFragments = LaneLocationFragments;
+			Reservations.DistancesAlongLane.SetNumUninitialized(NumEntities);
+
 			for (int32 Index = 0; Index < NumEntities; ++Index)
 			{
+				const FMassEntityHandle VehicleEntity = QueryContext.GetEntity(Index);
 				const FMassSimulationVariableTickFragment& VariableTickFragment = VariableTickFragments[Index];
 				const FMassTrafficRandomFractionFragment& RandomFractionFragment = RandomFractionFragments[Index];
 				const FTransformFragment& TransformFragment = TransformFragments[Index];
 				const FAgentRadiusFragment& RadiusFragment = RadiusFragments[Index];
 				FMassTrafficVehicleControlFragment& VehicleControlFragment = VehicleControlFragments[Index];
 				FMassTrafficVehicleLightsFragment& VehicleLightsFragment = VehicleLightsFragments[Index];
-				FMassZoneGraphLaneLocationFragment& LaneLocationFragment = LaneLocationFragments[Index];
 				FMassTrafficLaneOffsetFragment& LaneOffsetFragment = LaneOffsetFragments[Index];
 				FMassTrafficObstacleAvoidanceFragment& AvoidanceFragment = AvoidanceFragments[Index];
 				FMassTrafficVehicleLaneChangeFragment* LaneChangeFragment = !LaneChangeFragments.IsEmpty() ? &LaneChangeFragments[Index] : nullptr;
-				const FMassTrafficNextVehicleFragment& NextVehicleFragment = NextVehicleFragments[Index];
-				
+				FMassTrafficNextVehicleFragment& NextVehicleFragment = NextVehicleFragments[Index];
+
+				// Advance a copy of the lane location, written back once every chunk has been processed, so other
+				// vehicles see where this one was at the start of the loop
+				FMassZoneGraphLaneLocationFragment LaneLocationFragment = LaneLocationFragments[Index];
+				bool bCantStopAtLaneExit = VehicleControlFragment.bCantStopAtLaneExit; // (See all CANTSTOPLANEEXIT.)
 				
 				// Debug
 				const bool bVisLog = DebugFragments.IsEmpty() ? false : DebugFragments[Index].bVisLog > 0;
 
-				SimpleVehicleControl(
-					EntityManager,
-					MassTrafficSubsystem,
-					Context,
-					Index,
-					RadiusFragment,
-					RandomFractionFragment,
-					TransformFragment,
-					VariableTickFragment,
-					VehicleControlFragment,
-					VehicleLightsFragment,
-					LaneLocationFragment,
-					LaneOffsetFragment,
-					AvoidanceFragment,
-					LaneChangeFragment, NextVehicleFragment, bVisLog);
+				// With a fixed timestep, higher LODs integrate the accumulated variable tick time in fixed substeps
+				// while lower LODs take a single coarse step
+				const int32 NumSteps = SimulationClock.GetNumSteps(VariableTickFragment.DeltaTime, LOD, MassTrafficSettings->MaxFixedTimestepSubstepLOD);
+				const float StepDeltaTime = VariableTickFragment.DeltaTime / NumSteps;
+				for (int32 Step = 0; Step < NumSteps; ++Step)
+				{
+					const bool bReachedEndOfLane = SimpleVehicleControl(
+						EntityManager,
+						MassTrafficSubsystem,
+						VehicleEntity,
+						LOD,
+						RadiusFragment,
+						RandomFractionFragment,
+						TransformFragment,
+						StepDeltaTime,
+						VehicleControlFragment,
+						bCantStopAtLaneExit,
+						VehicleLightsFragment,
+						LaneLocationFragment,
+						LaneOffsetFragment,
+						AvoidanceFragment,
+						LaneChangeFragment,
+						NextVehicleFragment,
+						&Reservations,
+						bVisLog);
+
+					// Lane surgery has to wait until every chunk is done. The remaining steps are then taken on the
+					// next lane. (See MoveSimpleVehicleToNextLane.)
+					if (bReachedEndOfLane)
+					{
+						Reservations.AddVehicleAction(VehicleEntity, LOD, /*NumRemainingSteps*/NumSteps - Step - 1, StepDeltaTime);
+						break;
+					}
 				}
-		});
 
-	// Prepare physics inputs for PID vehicles
-	PIDVehicleControlEntityQuery_Conditional.ForEachEntityChunk(EntityManager, Context, [&, World = EntityManager.GetWorld()](FMassExecutionContext& ComponentSystemExecutionContext)
+				Reservations.DistancesAlongLane[Index] = LaneLocationFragment.DistanceAlongLane;
+			}
+		};
+
+	{
+		TRACE_CPUPROFILER_EVENT_SCOPE(TEXT("SimpleVehicleControl"));
+
+		if (ShouldProcessVehicleBehaviorInParallel())
+		{
+			SimpleVehicleControlEntityQuery_Conditional.ParallelForEachEntityChunk(EntityManager, Context, SimpleVehicleControlChunk);
+		}
+		else
+		{
+			SimpleVehicleControlEntityQuery_Conditional.ForEachEntityChunk(EntityManager, Context, SimpleVehicleControlChunk);
+		}
+	}
+
+	// Apply the recorded lane changes, then move vehicles that reached the end of their lane onto their next lane.
+	{
+		TRACE_CPUPROFILER_EVENT_SCOPE(TEXT("ApplyLaneReservations"));
+
+		LaneReservations.ApplyDistancesAlongLane();
+		for (const FMassTrafficLaneReservation& Reservation : LaneReservations.Sort())
+		{
+			if (Reservation.Type == EMassTrafficLaneReservationType::VehicleAction)
+			{
+				MoveSimpleVehicleToNextLane(EntityManager, MassTrafficSubsystem, Reservation.Entity, Reservation.LOD, /*NumRemainingSteps*/Reservation.ActionData, /*StepDeltaTime*/Reservation.ActionValue);
+			}
+			else
+			{
+				FMassTrafficLaneReservations::Apply(Reservation, MassTrafficSettings->DownstreamFlowDensityMixtureFraction);
+			}
+		}
+	}
+
+	// Prepare physics inputs for PID vehicles. These are the few high LOD vehicles, so aren't worth going wide for.
+	PIDVehicleControlEntityQuery_Conditional.ForEachEntityChunk(EntityManager, Context, [&, World = EntityManager.GetWorld()](FMassExecutionContext& QueryContext)
 		{
-			const UZoneGraphSubsystem& ZoneGraphSubsystem = ComponentSystemExecutionContext.GetSubsystemChecked<UZoneGraphSubsystem>(World);
-
-			const TConstArrayView<FMassSimulationVariableTickFragment> VariableTickFragments = Context.GetFragmentView<FMassSimulationVariableTickFragment>();
-			const TConstArrayView<FMassTrafficRandomFractionFragment> RandomFractionFragments = Context.GetMutableFragmentView<FMassTrafficRandomFractionFragment>();
-			const TConstArrayView<FMassTrafficObstacleAvoidanceFragment> AvoidanceFragments = Context.GetMutableFragmentView<FMassTrafficObstacleAvoidanceFragment>();
-			const TConstArrayView<FAgentRadiusFragment> RadiusFragments = Context.GetFragmentView<FAgentRadiusFragment>();
-			const TConstArrayView<FTransformFragment> TransformFragments = Context.GetFragmentView<FTransformFragment>();
-			const TArrayView<FMassTrafficVehicleControlFragment> VehicleControlFragments = Context.GetMutableFragmentView<FMassTrafficVehicleControlFragment>();
-			const TArrayView<FMassTrafficVehicleLightsFragment> VehicleLightsFragments = Context.GetMutableFragmentView<FMassTrafficVehicleLightsFragment>();
-			const TArrayView<FMassZoneGraphLaneLocationFragment> LaneLocationFragments = Context.GetMutableFragmentView<FMassZoneGraphLaneLocationFragment>();
-			const TArrayView<FMassTrafficPIDVehicleControlFragment> PIDVehicleControlFragments = Context.GetMutableFragmentView<FMassTrafficPIDVehicleControlFragment>();
-			const TArrayView<FMassTrafficPIDControlInterpolationFragment> VehiclePIDMovementInterpolationFragments = Context.GetMutableFragmentView<FMassTrafficPIDControlInterpolationFragment>();
-			const TConstArrayView<FMassTrafficDebugFragment> DebugFragments = Context.GetFragmentView<FMassTrafficDebugFragment>();
-			const TArrayView<FMassTrafficVehicleLaneChangeFragment> LaneChangeFragments = Context.GetMutableFragmentView<FMassTrafficVehicleLaneChangeFragment>();
-			const TConstArrayView<FMassTrafficNextVehicleFragment> NextVehicleFragments = Context.GetMutableFragmentView<FMassTrafficNextVehicleFragment>();
-
-			const int32 NumEntities = Context.GetNumEntities();
+			const UZoneGraphSubsystem& ZoneGraphSubsystem = QueryContext.GetSubsystemChecked<UZoneGraphSubsystem>(World);
+
+			const EMassLOD::Type LOD = UE::MassLOD::GetLODFromArchetype(QueryContext);
+			const TConstArrayView<FMassSimulationVariableTickFragment> VariableTickFragments = QueryContext.GetFragmentView<FMassSimulationVariableTickFragment>();
+			const TConstArrayView<FMassTrafficRandomFractionFragment> RandomFractionFragments = QueryContext.GetFragmentView<FMassTrafficRandomFractionFragment>();
+			const TConstArrayView<FMassTrafficObstacleAvoidanceFragment> AvoidanceFragments = QueryContext.GetFragmentView<FMassTrafficObstacleAvoidanceFragment>();
+			const TConstArrayView<FAgentRadiusFragment> RadiusFragments = QueryContext.GetFragmentView<FAgentRadiusFragment>();
+			const TConstArrayView<FTransformFragment> TransformFragments = QueryContext.GetFragmentView<FTransformFragment>();
+			const TArrayView<FMassTrafficVehicleControlFragment> VehicleControlFragments = QueryContext.GetMutableFragmentView<FMassTrafficVehicleControlFragment>();
+			const TArrayView<FMassTrafficVehicleLightsFragment> VehicleLightsFragments = QueryContext.GetMutableFragmentView<FMassTrafficVehicleLightsFragment>();
+			const TArrayView<FMassZoneGraphLaneLocationFragment> LaneLocationFragments = QueryContext.GetMutableFragmentView<FMassZoneGraphLaneLocationFragment>();
+			const TArrayView<FMassTrafficPIDVehicleControlFragment> PIDVehicleControlFragments = QueryContext.GetMutableFragmentView<FMassTrafficPIDVehicleControlFragment>();
+			const TArrayView<FMassTrafficPIDControlInterpolationFragment> VehiclePIDMovementInterpolationFragments = QueryContext.GetMutableFragmentView<FMassTrafficPIDControlInterpolationFragment>();
+			const TConstArrayView<FMassTrafficDebugFragment> DebugFragments = QueryContext.GetFragmentView<FMassTrafficDebugFragment>();
+			const TArrayView<FMassTrafficVehicleLaneChangeFragment> LaneChangeFragments = QueryContext.GetMutableFragmentView<FMassTrafficVehicleLaneChangeFragment>();
+			const TConstArrayView<FMassTrafficNextVehicleFragment> NextVehicleFragments = QueryContext.GetFragmentView<FMassTrafficNextVehicleFragment>();
+
+			const int32 NumEntities = QueryContext.GetNumEntities();
 			for (int32 Index = 0; Index < NumEntities; ++Index)
 			{
 				const FMassSimulationVariableTickFragment& VariableTickFragment = VariableTickFragments[Index];
@@ -255,9 +365,10 @@ void UMassTrafficVehicleControlProcessor::Execute(FMassEntityManager& EntityMana
 
 				PIDVehicleControl(
 					EntityManager,
-					Context,
-					Index,
+					QueryContext.GetEntity(Index),
+					LOD,
 					*ZoneGraphStorage,
+					MassTrafficSubsystem.GetLaneSegmentTable(LaneLocationFragment.LaneHandle.DataHandle),
 					AvoidanceFragment,
 					RadiusFragment,
 					RandomFractionFragment,
@@ -274,22 +385,95 @@ void UMassTrafficVehicleControlProcessor::Execute(FMassEntityManager& EntityMana
 		});
 }
 
-void UMassTrafficVehicleControlProcessor::SimpleVehicleControl(
+void UMassTrafficVehicleControlProcessor::MoveSimpleVehicleToNextLane(
 	FMassEntityManager& EntityManager,
 	UMassTrafficSubsystem& MassTrafficSubsystem,
-	FMassExecutionContext& Context,
-	const int32 EntityIndex,
+	const FMassEntityHandle VehicleEntity,
+	const EMassLOD::Type LOD,
+	const int32 NumRemainingSteps,
+	const float StepDeltaTime) const
+{
+	FMassEntityView VehicleEntityView(EntityManager, VehicleEntity);
+	const FAgentRadiusFragment& AgentRadiusFragment = VehicleEntityView.GetFragmentData<FAgentRadiusFragment>();
+	const FMassTrafficRandomFractionFragment& RandomFractionFragment = VehicleEntityView.GetFragmentData<FMassTrafficRandomFractionFragment>();
+	const FTransformFragment& TransformFragment = VehicleEntityView.GetFragmentData<FTransformFragment>();
+	FMassTrafficVehicleControlFragment& VehicleControlFragment = VehicleEntityView.GetFragmentData<FMassTrafficVehicleControlFragment>();
+	FMassTrafficVehicleLightsFragment& VehicleLightsFragment = VehicleEntityView.GetFragmentData<FMassTrafficVehicleLightsFragment>();
+	FMassZoneGraphLaneLocationFragment& LaneLocationFragment = VehicleEntityView.GetFragmentData<FMassZoneGraphLaneLocationFragment>();
+	FMassTrafficLaneOffsetFragment& LaneOffsetFragment = VehicleEntityView.GetFragmentData<FMassTrafficLaneOffsetFragment>();
+	FMassTrafficObstacleAvoidanceFragment& AvoidanceFragment = VehicleEntityView.GetFragmentData<FMassTrafficObstacleAvoidanceFragment>();
+	FMassTrafficNextVehicleFragment& NextVehicleFragment = VehicleEntityView.GetFragmentData<FMassTrafficNextVehicleFragment>();
+	FMassTrafficVehicleLaneChangeFragment* LaneChangeFragment = VehicleEntityView.GetFragmentDataPtr<FMassTrafficVehicleLaneChangeFragment>();
+	const FMassTrafficDebugFragment* DebugFragment = VehicleEntityView.GetFragmentDataPtr<FMassTrafficDebugFragment>();
+	const bool bVisLog = DebugFragment && DebugFragment->bVisLog > 0;
+
+	// Only UMassTrafficChooseNextLaneProcessor changes NextLane, so it should still be set. But at least clamp to the
+	// current lane length if not.
+	if (!ensure(VehicleControlFragment.NextLane))
+	{
+		LaneLocationFragment.DistanceAlongLane = LaneLocationFragment.LaneLength;
+		return;
+	}
+
+	bool bIsVehicleStuck = false; // (See all RECYCLESTUCK.)
+	UE::MassTraffic::MoveVehicleToNextLane(
+		EntityManager,
+		MassTrafficSubsystem,
+		VehicleEntity,
+		AgentRadiusFragment,
+		RandomFractionFragment,
+		VehicleControlFragment,
+		VehicleLightsFragment,
+		LaneLocationFragment,
+		NextVehicleFragment,
+		LaneChangeFragment,
+		bIsVehicleStuck/*out*/);
+
+	// Every other vehicle has finished moving, so the rest of this vehicle's steps can change shared lane state directly
+	bool bCantStopAtLaneExit = VehicleControlFragment.bCantStopAtLaneExit; // (See all CANTSTOPLANEEXIT.)
+	for (int32 Step = 0; Step < NumRemainingSteps; ++Step)
+	{
+		SimpleVehicleControl(
+			EntityManager,
+			MassTrafficSubsystem,
+			VehicleEntity,
+			LOD,
+			AgentRadiusFragment,
+			RandomFractionFragment,
+			TransformFragment,
+			StepDeltaTime,
+			VehicleControlFragment,
+			bCantStopAtLaneExit,
+			VehicleLightsFragment,
+			LaneLocationFragment,
+			LaneOffsetFragment,
+			AvoidanceFragment,
+			LaneChangeFragment,
+			NextVehicleFragment,
+			/*Reservations*/nullptr,
+			bVisLog);
+	}
+}
+
+bool UMassTrafficVehicleControlProcessor::SimpleVehicleControl(
+	FMassEntityManager& EntityManager,
+	UMassTrafficSubsystem& MassTrafficSubsystem,
+	const FMassEntityHandle VehicleEntity,
+	const EMassLOD::Type LOD,
 	const FAgentRadiusFragment& AgentRadiusFragment,
 	const FMassTrafficRandomFractionFragment& RandomFractionFragment,
 	const FTransformFragment& TransformFragment,
-	const FMassSimulationVariableTickFragment& VariableTickFragment,
+	const float DeltaTime,
 	FMassTrafficVehicleControlFragment& VehicleControlFragment,
+	bool& bCantStopAtLaneExit,
 	FMassTrafficVehicleLightsFragment& VehicleLightsFragment,
 	FMassZoneGraphLaneLocationFragment& LaneLocationFragment,
 	FMassTrafficLaneOffsetFragment& LaneOffsetFragment,
 	FMassTrafficObstacleAvoidanceFragment& AvoidanceFragment,
 	FMassTrafficVehicleLaneChangeFragment* LaneChangeFragment,
-	const FMassTrafficNextVehicleFragment& NextVehicleFragment, const bool bVisLog
+	FMassTrafficNextVehicleFragment& NextVehicleFragment,
+	FMassTrafficLaneReservationBuffer* Reservations,
+	const bool bVisLog
 ) const
 {
 	// Compute stable distance based noise
@@ -306,12 +490,12 @@ void UMassTrafficVehicleControlProcessor::SimpleVehicleControl(
 	);
 	const float VariedSpeedLimit = UE::MassTraffic::VarySpeedLimit(SpeedLimit, MassTrafficSettings->SpeedLimitVariancePct, MassTrafficSettings->SpeedVariancePct, RandomFractionFragment.RandomFraction, NoiseValue);
 
-	const bool bIsOffLOD = (UE::MassLOD::GetLODFromArchetype(Context) == EMassLOD::Off);
-	const bool bIsLowLOD = (UE::MassLOD::GetLODFromArchetype(Context) == EMassLOD::Low);
+	const bool bIsOffLOD = (LOD == EMassLOD::Off);
+	const bool bIsLowLOD = (LOD == EMassLOD::Low);
 	
 	// Should stop?
 	bool bRequestDifferentNextLane = false;
-	bool bVehicleCantStopAtLaneExit = VehicleControlFragment.bCantStopAtLaneExit; // (See all CANTSTOPLANEEXIT.)
+	bool bVehicleCantStopAtLaneExit = bCantStopAtLaneExit; // (See all CANTSTOPLANEEXIT.)
 	bool bIsFrontOfVehicleBeyondEndOfLane = false;
 	bool bVehicleHasNoNextLane = false;
 	bool bVehicleHasNoRoom = false;
@@ -333,7 +517,7 @@ void UMassTrafficVehicleControlProcessor::SimpleVehicleControl(
 		#if WITH_MASSTRAFFIC_DEBUG
 			, bVisLog
 			, LogOwner
-			, &Context.GetFragmentView<FTransformFragment>()[EntityIndex].GetTransform()
+			, &TransformFragment.GetTransform()
 		#endif
 	);
 	
@@ -347,15 +531,15 @@ void UMassTrafficVehicleControlProcessor::SimpleVehicleControl(
 	if (!bIsOffLOD /*EDGE CASE-ish - don't do this in off-LOD*/ && bVehicleCantStopAtLaneExit) 
 	{
 		// Vehicle can't stop before hitting the red light.
-		SetVehicleCantStopAtLaneExit(VehicleControlFragment, LaneLocationFragment, NextVehicleFragment, EntityManager);
+		SetVehicleCantStopAtLaneExit(VehicleEntity, VehicleControlFragment, bCantStopAtLaneExit, LaneLocationFragment, NextVehicleFragment, EntityManager, Reservations);
 	}
 
 	// EDGE CASE. Happens when a vehicle has decided it can't stop at same point in the recent past, but then soon
 	// after discovers it must stop after all (has run out of room, or has lost it's next lane.)
 	// (See all CANTSTOPLANEEXIT.)
-	if (bMustStopAtLaneExit && VehicleControlFragment.bCantStopAtLaneExit) 
+	if (bMustStopAtLaneExit && bCantStopAtLaneExit) 
 	{
-		UnsetVehicleCantStopAtLaneExit(VehicleControlFragment);
+		UnsetVehicleCantStopAtLaneExit(VehicleEntity, VehicleControlFragment, bCantStopAtLaneExit, Reservations);
 		bVehicleCantStopAtLaneExit = false;
 	}
 	
@@ -363,18 +547,18 @@ void UMassTrafficVehicleControlProcessor::SimpleVehicleControl(
 	// after discovers that, during it's very brief can't-stop phase, it has slipped into off-LOD territory, where we
 	// handle this situation differently. (See off-LOD handling below.)
 	// (See all CANTSTOPLANEEXIT.)
-	if (bIsOffLOD && VehicleControlFragment.bCantStopAtLaneExit) 
+	if (bIsOffLOD && bCantStopAtLaneExit) 
 	{
-		UnsetVehicleCantStopAtLaneExit(VehicleControlFragment);
+		UnsetVehicleCantStopAtLaneExit(VehicleEntity, VehicleControlFragment, bCantStopAtLaneExit, Reservations);
 		bVehicleCantStopAtLaneExit = false;
 	}
 
 	// EDGE CASE. Happens when a vehicle has decided it can't stop at same point in the recent past, but then does in
 	// fact somehow stop before the lane exit. (Seems to only happen in off LOD simple vehicles, but let's be safe.)
 	// (See all CANTSTOPLANEEXIT.)
-	if (VehicleControlFragment.Speed < 0.1f && !bIsFrontOfVehicleBeyondEndOfLane && VehicleControlFragment.bCantStopAtLaneExit)
+	if (VehicleControlFragment.Speed < 0.1f && !bIsFrontOfVehicleBeyondEndOfLane && bCantStopAtLaneExit)
 	{
-		UnsetVehicleCantStopAtLaneExit(VehicleControlFragment);
+		UnsetVehicleCantStopAtLaneExit(VehicleEntity, VehicleControlFragment, bCantStopAtLaneExit, Reservations);
 		bVehicleCantStopAtLaneExit = false;		
 	}
 
@@ -402,14 +586,14 @@ void UMassTrafficVehicleControlProcessor::SimpleVehicleControl(
 		bMustStopAtLaneExit
 		#if WITH_MASSTRAFFIC_DEBUG
 			, bVisLog
-			, Context.GetSubsystem<UMassTrafficSubsystem>(EntityManager.GetWorld())
-			, &Context.GetFragmentView<FTransformFragment>()[EntityIndex].GetTransform()
+			, &MassTrafficSubsystem
+			, &TransformFragment.GetTransform()
 		#endif
 	);
 
 
 	// (See all READYLANE.)
-	SetIsVehicleReadyToUseNextIntersectionLane(VehicleControlFragment, LaneLocationFragment, AgentRadiusFragment, RandomFractionFragment, MassTrafficSettings->StoppingDistanceRange, bVehicleHasNoRoom);
+	SetIsVehicleReadyToUseNextIntersectionLane(VehicleEntity, VehicleControlFragment, LaneLocationFragment, AgentRadiusFragment, RandomFractionFragment, MassTrafficSettings->StoppingDistanceRange, bVehicleHasNoRoom, Reservations);
 
 	
 	// @todo Reduce speed on corners 
@@ -421,8 +605,8 @@ void UMassTrafficVehicleControlProcessor::SimpleVehicleControl(
 		if (TargetSpeed > VehicleControlFragment.Speed)
 		{
 			const float VariedAcceleration = MassTrafficSettings->Acceleration * (1.0f + MassTrafficSettings->AccelerationVariancePct * (RandomFractionFragment.RandomFraction * 2.0f - 1.0f));
-			VehicleControlFragment.Speed = FMath::Min(TargetSpeed, VehicleControlFragment.Speed + VariableTickFragment.DeltaTime * VariedAcceleration);
-			VehicleControlFragment.BrakeLightHysteresis = VehicleControlFragment.BrakeLightHysteresis - VariableTickFragment.DeltaTime;
+			VehicleControlFragment.Speed = FMath::Min(TargetSpeed, VehicleControlFragment.Speed + DeltaTime * VariedAcceleration);
+			VehicleControlFragment.BrakeLightHysteresis = VehicleControlFragment.BrakeLightHysteresis - DeltaTime;
 		}
 		// Decelerate down to TargetSpeed
 		else
@@ -432,7 +616,7 @@ void UMassTrafficVehicleControlProcessor::SimpleVehicleControl(
 			{
 				VehicleControlFragment.BrakeLightHysteresis = 1.0f + RandomFractionFragment.RandomFraction * 0.25;
 			}
-			VehicleControlFragment.Speed = FMath::Max(TargetSpeed, VehicleControlFragment.Speed - VariableTickFragment.DeltaTime * VariedDeceleration);
+			VehicleControlFragment.Speed = FMath::Max(TargetSpeed, VehicleControlFragment.Speed - DeltaTime * VariedDeceleration);
 		}
 	}	
 
@@ -455,7 +639,7 @@ void UMassTrafficVehicleControlProcessor::SimpleVehicleControl(
 	if (!bIsOffLOD || !bIsVehicleStoppingOverLaneExit) // (See all CROSSWALKOVERLAP.)
 	{
 		const float MaxDistanceDelta = FMath::Max(AvoidanceFragment.DistanceToNext - MassTrafficSettings->MinimumDistanceToObstacleRange.X, 0.0f); 
-		const float DistanceDelta = FMath::Min(VariableTickFragment.DeltaTime * VehicleControlFragment.Speed, MaxDistanceDelta);
+		const float DistanceDelta = FMath::Min(DeltaTime * VehicleControlFragment.Speed, MaxDistanceDelta);
 
 		LaneLocationFragment.DistanceAlongLane += DistanceDelta;
 	
@@ -480,6 +664,7 @@ void UMassTrafficVehicleControlProcessor::SimpleVehicleControl(
 
 	
 	// Overran the lane?
+	bool bReachedEndOfLane = false;
 	if (bIsVehicleStoppingOverLaneExit)
 	{
 		// (See all CROSSWALKOVERLAP.)
@@ -496,7 +681,7 @@ void UMassTrafficVehicleControlProcessor::SimpleVehicleControl(
 			// (See all CROSSWALKOVERLAP.)
 			if (VehicleControlFragment.NextLane)
 			{
-				VehicleControlFragment.NextLane->bIsStoppedVehicleInPreviousLaneOverlappingThisLane = true;			
+				ReserveLaneState(Reservations, VehicleEntity, EMassTrafficLaneReservationType::SetStoppedVehicleOverlappingLane, VehicleControlFragment.NextLane);
 			}
 
 			// Whilst the above code will try to clamp us to the ideal MaxDistanceAlongLaneIfStopped, it may be that
@@ -514,21 +699,30 @@ void UMassTrafficVehicleControlProcessor::SimpleVehicleControl(
 		// Proceed onto next chosen lane
 		if (VehicleControlFragment.NextLane)
 		{
-			const FMassEntityHandle VehicleEntity = Context.GetEntity(EntityIndex); 
-			bool bIsVehicleStuck = false; // (See all RECYCLESTUCK.)
-			
-			UE::MassTraffic::MoveVehicleToNextLane(
-				EntityManager,
-				MassTrafficSubsystem,
-				VehicleEntity,
-				AgentRadiusFragment,
-				RandomFractionFragment,
-				VehicleControlFragment,
-				VehicleLightsFragment,
-				LaneLocationFragment,
-				Context.GetMutableFragmentView<FMassTrafficNextVehicleFragment>()[EntityIndex],
-				LaneChangeFragment,
-				bIsVehicleStuck/*out*/);
+			// Lane surgery is left to the caller when reserving lane state
+			if (Reservations)
+			{
+				bReachedEndOfLane = true;
+			}
+			else
+			{
+				bool bIsVehicleStuck = false; // (See all RECYCLESTUCK.)
+				
+				UE::MassTraffic::MoveVehicleToNextLane(
+					EntityManager,
+					MassTrafficSubsystem,
+					VehicleEntity,
+					AgentRadiusFragment,
+					RandomFractionFragment,
+					VehicleControlFragment,
+					VehicleLightsFragment,
+					LaneLocationFragment,
+					NextVehicleFragment,
+					LaneChangeFragment,
+					bIsVehicleStuck/*out*/);
+
+				bCantStopAtLaneExit = VehicleControlFragment.bCantStopAtLaneExit; // ..cleared on entering the next lane
+			}
 		}
 		// No next lane yet, at least clamp to current lane length
 		else
@@ -540,20 +734,23 @@ void UMassTrafficVehicleControlProcessor::SimpleVehicleControl(
 	// Debug speed
 	UE::MassTraffic::DrawDebugSpeed(
 		GetWorld(),
-		Context.GetFragmentView<FTransformFragment>()[EntityIndex].GetTransform().GetLocation(),
+		TransformFragment.GetTransform().GetLocation(),
 		VehicleControlFragment.Speed,
 		VehicleLightsFragment.bBrakeLights,
 		LaneLocationFragment.DistanceAlongLane,
 		LaneLocationFragment.LaneLength,
-		UE::MassLOD::GetLODFromArchetype(Context),
+		LOD,
 		bVisLog, LogOwner);
+
+	return bReachedEndOfLane;
 }
 
 void UMassTrafficVehicleControlProcessor::PIDVehicleControl(
 	const FMassEntityManager& EntityManager,
-	const FMassExecutionContext& Context,
-	const int32 EntityIndex,
+	const FMassEntityHandle VehicleEntity,
+	const EMassLOD::Type LOD,
 	const FZoneGraphStorage& ZoneGraphStorage,
+	const FMassTrafficLaneSegmentTable* LaneSegmentTable,
 	const FMassTrafficObstacleAvoidanceFragment& AvoidanceFragment,
 	const FAgentRadiusFragment& AgentRadiusFragment,
 	const FMassTrafficRandomFractionFragment& RandomFractionFragment,
@@ -579,6 +776,7 @@ void UMassTrafficVehicleControlProcessor::PIDVehicleControl(
 	FQuat SpeedControlChaseTargetOrientation;
 	UE::MassTraffic::InterpolatePositionAndOrientationAlongContinuousLanes(
 		ZoneGraphStorage,
+		LaneSegmentTable,
 		LaneLocationFragment.LaneHandle.Index,
 		LaneLocationFragment.LaneLength,
 		VehicleControlFragment.NextLane ? VehicleControlFragment.NextLane->LaneHandle.Index : INDEX_NONE,
@@ -595,6 +793,7 @@ void UMassTrafficVehicleControlProcessor::PIDVehicleControl(
 	FQuat SteeringControlChaseTargetOrientation;
 	UE::MassTraffic::InterpolatePositionAndOrientationAlongContinuousLanes(
 		ZoneGraphStorage,
+		LaneSegmentTable,
 		LaneLocationFragment.LaneHandle.Index,
 		LaneLocationFragment.LaneLength,
 		VehicleControlFragment.NextLane ? VehicleControlFragment.NextLane->LaneHandle.Index : INDEX_NONE,
@@ -632,7 +831,8 @@ void UMassTrafficVehicleControlProcessor::PIDVehicleControl(
 
 	// Should stop?
 	bool bRequestDifferentNextLane = false;
-	bool bVehicleCantStopAtLaneExit = VehicleControlFragment.bCantStopAtLaneExit; // (See all CANTSTOPLANEEXIT.)
+	bool bCantStopAtLaneExit = VehicleControlFragment.bCantStopAtLaneExit; // (See all CANTSTOPLANEEXIT.)
+	bool bVehicleCantStopAtLaneExit = bCantStopAtLaneExit;
 	bool bIsFrontOfVehicleBeyondEndOfLane = false;
 	bool bVehicleHasNoNextLane = false;
 	bool bVehicleHasNoRoom = false;
@@ -655,7 +855,7 @@ void UMassTrafficVehicleControlProcessor::PIDVehicleControl(
 		#if WITH_MASSTRAFFIC_DEBUG
 			, bVisLog
 			, LogOwner
-			, &Context.GetFragmentView<FTransformFragment>()[EntityIndex].GetTransform()
+			, &TransformFragment.GetTransform()
 		#endif
 	);
 	
@@ -667,24 +867,24 @@ void UMassTrafficVehicleControlProcessor::PIDVehicleControl(
 	if (bVehicleCantStopAtLaneExit) // (See all CANTSTOPLANEEXIT.)
 	{
 		// Vehicle can't stop before hitting the red light.
-		SetVehicleCantStopAtLaneExit(VehicleControlFragment, LaneLocationFragment, NextVehicleFragment, EntityManager);
+		SetVehicleCantStopAtLaneExit(VehicleEntity, VehicleControlFragment, bCantStopAtLaneExit, LaneLocationFragment, NextVehicleFragment, EntityManager, /*Reservations*/nullptr);
 	}
 
 	// EDGE CASE. Happens when a vehicle has decided it can't stop at same point in the recent past, but then soon
 	// after discovers it must stop after all (has run out of room, or has lost it's next lane.)
 	// (See all CANTSTOPLANEEXIT.)
-	if (bMustStopAtLaneExit && VehicleControlFragment.bCantStopAtLaneExit)
+	if (bMustStopAtLaneExit && bCantStopAtLaneExit)
 	{
-		UnsetVehicleCantStopAtLaneExit(VehicleControlFragment);
+		UnsetVehicleCantStopAtLaneExit(VehicleEntity, VehicleControlFragment, bCantStopAtLaneExit, /*Reservations*/nullptr);
 		bVehicleCantStopAtLaneExit = false;
 	}
 	
 	// EDGE CASE. Happens when a vehicle has decided it can't stop at same point in the recent past, but then does in
 	// fact somehow stop before the lane exit. (Seems to only happen in off LOD simple vehicles, but let's be safe.)
 	// (See all CANTSTOPLANEEXIT.)
-	if (VehicleControlFragment.Speed < 0.1f && !bIsFrontOfVehicleBeyondEndOfLane && VehicleControlFragment.bCantStopAtLaneExit)
+	if (VehicleControlFragment.Speed < 0.1f && !bIsFrontOfVehicleBeyondEndOfLane && bCantStopAtLaneExit)
 	{
-		UnsetVehicleCantStopAtLaneExit(VehicleControlFragment);
+		UnsetVehicleCantStopAtLaneExit(VehicleEntity, VehicleControlFragment, bCantStopAtLaneExit, /*Reservations*/nullptr);
 		bVehicleCantStopAtLaneExit = false;
 	}
 
@@ -693,7 +893,7 @@ void UMassTrafficVehicleControlProcessor::PIDVehicleControl(
 	if ((bMustStopAtLaneExit && bIsFrontOfVehicleBeyondEndOfLane) &&
 		VehicleControlFragment.NextLane)
 	{
-		VehicleControlFragment.NextLane->bIsStoppedVehicleInPreviousLaneOverlappingThisLane = true;
+		ReserveLaneState(/*Reservations*/nullptr, VehicleEntity, EMassTrafficLaneReservationType::SetStoppedVehicleOverlappingLane, VehicleControlFragment.NextLane);
 	}
 
 	// Calculate target speed
@@ -720,12 +920,12 @@ void UMassTrafficVehicleControlProcessor::PIDVehicleControl(
 		#if WITH_MASSTRAFFIC_DEBUG
 			, bVisLog
 			, LogOwner
-			, &Context.GetFragmentView<FTransformFragment>()[EntityIndex].GetTransform()
+			, &TransformFragment.GetTransform()
 		#endif
 	);
 
 	// (See all READYLANE.)
-	SetIsVehicleReadyToUseNextIntersectionLane(VehicleControlFragment, LaneLocationFragment, AgentRadiusFragment, RandomFractionFragment, MassTrafficSettings->StoppingDistanceRange, bVehicleHasNoRoom);
+	SetIsVehicleReadyToUseNextIntersectionLane(VehicleEntity, VehicleControlFragment, LaneLocationFragment, AgentRadiusFragment, RandomFractionFragment, MassTrafficSettings->StoppingDistanceRange, bVehicleHasNoRoom, /*Reservations*/nullptr);
 
 	// Reduce speed while cornering
 	const float TurnAngle = TransformFragment.GetTransform().InverseTransformVectorNoScale(SpeedControlChaseTargetOrientation.GetForwardVector()).HeadingAngle();
@@ -806,7 +1006,7 @@ void UMassTrafficVehicleControlProcessor::PIDVehicleControl(
 
 	// Debug speed
 	#if WITH_MASSTRAFFIC_DEBUG
-		const FVector& DebugLocation = Context.GetFragmentView<FTransformFragment>()[EntityIndex].GetTransform().GetLocation();
+		const FVector& DebugLocation = TransformFragment.GetTransform().GetLocation();
 		UE::MassTraffic::DrawDebugSpeed(
 			GetWorld(),
 			DebugLocation,
@@ -814,7 +1014,7 @@ void UMassTrafficVehicleControlProcessor::PIDVehicleControl(
 			VehicleLightsFragment.bBrakeLights,
 			LaneLocationFragment.DistanceAlongLane,
 			LaneLocationFragment.LaneLength,
-			UE::MassLOD::GetLODFromArchetype(Context),
+			LOD,
 			bVisLog,
 			LogOwner);
 		UE::MassTraffic::DrawDebugChaosVehicleControl(GetWorld(), DebugLocation, SpeedControlChaseTargetLocation, SteeringControlChaseTargetLocation, TargetSpeed, PIDVehicleControlFragment.Throttle, PIDVehicleControlFragment.Brake, PIDVehicleControlFragment.Steering, PIDVehicleControlFragment.bHandbrake, bVisLog, LogOwner);
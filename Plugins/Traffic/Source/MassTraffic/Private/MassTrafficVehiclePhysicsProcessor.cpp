@@ -7,6 +7,7 @@
 #include "MassTrafficInterpolation.h"
 #include "MassTrafficLaneChange.h"
 #include "MassTrafficParkedVehicleVisualizationProcessor.h"
+#include "MassTrafficSubsystem.h"
 #include "MassTrafficTrailerSimulationTrait.h"
 #include "MassTrafficVehicleControlProcessor.h"
 
@@ -91,16 +92,27 @@ void UMassTrafficVehiclePhysicsProcessor::ConfigureQueries()
 
 void UMassTrafficVehiclePhysicsProcessor::Execute(FMassEntityManager& EntityManager, FMassExecutionContext& Context)
 {
+	// Skip during replay playback and on frames without fixed timestep substeps
+	if (!ShouldSimulateTrafficVehicles())
+	{
+		return;
+	}
+
 	TRACE_CPUPROFILER_EVENT_SCOPE(TEXT("SimplePhysicsVehicle"))
 
 	// Get Chaos solver settings
 	const int32 NumChaosConstraintSolverIterations = UPhysicsSettingsCore::Get()->SolverOptions.PositionIterations;
 	const float MinDeltaTime = UPhysicsSettings::Get()->MinPhysicsDeltaTime;
 	const float MaxDeltaTime = UPhysicsSettings::Get()->MaxPhysicsDeltaTime;
-	const float DeltaTime = FMath::Min(Context.GetDeltaTimeSeconds(), MaxDeltaTime);
+
+	// With a fixed timestep, integrate each of this frame's substeps at exactly the fixed step size
+	const UMassTrafficSubsystem& MassTrafficSubsystem = *GetWorld()->GetSubsystem<UMassTrafficSubsystem>();
+	const FMassTrafficSimulationClock& SimulationClock = MassTrafficSubsystem.GetSimulationClock();
+	const int32 NumSubsteps = SimulationClock.bFixedTimestep ? SimulationClock.NumSubsteps : 1;
+	const float DeltaTime = SimulationClock.bFixedTimestep ? SimulationClock.FixedDeltaTime : FMath::Min(Context.GetDeltaTimeSeconds(), MaxDeltaTime);
 
 	// Skip simulation if Dt < MinDeltaTime 
-	if (DeltaTime < MinDeltaTime)
+	if (!SimulationClock.bFixedTimestep && DeltaTime < MinDeltaTime)
 	{
 		return;
 	}
@@ -111,239 +123,244 @@ void UMassTrafficVehiclePhysicsProcessor::Execute(FMassEntityManager& EntityMana
 		// Get gravity from world
 		float GravityZ = GetWorld()->GetGravityZ();
 		
-		SimplePhysicsVehiclesQuery.ForEachEntityChunk(EntityManager, Context, [&, World = EntityManager.GetWorld()](FMassExecutionContext& QueryContext)
+		for (int32 Substep = 0; Substep < NumSubsteps; ++Substep)
 		{
-			const UZoneGraphSubsystem& ZoneGraphSubsystem = QueryContext.GetSubsystemChecked<UZoneGraphSubsystem>(World);
-
-			const TConstArrayView<FMassTrafficPIDVehicleControlFragment> PIDVehicleControlFragments = QueryContext.GetFragmentView<FMassTrafficPIDVehicleControlFragment>();
-			const TConstArrayView<FMassTrafficVehicleLaneChangeFragment> LaneChangeFragments = QueryContext.GetFragmentView<FMassTrafficVehicleLaneChangeFragment>();
-			const TConstArrayView<FMassTrafficConstrainedTrailerFragment> TrailerConstraintFragments = QueryContext.GetFragmentView<FMassTrafficConstrainedTrailerFragment>();
-			const TConstArrayView<FMassTrafficLaneOffsetFragment> LaneOffsetFragments = QueryContext.GetMutableFragmentView<FMassTrafficLaneOffsetFragment>();
-			const TArrayView<FMassTrafficVehicleControlFragment> VehicleControlFragments = QueryContext.GetMutableFragmentView<FMassTrafficVehicleControlFragment>();
-			const TArrayView<FMassTrafficVehiclePhysicsFragment> SimplePhysicsVehicleFragments = QueryContext.GetMutableFragmentView<FMassTrafficVehiclePhysicsFragment>();
-			const TArrayView<FMassVelocityFragment> VelocityFragments = QueryContext.GetMutableFragmentView<FMassVelocityFragment>();
-			const TArrayView<FMassTrafficAngularVelocityFragment> AngularVelocityFragments = QueryContext.GetMutableFragmentView<FMassTrafficAngularVelocityFragment>();
-			const TArrayView<FTransformFragment> TransformFragments = QueryContext.GetMutableFragmentView<FTransformFragment>();
-			const TArrayView<FMassZoneGraphLaneLocationFragment> LaneLocationFragments = QueryContext.GetMutableFragmentView<FMassZoneGraphLaneLocationFragment>();
-			const TArrayView<FMassTrafficInterpolationFragment> InterpolationFragments = QueryContext.GetMutableFragmentView<FMassTrafficInterpolationFragment>();
-			const TConstArrayView<FMassTrafficDebugFragment> DebugFragments = QueryContext.GetFragmentView<FMassTrafficDebugFragment>();
-
-			const int32 NumEntities = QueryContext.GetNumEntities();
-			for (int32 Index = 0; Index < NumEntities; ++Index)
+			SimplePhysicsVehiclesQuery.ForEachEntityChunk(EntityManager, Context, [&, World = EntityManager.GetWorld()](FMassExecutionContext& QueryContext)
 			{
-				// Note: Simple vehicle physics is always run for both high & low viewer LOD vehicles. Most of the time
-				//		 this simple simulation is discarded / ignored by the high LOD physics actor which does its
-				//		 own simulation. However, when a high LOD drops back to medium LOD on a frame, this simulation
-				//		 will have been done to ensure the spawned medium LOD will have been advanced forward.  
+				const UZoneGraphSubsystem& ZoneGraphSubsystem = QueryContext.GetSubsystemChecked<UZoneGraphSubsystem>(World);
+
+				const TConstArrayView<FMassTrafficPIDVehicleControlFragment> PIDVehicleControlFragments = QueryContext.GetFragmentView<FMassTrafficPIDVehicleControlFragment>();
+				const TConstArrayView<FMassTrafficVehicleLaneChangeFragment> LaneChangeFragments = QueryContext.GetFragmentView<FMassTrafficVehicleLaneChangeFragment>();
+				const TConstArrayView<FMassTrafficConstrainedTrailerFragment> TrailerConstraintFragments = QueryContext.GetFragmentView<FMassTrafficConstrainedTrailerFragment>();
+				const TConstArrayView<FMassTrafficLaneOffsetFragment> LaneOffsetFragments = QueryContext.GetMutableFragmentView<FMassTrafficLaneOffsetFragment>();
+				const TArrayView<FMassTrafficVehicleControlFragment> VehicleControlFragments = QueryContext.GetMutableFragmentView<FMassTrafficVehicleControlFragment>();
+				const TArrayView<FMassTrafficVehiclePhysicsFragment> SimplePhysicsVehicleFragments = QueryContext.GetMutableFragmentView<FMassTrafficVehiclePhysicsFragment>();
+				const TArrayView<FMassVelocityFragment> VelocityFragments = QueryContext.GetMutableFragmentView<FMassVelocityFragment>();
+				const TArrayView<FMassTrafficAngularVelocityFragment> AngularVelocityFragments = QueryContext.GetMutableFragmentView<FMassTrafficAngularVelocityFragment>();
+				const TArrayView<FTransformFragment> TransformFragments = QueryContext.GetMutableFragmentView<FTransformFragment>();
+				const TArrayView<FMassZoneGraphLaneLocationFragment> LaneLocationFragments = QueryContext.GetMutableFragmentView<FMassZoneGraphLaneLocationFragment>();
+				const TArrayView<FMassTrafficInterpolationFragment> InterpolationFragments = QueryContext.GetMutableFragmentView<FMassTrafficInterpolationFragment>();
+				const TConstArrayView<FMassTrafficDebugFragment> DebugFragments = QueryContext.GetFragmentView<FMassTrafficDebugFragment>();
+
+				const int32 NumEntities = QueryContext.GetNumEntities();
+				for (int32 Index = 0; Index < NumEntities; ++Index)
+				{
+					// Note: Simple vehicle physics is always run for both high & low viewer LOD vehicles. Most of the time
+					//		 this simple simulation is discarded / ignored by the high LOD physics actor which does its
+					//		 own simulation. However, when a high LOD drops back to medium LOD on a frame, this simulation
+					//		 will have been done to ensure the spawned medium LOD will have been advanced forward.  
 				
-				const FMassTrafficPIDVehicleControlFragment& PIDVehicleControlFragment = PIDVehicleControlFragments[Index];
-				const FMassTrafficVehicleLaneChangeFragment& LaneChangeFragment = LaneChangeFragments[Index]; 
-				FMassTrafficVehicleControlFragment& VehicleControlFragment = VehicleControlFragments[Index];
-				FMassTrafficVehiclePhysicsFragment& SimplePhysicsVehicleFragment = SimplePhysicsVehicleFragments[Index];
-				FMassVelocityFragment& VelocityFragment = VelocityFragments[Index];
-				FMassTrafficAngularVelocityFragment& AngularVelocityFragment = AngularVelocityFragments[Index];
-				FTransformFragment& TransformFragment = TransformFragments[Index];
-				FMassZoneGraphLaneLocationFragment& LaneLocationFragment = LaneLocationFragments[Index];
-				const FMassTrafficLaneOffsetFragment& LaneOffsetFragment = LaneOffsetFragments[Index];
-				FMassTrafficInterpolationFragment& InterpolationFragment = InterpolationFragments[Index];
-
-				const FZoneGraphStorage* ZoneGraphStorage = ZoneGraphSubsystem.GetZoneGraphStorage(LaneLocationFragment.LaneHandle.DataHandle);
-				check(ZoneGraphStorage);
-
-				bool bVisLog = DebugFragments.IsEmpty() ? false : DebugFragments[Index].bVisLog > 0;
-
-				// Copy input world transform
-				const FTransform VehicleWorldTransform = TransformFragment.GetTransform();
+					const FMassTrafficPIDVehicleControlFragment& PIDVehicleControlFragment = PIDVehicleControlFragments[Index];
+					const FMassTrafficVehicleLaneChangeFragment& LaneChangeFragment = LaneChangeFragments[Index]; 
+					FMassTrafficVehicleControlFragment& VehicleControlFragment = VehicleControlFragments[Index];
+					FMassTrafficVehiclePhysicsFragment& SimplePhysicsVehicleFragment = SimplePhysicsVehicleFragments[Index];
+					FMassVelocityFragment& VelocityFragment = VelocityFragments[Index];
+					FMassTrafficAngularVelocityFragment& AngularVelocityFragment = AngularVelocityFragments[Index];
+					FTransformFragment& TransformFragment = TransformFragments[Index];
+					FMassZoneGraphLaneLocationFragment& LaneLocationFragment = LaneLocationFragments[Index];
+					const FMassTrafficLaneOffsetFragment& LaneOffsetFragment = LaneOffsetFragments[Index];
+					FMassTrafficInterpolationFragment& InterpolationFragment = InterpolationFragments[Index];
+
+					const FZoneGraphStorage* ZoneGraphStorage = ZoneGraphSubsystem.GetZoneGraphStorage(LaneLocationFragment.LaneHandle.DataHandle);
+					check(ZoneGraphStorage);
+					const FMassTrafficLaneSegmentTable* LaneSegmentTable = MassTrafficSubsystem.GetLaneSegmentTable(LaneLocationFragment.LaneHandle.DataHandle);
+
+					bool bVisLog = DebugFragments.IsEmpty() ? false : DebugFragments[Index].bVisLog > 0;
+
+					// Copy input world transform
+					const FTransform VehicleWorldTransform = TransformFragment.GetTransform();
 				
-				// Skip sleeping vehicles
-				const bool bIsSleeping = ProcessSleeping(VehicleControlFragment, PIDVehicleControlFragment, SimplePhysicsVehicleFragment, VehicleWorldTransform, bVisLog);
-				if (bIsSleeping)
-				{
-					continue;
-				}
+					// Skip sleeping vehicles
+					const bool bIsSleeping = ProcessSleeping(VehicleControlFragment, PIDVehicleControlFragment, SimplePhysicsVehicleFragment, VehicleWorldTransform, bVisLog);
+					if (bIsSleeping)
+					{
+						continue;
+					}
 				
-				// Interpolate current raw lane location
-				FTransform RawLaneLocationTransform;
-				UE::MassTraffic::InterpolatePositionAndOrientationAlongLane(*ZoneGraphStorage, LaneLocationFragment.LaneHandle.Index, LaneLocationFragment.DistanceAlongLane, ETrafficVehicleMovementInterpolationMethod::CubicBezier, InterpolationFragment.LaneLocationLaneSegment, RawLaneLocationTransform);
-				RawLaneLocationTransform.AddToTranslation(RawLaneLocationTransform.GetRotation().GetRightVector() * LaneOffsetFragment.LateralOffset);
-				UE::MassTraffic::AdjustVehicleTransformDuringLaneChange(LaneChangeFragment, LaneLocationFragment.DistanceAlongLane, RawLaneLocationTransform, nullptr/*TrafficCoordinator->GetWorld()*/);
-
-				// Perform suspension traces
-				TArray<FHitResult, TFixedAllocator<FMassTrafficSimpleVehiclePhysicsSim::MaxWheels>> SuspensionTraceHitResults;
-				TArray<FVector, TFixedAllocator<FMassTrafficSimpleVehiclePhysicsSim::MaxWheels>> SuspensionTargets;
-				PerformSuspensionTraces(
-					SimplePhysicsVehicleFragment,
-					VehicleWorldTransform,
-					RawLaneLocationTransform,
-					SuspensionTraceHitResults,
-					SuspensionTargets,
-					bVisLog,
-					/*Color*/UE::MassTraffic::EntityToColor(QueryContext.GetEntity(Index)));
+					// Interpolate current raw lane location
+					FTransform RawLaneLocationTransform;
+					UE::MassTraffic::InterpolatePositionAndOrientationAlongLane(*ZoneGraphStorage, LaneSegmentTable, LaneLocationFragment.LaneHandle.Index, LaneLocationFragment.DistanceAlongLane, ETrafficVehicleMovementInterpolationMethod::CubicBezier, InterpolationFragment.LaneLocationLaneSegment, RawLaneLocationTransform);
+					RawLaneLocationTransform.AddToTranslation(RawLaneLocationTransform.GetRotation().GetRightVector() * LaneOffsetFragment.LateralOffset);
+					UE::MassTraffic::AdjustVehicleTransformDuringLaneChange(LaneChangeFragment, LaneLocationFragment.DistanceAlongLane, RawLaneLocationTransform, nullptr/*TrafficCoordinator->GetWorld()*/);
+
+					// Perform suspension traces
+					TArray<FHitResult, TFixedAllocator<FMassTrafficSimpleVehiclePhysicsSim::MaxWheels>> SuspensionTraceHitResults;
+					TArray<FVector, TFixedAllocator<FMassTrafficSimpleVehiclePhysicsSim::MaxWheels>> SuspensionTargets;
+					PerformSuspensionTraces(
+						SimplePhysicsVehicleFragment,
+						VehicleWorldTransform,
+						RawLaneLocationTransform,
+						SuspensionTraceHitResults,
+						SuspensionTargets,
+						bVisLog,
+						/*Color*/UE::MassTraffic::EntityToColor(QueryContext.GetEntity(Index)));
 				
-				// Simulate drive forces 
-				SimulateDriveForces(
-					DeltaTime,
-					GravityZ,
-					PIDVehicleControlFragment,
-					SimplePhysicsVehicleFragment,
-					VelocityFragment,
-					AngularVelocityFragment,
-					TransformFragment,
-					VehicleWorldTransform,
-					SuspensionTraceHitResults,
-					bVisLog
-				);
-
-				// Has a simulating trailer? (Vehicles with trailers need to iterate constraints for both the vehicle & the trailer together)
-				bool bHasTrailer = false;
-				if (!TrailerConstraintFragments.IsEmpty())
-				{
-					const FMassTrafficConstrainedTrailerFragment& TrailerConstraintFragment = TrailerConstraintFragments[Index];
-					if (TrailerConstraintFragment.Trailer.IsSet())
+					// Simulate drive forces 
+					SimulateDriveForces(
+						DeltaTime,
+						GravityZ,
+						PIDVehicleControlFragment,
+						SimplePhysicsVehicleFragment,
+						VelocityFragment,
+						AngularVelocityFragment,
+						TransformFragment,
+						VehicleWorldTransform,
+						SuspensionTraceHitResults,
+						bVisLog
+					);
+
+					// Has a simulating trailer? (Vehicles with trailers need to iterate constraints for both the vehicle & the trailer together)
+					bool bHasTrailer = false;
+					if (!TrailerConstraintFragments.IsEmpty())
 					{
-						FMassEntityView TrailerMassEntityView(EntityManager, TrailerConstraintFragment.Trailer);
-						FMassTrafficVehiclePhysicsFragment* TrailerSimplePhysicsVehicleFragmentPtr = TrailerMassEntityView.GetFragmentDataPtr<FMassTrafficVehiclePhysicsFragment>();
-						if (TrailerSimplePhysicsVehicleFragmentPtr)
+						const FMassTrafficConstrainedTrailerFragment& TrailerConstraintFragment = TrailerConstraintFragments[Index];
+						if (TrailerConstraintFragment.Trailer.IsSet())
 						{
-							TRACE_CPUPROFILER_EVENT_SCOPE(TEXT("SuspensionConstraintsAndTrailer"))
-							bHasTrailer = true;
+							FMassEntityView TrailerMassEntityView(EntityManager, TrailerConstraintFragment.Trailer);
+							FMassTrafficVehiclePhysicsFragment* TrailerSimplePhysicsVehicleFragmentPtr = TrailerMassEntityView.GetFragmentDataPtr<FMassTrafficVehiclePhysicsFragment>();
+							if (TrailerSimplePhysicsVehicleFragmentPtr)
+							{
+								TRACE_CPUPROFILER_EVENT_SCOPE(TEXT("SuspensionConstraintsAndTrailer"))
+								bHasTrailer = true;
 							
-							FMassTrafficVehiclePhysicsFragment& TrailerSimplePhysicsVehicleFragment = *TrailerSimplePhysicsVehicleFragmentPtr; 
-							FMassVelocityFragment& TrailerVelocityFragment = TrailerMassEntityView.GetFragmentData<FMassVelocityFragment>();
-							FMassTrafficAngularVelocityFragment& TrailerAngularVelocityFragment = TrailerMassEntityView.GetFragmentData<FMassTrafficAngularVelocityFragment>();
-							FTransformFragment& TrailerTransformFragment = TrailerMassEntityView.GetFragmentData<FTransformFragment>();
-							FMassTrafficInterpolationFragment& TrailerInterpolationFragment = TrailerMassEntityView.GetFragmentData<FMassTrafficInterpolationFragment>();
+								FMassTrafficVehiclePhysicsFragment& TrailerSimplePhysicsVehicleFragment = *TrailerSimplePhysicsVehicleFragmentPtr; 
+								FMassVelocityFragment& TrailerVelocityFragment = TrailerMassEntityView.GetFragmentData<FMassVelocityFragment>();
+								FMassTrafficAngularVelocityFragment& TrailerAngularVelocityFragment = TrailerMassEntityView.GetFragmentData<FMassTrafficAngularVelocityFragment>();
+								FTransformFragment& TrailerTransformFragment = TrailerMassEntityView.GetFragmentData<FTransformFragment>();
+								FMassTrafficInterpolationFragment& TrailerInterpolationFragment = TrailerMassEntityView.GetFragmentData<FMassTrafficInterpolationFragment>();
 					
-							// Get trailer simulation config
-							const FMassTrafficTrailerSimulationParameters& TrailerSimulationConfig = TrailerMassEntityView.GetConstSharedFragmentData<FMassTrafficTrailerSimulationParameters>();
+								// Get trailer simulation config
+								const FMassTrafficTrailerSimulationParameters& TrailerSimulationConfig = TrailerMassEntityView.GetConstSharedFragmentData<FMassTrafficTrailerSimulationParameters>();
 					
-							// Capture input world transform
-							const FTransform TrailerWorldTransform = TrailerTransformFragment.GetTransform();
+								// Capture input world transform
+								const FTransform TrailerWorldTransform = TrailerTransformFragment.GetTransform();
 					
-							// Interpolate current raw lane location for trailer rear axle
-							// Note: As we don't do ClampLateralDeviation for trailers, we can skip
-							//       performing AdjustVehicleTransformDuringLaneChange as we're only using this raw lane
-							//		 location to form the tracing plane for suspensions traces, which isn't affected by lane
-							//		 change lateral offsets anyway.
-							FTransform TrailerRawLaneLocationTransform;
-							UE::MassTraffic::InterpolatePositionAndOrientationAlongContinuousLanes(
-								*ZoneGraphStorage,
-								VehicleControlFragment.PreviousLaneIndex,
-								VehicleControlFragment.PreviousLaneLength,
-								LaneLocationFragment.LaneHandle.Index,
-								LaneLocationFragment.LaneLength,
-								/*NextLaneIndex*/INDEX_NONE,
-								LaneLocationFragment.DistanceAlongLane + TrailerSimulationConfig.RearAxleX, ETrafficVehicleMovementInterpolationMethod::CubicBezier, TrailerInterpolationFragment.LaneLocationLaneSegment, TrailerRawLaneLocationTransform);
+								// Interpolate current raw lane location for trailer rear axle
+								// Note: As we don't do ClampLateralDeviation for trailers, we can skip
+								//       performing AdjustVehicleTransformDuringLaneChange as we're only using this raw lane
+								//		 location to form the tracing plane for suspensions traces, which isn't affected by lane
+								//		 change lateral offsets anyway.
+								FTransform TrailerRawLaneLocationTransform;
+								UE::MassTraffic::InterpolatePositionAndOrientationAlongContinuousLanes(
+									*ZoneGraphStorage,
+									LaneSegmentTable,
+									VehicleControlFragment.PreviousLaneIndex,
+									VehicleControlFragment.PreviousLaneLength,
+									LaneLocationFragment.LaneHandle.Index,
+									LaneLocationFragment.LaneLength,
+									/*NextLaneIndex*/INDEX_NONE,
+									LaneLocationFragment.DistanceAlongLane + TrailerSimulationConfig.RearAxleX, ETrafficVehicleMovementInterpolationMethod::CubicBezier, TrailerInterpolationFragment.LaneLocationLaneSegment, TrailerRawLaneLocationTransform);
 					
-							// Perform suspension traces
-							TArray<FHitResult, TFixedAllocator<FMassTrafficSimpleVehiclePhysicsSim::MaxWheels>> TrailerSuspensionTraceHitResults;
-							TArray<FVector, TFixedAllocator<FMassTrafficSimpleVehiclePhysicsSim::MaxWheels>> TrailerSuspensionTargets;
-							PerformSuspensionTraces(
-								TrailerSimplePhysicsVehicleFragment,
-								TrailerWorldTransform,
-								TrailerRawLaneLocationTransform,
-								TrailerSuspensionTraceHitResults,
-								TrailerSuspensionTargets,
-								bVisLog,
-								/*Color*/UE::MassTraffic::EntityToColor(QueryContext.GetEntity(Index)));
+								// Perform suspension traces
+								TArray<FHitResult, TFixedAllocator<FMassTrafficSimpleVehiclePhysicsSim::MaxWheels>> TrailerSuspensionTraceHitResults;
+								TArray<FVector, TFixedAllocator<FMassTrafficSimpleVehiclePhysicsSim::MaxWheels>> TrailerSuspensionTargets;
+								PerformSuspensionTraces(
+									TrailerSimplePhysicsVehicleFragment,
+									TrailerWorldTransform,
+									TrailerRawLaneLocationTransform,
+									TrailerSuspensionTraceHitResults,
+									TrailerSuspensionTargets,
+									bVisLog,
+									/*Color*/UE::MassTraffic::EntityToColor(QueryContext.GetEntity(Index)));
 							
-							// Simulate drive forces 
-							const FMassTrafficPIDVehicleControlFragment NoInputPIDVehicleControlFragment;
-							SimulateDriveForces(
-								DeltaTime,
-								GravityZ,
-								NoInputPIDVehicleControlFragment,
-								TrailerSimplePhysicsVehicleFragment,
-								TrailerVelocityFragment,
-								TrailerAngularVelocityFragment,
-								TrailerTransformFragment,
-								TrailerWorldTransform,
-								TrailerSuspensionTraceHitResults,
-								bVisLog
-							);
+								// Simulate drive forces 
+								const FMassTrafficPIDVehicleControlFragment NoInputPIDVehicleControlFragment;
+								SimulateDriveForces(
+									DeltaTime,
+									GravityZ,
+									NoInputPIDVehicleControlFragment,
+									TrailerSimplePhysicsVehicleFragment,
+									TrailerVelocityFragment,
+									TrailerAngularVelocityFragment,
+									TrailerTransformFragment,
+									TrailerWorldTransform,
+									TrailerSuspensionTraceHitResults,
+									bVisLog
+								);
 					
-							TrailerConstraintSolver.Init(
-								DeltaTime, 
-								ChaosConstraintSolverSettings,
-								TrailerSimulationConfig.ChaosJointSettings,
-								VehicleWorldTransform.TransformPosition(SimplePhysicsVehicleFragment.VehicleSim.Setup().CenterOfMass),
-								TrailerWorldTransform.TransformPosition(TrailerSimplePhysicsVehicleFragment.VehicleSim.Setup().CenterOfMass),
-								VehicleWorldTransform.GetRotation() * SimplePhysicsVehicleFragment.VehicleSim.Setup().RotationOfMass,
-								TrailerWorldTransform.GetRotation() * TrailerSimplePhysicsVehicleFragment.VehicleSim.Setup().RotationOfMass,
-								SimplePhysicsVehicleFragment.VehicleSim.Setup().Mass > 0.0f ? 1.0f / SimplePhysicsVehicleFragment.VehicleSim.Setup().Mass : 0.0f,
-								SimplePhysicsVehicleFragment.VehicleSim.Setup().InverseMomentOfInertia,
-								TrailerSimplePhysicsVehicleFragment.VehicleSim.Setup().Mass > 0.0f ? 1.0f / TrailerSimplePhysicsVehicleFragment.VehicleSim.Setup().Mass : 0.0f,
-								TrailerSimplePhysicsVehicleFragment.VehicleSim.Setup().InverseMomentOfInertia,
-								Chaos::FRigidTransform3(SimplePhysicsVehicleFragment.VehicleSim.Setup().RotationOfMass.UnrotateVector(TrailerSimulationConfig.ConstraintSettings.MountPoint - SimplePhysicsVehicleFragment.VehicleSim.Setup().CenterOfMass), SimplePhysicsVehicleFragment.VehicleSim.Setup().RotationOfMass.Inverse()),
-								Chaos::FRigidTransform3(TrailerSimplePhysicsVehicleFragment.VehicleSim.Setup().RotationOfMass.UnrotateVector(TrailerSimulationConfig.ConstraintSettings.MountPoint - TrailerSimplePhysicsVehicleFragment.VehicleSim.Setup().CenterOfMass), TrailerSimplePhysicsVehicleFragment.VehicleSim.Setup().RotationOfMass.Inverse())
-							);
+								TrailerConstraintSolver.Init(
+									DeltaTime, 
+									ChaosConstraintSolverSettings,
+									TrailerSimulationConfig.ChaosJointSettings,
+									VehicleWorldTransform.TransformPosition(SimplePhysicsVehicleFragment.VehicleSim.Setup().CenterOfMass),
+									TrailerWorldTransform.TransformPosition(TrailerSimplePhysicsVehicleFragment.VehicleSim.Setup().CenterOfMass),
+									VehicleWorldTransform.GetRotation() * SimplePhysicsVehicleFragment.VehicleSim.Setup().RotationOfMass,
+									TrailerWorldTransform.GetRotation() * TrailerSimplePhysicsVehicleFragment.VehicleSim.Setup().RotationOfMass,
+									SimplePhysicsVehicleFragment.VehicleSim.Setup().Mass > 0.0f ? 1.0f / SimplePhysicsVehicleFragment.VehicleSim.Setup().Mass : 0.0f,
+									SimplePhysicsVehicleFragment.VehicleSim.Setup().InverseMomentOfInertia,
+									TrailerSimplePhysicsVehicleFragment.VehicleSim.Setup().Mass > 0.0f ? 1.0f / TrailerSimplePhysicsVehicleFragment.VehicleSim.Setup().Mass : 0.0f,
+									TrailerSimplePhysicsVehicleFragment.VehicleSim.Setup().InverseMomentOfInertia,
+									Chaos::FRigidTransform3(SimplePhysicsVehicleFragment.VehicleSim.Setup().RotationOfMass.UnrotateVector(TrailerSimulationConfig.ConstraintSettings.MountPoint - SimplePhysicsVehicleFragment.VehicleSim.Setup().CenterOfMass), SimplePhysicsVehicleFragment.VehicleSim.Setup().RotationOfMass.Inverse()),
+									Chaos::FRigidTransform3(TrailerSimplePhysicsVehicleFragment.VehicleSim.Setup().RotationOfMass.UnrotateVector(TrailerSimulationConfig.ConstraintSettings.MountPoint - TrailerSimplePhysicsVehicleFragment.VehicleSim.Setup().CenterOfMass), TrailerSimplePhysicsVehicleFragment.VehicleSim.Setup().RotationOfMass.Inverse())
+								);
 							
-							// Suspension & trailer attachment constraints 
-							for (int Iteration = 0; Iteration < NumChaosConstraintSolverIterations; ++Iteration)
-							{
-								// Vehicle suspension constraints
-								SolveSuspensionConstraintsIteration(DeltaTime, SimplePhysicsVehicleFragment, VelocityFragment, AngularVelocityFragment, TransformFragment, VehicleWorldTransform, SuspensionTargets, bVisLog);
+								// Suspension & trailer attachment constraints 
+								for (int Iteration = 0; Iteration < NumChaosConstraintSolverIterations; ++Iteration)
+								{
+									// Vehicle suspension constraints
+									SolveSuspensionConstraintsIteration(DeltaTime, SimplePhysicsVehicleFragment, VelocityFragment, AngularVelocityFragment, TransformFragment, VehicleWorldTransform, SuspensionTargets, bVisLog);
 								
-								// Trailer suspension constraints
-								SolveSuspensionConstraintsIteration(DeltaTime, TrailerSimplePhysicsVehicleFragment, TrailerVelocityFragment, TrailerAngularVelocityFragment, TrailerTransformFragment, TrailerWorldTransform, TrailerSuspensionTargets, bVisLog);
+									// Trailer suspension constraints
+									SolveSuspensionConstraintsIteration(DeltaTime, TrailerSimplePhysicsVehicleFragment, TrailerVelocityFragment, TrailerAngularVelocityFragment, TrailerTransformFragment, TrailerWorldTransform, TrailerSuspensionTargets, bVisLog);
 					
-								// Trailer attachment constraint 
-								TrailerConstraintSolver.Update(
-									Iteration,
-									NumChaosConstraintSolverIterations, 
-									ChaosConstraintSolverSettings,
-									/*P0*/TransformFragment.GetTransform().TransformPositionNoScale(SimplePhysicsVehicleFragment.VehicleSim.Setup().CenterOfMass),
-									/*Q0*/TransformFragment.GetTransform().GetRotation() * SimplePhysicsVehicleFragment.VehicleSim.Setup().RotationOfMass,
-									/*V0*/VelocityFragment.Value,
-									/*W0*/AngularVelocityFragment.AngularVelocity,
-									/*P1*/TrailerTransformFragment.GetTransform().TransformPositionNoScale(TrailerSimplePhysicsVehicleFragment.VehicleSim.Setup().CenterOfMass),
-									/*Q1*/TrailerTransformFragment.GetTransform().GetRotation() * TrailerSimplePhysicsVehicleFragment.VehicleSim.Setup().RotationOfMass,
-									/*V1*/TrailerVelocityFragment.Value,
-									/*W1*/TrailerAngularVelocityFragment.AngularVelocity
-								);
+									// Trailer attachment constraint 
+									TrailerConstraintSolver.Update(
+										Iteration,
+										NumChaosConstraintSolverIterations, 
+										ChaosConstraintSolverSettings,
+										/*P0*/TransformFragment.GetTransform().TransformPositionNoScale(SimplePhysicsVehicleFragment.VehicleSim.Setup().CenterOfMass),
+										/*Q0*/TransformFragment.GetTransform().GetRotation() * SimplePhysicsVehicleFragment.VehicleSim.Setup().RotationOfMass,
+										/*V0*/VelocityFragment.Value,
+										/*W0*/AngularVelocityFragment.AngularVelocity,
+										/*P1*/TrailerTransformFragment.GetTransform().TransformPositionNoScale(TrailerSimplePhysicsVehicleFragment.VehicleSim.Setup().CenterOfMass),
+										/*Q1*/TrailerTransformFragment.GetTransform().GetRotation() * TrailerSimplePhysicsVehicleFragment.VehicleSim.Setup().RotationOfMass,
+										/*V1*/TrailerVelocityFragment.Value,
+										/*W1*/TrailerAngularVelocityFragment.AngularVelocity
+									);
 								
-								if (TrailerConstraintSolver.GetIsActive())
-								{
-									TrailerConstraintSolver.ApplyConstraints(DeltaTime, ChaosConstraintSolverSettings, TrailerSimulationConfig.ChaosJointSettings);
-										
-									if (!TrailerConstraintSolver.GetIsActive())
+									if (TrailerConstraintSolver.GetIsActive())
 									{
-										break;
-									}
+										TrailerConstraintSolver.ApplyConstraints(DeltaTime, ChaosConstraintSolverSettings, TrailerSimulationConfig.ChaosJointSettings);
+										
+										if (!TrailerConstraintSolver.GetIsActive())
+										{
+											break;
+										}
 					
-									// Set new constrained Center of Mass transform for vehicle & trailer
-									SetCoMWorldTransform(SimplePhysicsVehicleFragment, TransformFragment, TrailerConstraintSolver.GetP(0), TrailerConstraintSolver.GetQ(0));
-									SetCoMWorldTransform(TrailerSimplePhysicsVehicleFragment, TrailerTransformFragment, TrailerConstraintSolver.GetP(1), TrailerConstraintSolver.GetQ(1));
+										// Set new constrained Center of Mass transform for vehicle & trailer
+										SetCoMWorldTransform(SimplePhysicsVehicleFragment, TransformFragment, TrailerConstraintSolver.GetP(0), TrailerConstraintSolver.GetQ(0));
+										SetCoMWorldTransform(TrailerSimplePhysicsVehicleFragment, TrailerTransformFragment, TrailerConstraintSolver.GetP(1), TrailerConstraintSolver.GetQ(1));
+									}
 								}
-							}
 					
-							// Update speed & velocity of trailer
-							UpdateCoMVelocity(DeltaTime, TrailerSimplePhysicsVehicleFragment, TrailerTransformFragment, TrailerVelocityFragment, TrailerAngularVelocityFragment, TrailerWorldTransform);
+								// Update speed & velocity of trailer
+								UpdateCoMVelocity(DeltaTime, TrailerSimplePhysicsVehicleFragment, TrailerTransformFragment, TrailerVelocityFragment, TrailerAngularVelocityFragment, TrailerWorldTransform);
+							}
 						}
 					}
-				}
 				
-				// No trailer, we can just simulate our own suspension constraints by ourself
-				if (!bHasTrailer)
-				{
-
-					// Suspension Constraints
-					for (int Iteration = 0; Iteration < NumChaosConstraintSolverIterations; ++Iteration)
+					// No trailer, we can just simulate our own suspension constraints by ourself
+					if (!bHasTrailer)
 					{
-						SolveSuspensionConstraintsIteration(DeltaTime, SimplePhysicsVehicleFragment, VelocityFragment, AngularVelocityFragment, TransformFragment, VehicleWorldTransform, SuspensionTargets, bVisLog);
+
+						// Suspension Constraints
+						for (int Iteration = 0; Iteration < NumChaosConstraintSolverIterations; ++Iteration)
+						{
+							SolveSuspensionConstraintsIteration(DeltaTime, SimplePhysicsVehicleFragment, VelocityFragment, AngularVelocityFragment, TransformFragment, VehicleWorldTransform, SuspensionTargets, bVisLog);
+						}
 					}
-				}
 				
-				// Clamp vehicle position to limit deviation from RawLaneLocation
-				ClampLateralDeviation(TransformFragment, RawLaneLocationTransform);
+					// Clamp vehicle position to limit deviation from RawLaneLocation
+					ClampLateralDeviation(TransformFragment, RawLaneLocationTransform);
 
-				// Update velocity of vehicle
-				UpdateCoMVelocity(DeltaTime, SimplePhysicsVehicleFragment, TransformFragment, VelocityFragment, AngularVelocityFragment, VehicleWorldTransform);
+					// Update velocity of vehicle
+					UpdateCoMVelocity(DeltaTime, SimplePhysicsVehicleFragment, TransformFragment, VelocityFragment, AngularVelocityFragment, VehicleWorldTransform);
 
-				// Update speed from velocity 
-				VehicleControlFragment.Speed = VelocityFragment.Value.Size();
-			}
-		});
+					// Update speed from velocity 
+					VehicleControlFragment.Speed = VelocityFragment.Value.Size();
+				}
+			});
+		}
 	}
 }
 
@@ -27,6 +27,12 @@ EMassActorSpawnRequestAction UMassTrafficVehicleRepresentationActorManagement::O
 	UMassRepresentationSubsystem* RepresentationSubsystem = EntityView.GetSharedFragmentData<FMassRepresentationSubsystemSharedFragment>().RepresentationSubsystem;
 	check(RepresentationSubsystem);
 	
+	// Resolve the components visualization updates every frame, once
+	if (FMassTrafficVehicleActorComponentsFragment* ActorComponentsFragment = EntityView.GetFragmentDataPtr<FMassTrafficVehicleActorComponentsFragment>())
+	{
+		ActorComponentsFragment->Resolve(*MassActorSpawnRequest.SpawnedActor);
+	}
+
 	FMassRepresentationFragment& RepresentationFragment = EntityView.GetFragmentData<FMassRepresentationFragment>();
 	if (RepresentationFragment.HighResTemplateActorIndex != INDEX_NONE && RepresentationSubsystem->DoesActorMatchTemplate(*MassActorSpawnRequest.SpawnedActor, RepresentationFragment.HighResTemplateActorIndex))
 	{
@@ -51,7 +57,8 @@ void UMassTrafficVehicleRepresentationActorManagement::InitLowResActor(AActor& L
 	const FMassTrafficVehiclePhysicsFragment* SimpleVehiclePhysicsFragment = EntityView.GetFragmentDataPtr<FMassTrafficVehiclePhysicsFragment>();
 	if (SimpleVehiclePhysicsFragment)
 	{
-		UMassTrafficVehicleComponent* MassTrafficVehicleComponent = LowResActor.FindComponentByClass<UMassTrafficVehicleComponent>();
+		const FMassTrafficVehicleActorComponentsFragment* ActorComponentsFragment = EntityView.GetFragmentDataPtr<FMassTrafficVehicleActorComponentsFragment>();
+		UMassTrafficVehicleComponent* MassTrafficVehicleComponent = ActorComponentsFragment ? ActorComponentsFragment->VehicleComponent.Get() : LowResActor.FindComponentByClass<UMassTrafficVehicleComponent>();
 		if (MassTrafficVehicleComponent)
 		{
 			// Init offsets?
@@ -2,6 +2,7 @@
 
 #include "MassTrafficVehicleSimulationLODProcessor.h"
 #include "MassTraffic.h"
+#include "MassTrafficSubsystem.h"
 
 #include "VisualLogger/VisualLogger.h"
 #include "DrawDebugHelpers.h"
@@ -171,7 +172,10 @@ void UMassTrafficVehicleSimulationLODProcessor::Execute(FMassEntityManager& Enti
 		TRACE_CPUPROFILER_EVENT_SCOPE(TEXT("VariableTickRates"))
 		
 		check(World);
-		const float Time = World->GetTimeSeconds();
+
+		// Variable tick rates accumulate simulation time, which only advances in whole steps with a fixed timestep
+		const UMassTrafficSubsystem* MassTrafficSubsystem = World->GetSubsystem<UMassTrafficSubsystem>();
+		const float Time = MassTrafficSubsystem && MassTrafficSubsystem->GetSimulationClock().bFixedTimestep ? MassTrafficSubsystem->GetSimulationClock().SimulationTime : World->GetTimeSeconds();
 		EntityQueryVariableTick.ForEachEntityChunk(EntityManager, Context, [this, Time](FMassExecutionContext& QueryContext)
 		{
 			FMassSimulationVariableTickSharedFragment& TickRateSharedFragment = QueryContext.GetMutableSharedFragment<FMassSimulationVariableTickSharedFragment>();
@@ -55,6 +55,7 @@ void UMassTrafficVehicleSimulationTrait::BuildTemplate(FMassEntityTemplateBuildC
 	// Variable tick
 	BuildContext.AddFragment<FMassSimulationVariableTickFragment>();
 	BuildContext.AddChunkFragment<FMassSimulationVariableTickChunkFragment>();
+	BuildContext.AddChunkFragment<FMassTrafficValidationChunkFragment>();
 
 	const FConstSharedStruct VariableTickParamsFragment = EntityManager.GetOrCreateConstSharedFragment(VariableTickParams);
 	BuildContext.AddConstSharedFragment(VariableTickParamsFragment);
@@ -71,7 +72,9 @@ void UMassTrafficVehicleSimulationTrait::BuildTemplate(FMassEntityTemplateBuildC
 	BuildContext.AddFragment<FMassTrafficLaneOffsetFragment>();
 	BuildContext.AddFragment<FMassTrafficNextVehicleFragment>();
 	BuildContext.AddFragment<FMassTrafficObstacleAvoidanceFragment>();	
+	BuildContext.AddFragment<FMassTrafficPreviousTransformFragment>();
 	BuildContext.RequireFragment<FMassTrafficRandomFractionFragment>();
+	BuildContext.AddFragment<FMassTrafficVehicleIdFragment>();
 	BuildContext.AddFragment<FMassTrafficVehicleLaneChangeFragment>();	
 	BuildContext.RequireFragment<FMassTrafficVehicleLightsFragment>();
 	BuildContext.AddFragment<FMassVelocityFragment>();
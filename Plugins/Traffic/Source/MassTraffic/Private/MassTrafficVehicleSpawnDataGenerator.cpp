@@ -9,11 +9,13 @@
 #include "MassTrafficInitInterpolationProcessor.h"
 #include "MassTrafficInitTrafficVehicleSpeedProcessor.h"
 #include "MassTrafficInitTrafficVehiclesProcessor.h"
+#include "MassTrafficSpawnPointCache.h"
 #include "MassTrafficSubsystem.h"
 #include "MassTrafficUpdateDistanceToNearestObstacleProcessor.h"
 #include "MassTrafficUpdateVelocityProcessor.h"
 #include "MassTrafficUtils.h"
 
+#include "Async/ParallelFor.h"
 #include "ZoneGraphSubsystem.h"
 #include "ZoneGraphQuery.h"
 
@@ -35,6 +37,7 @@ void UMassTrafficVehicleSpawnDataGenerator::Generate(UObject& QueryOwner,
 
 	// Seed random stream
 	FRandomStream RandomStream;
+	bool bSeeded = true;
 	if (RandomSeed > 0)
 	{
 		RandomStream.Initialize(RandomSeed);
@@ -46,6 +49,7 @@ void UMassTrafficVehicleSpawnDataGenerator::Generate(UObject& QueryOwner,
 	else
 	{
 		RandomStream.GenerateNewSeed();
+		bSeeded = false;
 	}
 
 	// Scale vehicle spawn count
@@ -107,69 +111,119 @@ void UMassTrafficVehicleSpawnDataGenerator::Generate(UObject& QueryOwner,
 	TArray<FVector> ObstacleLocationsToAvoid;
 	MassTrafficSubsystem->GetAllObstacleLocations(ObstacleLocationsToAvoid);
 
+	// Filter locations to ensure we don't spawn near obstacles (player)
+	const UE::MassTraffic::FObstacleExclusionGrid ObstacleExclusionGrid(ObstacleLocationsToAvoid, ObstacleExclusionRadius);
+	auto LaneLocationFilterFunction = [&](const FZoneGraphLaneLocation& LaneLocation)
+	{
+		return !ObstacleExclusionGrid.IsNearObstacle(LaneLocation.Position);
+	};
+
+	// Everything but the ZoneGraph data that lane points depend on, to key the spawn point cache with
+	uint32 SettingsHash = GetTypeHash(RandomStream.GetCurrentSeed());
+	SettingsHash = HashCombine(SettingsHash, GetTypeHash(MinGapBetweenSpaces));
+	SettingsHash = HashCombine(SettingsHash, GetTypeHash(MaxGapBetweenSpaces));
+	SettingsHash = HashCombine(SettingsHash, UE::MassTraffic::GetZoneGraphTagFilterHash(MassTrafficSettings->TrafficLaneFilter));
+	for (const FMassTrafficLaneDensity& LaneDensity : MassTrafficSettings->LaneDensities)
+	{
+		SettingsHash = HashCombine(SettingsHash, UE::MassTraffic::GetZoneGraphTagFilterHash(LaneDensity.LaneFilter));
+		SettingsHash = HashCombine(SettingsHash, GetTypeHash(LaneDensity.DensityMultiplier));
+	}
+	for (const FMassTrafficVehicleSpacing& Spacing : DefaultAndVehicleTypeSpacings)
+	{
+		SettingsHash = HashCombine(SettingsHash, GetTypeHash(Spacing.Space));
+		SettingsHash = HashCombine(SettingsHash, GetTypeHash(Spacing.Proportion));
+		SettingsHash = HashCombine(SettingsHash, UE::MassTraffic::GetZoneGraphTagFilterHash(Spacing.LaneFilter));
+	}
+
 	// Find potential spawn points.
 	TArray<TArray<FZoneGraphLaneLocation>> SpawnPointsPerSpacing;
+	SpawnPointsPerSpacing.SetNum(DefaultAndVehicleTypeSpacings.Num());
 	for (const FMassTrafficZoneGraphData& TrafficZoneGraphData : MassTrafficSubsystem->GetTrafficZoneGraphData())
 	{
 		const FZoneGraphStorage* ZoneGraphStorage = ZoneGraphSubsystem->GetZoneGraphStorage(TrafficZoneGraphData.DataHandle);
 		check(ZoneGraphStorage);
 
-		// Filter lanes to ensure we never spawn on merging or splitting lanes
-		auto LaneFilterFunction = [&](const FZoneGraphStorage&, int32 LaneIndex)
+		// Spawn points on each ZoneGraph data are generated from its own random stream, so they can be cached
+		// independently of the other ZoneGraph data
+		const uint32 ZoneGraphStorageHash = UE::MassTraffic::GetZoneGraphStorageHash(*ZoneGraphStorage);
+		const FRandomStream ZoneGraphRandomStream(static_cast<int32>(HashCombine(GetTypeHash(RandomStream.GetCurrentSeed()), ZoneGraphStorageHash)));
+
+		// Try the cache first
+		const bool bUseCache = bCacheSpawnPoints && bSeeded;
+		const uint32 CacheKey = HashCombine(SettingsHash, ZoneGraphStorageHash);
+		const FString CacheFilename = UE::MassTraffic::GetSpawnPointCacheFilename(TEXT("TrafficVehicles"), CacheKey);
+		TArray<TArray<FZoneGraphLaneLocation>> ZoneGraphSpawnPointsPerSpacing;
+		if (!bUseCache || !UE::MassTraffic::LoadSpawnPointCache(CacheFilename, CacheKey, *ZoneGraphStorage, ZoneGraphSpawnPointsPerSpacing))
 		{
-			// Make sure we have traffic lane data
-			const FZoneGraphTrafficLaneData* TrafficLaneData = TrafficZoneGraphData.GetTrafficLaneData(LaneIndex);
-			if (!TrafficLaneData)
+			// Filter lanes to ensure we never spawn on merging or splitting lanes
+			auto LaneFilterFunction = [&](const FZoneGraphStorage&, int32 LaneIndex)
+			{
+				// Make sure we have traffic lane data
+				const FZoneGraphTrafficLaneData* TrafficLaneData = TrafficZoneGraphData.GetTrafficLaneData(LaneIndex);
+				if (!TrafficLaneData)
+				{
+					return false;
+				}
+				
+				// We don't want to spawn on merging or splitting lanes, since vehicles can actually end up overlapping
+				// where the lanes get close together.
+				if (TrafficLaneData->MergingLanes.Num() > 0 || TrafficLaneData->SplittingLanes.Num() > 0)
+				{
+					return false;
+				}
+					
+				return true;
+			};
+
+			// Find the non-overlapping spawn point candidates - for each unique vehicle type spacing. Obstacles move
+			// between runs, so aren't filtered here but below, after caching.
+			const bool bFoundPoints = FindNonOverlappingLanePoints(
+				*ZoneGraphStorage,
+				MassTrafficSettings->TrafficLaneFilter, 
+				MassTrafficSettings->LaneDensities,
+				ZoneGraphRandomStream,
+				DefaultAndVehicleTypeSpacings,
+				MinGapBetweenSpaces,
+				MaxGapBetweenSpaces,
+				/*Out*/ZoneGraphSpawnPointsPerSpacing,
+				/*bShufflePoints*/false,
+				LaneFilterFunction);
+			if (!bFoundPoints)
 			{
-				return false;
+				UE_LOG(LogMassTraffic, Error, TEXT("%s - Could not find non-overlapping points to spawn on - abandoning traffic vehicle spawning"), ANSI_TO_TCHAR(__FUNCTION__));
+				return;
 			}
-			
-			// We don't want to spawn on merging or splitting lanes, since vehicles can actually end up overlapping
-			// where the lanes get close together.
-			if (TrafficLaneData->MergingLanes.Num() > 0 || TrafficLaneData->SplittingLanes.Num() > 0)
+
+			if (bUseCache)
 			{
-				return false;
+				UE::MassTraffic::SaveSpawnPointCache(CacheFilename, CacheKey, ZoneGraphSpawnPointsPerSpacing);
 			}
-				
-			return true;
-		};
+		}
 
-		// Filter locations to ensure we don't spawn near obstacles (player)
-		const float ObstacleRadiusSquared = FMath::Square(ObstacleExclusionRadius);
-		auto LaneLocationFilterFunction = [&](const FZoneGraphLaneLocation& LaneLocation)
+		// Add the points away from obstacles
+		check(ZoneGraphSpawnPointsPerSpacing.Num() == SpawnPointsPerSpacing.Num());
+		for (int32 SpacingIndex = 0; SpacingIndex < SpawnPointsPerSpacing.Num(); ++SpacingIndex)
 		{
-			// Make sure there are no obstacles.
-			// !This won't scale past very few obstacles!
-			for (const FVector & ObstacleLocation : ObstacleLocationsToAvoid)
+			for (const FZoneGraphLaneLocation& LaneLocation : ZoneGraphSpawnPointsPerSpacing[SpacingIndex])
 			{
-				if (FVector::DistSquared(LaneLocation.Position, ObstacleLocation) < ObstacleRadiusSquared)
+				if (LaneLocationFilterFunction(LaneLocation))
 				{
-					return false;
+					SpawnPointsPerSpacing[SpacingIndex].Add(LaneLocation);
 				}
 			}
+		}
+	}
 
-			return true;
-		};
-		
-		// Find the non-overlapping spawn point candidates - for each unique vehicle type spacing.
-		const bool bFoundPoints = FindNonOverlappingLanePoints(
-			*ZoneGraphStorage,
-			GetDefault<UMassTrafficSettings>()->TrafficLaneFilter, 
-			GetDefault<UMassTrafficSettings>()->LaneDensities,
-			RandomStream,
-			DefaultAndVehicleTypeSpacings,
-			MinGapBetweenSpaces,
-			MaxGapBetweenSpaces,
-			/*Out*/SpawnPointsPerSpacing,
-			/*bShufflePoints*/true,
-			LaneFilterFunction, LaneLocationFilterFunction);
-		if (!bFoundPoints)
+	// Shuffle points across all ZoneGraph data
+	for (TArray<FZoneGraphLaneLocation>& SpawnPoints : SpawnPointsPerSpacing)
+	{
+		for (int32 I = 0; I < SpawnPoints.Num(); ++I)
 		{
-			UE_LOG(LogMassTraffic, Error, TEXT("%s - Could not find non-overlapping points to spawn on - abandoning traffic vehicle spawning"), ANSI_TO_TCHAR(__FUNCTION__));
-			return;
+			const int32 J = RandomStream.RandHelper(SpawnPoints.Num());
+			SpawnPoints.Swap(I, J);
 		}
 	}
-	if (SpawnPointsPerSpacing.IsEmpty())
+	if (MassTrafficSubsystem->GetTrafficZoneGraphData().Num() == 0)
 	{
 		UE_LOG(LogMassTraffic, Error, TEXT("%s - Could not find non-overlapping points to spawn on - abandoning traffic vehicle spawning"), ANSI_TO_TCHAR(__FUNCTION__));
 		return;
@@ -311,15 +365,27 @@ bool UMassTrafficVehicleSpawnDataGenerator::FindNonOverlappingLanePoints(
 	}
 	
 	
-	// Loop lanes.
+	// Loop lanes, in parallel.
 	{
+		TRACE_CPUPROFILER_EVENT_SCOPE(TEXT("FindLanePoints"))
+
 		// Prepare discrete random stream to pull spacing choices from.
 		const UE::MassTraffic::TDiscreteRandomStream VehicleTypeSpacingDiscreteRandomStream(SpacingProportions);
 
+		// Each lane gets its own random substream, derived from the lane index rather than the order lanes happen to be
+		// processed in, so results are deterministic however the lanes are spread across threads.
+		const uint32 LaneSeedBase = static_cast<uint32>(RandomStream.GetCurrentSeed());
+
+		// Points found on each lane, as (vehicle type spacing index, location) pairs
+		TArray<TArray<TPair<int32, FZoneGraphLaneLocation>>> PointsPerLane;
+		PointsPerLane.SetNum(LaneIndices.Num());
+
 		// Go through all lanes we have chosen to work on.
-		for (int32 LaneIndexIndex = 0; LaneIndexIndex < LaneIndices.Num(); ++LaneIndexIndex)
+		ParallelFor(LaneIndices.Num(), [&](const int32 LaneIndexIndex)
 		{
 			const int32 LaneIndex = LaneIndices[LaneIndexIndex];
+			const FRandomStream LaneRandomStream(static_cast<int32>(HashCombine(LaneSeedBase, GetTypeHash(LaneIndex))));
+			TArray<TPair<int32, FZoneGraphLaneLocation>>& LanePoints = PointsPerLane[LaneIndexIndex];
 
 			float LaneLength = 0.0f;
 			UE::ZoneGraph::Query::GetLaneLength(ZoneGraphStorage, LaneIndex, LaneLength);
@@ -344,7 +410,7 @@ bool UMassTrafficVehicleSpawnDataGenerator::FindNonOverlappingLanePoints(
 				if (DensityMultiplier <= 0.0f)
 				{
 					// Continue to next lane, no spaces generated on this lane
-					continue;  
+					return;  
 				}
 
 				SpacingScale = 1.0f / DensityMultiplier;
@@ -354,7 +420,7 @@ bool UMassTrafficVehicleSpawnDataGenerator::FindNonOverlappingLanePoints(
 			auto ChooseVehicleTypeSpacingIndex = [&]() -> int32
 			{
 				// Pick a unique vehicle spacing index.
-				int32 VehicleTypeSpacingIndex = VehicleTypeSpacingDiscreteRandomStream.RandChoice(RandomStream);
+				int32 VehicleTypeSpacingIndex = VehicleTypeSpacingDiscreteRandomStream.RandChoice(LaneRandomStream);
 
 				const int32 NumSpacings = Spacings.Num();
 				for (int32 I = 0; I < NumSpacings; I++)
@@ -382,7 +448,7 @@ bool UMassTrafficVehicleSpawnDataGenerator::FindNonOverlappingLanePoints(
 
 			
 			// Allocate points along the lane, starting at 0
-			for (float Distance = RandomStream.FRandRange(MinGapBetweenSpaces, MaxGapBetweenSpaces); Distance < LaneLength; /*see end of block*/)
+			for (float Distance = LaneRandomStream.FRandRange(MinGapBetweenSpaces, MaxGapBetweenSpaces); Distance < LaneLength; /*see end of block*/)
 			{
 				const int32 VehicleTypeSpacingIndex = ChooseVehicleTypeSpacingIndex();
 				if (VehicleTypeSpacingIndex == INDEX_NONE)
@@ -401,12 +467,21 @@ bool UMassTrafficVehicleSpawnDataGenerator::FindNonOverlappingLanePoints(
 					if (!LaneLocationFilterFunction || LaneLocationFilterFunction(LaneLocation))
 					{
 						// Passed filter, add location
-						OutSpawnPointsPerSpacing[VehicleTypeSpacingIndex].Add(LaneLocation);
+						LanePoints.Emplace(VehicleTypeSpacingIndex, LaneLocation);
 					}
 				}
 				
 				// Advance ahead past the space we just consumed, plus a random gap.
-				Distance += VehicleTypeSpacing.Space * SpacingScale + RandomStream.FRandRange(MinGapBetweenSpaces, MaxGapBetweenSpaces);
+				Distance += VehicleTypeSpacing.Space * SpacingScale + LaneRandomStream.FRandRange(MinGapBetweenSpaces, MaxGapBetweenSpaces);
+			}
+		});
+
+		// Gather points in lane order
+		for (const TArray<TPair<int32, FZoneGraphLaneLocation>>& LanePoints : PointsPerLane)
+		{
+			for (const TPair<int32, FZoneGraphLaneLocation>& LanePoint : LanePoints)
+			{
+				OutSpawnPointsPerSpacing[LanePoint.Key].Add(LanePoint.Value);
 			}
 		}
 	}
@@ -1,6 +1,7 @@
 // Copyright Epic Games, Inc. All Rights Reserved.
 
 #include "MassTrafficVehicleVisualizationProcessor.h"
+#include "MassTrafficActorUpdateBatch.h"
 #include "MassTrafficVehicleComponent.h"
 #include "MassTrafficSubsystem.h"
 #include "MassTrafficDamageRepairProcessor.h"
@@ -203,12 +204,16 @@ void UMassTrafficVehicleUpdateCustomVisualizationProcessor::ConfigureQueries()
 	EntityQuery.AddRequirement<FMassRepresentationFragment>(EMassFragmentAccess::ReadWrite);
 	EntityQuery.AddRequirement<FMassRepresentationLODFragment>(EMassFragmentAccess::ReadOnly);
 	EntityQuery.AddRequirement<FMassActorFragment>(EMassFragmentAccess::ReadWrite);
+	EntityQuery.AddRequirement<FMassTrafficVehicleActorComponentsFragment>(EMassFragmentAccess::ReadWrite);
 	EntityQuery.AddChunkRequirement<FMassVisualizationChunkFragment>(EMassFragmentAccess::ReadWrite);
 	EntityQuery.AddSharedRequirement<FMassRepresentationSubsystemSharedFragment>(EMassFragmentAccess::ReadWrite);
 
 	EntityQuery.AddRequirement<FMassTrafficRandomFractionFragment>(EMassFragmentAccess::ReadOnly);
 	EntityQuery.AddRequirement<FMassTrafficVehicleLightsFragment>(EMassFragmentAccess::ReadOnly);
 	EntityQuery.AddRequirement<FMassTrafficVehiclePhysicsFragment>(EMassFragmentAccess::ReadOnly, EMassFragmentPresence::Optional);
+	EntityQuery.AddRequirement<FMassTrafficPreviousTransformFragment>(EMassFragmentAccess::ReadOnly, EMassFragmentPresence::Optional);
+
+	ProcessorRequirements.AddSubsystemRequirement<UMassTrafficSubsystem>(EMassFragmentAccess::ReadWrite);
 
 #if WITH_MASSTRAFFIC_DEBUG
 	DebugEntityQuery = EntityQuery;
@@ -220,7 +225,21 @@ void UMassTrafficVehicleUpdateCustomVisualizationProcessor::ConfigureQueries()
 
 void UMassTrafficVehicleUpdateCustomVisualizationProcessor::Execute(FMassEntityManager& EntityManager, FMassExecutionContext& Context)
 {
-	EntityQuery.ForEachEntityChunk(EntityManager, Context, [this](FMassExecutionContext& Context)
+	UMassTrafficSubsystem& MassTrafficSubsystem = Context.GetMutableSubsystemChecked<UMassTrafficSubsystem>(EntityManager.GetWorld());
+	const FMassTrafficSimulationClock& SimulationClock = MassTrafficSubsystem.GetSimulationClock();
+
+	FMassTrafficMovingInstances& MovingInstances = MassTrafficSubsystem.GetMutableTrafficVehicleMovingInstances();
+	const bool bUseMovingInstances = GMassTrafficStaticInstances != 0;
+	if (bUseMovingInstances)
+	{
+		MovingInstances.BeginUpdate(*EntityManager.GetWorld());
+	}
+	else if (MovingInstances.Num() > 0)
+	{
+		MovingInstances.Reset();
+	}
+
+	EntityQuery.ForEachEntityChunk(EntityManager, Context, [this, &SimulationClock, &MovingInstances, bUseMovingInstances](FMassExecutionContext& Context)
 	{
 		// Get mutable ISMInfos to append instances & custom data to
 		UMassRepresentationSubsystem* RepresentationSubsystem = Context.GetMutableSharedFragment<FMassRepresentationSubsystemSharedFragment>().RepresentationSubsystem;
@@ -231,8 +250,10 @@ void UMassTrafficVehicleUpdateCustomVisualizationProcessor::Execute(FMassEntityM
 		const TConstArrayView<FMassTrafficVehiclePhysicsFragment> SimpleVehiclePhysicsFragments = Context.GetFragmentView<FMassTrafficVehiclePhysicsFragment>();
 		const TConstArrayView<FMassTrafficVehicleLightsFragment> VehicleStateFragments = Context.GetFragmentView<FMassTrafficVehicleLightsFragment>();
 		const TConstArrayView<FTransformFragment> TransformFragments = Context.GetFragmentView<FTransformFragment>();
+		const TConstArrayView<FMassTrafficPreviousTransformFragment> PreviousTransformFragments = Context.GetFragmentView<FMassTrafficPreviousTransformFragment>();
 		const TConstArrayView<FMassRepresentationLODFragment> RepresentationLODFragments = Context.GetFragmentView<FMassRepresentationLODFragment>();
 		const TArrayView<FMassActorFragment> ActorFragments = Context.GetMutableFragmentView<FMassActorFragment>();
+		const TArrayView<FMassTrafficVehicleActorComponentsFragment> ActorComponentsFragments = Context.GetMutableFragmentView<FMassTrafficVehicleActorComponentsFragment>();
 		const TArrayView<FMassRepresentationFragment> VisualizationFragments = Context.GetMutableFragmentView<FMassRepresentationFragment>();
 
 		const int32 NumEntities = Context.GetNumEntities();
@@ -245,9 +266,14 @@ void UMassTrafficVehicleUpdateCustomVisualizationProcessor::Execute(FMassEntityM
 			const FTransformFragment& TransformFragment = TransformFragments[EntityIdx];
 			const FMassRepresentationLODFragment& RepresentationLODFragment = RepresentationLODFragments[EntityIdx];
 			FMassActorFragment& ActorFragment = ActorFragments[EntityIdx];
+			FMassTrafficVehicleActorComponentsFragment& ActorComponentsFragment = ActorComponentsFragments[EntityIdx];
 			FMassRepresentationFragment& RepresentationFragment = VisualizationFragments[EntityIdx];
 
 			AActor* Actor = ActorFragment.GetMutable();
+
+			// Interpolate between fixed timestep simulation states
+			const FTransform VisualTransform = PreviousTransformFragments.IsEmpty() ? TransformFragment.GetTransform() :
+				SimulationClock.GetInterpolatedTransform(PreviousTransformFragments[EntityIdx].Transform, PreviousTransformFragments[EntityIdx].Step, TransformFragment.GetTransform());
 			
 			// Update active representation
 			{
@@ -259,10 +285,16 @@ void UMassTrafficVehicleUpdateCustomVisualizationProcessor::Execute(FMassEntityM
 						// Add ISMC instance with custom data
 						if (RepresentationFragment.StaticMeshDescIndex != INDEX_NONE)
 						{
-							ISMInfo[RepresentationFragment.StaticMeshDescIndex].AddBatchedTransform(GetTypeHash(Entity), TransformFragment.GetTransform(), RepresentationFragment.PrevTransform, RepresentationLODFragment.LODSignificance);
-
 							const FMassTrafficPackedVehicleInstanceCustomData PackedCustomData = FMassTrafficVehicleInstanceCustomData::MakeTrafficVehicleCustomData(VehicleStateFragment, RandomFractionFragment);
-							ISMInfo[RepresentationFragment.StaticMeshDescIndex].AddBatchedCustomData(PackedCustomData, RepresentationLODFragment.LODSignificance);
+							if (bUseMovingInstances)
+							{
+								MovingInstances.AddInstance(RepresentationFragment.StaticMeshDescIndex, ISMInfo[RepresentationFragment.StaticMeshDescIndex].GetDesc(), VisualTransform, RepresentationLODFragment.LODSignificance, PackedCustomData);
+							}
+							else
+							{
+								ISMInfo[RepresentationFragment.StaticMeshDescIndex].AddBatchedTransform(GetTypeHash(Entity), VisualTransform, RepresentationFragment.PrevTransform, RepresentationLODFragment.LODSignificance);
+								ISMInfo[RepresentationFragment.StaticMeshDescIndex].AddBatchedCustomData(PackedCustomData, RepresentationLODFragment.LODSignificance);
+							}
 						}
 						break;
 					}
@@ -273,53 +305,26 @@ void UMassTrafficVehicleUpdateCustomVisualizationProcessor::Execute(FMassEntityM
 
 						if (Actor)
 						{
+							// Components are resolved when the actor is spawned, but actors can also be swapped in
+							// from elsewhere (e.g: pooled), in which case resolve them now
+							ActorComponentsFragment.Resolve(*Actor);
+
 							// Teleport actor to simulated position
-							const FTransform NewActorTransform = TransformFragment.GetTransform();
-							Context.Defer().PushCommand<FMassDeferredSetCommand>([Actor, NewActorTransform](FMassEntityManager& System)
-							{
-								Actor->SetActorTransform(NewActorTransform);
-							});
+							ActorUpdateBatch.AddActorTransform(*Actor, VisualTransform);
 						
-							// Has simple vehicle physics?
+							// Has simple vehicle physics & a UMassTrafficVehicleComponent with wheel mesh references?
 							if (!SimpleVehiclePhysicsFragments.IsEmpty())
 							{
-								// Has a UMassTrafficVehicleComponent with wheel mesh references? 
-								UMassTrafficVehicleComponent* MassTrafficVehicleComponent = Actor->FindComponentByClass<UMassTrafficVehicleComponent>();
-								if (MassTrafficVehicleComponent)
+								if (UMassTrafficVehicleComponent* MassTrafficVehicleComponent = ActorComponentsFragment.VehicleComponent.Get())
 								{
 									// Update wheel component transforms from simple vehicle physics sim
-									Context.Defer().PushCommand<FMassDeferredSetCommand>([MassTrafficVehicleComponent, Entity](FMassEntityManager& CallbackEntitySubsystem)
-									{
-										if (CallbackEntitySubsystem.IsEntityValid(Entity))
-										{
-											// If the simulation LOD changed this frame, removal of the
-											// FDataFragment_SimpleVehiclePhysics would have been queued and executed 
-											// before this deferred command, thus actually removing the fragment we
-											// thought we had via the check above. So we safely check again here for
-											// FDataFragment_SimpleVehiclePhysics using an FMassEntityView
-											const FMassTrafficVehiclePhysicsFragment* SimpleVehiclePhysicsFragment = CallbackEntitySubsystem.GetFragmentDataPtr<FMassTrafficVehiclePhysicsFragment>(Entity);
-											if (SimpleVehiclePhysicsFragment)
-											{
-												// Init offsets?
-												if (MassTrafficVehicleComponent->WheelOffsets.IsEmpty())
-												{
-													MassTrafficVehicleComponent->InitWheelAttachmentOffsets(SimpleVehiclePhysicsFragment->VehicleSim);
-												}
-								
-												// Update
-												MassTrafficVehicleComponent->UpdateWheelComponents(SimpleVehiclePhysicsFragment->VehicleSim);
-											}
-										}
-									});
+									ActorUpdateBatch.AddWheelUpdate(*MassTrafficVehicleComponent, Entity);
 								}
 							}
 						
 							// Update primitive component custom data
 							const FMassTrafficPackedVehicleInstanceCustomData PackedCustomData = FMassTrafficVehicleInstanceCustomData::MakeTrafficVehicleCustomData(VehicleStateFragment, RandomFractionFragment);
-							Actor->ForEachComponent<UPrimitiveComponent>(/*bIncludeFromChildActors*/true, [&PackedCustomData](UPrimitiveComponent* PrimitiveComponent)
-							{
-								PrimitiveComponent->SetCustomPrimitiveDataFloat(/*DataIndex*/1, PackedCustomData.PackedParam1);
-							});
+							ActorComponentsFragment.SetCustomPrimitiveDataFloat(/*DataIndex*/1, PackedCustomData.PackedParam1);
 						}
 
 						break;
@@ -331,12 +336,11 @@ void UMassTrafficVehicleUpdateCustomVisualizationProcessor::Execute(FMassEntityM
 						// We should always have an Actor if CurrentRepresentation is HighResSpawnedActor   
 						if (Actor)
 						{
+							ActorComponentsFragment.Resolve(*Actor);
+
 							// Update primitive component custom data
 							const FMassTrafficPackedVehicleInstanceCustomData PackedCustomData = FMassTrafficVehicleInstanceCustomData::MakeTrafficVehicleCustomData(VehicleStateFragment, RandomFractionFragment);
-							Actor->ForEachComponent<UPrimitiveComponent>(/*bIncludeFromChildActors*/true, [&PackedCustomData](UPrimitiveComponent* PrimitiveComponent)
-							{
-								PrimitiveComponent->SetCustomPrimitiveDataFloat(/*DataIndex*/1, PackedCustomData.PackedParam1);
-							});
+							ActorComponentsFragment.SetCustomPrimitiveDataFloat(/*DataIndex*/1, PackedCustomData.PackedParam1);
 						}
 
 						break;
@@ -349,10 +353,18 @@ void UMassTrafficVehicleUpdateCustomVisualizationProcessor::Execute(FMassEntityM
 				}
 			}
 
-			RepresentationFragment.PrevTransform = TransformFragment.GetTransform();
+			RepresentationFragment.PrevTransform = VisualTransform;
 		}
 	});
 
+	if (bUseMovingInstances)
+	{
+		MovingInstances.EndUpdate();
+	}
+
+	// Apply this frame's actor transform & wheel updates together
+	ActorUpdateBatch.Defer(Context.Defer());
+
 #if WITH_MASSTRAFFIC_DEBUG
 	// Debug draw current visualization
 	if (GMassTrafficDebugVisualization && LogOwner.IsValid())
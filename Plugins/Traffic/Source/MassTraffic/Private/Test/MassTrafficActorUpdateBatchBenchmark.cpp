@@ -0,0 +1,153 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "Misc/AutomationTest.h"
+
+#include "MassTrafficActorUpdateBatch.h"
+#include "MassTrafficFragments.h"
+#include "MassTrafficPhysics.h"
+#include "MassTrafficVehicleComponent.h"
+
+#include "Components/StaticMeshComponent.h"
+#include "Engine/Engine.h"
+#include "Engine/World.h"
+#include "GameFramework/Actor.h"
+#include "HAL/PlatformTime.h"
+#include "MassCommandBuffer.h"
+#include "MassEntityManager.h"
+
+namespace UE::MassTraffic::ActorUpdateBatchBenchmark
+{
+
+static constexpr int32 NumWheels = 4;
+static constexpr int32 NumFrames = 100;
+static const int32 NumVehiclesToTest[] = { 50, 100, 200, 400, 800 };
+
+/** Actor with the same kind of components a low res traffic vehicle actor has. */
+static AActor* SpawnVehicleActor(UWorld& World)
+{
+	AActor* Actor = World.SpawnActor<AActor>();
+
+	USceneComponent* RootComponent = NewObject<USceneComponent>(Actor);
+	Actor->SetRootComponent(RootComponent);
+	RootComponent->RegisterComponent();
+
+	UStaticMeshComponent* BodyComponent = NewObject<UStaticMeshComponent>(Actor);
+	BodyComponent->SetupAttachment(RootComponent);
+	BodyComponent->RegisterComponent();
+
+	UMassTrafficVehicleComponent* VehicleComponent = NewObject<UMassTrafficVehicleComponent>(Actor);
+	for (int32 WheelIndex = 0; WheelIndex < NumWheels; ++WheelIndex)
+	{
+		UStaticMeshComponent* WheelComponent = NewObject<UStaticMeshComponent>(Actor);
+		WheelComponent->SetupAttachment(RootComponent);
+		WheelComponent->RegisterComponent();
+		VehicleComponent->WheelComponents.Add(WheelComponent);
+	}
+	VehicleComponent->RegisterComponent();
+
+	return Actor;
+}
+
+}
+
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FMassTrafficActorUpdateBatchBenchmark, "MassTraffic.Benchmark.ActorUpdates", EAutomationTestFlags::EditorContext | EAutomationTestFlags::PerfFilter)
+
+// Compares the per frame cost of updating actor LOD vehicles by looking up their components & pushing commands per
+// vehicle, against using components resolved at spawn and a single FMassTrafficActorUpdateBatch command, for
+// increasing numbers of actor LOD vehicles
+bool FMassTrafficActorUpdateBatchBenchmark::RunTest(const FString& Parameters)
+{
+	using namespace UE::MassTraffic::ActorUpdateBatchBenchmark;
+
+	UWorld* World = UWorld::CreateWorld(EWorldType::Game, /*bInformEngineOfWorld*/false);
+	FWorldContext& WorldContext = GEngine->CreateNewWorldContext(EWorldType::Game);
+	WorldContext.SetCurrentWorld(World);
+
+	TSharedPtr<FMassEntityManager> EntityManager = MakeShareable(new FMassEntityManager(World));
+	EntityManager->Initialize();
+	const FMassArchetypeHandle Archetype = EntityManager->CreateArchetype({ FMassTrafficVehiclePhysicsFragment::StaticStruct() });
+
+	TArray<AActor*> Actors;
+	TArray<FMassEntityHandle> Entities;
+	TArray<FMassTrafficVehicleActorComponentsFragment> ActorComponentsFragments;
+	TSharedPtr<FMassCommandBuffer> CommandBuffer = MakeShareable(new FMassCommandBuffer());
+	FMassTrafficActorUpdateBatch ActorUpdateBatch;
+
+	for (const int32 NumVehicles : NumVehiclesToTest)
+	{
+		while (Actors.Num() < NumVehicles)
+		{
+			AActor* Actor = SpawnVehicleActor(*World);
+			Actors.Add(Actor);
+			Entities.Add(EntityManager->CreateEntity(Archetype));
+			ActorComponentsFragments.AddDefaulted_GetRef().Resolve(*Actor);
+		}
+
+		// Per vehicle component lookups & commands
+		const double PerVehicleStartTime = FPlatformTime::Seconds();
+		for (int32 Frame = 0; Frame < NumFrames; ++Frame)
+		{
+			const FTransform Transform(FVector(Frame, 0.0f, 0.0f));
+			for (int32 VehicleIndex = 0; VehicleIndex < NumVehicles; ++VehicleIndex)
+			{
+				AActor* Actor = Actors[VehicleIndex];
+				CommandBuffer->PushCommand<FMassDeferredSetCommand>([Actor, Transform](FMassEntityManager&)
+				{
+					Actor->SetActorTransform(Transform);
+				});
+
+				if (UMassTrafficVehicleComponent* MassTrafficVehicleComponent = Actor->FindComponentByClass<UMassTrafficVehicleComponent>())
+				{
+					CommandBuffer->PushCommand<FMassDeferredSetCommand>([MassTrafficVehicleComponent, Entity = Entities[VehicleIndex]](FMassEntityManager& CallbackEntityManager)
+					{
+						if (const FMassTrafficVehiclePhysicsFragment* SimpleVehiclePhysicsFragment = CallbackEntityManager.GetFragmentDataPtr<FMassTrafficVehiclePhysicsFragment>(Entity))
+						{
+							MassTrafficVehicleComponent->UpdateWheelComponents(SimpleVehiclePhysicsFragment->VehicleSim);
+						}
+					});
+				}
+
+				Actor->ForEachComponent<UPrimitiveComponent>(/*bIncludeFromChildActors*/true, [Frame](UPrimitiveComponent* PrimitiveComponent)
+				{
+					PrimitiveComponent->SetCustomPrimitiveDataFloat(/*DataIndex*/1, Frame);
+				});
+			}
+			EntityManager->FlushCommands(CommandBuffer);
+		}
+		const double PerVehicleMilliseconds = (FPlatformTime::Seconds() - PerVehicleStartTime) * 1000.0 / NumFrames;
+
+		// Components resolved at spawn & batched commands
+		const double BatchedStartTime = FPlatformTime::Seconds();
+		for (int32 Frame = 0; Frame < NumFrames; ++Frame)
+		{
+			const FTransform Transform(FVector(Frame, 0.0f, 0.0f));
+			for (int32 VehicleIndex = 0; VehicleIndex < NumVehicles; ++VehicleIndex)
+			{
+				FMassTrafficVehicleActorComponentsFragment& ActorComponentsFragment = ActorComponentsFragments[VehicleIndex];
+				ActorComponentsFragment.Resolve(*Actors[VehicleIndex]);
+
+				ActorUpdateBatch.AddActorTransform(*Actors[VehicleIndex], Transform);
+
+				if (UMassTrafficVehicleComponent* MassTrafficVehicleComponent = ActorComponentsFragment.VehicleComponent.Get())
+				{
+					ActorUpdateBatch.AddWheelUpdate(*MassTrafficVehicleComponent, Entities[VehicleIndex]);
+				}
+
+				ActorComponentsFragment.SetCustomPrimitiveDataFloat(/*DataIndex*/1, Frame);
+			}
+			ActorUpdateBatch.Defer(*CommandBuffer);
+			EntityManager->FlushCommands(CommandBuffer);
+		}
+		const double BatchedMilliseconds = (FPlatformTime::Seconds() - BatchedStartTime) * 1000.0 / NumFrames;
+
+		AddInfo(FString::Printf(TEXT("%d actor LOD vehicles: per vehicle %.3f ms/frame, batched %.3f ms/frame (%.2fx)"),
+			NumVehicles, PerVehicleMilliseconds, BatchedMilliseconds, BatchedMilliseconds > 0.0 ? PerVehicleMilliseconds / BatchedMilliseconds : 0.0));
+	}
+
+	EntityManager->Deinitialize();
+	GEngine->DestroyWorldContext(World);
+	World->DestroyWorld(/*bInformEngineOfWorld*/false);
+
+	return true;
+}
@@ -0,0 +1,163 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "Misc/AutomationTest.h"
+
+#include "MassTrafficEntityTransitionBatch.h"
+#include "MassTrafficFragments.h"
+
+#include "Engine/Engine.h"
+#include "Engine/World.h"
+#include "HAL/PlatformTime.h"
+#include "MassCommandBuffer.h"
+#include "MassEntityManager.h"
+#include "MassEntityView.h"
+
+namespace UE::MassTraffic::EntityTransitionBatchTests
+{
+
+static constexpr int32 NumVehicles = 10000;
+
+/** Destroy every this many vehicles rather than recycling them, as irreparably damaged vehicles are. */
+static constexpr int32 DestroyInterval = 10;
+
+/** Counts the valid entities with a vehicle tag & with a recyclable vehicle tag. */
+static void CountTags(const FMassEntityManager& EntityManager, TConstArrayView<FMassEntityHandle> Entities, int32& OutNumValid, int32& OutNumVehicles, int32& OutNumRecyclable)
+{
+	OutNumValid = 0;
+	OutNumVehicles = 0;
+	OutNumRecyclable = 0;
+	for (const FMassEntityHandle Entity : Entities)
+	{
+		if (!EntityManager.IsEntityValid(Entity))
+		{
+			continue;
+		}
+
+		++OutNumValid;
+		const FMassEntityView EntityView(EntityManager, Entity);
+		OutNumVehicles += EntityView.HasTag<FMassTrafficVehicleTag>() ? 1 : 0;
+		OutNumRecyclable += EntityView.HasTag<FMassTrafficRecyclableVehicleTag>() ? 1 : 0;
+	}
+}
+
+}
+
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FMassTrafficEntityTransitionBatchTest, "MassTraffic.EntityTransitionBatch.RecycleVehicles", EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+// Recycles 10k vehicles in a single tick, first with a SwapTags command per vehicle then with a
+// FMassTrafficEntityTransitionBatch, checking the batch leaves every vehicle in the same state & reporting both timings
+bool FMassTrafficEntityTransitionBatchTest::RunTest(const FString& Parameters)
+{
+	using namespace UE::MassTraffic::EntityTransitionBatchTests;
+
+	UWorld* World = UWorld::CreateWorld(EWorldType::Game, /*bInformEngineOfWorld*/false);
+	FWorldContext& WorldContext = GEngine->CreateNewWorldContext(EWorldType::Game);
+	WorldContext.SetCurrentWorld(World);
+
+	TSharedPtr<FMassEntityManager> EntityManager = MakeShareable(new FMassEntityManager(World));
+	EntityManager->Initialize();
+	const FMassArchetypeHandle Archetype = EntityManager->CreateArchetype({ FMassTrafficRandomFractionFragment::StaticStruct(), FMassTrafficVehicleTag::StaticStruct() });
+
+	TSharedPtr<FMassCommandBuffer> CommandBuffer = MakeShareable(new FMassCommandBuffer());
+
+	int32 NumValid = 0;
+	int32 NumVehicleTags = 0;
+	int32 NumRecyclable = 0;
+
+	// Per vehicle commands
+	TArray<FMassEntityHandle> PerVehicleEntities;
+	for (int32 VehicleIndex = 0; VehicleIndex < NumVehicles; ++VehicleIndex)
+	{
+		PerVehicleEntities.Add(EntityManager->CreateEntity(Archetype));
+	}
+
+	const double PerVehicleStartTime = FPlatformTime::Seconds();
+	for (int32 VehicleIndex = 0; VehicleIndex < PerVehicleEntities.Num(); ++VehicleIndex)
+	{
+		if (VehicleIndex % DestroyInterval == 0)
+		{
+			CommandBuffer->DestroyEntity(PerVehicleEntities[VehicleIndex]);
+		}
+		else
+		{
+			CommandBuffer->SwapTags<FMassTrafficVehicleTag, FMassTrafficRecyclableVehicleTag>(PerVehicleEntities[VehicleIndex]);
+		}
+	}
+	EntityManager->FlushCommands(CommandBuffer);
+	const double PerVehicleMilliseconds = (FPlatformTime::Seconds() - PerVehicleStartTime) * 1000.0;
+
+	CountTags(*EntityManager, PerVehicleEntities, NumValid, NumVehicleTags, NumRecyclable);
+	const int32 ExpectedNumValid = NumValid;
+	const int32 ExpectedNumRecyclable = NumRecyclable;
+	TestEqual(TEXT("Per vehicle vehicles left"), NumVehicleTags, 0);
+
+	// Batched transition
+	TArray<FMassEntityHandle> BatchedEntities;
+	for (int32 VehicleIndex = 0; VehicleIndex < NumVehicles; ++VehicleIndex)
+	{
+		BatchedEntities.Add(EntityManager->CreateEntity(Archetype));
+	}
+
+	const FMassTrafficEntityTransition RecycleTransition = FMassTrafficEntityTransition()
+		.RemoveTags<FMassTrafficVehicleTag>()
+		.AddTags<FMassTrafficRecyclableVehicleTag>();
+
+	FMassTrafficEntityTransitionBatch EntityTransitionBatch;
+	TArray<FMassEntityHandle> EntitiesToDestroy;
+	const double BatchedStartTime = FPlatformTime::Seconds();
+	for (int32 VehicleIndex = 0; VehicleIndex < BatchedEntities.Num(); ++VehicleIndex)
+	{
+		if (VehicleIndex % DestroyInterval == 0)
+		{
+			EntitiesToDestroy.Add(BatchedEntities[VehicleIndex]);
+		}
+		else
+		{
+			EntityTransitionBatch.AddTransition(RecycleTransition, BatchedEntities[VehicleIndex]);
+		}
+	}
+	TestEqual(TEXT("Batched entities"), EntityTransitionBatch.Num() + EntitiesToDestroy.Num(), NumVehicles);
+	EntityTransitionBatch.Defer(*CommandBuffer);
+	CommandBuffer->DestroyEntities(EntitiesToDestroy);
+	TestTrue(TEXT("Batch empty after deferring"), EntityTransitionBatch.IsEmpty());
+	EntityManager->FlushCommands(CommandBuffer);
+	const double BatchedMilliseconds = (FPlatformTime::Seconds() - BatchedStartTime) * 1000.0;
+
+	CountTags(*EntityManager, BatchedEntities, NumValid, NumVehicleTags, NumRecyclable);
+	TestEqual(TEXT("Batched valid entities"), NumValid, ExpectedNumValid);
+	TestEqual(TEXT("Batched vehicles left"), NumVehicleTags, 0);
+	TestEqual(TEXT("Batched recyclable vehicles"), NumRecyclable, ExpectedNumRecyclable);
+
+	AddInfo(FString::Printf(TEXT("Recycling %d vehicles: per vehicle %.3f ms, batched %.3f ms (%.2fx)"),
+		NumVehicles, PerVehicleMilliseconds, BatchedMilliseconds, BatchedMilliseconds > 0.0 ? PerVehicleMilliseconds / BatchedMilliseconds : 0.0));
+
+	// Fragments added by a transition are set from their instances
+	const FMassTrafficEntityTransition DamageTransition = FMassTrafficEntityTransition()
+		.AddFragments<FMassTrafficVehicleDamageFragment>();
+
+	FMassTrafficVehicleDamageFragment DamageFragment;
+	DamageFragment.VehicleDamageState = EMassTrafficVehicleDamageState::Irreparable;
+	const FInstancedStruct DamageFragmentInstance = FInstancedStruct::Make(DamageFragment);
+
+	for (const FMassEntityHandle Entity : BatchedEntities)
+	{
+		EntityTransitionBatch.AddTransition(DamageTransition, Entity, MakeArrayView(&DamageFragmentInstance, 1));
+	}
+	EntityTransitionBatch.Apply(*EntityManager);
+	EntityTransitionBatch.Reset();
+
+	int32 NumDamaged = 0;
+	for (const FMassEntityHandle Entity : BatchedEntities)
+	{
+		const FMassTrafficVehicleDamageFragment* Fragment = EntityManager->IsEntityValid(Entity) ? EntityManager->GetFragmentDataPtr<FMassTrafficVehicleDamageFragment>(Entity) : nullptr;
+		NumDamaged += Fragment && Fragment->VehicleDamageState == EMassTrafficVehicleDamageState::Irreparable ? 1 : 0;
+	}
+	TestEqual(TEXT("Damaged vehicles"), NumDamaged, ExpectedNumValid);
+
+	EntityManager->Deinitialize();
+	GEngine->DestroyWorldContext(World);
+	World->DestroyWorld(/*bInformEngineOfWorld*/false);
+
+	return true;
+}
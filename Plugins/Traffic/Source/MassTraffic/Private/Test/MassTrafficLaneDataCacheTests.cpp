@@ -0,0 +1,228 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "Misc/AutomationTest.h"
+
+#include "MassTrafficLaneDataCache.h"
+#include "MassTrafficSettings.h"
+#include "MassTrafficTypes.h"
+
+#include "HAL/FileManager.h"
+#include "Misc/Paths.h"
+#include "ZoneGraphTypes.h"
+
+namespace UE::MassTraffic::LaneDataCacheTests
+{
+
+static constexpr int32 NumLanes = 6;
+
+/** Lanes 0-4 are traffic lanes, lane 5 isn't. Lanes 0 & 1 are adjacent, both lead to 2, which splits into 3 & 4. */
+static void BuildLaneData(FZoneGraphStorage& ZoneGraphStorage, FMassTrafficZoneGraphData& TrafficZoneGraphData)
+{
+	ZoneGraphStorage.DataHandle = FZoneGraphDataHandle(1, 1);
+	for (int32 LaneIndex = 0; LaneIndex < NumLanes; ++LaneIndex)
+	{
+		FZoneLaneData& Lane = ZoneGraphStorage.Lanes.AddDefaulted_GetRef();
+		Lane.PointsBegin = ZoneGraphStorage.LanePoints.Num();
+		ZoneGraphStorage.LanePoints.Add(FVector(0.0f, LaneIndex * 500.0f, 0.0f));
+		ZoneGraphStorage.LanePoints.Add(FVector(1000.0f + LaneIndex, LaneIndex * 500.0f, 0.0f));
+		Lane.PointsEnd = ZoneGraphStorage.LanePoints.Num();
+	}
+
+	TrafficZoneGraphData.DataHandle = ZoneGraphStorage.DataHandle;
+	TrafficZoneGraphData.TrafficLaneDataArray.SetNum(NumLanes - 1);
+	TrafficZoneGraphData.TrafficLaneDataLookup.SetNumZeroed(NumLanes);
+	for (int32 LaneIndex = 0; LaneIndex < NumLanes - 1; ++LaneIndex)
+	{
+		FZoneGraphTrafficLaneData& TrafficLaneData = TrafficZoneGraphData.TrafficLaneDataArray[LaneIndex];
+		TrafficLaneData.LaneHandle = FZoneGraphLaneHandle(LaneIndex, ZoneGraphStorage.DataHandle);
+		TrafficLaneData.Length = 1000.0f + LaneIndex;
+		TrafficLaneData.SpaceAvailable = TrafficLaneData.Length;
+		TrafficLaneData.CenterLocation = FVector(500.0f, LaneIndex * 500.0f, 0.0f);
+		TrafficLaneData.Radius = 500.0f;
+		TrafficLaneData.ConstData.SpeedLimit = 1500.0f + LaneIndex;
+		TrafficLaneData.ConstData.AverageNextLanesSpeedLimit = 1200.0f;
+		TrafficLaneData.ConstData.bIsIntersectionLane = LaneIndex == 2;
+		TrafficLaneData.ConstData.bIsTrunkLane = LaneIndex != 4;
+		TrafficLaneData.ConstData.bIsLaneChangingLane = LaneIndex < 2;
+		TrafficLaneData.MaxDensity = 0.25f * LaneIndex;
+		TrafficLaneData.bTurnsLeft = LaneIndex == 3;
+		TrafficLaneData.bTurnsRight = LaneIndex == 4;
+		TrafficLaneData.bIsRightMostLane = LaneIndex == 1;
+		TrafficLaneData.bIsDownstreamFromIntersection = LaneIndex > 2;
+		TrafficZoneGraphData.TrafficLaneDataLookup[LaneIndex] = &TrafficLaneData;
+	}
+
+	TArray<FZoneGraphTrafficLaneData>& Lanes = TrafficZoneGraphData.TrafficLaneDataArray;
+	Lanes[0].RightLane = &Lanes[1];
+	Lanes[1].LeftLane = &Lanes[0];
+	Lanes[0].NextLanes.Add(&Lanes[2]);
+	Lanes[1].NextLanes.Add(&Lanes[2]);
+	Lanes[2].NextLanes.Add(&Lanes[3]);
+	Lanes[2].NextLanes.Add(&Lanes[4]);
+	Lanes[3].SplittingLanes.Add(&Lanes[4]);
+	Lanes[4].SplittingLanes.Add(&Lanes[3]);
+	Lanes[0].MergingLanes.Add(&Lanes[1]);
+}
+
+template<typename AllocatorType>
+static TArray<int32> GetLaneIndices(const TArray<FZoneGraphTrafficLaneData*, AllocatorType>& LinkedLanes)
+{
+	TArray<int32> LaneIndices;
+	for (const FZoneGraphTrafficLaneData* LinkedLane : LinkedLanes)
+	{
+		LaneIndices.Add(LinkedLane->LaneHandle.Index);
+	}
+	return LaneIndices;
+}
+
+static int32 GetLaneIndex(const FZoneGraphTrafficLaneData* TrafficLaneData)
+{
+	return TrafficLaneData ? TrafficLaneData->LaneHandle.Index : INDEX_NONE;
+}
+
+}
+
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FMassTrafficLaneDataCacheTest, "MassTraffic.LaneData.Cache", EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+// Save lane data to the cache & load it back, checking lanes and the links between them survive the round trip, and
+// that it isn't loaded for a different key or storage
+bool FMassTrafficLaneDataCacheTest::RunTest(const FString& Parameters)
+{
+	using namespace UE::MassTraffic::LaneDataCacheTests;
+
+	FZoneGraphStorage ZoneGraphStorage;
+	FMassTrafficZoneGraphData TrafficZoneGraphData;
+	BuildLaneData(ZoneGraphStorage, TrafficZoneGraphData);
+
+	const uint32 CacheKey = UE::MassTraffic::GetLaneDataCacheKey(ZoneGraphStorage, *GetDefault<UMassTrafficSettings>());
+	const FString Filename = FPaths::Combine(FPaths::AutomationTransientDir(), TEXT("MassTrafficLaneDataCacheTest.bin"));
+	if (!UE::MassTraffic::SaveLaneDataCache(Filename, CacheKey, TrafficZoneGraphData))
+	{
+		AddError(FString::Printf(TEXT("Couldn't save lane data cache to %s"), *Filename));
+		return false;
+	}
+
+	FMassTrafficZoneGraphData LoadedTrafficZoneGraphData;
+	if (!TestTrue(TEXT("Lane data cache loaded"), UE::MassTraffic::LoadLaneDataCache(Filename, CacheKey, ZoneGraphStorage, LoadedTrafficZoneGraphData)))
+	{
+		return false;
+	}
+
+	TestEqual(TEXT("Data handle"), LoadedTrafficZoneGraphData.DataHandle, ZoneGraphStorage.DataHandle);
+	TestEqual(TEXT("Number of lookup entries"), LoadedTrafficZoneGraphData.TrafficLaneDataLookup.Num(), NumLanes);
+	TestNull(TEXT("Non traffic lane lookup"), LoadedTrafficZoneGraphData.GetTrafficLaneData(NumLanes - 1));
+	if (!TestEqual(TEXT("Number of traffic lanes"), LoadedTrafficZoneGraphData.TrafficLaneDataArray.Num(), TrafficZoneGraphData.TrafficLaneDataArray.Num()))
+	{
+		return false;
+	}
+
+	for (int32 LaneIndex = 0; LaneIndex < TrafficZoneGraphData.TrafficLaneDataArray.Num(); ++LaneIndex)
+	{
+		const FZoneGraphTrafficLaneData& Lane = TrafficZoneGraphData.TrafficLaneDataArray[LaneIndex];
+		const FZoneGraphTrafficLaneData* LoadedLane = LoadedTrafficZoneGraphData.GetTrafficLaneData(LaneIndex);
+		if (!TestNotNull(TEXT("Traffic lane lookup"), LoadedLane))
+		{
+			return false;
+		}
+
+		TestEqual(TEXT("Lane handle"), LoadedLane->LaneHandle, Lane.LaneHandle);
+		TestEqual(TEXT("Length"), LoadedLane->Length, Lane.Length);
+		TestEqual(TEXT("Space available"), LoadedLane->SpaceAvailable, Lane.SpaceAvailable);
+		TestEqual(TEXT("Center location"), LoadedLane->CenterLocation, Lane.CenterLocation);
+		TestEqual(TEXT("Radius"), LoadedLane->Radius.GetFloat(), Lane.Radius.GetFloat());
+		TestEqual(TEXT("Speed limit"), LoadedLane->ConstData.SpeedLimit.GetFloat(), Lane.ConstData.SpeedLimit.GetFloat());
+		TestEqual(TEXT("Average next lanes speed limit"), LoadedLane->ConstData.AverageNextLanesSpeedLimit.GetFloat(), Lane.ConstData.AverageNextLanesSpeedLimit.GetFloat());
+		TestEqual(TEXT("Max density"), static_cast<float>(LoadedLane->MaxDensity), static_cast<float>(Lane.MaxDensity));
+		TestEqual(TEXT("Is intersection lane"), static_cast<bool>(LoadedLane->ConstData.bIsIntersectionLane), static_cast<bool>(Lane.ConstData.bIsIntersectionLane));
+		TestEqual(TEXT("Is trunk lane"), static_cast<bool>(LoadedLane->ConstData.bIsTrunkLane), static_cast<bool>(Lane.ConstData.bIsTrunkLane));
+		TestEqual(TEXT("Is lane changing lane"), static_cast<bool>(LoadedLane->ConstData.bIsLaneChangingLane), static_cast<bool>(Lane.ConstData.bIsLaneChangingLane));
+		TestEqual(TEXT("Turns left"), static_cast<bool>(LoadedLane->bTurnsLeft), static_cast<bool>(Lane.bTurnsLeft));
+		TestEqual(TEXT("Turns right"), static_cast<bool>(LoadedLane->bTurnsRight), static_cast<bool>(Lane.bTurnsRight));
+		TestEqual(TEXT("Is right most lane"), static_cast<bool>(LoadedLane->bIsRightMostLane), static_cast<bool>(Lane.bIsRightMostLane));
+		TestEqual(TEXT("Is downstream from intersection"), static_cast<bool>(LoadedLane->bIsDownstreamFromIntersection), static_cast<bool>(Lane.bIsDownstreamFromIntersection));
+
+		// Links must point into the loaded lane data, not the original
+		TestEqual(TEXT("Left lane"), GetLaneIndex(LoadedLane->LeftLane), GetLaneIndex(Lane.LeftLane));
+		TestEqual(TEXT("Right lane"), GetLaneIndex(LoadedLane->RightLane), GetLaneIndex(Lane.RightLane));
+		TestEqual(TEXT("Next lanes"), GetLaneIndices(LoadedLane->NextLanes), GetLaneIndices(Lane.NextLanes));
+		TestEqual(TEXT("Merging lanes"), GetLaneIndices(LoadedLane->MergingLanes), GetLaneIndices(Lane.MergingLanes));
+		TestEqual(TEXT("Splitting lanes"), GetLaneIndices(LoadedLane->SplittingLanes), GetLaneIndices(Lane.SplittingLanes));
+		for (const FZoneGraphTrafficLaneData* NextLane : LoadedLane->NextLanes)
+		{
+			TestTrue(TEXT("Next lane is loaded lane data"), NextLane == LoadedTrafficZoneGraphData.GetTrafficLaneData(NextLane->LaneHandle.Index));
+		}
+	}
+
+	FMassTrafficZoneGraphData MismatchedTrafficZoneGraphData;
+	TestFalse(TEXT("Lane data cache loaded for a different key"), UE::MassTraffic::LoadLaneDataCache(Filename, CacheKey + 1, ZoneGraphStorage, MismatchedTrafficZoneGraphData));
+
+	ZoneGraphStorage.Lanes.AddDefaulted();
+	TestFalse(TEXT("Lane data cache loaded for a storage with more lanes"), UE::MassTraffic::LoadLaneDataCache(Filename, CacheKey, ZoneGraphStorage, MismatchedTrafficZoneGraphData));
+	TestNotEqual(TEXT("Lane data cache key after adding a lane"), UE::MassTraffic::GetLaneDataCacheKey(ZoneGraphStorage, *GetDefault<UMassTrafficSettings>()), CacheKey);
+
+	IFileManager::Get().Delete(*Filename);
+
+	return true;
+}
+
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FMassTrafficGroundSnapCacheTest, "MassTraffic.LaneData.GroundSnapCache", EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+// Save ground traces to the cache & load them back, checking they're still keyed by lane & point index, and that
+// they aren't loaded for different trace settings
+bool FMassTrafficGroundSnapCacheTest::RunTest(const FString& Parameters)
+{
+	UE::MassTraffic::FGroundSnapCache GroundSnapCache;
+	for (int32 LaneIndex = 0; LaneIndex < 3; ++LaneIndex)
+	{
+		for (int32 PointIndex = 2 * LaneIndex; PointIndex < 2 * LaneIndex + 2; ++PointIndex)
+		{
+			UE::MassTraffic::FGroundSnapCacheEntry& Entry = GroundSnapCache.Add(FIntPoint(LaneIndex, PointIndex));
+			Entry.SourcePoint = FVector(100.0f * PointIndex, 500.0f * LaneIndex, 50.0f);
+			Entry.ImpactPoint = FVector(100.0f * PointIndex, 500.0f * LaneIndex, 10.0f + PointIndex);
+			Entry.ImpactNormal = FVector(0.0f, 0.1f * LaneIndex, 1.0f).GetSafeNormal();
+			Entry.SnappedPoint = Entry.ImpactPoint;
+			Entry.GeometryHash = 0x1000 + PointIndex;
+			Entry.bHit = PointIndex != 3;
+		}
+	}
+
+	const uint32 CacheKey = 0xC0FFEE;
+	const FString Filename = FPaths::Combine(FPaths::AutomationTransientDir(), TEXT("MassTrafficGroundSnapCacheTest.bin"));
+	if (!UE::MassTraffic::SaveGroundSnapCache(Filename, CacheKey, GroundSnapCache))
+	{
+		AddError(FString::Printf(TEXT("Couldn't save ground snap cache to %s"), *Filename));
+		return false;
+	}
+
+	UE::MassTraffic::FGroundSnapCache LoadedGroundSnapCache;
+	if (!TestTrue(TEXT("Ground snap cache loaded"), UE::MassTraffic::LoadGroundSnapCache(Filename, CacheKey, LoadedGroundSnapCache))
+		|| !TestEqual(TEXT("Number of entries"), LoadedGroundSnapCache.Num(), GroundSnapCache.Num()))
+	{
+		return false;
+	}
+
+	for (const TPair<FIntPoint, UE::MassTraffic::FGroundSnapCacheEntry>& CacheEntry : GroundSnapCache)
+	{
+		const UE::MassTraffic::FGroundSnapCacheEntry* LoadedEntry = LoadedGroundSnapCache.Find(CacheEntry.Key);
+		if (!TestNotNull(TEXT("Entry for lane point"), LoadedEntry))
+		{
+			return false;
+		}
+
+		TestEqual(TEXT("Source point"), LoadedEntry->SourcePoint, CacheEntry.Value.SourcePoint);
+		TestEqual(TEXT("Snapped point"), LoadedEntry->SnappedPoint, CacheEntry.Value.SnappedPoint);
+		TestEqual(TEXT("Impact point"), LoadedEntry->ImpactPoint, CacheEntry.Value.ImpactPoint);
+		TestEqual(TEXT("Impact normal"), LoadedEntry->ImpactNormal, CacheEntry.Value.ImpactNormal);
+		TestEqual(TEXT("Geometry hash"), LoadedEntry->GeometryHash, CacheEntry.Value.GeometryHash);
+		TestEqual(TEXT("Hit"), LoadedEntry->bHit, CacheEntry.Value.bHit);
+	}
+
+	TestFalse(TEXT("Ground snap cache loaded for different trace settings"), UE::MassTraffic::LoadGroundSnapCache(Filename, CacheKey + 1, LoadedGroundSnapCache));
+	TestEqual(TEXT("Entries after a mismatched load"), LoadedGroundSnapCache.Num(), 0);
+
+	IFileManager::Get().Delete(*Filename);
+
+	return true;
+}
@@ -0,0 +1,154 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "Misc/AutomationTest.h"
+#include "Async/ParallelFor.h"
+
+#include "MassTrafficFragments.h"
+#include "MassTrafficLaneReservations.h"
+#include "MassTrafficTypes.h"
+
+#include "MassZoneGraphNavigationFragments.h"
+
+namespace UE::MassTraffic::LaneReservationsTests
+{
+
+static constexpr int32 NumLanes = 64;
+static constexpr int32 NumVehicles = 4096;
+static constexpr int32 NumVehiclesPerChunk = 128;
+static constexpr int32 NumChunks = NumVehicles / NumVehiclesPerChunk;
+static constexpr int32 NumFrames = 8;
+static constexpr float DownstreamFlowDensityMixtureFraction = 0.3f;
+
+/** Stand-in for the lanes & vehicle fragments a vehicle processor touches. */
+struct FTestWorld
+{
+	TArray<FZoneGraphTrafficLaneData> Lanes;
+	TArray<FMassTrafficVehicleControlFragment> VehicleControlFragments;
+	TArray<FMassZoneGraphLaneLocationFragment> LaneLocationFragments;
+
+	FTestWorld()
+	{
+		Lanes.SetNum(NumLanes);
+		for (int32 LaneIndex = 0; LaneIndex < NumLanes; ++LaneIndex)
+		{
+			FZoneGraphTrafficLaneData& Lane = Lanes[LaneIndex];
+			Lane.Length = 1000.0f + 100.0f * LaneIndex;
+			Lane.SpaceAvailable = Lane.Length * float(LaneIndex % 7) / 7.0f;
+			Lane.NumReservedVehiclesOnLane = 100;
+			Lane.NumVehiclesApproachingLane = 100;
+			Lane.NextLanes.Add(&Lanes[(LaneIndex + 1) % NumLanes]);
+			Lane.NextLanes.Add(&Lanes[(LaneIndex * 7 + 3) % NumLanes]);
+		}
+
+		VehicleControlFragments.SetNum(NumVehicles);
+		LaneLocationFragments.SetNum(NumVehicles);
+	}
+
+	/** Records a frame's worth of reservations for the vehicles in ChunkIndex, as a vehicle processor's chunk loop would. */
+	void RecordChunk(FMassTrafficLaneReservations& LaneReservations, const int32 ChunkIndex, const uint32 FrameSeed)
+	{
+		FMassTrafficLaneReservationBuffer& Reservations = LaneReservations.AddBuffer();
+		Reservations.LaneLocationFragments = MakeArrayView(LaneLocationFragments).Slice(ChunkIndex * NumVehiclesPerChunk, NumVehiclesPerChunk);
+		Reservations.DistancesAlongLane.SetNumUninitialized(NumVehiclesPerChunk);
+
+		for (int32 Index = 0; Index < NumVehiclesPerChunk; ++Index)
+		{
+			const int32 VehicleIndex = ChunkIndex * NumVehiclesPerChunk + Index;
+			const FMassEntityHandle Entity(VehicleIndex + 1, 1);
+			const FRandomStream EntityRandomStream = MakeEntityRandomStream(FrameSeed, Entity);
+
+			// Read shared state, which must look the same whichever thread & order the chunks are processed in
+			FZoneGraphTrafficLaneData& Lane = Lanes[EntityRandomStream.RandHelper(NumLanes)];
+			const float SpeedFactor = Lane.bIsVehicleReadyToUseLane ? 0.5f : 1.0f;
+			Reservations.DistancesAlongLane[Index] = LaneLocationFragments[VehicleIndex].DistanceAlongLane + SpeedFactor * Lane.GetDownstreamFlowDensity() + EntityRandomStream.FRand();
+
+			const int32 NumReservations = EntityRandomStream.RandRange(0, 4);
+			for (int32 ReservationIndex = 0; ReservationIndex < NumReservations; ++ReservationIndex)
+			{
+				const EMassTrafficLaneReservationType Type = static_cast<EMassTrafficLaneReservationType>(EntityRandomStream.RandHelper(static_cast<int32>(EMassTrafficLaneReservationType::VehicleAction)));
+				Reservations.Add(Entity, Type, &Lanes[EntityRandomStream.RandHelper(NumLanes)], &VehicleControlFragments[VehicleIndex]);
+			}
+		}
+	}
+
+	void Apply(FMassTrafficLaneReservations& LaneReservations)
+	{
+		LaneReservations.ApplyDistancesAlongLane();
+		LaneReservations.SortAndApply(DownstreamFlowDensityMixtureFraction);
+	}
+};
+
+static bool AreLanesIdentical(const FZoneGraphTrafficLaneData& A, const FZoneGraphTrafficLaneData& B)
+{
+	return A.NumReservedVehiclesOnLane == B.NumReservedVehiclesOnLane
+		&& A.NumVehiclesApproachingLane == B.NumVehiclesApproachingLane
+		&& A.bIsVehicleReadyToUseLane == B.bIsVehicleReadyToUseLane
+		&& A.bIsStoppedVehicleInPreviousLaneOverlappingThisLane == B.bIsStoppedVehicleInPreviousLaneOverlappingThisLane
+		&& A.GetDownstreamFlowDensity() == B.GetDownstreamFlowDensity();
+}
+
+}
+
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FMassTrafficLaneReservationsParallelTest, "MassTraffic.LaneReservations.ParallelMatchesSerial", EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+// Record reservations for the same vehicles on a single thread in chunk order, and in parallel in a shuffled chunk order,
+// and check both end up bit-identical after every frame
+bool FMassTrafficLaneReservationsParallelTest::RunTest(const FString& Parameters)
+{
+	using namespace UE::MassTraffic::LaneReservationsTests;
+
+	FTestWorld SerialWorld;
+	FTestWorld ParallelWorld;
+	FMassTrafficLaneReservations SerialReservations;
+	FMassTrafficLaneReservations ParallelReservations;
+
+	FRandomStream RandomStream(1234);
+	TArray<int32> ChunkOrder;
+	for (int32 ChunkIndex = 0; ChunkIndex < NumChunks; ++ChunkIndex)
+	{
+		ChunkOrder.Add(ChunkIndex);
+	}
+
+	for (int32 Frame = 0; Frame < NumFrames; ++Frame)
+	{
+		const uint32 FrameSeed = RandomStream.GetUnsignedInt();
+
+		for (int32 ChunkIndex = 0; ChunkIndex < NumChunks; ++ChunkIndex)
+		{
+			SerialWorld.RecordChunk(SerialReservations, ChunkIndex, FrameSeed);
+		}
+		SerialWorld.Apply(SerialReservations);
+
+		for (int32 Index = ChunkOrder.Num() - 1; Index > 0; --Index)
+		{
+			ChunkOrder.Swap(Index, RandomStream.RandHelper(Index + 1));
+		}
+		ParallelFor(NumChunks, [&](const int32 Index)
+		{
+			ParallelWorld.RecordChunk(ParallelReservations, ChunkOrder[Index], FrameSeed);
+		});
+		ParallelWorld.Apply(ParallelReservations);
+
+		for (int32 LaneIndex = 0; LaneIndex < NumLanes; ++LaneIndex)
+		{
+			if (!AreLanesIdentical(SerialWorld.Lanes[LaneIndex], ParallelWorld.Lanes[LaneIndex]))
+			{
+				AddError(FString::Printf(TEXT("Lane %d differs after frame %d"), LaneIndex, Frame));
+				return false;
+			}
+		}
+
+		for (int32 VehicleIndex = 0; VehicleIndex < NumVehicles; ++VehicleIndex)
+		{
+			if (SerialWorld.VehicleControlFragments[VehicleIndex].bCantStopAtLaneExit != ParallelWorld.VehicleControlFragments[VehicleIndex].bCantStopAtLaneExit
+				|| SerialWorld.LaneLocationFragments[VehicleIndex].DistanceAlongLane != ParallelWorld.LaneLocationFragments[VehicleIndex].DistanceAlongLane)
+			{
+				AddError(FString::Printf(TEXT("Vehicle %d differs after frame %d"), VehicleIndex, Frame));
+				return false;
+			}
+		}
+	}
+
+	return true;
+}
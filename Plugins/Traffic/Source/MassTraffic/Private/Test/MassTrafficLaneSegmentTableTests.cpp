@@ -0,0 +1,279 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "Misc/AutomationTest.h"
+
+#include "MassTrafficInterpolation.h"
+
+#include "Engine/Engine.h"
+#include "Engine/World.h"
+#include "ZoneGraphData.h"
+#include "ZoneGraphQuery.h"
+#include "ZoneGraphSubsystem.h"
+#include "ZoneGraphTypes.h"
+
+namespace UE::MassTraffic::LaneSegmentTableTests
+{
+
+/** Maximum distance between positions interpolated with & without the lane segment table. */
+static constexpr float PositionTolerance = 0.01f;
+
+/** Adds a lane of NumPoints along a curve, with uneven spacing between its points, to ZoneGraphStorage. */
+static void AddLane(FZoneGraphStorage& ZoneGraphStorage, const int32 NumPoints, const float Radius, FRandomStream& RandomStream)
+{
+	FZoneLaneData& LaneData = ZoneGraphStorage.Lanes.AddDefaulted_GetRef();
+	LaneData.PointsBegin = ZoneGraphStorage.LanePoints.Num();
+	LaneData.PointsEnd = LaneData.PointsBegin + NumPoints;
+
+	float Angle = 0.0f;
+	float Progression = 0.0f;
+	for (int32 PointIndex = 0; PointIndex < NumPoints; ++PointIndex)
+	{
+		const FVector Point(Radius * FMath::Cos(Angle), Radius * FMath::Sin(Angle), 10.0f * PointIndex);
+		if (PointIndex > 0)
+		{
+			Progression += FVector::Distance(ZoneGraphStorage.LanePoints.Last(), Point);
+		}
+
+		ZoneGraphStorage.LanePoints.Add(Point);
+		ZoneGraphStorage.LanePointProgressions.Add(Progression);
+		ZoneGraphStorage.LaneTangentVectors.Add(FVector(-FMath::Sin(Angle), FMath::Cos(Angle), 0.0f));
+		ZoneGraphStorage.LaneUpVectors.Add(FVector::UpVector);
+
+		// Tessellation varies from very fine to coarse along the lane
+		Angle += RandomStream.FRandRange(0.001f, 0.2f);
+	}
+}
+
+/** Adds a zone holding all of ZoneGraphStorage's lanes, so it can be registered with a UZoneGraphSubsystem. */
+static void AddZone(FZoneGraphStorage& ZoneGraphStorage)
+{
+	FZoneData& Zone = ZoneGraphStorage.Zones.AddDefaulted_GetRef();
+	Zone.LanesBegin = 0;
+	Zone.LanesEnd = ZoneGraphStorage.Lanes.Num();
+	Zone.Bounds = FBox(ZoneGraphStorage.LanePoints);
+	ZoneGraphStorage.Bounds = Zone.Bounds;
+	ZoneGraphStorage.ZoneBVTree.Build(MakeStridedView(ZoneGraphStorage.Zones, &FZoneData::Bounds));
+
+	for (FZoneLaneData& LaneData : ZoneGraphStorage.Lanes)
+	{
+		LaneData.ZoneIndex = 0;
+	}
+}
+
+/** @return Location DistanceAlongLane along the lane, offset sideways by SideOffset. */
+static FVector GetLocationAlongLane(const FZoneGraphStorage& ZoneGraphStorage, const int32 LaneIndex, const float DistanceAlongLane, const float SideOffset)
+{
+	FZoneGraphLaneLocation LaneLocation;
+	UE::ZoneGraph::Query::CalculateLocationAlongLane(ZoneGraphStorage, FZoneGraphLaneHandle(LaneIndex, ZoneGraphStorage.DataHandle), DistanceAlongLane, LaneLocation);
+	return LaneLocation.Position + FVector::CrossProduct(LaneLocation.Up, LaneLocation.Direction).GetSafeNormal() * SideOffset;
+}
+
+}
+
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FMassTrafficLaneSegmentTableTest, "MassTraffic.Interpolation.LaneSegmentTable", EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+// Interpolates along lanes with & without a lane segment table, checking both find the same segments & positions
+bool FMassTrafficLaneSegmentTableTest::RunTest(const FString& Parameters)
+{
+	using namespace UE::MassTraffic::LaneSegmentTableTests;
+
+	FRandomStream RandomStream(1234);
+
+	FZoneGraphStorage ZoneGraphStorage;
+	AddLane(ZoneGraphStorage, 2, 1000.0f, RandomStream);
+	AddLane(ZoneGraphStorage, 50, 2000.0f, RandomStream);
+	AddLane(ZoneGraphStorage, 400, 5000.0f, RandomStream);
+
+	// Distances along each lane, including before its start & past its end
+	TArray<TArray<float>> LaneDistances;
+	for (int32 LaneIndex = 0; LaneIndex < ZoneGraphStorage.Lanes.Num(); ++LaneIndex)
+	{
+		const FZoneLaneData& LaneData = ZoneGraphStorage.Lanes[LaneIndex];
+		const float LaneLength = ZoneGraphStorage.LanePointProgressions[LaneData.PointsEnd - 1];
+
+		TArray<float>& Distances = LaneDistances.AddDefaulted_GetRef();
+		Distances.Add(-10.0f);
+		Distances.Add(LaneLength + 10.0f);
+		for (int32 PointIndex = LaneData.PointsBegin; PointIndex < LaneData.PointsEnd; ++PointIndex)
+		{
+			Distances.Add(ZoneGraphStorage.LanePointProgressions[PointIndex]);
+		}
+		for (int32 DistanceIndex = 0; DistanceIndex < 1000; ++DistanceIndex)
+		{
+			Distances.Add(RandomStream.FRandRange(0.0f, LaneLength));
+		}
+	}
+
+	// Interpolate without a table first
+	FMassTrafficLaneSegmentTable LaneSegmentTable;
+	TestFalse(TEXT("Lane segment table built before building"), LaneSegmentTable.IsBuilt());
+
+	TArray<FMassTrafficLaneSegment> ExpectedLaneSegments;
+	TArray<FTransform> ExpectedTransforms;
+	for (int32 LaneIndex = 0; LaneIndex < ZoneGraphStorage.Lanes.Num(); ++LaneIndex)
+	{
+		for (const float Distance : LaneDistances[LaneIndex])
+		{
+			FMassTrafficLaneSegment& LaneSegment = ExpectedLaneSegments.AddDefaulted_GetRef();
+			UE::MassTraffic::InterpolatePositionAndOrientationAlongLane(ZoneGraphStorage, /*LaneSegmentTable*/nullptr, LaneIndex, Distance, ETrafficVehicleMovementInterpolationMethod::CubicBezier, LaneSegment, ExpectedTransforms.AddDefaulted_GetRef());
+		}
+	}
+
+	LaneSegmentTable.Build(ZoneGraphStorage);
+	if (!TestTrue(TEXT("Lane segment table built after building"), LaneSegmentTable.IsBuilt()))
+	{
+		return false;
+	}
+
+	// Then with the table, both from fresh segments & a segment carried along from the previous distance
+	bool bSuccess = true;
+	int32 ExpectedIndex = 0;
+	FMassTrafficLaneSegment CarriedLaneSegment;
+	for (int32 LaneIndex = 0; LaneIndex < ZoneGraphStorage.Lanes.Num() && bSuccess; ++LaneIndex)
+	{
+		for (const float Distance : LaneDistances[LaneIndex])
+		{
+			const FMassTrafficLaneSegment& ExpectedLaneSegment = ExpectedLaneSegments[ExpectedIndex];
+			const FTransform& ExpectedTransform = ExpectedTransforms[ExpectedIndex];
+			++ExpectedIndex;
+
+			FMassTrafficLaneSegment LaneSegment;
+			FTransform Transform;
+			UE::MassTraffic::InterpolatePositionAndOrientationAlongLane(ZoneGraphStorage, &LaneSegmentTable, LaneIndex, Distance, ETrafficVehicleMovementInterpolationMethod::CubicBezier, LaneSegment, Transform);
+
+			FTransform CarriedTransform;
+			UE::MassTraffic::InterpolatePositionAndOrientationAlongLane(ZoneGraphStorage, &LaneSegmentTable, LaneIndex, Distance, ETrafficVehicleMovementInterpolationMethod::CubicBezier, CarriedLaneSegment, CarriedTransform);
+
+			bSuccess &= TestEqual(TEXT("Segment start point"), LaneSegment.StartPointIndex, ExpectedLaneSegment.StartPointIndex);
+			bSuccess &= TestTrue(TEXT("Segment start control point"), LaneSegment.StartControlPoint.Equals(ExpectedLaneSegment.StartControlPoint, PositionTolerance));
+			bSuccess &= TestTrue(TEXT("Segment end control point"), LaneSegment.EndControlPoint.Equals(ExpectedLaneSegment.EndControlPoint, PositionTolerance));
+			bSuccess &= TestTrue(TEXT("Position"), Transform.GetLocation().Equals(ExpectedTransform.GetLocation(), PositionTolerance));
+			bSuccess &= TestTrue(TEXT("Orientation"), Transform.GetRotation().Equals(ExpectedTransform.GetRotation(), UE_KINDA_SMALL_NUMBER));
+			bSuccess &= TestTrue(TEXT("Position from carried segment"), CarriedTransform.GetLocation().Equals(ExpectedTransform.GetLocation(), PositionTolerance));
+			if (!bSuccess)
+			{
+				AddError(FString::Printf(TEXT("Lane %d at distance %f"), LaneIndex, Distance));
+				break;
+			}
+		}
+	}
+
+	LaneSegmentTable.Reset();
+	TestFalse(TEXT("Lane segment table built after resetting"), LaneSegmentTable.IsBuilt());
+
+	return bSuccess;
+}
+
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FMassTrafficNearbyDistanceAlongLaneTest, "MassTraffic.Interpolation.NearbyDistanceAlongLane", EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+// Finds the distance along a lane of locations near a previous distance, as post physics updates do for vehicles, with
+// FindNearbyDistanceAlongLane, checking it agrees with UZoneGraphSubsystem::FindNearestLocationOnLane's whole lane
+// search whenever it finds one, and that it defers to that search when the location may be outside its search range
+bool FMassTrafficNearbyDistanceAlongLaneTest::RunTest(const FString& Parameters)
+{
+	using namespace UE::MassTraffic::LaneSegmentTableTests;
+
+	static constexpr float SearchDistance = 500.0f;
+	static constexpr float DistanceTolerance = 0.5f;
+
+	UWorld* World = UWorld::CreateWorld(EWorldType::Game, /*bInformEngineOfWorld*/false);
+	FWorldContext& WorldContext = GEngine->CreateNewWorldContext(EWorldType::Game);
+	WorldContext.SetCurrentWorld(World);
+
+	UZoneGraphSubsystem* ZoneGraphSubsystem = World->GetSubsystem<UZoneGraphSubsystem>();
+	if (!ZoneGraphSubsystem)
+	{
+		AddError(TEXT("ZoneGraph subsystem missing from test world"));
+		GEngine->DestroyWorldContext(World);
+		World->DestroyWorld(false);
+		return false;
+	}
+
+	FRandomStream RandomStream(1234);
+
+	AZoneGraphData* ZoneGraphData = World->SpawnActorDeferred<AZoneGraphData>(AZoneGraphData::StaticClass(), FTransform::Identity);
+	FZoneGraphStorage& ZoneGraphStorage = ZoneGraphData->GetStorageMutable();
+	AddLane(ZoneGraphStorage, 50, 2000.0f, RandomStream);
+	AddLane(ZoneGraphStorage, 400, 5000.0f, RandomStream);
+	AddZone(ZoneGraphStorage);
+	ZoneGraphData->FinishSpawning(FTransform::Identity);
+	if (!ZoneGraphStorage.DataHandle.IsValid())
+	{
+		ZoneGraphSubsystem->RegisterZoneGraphData(*ZoneGraphData);
+	}
+
+	FMassTrafficLaneSegmentTable LaneSegmentTable;
+	LaneSegmentTable.Build(ZoneGraphStorage);
+
+	// @return Distance along the lane UZoneGraphSubsystem finds for Location, searching the whole lane, or -1 if none.
+	auto FindNearestDistanceAlongLane = [&](const int32 LaneIndex, const FVector& Location, float& OutDistanceSq)
+	{
+		FZoneGraphLaneLocation NearestLaneLocation;
+		if (!ZoneGraphSubsystem->FindNearestLocationOnLane(FZoneGraphLaneHandle(LaneIndex, ZoneGraphStorage.DataHandle), FBox::BuildAABB(Location, FVector(100000.0f)), NearestLaneLocation, OutDistanceSq))
+		{
+			return -1.0f;
+		}
+		return NearestLaneLocation.DistanceAlongLane;
+	};
+
+	// Nearby hits - locations a little ahead of the previous distance & a little off the lane, as vehicles move
+	bool bSuccess = true;
+	for (int32 LaneIndex = 0; LaneIndex < ZoneGraphStorage.Lanes.Num() && bSuccess; ++LaneIndex)
+	{
+		const FZoneLaneData& LaneData = ZoneGraphStorage.Lanes[LaneIndex];
+		const float LaneLength = ZoneGraphStorage.LanePointProgressions[LaneData.PointsEnd - 1];
+
+		for (int32 SampleIndex = 0; SampleIndex < 1000; ++SampleIndex)
+		{
+			const float DistanceAlongLane = RandomStream.FRandRange(0.0f, LaneLength);
+			const float PreviousDistanceAlongLane = FMath::Max(DistanceAlongLane - RandomStream.FRandRange(0.0f, 200.0f), 0.0f);
+			const FVector Location = GetLocationAlongLane(ZoneGraphStorage, LaneIndex, DistanceAlongLane, RandomStream.FRandRange(-50.0f, 50.0f));
+
+			float NearbyDistanceAlongLane = 0.0f;
+			float NearbyDistanceSq = 0.0f;
+			bSuccess &= TestTrue(TEXT("Nearby distance found"), UE::MassTraffic::FindNearbyDistanceAlongLane(ZoneGraphStorage, &LaneSegmentTable, LaneIndex, Location, PreviousDistanceAlongLane, SearchDistance, NearbyDistanceAlongLane, NearbyDistanceSq));
+
+			float NearestDistanceSq = 0.0f;
+			const float NearestDistanceAlongLane = FindNearestDistanceAlongLane(LaneIndex, Location, NearestDistanceSq);
+			bSuccess &= TestEqual(TEXT("Nearby distance along lane matches the whole lane search"), NearbyDistanceAlongLane, NearestDistanceAlongLane, DistanceTolerance);
+			bSuccess &= TestEqual(TEXT("Nearby distance from lane matches the whole lane search"), FMath::Sqrt(NearbyDistanceSq), FMath::Sqrt(NearestDistanceSq), DistanceTolerance);
+			if (!bSuccess)
+			{
+				AddError(FString::Printf(TEXT("Lane %d at distance %f, previously %f"), LaneIndex, DistanceAlongLane, PreviousDistanceAlongLane));
+				break;
+			}
+		}
+	}
+
+	// Fallbacks - the caller must search the whole lane instead, which still finds the right distance
+	const int32 LaneIndex = 0;
+	const float LaneLength = ZoneGraphStorage.LanePointProgressions[ZoneGraphStorage.Lanes[LaneIndex].PointsEnd - 1];
+	auto TestFallback = [&](const TCHAR* What, const FMassTrafficLaneSegmentTable* FallbackLaneSegmentTable, const float DistanceAlongLane, const float PreviousDistanceAlongLane, const float SideOffset)
+	{
+		const FVector Location = GetLocationAlongLane(ZoneGraphStorage, LaneIndex, DistanceAlongLane, SideOffset);
+
+		float NearbyDistanceAlongLane = 0.0f;
+		float NearbyDistanceSq = 0.0f;
+		TestFalse(FString::Printf(TEXT("%s - nearby distance found"), What), UE::MassTraffic::FindNearbyDistanceAlongLane(ZoneGraphStorage, FallbackLaneSegmentTable, LaneIndex, Location, PreviousDistanceAlongLane, SearchDistance, NearbyDistanceAlongLane, NearbyDistanceSq));
+
+		float NearestDistanceSq = 0.0f;
+		TestEqual(FString::Printf(TEXT("%s - whole lane search distance along lane"), What), FindNearestDistanceAlongLane(LaneIndex, Location, NearestDistanceSq), DistanceAlongLane, DistanceTolerance);
+	};
+
+	TestFallback(TEXT("Moved far ahead of the search range"), &LaneSegmentTable, LaneLength * 0.8f, LaneLength * 0.2f, 0.0f);
+	TestFallback(TEXT("Moved far behind the search range"), &LaneSegmentTable, LaneLength * 0.2f, LaneLength * 0.8f, 0.0f);
+	// (Out from the lane's curve, so the rest of the lane is further away)
+	TestFallback(TEXT("Deviated further from the lane than the search distance"), &LaneSegmentTable, LaneLength * 0.5f, LaneLength * 0.5f, -2.0f * SearchDistance);
+	TestFallback(TEXT("No lane segment table"), /*LaneSegmentTable*/nullptr, LaneLength * 0.5f, LaneLength * 0.5f, 0.0f);
+
+	float NearbyDistanceAlongLane = 0.0f;
+	float NearbyDistanceSq = 0.0f;
+	TestFalse(TEXT("Nearby distance found on an invalid lane"), UE::MassTraffic::FindNearbyDistanceAlongLane(ZoneGraphStorage, &LaneSegmentTable, ZoneGraphStorage.Lanes.Num(), FVector::ZeroVector, 0.0f, SearchDistance, NearbyDistanceAlongLane, NearbyDistanceSq));
+
+	GEngine->DestroyWorldContext(World);
+	World->DestroyWorld(false);
+
+	return bSuccess;
+}
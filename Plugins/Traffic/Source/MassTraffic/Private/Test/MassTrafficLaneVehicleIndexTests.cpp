@@ -0,0 +1,207 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "Misc/AutomationTest.h"
+
+#include "MassTrafficLaneChange.h"
+#include "MassTrafficTypes.h"
+
+#include "Algo/IsSorted.h"
+#include "MassEntityManager.h"
+#include "MassZoneGraphNavigationFragments.h"
+
+namespace UE::MassTraffic::LaneVehicleIndexTests
+{
+
+static constexpr int32 NumVehicles = 100;
+static constexpr float VehicleSpacing = 100.0f;
+
+/** Fills TrafficLaneData's Vehicles with vehicles 1 - NumVehicles, VehicleSpacing apart, starting VehicleSpacing along the lane. */
+static void AddVehicles(FZoneGraphTrafficLaneData& TrafficLaneData)
+{
+	for (int32 VehicleIndex = 0; VehicleIndex < NumVehicles; ++VehicleIndex)
+	{
+		TrafficLaneData.Vehicles.Emplace(FMassEntityHandle(VehicleIndex + 1, 1), VehicleSpacing * (VehicleIndex + 1), 50.0f);
+	}
+}
+
+/** Lane vehicles with real entities, for lookups that check their current lane locations. */
+struct FLaneVehicleEntities
+{
+	static constexpr int32 NumEntities = 10;
+
+	TSharedPtr<FMassEntityManager> EntityManager;
+	FZoneGraphTrafficLaneData TrafficLaneData;
+	FZoneGraphLaneHandle OtherLaneHandle;
+	TArray<FMassEntityHandle> Entities;
+
+	/** Vehicles 1 - NumEntities, VehicleSpacing apart, starting VehicleSpacing along the lane, all cached & current. */
+	FLaneVehicleEntities()
+		: EntityManager(MakeShareable(new FMassEntityManager()))
+	{
+		EntityManager->Initialize();
+		const FMassArchetypeHandle Archetype = EntityManager->CreateArchetype({ FMassZoneGraphLaneLocationFragment::StaticStruct() });
+
+		TrafficLaneData.LaneHandle = FZoneGraphLaneHandle(0, FZoneGraphDataHandle(1, 1));
+		OtherLaneHandle = FZoneGraphLaneHandle(1, FZoneGraphDataHandle(1, 1));
+
+		for (int32 VehicleIndex = 0; VehicleIndex < NumEntities; ++VehicleIndex)
+		{
+			const FMassEntityHandle Entity = Entities.Add_GetRef(EntityManager->CreateEntity(Archetype));
+			TrafficLaneData.Vehicles.Emplace(Entity, VehicleSpacing * (VehicleIndex + 1), 50.0f);
+			MoveVehicle(VehicleIndex + 1, TrafficLaneData.LaneHandle, VehicleSpacing * (VehicleIndex + 1));
+		}
+	}
+
+	~FLaneVehicleEntities()
+	{
+		EntityManager->Deinitialize();
+	}
+
+	/** Moves vehicle VehicleNumber, without updating its cached distance, as vehicles move during a frame. */
+	void MoveVehicle(const int32 VehicleNumber, const FZoneGraphLaneHandle LaneHandle, const float DistanceAlongLane)
+	{
+		FMassZoneGraphLaneLocationFragment& LaneLocationFragment = EntityManager->GetFragmentDataChecked<FMassZoneGraphLaneLocationFragment>(Entities[VehicleNumber - 1]);
+		LaneLocationFragment.LaneHandle = LaneHandle;
+		LaneLocationFragment.DistanceAlongLane = DistanceAlongLane;
+	}
+
+	/** @return Vehicle numbers behind & ahead of DistanceAlongLane, 0 for none, or -1 on failure. */
+	TPair<int32, int32> FindNearbyVehicles(const float DistanceAlongLane) const
+	{
+		FMassEntityHandle Entity_Behind;
+		FMassEntityHandle Entity_Ahead;
+		if (!FindNearbyVehiclesOnLane_RelativeToDistanceAlongLane(&TrafficLaneData, DistanceAlongLane, Entity_Behind, Entity_Ahead, *EntityManager))
+		{
+			return TPair<int32, int32>(-1, -1);
+		}
+
+		return TPair<int32, int32>(Entities.IndexOfByKey(Entity_Behind) + 1, Entities.IndexOfByKey(Entity_Ahead) + 1);
+	}
+};
+
+}
+
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FMassTrafficLaneVehicleIndexTest, "MassTraffic.LaneData.VehicleIndex", EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+// Looks up vehicles on a lane by distance and by entity, as lane changes do to find the neighbours on either lane,
+// including with a vehicle that has moved on since the cached distances were refreshed
+bool FMassTrafficLaneVehicleIndexTest::RunTest(const FString& Parameters)
+{
+	using namespace UE::MassTraffic::LaneVehicleIndexTests;
+
+	FZoneGraphTrafficLaneData TrafficLaneData;
+	TestEqual(TEXT("First vehicle ahead on an empty lane"), TrafficLaneData.FindFirstVehicleIndexAhead(500.0f), 0);
+	TestEqual(TEXT("Vehicle index on an empty lane"), TrafficLaneData.FindVehicleIndex(FMassEntityHandle(1, 1), 500.0f), INDEX_NONE);
+
+	AddVehicles(TrafficLaneData);
+
+	TestEqual(TEXT("First vehicle ahead of lane start"), TrafficLaneData.FindFirstVehicleIndexAhead(0.0f), 0);
+	TestEqual(TEXT("First vehicle ahead between vehicles"), TrafficLaneData.FindFirstVehicleIndexAhead(4.5f * VehicleSpacing), 4);
+	TestEqual(TEXT("First vehicle ahead level with a vehicle"), TrafficLaneData.FindFirstVehicleIndexAhead(5.0f * VehicleSpacing), 5);
+	TestEqual(TEXT("First vehicle ahead of the lead vehicle"), TrafficLaneData.FindFirstVehicleIndexAhead(VehicleSpacing * (NumVehicles + 1)), NumVehicles);
+
+	for (int32 VehicleIndex = 0; VehicleIndex < NumVehicles; ++VehicleIndex)
+	{
+		const FMassTrafficLaneVehicle& LaneVehicle = TrafficLaneData.Vehicles[VehicleIndex];
+		if (!TestEqual(TEXT("Vehicle index"), TrafficLaneData.FindVehicleIndex(LaneVehicle.Entity, LaneVehicle.DistanceAlongLane), VehicleIndex))
+		{
+			return false;
+		}
+	}
+
+	// Vehicle 10 has since moved past the cached distances of the next 2 vehicles
+	TestEqual(TEXT("Vehicle index after moving ahead"), TrafficLaneData.FindVehicleIndex(FMassEntityHandle(10, 1), 12.5f * VehicleSpacing), 9);
+
+	// Vehicle 10 was moved back along the lane
+	TestEqual(TEXT("Vehicle index after moving back"), TrafficLaneData.FindVehicleIndex(FMassEntityHandle(10, 1), 2.0f * VehicleSpacing), 9);
+
+	TestEqual(TEXT("Vehicle index of a vehicle on another lane"), TrafficLaneData.FindVehicleIndex(FMassEntityHandle(NumVehicles + 1, 1), 50.0f * VehicleSpacing), INDEX_NONE);
+
+	return true;
+}
+
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FMassTrafficLaneVehicleInsertTest, "MassTraffic.LaneData.VehicleInsert", EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+// Inserts vehicles mid frame, at distances past the stale cached distances of the vehicles around them, as lane changes
+// & vehicles moving onto a lane do. Cached distances must stay sorted, for FindFirstVehicleIndexAhead's binary search
+bool FMassTrafficLaneVehicleInsertTest::RunTest(const FString& Parameters)
+{
+	using namespace UE::MassTraffic::LaneVehicleIndexTests;
+
+	FZoneGraphTrafficLaneData TrafficLaneData;
+	AddVehicles(TrafficLaneData);
+
+	// Vehicles 10 & 11 have since moved to 10.8 & 11.6, and a vehicle lane changes in between them at 11.2
+	const FMassEntityHandle LaneChangingEntity(NumVehicles + 1, 1);
+	TrafficLaneData.InsertVehicleAhead(FMassEntityHandle(10, 1), LaneChangingEntity, 11.2f * VehicleSpacing, 50.0f);
+	TestEqual(TEXT("Lane changing vehicle index"), TrafficLaneData.FindVehicleIndex(LaneChangingEntity, 11.2f * VehicleSpacing), 10);
+	TestTrue(TEXT("Cached distances sorted after inserting past a stale vehicle ahead"), Algo::IsSortedBy(TrafficLaneData.Vehicles, &FMassTrafficLaneVehicle::DistanceAlongLane));
+	TestTrue(TEXT("Inserted vehicle's cached distance not ahead of its current distance"), TrafficLaneData.Vehicles[10].DistanceAlongLane <= 11.2f * VehicleSpacing);
+
+	// A vehicle lane changes in ahead of vehicle 19, though it's still slightly behind it, at 18.5
+	const FMassEntityHandle LevelEntity(NumVehicles + 2, 1);
+	TrafficLaneData.InsertVehicleAhead(FMassEntityHandle(19, 1), LevelEntity, 18.5f * VehicleSpacing, 50.0f);
+	TestTrue(TEXT("Cached distances sorted after inserting ahead of a vehicle further along"), Algo::IsSortedBy(TrafficLaneData.Vehicles, &FMassTrafficLaneVehicle::DistanceAlongLane));
+	TestEqual(TEXT("Level vehicle index"), TrafficLaneData.FindVehicleIndex(LevelEntity, 18.5f * VehicleSpacing), 20);
+	TestEqual(TEXT("Vehicle index of the vehicle it's level with"), TrafficLaneData.FindVehicleIndex(FMassEntityHandle(19, 1), 19.0f * VehicleSpacing), 19);
+
+	// A vehicle moves onto the lane as the new tail, past the stale cached distance of the old tail
+	const FMassEntityHandle TailEntity(NumVehicles + 3, 1);
+	TrafficLaneData.AddTailVehicle(TailEntity, 1.5f * VehicleSpacing, 50.0f);
+	TestTrue(TEXT("Cached distances sorted after adding a tail vehicle"), Algo::IsSortedBy(TrafficLaneData.Vehicles, &FMassTrafficLaneVehicle::DistanceAlongLane));
+	TestEqual(TEXT("Tail vehicle index"), TrafficLaneData.FindVehicleIndex(TailEntity, 1.5f * VehicleSpacing), 0);
+
+	// Every vehicle can still be found from its current distance, which is at least its cached distance
+	TestEqual(TEXT("Vehicle index after inserts"), TrafficLaneData.FindVehicleIndex(FMassEntityHandle(50, 1), 50.0f * VehicleSpacing), 52);
+	TestEqual(TEXT("First vehicle ahead after inserts"), TrafficLaneData.FindFirstVehicleIndexAhead(30.5f * VehicleSpacing), 33);
+
+	return true;
+}
+
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FMassTrafficLaneNearbyVehiclesTest, "MassTraffic.LaneData.NearbyVehicles", EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+// Finds the vehicles behind & ahead of a distance along a lane, as lane changes do on the lane being changed onto, with
+// neighbours that have moved past their stale cached distances or left the lane since Vehicles was refreshed
+bool FMassTrafficLaneNearbyVehiclesTest::RunTest(const FString& Parameters)
+{
+	using namespace UE::MassTraffic::LaneVehicleIndexTests;
+
+	FLaneVehicleEntities LaneVehicles;
+	auto TestNearbyVehicles = [this, &LaneVehicles](const TCHAR* What, const float DistanceAlongLane, const int32 ExpectedBehind, const int32 ExpectedAhead)
+	{
+		const TPair<int32, int32> NearbyVehicles = LaneVehicles.FindNearbyVehicles(DistanceAlongLane);
+		TestEqual(FString::Printf(TEXT("%s - vehicle behind"), What), NearbyVehicles.Key, ExpectedBehind);
+		TestEqual(FString::Printf(TEXT("%s - vehicle ahead"), What), NearbyVehicles.Value, ExpectedAhead);
+	};
+
+	TestNearbyVehicles(TEXT("Between vehicles"), 4.5f * VehicleSpacing, 4, 5);
+	TestNearbyVehicles(TEXT("Behind the tail vehicle"), 0.5f * VehicleSpacing, 0, 1);
+	TestNearbyVehicles(TEXT("Ahead of the lead vehicle"), 10.5f * VehicleSpacing, 10, 0);
+
+	// Vehicle 4 has since moved past 4.5, so is ahead rather than behind
+	LaneVehicles.MoveVehicle(4, LaneVehicles.TrafficLaneData.LaneHandle, 4.7f * VehicleSpacing);
+	TestNearbyVehicles(TEXT("Stale vehicle behind"), 4.5f * VehicleSpacing, 3, 4);
+
+	// Vehicle 3 has too
+	LaneVehicles.MoveVehicle(3, LaneVehicles.TrafficLaneData.LaneHandle, 4.6f * VehicleSpacing);
+	TestNearbyVehicles(TEXT("Several stale vehicles behind"), 4.5f * VehicleSpacing, 2, 3);
+
+	LaneVehicles.MoveVehicle(3, LaneVehicles.TrafficLaneData.LaneHandle, 3.0f * VehicleSpacing);
+	LaneVehicles.MoveVehicle(4, LaneVehicles.TrafficLaneData.LaneHandle, 4.0f * VehicleSpacing);
+	TestNearbyVehicles(TEXT("Between vehicles after moving back"), 4.5f * VehicleSpacing, 4, 5);
+
+	// Vehicle 5 has left the lane without being removed from Vehicles
+	LaneVehicles.MoveVehicle(5, LaneVehicles.OtherLaneHandle, 5.0f * VehicleSpacing);
+	TestNearbyVehicles(TEXT("Out of lane vehicle behind"), 5.2f * VehicleSpacing, 4, 6);
+	TestNearbyVehicles(TEXT("Out of lane vehicle ahead"), 4.8f * VehicleSpacing, 4, 6);
+
+	// The lead vehicle has moved on to its next lane
+	LaneVehicles.MoveVehicle(10, LaneVehicles.OtherLaneHandle, 0.5f * VehicleSpacing);
+	TestNearbyVehicles(TEXT("Out of lane lead vehicle ahead"), 9.5f * VehicleSpacing, 9, 0);
+	TestNearbyVehicles(TEXT("Out of lane lead vehicle behind"), 10.5f * VehicleSpacing, 9, 0);
+
+	return true;
+}
@@ -0,0 +1,94 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "Misc/AutomationTest.h"
+
+#include "MassTrafficTypes.h"
+
+namespace UE::MassTraffic::NextLaneRouteTests
+{
+
+enum ELane
+{
+	Road,
+	StraightIntersectionLane,
+	LeftTurnIntersectionLane,
+	BrokenIntersectionLane,
+	MergeLane,
+	StraightExitLane,
+	LeftExitLane,
+	NumLanes
+};
+
+/**
+ * Road leads into 3 intersection lanes & a merge lane. The straight intersection lane exits onto StraightExitLane, the
+ * left turn, which isn't a trunk lane, onto LeftExitLane, and the broken intersection lane onto both exit lanes.
+ */
+static void BuildLaneData(FMassTrafficZoneGraphData& TrafficZoneGraphData)
+{
+	TrafficZoneGraphData.TrafficLaneDataArray.SetNum(NumLanes);
+	TArray<FZoneGraphTrafficLaneData>& Lanes = TrafficZoneGraphData.TrafficLaneDataArray;
+	for (int32 LaneIndex = 0; LaneIndex < NumLanes; ++LaneIndex)
+	{
+		Lanes[LaneIndex].LaneHandle = FZoneGraphLaneHandle(LaneIndex, FZoneGraphDataHandle(1, 1));
+		Lanes[LaneIndex].Length = 1000.0f * (LaneIndex + 1);
+		Lanes[LaneIndex].ConstData.bIsTrunkLane = true;
+		TrafficZoneGraphData.TrafficLaneDataLookup.Add(&Lanes[LaneIndex]);
+	}
+
+	Lanes[StraightIntersectionLane].ConstData.bIsIntersectionLane = true;
+	Lanes[LeftTurnIntersectionLane].ConstData.bIsIntersectionLane = true;
+	Lanes[LeftTurnIntersectionLane].ConstData.bIsTrunkLane = false;
+	Lanes[LeftTurnIntersectionLane].bTurnsLeft = true;
+	Lanes[BrokenIntersectionLane].ConstData.bIsIntersectionLane = true;
+
+	Lanes[Road].NextLanes = { &Lanes[StraightIntersectionLane], &Lanes[LeftTurnIntersectionLane], &Lanes[BrokenIntersectionLane], &Lanes[MergeLane] };
+	Lanes[StraightIntersectionLane].NextLanes = { &Lanes[StraightExitLane] };
+	Lanes[LeftTurnIntersectionLane].NextLanes = { &Lanes[LeftExitLane] };
+	Lanes[BrokenIntersectionLane].NextLanes = { &Lanes[StraightExitLane], &Lanes[LeftExitLane] };
+	Lanes[MergeLane].NextLanes = { &Lanes[StraightExitLane] };
+}
+
+}
+
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FMassTrafficNextLaneRouteTest, "MassTraffic.LaneData.NextLaneRoutes", EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+// Builds next lane routes for a lane leading into an intersection, checking intersection lanes are routed by their
+// exit lane, non intersection lanes by themselves, trunk & turn flags are cached and unroutable lanes left out
+bool FMassTrafficNextLaneRouteTest::RunTest(const FString& Parameters)
+{
+	using namespace UE::MassTraffic::NextLaneRouteTests;
+
+	FMassTrafficZoneGraphData TrafficZoneGraphData;
+	BuildLaneData(TrafficZoneGraphData);
+
+	AddExpectedError(TEXT("should have only one next lane, but it has 2"), EAutomationExpectedErrorFlags::Contains, 1);
+	TrafficZoneGraphData.BuildNextLaneRoutes();
+
+	const TArray<FZoneGraphTrafficLaneData>& Lanes = TrafficZoneGraphData.TrafficLaneDataArray;
+	const TArrayView<const FMassTrafficNextLaneRoute> Routes = Lanes[Road].NextLaneRoutes;
+	if (!TestEqual(TEXT("Number of routes"), Routes.Num(), 3))
+	{
+		return false;
+	}
+
+	TestTrue(TEXT("Straight route next lane"), Routes[0].NextLane == &Lanes[StraightIntersectionLane]);
+	TestTrue(TEXT("Straight route destination lane"), Routes[0].DestinationLane == &Lanes[StraightExitLane]);
+	TestEqual(TEXT("Straight route destination lane length"), Routes[0].DestinationLaneLength, Lanes[StraightExitLane].Length);
+	TestTrue(TEXT("Straight route is trunk lane"), Routes[0].bIsTrunkLane);
+	TestFalse(TEXT("Straight route turns left"), Routes[0].bTurnsLeft);
+
+	TestTrue(TEXT("Left turn route next lane"), Routes[1].NextLane == &Lanes[LeftTurnIntersectionLane]);
+	TestTrue(TEXT("Left turn route destination lane"), Routes[1].DestinationLane == &Lanes[LeftExitLane]);
+	TestFalse(TEXT("Left turn route is trunk lane"), Routes[1].bIsTrunkLane);
+	TestTrue(TEXT("Left turn route turns left"), Routes[1].bTurnsLeft);
+
+	TestTrue(TEXT("Merge route next lane"), Routes[2].NextLane == &Lanes[MergeLane]);
+	TestTrue(TEXT("Merge route destination lane"), Routes[2].DestinationLane == &Lanes[MergeLane]);
+	TestEqual(TEXT("Merge route destination lane length"), Routes[2].DestinationLaneLength, Lanes[MergeLane].Length);
+
+	TestEqual(TEXT("Number of intersection lane routes"), Lanes[StraightIntersectionLane].NextLaneRoutes.Num(), 1);
+	TestEqual(TEXT("Number of exit lane routes"), Lanes[StraightExitLane].NextLaneRoutes.Num(), 0);
+
+	return true;
+}
@@ -0,0 +1,110 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "Misc/AutomationTest.h"
+
+#include "MassTrafficParkedVehicleSpawnDataGenerator.h"
+#include "MassTrafficUtils.h"
+
+#include "HAL/PlatformTime.h"
+
+namespace UE::MassTraffic::ObstacleExclusionBenchmark
+{
+
+static constexpr int32 NumParkingSpaces = 100000;
+static constexpr int32 NumObstacles = 20000;
+static constexpr float WorldSize = 500000.0f;
+static constexpr float ObstacleExclusionRadius = 500.0f;
+
+static FVector RandLocation(const FRandomStream& RandomStream)
+{
+	return FVector(RandomStream.FRandRange(0.0f, WorldSize), RandomStream.FRandRange(0.0f, WorldSize), RandomStream.FRandRange(0.0f, 1000.0f));
+}
+
+/** The original exhaustive test of every parking space against every obstacle. */
+static void RemoveParkingSpacesNearObstacles_BruteForce(TArray<FTransform>& ParkingSpaceTransforms, const TArray<FVector>& ObstacleLocations)
+{
+	const float ObstacleRadiusSquared = FMath::Square(ObstacleExclusionRadius);
+	for (int32 ParkingSpaceIndex = 0; ParkingSpaceIndex < ParkingSpaceTransforms.Num(); )
+	{
+		const FVector ParkingSpacePosition = ParkingSpaceTransforms[ParkingSpaceIndex].GetLocation();
+
+		bool bOverlapsObstacle = false;
+		for (const FVector& ObstacleLocation : ObstacleLocations)
+		{
+			if (FVector::DistSquared(ParkingSpacePosition, ObstacleLocation) < ObstacleRadiusSquared)
+			{
+				bOverlapsObstacle = true;
+				break;
+			}
+		}
+
+		if (bOverlapsObstacle)
+		{
+			ParkingSpaceTransforms.RemoveAtSwap(ParkingSpaceIndex);
+		}
+		else
+		{
+			++ParkingSpaceIndex;
+		}
+	}
+}
+
+}
+
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FMassTrafficObstacleExclusionBenchmark, "MassTraffic.Benchmark.ParkedVehicleObstacleExclusion", EAutomationTestFlags::EditorContext | EAutomationTestFlags::PerfFilter)
+
+// Compares removing parking spaces near obstacles by testing every space against every obstacle, against querying
+// obstacles through FObstacleExclusionGrid, for 100k parking spaces & 20k obstacles, and checks both keep exactly the
+// same spaces in the same order
+bool FMassTrafficObstacleExclusionBenchmark::RunTest(const FString& Parameters)
+{
+	using namespace UE::MassTraffic::ObstacleExclusionBenchmark;
+
+	const FRandomStream RandomStream(1234);
+
+	TArray<FTransform> ParkingSpaceTransforms;
+	ParkingSpaceTransforms.Reserve(NumParkingSpaces);
+	for (int32 ParkingSpaceIndex = 0; ParkingSpaceIndex < NumParkingSpaces; ++ParkingSpaceIndex)
+	{
+		ParkingSpaceTransforms.Add(FTransform(FRotator(0.0f, RandomStream.FRandRange(0.0f, 360.0f), 0.0f), RandLocation(RandomStream)));
+	}
+
+	TArray<FVector> ObstacleLocations;
+	ObstacleLocations.Reserve(NumObstacles);
+	for (int32 ObstacleIndex = 0; ObstacleIndex < NumObstacles; ++ObstacleIndex)
+	{
+		ObstacleLocations.Add(RandLocation(RandomStream));
+	}
+
+	// Brute force
+	TArray<FTransform> BruteForceParkingSpaceTransforms = ParkingSpaceTransforms;
+	const double BruteForceStartTime = FPlatformTime::Seconds();
+	RemoveParkingSpacesNearObstacles_BruteForce(BruteForceParkingSpaceTransforms, ObstacleLocations);
+	const double BruteForceMilliseconds = (FPlatformTime::Seconds() - BruteForceStartTime) * 1000.0;
+
+	// Spatially indexed, including building the index
+	TArray<FTransform> GridParkingSpaceTransforms = ParkingSpaceTransforms;
+	const double GridStartTime = FPlatformTime::Seconds();
+	const UE::MassTraffic::FObstacleExclusionGrid ObstacleExclusionGrid(ObstacleLocations, ObstacleExclusionRadius);
+	UMassTrafficParkedVehicleSpawnDataGenerator::RemoveParkingSpacesNearObstacles(GridParkingSpaceTransforms, ObstacleExclusionGrid);
+	const double GridMilliseconds = (FPlatformTime::Seconds() - GridStartTime) * 1000.0;
+
+	AddInfo(FString::Printf(TEXT("%d parking spaces, %d obstacles: brute force %.1f ms, grid %.1f ms (%.1fx), %d spaces kept"),
+		NumParkingSpaces, NumObstacles, BruteForceMilliseconds, GridMilliseconds, GridMilliseconds > 0.0 ? BruteForceMilliseconds / GridMilliseconds : 0.0, GridParkingSpaceTransforms.Num()));
+
+	if (!TestEqual(TEXT("Number of parking spaces kept"), GridParkingSpaceTransforms.Num(), BruteForceParkingSpaceTransforms.Num()))
+	{
+		return false;
+	}
+	for (int32 ParkingSpaceIndex = 0; ParkingSpaceIndex < GridParkingSpaceTransforms.Num(); ++ParkingSpaceIndex)
+	{
+		if (!GridParkingSpaceTransforms[ParkingSpaceIndex].GetLocation().Equals(BruteForceParkingSpaceTransforms[ParkingSpaceIndex].GetLocation(), 0.0f))
+		{
+			AddError(FString::Printf(TEXT("Parking space %d differs"), ParkingSpaceIndex));
+			return false;
+		}
+	}
+
+	return true;
+}
@@ -0,0 +1,1113 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "Misc/AutomationTest.h"
+
+#include "MassTraffic.h"
+#include "MassTrafficChooseNextLaneProcessor.h"
+#include "MassTrafficFragments.h"
+#include "MassTrafficInitTrafficVehiclesProcessor.h"
+#include "MassTrafficIntersectionSimulationTrait.h"
+#include "MassTrafficIntersectionSpawnDataGenerator.h"
+#include "MassTrafficLaneChangingProcessor.h"
+#include "MassTrafficSettings.h"
+#include "MassTrafficSubsystem.h"
+#include "MassTrafficVehicleControlProcessor.h"
+#include "MassTrafficVehicleSimulationTrait.h"
+
+#include "Dom/JsonObject.h"
+#include "Engine/Engine.h"
+#include "Engine/World.h"
+#include "HAL/PlatformMemory.h"
+#include "HAL/FileManager.h"
+#include "HAL/PlatformTime.h"
+#include "MassAssortedFragmentsTrait.h"
+#include "MassCommonFragments.h"
+#include "MassEntityConfigAsset.h"
+#include "MassEntityManager.h"
+#include "MassEntitySubsystem.h"
+#include "MassExecutor.h"
+#include "MassProcessorDependencySolver.h"
+#include "MassRepresentationFragments.h"
+#include "MassSpawnerSubsystem.h"
+#include "MassZoneGraphNavigationFragments.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Serialization/JsonSerializer.h"
+#include "UObject/UObjectIterator.h"
+#include "ZoneGraphData.h"
+#include "ZoneGraphQuery.h"
+#include "ZoneGraphSubsystem.h"
+
+namespace UE::MassTraffic::SimulationBenchmark
+{
+
+/** Synthetic grid & simulation size, parsed from the test parameters. */
+struct FBenchmarkParameters
+{
+	/** Number of intersections along each side of the grid. */
+	int32 GridSize = 4;
+
+	/** Number of lanes each road has in each direction. */
+	int32 LanesPerDirection = 1;
+
+	int32 NumVehicles = 200;
+	int32 NumTicks = 300;
+	float DeltaTime = 1.0f / 30.0f;
+
+	/** @see GMassTrafficScheduleIntersections */
+	bool bScheduleIntersections = true;
+
+	/** Also simulate with bScheduleIntersections flipped, checking both end with the same checksum. */
+	bool bCompareUnscheduled = false;
+
+	/** @see GMassTrafficParallelVehicleBehavior, GMassTrafficParallelFieldOperations */
+	bool bParallel = true;
+
+	/** Also simulate with bParallel flipped, checking both end with the same checksum. */
+	bool bCompareSerial = true;
+
+	/** Only run these processors, or every auto registered MassTraffic processor if empty. */
+	TArray<const UClass*> ProcessorClasses;
+
+	void Parse(const FString& Parameters)
+	{
+		FParse::Value(*Parameters, TEXT("GridSize="), GridSize);
+		FParse::Value(*Parameters, TEXT("LanesPerDirection="), LanesPerDirection);
+		FParse::Value(*Parameters, TEXT("NumVehicles="), NumVehicles);
+		FParse::Value(*Parameters, TEXT("NumTicks="), NumTicks);
+		FParse::Value(*Parameters, TEXT("DeltaTime="), DeltaTime);
+		FParse::Bool(*Parameters, TEXT("ScheduleIntersections="), bScheduleIntersections);
+		FParse::Bool(*Parameters, TEXT("CompareUnscheduled="), bCompareUnscheduled);
+		FParse::Bool(*Parameters, TEXT("Parallel="), bParallel);
+		FParse::Bool(*Parameters, TEXT("CompareSerial="), bCompareSerial);
+
+		GridSize = FMath::Max(GridSize, 2);
+		LanesPerDirection = FMath::Clamp(LanesPerDirection, 1, 4);
+		NumVehicles = FMath::Max(NumVehicles, 0);
+		NumTicks = FMath::Max(NumTicks, 1);
+		DeltaTime = FMath::Max(DeltaTime, KINDA_SMALL_NUMBER);
+	}
+};
+
+static constexpr float BlockSize = 6000.0f;
+static constexpr float LaneWidth = 350.0f;
+static constexpr float IntersectionMargin = 300.0f;
+static constexpr float RoadLanePointSpacing = 1000.0f;
+static constexpr int32 NumIntersectionLanePoints = 6;
+static constexpr float VehicleSpacing = 1200.0f;
+static constexpr int32 RandomSeed = 1234;
+
+/** Intersection sides, as directions pointing away from the intersection center. */
+static constexpr int32 NumSides = 4;
+static const FVector SideDirections[NumSides] = { FVector(1.0f, 0.0f, 0.0f), FVector(0.0f, 1.0f, 0.0f), FVector(-1.0f, 0.0f, 0.0f), FVector(0.0f, -1.0f, 0.0f) };
+
+static int32 GetOppositeSide(const int32 Side)
+{
+	return (Side + 2) % NumSides;
+}
+
+static FVector GetRightDirection(const FVector& Direction)
+{
+	return FVector(-Direction.Y, Direction.X, 0.0f);
+}
+
+/** @return Tags any lane tagged with will pass Filter, assuming Filter's tags don't contradict each other. */
+static FZoneGraphTagMask GetTagsPassingFilter(const FZoneGraphTagFilter& Filter)
+{
+	const uint32 AnyTags = Filter.AnyTags.GetValue();
+	return FZoneGraphTagMask(Filter.AllTags.GetValue() | (AnyTags & (~AnyTags + 1)));
+}
+
+/** Road lanes entering & leaving one side of an intersection, from the left most lane to the right most. */
+struct FIntersectionSideLanes
+{
+	TArray<int32> IncomingLanes;
+	TArray<int32> OutgoingLanes;
+};
+
+/** Builds a ZoneGraph storage of GridSize x GridSize intersections, connected by two way roads. */
+class FSyntheticGridBuilder
+{
+public:
+
+	FSyntheticGridBuilder(FZoneGraphStorage& InStorage, const FBenchmarkParameters& InParameters, const UMassTrafficSettings& MassTrafficSettings)
+		: Storage(InStorage)
+		, Parameters(InParameters)
+		, IntersectionHalfSize(InParameters.LanesPerDirection * LaneWidth + IntersectionMargin)
+	{
+		RoadTags = GetTagsPassingFilter(MassTrafficSettings.TrafficLaneFilter);
+		RoadTags.Add(GetTagsPassingFilter(MassTrafficSettings.TrunkLaneFilter));
+		RoadTags.Add(GetTagsPassingFilter(MassTrafficSettings.LaneChangingLaneFilter));
+
+		IntersectionTags = GetTagsPassingFilter(MassTrafficSettings.TrafficLaneFilter);
+		IntersectionTags.Add(GetTagsPassingFilter(MassTrafficSettings.IntersectionLaneFilter));
+	}
+
+	/** @return Indices of all road (i.e: non intersection) lanes. */
+	TArray<int32> Build()
+	{
+		Storage.Reset();
+		IntersectionSides.SetNum(Parameters.GridSize * Parameters.GridSize);
+
+		// Roads east & north of each intersection
+		for (int32 Y = 0; Y < Parameters.GridSize; ++Y)
+		{
+			for (int32 X = 0; X < Parameters.GridSize; ++X)
+			{
+				if (X + 1 < Parameters.GridSize)
+				{
+					AddRoad(X, Y, X + 1, Y, /*Side*/0);
+				}
+				if (Y + 1 < Parameters.GridSize)
+				{
+					AddRoad(X, Y, X, Y + 1, /*Side*/1);
+				}
+			}
+		}
+
+		for (int32 IntersectionIndex = 0; IntersectionIndex < IntersectionSides.Num(); ++IntersectionIndex)
+		{
+			AddIntersection(IntersectionIndex);
+		}
+
+		// Flatten links
+		for (int32 LaneIndex = 0; LaneIndex < Storage.Lanes.Num(); ++LaneIndex)
+		{
+			FZoneLaneData& Lane = Storage.Lanes[LaneIndex];
+			Lane.LinksBegin = Storage.LaneLinks.Num();
+			Storage.LaneLinks.Append(LaneLinks[LaneIndex]);
+			Lane.LinksEnd = Storage.LaneLinks.Num();
+		}
+
+		Storage.Bounds.Init();
+		for (const FZoneData& Zone : Storage.Zones)
+		{
+			Storage.Bounds += Zone.Bounds;
+		}
+		Storage.ZoneBVTree.Build(MakeStridedView(Storage.Zones, &FZoneData::Bounds));
+
+		return RoadLanes;
+	}
+
+private:
+
+	FVector GetIntersectionCenter(const int32 X, const int32 Y) const
+	{
+		return FVector(X * BlockSize, Y * BlockSize, 0.0f);
+	}
+
+	int32 AddLane(TConstArrayView<FVector> Points, const FZoneGraphTagMask Tags, FBox& ZoneBounds)
+	{
+		const int32 LaneIndex = Storage.Lanes.Num();
+		FZoneLaneData& Lane = Storage.Lanes.AddDefaulted_GetRef();
+		Lane.Width = LaneWidth;
+		Lane.Tags = Tags;
+		Lane.ZoneIndex = Storage.Zones.Num();
+		Lane.PointsBegin = Storage.LanePoints.Num();
+
+		float Progression = 0.0f;
+		for (int32 PointIndex = 0; PointIndex < Points.Num(); ++PointIndex)
+		{
+			const FVector& Point = Points[PointIndex];
+			if (PointIndex > 0)
+			{
+				Progression += FVector::Distance(Points[PointIndex - 1], Point);
+			}
+
+			const FVector Tangent = PointIndex + 1 < Points.Num() ? Points[PointIndex + 1] - Point : Point - Points[PointIndex - 1];
+			Storage.LanePoints.Add(Point);
+			Storage.LaneTangentVectors.Add(Tangent.GetSafeNormal());
+			Storage.LaneUpVectors.Add(FVector::UpVector);
+			Storage.LanePointProgressions.Add(Progression);
+
+			ZoneBounds += Point;
+		}
+
+		Lane.PointsEnd = Storage.LanePoints.Num();
+		LaneLinks.AddDefaulted();
+
+		return LaneIndex;
+	}
+
+	void AddZone(const int32 LanesBegin, const FZoneGraphTagMask Tags, const FBox& ZoneBounds)
+	{
+		FZoneData& Zone = Storage.Zones.AddDefaulted_GetRef();
+		Zone.LanesBegin = LanesBegin;
+		Zone.LanesEnd = Storage.Lanes.Num();
+		Zone.BoundaryPointsBegin = Storage.BoundaryPoints.Num();
+		Zone.BoundaryPointsEnd = Storage.BoundaryPoints.Num();
+		Zone.Bounds = ZoneBounds.ExpandBy(LaneWidth);
+		Zone.Tags = Tags;
+	}
+
+	void AddLink(const int32 LaneIndex, const int32 DestLaneIndex, const EZoneLaneLinkType Type, const EZoneLaneLinkFlags Flags = EZoneLaneLinkFlags::None)
+	{
+		LaneLinks[LaneIndex].Add(FZoneLaneLinkData(DestLaneIndex, Type, Flags));
+	}
+
+	/** Adds a road zone with LanesPerDirection lanes in each direction, between 2 neighboring intersections. */
+	void AddRoad(const int32 FromX, const int32 FromY, const int32 ToX, const int32 ToY, const int32 Side)
+	{
+		const int32 FromIntersectionIndex = FromY * Parameters.GridSize + FromX;
+		const int32 ToIntersectionIndex = ToY * Parameters.GridSize + ToX;
+		const FVector FromCenter = GetIntersectionCenter(FromX, FromY);
+		const FVector ToCenter = GetIntersectionCenter(ToX, ToY);
+
+		const int32 LanesBegin = Storage.Lanes.Num();
+		FBox ZoneBounds(ForceInit);
+
+		for (const bool bReverse : { false, true })
+		{
+			const FVector Start = bReverse ? ToCenter : FromCenter;
+			const FVector End = bReverse ? FromCenter : ToCenter;
+			const FVector Direction = (End - Start).GetSafeNormal();
+			const FVector RightDirection = GetRightDirection(Direction);
+			const float Length = FVector::Distance(Start, End) - 2.0f * IntersectionHalfSize;
+			const int32 NumSegments = FMath::Max(1, FMath::CeilToInt(Length / RoadLanePointSpacing));
+
+			FIntersectionSideLanes& StartSide = IntersectionSides[bReverse ? ToIntersectionIndex : FromIntersectionIndex][bReverse ? GetOppositeSide(Side) : Side];
+			FIntersectionSideLanes& EndSide = IntersectionSides[bReverse ? FromIntersectionIndex : ToIntersectionIndex][bReverse ? Side : GetOppositeSide(Side)];
+
+			const int32 FirstLaneIndex = Storage.Lanes.Num();
+			for (int32 LaneInDirection = 0; LaneInDirection < Parameters.LanesPerDirection; ++LaneInDirection)
+			{
+				const FVector LaneStart = Start + Direction * IntersectionHalfSize + RightDirection * (LaneWidth * (LaneInDirection + 0.5f));
+
+				TArray<FVector, TInlineAllocator<16>> Points;
+				for (int32 PointIndex = 0; PointIndex <= NumSegments; ++PointIndex)
+				{
+					Points.Add(LaneStart + Direction * (Length * PointIndex / NumSegments));
+				}
+
+				const int32 LaneIndex = AddLane(Points, RoadTags, ZoneBounds);
+				StartSide.OutgoingLanes.Add(LaneIndex);
+				EndSide.IncomingLanes.Add(LaneIndex);
+				RoadLanes.Add(LaneIndex);
+			}
+
+			// Lanes are added from the left most to the right most
+			for (int32 LaneInDirection = 0; LaneInDirection < Parameters.LanesPerDirection; ++LaneInDirection)
+			{
+				const int32 LaneIndex = FirstLaneIndex + LaneInDirection;
+				if (LaneInDirection > 0)
+				{
+					AddLink(LaneIndex, LaneIndex - 1, EZoneLaneLinkType::Adjacent, EZoneLaneLinkFlags::Left);
+				}
+				if (LaneInDirection + 1 < Parameters.LanesPerDirection)
+				{
+					AddLink(LaneIndex, LaneIndex + 1, EZoneLaneLinkType::Adjacent, EZoneLaneLinkFlags::Right);
+				}
+			}
+		}
+
+		AddZone(LanesBegin, RoadTags, ZoneBounds);
+	}
+
+	/**
+	 * Adds an intersection zone with lanes from each incoming road lane to the same lane straight ahead. The right most
+	 * lane can also turn right & the left most turn left. Where there's no road straight ahead, all lanes can turn, so
+	 * every road lane has somewhere to go, even at the edges of the grid.
+	 */
+	void AddIntersection(const int32 IntersectionIndex)
+	{
+		const TStaticArray<FIntersectionSideLanes, NumSides>& Sides = IntersectionSides[IntersectionIndex];
+		const int32 LanesBegin = Storage.Lanes.Num();
+		FBox ZoneBounds(ForceInit);
+
+		for (int32 IncomingSide = 0; IncomingSide < NumSides; ++IncomingSide)
+		{
+			const TArray<int32>& IncomingLanes = Sides[IncomingSide].IncomingLanes;
+			const FVector IncomingDirection = -SideDirections[IncomingSide];
+			const bool bHasStraightRoad = !Sides[GetOppositeSide(IncomingSide)].OutgoingLanes.IsEmpty();
+
+			for (int32 OutgoingSide = 0; OutgoingSide < NumSides; ++OutgoingSide)
+			{
+				const TArray<int32>& OutgoingLanes = Sides[OutgoingSide].OutgoingLanes;
+				if (OutgoingSide == IncomingSide || OutgoingLanes.IsEmpty())
+				{
+					continue;
+				}
+
+				const FVector OutgoingDirection = SideDirections[OutgoingSide];
+				const bool bIsStraight = OutgoingSide == GetOppositeSide(IncomingSide);
+				const bool bIsRightTurn = !bIsStraight && FVector::DotProduct(GetRightDirection(IncomingDirection), OutgoingDirection) > 0.5f;
+
+				for (int32 LaneInDirection = 0; LaneInDirection < IncomingLanes.Num(); ++LaneInDirection)
+				{
+					int32 OutgoingLaneInDirection = LaneInDirection;
+					if (!bIsStraight)
+					{
+						const int32 TurningLaneInDirection = bIsRightTurn ? IncomingLanes.Num() - 1 : 0;
+						if (LaneInDirection != TurningLaneInDirection && bHasStraightRoad)
+						{
+							continue;
+						}
+						OutgoingLaneInDirection = TurningLaneInDirection;
+					}
+
+					const int32 IncomingLaneIndex = IncomingLanes[LaneInDirection];
+					const int32 OutgoingLaneIndex = OutgoingLanes[OutgoingLaneInDirection];
+
+					// Cubic curve from the end of the incoming lane to the start of the outgoing one
+					const FVector Start = Storage.LanePoints[Storage.Lanes[IncomingLaneIndex].PointsEnd - 1];
+					const FVector End = Storage.LanePoints[Storage.Lanes[OutgoingLaneIndex].PointsBegin];
+					const float ControlPointDistance = FVector::Distance(Start, End) / 3.0f;
+					const FVector StartControlPoint = Start + IncomingDirection * ControlPointDistance;
+					const FVector EndControlPoint = End - OutgoingDirection * ControlPointDistance;
+
+					TArray<FVector, TInlineAllocator<NumIntersectionLanePoints>> Points;
+					for (int32 PointIndex = 0; PointIndex < NumIntersectionLanePoints; ++PointIndex)
+					{
+						const float Alpha = static_cast<float>(PointIndex) / (NumIntersectionLanePoints - 1);
+						Points.Add(FMath::CubicInterp(Start, (StartControlPoint - Start) * 3.0f, End, (End - EndControlPoint) * 3.0f, Alpha));
+					}
+
+					const int32 LaneIndex = AddLane(Points, IntersectionTags, ZoneBounds);
+					AddLink(LaneIndex, IncomingLaneIndex, EZoneLaneLinkType::Incoming);
+					AddLink(LaneIndex, OutgoingLaneIndex, EZoneLaneLinkType::Outgoing);
+					AddLink(IncomingLaneIndex, LaneIndex, EZoneLaneLinkType::Outgoing);
+					AddLink(OutgoingLaneIndex, LaneIndex, EZoneLaneLinkType::Incoming);
+				}
+			}
+		}
+
+		AddZone(LanesBegin, IntersectionTags, ZoneBounds);
+	}
+
+	FZoneGraphStorage& Storage;
+	const FBenchmarkParameters& Parameters;
+	const float IntersectionHalfSize;
+
+	FZoneGraphTagMask RoadTags;
+	FZoneGraphTagMask IntersectionTags;
+
+	TArray<TStaticArray<FIntersectionSideLanes, NumSides>> IntersectionSides;
+	TArray<TArray<FZoneLaneLinkData>> LaneLinks;
+	TArray<int32> RoadLanes;
+};
+
+/** @return Evenly spaced, non overlapping vehicle locations along RoadLanes, in a deterministic random order. */
+static TArray<FZoneGraphLaneLocation> GetVehicleLaneLocations(const FZoneGraphStorage& Storage, const TArray<int32>& RoadLanes, const int32 NumVehicles)
+{
+	TArray<FZoneGraphLaneLocation> LaneLocations;
+	for (const int32 LaneIndex : RoadLanes)
+	{
+		const FZoneGraphLaneHandle LaneHandle(LaneIndex, Storage.DataHandle);
+
+		float LaneLength = 0.0f;
+		UE::ZoneGraph::Query::GetLaneLength(Storage, LaneHandle, LaneLength);
+		for (float DistanceAlongLane = VehicleSpacing * 0.5f; DistanceAlongLane < LaneLength - VehicleSpacing * 0.5f; DistanceAlongLane += VehicleSpacing)
+		{
+			UE::ZoneGraph::Query::CalculateLocationAlongLane(Storage, LaneHandle, DistanceAlongLane, LaneLocations.AddDefaulted_GetRef());
+		}
+	}
+
+	const FRandomStream RandomStream(RandomSeed);
+	for (int32 Index = LaneLocations.Num() - 1; Index > 0; --Index)
+	{
+		LaneLocations.Swap(Index, RandomStream.RandRange(0, Index));
+	}
+
+	LaneLocations.SetNum(FMath::Min(NumVehicles, LaneLocations.Num()));
+
+	return LaneLocations;
+}
+
+/**
+ * All auto registered MassTraffic processors, or only those of ProcessorClasses if not empty, sorted into execution
+ * order, per processing phase.
+ */
+static TArray<TArray<UMassProcessor*>> CreateTrafficProcessors(UMassTrafficSubsystem& MassTrafficSubsystem, TConstArrayView<const UClass*> ProcessorClasses)
+{
+	TArray<TArray<UMassProcessor*>> PhaseProcessors;
+	PhaseProcessors.SetNum(static_cast<int32>(EMassProcessingPhase::MAX));
+
+	const UPackage* MassTrafficPackage = UMassTrafficSubsystem::StaticClass()->GetOuterUPackage();
+	for (TObjectIterator<UClass> ClassIt; ClassIt; ++ClassIt)
+	{
+		if (!ClassIt->IsChildOf(UMassProcessor::StaticClass()) || ClassIt->HasAnyClassFlags(CLASS_Abstract) || ClassIt->GetOuterUPackage() != MassTrafficPackage)
+		{
+			continue;
+		}
+
+		if (!ProcessorClasses.IsEmpty() && !ProcessorClasses.Contains(*ClassIt))
+		{
+			continue;
+		}
+
+		const UMassProcessor* ProcessorCDO = GetDefault<UMassProcessor>(*ClassIt);
+		if (!ProcessorCDO->ShouldAutoAddToGlobalList() || !ProcessorCDO->ShouldExecute(EProcessorExecutionFlags::Standalone))
+		{
+			continue;
+		}
+
+		UMassProcessor* Processor = NewObject<UMassProcessor>(&MassTrafficSubsystem, *ClassIt);
+		Processor->Initialize(MassTrafficSubsystem);
+		PhaseProcessors[static_cast<int32>(Processor->GetProcessingPhase())].Add(Processor);
+	}
+
+	for (TArray<UMassProcessor*>& Processors : PhaseProcessors)
+	{
+		TArray<FMassProcessorOrderInfo> SortedProcessors;
+		FMassProcessorDependencySolver DependencySolver(MakeArrayView(Processors));
+		DependencySolver.ResolveDependencies(SortedProcessors);
+
+		Processors.Reset();
+		for (const FMassProcessorOrderInfo& OrderInfo : SortedProcessors)
+		{
+			if (OrderInfo.Processor)
+			{
+				Processors.Add(OrderInfo.Processor);
+			}
+		}
+	}
+
+	return PhaseProcessors;
+}
+
+/**
+ * @return Checksum of every vehicle's lane location & transform, to the nearest cm, followed by every intersection's
+ * current period, period time remaining & traffic light states, in entity order.
+ */
+static uint32 GetSimulationChecksum(const TSharedPtr<FMassEntityManager>& EntityManager, int32& OutNumVehicles)
+{
+	struct FVehicleState
+	{
+		int32 EntityIndex;
+		int32 LaneIndex;
+		int32 DistanceAlongLane;
+		FIntVector Location;
+	};
+	TArray<FVehicleState> VehicleStates;
+
+	FMassEntityQuery VehicleQuery;
+	VehicleQuery.AddTagRequirement<FMassTrafficVehicleTag>(EMassFragmentPresence::All);
+	VehicleQuery.AddRequirement<FMassZoneGraphLaneLocationFragment>(EMassFragmentAccess::ReadOnly);
+	VehicleQuery.AddRequirement<FTransformFragment>(EMassFragmentAccess::ReadOnly);
+
+	FMassExecutionContext ExecutionContext(EntityManager, 0.0f);
+	VehicleQuery.ForEachEntityChunk(*EntityManager.Get(), ExecutionContext, [&VehicleStates](FMassExecutionContext& QueryContext)
+	{
+		const TConstArrayView<FMassZoneGraphLaneLocationFragment> LaneLocationFragments = QueryContext.GetFragmentView<FMassZoneGraphLaneLocationFragment>();
+		const TConstArrayView<FTransformFragment> TransformFragments = QueryContext.GetFragmentView<FTransformFragment>();
+
+		const int32 NumEntities = QueryContext.GetNumEntities();
+		for (int32 Index = 0; Index < NumEntities; ++Index)
+		{
+			const FVector Location = TransformFragments[Index].GetTransform().GetLocation();
+			VehicleStates.Add({
+				QueryContext.GetEntity(Index).Index,
+				LaneLocationFragments[Index].LaneHandle.Index,
+				FMath::RoundToInt(LaneLocationFragments[Index].DistanceAlongLane),
+				FIntVector(FMath::RoundToInt(Location.X), FMath::RoundToInt(Location.Y), FMath::RoundToInt(Location.Z))});
+		}
+	});
+
+	struct FIntersectionState
+	{
+		int32 EntityIndex;
+		uint32 CurrentPeriodIndex;
+		uint32 PeriodTimeRemaining;
+		uint32 TrafficLightsChecksum;
+	};
+	TArray<FIntersectionState> IntersectionStates;
+
+	FMassEntityQuery IntersectionQuery;
+	IntersectionQuery.AddRequirement<FMassTrafficIntersectionFragment>(EMassFragmentAccess::ReadOnly);
+
+	IntersectionQuery.ForEachEntityChunk(*EntityManager.Get(), ExecutionContext, [&IntersectionStates](FMassExecutionContext& QueryContext)
+	{
+		const TConstArrayView<FMassTrafficIntersectionFragment> IntersectionFragments = QueryContext.GetFragmentView<FMassTrafficIntersectionFragment>();
+
+		const int32 NumEntities = QueryContext.GetNumEntities();
+		for (int32 Index = 0; Index < NumEntities; ++Index)
+		{
+			const FMassTrafficIntersectionFragment& IntersectionFragment = IntersectionFragments[Index];
+
+			TArray<EMassTrafficLightStateFlags, TInlineAllocator<MASSTRAFFIC_NUM_INLINE_INTERSECTION_TRAFFIC_LIGHTS>> TrafficLightStates;
+			for (const FMassTrafficLight& TrafficLight : IntersectionFragment.TrafficLights)
+			{
+				TrafficLightStates.Add(TrafficLight.TrafficLightStateFlags);
+			}
+
+			IntersectionStates.Add({
+				QueryContext.GetEntity(Index).Index,
+				IntersectionFragment.CurrentPeriodIndex,
+				IntersectionFragment.PeriodTimeRemaining.Encoded,
+				FCrc::MemCrc32(TrafficLightStates.GetData(), TrafficLightStates.Num() * TrafficLightStates.GetTypeSize())});
+		}
+	});
+
+	VehicleStates.Sort([](const FVehicleState& A, const FVehicleState& B) { return A.EntityIndex < B.EntityIndex; });
+	IntersectionStates.Sort([](const FIntersectionState& A, const FIntersectionState& B) { return A.EntityIndex < B.EntityIndex; });
+
+	OutNumVehicles = VehicleStates.Num();
+	const uint32 VehiclesChecksum = FCrc::MemCrc32(VehicleStates.GetData(), VehicleStates.Num() * VehicleStates.GetTypeSize());
+	return FCrc::MemCrc32(IntersectionStates.GetData(), IntersectionStates.Num() * IntersectionStates.GetTypeSize(), VehiclesChecksum);
+}
+
+static int64 GetUsedPhysicalMemory()
+{
+	return static_cast<int64>(FPlatformMemory::GetStats().UsedPhysical);
+}
+
+/** Timings & memory deltas of one processor, over every tick of a simulation. */
+struct FProcessorResult
+{
+	FString Name;
+	int32 PhaseIndex = 0;
+	double TotalMilliseconds = 0.0;
+	double MaxMilliseconds = 0.0;
+	int64 TotalMemoryDeltaBytes = 0;
+	int64 MaxMemoryDeltaBytes = 0;
+};
+
+/** Size, timings, memory deltas & final checksum of one simulation of the synthetic grid. */
+struct FSimulationResult
+{
+	int32 NumLanes = 0;
+	int32 NumIntersections = 0;
+	int32 NumVehicleLocations = 0;
+	int32 NumVehiclesSpawned = 0;
+	int32 NumVehiclesSimulated = 0;
+	double SetupMilliseconds = 0.0;
+	double SimulationMilliseconds = 0.0;
+	int64 SetupMemoryDeltaBytes = 0;
+	int64 SimulationMemoryDeltaBytes = 0;
+	uint32 Checksum = 0;
+	TArray<FProcessorResult> Processors;
+};
+
+/** Called at the end of every tick of RunSimulation. */
+using FOnSimulationTicked = TFunction<void(FMassEntityManager& EntityManager, UMassTrafficSubsystem& MassTrafficSubsystem)>;
+
+/**
+ * Generates a synthetic grid of intersections & roads in a new headless world, spawns intersections & vehicles on it and
+ * runs every auto registered MassTraffic processor, in dependency order, for a fixed number of fixed delta time ticks.
+ * No rendering, physics assets or viewers are involved, so vehicles run at Off LOD.
+ * @return Whether the world could be set up. Errors are reported to Test.
+ */
+static bool RunSimulation(FAutomationTestBase& Test, const FBenchmarkParameters& Parameters, FSimulationResult& OutResult, const FOnSimulationTicked& OnTicked = nullptr)
+{
+	// Don't write the synthetic grid's lane data into the project's lane data cache
+	TGuardValue<bool> CacheLaneDataGuard(GetMutableDefault<UMassTrafficSettings>()->bCacheLaneData, false);
+
+	TGuardValue<int32> ScheduleIntersectionsGuard(GMassTrafficScheduleIntersections, Parameters.bScheduleIntersections ? 1 : 0);
+	TGuardValue<int32> ParallelVehicleBehaviorGuard(GMassTrafficParallelVehicleBehavior, Parameters.bParallel ? 1 : 0);
+	TGuardValue<int32> ParallelFieldOperationsGuard(GMassTrafficParallelFieldOperations, Parameters.bParallel ? 1 : 0);
+
+	UWorld* World = UWorld::CreateWorld(EWorldType::Game, /*bInformEngineOfWorld*/false);
+	FWorldContext& WorldContext = GEngine->CreateNewWorldContext(EWorldType::Game);
+	WorldContext.SetCurrentWorld(World);
+
+	UMassTrafficSubsystem* MassTrafficSubsystem = World->GetSubsystem<UMassTrafficSubsystem>();
+	UZoneGraphSubsystem* ZoneGraphSubsystem = World->GetSubsystem<UZoneGraphSubsystem>();
+	UMassSpawnerSubsystem* SpawnerSubsystem = World->GetSubsystem<UMassSpawnerSubsystem>();
+	if (!MassTrafficSubsystem || !ZoneGraphSubsystem || !SpawnerSubsystem)
+	{
+		Test.AddError(TEXT("Traffic, ZoneGraph or Mass spawner subsystem missing from benchmark world"));
+		GEngine->DestroyWorldContext(World);
+		World->DestroyWorld(false);
+		return false;
+	}
+	const TSharedPtr<FMassEntityManager> EntityManager = World->GetSubsystem<UMassEntitySubsystem>()->GetMutableEntityManager().AsShared();
+
+	const int64 MemoryBeforeSetup = GetUsedPhysicalMemory();
+	const double SetupStartTime = FPlatformTime::Seconds();
+
+	// Synthetic ZoneGraph, registered like any level's ZoneGraph data
+	AZoneGraphData* ZoneGraphData = World->SpawnActorDeferred<AZoneGraphData>(AZoneGraphData::StaticClass(), FTransform::Identity);
+	FSyntheticGridBuilder GridBuilder(ZoneGraphData->GetStorageMutable(), Parameters, *GetDefault<UMassTrafficSettings>());
+	const TArray<int32> RoadLanes = GridBuilder.Build();
+	ZoneGraphData->FinishSpawning(FTransform::Identity);
+	if (!ZoneGraphData->GetStorage().DataHandle.IsValid())
+	{
+		ZoneGraphSubsystem->RegisterZoneGraphData(*ZoneGraphData);
+	}
+	const FZoneGraphStorage& ZoneGraphStorage = ZoneGraphData->GetStorage();
+
+	// Intersections
+	UMassEntityConfigAsset* IntersectionConfig = NewObject<UMassEntityConfigAsset>();
+	IntersectionConfig->GetMutableConfig().AddTrait(*NewObject<UMassTrafficIntersectionSimulationTrait>(IntersectionConfig));
+	const FMassEntityTemplate& IntersectionTemplate = IntersectionConfig->GetConfig().GetOrCreateEntityTemplate(*World, *IntersectionConfig);
+
+	TArray<FMassEntityHandle> IntersectionEntities;
+	UMassTrafficIntersectionSpawnDataGenerator* IntersectionSpawnDataGenerator = NewObject<UMassTrafficIntersectionSpawnDataGenerator>();
+	FFinishedGeneratingSpawnDataSignature OnIntersectionSpawnDataGenerated = FFinishedGeneratingSpawnDataSignature::CreateLambda([&](TConstArrayView<FMassEntitySpawnDataGeneratorResult> Results)
+	{
+		for (const FMassEntitySpawnDataGeneratorResult& Result : Results)
+		{
+			SpawnerSubsystem->SpawnEntities(IntersectionTemplate.GetTemplateID(), Result.NumEntities, FConstStructView(Result.SpawnData), Result.SpawnDataProcessor, IntersectionEntities);
+		}
+	});
+	IntersectionSpawnDataGenerator->Generate(*MassTrafficSubsystem, TConstArrayView<FMassSpawnedEntityType>(), /*Count*/0, OnIntersectionSpawnDataGenerated);
+
+	// Vehicles, without a physics template or visualization, as the simulation only needs the tag & a couple of
+	// fragments visualization traits usually add
+	UMassEntityConfigAsset* VehicleConfig = NewObject<UMassEntityConfigAsset>();
+	UMassTrafficVehicleSimulationTrait* VehicleSimulationTrait = NewObject<UMassTrafficVehicleSimulationTrait>(VehicleConfig);
+	VehicleSimulationTrait->Params.HalfLength = 225.0f;
+	VehicleSimulationTrait->Params.HalfWidth = 90.0f;
+	VehicleConfig->GetMutableConfig().AddTrait(*VehicleSimulationTrait);
+	UMassAssortedFragmentsTrait* VehicleFragmentsTrait = NewObject<UMassAssortedFragmentsTrait>(VehicleConfig);
+	VehicleFragmentsTrait->Fragments.Add(FInstancedStruct::Make<FMassTrafficRandomFractionFragment>());
+	VehicleFragmentsTrait->Fragments.Add(FInstancedStruct::Make<FMassTrafficVehicleLightsFragment>());
+	VehicleFragmentsTrait->Fragments.Add(FInstancedStruct::Make<FMassRepresentationFragment>());
+	VehicleFragmentsTrait->Tags.Add(FInstancedStruct::Make<FMassTrafficVehicleTag>());
+	VehicleConfig->GetMutableConfig().AddTrait(*VehicleFragmentsTrait);
+	const FMassEntityTemplate& VehicleTemplate = VehicleConfig->GetConfig().GetOrCreateEntityTemplate(*World, *VehicleConfig);
+
+	FMassTrafficVehiclesSpawnData VehiclesSpawnData;
+	VehiclesSpawnData.LaneLocations = GetVehicleLaneLocations(ZoneGraphStorage, RoadLanes, Parameters.NumVehicles);
+
+	TArray<FMassEntityHandle> VehicleEntities;
+	SpawnerSubsystem->SpawnEntities(VehicleTemplate.GetTemplateID(), VehiclesSpawnData.LaneLocations.Num(), FConstStructView::Make(VehiclesSpawnData), UMassTrafficInitTrafficVehiclesProcessor::StaticClass(), VehicleEntities);
+
+	const TArray<TArray<UMassProcessor*>> PhaseProcessors = CreateTrafficProcessors(*MassTrafficSubsystem, Parameters.ProcessorClasses);
+
+	OutResult.SetupMilliseconds = (FPlatformTime::Seconds() - SetupStartTime) * 1000.0;
+	const int64 MemoryAfterSetup = GetUsedPhysicalMemory();
+
+	// Simulate
+	TMap<const UMassProcessor*, FProcessorResult> ProcessorResults;
+
+	FMassProcessingContext ProcessingContext(*EntityManager.Get(), Parameters.DeltaTime);
+	const double SimulationStartTime = FPlatformTime::Seconds();
+	for (int32 Tick = 0; Tick < Parameters.NumTicks; ++Tick)
+	{
+		for (const TArray<UMassProcessor*>& Processors : PhaseProcessors)
+		{
+			for (UMassProcessor* Processor : Processors)
+			{
+				// Memory is sampled outside the timed region, as querying it isn't free
+				const int64 ProcessorStartMemory = GetUsedPhysicalMemory();
+				const double ProcessorStartTime = FPlatformTime::Seconds();
+				UE::Mass::Executor::RunProcessorsView(MakeArrayView(&Processor, 1), ProcessingContext);
+				const double ProcessorMilliseconds = (FPlatformTime::Seconds() - ProcessorStartTime) * 1000.0;
+				const int64 ProcessorMemoryDeltaBytes = GetUsedPhysicalMemory() - ProcessorStartMemory;
+
+				FProcessorResult& ProcessorResult = ProcessorResults.FindOrAdd(Processor);
+				ProcessorResult.TotalMilliseconds += ProcessorMilliseconds;
+				ProcessorResult.MaxMilliseconds = FMath::Max(ProcessorResult.MaxMilliseconds, ProcessorMilliseconds);
+				ProcessorResult.TotalMemoryDeltaBytes += ProcessorMemoryDeltaBytes;
+				ProcessorResult.MaxMemoryDeltaBytes = FMath::Max(ProcessorResult.MaxMemoryDeltaBytes, ProcessorMemoryDeltaBytes);
+			}
+		}
+
+		if (OnTicked)
+		{
+			OnTicked(*EntityManager, *MassTrafficSubsystem);
+		}
+	}
+	OutResult.SimulationMilliseconds = (FPlatformTime::Seconds() - SimulationStartTime) * 1000.0;
+	const int64 MemoryAfterSimulation = GetUsedPhysicalMemory();
+
+	OutResult.Checksum = GetSimulationChecksum(EntityManager, OutResult.NumVehiclesSimulated);
+	OutResult.NumLanes = ZoneGraphStorage.Lanes.Num();
+	OutResult.NumIntersections = IntersectionEntities.Num();
+	OutResult.NumVehicleLocations = VehiclesSpawnData.LaneLocations.Num();
+	OutResult.NumVehiclesSpawned = VehicleEntities.Num();
+	OutResult.SetupMemoryDeltaBytes = MemoryAfterSetup - MemoryBeforeSetup;
+	OutResult.SimulationMemoryDeltaBytes = MemoryAfterSimulation - MemoryAfterSetup;
+
+	OutResult.Processors.Reset();
+	for (int32 PhaseIndex = 0; PhaseIndex < PhaseProcessors.Num(); ++PhaseIndex)
+	{
+		for (const UMassProcessor* Processor : PhaseProcessors[PhaseIndex])
+		{
+			FProcessorResult& ProcessorResult = OutResult.Processors.Add_GetRef(ProcessorResults.FindChecked(Processor));
+			ProcessorResult.Name = Processor->GetClass()->GetName();
+			ProcessorResult.PhaseIndex = PhaseIndex;
+		}
+	}
+
+	GEngine->DestroyWorldContext(World);
+	World->DestroyWorld(false);
+
+	return true;
+}
+
+/** A vehicle's transform, keyed by its replay ID. (See FMassTrafficVehicleIdFragment.) */
+struct FVehicleTransform
+{
+	int32 VehicleId;
+	FVector Location;
+	FQuat Rotation;
+};
+
+/** @return Every vehicle's transform, sorted by ID. */
+static TArray<FVehicleTransform> GetVehicleTransforms(FMassEntityManager& EntityManager)
+{
+	TArray<FVehicleTransform> VehicleTransforms;
+
+	FMassEntityQuery VehicleQuery;
+	VehicleQuery.AddTagRequirement<FMassTrafficVehicleTag>(EMassFragmentPresence::All);
+	VehicleQuery.AddRequirement<FMassTrafficVehicleIdFragment>(EMassFragmentAccess::ReadOnly);
+	VehicleQuery.AddRequirement<FTransformFragment>(EMassFragmentAccess::ReadOnly);
+
+	FMassExecutionContext ExecutionContext(EntityManager.AsShared(), 0.0f);
+	VehicleQuery.ForEachEntityChunk(EntityManager, ExecutionContext, [&VehicleTransforms](FMassExecutionContext& QueryContext)
+	{
+		const TConstArrayView<FMassTrafficVehicleIdFragment> VehicleIdFragments = QueryContext.GetFragmentView<FMassTrafficVehicleIdFragment>();
+		const TConstArrayView<FTransformFragment> TransformFragments = QueryContext.GetFragmentView<FTransformFragment>();
+
+		const int32 NumEntities = QueryContext.GetNumEntities();
+		for (int32 Index = 0; Index < NumEntities; ++Index)
+		{
+			const FTransform& Transform = TransformFragments[Index].GetTransform();
+			VehicleTransforms.Add({ VehicleIdFragments[Index].VehicleId, Transform.GetLocation(), Transform.GetRotation() });
+		}
+	});
+
+	VehicleTransforms.Sort([](const FVehicleTransform& A, const FVehicleTransform& B) { return A.VehicleId < B.VehicleId; });
+
+	return VehicleTransforms;
+}
+
+/**
+ * @return What's wrong with the first lane whose vehicles, tail vehicle or vehicles' next vehicles don't match the lane
+ * locations of the vehicles on it, or an empty string if every lane matches & holds NumVehicles in total.
+ */
+static FString FindLaneVehiclesMismatch(FMassEntityManager& EntityManager, const UMassTrafficSubsystem& MassTrafficSubsystem, const int32 NumVehicles)
+{
+	int32 NumLaneVehicles = 0;
+	for (const FMassTrafficZoneGraphData& TrafficZoneGraphData : MassTrafficSubsystem.GetTrafficZoneGraphData())
+	{
+		for (const FZoneGraphTrafficLaneData& TrafficLaneData : TrafficZoneGraphData.TrafficLaneDataArray)
+		{
+			const TArray<FMassTrafficLaneVehicle>& Vehicles = TrafficLaneData.Vehicles;
+			NumLaneVehicles += Vehicles.Num();
+
+			if (TrafficLaneData.TailVehicle != (Vehicles.IsEmpty() ? FMassEntityHandle() : Vehicles[0].Entity))
+			{
+				return FString::Printf(TEXT("Lane %s tail vehicle isn't its first vehicle"), *TrafficLaneData.LaneHandle.ToString());
+			}
+
+			for (int32 VehicleIndex = 0; VehicleIndex < Vehicles.Num(); ++VehicleIndex)
+			{
+				const FMassEntityHandle Entity = Vehicles[VehicleIndex].Entity;
+				const FMassZoneGraphLaneLocationFragment& LaneLocationFragment = EntityManager.GetFragmentDataChecked<FMassZoneGraphLaneLocationFragment>(Entity);
+				if (LaneLocationFragment.LaneHandle != TrafficLaneData.LaneHandle)
+				{
+					return FString::Printf(TEXT("Lane %s vehicle %d is on lane %s"), *TrafficLaneData.LaneHandle.ToString(), VehicleIndex, *LaneLocationFragment.LaneHandle.ToString());
+				}
+
+				if (VehicleIndex + 1 < Vehicles.Num())
+				{
+					const FMassEntityHandle AheadEntity = Vehicles[VehicleIndex + 1].Entity;
+					if (EntityManager.GetFragmentDataChecked<FMassZoneGraphLaneLocationFragment>(AheadEntity).DistanceAlongLane < LaneLocationFragment.DistanceAlongLane)
+					{
+						return FString::Printf(TEXT("Lane %s vehicle %d is ahead of the next one"), *TrafficLaneData.LaneHandle.ToString(), VehicleIndex);
+					}
+					if (EntityManager.GetFragmentDataChecked<FMassTrafficNextVehicleFragment>(Entity).GetNextVehicle() != AheadEntity)
+					{
+						return FString::Printf(TEXT("Lane %s vehicle %d next vehicle isn't the one ahead of it"), *TrafficLaneData.LaneHandle.ToString(), VehicleIndex);
+					}
+				}
+			}
+		}
+	}
+
+	if (NumLaneVehicles != NumVehicles)
+	{
+		return FString::Printf(TEXT("Lanes hold %d vehicles, not %d"), NumLaneVehicles, NumVehicles);
+	}
+
+	return FString();
+}
+
+}
+
+
+IMPLEMENT_COMPLEX_AUTOMATION_TEST(FMassTrafficSimulationBenchmark, "MassTraffic.Benchmark.Simulation", EAutomationTestFlags::EditorContext | EAutomationTestFlags::PerfFilter)
+
+void FMassTrafficSimulationBenchmark::GetTests(TArray<FString>& OutBeautifiedNames, TArray<FString>& OutTestCommands) const
+{
+	OutBeautifiedNames.Add(TEXT("Small"));
+	OutTestCommands.Add(TEXT("GridSize=4 LanesPerDirection=1 NumVehicles=200 NumTicks=300"));
+
+	OutBeautifiedNames.Add(TEXT("Medium"));
+	OutTestCommands.Add(TEXT("GridSize=8 LanesPerDirection=2 NumVehicles=2000 NumTicks=300"));
+
+	OutBeautifiedNames.Add(TEXT("Large"));
+	OutTestCommands.Add(TEXT("GridSize=16 LanesPerDirection=3 NumVehicles=10000 NumTicks=300"));
+
+	// City wide signal network, mostly measuring intersections, with & without scheduling them by their period deadlines
+	OutBeautifiedNames.Add(TEXT("Intersections"));
+	OutTestCommands.Add(TEXT("GridSize=64 LanesPerDirection=1 NumVehicles=2000 NumTicks=900 CompareUnscheduled=1"));
+}
+
+// Simulates a synthetic grid of intersections & roads (see RunSimulation.) Per processor timings, memory deltas and a
+// checksum of the final simulation state are reported and saved to Saved/MassTraffic/Benchmark as JSON, to compare
+// between versions. The grid is simulated again serially (unless CompareSerial=0) and, with CompareUnscheduled=1, with
+// intersection scheduling off, both of which must end with the same checksum
+bool FMassTrafficSimulationBenchmark::RunTest(const FString& Parameters)
+{
+	using namespace UE::MassTraffic::SimulationBenchmark;
+
+	FBenchmarkParameters BenchmarkParameters;
+	BenchmarkParameters.Parse(Parameters);
+
+	// Expected for a headless world
+	AddExpectedError(TEXT("No PhysicsVehicleTemplateActor set"), EAutomationExpectedErrorFlags::Contains, 0);
+	AddExpectedError(TEXT("No TrafficLightTypesData asset specified"), EAutomationExpectedErrorFlags::Contains, 0);
+	AddExpectedError(TEXT("No TrafficLightInstanceData asset specified"), EAutomationExpectedErrorFlags::Contains, 0);
+
+	FSimulationResult Result;
+	if (!RunSimulation(*this, BenchmarkParameters, Result))
+	{
+		return false;
+	}
+
+	if (Result.NumVehicleLocations < BenchmarkParameters.NumVehicles)
+	{
+		AddWarning(FString::Printf(TEXT("Grid only has room for %d of %d vehicles"), Result.NumVehicleLocations, BenchmarkParameters.NumVehicles));
+	}
+
+	FSimulationResult UnscheduledResult;
+	if (BenchmarkParameters.bCompareUnscheduled)
+	{
+		FBenchmarkParameters UnscheduledParameters = BenchmarkParameters;
+		UnscheduledParameters.bScheduleIntersections = !BenchmarkParameters.bScheduleIntersections;
+		if (!RunSimulation(*this, UnscheduledParameters, UnscheduledResult))
+		{
+			return false;
+		}
+
+		// Scheduling only skips intersections that can't change state yet, so must not change the simulation
+		TestEqual(TEXT("Checksum with & without intersection scheduling"), Result.Checksum, UnscheduledResult.Checksum);
+	}
+
+	FSimulationResult SerialResult;
+	if (BenchmarkParameters.bCompareSerial)
+	{
+		FBenchmarkParameters SerialParameters = BenchmarkParameters;
+		SerialParameters.bParallel = !BenchmarkParameters.bParallel;
+		if (!RunSimulation(*this, SerialParameters, SerialResult))
+		{
+			return false;
+		}
+
+		// Shared lane state is only changed through FMassTrafficLaneReservations, so processing chunks in parallel must
+		// not change the simulation
+		TestEqual(TEXT("Checksum in parallel & serially"), Result.Checksum, SerialResult.Checksum);
+	}
+
+	// Report
+	TSharedRef<FJsonObject> ReportObject = MakeShared<FJsonObject>();
+	ReportObject->SetStringField(TEXT("Parameters"), Parameters);
+	ReportObject->SetNumberField(TEXT("GridSize"), BenchmarkParameters.GridSize);
+	ReportObject->SetNumberField(TEXT("LanesPerDirection"), BenchmarkParameters.LanesPerDirection);
+	ReportObject->SetNumberField(TEXT("NumLanes"), Result.NumLanes);
+	ReportObject->SetNumberField(TEXT("NumIntersections"), Result.NumIntersections);
+	ReportObject->SetNumberField(TEXT("NumVehiclesSpawned"), Result.NumVehiclesSpawned);
+	ReportObject->SetNumberField(TEXT("NumVehiclesSimulated"), Result.NumVehiclesSimulated);
+	ReportObject->SetNumberField(TEXT("NumTicks"), BenchmarkParameters.NumTicks);
+	ReportObject->SetNumberField(TEXT("DeltaTime"), BenchmarkParameters.DeltaTime);
+	ReportObject->SetBoolField(TEXT("ScheduleIntersections"), BenchmarkParameters.bScheduleIntersections);
+	ReportObject->SetBoolField(TEXT("Parallel"), BenchmarkParameters.bParallel);
+	ReportObject->SetNumberField(TEXT("SetupMilliseconds"), Result.SetupMilliseconds);
+	ReportObject->SetNumberField(TEXT("SimulationMilliseconds"), Result.SimulationMilliseconds);
+	ReportObject->SetNumberField(TEXT("AverageTickMilliseconds"), Result.SimulationMilliseconds / BenchmarkParameters.NumTicks);
+	ReportObject->SetNumberField(TEXT("SetupMemoryDeltaBytes"), Result.SetupMemoryDeltaBytes);
+	ReportObject->SetNumberField(TEXT("SimulationMemoryDeltaBytes"), Result.SimulationMemoryDeltaBytes);
+	ReportObject->SetStringField(TEXT("Checksum"), FString::Printf(TEXT("%08X"), Result.Checksum));
+	if (BenchmarkParameters.bCompareUnscheduled)
+	{
+		ReportObject->SetNumberField(TEXT("UnscheduledSimulationMilliseconds"), UnscheduledResult.SimulationMilliseconds);
+		ReportObject->SetStringField(TEXT("UnscheduledChecksum"), FString::Printf(TEXT("%08X"), UnscheduledResult.Checksum));
+	}
+	if (BenchmarkParameters.bCompareSerial)
+	{
+		ReportObject->SetNumberField(TEXT("SerialSimulationMilliseconds"), SerialResult.SimulationMilliseconds);
+		ReportObject->SetStringField(TEXT("SerialChecksum"), FString::Printf(TEXT("%08X"), SerialResult.Checksum));
+	}
+
+	TArray<TSharedPtr<FJsonValue>> ProcessorValues;
+	for (const FProcessorResult& ProcessorResult : Result.Processors)
+	{
+		TSharedRef<FJsonObject> ProcessorObject = MakeShared<FJsonObject>();
+		ProcessorObject->SetStringField(TEXT("Name"), ProcessorResult.Name);
+		ProcessorObject->SetStringField(TEXT("Phase"), StaticEnum<EMassProcessingPhase>()->GetNameStringByValue(ProcessorResult.PhaseIndex));
+		ProcessorObject->SetNumberField(TEXT("TotalMilliseconds"), ProcessorResult.TotalMilliseconds);
+		ProcessorObject->SetNumberField(TEXT("AverageMilliseconds"), ProcessorResult.TotalMilliseconds / BenchmarkParameters.NumTicks);
+		ProcessorObject->SetNumberField(TEXT("MaxMilliseconds"), ProcessorResult.MaxMilliseconds);
+		ProcessorObject->SetNumberField(TEXT("MemoryDeltaBytes"), ProcessorResult.TotalMemoryDeltaBytes);
+		ProcessorObject->SetNumberField(TEXT("MaxTickMemoryDeltaBytes"), ProcessorResult.MaxMemoryDeltaBytes);
+		ProcessorValues.Add(MakeShared<FJsonValueObject>(ProcessorObject));
+
+		AddInfo(FString::Printf(TEXT("  %s: %.3f ms / tick (max %.3f ms), %lld bytes (max %lld bytes / tick)"), *ProcessorResult.Name,
+			ProcessorResult.TotalMilliseconds / BenchmarkParameters.NumTicks, ProcessorResult.MaxMilliseconds, ProcessorResult.TotalMemoryDeltaBytes, ProcessorResult.MaxMemoryDeltaBytes));
+	}
+	ReportObject->SetArrayField(TEXT("Processors"), ProcessorValues);
+
+	AddInfo(FString::Printf(TEXT("%dx%d grid, %d lanes, %d intersections, %d vehicles: %d ticks in %.1f ms (%.3f ms / tick), setup %.1f ms, checksum %08X"),
+		BenchmarkParameters.GridSize, BenchmarkParameters.GridSize, Result.NumLanes, Result.NumIntersections, Result.NumVehiclesSpawned,
+		BenchmarkParameters.NumTicks, Result.SimulationMilliseconds, Result.SimulationMilliseconds / BenchmarkParameters.NumTicks, Result.SetupMilliseconds, Result.Checksum));
+	if (BenchmarkParameters.bCompareSerial)
+	{
+		AddInfo(FString::Printf(TEXT("%s: %.1f ms (%.3f ms / tick), checksum %08X"),
+			BenchmarkParameters.bParallel ? TEXT("Serial") : TEXT("Parallel"), SerialResult.SimulationMilliseconds, SerialResult.SimulationMilliseconds / BenchmarkParameters.NumTicks, SerialResult.Checksum));
+	}
+	if (BenchmarkParameters.bCompareUnscheduled)
+	{
+		AddInfo(FString::Printf(TEXT("%s intersection scheduling: %.1f ms (%.3f ms / tick), checksum %08X"),
+			BenchmarkParameters.bScheduleIntersections ? TEXT("Without") : TEXT("With"), UnscheduledResult.SimulationMilliseconds, UnscheduledResult.SimulationMilliseconds / BenchmarkParameters.NumTicks, UnscheduledResult.Checksum));
+	}
+
+	FString ReportString;
+	const TSharedRef<TJsonWriter<>> ReportWriter = TJsonWriterFactory<>::Create(&ReportString);
+	FJsonSerializer::Serialize(ReportObject, ReportWriter);
+
+	const FString ReportFilename = FPaths::Combine(FPaths::ProjectSavedDir(), TEXT("MassTraffic"), TEXT("Benchmark"),
+		FString::Printf(TEXT("Simulation_%dx%d_%d_%d%s%s.json"), BenchmarkParameters.GridSize, BenchmarkParameters.GridSize, BenchmarkParameters.LanesPerDirection, Result.NumVehiclesSpawned,
+			BenchmarkParameters.bScheduleIntersections ? TEXT("") : TEXT("_Unscheduled"), BenchmarkParameters.bParallel ? TEXT("") : TEXT("_Serial")));
+	if (FFileHelper::SaveStringToFile(ReportString, *ReportFilename))
+	{
+		AddInfo(FString::Printf(TEXT("Saved benchmark report to %s"), *ReportFilename));
+	}
+	else
+	{
+		AddWarning(FString::Printf(TEXT("Couldn't save benchmark report to %s"), *ReportFilename));
+	}
+
+	TestEqual(TEXT("Number of vehicles spawned"), Result.NumVehiclesSpawned, Result.NumVehicleLocations);
+
+	return true;
+}
+
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FMassTrafficParallelVehicleBehaviorTest, "MassTraffic.Simulation.ParallelVehicleBehavior", EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+// Runs the vehicle control, choose next lane & lane change processors, the ones MassTraffic.ParallelVehicleBehavior
+// processes chunks of in parallel, on the benchmark's seeded grid, once in parallel & once serially. Real lanes, lane
+// changes & intersections are involved, unlike MassTraffic.LaneReservations.*, and both must end with the same checksum
+bool FMassTrafficParallelVehicleBehaviorTest::RunTest(const FString& Parameters)
+{
+	using namespace UE::MassTraffic::SimulationBenchmark;
+
+	FBenchmarkParameters SimulationParameters;
+	SimulationParameters.Parse(TEXT("GridSize=4 LanesPerDirection=2 NumVehicles=400 NumTicks=300"));
+	SimulationParameters.ProcessorClasses = {
+		UMassTrafficVehicleControlProcessor::StaticClass(),
+		UMassTrafficChooseNextLaneProcessor::StaticClass(),
+		UMassTrafficLaneChangingProcessor::StaticClass() };
+
+	// Expected for a headless world
+	AddExpectedError(TEXT("No PhysicsVehicleTemplateActor set"), EAutomationExpectedErrorFlags::Contains, 0);
+	AddExpectedError(TEXT("No TrafficLightTypesData asset specified"), EAutomationExpectedErrorFlags::Contains, 0);
+	AddExpectedError(TEXT("No TrafficLightInstanceData asset specified"), EAutomationExpectedErrorFlags::Contains, 0);
+
+	FSimulationResult ParallelResult;
+	SimulationParameters.bParallel = true;
+	if (!RunSimulation(*this, SimulationParameters, ParallelResult))
+	{
+		return false;
+	}
+
+	FSimulationResult SerialResult;
+	SimulationParameters.bParallel = false;
+	if (!RunSimulation(*this, SimulationParameters, SerialResult))
+	{
+		return false;
+	}
+
+	TestEqual(TEXT("Number of processors run"), ParallelResult.Processors.Num(), SimulationParameters.ProcessorClasses.Num());
+	TestTrue(TEXT("Vehicles simulated"), ParallelResult.NumVehiclesSimulated > 0);
+	TestEqual(TEXT("Number of vehicles simulated in parallel & serially"), ParallelResult.NumVehiclesSimulated, SerialResult.NumVehiclesSimulated);
+	TestEqual(TEXT("Checksum in parallel & serially"), ParallelResult.Checksum, SerialResult.Checksum);
+
+	return true;
+}
+
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FMassTrafficReplayTest, "MassTraffic.Simulation.Replay", EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+// Records the benchmark's seeded grid to a traffic replay, then plays it back on the same grid. Every vehicle must end
+// every tick of playback with exactly the transform it had at the end of the same tick of the recording, and lanes'
+// vehicles, tail vehicles & vehicles' next vehicles must match where the replayed vehicles are
+bool FMassTrafficReplayTest::RunTest(const FString& Parameters)
+{
+	using namespace UE::MassTraffic::SimulationBenchmark;
+
+	FBenchmarkParameters SimulationParameters;
+	SimulationParameters.Parse(TEXT("GridSize=4 LanesPerDirection=2 NumVehicles=400 NumTicks=300"));
+
+	// Expected for a headless world
+	AddExpectedError(TEXT("No PhysicsVehicleTemplateActor set"), EAutomationExpectedErrorFlags::Contains, 0);
+	AddExpectedError(TEXT("No TrafficLightTypesData asset specified"), EAutomationExpectedErrorFlags::Contains, 0);
+	AddExpectedError(TEXT("No TrafficLightInstanceData asset specified"), EAutomationExpectedErrorFlags::Contains, 0);
+
+	UMassTrafficSettings* MassTrafficSettings = GetMutableDefault<UMassTrafficSettings>();
+	const FString ReplayFilename = FPaths::ConvertRelativePathToFull(FPaths::Combine(FPaths::ProjectSavedDir(), TEXT("MassTraffic"), TEXT("Test"), TEXT("ReplayTest.bin")));
+	TGuardValue<FString> ReplayFilenameGuard(MassTrafficSettings->ReplayFilename, ReplayFilename);
+	TGuardValue<float> ReplayPlaybackRateGuard(MassTrafficSettings->ReplayPlaybackRate, 1.0f);
+
+	TArray<TArray<FVehicleTransform>> RecordedTransforms;
+	{
+		TGuardValue<int32> ReplayGuard(GMassTrafficReplay, 1 /*record*/);
+		FSimulationResult RecordResult;
+		if (!RunSimulation(*this, SimulationParameters, RecordResult, [&RecordedTransforms](FMassEntityManager& EntityManager, UMassTrafficSubsystem&)
+			{
+				RecordedTransforms.Add(GetVehicleTransforms(EntityManager));
+			}))
+		{
+			return false;
+		}
+	}
+
+	// The recorder only closes the replay once recording stops or it's destroyed along with its world
+	CollectGarbage(GARBAGE_COLLECTION_KEEPFLAGS);
+
+	TArray<TArray<FVehicleTransform>> PlaybackTransforms;
+	FString LaneVehiclesMismatch;
+	{
+		TGuardValue<int32> ReplayGuard(GMassTrafficReplay, 2 /*playback*/);
+		FSimulationResult PlaybackResult;
+		if (!RunSimulation(*this, SimulationParameters, PlaybackResult, [&PlaybackTransforms, &LaneVehiclesMismatch](FMassEntityManager& EntityManager, UMassTrafficSubsystem& MassTrafficSubsystem)
+			{
+				PlaybackTransforms.Add(GetVehicleTransforms(EntityManager));
+				if (LaneVehiclesMismatch.IsEmpty())
+				{
+					const FString Mismatch = FindLaneVehiclesMismatch(EntityManager, MassTrafficSubsystem, PlaybackTransforms.Last().Num());
+					if (!Mismatch.IsEmpty())
+					{
+						LaneVehiclesMismatch = FString::Printf(TEXT("Tick %d: %s"), PlaybackTransforms.Num() - 1, *Mismatch);
+					}
+				}
+			}))
+		{
+			return false;
+		}
+	}
+
+	IFileManager::Get().Delete(*ReplayFilename);
+
+	TestEqual(TEXT("Number of ticks played back"), PlaybackTransforms.Num(), RecordedTransforms.Num());
+	TestTrue(TEXT("Vehicles recorded"), !RecordedTransforms.IsEmpty() && !RecordedTransforms[0].IsEmpty());
+	TestTrue(FString::Printf(TEXT("Lane vehicles match replayed vehicles (%s)"), *LaneVehiclesMismatch), LaneVehiclesMismatch.IsEmpty());
+
+	const int32 NumTicks = FMath::Min(PlaybackTransforms.Num(), RecordedTransforms.Num());
+	for (int32 Tick = 0; Tick < NumTicks; ++Tick)
+	{
+		const TArray<FVehicleTransform>& Recorded = RecordedTransforms[Tick];
+		const TArray<FVehicleTransform>& PlayedBack = PlaybackTransforms[Tick];
+		if (PlayedBack.Num() != Recorded.Num())
+		{
+			AddError(FString::Printf(TEXT("Tick %d played back %d vehicles, %d were recorded"), Tick, PlayedBack.Num(), Recorded.Num()));
+			return false;
+		}
+
+		for (int32 Index = 0; Index < Recorded.Num(); ++Index)
+		{
+			if (PlayedBack[Index].VehicleId != Recorded[Index].VehicleId || PlayedBack[Index].Location != Recorded[Index].Location || PlayedBack[Index].Rotation != Recorded[Index].Rotation)
+			{
+				AddError(FString::Printf(TEXT("Tick %d vehicle %d played back at %s %s, recorded at %s %s"), Tick, Recorded[Index].VehicleId,
+					*PlayedBack[Index].Location.ToString(), *PlayedBack[Index].Rotation.ToString(), *Recorded[Index].Location.ToString(), *Recorded[Index].Rotation.ToString()));
+				return false;
+			}
+		}
+	}
+
+	return true;
+}
@@ -0,0 +1,175 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "Misc/AutomationTest.h"
+
+#include "MassTrafficSpawnPointCache.h"
+#include "MassTrafficVehicleSpawnDataGenerator.h"
+
+#include "HAL/FileManager.h"
+#include "Misc/Paths.h"
+#include "ZoneGraphTypes.h"
+
+namespace UE::MassTraffic::SpawnPointGenerationTests
+{
+
+static constexpr int32 NumLanes = 512;
+static constexpr int32 NumPointsPerLane = 8;
+static constexpr float PointSpacing = 1000.0f;
+
+/** Straight, parallel lanes of increasing length, one every 500cm. */
+static void BuildZoneGraphStorage(FZoneGraphStorage& ZoneGraphStorage)
+{
+	for (int32 LaneIndex = 0; LaneIndex < NumLanes; ++LaneIndex)
+	{
+		FZoneLaneData& Lane = ZoneGraphStorage.Lanes.AddDefaulted_GetRef();
+		Lane.Width = 350.0f;
+		Lane.PointsBegin = ZoneGraphStorage.LanePoints.Num();
+
+		const float LanePointSpacing = PointSpacing + 10.0f * (LaneIndex % 50);
+		for (int32 PointIndex = 0; PointIndex < NumPointsPerLane; ++PointIndex)
+		{
+			ZoneGraphStorage.LanePoints.Add(FVector(PointIndex * LanePointSpacing, LaneIndex * 500.0f, 0.0f));
+			ZoneGraphStorage.LaneTangentVectors.Add(FVector::ForwardVector);
+			ZoneGraphStorage.LaneUpVectors.Add(FVector::UpVector);
+			ZoneGraphStorage.LanePointProgressions.Add(PointIndex * LanePointSpacing);
+		}
+
+		Lane.PointsEnd = ZoneGraphStorage.LanePoints.Num();
+	}
+}
+
+static TArray<FMassTrafficVehicleSpacing> MakeSpacings()
+{
+	TArray<FMassTrafficVehicleSpacing> Spacings;
+	for (const float Space : { 500.0f, 800.0f, 1500.0f })
+	{
+		FMassTrafficVehicleSpacing& Spacing = Spacings.AddDefaulted_GetRef();
+		Spacing.Space = Space;
+		Spacing.Proportion = 1.0f;
+	}
+	return Spacings;
+}
+
+static bool ArePointsIdentical(const TArray<TArray<FZoneGraphLaneLocation>>& A, const TArray<TArray<FZoneGraphLaneLocation>>& B)
+{
+	if (A.Num() != B.Num())
+	{
+		return false;
+	}
+
+	for (int32 SpacingIndex = 0; SpacingIndex < A.Num(); ++SpacingIndex)
+	{
+		if (A[SpacingIndex].Num() != B[SpacingIndex].Num())
+		{
+			return false;
+		}
+
+		for (int32 PointIndex = 0; PointIndex < A[SpacingIndex].Num(); ++PointIndex)
+		{
+			const FZoneGraphLaneLocation& PointA = A[SpacingIndex][PointIndex];
+			const FZoneGraphLaneLocation& PointB = B[SpacingIndex][PointIndex];
+			if (PointA.LaneHandle != PointB.LaneHandle
+				|| PointA.DistanceAlongLane != PointB.DistanceAlongLane
+				|| PointA.LaneSegment != PointB.LaneSegment
+				|| PointA.Position != PointB.Position
+				|| PointA.Direction != PointB.Direction)
+			{
+				return false;
+			}
+		}
+	}
+
+	return true;
+}
+
+static void FindPoints(const FZoneGraphStorage& ZoneGraphStorage, const int32 Seed, TArray<TArray<FZoneGraphLaneLocation>>& OutSpawnPointsPerSpacing)
+{
+	UMassTrafficVehicleSpawnDataGenerator::FindNonOverlappingLanePoints(
+		ZoneGraphStorage,
+		FZoneGraphTagFilter(),
+		TArray<FMassTrafficLaneDensity>(),
+		FRandomStream(Seed),
+		MakeSpacings(),
+		/*MinGapBetweenSpaces*/100.0f,
+		/*MaxGapBetweenSpaces*/300.0f,
+		OutSpawnPointsPerSpacing,
+		/*bShufflePoints*/true);
+}
+
+}
+
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FMassTrafficSpawnPointGenerationDeterminismTest, "MassTraffic.SpawnPoints.Deterministic", EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+// Lanes are processed in parallel, so generate points for the same ZoneGraph data & seed several times and check
+// they're always identical, and that a different seed changes them
+bool FMassTrafficSpawnPointGenerationDeterminismTest::RunTest(const FString& Parameters)
+{
+	using namespace UE::MassTraffic::SpawnPointGenerationTests;
+
+	FZoneGraphStorage ZoneGraphStorage;
+	BuildZoneGraphStorage(ZoneGraphStorage);
+
+	TArray<TArray<FZoneGraphLaneLocation>> ReferencePoints;
+	FindPoints(ZoneGraphStorage, /*Seed*/1234, ReferencePoints);
+	if (ReferencePoints.IsEmpty() || ReferencePoints[0].IsEmpty())
+	{
+		AddError(TEXT("No spawn points were generated"));
+		return false;
+	}
+
+	for (int32 Run = 0; Run < 4; ++Run)
+	{
+		TArray<TArray<FZoneGraphLaneLocation>> Points;
+		FindPoints(ZoneGraphStorage, /*Seed*/1234, Points);
+		if (!ArePointsIdentical(ReferencePoints, Points))
+		{
+			AddError(FString::Printf(TEXT("Spawn points differ on run %d"), Run));
+			return false;
+		}
+	}
+
+	TArray<TArray<FZoneGraphLaneLocation>> OtherSeedPoints;
+	FindPoints(ZoneGraphStorage, /*Seed*/4321, OtherSeedPoints);
+	TestFalse(TEXT("Spawn points with a different seed are identical"), ArePointsIdentical(ReferencePoints, OtherSeedPoints));
+
+	return true;
+}
+
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FMassTrafficSpawnPointCacheTest, "MassTraffic.SpawnPoints.Cache", EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+// Save generated points to the cache & load them back, checking they survive the round trip and aren't loaded for a
+// different key or changed ZoneGraph data
+bool FMassTrafficSpawnPointCacheTest::RunTest(const FString& Parameters)
+{
+	using namespace UE::MassTraffic::SpawnPointGenerationTests;
+
+	FZoneGraphStorage ZoneGraphStorage;
+	BuildZoneGraphStorage(ZoneGraphStorage);
+
+	TArray<TArray<FZoneGraphLaneLocation>> Points;
+	FindPoints(ZoneGraphStorage, /*Seed*/1234, Points);
+
+	const uint32 CacheKey = UE::MassTraffic::GetZoneGraphStorageHash(ZoneGraphStorage);
+	const FString Filename = FPaths::Combine(FPaths::AutomationTransientDir(), TEXT("MassTrafficSpawnPointCacheTest.bin"));
+	if (!UE::MassTraffic::SaveSpawnPointCache(Filename, CacheKey, Points))
+	{
+		AddError(FString::Printf(TEXT("Couldn't save spawn point cache to %s"), *Filename));
+		return false;
+	}
+
+	TArray<TArray<FZoneGraphLaneLocation>> LoadedPoints;
+	TestTrue(TEXT("Spawn point cache loaded"), UE::MassTraffic::LoadSpawnPointCache(Filename, CacheKey, ZoneGraphStorage, LoadedPoints));
+	TestTrue(TEXT("Loaded spawn points match generated ones"), ArePointsIdentical(Points, LoadedPoints));
+
+	TArray<TArray<FZoneGraphLaneLocation>> MismatchedPoints;
+	TestFalse(TEXT("Spawn point cache loaded for a different key"), UE::MassTraffic::LoadSpawnPointCache(Filename, CacheKey + 1, ZoneGraphStorage, MismatchedPoints));
+
+	ZoneGraphStorage.LanePoints[0].Z += 1.0f;
+	TestNotEqual(TEXT("ZoneGraph hash after moving a lane point"), UE::MassTraffic::GetZoneGraphStorageHash(ZoneGraphStorage), CacheKey);
+
+	IFileManager::Get().Delete(*Filename);
+
+	return true;
+}
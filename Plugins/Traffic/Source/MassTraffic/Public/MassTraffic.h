@@ -71,6 +71,15 @@ extern float GMassTrafficLinearSpeedSleepThreshold;
 extern float GMassTrafficControlInputWakeTolerance;
 
 extern float GMassTrafficSpeedLimitScale;
+extern int32 GMassTrafficReplay;
+extern int32 GMassTrafficParallelValidation;
+extern int32 GMassTrafficValidationSampleInterval;
+extern int32 GMassTrafficParallelVehicleBehavior;
+extern int32 GMassTrafficStaticInstances;
+extern int32 GMassTrafficScheduleIntersections;
+extern int32 GMassTrafficParallelFieldOperations;
+extern float GMassTrafficPostPhysicsLaneSearchDistance;
+extern float GMassTrafficStaticInstanceCellSize;
 
 namespace UE::MassTraffic::ProcessorGroupNames
 {
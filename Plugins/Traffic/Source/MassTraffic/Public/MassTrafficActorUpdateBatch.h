@@ -0,0 +1,52 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "MassEntityTypes.h"
+
+class AActor;
+class UMassTrafficVehicleComponent;
+struct FMassCommandBuffer;
+struct FMassEntityManager;
+
+
+/**
+ * A frame's worth of actor transform & wheel updates for vehicles & trailers represented by spawned actors. Visualization
+ * processors collect these while iterating their chunks, then apply them all from a single deferred command rather than
+ * pushing a command per vehicle.
+ */
+struct MASSTRAFFIC_API FMassTrafficActorUpdateBatch
+{
+	void AddActorTransform(AActor& Actor, const FTransform& Transform)
+	{
+		ActorTransforms.Emplace(&Actor, Transform);
+	}
+
+	/** Updates VehicleComponent's wheels from Entity's FMassTrafficVehiclePhysicsFragment, if it still has one when applied. */
+	void AddWheelUpdate(UMassTrafficVehicleComponent& VehicleComponent, const FMassEntityHandle Entity)
+	{
+		WheelUpdates.Emplace(&VehicleComponent, Entity);
+	}
+
+	bool IsEmpty() const
+	{
+		return ActorTransforms.IsEmpty() && WheelUpdates.IsEmpty();
+	}
+
+	int32 Num() const
+	{
+		return ActorTransforms.Num();
+	}
+
+	/** Applies all the actor transforms, then all the wheel updates. */
+	void Apply(const FMassEntityManager& EntityManager) const;
+
+	/** Moves the batch into a single deferred command to be applied along with the rest of CommandBuffer, leaving this empty. */
+	void Defer(FMassCommandBuffer& CommandBuffer);
+
+	void Reset();
+
+private:
+	TArray<TPair<AActor*, FTransform>> ActorTransforms;
+	TArray<TPair<UMassTrafficVehicleComponent*, FMassEntityHandle>> WheelUpdates;
+};
@@ -4,6 +4,7 @@
 
 #include "MassTrafficProcessorBase.h"
 #include "MassTrafficFragments.h"
+#include "MassTrafficLaneReservations.h"
 #include "MassProcessor.h"
 #include "MassTrafficChooseNextLaneProcessor.generated.h"
 
@@ -21,4 +22,6 @@ protected:
 	virtual void Execute(FMassEntityManager& EntityManager, FMassExecutionContext& Context) override;
 
 	FMassEntityQuery EntityQuery_Conditional;
+
+	FMassTrafficLaneReservations LaneReservations;
 };
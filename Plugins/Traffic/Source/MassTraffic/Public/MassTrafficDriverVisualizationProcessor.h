@@ -14,7 +14,8 @@ class UAnimToTextureDataAsset;
 class UMassTrafficSubsystem;
 
 /**
- * Overridden visualization processor to make it tied to the TrafficVehicle via the requirements
+ * Overridden visualization processor to make it tied to the TrafficVehicle via the requirements. Driver instances are
+ * bucketed into cells (see FMassTrafficMovingInstances) unless MassTraffic.StaticInstances is off.
  */
 UCLASS(HideCategories=("Mass|LOD"))
 class MASSTRAFFIC_API UMassTrafficDriverVisualizationProcessor : public UMassProcessor
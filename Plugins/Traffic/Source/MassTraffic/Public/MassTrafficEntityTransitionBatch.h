@@ -0,0 +1,99 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "MassEntityTypes.h"
+#include "InstancedStruct.h"
+
+struct FMassCommandBuffer;
+struct FMassEntityManager;
+
+
+/** A change of tags & fragments for an entity to make, e.g: a vehicle becoming a deviant obstacle. */
+struct MASSTRAFFIC_API FMassTrafficEntityTransition
+{
+	template<typename... TTags>
+	FMassTrafficEntityTransition& AddTags()
+	{
+		(TagsToAdd.Add<TTags>(), ...);
+		return *this;
+	}
+
+	template<typename... TTags>
+	FMassTrafficEntityTransition& RemoveTags()
+	{
+		(TagsToRemove.Add<TTags>(), ...);
+		return *this;
+	}
+
+	template<typename... TFragments>
+	FMassTrafficEntityTransition& AddFragments()
+	{
+		(FragmentsToAdd.Add<TFragments>(), ...);
+		return *this;
+	}
+
+	template<typename... TFragments>
+	FMassTrafficEntityTransition& RemoveFragments()
+	{
+		(FragmentsToRemove.Add<TFragments>(), ...);
+		return *this;
+	}
+
+	bool operator==(const FMassTrafficEntityTransition& Other) const
+	{
+		return TagsToAdd == Other.TagsToAdd && TagsToRemove == Other.TagsToRemove && FragmentsToAdd == Other.FragmentsToAdd && FragmentsToRemove == Other.FragmentsToRemove;
+	}
+
+	FMassTagBitSet TagsToAdd;
+	FMassTagBitSet TagsToRemove;
+	FMassFragmentBitSet FragmentsToAdd;
+	FMassFragmentBitSet FragmentsToRemove;
+};
+
+
+/**
+ * A frame's worth of archetype changes for traffic entities, e.g: vehicles becoming or ceasing to be deviant obstacles,
+ * being recycled or changing simulation mode. Processors collect these while iterating their chunks, then apply them
+ * all from a single deferred command, where every entity making the same transition is moved between archetypes in
+ * bulk, rather than pushing an AddTag / RemoveTag / SwapTags / AddFragments command per entity, each moving it on its own.
+ * Entities to destroy should still be pushed with FMassCommandBuffer::DestroyEntities, so they're destroyed after the
+ * buffer's other commands, as usual.
+ */
+struct MASSTRAFFIC_API FMassTrafficEntityTransitionBatch
+{
+	/**
+	 * Adds Entity to those making Transition. FragmentInstances are then copied onto Entity's fragments of the same
+	 * types, once it's made the transition, so should be of fragments it will have afterwards.
+	 */
+	void AddTransition(const FMassTrafficEntityTransition& Transition, const FMassEntityHandle Entity, TConstArrayView<FInstancedStruct> FragmentInstances = {});
+
+	bool IsEmpty() const
+	{
+		return Transitions.IsEmpty();
+	}
+
+	/** @return The number of entities making transitions. */
+	int32 Num() const;
+
+	/**
+	 * Makes each transition for all its (still valid) entities at once, in the order the transitions were first added,
+	 * then sets the fragment instances.
+	 */
+	void Apply(FMassEntityManager& EntityManager) const;
+
+	/** Moves the batch into a single deferred command to be applied along with the rest of CommandBuffer, leaving this empty. */
+	void Defer(FMassCommandBuffer& CommandBuffer);
+
+	void Reset();
+
+private:
+	struct FTransitionEntities
+	{
+		FMassTrafficEntityTransition Transition;
+		TArray<FMassEntityHandle> Entities;
+	};
+
+	TArray<FTransitionEntities> Transitions;
+	TArray<TPair<FMassEntityHandle, FInstancedStruct>> FragmentInstances;
+};
@@ -0,0 +1,71 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "MassTrafficProcessorBase.h"
+#include "MassTrafficTypes.h"
+
+#include "ZoneGraphTypes.h"
+
+#include "MassTrafficFarFieldProcessor.generated.h"
+
+class UMassTrafficSubsystem;
+class UZoneGraphSubsystem;
+
+
+/**
+ * Simulates traffic on lanes far from every viewer as aggregate flow, the level of simulation detail beyond the Off
+ * LOD chosen by UMassTrafficVehicleSimulationLODProcessor. (See UMassTrafficSettings::bFarFieldSimulation.)
+ *
+ * Far field lanes are cells of a cell transmission model. Each step, every far field lane sends as many of its
+ * FarFieldNumVehicles as its free flow speed & density allow onto its next lanes, split by their downstream flow
+ * density and limited by the space each next lane has to receive them. Far field flow ignores intersection periods.
+ *
+ * Off LOD vehicles anywhere on far field lanes are dematerialised into the flow, with the vehicle behind them linked
+ * straight to the vehicle ahead, and swap FMassTrafficVehicleTag for FMassTrafficFarFieldVehicleTag so no other
+ * processor touches them. Flow reaching a near field lane queues as
+ * FarFieldPendingVehicles and is materialised from the pooled vehicles as space opens up at the start of the lane. The
+ * number of simulated agents is then bounded by the near field, rather than the total number of vehicles in the city.
+ */
+UCLASS()
+class MASSTRAFFIC_API UMassTrafficFarFieldProcessor : public UMassTrafficProcessorBase
+{
+	GENERATED_BODY()
+
+public:
+	UMassTrafficFarFieldProcessor();
+
+protected:
+	virtual void ConfigureQueries() override;
+	virtual void Execute(FMassEntityManager& EntityManager, FMassExecutionContext& Context) override;
+
+	/** Flags lanes as far or near field, handing aggregate vehicles over to the materialisation queue as lanes become near field. */
+	void UpdateFarFieldLanes(FMassTrafficZoneGraphData& TrafficZoneGraphData, TConstArrayView<FVector> InViewerLocations, const bool bFarFieldSimulation) const;
+
+	/** Advances the cell transmission model across this zone graph's far field lanes by DeltaTime. */
+	void UpdateFarFieldFlow(FMassTrafficZoneGraphData& TrafficZoneGraphData, const float DeltaTime);
+
+	/** Removes the vehicle at VehicleIndex in TrafficLaneData's Vehicles from the lane and adds it to the far field flow. */
+	bool DematerialiseVehicle(
+		FMassEntityManager& EntityManager,
+		FMassExecutionContext& Context,
+		const UZoneGraphSubsystem& ZoneGraphSubsystem,
+		UMassTrafficSubsystem& MassTrafficSubsystem,
+		FZoneGraphTrafficLaneData& TrafficLaneData,
+		const int32 VehicleIndex);
+
+	/** Takes a pooled far field vehicle and inserts it as the new tail vehicle of TrafficLaneData. */
+	bool MaterialiseVehicle(
+		FMassEntityManager& EntityManager,
+		FMassExecutionContext& Context,
+		const FZoneGraphStorage& ZoneGraphStorage,
+		UMassTrafficSubsystem& MassTrafficSubsystem,
+		FZoneGraphTrafficLaneData& TrafficLaneData) const;
+
+	// Scratch buffers
+	TArray<FVector> ViewerLocations;
+	TArray<float> LaneSupplies;
+	TArray<float> LaneInflows;
+	TArray<float> LaneOutflows;
+	TArray<FZoneGraphLinkedLane> IncomingLanes;
+};
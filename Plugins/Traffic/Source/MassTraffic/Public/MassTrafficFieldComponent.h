@@ -61,6 +61,13 @@ public:
 	 */
 	void PerformFieldOperation(TSubclassOf<class UMassTrafficFieldOperationBase> OperationType, struct FMassTrafficFieldOperationContextBase& Context);
 
+	/**
+	 * Returns true if this field has operations of type OperationType, and all of them can be executed in parallel
+	 * with other fields' operations.
+	 * @see UMassTrafficFieldOperationBase::CanExecuteInParallel
+	 */
+	bool CanPerformFieldOperationInParallel(TSubclassOf<class UMassTrafficFieldOperationBase> OperationType) const;
+
 	FORCEINLINE const TArray<FZoneGraphTrafficLaneData*>& GetTrafficLanes() const 
 	{
 		return TrafficLanes;
@@ -72,7 +79,13 @@ public:
 	}
 
 	void UpdateOverlappedLanes(UMassTrafficSubsystem& MassTrafficSubsystem);
-	void UpdateOverlappedIntersections(const UMassTrafficSubsystem& MassTrafficSubsystem);
+	void UpdateOverlappedIntersections(UMassTrafficSubsystem& MassTrafficSubsystem);
+
+	/**
+	 * Re-caches overlapped lanes & intersections, only if the field has moved or changed size since the lanes were
+	 * last cached. Returns true if they were re-cached.
+	 */
+	bool UpdateOverlapsIfMoved(UMassTrafficSubsystem& MassTrafficSubsystem);
 
 	// UPrimitiveComponent interface
 	virtual FPrimitiveSceneProxy* CreateSceneProxy() override;
@@ -92,4 +105,7 @@ protected:
 
 	TArray<FZoneGraphTrafficLaneData*> TrafficLanes;
 	TArray<FMassEntityHandle> TrafficIntersectionEntities;
+
+	/** Bounds TrafficLanes were last found overlapping. */
+	FBox OverlappedLanesQueryBounds = FBox(ForceInit);
 };
\ No newline at end of file
@@ -55,6 +55,12 @@ class MASSTRAFFIC_API UMassTrafficFieldOperationBase : public UObject
 
 public:
 	virtual void Execute(FMassTrafficFieldOperationContext& Context) {};
+
+	/**
+	 * Whether this operation can execute at the same time as operations on other fields, that overlap none of the same
+	 * lanes or intersections. i.e. it only touches its field's lanes, the vehicles on them & its intersections.
+	 */
+	virtual bool CanExecuteInParallel() const { return false; }
 };
 
 /** Any field operations subclassing from this will be run automatically on begin play */
@@ -92,6 +98,7 @@ class MASSTRAFFIC_API UMassTrafficForceTrafficVehicleViewerLODFieldOperation : p
 	TEnumAsByte<EMassLOD::Type> LOD;
 
 	virtual void Execute(FMassTrafficFieldOperationContext& Context) override;
+	virtual bool CanExecuteInParallel() const override;
 };
 
 UCLASS(Meta=(DisplayName="Set Lane Speed Limit"))
@@ -114,6 +121,7 @@ class MASSTRAFFIC_API UMassTrafficVisualLoggingFieldOperation : public UMassTraf
 	bool bVisLog = true;
 
 	virtual void Execute(FMassTrafficFieldOperationContext& Context) override;
+	virtual bool CanExecuteInParallel() const override { return true; }
 };
 
 UCLASS(Meta=(DisplayName="Re-Time Intersection Periods"))
@@ -134,6 +142,7 @@ class MASSTRAFFIC_API UMassTrafficRetimeIntersectionPeriodsFieldOperation : publ
 	float EmptyPeriodDurationMult = 1.0f;
 
 	virtual void Execute(FMassTrafficFieldOperationContext& Context) override;
+	virtual bool CanExecuteInParallel() const override { return true; }
 };
 
 UCLASS()
@@ -21,3 +21,21 @@ protected:
 
 	FMassEntityQuery EntityQuery;
 };
+
+
+/**
+ * Refreshes the cached distances in each lane's FZoneGraphTrafficLaneData::Vehicles at the start of the frame, and
+ * drops vehicles that are no longer on the lane.
+ */
+UCLASS()
+class MASSTRAFFIC_API UMassTrafficRefreshLaneVehiclesProcessor : public UMassTrafficProcessorBase
+{
+	GENERATED_BODY()
+
+public:
+	UMassTrafficRefreshLaneVehiclesProcessor();
+
+protected:
+	virtual void ConfigureQueries() override;
+	virtual void Execute(FMassEntityManager& EntityManager, FMassExecutionContext& Context) override;
+};
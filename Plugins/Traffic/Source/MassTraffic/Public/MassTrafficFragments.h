@@ -15,6 +15,7 @@
 #include "Containers/RingBuffer.h"
 #include "MassLODSubsystem.h"
 #include "MassTrafficSettings.h"
+#include "MassZoneGraphNavigationFragments.h"
 
 #include "MassTrafficFragments.generated.h"
 
@@ -37,6 +38,8 @@ struct FMassTrafficVehicleControlFragment;
 struct FMassTrafficIntersectionFragment;
 struct FMassTrafficSimpleVehiclePhysicsTemplate;
 class AMassTrafficCoordinator;
+class UMassTrafficVehicleComponent;
+class UPrimitiveComponent;
 
 
 /** Special tag to differentiate the TrafficVehicle from the rest of the other entities */
@@ -87,6 +90,18 @@ struct MASSTRAFFIC_API FMassTrafficRecyclableVehicleTag : public FMassTag
 };
 
 
+/**
+ * Tag for traffic vehicles that have been dematerialised into the far field aggregate flow. These replace
+ * FMassTrafficVehicleTag, so far field vehicles aren't processed until they're materialised again.
+ * @see UMassTrafficFarFieldProcessor
+ */
+USTRUCT()
+struct MASSTRAFFIC_API FMassTrafficFarFieldVehicleTag : public FMassTag
+{
+	GENERATED_BODY()
+};
+
+
 /** Special tag to differentiate the TrafficIntersection from the rest of the other entities */
 USTRUCT()
 struct MASSTRAFFIC_API FMassTrafficIntersectionTag : public FMassTag
@@ -95,6 +110,25 @@ struct MASSTRAFFIC_API FMassTrafficIntersectionTag : public FMassTag
 };
 
 
+/**
+ * Intersections where nothing but the period timer can change until it's time to prepare to stop. These are skipped by
+ * UMassTrafficUpdateIntersectionsProcessor until their deadline. See all INTERSECTIONDEADLINE.
+ */
+USTRUCT()
+struct MASSTRAFFIC_API FMassTrafficIntersectionWaitingForPeriodDeadlineTag : public FMassTag
+{
+	GENERATED_BODY()
+};
+
+
+/** Entities with persistent instances in a FMassTrafficStaticInstances, to find those that must be removed. */
+USTRUCT()
+struct MASSTRAFFIC_API FMassTrafficHasStaticInstancesTag : public FMassTag
+{
+	GENERATED_BODY()
+};
+
+
 /*** Agents with this tag will be considered for traffic vehicle obstacle avoidance and must also have Transform and * AgentRadius fragments.
  */
 USTRUCT()
@@ -526,6 +560,20 @@ struct MASSTRAFFIC_API FMassTrafficDriverVisualizationFragment : public FMassFra
 };
 
 
+/** Static Instances Fragment. Handles of an entity's persistent instances. @see FMassTrafficStaticInstances */
+USTRUCT()
+struct MASSTRAFFIC_API FMassTrafficStaticInstancesFragment : public FMassFragment
+{
+	GENERATED_BODY()
+
+	/** The entity's instance for each sub index, or INDEX_NONE */
+	TArray<int32, TInlineAllocator<1>> InstanceHandles;
+
+	/** FMassTrafficStaticInstances::ResetCount InstanceHandles are from. They're stale if it has been reset since. */
+	uint32 ResetCount = 0;
+};
+
+
 /** Next Vehicle Fragment * Search key: NVFRAG
  */
 UENUM()
@@ -608,6 +656,33 @@ private:
 };
 
 
+template<typename TVisitor>
+void FZoneGraphTrafficLaneData::ForEachVehicleOnLane(const FMassEntityManager& EntityManager, TVisitor&& Visitor) const
+{
+	for (const FMassTrafficLaneVehicle& LaneVehicle : Vehicles)
+	{
+		// Entries are only refreshed once per frame, so skip any that have since been destroyed or left the lane.
+		if (!EntityManager.IsEntityValid(LaneVehicle.Entity))
+		{
+			continue;
+		}
+		
+		const FMassEntityView VehicleEntityView(EntityManager, LaneVehicle.Entity);
+		FMassZoneGraphLaneLocationFragment& LaneLocationFragment = VehicleEntityView.GetFragmentData<FMassZoneGraphLaneLocationFragment>();
+		if (LaneLocationFragment.LaneHandle != LaneHandle)
+		{
+			continue;
+		}
+		FMassTrafficNextVehicleFragment& NextVehicleFragment = VehicleEntityView.GetFragmentData<FMassTrafficNextVehicleFragment>();
+
+		if (!Visitor(VehicleEntityView, NextVehicleFragment, LaneLocationFragment))
+		{
+			break;
+		}
+	}
+}
+
+
 /** Obstacle List Fragment */
 
 USTRUCT()
@@ -633,6 +708,19 @@ struct MASSTRAFFIC_API FMassTrafficObstacleAvoidanceFragment : public FMassFragm
 };
 
 
+/** Vehicle ID Fragment */
+
+// Stable ID for a traffic vehicle, assigned in spawn order, so the same vehicle can be identified across runs of the same
+// map & RandomSeed, unlike its entity handle. (See UMassTrafficSubsystem::GetNextVehicleId.)
+USTRUCT()
+struct MASSTRAFFIC_API FMassTrafficVehicleIdFragment : public FMassFragment
+{
+	GENERATED_BODY()
+
+	int32 VehicleId = INDEX_NONE;
+};
+
+
 /** Random Fraction Fragment */
 
 // A random float number in the range [0, 1) as a basis for variation across agents 
@@ -835,12 +923,14 @@ struct MASSTRAFFIC_API FMassTrafficVehicleLaneChangeFragment : public FMassFragm
 		// Other..
 		FMassEntityManager& EntityManager);
 
-	void UpdateLaneChange(
+	/**
+	 * Counts down to the next lane change attempt, or checks whether the lane change in progress is done.
+	 * Only touches this fragment, so vehicles can be updated in parallel.
+	 * @return true if the lane change in progress has finished, and should now be ended with EndLaneChangeProgression.
+	 */
+	bool UpdateLaneChange(
 		const float DeltaTimeSeconds,
-		FMassTrafficVehicleLightsFragment& VehicleLightsFragment_Current,
-		FMassTrafficNextVehicleFragment& NextVehicleFragment_Current,
 		const FMassZoneGraphLaneLocationFragment& ZoneGraphLaneLocationFragment_Current,
-		const FMassEntityManager& EntityManager, 
 		const UMassTrafficSettings& MassTrafficSettings,
 		const FRandomStream& RandomStream);
 
@@ -887,6 +977,20 @@ struct MASSTRAFFIC_API FMassTrafficDebugFragment : public FMassFragment
 };
 
 
+/**
+ * Rotates which of a chunk's vehicles are validated, when only a sample are each time the chunk ticks. Counted per chunk
+ * rather than per frame, so chunks ticking at a reduced rate still rotate through all their vehicles.
+ * @see GMassTrafficValidationSampleInterval
+ */
+USTRUCT()
+struct MASSTRAFFIC_API FMassTrafficValidationChunkFragment : public FMassChunkFragment
+{
+	GENERATED_BODY()
+
+	uint32 NumValidations = 0;
+};
+
+
 /** Interpolation and Lane Segment Structs */
 struct MASSTRAFFIC_API FMassTrafficPositionOnlyLaneSegment
 {
@@ -920,6 +1024,48 @@ struct MASSTRAFFIC_API FMassTrafficInterpolationFragment : public FMassFragment
 };
 
 
+/**
+ * Transform before the current frame's fixed timestep substeps were simulated. Vehicle visualization blends from this
+ * to FTransformFragment by FMassTrafficSimulationClock::InterpolationAlpha.
+ */
+USTRUCT()
+struct MASSTRAFFIC_API FMassTrafficPreviousTransformFragment : public FMassFragment
+{
+	GENERATED_BODY()
+
+	FTransform Transform;
+
+	// FMassTrafficSimulationClock::StepIndex Transform was captured at. INDEX_NONE until first captured.
+	int64 Step = INDEX_NONE;
+};
+
+
+/**
+ * Components of a vehicle's spawned actor that visualization updates every frame. Resolved once, when the actor is
+ * spawned, rather than looked up on the actor every frame.
+ */
+USTRUCT()
+struct MASSTRAFFIC_API FMassTrafficVehicleActorComponentsFragment : public FMassFragment
+{
+	GENERATED_BODY()
+
+	/** Finds InActor's components, unless they've already been resolved for InActor. */
+	void Resolve(AActor& InActor);
+
+	FORCEINLINE bool IsResolvedFor(const AActor* InActor) const
+	{
+		return InActor && Actor.Get() == InActor;
+	}
+
+	/** Sets custom primitive data on every primitive component of the actor (including those of child actors.) */
+	void SetCustomPrimitiveDataFloat(const int32 DataIndex, const float Value) const;
+
+	TWeakObjectPtr<AActor> Actor;
+	TWeakObjectPtr<UMassTrafficVehicleComponent> VehicleComponent;
+	TArray<TWeakObjectPtr<UPrimitiveComponent>, TInlineAllocator<8>> PrimitiveComponents;
+};
+
+
 USTRUCT()
 struct MASSTRAFFIC_API FMassTrafficPIDControlInterpolationFragment : public FMassFragment
 {
@@ -11,14 +11,30 @@ enum class ETrafficVehicleMovementInterpolationMethod : uint8
     CubicBezier
 };
 
+/**
+ * Lane segments are found through LaneSegmentTable, ZoneGraphStorage's lane segment table, when passed one (see
+ * UMassTrafficSubsystem::GetLaneSegmentTable), and otherwise by stepping through the lane's points.
+ */
 namespace UE
 {
 namespace MassTraffic
 {
 
-MASSTRAFFIC_API void InitPositionOnlyLaneSegment(const FZoneGraphStorage& ZoneGraphStorage, int32 LaneIndex, float DistanceAlongLane, FMassTrafficPositionOnlyLaneSegment& InOutLaneSegment);
+/**
+ * Finds the nearest location to Location on the lane, only searching the lane segments within SearchDistance of
+ * PreviousDistanceAlongLane, for locations expected to have moved only a little since PreviousDistanceAlongLane.
+ *
+ * Returns false if the nearest location may be outside the searched segments - i.e. it's at the edge of the searched
+ * range (other than the lane's start or end), or Location is more than SearchDistance from the lane - or if
+ * there isn't a lane segment table. Callers should then fall back to searching the whole lane with
+ * UZoneGraphSubsystem::FindNearestLocationOnLane.
+ */
+MASSTRAFFIC_API bool FindNearbyDistanceAlongLane(const FZoneGraphStorage& ZoneGraphStorage, const FMassTrafficLaneSegmentTable* LaneSegmentTable, int32 LaneIndex, const FVector& Location, float PreviousDistanceAlongLane, float SearchDistance, float& OutDistanceAlongLane, float& OutDistanceSq);
+
+/** Finds the lane segment around DistanceAlongLane. */
+MASSTRAFFIC_API void InitPositionOnlyLaneSegment(const FZoneGraphStorage& ZoneGraphStorage, const FMassTrafficLaneSegmentTable* LaneSegmentTable, int32 LaneIndex, float DistanceAlongLane, FMassTrafficPositionOnlyLaneSegment& InOutLaneSegment);
 	
-MASSTRAFFIC_API void InitLaneSegment(const FZoneGraphStorage& ZoneGraphStorage, int32 LaneIndex, float DistanceAlongLane, FMassTrafficLaneSegment& InOutLaneSegment);
+MASSTRAFFIC_API void InitLaneSegment(const FZoneGraphStorage& ZoneGraphStorage, const FMassTrafficLaneSegmentTable* LaneSegmentTable, int32 LaneIndex, float DistanceAlongLane, FMassTrafficLaneSegment& InOutLaneSegment);
 	
 /** Uses Linear or Cubic Bezier interpolation to evaluate the 3D lane location at
  * DistanceAlongLane along InOutLaneSegment.
@@ -29,6 +45,7 @@ MASSTRAFFIC_API void InitLaneSegment(const FZoneGraphStorage& ZoneGraphStorage,
  */
 MASSTRAFFIC_API void InterpolatePositionAlongLane(
 	const FZoneGraphStorage& ZoneGraphStorage, 
+    const FMassTrafficLaneSegmentTable* LaneSegmentTable,
     int32 LaneIndex,
 	float DistanceAlongLane,
 	ETrafficVehicleMovementInterpolationMethod InterpolationMethod,
@@ -44,6 +61,7 @@ MASSTRAFFIC_API void InterpolatePositionAlongLane(
  */
 MASSTRAFFIC_API void InterpolatePositionAndOrientationAlongLane(
 	const FZoneGraphStorage& ZoneGraphStorage, 
+	const FMassTrafficLaneSegmentTable* LaneSegmentTable,
 	int32 LaneIndex,
 	float DistanceAlongLane,
 	ETrafficVehicleMovementInterpolationMethod InterpolationMethod,
@@ -53,6 +71,7 @@ MASSTRAFFIC_API void InterpolatePositionAndOrientationAlongLane(
 
 FORCEINLINE void InterpolatePositionAndOrientationAlongLane(
 	const FZoneGraphStorage& ZoneGraphStorage, 
+	const FMassTrafficLaneSegmentTable* LaneSegmentTable,
 	int32 LaneIndex,
 	float DistanceAlongLane,
 	ETrafficVehicleMovementInterpolationMethod InterpolationMethod,
@@ -61,7 +80,7 @@ FORCEINLINE void InterpolatePositionAndOrientationAlongLane(
 {
 	FVector OutPosition;
     FQuat OutOrientation;
-	InterpolatePositionAndOrientationAlongLane(ZoneGraphStorage,
+	InterpolatePositionAndOrientationAlongLane(ZoneGraphStorage, LaneSegmentTable,
 		LaneIndex, DistanceAlongLane, InterpolationMethod,
 		InOutLaneSegment, OutPosition, OutOrientation);
 
@@ -71,6 +90,7 @@ FORCEINLINE void InterpolatePositionAndOrientationAlongLane(
 
 MASSTRAFFIC_API void InterpolatePositionAlongContinuousLanes(
 	const FZoneGraphStorage& ZoneGraphStorage, 
+	const FMassTrafficLaneSegmentTable* LaneSegmentTable,
 	int32 CurrentLaneIndex,
 	float CurrentLaneLength,
 	int32 NextLaneIndex,
@@ -81,6 +101,7 @@ MASSTRAFFIC_API void InterpolatePositionAlongContinuousLanes(
 	
 MASSTRAFFIC_API void InterpolatePositionAndOrientationAlongContinuousLanes(
 	const FZoneGraphStorage& ZoneGraphStorage, 
+	const FMassTrafficLaneSegmentTable* LaneSegmentTable,
 	int32 CurrentLaneIndex,
 	float CurrentLaneLength,
 	int32 NextLaneIndex,
@@ -92,6 +113,7 @@ MASSTRAFFIC_API void InterpolatePositionAndOrientationAlongContinuousLanes(
 
 FORCEINLINE void InterpolatePositionAndOrientationAlongContinuousLanes(
 	const FZoneGraphStorage& ZoneGraphStorage, 
+	const FMassTrafficLaneSegmentTable* LaneSegmentTable,
 	int32 CurrentLaneIndex,
 	float CurrentLaneLength,
 	int32 NextLaneIndex,
@@ -102,7 +124,7 @@ FORCEINLINE void InterpolatePositionAndOrientationAlongContinuousLanes(
 {
 	FVector OutPosition;
 	FQuat OutOrientation;
-	InterpolatePositionAndOrientationAlongContinuousLanes(ZoneGraphStorage,
+	InterpolatePositionAndOrientationAlongContinuousLanes(ZoneGraphStorage, LaneSegmentTable,
 		CurrentLaneIndex, CurrentLaneLength, NextLaneIndex,
 		DistanceAlongCurrentLane, InterpolationMethod,
 		InOutLaneSegment, OutPosition, OutOrientation);
@@ -113,6 +135,7 @@ FORCEINLINE void InterpolatePositionAndOrientationAlongContinuousLanes(
 	
 MASSTRAFFIC_API void InterpolatePositionAndOrientationAlongContinuousLanes(
 	const FZoneGraphStorage& ZoneGraphStorage, 
+	const FMassTrafficLaneSegmentTable* LaneSegmentTable,
 	int32 PreviousLaneIndex,
 	float PreviousLaneLength,
 	int32 CurrentLaneIndex,
@@ -126,6 +149,7 @@ MASSTRAFFIC_API void InterpolatePositionAndOrientationAlongContinuousLanes(
 
 FORCEINLINE void InterpolatePositionAndOrientationAlongContinuousLanes(
 	const FZoneGraphStorage& ZoneGraphStorage, 
+	const FMassTrafficLaneSegmentTable* LaneSegmentTable,
 	int32 PreviousLaneIndex,
 	float PreviousLaneLength,
 	int32 CurrentLaneIndex,
@@ -138,7 +162,7 @@ FORCEINLINE void InterpolatePositionAndOrientationAlongContinuousLanes(
 {
 	FVector OutPosition;
 	FQuat OutOrientation;
-	InterpolatePositionAndOrientationAlongContinuousLanes(ZoneGraphStorage,
+	InterpolatePositionAndOrientationAlongContinuousLanes(ZoneGraphStorage, LaneSegmentTable,
 		PreviousLaneIndex, PreviousLaneLength, CurrentLaneIndex, CurrentLaneLength,
 		NextLaneIndex, DistanceAlongCurrentLane, InterpolationMethod,
 		InOutLaneSegment, OutPosition, OutOrientation);
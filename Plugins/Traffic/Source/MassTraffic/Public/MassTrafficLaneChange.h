@@ -87,6 +87,7 @@ FORCEINLINE bool AreVehiclesCurrentlyApproachingLaneFromIntersection(const FZone
 
 /**
  * Finds nearest vehicles behind and ahead of a distance along the lane.
+ * Binary searches the lane's Vehicles, so it's O(log n) in the number of vehicles on the lane.
  * Can optionally ignore a particular vehicle.
  * Returns true if no problems were found.
  */
@@ -100,6 +101,7 @@ bool FindNearbyVehiclesOnLane_RelativeToDistanceAlongLane(
 
 /**
  * Finds nearest vehicles behind and ahead of a vehicle entity on a lane.
+ * Looks the entity up in the lane's Vehicles, only following NextVehicle links if it isn't there.
  * Can optionally ignore a particular vehicle.
  * Returns true if no problems were found.
  */
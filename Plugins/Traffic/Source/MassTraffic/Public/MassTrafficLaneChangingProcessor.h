@@ -5,6 +5,7 @@
 #include "MassActorSubsystem.h"
 #include "MassTrafficProcessorBase.h"
 #include "MassTrafficFragments.h"
+#include "MassTrafficLaneReservations.h"
 #include "MassActorSubsystem.h"
 #include "MassTrafficLaneChangingProcessor.generated.h"
 
@@ -23,4 +24,6 @@ protected:
 
 	FMassEntityQuery StartNewLaneChangesEntityQuery_Conditional;
 	FMassEntityQuery UpdateLaneChangesEntityQuery_Conditional;
+
+	FMassTrafficLaneReservations LaneReservations;
 };
@@ -0,0 +1,76 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+struct FMassTrafficZoneGraphData;
+struct FZoneGraphStorage;
+class UMassTrafficSettings;
+
+
+/**
+ * Precomputed traffic lane data, built by UMassTrafficSubsystem for each registered ZoneGraph data and saved to
+ * UMassTrafficSettings::LaneDataCacheDirectory, so it can be loaded directly rather than rebuilt.
+ *
+ * Cache files are named after a key built from the ZoneGraph storage and the lane settings the data was built with,
+ * so editing either one simply misses the cache. Lane links are stored as lane indices and restored against the
+ * storage the data is loaded for. Only the lane data derived from the ZoneGraph & settings is cached, runtime state
+ * (vehicles, occupancy, open / closed etc.) starts off at its defaults.
+ */
+namespace UE::MassTraffic
+{
+
+/** @return Key for lane data built from ZoneGraphStorage with MassTrafficSettings' lane filters, speed limits & densities. */
+MASSTRAFFIC_API uint32 GetLaneDataCacheKey(const FZoneGraphStorage& ZoneGraphStorage, const UMassTrafficSettings& MassTrafficSettings);
+
+/** @return Where lane data built for CacheKey is cached. */
+MASSTRAFFIC_API FString GetLaneDataCacheFilename(const UMassTrafficSettings& MassTrafficSettings, const uint32 CacheKey);
+
+/**
+ * Loads lane data previously saved for CacheKey into TrafficZoneGraphData, for ZoneGraphStorage.
+ * @return false if there was no cache file, or it was written for a different key, version or storage.
+ */
+MASSTRAFFIC_API bool LoadLaneDataCache(const FString& Filename, const uint32 CacheKey, const FZoneGraphStorage& ZoneGraphStorage, FMassTrafficZoneGraphData& TrafficZoneGraphData);
+
+/** Saves lane data built for CacheKey. */
+MASSTRAFFIC_API bool SaveLaneDataCache(const FString& Filename, const uint32 CacheKey, const FMassTrafficZoneGraphData& TrafficZoneGraphData);
+
+
+/**
+ * Ground trace for a ZoneGraph lane point, saved by AMassTrafficZoneGraphDataModifier::SnapZoneGraphDataToGround
+ * so later snaps of the same ZoneGraph data, including in later editor sessions, only retrace points that changed.
+ */
+struct FGroundSnapCacheEntry
+{
+	/** Point location the trace was made from, i.e. before snapping. */
+	FVector SourcePoint = FVector::ZeroVector;
+
+	/** Point location after the trace was applied, to recognise points that have already been snapped. */
+	FVector SnappedPoint = FVector::ZeroVector;
+
+	FVector ImpactPoint = FVector::ZeroVector;
+	FVector ImpactNormal = FVector::UpVector;
+
+	/** Hash of the collision geometry around SourcePoint when it was traced. */
+	uint32 GeometryHash = 0;
+
+	bool bHit = false;
+};
+
+/** Ground traces keyed by (lane index, lane point index) in the ZoneGraph storage. */
+using FGroundSnapCache = TMap<FIntPoint, FGroundSnapCacheEntry>;
+
+/** @return Where ground traces for the ZoneGraph data at ZoneGraphDataPath are cached, alongside lane data. */
+MASSTRAFFIC_API FString GetGroundSnapCacheFilename(const UMassTrafficSettings& MassTrafficSettings, const FString& ZoneGraphDataPath);
+
+/**
+ * Loads ground traces previously saved for CacheKey into OutGroundSnapCache.
+ * @return false if there was no cache file, or it was written for a different key or version.
+ */
+MASSTRAFFIC_API bool LoadGroundSnapCache(const FString& Filename, const uint32 CacheKey, FGroundSnapCache& OutGroundSnapCache);
+
+/** Saves ground traces made for CacheKey. */
+MASSTRAFFIC_API bool SaveGroundSnapCache(const FString& Filename, const uint32 CacheKey, const FGroundSnapCache& GroundSnapCache);
+
+}
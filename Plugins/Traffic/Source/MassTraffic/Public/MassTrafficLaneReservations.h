@@ -0,0 +1,146 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "MassEntityTypes.h"
+#include "MassLODTypes.h"
+#include "Math/RandomStream.h"
+#include "HAL/CriticalSection.h"
+
+struct FZoneGraphTrafficLaneData;
+struct FMassTrafficVehicleControlFragment;
+struct FMassZoneGraphLaneLocationFragment;
+
+
+/** Shared lane state change a vehicle wants to make, recorded while processing chunks in parallel. */
+enum class EMassTrafficLaneReservationType : uint8
+{
+	ReserveLane,						// ++NumReservedVehiclesOnLane & set bCantStopAtLaneExit. (See all CANTSTOPLANEEXIT.)
+	ReleaseLane,						// --NumReservedVehiclesOnLane & clear bCantStopAtLaneExit. (See all CANTSTOPLANEEXIT.)
+	ApproachLane,						// ++NumVehiclesApproachingLane
+	LeaveApproachingLane,				// --NumVehiclesApproachingLane
+	SetVehicleReadyToUseLane,			// bIsVehicleReadyToUseLane = true. (See all READYLANE.)
+	ClearVehicleReadyToUseLane,			// bIsVehicleReadyToUseLane = false. (See all READYLANE.)
+	SetStoppedVehicleOverlappingLane,	// bIsStoppedVehicleInPreviousLaneOverlappingThisLane = true. (See all CROSSWALKOVERLAP.)
+	UpdateDownstreamFlowDensity,		// Lane->UpdateDownstreamFlowDensity()
+	VehicleAction,						// Left to the recording processor to apply. (e.g: moving a vehicle to its next lane.)
+};
+
+
+struct MASSTRAFFIC_API FMassTrafficLaneReservation
+{
+	FMassEntityHandle Entity;
+
+	// Order this reservation was recorded in, among all of Entity's reservations
+	int32 Sequence = 0;
+
+	EMassTrafficLaneReservationType Type = EMassTrafficLaneReservationType::VehicleAction;
+
+	FZoneGraphTrafficLaneData* Lane = nullptr;
+
+	// Entity's control fragment, for reservations that also flag the vehicle. Chunks don't move during a processor's
+	// chunk loop, so this stays valid until the reservations are applied.
+	FMassTrafficVehicleControlFragment* VehicleControlFragment = nullptr;
+
+	// Processor specific payload for VehicleAction reservations
+	EMassLOD::Type LOD = EMassLOD::Max;
+	int32 ActionData = 0;
+	float ActionValue = 0.0f;
+};
+
+
+/**
+ * Reservations recorded by a single chunk. Only ever touched by the thread processing that chunk.
+ * @see FMassTrafficLaneReservations
+ */
+struct MASSTRAFFIC_API FMassTrafficLaneReservationBuffer
+{
+	FORCEINLINE void Add(const FMassEntityHandle Entity, const EMassTrafficLaneReservationType Type, FZoneGraphTrafficLaneData* Lane, FMassTrafficVehicleControlFragment* VehicleControlFragment = nullptr)
+	{
+		FMassTrafficLaneReservation& Reservation = Reservations.AddDefaulted_GetRef();
+		Reservation.Entity = Entity;
+		Reservation.Sequence = Reservations.Num() - 1;
+		Reservation.Type = Type;
+		Reservation.Lane = Lane;
+		Reservation.VehicleControlFragment = VehicleControlFragment;
+	}
+
+	FORCEINLINE void AddVehicleAction(const FMassEntityHandle Entity, const EMassLOD::Type LOD, const int32 ActionData, const float ActionValue)
+	{
+		Add(Entity, EMassTrafficLaneReservationType::VehicleAction, nullptr);
+		Reservations.Last().LOD = LOD;
+		Reservations.Last().ActionData = ActionData;
+		Reservations.Last().ActionValue = ActionValue;
+	}
+
+	TArray<FMassTrafficLaneReservation> Reservations;
+
+	/**
+	 * Optional new DistanceAlongLane for each entity in the chunk, written back to LaneLocationFragments by
+	 * FMassTrafficLaneReservations::ApplyDistancesAlongLane. Lets vehicles move without other vehicles seeing it until
+	 * every chunk has been processed.
+	 */
+	TArrayView<FMassZoneGraphLaneLocationFragment> LaneLocationFragments;
+	TArray<float> DistancesAlongLane;
+};
+
+
+/**
+ * Lets vehicle processors run their chunk loops in parallel, without contention on FZoneGraphTrafficLaneData.
+ *
+ * While chunks are processed, changes to shared lane state (reservation counters, lane flags, downstream flow
+ * density) and any lane surgery are recorded into per-chunk buffers, rather than written through the lane pointers.
+ * Every vehicle then reads the lane state as it was at the start of the loop, whichever thread gets to it first.
+ * Afterwards, the recorded reservations are sorted by entity & recording order and applied on the calling thread.
+ *
+ * Since neither what's read nor the order changes are applied in depends on how chunks are scheduled, processing
+ * chunks in parallel gives bit-identical results to processing them on a single thread.
+ * (See GMassTrafficParallelVehicleBehavior.)
+ */
+class MASSTRAFFIC_API FMassTrafficLaneReservations
+{
+public:
+	/**
+	 * Returns an empty buffer for a chunk to record its reservations into. Thread safe. Buffers are reused across
+	 * frames, so their allocations are kept.
+	 */
+	FMassTrafficLaneReservationBuffer& AddBuffer();
+
+	/** Writes back the DistancesAlongLane recorded by all buffers. Call before Sort. */
+	void ApplyDistancesAlongLane();
+
+	/**
+	 * Gathers the reservations from all buffers into the same deterministic order, regardless of which buffers they
+	 * were recorded into, and empties the buffers. The returned view is valid until the next Sort or Reset.
+	 */
+	TConstArrayView<FMassTrafficLaneReservation> Sort();
+
+	/** Applies a single reservation's change to its lane. VehicleAction reservations are ignored. */
+	static void Apply(const FMassTrafficLaneReservation& Reservation, const float DownstreamFlowDensityMixtureFraction);
+
+	/** Applies all the reservations that aren't VehicleAction's, in sorted order. */
+	void SortAndApply(const float DownstreamFlowDensityMixtureFraction);
+
+	void Reset();
+
+private:
+	FCriticalSection BuffersCriticalSection;
+	TArray<TUniquePtr<FMassTrafficLaneReservationBuffer>> Buffers;
+	int32 NumUsedBuffers = 0;
+	TArray<FMassTrafficLaneReservation> SortedReservations;
+};
+
+
+namespace UE::MassTraffic
+{
+
+/**
+ * Random stream for Entity, that's independent of the order entities are processed in. Processors draw FrameSeed from
+ * their own RandomStream once per Execute, so results are still repeatable for a fixed UMassTrafficSettings::RandomSeed.
+ */
+FORCEINLINE FRandomStream MakeEntityRandomStream(const uint32 FrameSeed, const FMassEntityHandle Entity)
+{
+	return FRandomStream(static_cast<int32>(HashCombine(FrameSeed, GetTypeHash(Entity.Index))));
+}
+
+}
@@ -78,7 +78,8 @@ public:
 };
 
 /**
- * Custom visualization updates for TrafficLight
+ * Custom visualization updates for TrafficLight. Instanced lights are kept as persistent static instances (see
+ * FMassTrafficStaticInstances) unless MassTraffic.StaticInstances is off.
  */
 UCLASS()
 class MASSTRAFFIC_API UMassTrafficLightUpdateCustomVisualizationProcessor : public UMassProcessor
@@ -98,4 +99,7 @@ private:
 	UWorld* World;
 
 	FMassEntityQuery EntityQuery;
+
+	/** Intersections with persistent light instances that are now culled by distance, so no longer in visible chunks. */
+	FMassEntityQuery CulledStaticInstancesEntityQuery;
 };
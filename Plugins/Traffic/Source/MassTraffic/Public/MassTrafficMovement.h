@@ -206,6 +206,16 @@ MASSTRAFFIC_API void MoveVehicleToNextLane(
 	FMassTrafficNextVehicleFragment& NextVehicleFragment,
 	FMassTrafficVehicleLaneChangeFragment* LaneChangeFragment, bool& bIsVehicleStuck);
 
+/**
+ * Rebuilds every lane's Vehicles & TailVehicle, and each of Vehicles' NextVehicle, from their current lane locations.
+ * Vehicles must all have lane location, agent radius & next vehicle fragments, and are sorted by lane & distance.
+ * Lanes none of Vehicles are on are left empty.
+ */
+MASSTRAFFIC_API void RebuildLaneVehicles(
+	FMassEntityManager& EntityManager,
+	UMassTrafficSubsystem& MassTrafficSubsystem,
+	TArray<FMassEntityHandle>& Vehicles);
+
 /** Instantly moves a vehicle onto another lane. This is not an animated over time. */
 MASSTRAFFIC_API bool TeleportVehicleToAnotherLane(
 	const FMassEntityHandle Entity_Current,
@@ -24,6 +24,7 @@ protected:
 	bool MoveVehicleToFreeSpaceOnRandomLane(
 		const FMassEntityManager& EntityManager,
 		const FZoneGraphStorage& ZoneGraphStorage,
+		const struct FMassTrafficLaneSegmentTable* LaneSegmentTable,
 		const FMassEntityHandle VehicleEntity,
 		const struct FAgentRadiusFragment& Vehicle_RadiusFragment,
 		const FMassTrafficRandomFractionFragment& Vehicle_RandomFractionFragment,
@@ -10,6 +10,11 @@
 
 #include "MassTrafficParkedVehicleSpawnDataGenerator.generated.h"
 
+namespace UE::MassTraffic
+{
+	struct FObstacleExclusionGrid;
+}
+
 UCLASS()
 class MASSTRAFFIC_API UMassTrafficParkedVehicleSpawnDataGenerator : public UMassEntitySpawnDataGeneratorBase
 {
@@ -44,4 +49,10 @@ public:
 	 * @param FinishedGeneratingSpawnPointsDelegate is the callback to call once the generation is done
 	 */
 	virtual void Generate(UObject& QueryOwner, TConstArrayView<FMassSpawnedEntityType> EntityTypes, int32 Count, FFinishedGeneratingSpawnDataSignature& FinishedGeneratingSpawnPointsDelegate) const override;
+
+	/**
+	 * Removes parking spaces within ObstacleExclusionGrid's radius of an obstacle, swapping the last remaining space into
+	 * each removed one's place.
+	 */
+	static void RemoveParkingSpacesNearObstacles(TArray<FTransform>& ParkingSpaceTransforms, const UE::MassTraffic::FObstacleExclusionGrid& ObstacleExclusionGrid);
 };
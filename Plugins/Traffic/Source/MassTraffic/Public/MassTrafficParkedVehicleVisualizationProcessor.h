@@ -2,6 +2,7 @@
 
 #pragma once
 
+#include "MassObserverProcessor.h"
 #include "MassRepresentationProcessor.h"
 #include "MassVisualizationLODProcessor.h"
 
@@ -27,7 +28,8 @@ public:
 };
 
 /**
- * Custom visualization updates for ParkedVehicle 
+ * Custom visualization updates for ParkedVehicle. Instanced parked vehicles are kept as persistent static instances
+ * (see FMassTrafficStaticInstances) unless MassTraffic.StaticInstances is off.
  */
 UCLASS()
 class MASSTRAFFIC_API UMassTrafficParkedVehicleUpdateCustomVisualizationProcessor : public UMassProcessor
@@ -47,4 +49,27 @@ private:
 	UWorld* World;
 
 	FMassEntityQuery EntityQuery;
+
+	/** Parked vehicles with persistent instances that are now culled by distance, so no longer in visible chunks. */
+	FMassEntityQuery CulledStaticInstancesEntityQuery;
+};
+
+/**
+ * Removes the persistent instances of parked vehicles & traffic lights whose entities are destroyed. (See
+ * FMassTrafficStaticInstances.)
+ */
+UCLASS()
+class MASSTRAFFIC_API UMassTrafficStaticInstancesDestructor : public UMassObserverProcessor
+{
+	GENERATED_BODY()
+
+public:
+	UMassTrafficStaticInstancesDestructor();
+
+protected:
+	virtual void ConfigureQueries() override;
+	virtual void Execute(FMassEntityManager& EntityManager, FMassExecutionContext& Context) override;
+
+	FMassEntityQuery ParkedVehicleEntityQuery;
+	FMassEntityQuery IntersectionEntityQuery;
 };
\ No newline at end of file
@@ -20,6 +20,18 @@ public:
 	
 protected:
 
+	/**
+	 * @return false when processors moving traffic vehicles should skip this frame, i.e: during replay playback or on
+	 * frames without any fixed timestep substeps. (See FMassTrafficSimulationClock.)
+	 */
+	bool ShouldSimulateTrafficVehicles() const;
+
+	/**
+	 * @return true if vehicle behavior processors should process their chunks in parallel. Debug drawing & visual
+	 * logging aren't thread safe, so this is false while either is active. (See GMassTrafficParallelVehicleBehavior.)
+	 */
+	bool ShouldProcessVehicleBehaviorInParallel() const;
+
 	TWeakObjectPtr<const UMassTrafficSettings> MassTrafficSettings;
 
 	FRandomStream RandomStream;
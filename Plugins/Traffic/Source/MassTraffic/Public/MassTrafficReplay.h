@@ -0,0 +1,107 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "ZoneGraphTypes.h"
+
+class FArchive;
+class UMassTrafficSettings;
+
+
+/**
+ * Compact per-frame state of a single traffic vehicle, as written to a traffic replay.
+ * The transform is the one the simulation ended the frame with, so playback doesn't have to reconstruct it from the
+ * lane location and matches what was simulated exactly.
+ */
+struct MASSTRAFFIC_API FMassTrafficReplayVehicleState
+{
+	// (See FMassTrafficVehicleIdFragment.)
+	int32 VehicleId = INDEX_NONE;
+
+	FZoneGraphLaneHandle LaneHandle;
+	float DistanceAlongLane = 0.0f;
+	float Speed = 0.0f;
+	float LateralOffset = 0.0f;
+
+	FVector Location = FVector::ZeroVector;
+	FQuat Rotation = FQuat::Identity;
+
+	friend FArchive& operator<<(FArchive& Ar, FMassTrafficReplayVehicleState& State);
+};
+
+
+/** All recorded vehicle states for one simulation frame, sorted by vehicle ID. */
+struct MASSTRAFFIC_API FMassTrafficReplayFrame
+{
+	int32 FrameIndex = INDEX_NONE;
+
+	// Traffic simulation time at the end of this frame, in seconds since recording started. Taken from the
+	// FMassTrafficSimulationClock rather than accumulated here, so it doesn't drift over long recordings.
+	double SimulationTime = 0.0;
+
+	float DeltaTime = 0.0f;
+
+	TArray<FMassTrafficReplayVehicleState> Vehicles;
+
+	/** @return The index into Vehicles for VehicleId, or INDEX_NONE if it wasn't recorded this frame. */
+	int32 FindVehicleIndex(const int32 VehicleId) const;
+
+	friend FArchive& operator<<(FArchive& Ar, FMassTrafficReplayFrame& Frame);
+};
+
+
+/**
+ * Streams FMassTrafficReplayFrame's to a binary replay file.
+ *
+ * File layout:
+ *	Header:	uint32 Magic, uint32 Version, int32 RandomSeed
+ *	Frames:	int32 FrameIndex, double SimulationTime, float DeltaTime, int32 NumVehicles, FMassTrafficReplayVehicleState[NumVehicles]
+ *
+ * Vehicles are identified by their spawn order ID, so are only matched up when the replay is played back in the same
+ * map, with the same UMassTrafficSettings::RandomSeed, so the same vehicles are spawned in the same order.
+ */
+class MASSTRAFFIC_API FMassTrafficReplayWriter
+{
+public:
+	~FMassTrafficReplayWriter();
+
+	bool Open(const FString& Filename, const int32 RandomSeed);
+	void WriteFrame(FMassTrafficReplayFrame& Frame);
+	void Close();
+
+	bool IsOpen() const { return Archive.IsValid(); }
+
+private:
+	TUniquePtr<FArchive> Archive;
+};
+
+
+/** Loads a complete traffic replay into memory, for random access playback. */
+class MASSTRAFFIC_API FMassTrafficReplay
+{
+public:
+	bool Load(const FString& Filename);
+	void Reset();
+
+	/**
+	 * Finds the pair of recorded frames bracketing SimulationTime. Both are the same frame if SimulationTime is exactly
+	 * when a frame was recorded.
+	 * @return false if there are no frames.
+	 */
+	bool FindFramesAtTime(const double SimulationTime, int32& OutFrameIndexA, int32& OutFrameIndexB, float& OutAlpha) const;
+
+	bool IsEmpty() const { return Frames.IsEmpty(); }
+	double GetDuration() const { return Frames.IsEmpty() ? 0.0 : Frames.Last().SimulationTime; }
+
+	int32 RandomSeed = 0;
+	TArray<FMassTrafficReplayFrame> Frames;
+};
+
+
+namespace UE::MassTraffic
+{
+
+/** The replay file to record to or play back from, resolved relative to the project's Saved directory. */
+MASSTRAFFIC_API FString GetReplayFilename(const UMassTrafficSettings& MassTrafficSettings);
+
+}
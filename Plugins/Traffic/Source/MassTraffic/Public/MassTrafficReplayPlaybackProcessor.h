@@ -0,0 +1,50 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "MassTrafficProcessorBase.h"
+#include "MassTrafficFragments.h"
+#include "MassTrafficReplay.h"
+#include "MassTrafficReplayPlaybackProcessor.generated.h"
+
+
+/**
+ * When MassTraffic.Replay = 2, drives traffic vehicle lane locations and transforms from a recorded replay instead of
+ * the simulation. Playback time advances with the traffic simulation clock (scaled by
+ * UMassTrafficSettings::ReplayPlaybackRate) and vehicle state is interpolated between the two recorded frames either
+ * side of it, so playback doesn't depend on the frame rate the replay was recorded at. Played back at the recorded rate,
+ * vehicles get the exact transforms that were recorded.
+ *
+ * Whenever a vehicle changes lane, every lane's vehicles & tail vehicle and each vehicle's next vehicle are rebuilt, as
+ * the simulation would have maintained them. The simulation processors that would otherwise move vehicles are
+ * suspended during playback.
+ */
+UCLASS()
+class MASSTRAFFIC_API UMassTrafficReplayPlaybackProcessor : public UMassTrafficProcessorBase
+{
+	GENERATED_BODY()
+
+public:
+	UMassTrafficReplayPlaybackProcessor();
+
+protected:
+	virtual void ConfigureQueries() override;
+	virtual void Execute(FMassEntityManager& EntityManager, FMassExecutionContext& Context) override;
+
+	FMassEntityQuery EntityQuery;
+
+	// Every vehicle on a lane, to rebuild lane vehicles from. (See UE::MassTraffic::RebuildLaneVehicles.)
+	FMassEntityQuery LaneVehiclesQuery;
+
+private:
+	FMassTrafficReplay Replay;
+
+	// Reused between lane vehicle rebuilds
+	TArray<FMassEntityHandle> LaneVehicles;
+
+	// Simulation clock time playback started at
+	double PlaybackStartTime = 0.0;
+
+	double PlaybackTime = 0.0;
+	bool bLoaded = false;
+};
@@ -0,0 +1,37 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "MassTrafficProcessorBase.h"
+#include "MassTrafficReplay.h"
+#include "MassTrafficReplayRecorderProcessor.generated.h"
+
+
+/**
+ * When MassTraffic.Replay = 1, appends the end of frame lane location, speed and transform of every traffic vehicle to
+ * the replay file. (See FMassTrafficReplayWriter.)
+ */
+UCLASS()
+class MASSTRAFFIC_API UMassTrafficReplayRecorderProcessor : public UMassTrafficProcessorBase
+{
+	GENERATED_BODY()
+
+public:
+	UMassTrafficReplayRecorderProcessor();
+
+	virtual void BeginDestroy() override;
+
+protected:
+	virtual void ConfigureQueries() override;
+	virtual void Execute(FMassEntityManager& EntityManager, FMassExecutionContext& Context) override;
+
+	FMassEntityQuery EntityQuery;
+
+private:
+	FMassTrafficReplayWriter Writer;
+	FMassTrafficReplayFrame Frame;
+
+	// Simulation clock time recording started at
+	double RecordingStartTime = 0.0;
+	bool bOpenFailed = false;
+};
@@ -4,6 +4,7 @@
 
 #include "MassTrafficPIDController.h"
 
+#include "MassLODTypes.h"
 #include "MassSettings.h"
 #include "ZoneGraphTypes.h"
 #include "MassTrafficSettings.generated.h"
@@ -86,6 +87,21 @@ public:
 	UPROPERTY(EditAnywhere, Config, Category = "Lanes")
 	FZoneGraphTagFilter CrosswalkLaneFilter;
 
+	/**
+	 * When enabled, the traffic lane data built for each ZoneGraph data is saved to LaneDataCacheDirectory, and
+	 * loaded from there instead of being rebuilt, as long as neither the ZoneGraph data nor the lane settings have
+	 * changed since.
+	 */
+	UPROPERTY(EditAnywhere, Config, Category = "Lanes")
+	bool bCacheLaneData = true;
+
+	/**
+	 * Directory, relative to the project's Saved directory, that lane data is cached in. Like any other derived data,
+	 * each machine & cooked build fills its own cache the first time it builds the lane data.
+	 */
+	UPROPERTY(EditAnywhere, Config, Category = "Lanes", meta=(EditCondition="bCacheLaneData"))
+	FString LaneDataCacheDirectory = TEXT("MassTraffic/LaneData");
+
 	/**
 	 * Lane speed limits in Miles per Hour, to initialise FDataFragment_TrafficLane::SpeedLimit's with.
 	 * 
@@ -463,4 +479,62 @@ public:
 	 */
 	UPROPERTY(EditAnywhere, Config, Category="Noise")
 	float NoisePeriod = 20000.0f;
+
+	/**
+	 * File that traffic replays are recorded to and played back from, when MassTraffic.Replay is enabled. Relative
+	 * paths are relative to the project's Saved directory.
+	 */
+	UPROPERTY(EditAnywhere, Config, Category="Replay")
+	FString ReplayFilename = TEXT("TrafficReplay.bin");
+
+	/** Playback speed multiplier applied to the frame delta time when playing back a traffic replay. */
+	UPROPERTY(EditAnywhere, Config, Category="Replay", meta=(ClampMin="0.0"))
+	float ReplayPlaybackRate = 1.0f;
+
+	/**
+	 * When enabled, traffic is simulated in fixed FixedTimestepRate steps, decoupled from the frame rate. Each frame
+	 * simulates as many whole steps as have elapsed (possibly none) and vehicle visualization interpolates between
+	 * the last two simulated states. Slow frames, e.g: during high resolution offline captures, then don't change
+	 * traffic behavior.
+	 */
+	UPROPERTY(EditAnywhere, Config, Category="Fixed Timestep")
+	bool bFixedTimestep = false;
+
+	/** Simulation steps per second when bFixedTimestep is enabled. */
+	UPROPERTY(EditAnywhere, Config, Category="Fixed Timestep", meta=(EditCondition="bFixedTimestep", ClampMin="1.0", UIMin="10.0", UIMax="120.0"))
+	float FixedTimestepRate = 60.0f;
+
+	/**
+	 * Maximum number of simulation steps per frame. Any more elapsed time than this is dropped, slowing traffic down
+	 * rather than letting it fall further and further behind.
+	 */
+	UPROPERTY(EditAnywhere, Config, Category="Fixed Timestep", meta=(EditCondition="bFixedTimestep", ClampMin="1"))
+	int32 MaxFixedTimestepSubsteps = 8;
+
+	/**
+	 * Vehicles simulated at a lower LOD than this integrate a frame's worth of fixed steps as a single coarse step,
+	 * reducing the simulation rate for distant traffic.
+	 */
+	UPROPERTY(EditAnywhere, Config, Category="Fixed Timestep", meta=(EditCondition="bFixedTimestep"))
+	TEnumAsByte<EMassLOD::Type> MaxFixedTimestepSubstepLOD = EMassLOD::Medium;
+
+	/**
+	 * When enabled, lanes further than FarFieldDistance from every viewer are simulated as aggregate flow (vehicle
+	 * count & speed per lane) rather than as individual vehicles. Off LOD vehicles anywhere on far field lanes are
+	 * dematerialised into the flow, and the flow materialises vehicles again where it reaches near field lanes.
+	 */
+	UPROPERTY(EditAnywhere, Config, Category="Far Field")
+	bool bFarFieldSimulation = false;
+
+	/** Distance from the nearest viewer beyond which lanes become far field. Should be beyond the Off simulation LOD distance. */
+	UPROPERTY(EditAnywhere, Config, Category="Far Field", meta=(EditCondition="bFarFieldSimulation", ClampMin="0.0"))
+	float FarFieldDistance = 60000.0f;
+
+	/** Average length of lane taken by a far field vehicle in a jam, including the gap to the vehicle ahead. */
+	UPROPERTY(EditAnywhere, Config, Category="Far Field", meta=(EditCondition="bFarFieldSimulation", ClampMin="100.0"))
+	float FarFieldVehicleSpacing = 700.0f;
+
+	/** Maximum number of vehicles to materialise and dematerialise each frame, to amortise the cost of lane surgery. */
+	UPROPERTY(EditAnywhere, Config, Category="Far Field", meta=(EditCondition="bFarFieldSimulation", ClampMin="1"))
+	int32 MaxFarFieldTransitionsPerFrame = 32;
 };
@@ -0,0 +1,28 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "MassTrafficProcessorBase.h"
+#include "MassTrafficSimulationClockProcessor.generated.h"
+
+
+/**
+ * Advances the traffic simulation clock at the very start of the frame. (See FMassTrafficSimulationClock.)
+ * 
+ * With UMassTrafficSettings::bFixedTimestep enabled, this also captures each vehicle's transform into
+ * FMassTrafficPreviousTransformFragment before any substeps are simulated, for visualization to interpolate from.
+ */
+UCLASS()
+class MASSTRAFFIC_API UMassTrafficSimulationClockProcessor : public UMassTrafficProcessorBase
+{
+	GENERATED_BODY()
+
+public:
+	UMassTrafficSimulationClockProcessor();
+
+protected:
+	virtual void ConfigureQueries() override;
+	virtual void Execute(FMassEntityManager& EntityManager, FMassExecutionContext& Context) override;
+
+	FMassEntityQuery EntityQuery;
+};
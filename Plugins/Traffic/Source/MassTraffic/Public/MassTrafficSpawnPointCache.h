@@ -0,0 +1,38 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "ZoneGraphTypes.h"
+
+struct FZoneGraphStorage;
+
+
+/**
+ * On disk cache of generated lane spawn points, so that repeated spawn data generation on the same ZoneGraph data,
+ * with the same seed & settings, can skip generation entirely.
+ *
+ * Cache files are named after a key which callers build from GetZoneGraphStorageHash and everything else the points
+ * depend on. Lane handles are stored as lane indices and restored against the storage the points are loaded for.
+ */
+namespace UE::MassTraffic
+{
+
+/** Hash of a ZoneGraph storage's lanes, lane geometry & lane links, to key data generated from it. */
+MASSTRAFFIC_API uint32 GetZoneGraphStorageHash(const FZoneGraphStorage& ZoneGraphStorage);
+
+/** Hash of a lane tag filter, to key data generated with it. */
+MASSTRAFFIC_API uint32 GetZoneGraphTagFilterHash(const FZoneGraphTagFilter& TagFilter);
+
+/** @return Where spawn points generated for CacheKey are cached, under the project's Saved directory. */
+MASSTRAFFIC_API FString GetSpawnPointCacheFilename(const TCHAR* CacheName, const uint32 CacheKey);
+
+/**
+ * Loads spawn points previously saved for CacheKey.
+ * @return false if there was no cache file, or it was written for a different key, version or storage.
+ */
+MASSTRAFFIC_API bool LoadSpawnPointCache(const FString& Filename, const uint32 CacheKey, const FZoneGraphStorage& ZoneGraphStorage, TArray<TArray<FZoneGraphLaneLocation>>& OutSpawnPointsPerSpacing);
+
+/** Saves spawn points generated for CacheKey. */
+MASSTRAFFIC_API bool SaveSpawnPointCache(const FString& Filename, const uint32 CacheKey, const TArray<TArray<FZoneGraphLaneLocation>>& SpawnPointsPerSpacing);
+
+}
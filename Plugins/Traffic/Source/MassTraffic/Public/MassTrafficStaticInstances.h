@@ -0,0 +1,213 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "MassEntityTypes.h"
+#include "Containers/SparseArray.h"
+
+class AActor;
+class UInstancedStaticMeshComponent;
+class UWorld;
+struct FMassTrafficStaticInstancesFragment;
+struct FStaticMeshInstanceVisualizationDesc;
+
+namespace UE::MassTraffic
+{
+	/** Identifies the ISM components of a mesh desc within a cell. @see FMassTrafficStaticInstances, FMassTrafficMovingInstances */
+	struct FInstanceMeshComponentsKey
+	{
+		int16 StaticMeshDescIndex = INDEX_NONE;
+		FIntPoint Cell = FIntPoint::ZeroValue;
+
+		bool operator==(const FInstanceMeshComponentsKey& Other) const
+		{
+			return StaticMeshDescIndex == Other.StaticMeshDescIndex && Cell == Other.Cell;
+		}
+
+		friend uint32 GetTypeHash(const FInstanceMeshComponentsKey& Key)
+		{
+			return HashCombine(GetTypeHash(Key.StaticMeshDescIndex), GetTypeHash(Key.Cell));
+		}
+	};
+}
+
+/**
+ * Persistent ISM instances for entities that don't move while instanced, e.g: parked vehicles & traffic lights, only
+ * updated when an entity's mesh, custom data or LOD changes rather than resubmitted every frame. Instances must be
+ * removed explicitly once their entity is culled or destroyed. (See UMassTrafficStaticInstancesDestructor.)
+ */
+struct MASSTRAFFIC_API FMassTrafficStaticInstances
+{
+	FMassTrafficStaticInstances() = default;
+	FMassTrafficStaticInstances(const FMassTrafficStaticInstances&) = delete;
+	FMassTrafficStaticInstances& operator=(const FMassTrafficStaticInstances&) = delete;
+
+	/** Starts a new update, resetting if the world or MassTraffic.StaticInstanceCellSize changed. */
+	void BeginUpdate(UWorld& InWorld);
+
+	/**
+	 * Keeps an instance of StaticMeshDesc's meshes, for those whose LOD significance range contains LODSignificance,
+	 * for InstancesFragment's entity. SubIndex distinguishes between multiple instances for the same entity, e.g: an
+	 * intersection's lights. Transform is only used when the instance is added, as instanced entities don't move.
+	 */
+	void SetInstance(FMassTrafficStaticInstancesFragment& InstancesFragment, const int32 SubIndex, const int16 StaticMeshDescIndex, const FStaticMeshInstanceVisualizationDesc& StaticMeshDesc, const FTransform& Transform, const float LODSignificance, const float CustomData);
+
+	/** Removes all of InstancesFragment's entity's instances, if it has any. */
+	void RemoveInstances(FMassTrafficStaticInstancesFragment& InstancesFragment);
+
+	/** @return Whether InstancesFragment's entity has any instances. */
+	bool HasInstances(const FMassTrafficStaticInstancesFragment& InstancesFragment) const;
+
+	/** Marks the render state of components whose instances changed since the last update dirty. */
+	void EndUpdate();
+
+	/** Removes all instances & destroys the components holding them. Entities' handles to them become stale. */
+	void Reset();
+
+	int32 Num() const
+	{
+		return Instances.Num();
+	}
+
+private:
+
+	using FMeshComponentsKey = UE::MassTraffic::FInstanceMeshComponentsKey;
+
+	struct FInstance
+	{
+		FTransform Transform;
+		float CustomData = 0.0f;
+		int16 StaticMeshDescIndex = INDEX_NONE;
+		FIntPoint Cell = FIntPoint::ZeroValue;
+
+		/** This instance's index in each of its mesh desc's mesh components, or INDEX_NONE if it's outside that mesh's LOD significance range */
+		TArray<int32, TInlineAllocator<2>> MeshInstanceIndices;
+	};
+
+	struct FMeshComponent
+	{
+		TWeakObjectPtr<UInstancedStaticMeshComponent> ISMComponent;
+		int32 MeshIndex = INDEX_NONE;
+
+		/** The handle of the instance at each ISM instance index, to fix up the instance swapped into a removed one's place */
+		TArray<int32> InstanceHandles;
+
+		bool bRenderStateDirty = false;
+	};
+
+	FIntPoint GetCell(const FVector& Location) const;
+
+	/** Forgets InstancesFragment's handles if they're from before our last Reset. */
+	void ResetStaleHandles(FMassTrafficStaticInstancesFragment& InstancesFragment) const;
+
+	TArray<FMeshComponent>& FindOrAddMeshComponents(const FMeshComponentsKey& MeshComponentsKey, const FStaticMeshInstanceVisualizationDesc& StaticMeshDesc);
+
+	/** Hides & pools the mesh components at MeshComponentsKey if they no longer have any instances. @return Whether they were pooled. */
+	bool ReleaseMeshComponentsIfEmpty(const FMeshComponentsKey& MeshComponentsKey);
+
+	void MarkRenderStateDirty(FMeshComponent& MeshComponent, const FInstance& Instance);
+
+	void AddMeshInstance(FMeshComponent& MeshComponent, const int32 InstanceHandle);
+	void RemoveMeshInstance(FMeshComponent& MeshComponent, const int32 InstanceHandle);
+	void RemoveMeshInstances(const int32 InstanceHandle);
+
+	TWeakObjectPtr<UWorld> World;
+	TWeakObjectPtr<AActor> OwnerActor;
+
+	TSparseArray<FInstance> Instances;
+	TMap<FMeshComponentsKey, TArray<FMeshComponent>> MeshComponentsByKey;
+
+	/** Hidden mesh components of cells that were left empty, by mesh desc, to reuse for other cells. */
+	TMap<int16, TArray<TArray<FMeshComponent>>> PooledMeshComponentsByDesc;
+
+	/** Mesh components with a component marked bRenderStateDirty since the last EndUpdate. May contain duplicates. */
+	TArray<FMeshComponentsKey> DirtyMeshComponentsKeys;
+
+	/** MassTraffic.StaticInstanceCellSize the current instances were bucketed with. */
+	float CellSize = 0.0f;
+
+	/** Incremented by Reset, to tell handles to instances from before it apart. @see FMassTrafficStaticInstancesFragment::ResetCount */
+	uint32 ResetCount = 0;
+};
+
+/**
+ * ISM instances for entities that move, e.g: traffic vehicles, trailers & drivers. Like the Mass ISM batches, every
+ * instance is re-added each update, but they're bucketed into the same cells as FMassTrafficStaticInstances by their
+ * current location, and only cells whose instances changed since the last update have their instance buffers
+ * rebuilt. The components of cells left empty are hidden & pooled for other cells to reuse.
+ */
+struct MASSTRAFFIC_API FMassTrafficMovingInstances
+{
+	FMassTrafficMovingInstances() = default;
+	FMassTrafficMovingInstances(const FMassTrafficMovingInstances&) = delete;
+	FMassTrafficMovingInstances& operator=(const FMassTrafficMovingInstances&) = delete;
+
+	/** Starts a new update, resetting if the world or MassTraffic.StaticInstanceCellSize changed. */
+	void BeginUpdate(UWorld& InWorld);
+
+	/**
+	 * Adds an instance of StaticMeshDesc's meshes, for those whose LOD significance range contains LODSignificance, to
+	 * this update. CustomData is passed as floats, like FMassInstancedStaticMeshInfo::AddBatchedCustomData, and must be
+	 * the same size for every instance of a mesh desc.
+	 */
+	template<typename TCustomData>
+	void AddInstance(const int16 StaticMeshDescIndex, const FStaticMeshInstanceVisualizationDesc& StaticMeshDesc, const FTransform& Transform, const float LODSignificance, const TCustomData& CustomData)
+	{
+		static_assert(sizeof(TCustomData) % sizeof(float) == 0, "Custom data must be made of floats");
+		AddInstance(StaticMeshDescIndex, StaticMeshDesc, Transform, LODSignificance, TConstArrayView<float>(reinterpret_cast<const float*>(&CustomData), sizeof(TCustomData) / sizeof(float)));
+	}
+
+	void AddInstance(const int16 StaticMeshDescIndex, const FStaticMeshInstanceVisualizationDesc& StaticMeshDesc, const FTransform& Transform, const float LODSignificance, TConstArrayView<float> CustomData);
+
+	/** Rebuilds the instance buffers of cells whose instances changed this update & pools the components of cells left empty. */
+	void EndUpdate();
+
+	/** Removes all instances & destroys the components holding them. */
+	void Reset();
+
+	/** @return The number of instances added by the last update. */
+	int32 Num() const
+	{
+		return NumInstances;
+	}
+
+private:
+
+	using FMeshComponentsKey = UE::MassTraffic::FInstanceMeshComponentsKey;
+
+	struct FMeshComponent
+	{
+		TWeakObjectPtr<UInstancedStaticMeshComponent> ISMComponent;
+
+		/** Instances added this update */
+		TArray<FTransform> Transforms;
+		TArray<float> CustomData;
+
+		/** Instances in ISMComponent, from the last update that changed them */
+		TArray<FTransform> SubmittedTransforms;
+		TArray<float> SubmittedCustomData;
+	};
+
+	FIntPoint GetCell(const FVector& Location) const;
+
+	TArray<FMeshComponent>& FindOrAddMeshComponents(const FMeshComponentsKey& MeshComponentsKey, const FStaticMeshInstanceVisualizationDesc& StaticMeshDesc, const int32 NumCustomDataFloats);
+
+	/** Updates MeshComponent's ISM component with this update's instances, if they changed. */
+	void SubmitMeshInstances(FMeshComponent& MeshComponent, const int32 NumCustomDataFloats);
+
+	TWeakObjectPtr<UWorld> World;
+	TWeakObjectPtr<AActor> OwnerActor;
+
+	TMap<FMeshComponentsKey, TArray<FMeshComponent>> MeshComponentsByKey;
+
+	/** Hidden mesh components of cells that were left empty, by mesh desc, to reuse for other cells. */
+	TMap<int16, TArray<TArray<FMeshComponent>>> PooledMeshComponentsByDesc;
+
+	/** Number of custom data floats per instance, by mesh desc. */
+	TMap<int16, int32> NumCustomDataFloatsByDesc;
+
+	/** MassTraffic.StaticInstanceCellSize the instances are bucketed with. */
+	float CellSize = 0.0f;
+
+	int32 NumInstances = 0;
+};
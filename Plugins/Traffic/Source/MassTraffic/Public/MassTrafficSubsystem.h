@@ -5,6 +5,7 @@
 #include "MassTrafficPhysics.h"
 #include "MassTrafficTypes.h"
 #include "MassTrafficSettings.h"
+#include "MassTrafficStaticInstances.h"
 
 #include "ZoneGraphData.h"
 #include "ZoneGraphSubsystem.h"
@@ -56,6 +57,17 @@ public:
 		return TArrayView<FMassTrafficZoneGraphData*>(RegisteredTrafficZoneGraphData.GetData(), RegisteredTrafficZoneGraphData.Num());
 	}
 
+	/**
+	 * Returns the lane segment table to interpolate along a given zone graph's lanes with.
+	 * @return The table, or nullptr if the zone graph isn't registered (yet), in which case lane segments are found by
+	 * stepping through the lanes' points. Unlike GetTrafficZoneGraphData, doesn't ensure.
+	 */
+	FORCEINLINE const FMassTrafficLaneSegmentTable* GetLaneSegmentTable(const FZoneGraphDataHandle DataHandle) const
+	{
+		const FMassTrafficZoneGraphData* TrafficZoneGraphData = RegisteredTrafficZoneGraphData.IsValidIndex(DataHandle.Index) ? &RegisteredTrafficZoneGraphData[DataHandle.Index] : nullptr;
+		return TrafficZoneGraphData && TrafficZoneGraphData->DataHandle == DataHandle && TrafficZoneGraphData->LaneSegmentTable.IsBuilt() ? &TrafficZoneGraphData->LaneSegmentTable : nullptr;
+	}
+
 	/**
 	 * Returns the readonly runtime data associated to a given zone graph lane.
 	 * @param LaneHandle A valid lane handle used to retrieve the runtime data; ensure if handle is invalid
@@ -84,7 +96,7 @@ public:
 		return *MutableTrafficLaneData;
 	}
 
-	/** Returns the number of traffic vehicle agents currently present in the world */ 
+	/** Returns the number of traffic vehicle agents currently present in the world, including far field vehicles */ 
 	UFUNCTION(BlueprintPure, Category="Mass Traffic")
 	int32 GetNumTrafficVehicleAgents();
 	
@@ -110,7 +122,12 @@ public:
 		return Fields;
 	}
 
-	/** Perform the specified operation, if present, on all registered traffic fields */  
+	/**
+	 * Perform the specified operation, if present, on all registered traffic fields. Fields are run in batches of fields
+	 * that don't overlap any of the same lanes or intersections, so any two fields that do overlap still run in
+	 * registration order. Within a batch, fields whose operations can all execute in parallel are run in parallel, and
+	 * the others serially. @see GMassTrafficParallelFieldOperations
+	 */
 	void PerformFieldOperation(TSubclassOf<UMassTrafficFieldOperationBase> OperationType);
 
 	/**
@@ -132,8 +149,69 @@ public:
 	 */
 	void RemoveVehiclesOverlappingPlayers();
 
+	/** Returns the traffic simulation clock, advanced at the start of each frame. */
+	const FMassTrafficSimulationClock& GetSimulationClock() const
+	{
+		return SimulationClock;
+	}
+
+	FMassTrafficSimulationClock& GetMutableSimulationClock()
+	{
+		return SimulationClock;
+	}
+
+	/** Returns the ID for the next traffic vehicle spawned in this world. (See FMassTrafficVehicleIdFragment.) */
+	int32 GetNextVehicleId()
+	{
+		return NextVehicleId++;
+	}
+
+	/** Returns the vehicles currently dematerialised into the far field flow. (See UMassTrafficFarFieldProcessor.) */
+	const TArray<FMassEntityHandle>& GetFarFieldVehicles() const
+	{
+		return FarFieldVehicles;
+	}
+
+	TArray<FMassEntityHandle>& GetMutableFarFieldVehicles()
+	{
+		return FarFieldVehicles;
+	}
+
+	/** Returns the persistent instances of parked vehicles. (See UMassTrafficParkedVehicleUpdateCustomVisualizationProcessor.) */
+	FMassTrafficStaticInstances& GetMutableParkedVehicleStaticInstances()
+	{
+		return ParkedVehicleStaticInstances;
+	}
+
+	/** Returns the persistent instances of traffic lights. (See UMassTrafficLightUpdateCustomVisualizationProcessor.) */
+	FMassTrafficStaticInstances& GetMutableTrafficLightStaticInstances()
+	{
+		return TrafficLightStaticInstances;
+	}
+
+	/** Returns the cell bucketed instances of traffic vehicles. (See UMassTrafficVehicleUpdateCustomVisualizationProcessor.) */
+	FMassTrafficMovingInstances& GetMutableTrafficVehicleMovingInstances()
+	{
+		return TrafficVehicleMovingInstances;
+	}
+
+	/** Returns the cell bucketed instances of trailers. (See UMassTrafficTrailerUpdateCustomVisualizationProcessor.) */
+	FMassTrafficMovingInstances& GetMutableTrailerMovingInstances()
+	{
+		return TrailerMovingInstances;
+	}
+
+	/** Returns the cell bucketed instances of drivers. (See UMassTrafficDriverVisualizationProcessor.) */
+	FMassTrafficMovingInstances& GetMutableDriverMovingInstances()
+	{
+		return DriverMovingInstances;
+	}
+
 #if WITH_EDITOR
-	/** Clears and rebuilds all lane and intersection data for registered zone graphs using the current settings. */
+	/**
+	 * Rebuilds lane data for registered zone graphs using the current settings. Only lane data whose ZoneGraph data or
+	 * lane settings have changed is rebuilt.
+	 */
 	void RebuildLaneData();
 #endif
 	
@@ -145,6 +223,15 @@ protected:
 	void RegisterField(UMassTrafficFieldComponent* Field);
 	void UnregisterField(UMassTrafficFieldComponent* Field);
 
+	/** Called when fields are (un)registered or their overlapped lanes & intersections change. */
+	void InvalidateFieldBatches()
+	{
+		bFieldBatchesDirty = true;
+	}
+
+	/** Groups Fields into FieldBatches, if they're dirty. */
+	void UpdateFieldBatches();
+
 	const TMap<int32, FMassEntityHandle>& GetTrafficIntersectionEntities() const;
 	void RegisterTrafficIntersectionEntity(int32 ZoneIndex, const FMassEntityHandle IntersectionEntity);
 	FMassEntityHandle GetTrafficIntersectionEntity(int32 IntersectionIndex) const;
@@ -158,6 +245,9 @@ protected:
 	void RegisterZoneGraphData(const AZoneGraphData* ZoneGraphData);
 	void BuildLaneData(FMassTrafficZoneGraphData& TrafficZoneGraphData, const FZoneGraphStorage& ZoneGraphStorage);
 
+	/** Loads TrafficZoneGraphData from the lane data cache for SourceKey, or builds (and caches) it if it isn't there. */
+	void LoadOrBuildLaneData(FMassTrafficZoneGraphData& TrafficZoneGraphData, const FZoneGraphStorage& ZoneGraphStorage, const uint32 SourceKey);
+
 	FMassTrafficZoneGraphData* GetMutableTrafficZoneGraphData(const FZoneGraphDataHandle DataHandle);
 
 	UPROPERTY(Transient)
@@ -166,6 +256,14 @@ protected:
 	UPROPERTY(Transient)
 	TArray<TObjectPtr<UMassTrafficFieldComponent>> Fields;
 
+	/**
+	 * Indices into Fields, grouped by dependency level: each field is in the batch after the latest batch of any earlier
+	 * registered field it overlaps any of the same lanes or intersections with. So no two fields in a batch overlap, and
+	 * can therefore have their operations performed in parallel, while overlapping fields keep their registration order.
+	 */
+	TArray<TArray<int32>> FieldBatches;
+	bool bFieldBatchesDirty = true;
+
 	UPROPERTY(Transient)
 	TObjectPtr<UZoneGraphSubsystem> ZoneGraphSubsystem = nullptr;
 
@@ -182,6 +280,25 @@ protected:
 	
 	TMap<int32, FMassEntityHandle> RegisteredTrafficIntersections;
 
+	FMassTrafficSimulationClock SimulationClock;
+
+	int32 NextVehicleId = 0;
+
+	/** Pool of dematerialised far field vehicles, to materialise as far field flow reaches near field lanes */
+	TArray<FMassEntityHandle> FarFieldVehicles;
+
+	/**
+	 * Persistent instances, kept here rather than by the processors updating them so they can also be removed as their
+	 * entities are destroyed. @see UMassTrafficStaticInstancesDestructor
+	 */
+	FMassTrafficStaticInstances ParkedVehicleStaticInstances;
+	FMassTrafficStaticInstances TrafficLightStaticInstances;
+
+	/** Instances of moving entities, re-added every frame. Kept here so their components are destroyed with the subsystem. */
+	FMassTrafficMovingInstances TrafficVehicleMovingInstances;
+	FMassTrafficMovingInstances TrailerMovingInstances;
+	FMassTrafficMovingInstances DriverMovingInstances;
+
 	/** Used to test if there are any spawned traffic vehicles */
 	FMassEntityQuery TrafficVehicleEntityQuery;
 
@@ -5,6 +5,7 @@
 #include "MassRepresentationProcessor.h"
 #include "MassVisualizationLODProcessor.h"
 
+#include "MassTrafficActorUpdateBatch.h"
 #include "MassTrafficFragments.h"
 
 #include "MassTrafficTrailerVisualizationProcessor.generated.h"
@@ -27,7 +28,8 @@ public:
 };
 
 /**
- * Custom visualization updates for TrafficVehicleTrailer
+ * Custom visualization updates for TrafficVehicleTrailer. Instanced trailers are bucketed into cells (see
+ * FMassTrafficMovingInstances) unless MassTraffic.StaticInstances is off.
  */
 UCLASS()
 class MASSTRAFFIC_API UMassTrafficTrailerUpdateCustomVisualizationProcessor : public UMassProcessor
@@ -47,4 +49,6 @@ private:
 	UWorld* World;
 
 	FMassEntityQuery EntityQuery;
+
+	FMassTrafficActorUpdateBatch ActorUpdateBatch;
 };
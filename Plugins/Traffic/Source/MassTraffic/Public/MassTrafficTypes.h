@@ -8,6 +8,7 @@
 
 #include "HierarchicalHashGrid2D.h"
 #include "MassEntityView.h"
+#include "MassLODTypes.h"
 
 #include "MassTrafficTypes.generated.h"
 
@@ -445,7 +446,53 @@ struct MASSTRAFFIC_API FZoneGraphTrafficLaneConstData
 };
 
 
-typedef TFunction< bool (const FMassEntityView& VehicleEntityView, struct FMassTrafficNextVehicleFragment& NextVehicleFragment, struct FMassZoneGraphLaneLocationFragment& LaneLocationFragment) > FTrafficVehicleExecuteFunction;
+/**
+ * Compact entry for a vehicle on a lane, kept in lane order (tail vehicle first) by FZoneGraphTrafficLaneData.
+ * DistanceAlongLane and Radius are a cache of the vehicle's fragments, refreshed once per frame.
+ * @see FZoneGraphTrafficLaneData::Vehicles
+ */
+struct MASSTRAFFIC_API FMassTrafficLaneVehicle
+{
+	FMassTrafficLaneVehicle(const FMassEntityHandle InEntity = FMassEntityHandle(), const float InDistanceAlongLane = 0.0f, const float InRadius = 0.0f) :
+		Entity(InEntity),
+		DistanceAlongLane(InDistanceAlongLane),
+		Radius(InRadius)
+	{
+	}
+
+	FMassEntityHandle Entity;
+	float DistanceAlongLane = 0.0f;
+	float Radius = 0.0f;
+};
+
+struct FZoneGraphTrafficLaneData;
+
+/**
+ * Entry in a lane's next lane routing table. (See FZoneGraphTrafficLaneData::NextLaneRoutes.)
+ * Holds everything about choosing a next lane that only depends on lane topology & settings, so choosing between
+ * routes only has to read the dynamic space & density of each route's DestinationLane.
+ */
+struct MASSTRAFFIC_API FMassTrafficNextLaneRoute
+{
+	/** Next lane vehicles taking this route move on to. */
+	FZoneGraphTrafficLaneData* NextLane = nullptr;
+
+	/**
+	 * Lane this route is judged by - NextLane itself or, if NextLane is an intersection lane, the lane at the
+	 * intersection exit.
+	 */
+	FZoneGraphTrafficLaneData* DestinationLane = nullptr;
+
+	/** Cached DestinationLane->Length */
+	float DestinationLaneLength = 0.0f;
+
+	/** NextLane is a trunk lane, so vehicles restricted to trunk lanes can take it. (See TrunkVehicleLaneCheck.) */
+	bool bIsTrunkLane = false;
+
+	/** Cached NextLane turn flags, for turn signals. */
+	bool bTurnsLeft = false;
+	bool bTurnsRight = false;
+};
 
 USTRUCT()
 struct MASSTRAFFIC_API FZoneGraphTrafficLaneData
@@ -463,6 +510,7 @@ struct MASSTRAFFIC_API FZoneGraphTrafficLaneData
 	bool bIsDownstreamFromIntersection : 1;
 	bool bIsStoppedVehicleInPreviousLaneOverlappingThisLane : 1; // (See all CROSSWALKOVERLAP.)
 	bool bIsVehicleReadyToUseLane : 1; // (See all READYLANE.)
+	bool bIsFarField : 1; // ..lane is simulated as aggregate flow. (See UMassTrafficFarFieldProcessor.)
 
 	UE::MassTraffic::TFraction<true, uint8> FractionUntilClosed;
 
@@ -492,6 +540,15 @@ struct MASSTRAFFIC_API FZoneGraphTrafficLaneData
 	TArray<FZoneGraphTrafficLaneData*, TInlineAllocator<MASSTRAFFIC_NUM_INLINE_VEHICLE_MERGING_LANES>> MergingLanes;
 	TArray<FZoneGraphTrafficLaneData*, TInlineAllocator<MASSTRAFFIC_NUM_INLINE_VEHICLE_SPLITTING_LANES>> SplittingLanes;
 
+	/**
+	 * Routing table of the NextLanes vehicles can choose between, precomputed from lane topology by
+	 * BuildNextLaneRoutes. Intersection lanes without exactly one exit lane aren't routable and are left out.
+	 */
+	TArray<FMassTrafficNextLaneRoute, TInlineAllocator<MASSTRAFFIC_NUM_INLINE_VEHICLE_NEXT_LANES>> NextLaneRoutes;
+
+	/** Rebuilds NextLaneRoutes. NextLanes of this lane and of its next lanes must already be set. */
+	void BuildNextLaneRoutes();
+
 	/**
 	 * NOTE - If these take up too much memory, we can instead make a single 1-bit flag to cover both of these, that simply
 	 * tells if the lane is generally involved in a lane change - something like 'bIsLaneInvolvedInLaneChange', and remove
@@ -504,21 +561,87 @@ struct MASSTRAFFIC_API FZoneGraphTrafficLaneData
 	/** Center location (average between start and end lane location) and radius for distance testing */
 	FVector CenterLocation;
 	FFloat16 Radius;
+
+	/**
+	 * Far field flow state. (See UMassTrafficFarFieldProcessor.)
+	 * FarFieldNumVehicles are dematerialised vehicles on this far field lane, each occupying
+	 * UMassTrafficSettings::FarFieldVehicleSpacing of SpaceAvailable. FarFieldPendingVehicles have flowed onto this
+	 * near field lane and are waiting for space at the start of the lane to be materialised.
+	 */
+	float FarFieldNumVehicles = 0.0f;
+	float FarFieldPendingVehicles = 0.0f;
+	float FarFieldSpeed = 0.0f;
+
+	/**
+	 * Vehicles on this lane, in the same order as the NextVehicle links - TailVehicle first, the vehicle nearest the
+	 * lane end last. Rebuilt by RebuildLaneVehicles when vehicles are spawned or replayed, maintained by
+	 * MoveVehicleToNextLane and TeleportVehicleToAnotherLane, and refreshed once per frame by UMassTrafficRefreshLaneVehiclesProcessor.
+	 * Cached distances lag behind as vehicles move during the frame, but are always in ascending order & never ahead of
+	 * their vehicle's current distance, so Vehicles can be binary searched at any time. (See InsertVehicle.)
+	 */
+	TArray<FMassTrafficLaneVehicle> Vehicles;
 	
 	/** Clears all references to vehicles on this lane and reset all vehicle counters */  
 	void ClearVehicles();
 
 	/**
-	 * Walks along the vehicles on this lane starting from TailVehicle and following the NextVehicle links,
-	 * calling Function on each vehicle, until we reach a vehicle on another lane or we loop back to TailVehicle.
+	 * Visits the vehicles on this lane in order, starting from TailVehicle, calling Visitor on each vehicle until it
+	 * returns false. Visitor is called as -
+	 *		bool Visitor(const FMassEntityView&, FMassTrafficNextVehicleFragment&, FMassZoneGraphLaneLocationFragment&)
+	 * NOTE - Visitor must not add or remove vehicles on this lane.
+	 * (Defined in MassTrafficFragments.h, as it needs the vehicle fragment types.)
+	 */
+	template<typename TVisitor>
+	void ForEachVehicleOnLane(const FMassEntityManager& EntityManager, TVisitor&& Visitor) const;
+
+	/** Makes Entity the new tail vehicle in Vehicles. Doesn't touch TailVehicle. */
+	void AddTailVehicle(const FMassEntityHandle Entity, const float DistanceAlongLane, const float VehicleRadius);
+
+	/**
+	 * Inserts Entity into Vehicles directly ahead of BehindEntity. If BehindEntity isn't on this lane, Entity is
+	 * inserted by distance instead.
+	 */
+	void InsertVehicleAhead(const FMassEntityHandle BehindEntity, const FMassEntityHandle Entity, const float DistanceAlongLane, const float VehicleRadius);
+
+	/** Removes Entity from Vehicles, returning false if it wasn't found. */
+	bool RemoveVehicle(const FMassEntityHandle Entity);
+
+	/**
+	 * Inserts Entity into Vehicles at Index, caching at most the (possibly stale) distance of the vehicle ahead of it,
+	 * and lowering any stale distances behind it above that, to keep cached distances in ascending order. Lowering a
+	 * cached distance only makes it lag further behind, which is always safe.
 	 */
-	void ForEachVehicleOnLane(const FMassEntityManager& EntityManager, FTrafficVehicleExecuteFunction Function) const;
+	void InsertVehicle(const int32 Index, const FMassEntityHandle Entity, const float DistanceAlongLane, const float VehicleRadius);
+
+	/**
+	 * Updates the cached distances and radii in Vehicles, and drops any entries that are no longer on this lane.
+	 * Distances are clamped to those of the vehicles ahead, to stay in ascending order.
+	 */
+	void RefreshVehicles(const FMassEntityManager& EntityManager);
+
+	/**
+	 * Binary searches Vehicles for the first vehicle further along the lane than DistanceAlongLane, by cached distance.
+	 * Vehicles behind the result may have since moved past DistanceAlongLane, but none ahead of it can be behind it.
+	 * @return Index into Vehicles, or Vehicles.Num() if there is no such vehicle.
+	 */
+	int32 FindFirstVehicleIndexAhead(const float DistanceAlongLane) const;
+
+	/**
+	 * Finds Entity in Vehicles, searching back from where DistanceAlongLane, its current distance along the lane, would
+	 * be. As cached distances only lag behind, it's usually found within a step or two.
+	 * @return Index into Vehicles, or INDEX_NONE if Entity isn't on this lane.
+	 */
+	int32 FindVehicleIndex(const FMassEntityHandle Entity, const float DistanceAlongLane) const;
 
 	/** Space available for vehicle. */
 	void ClearVehicleOccupancy();
 	void RemoveVehicleOccupancy(const float SpaceToAdd);
 	void AddVehicleOccupancy(const float SpaceToRemove);
 
+	/** Space available for far field vehicles. These don't count towards NumVehiclesOnLane. */
+	void AddFarFieldVehicles(const float NumVehicles, const float VehicleSpacing);
+	void RemoveFarFieldVehicles(const float NumVehicles, const float VehicleSpacing);
+
 	float SpaceAvailableFromStartOfLaneForVehicle(const FMassEntityManager& EntityManager, const bool bCheckLaneChangeGhostVehicles, const bool bCheckSplittingAndMergingGhostTailVehicles) const;
 
 	// Traffic density.
@@ -550,6 +673,57 @@ private:
 	FFloat16 DownstreamFlowDensity = 0.0f;
 };
 
+/**
+ * Precomputed interpolation data for every lane in a ZoneGraph storage, so a lane segment can be found & initialized
+ * for any distance along a lane in constant time, rather than stepping through the lane's points from its start.
+ * Built alongside the storage's traffic lane data. @see FMassTrafficZoneGraphData::LaneSegmentTable
+ *
+ * Each lane is divided into as many equal length buckets as it has segments, each storing the first point at or beyond
+ * the bucket's start, so finding the segment for a distance only steps over the (usually zero or one) points within a
+ * bucket. Cubic Bezier control points are precomputed for every segment. Segments found through the table are
+ * identical to those found by stepping through the lane's points.
+ */
+struct MASSTRAFFIC_API FMassTrafficLaneSegmentTable
+{
+	/** Builds the table for ZoneGraphStorage. Defined in MassTrafficInterpolation.cpp, along with its use. */
+	void Build(const FZoneGraphStorage& ZoneGraphStorage);
+
+	void Reset()
+	{
+		LaneBucketsBegin.Reset();
+		LaneInvBucketLengths.Reset();
+		BucketEndPointIndices.Reset();
+		SegmentStartControlPoints.Reset();
+		SegmentEndControlPoints.Reset();
+		NumLanes = 0;
+		NumPoints = 0;
+	}
+
+	FORCEINLINE bool IsBuilt() const
+	{
+		return !LaneBucketsBegin.IsEmpty();
+	}
+
+	/** @return Index of the first point beyond DistanceAlongLane, clamped to the lane's second & last points. */
+	int32 FindSegmentEndPointIndex(const FZoneGraphStorage& ZoneGraphStorage, int32 LaneIndex, float DistanceAlongLane) const;
+
+	/** Per lane, index of its first bucket in BucketEndPointIndices. */
+	TArray<int32> LaneBucketsBegin;
+
+	/** Per lane, 1 / the length of its buckets. */
+	TArray<float> LaneInvBucketLengths;
+
+	/** Per bucket, index of the first point at or beyond the start of the bucket. */
+	TArray<int32> BucketEndPointIndices;
+
+	/** Per point, control points for the segment starting at that point. (Unused for the last point of each lane.) */
+	TArray<FVector> SegmentStartControlPoints;
+	TArray<FVector> SegmentEndControlPoints;
+
+	int32 NumLanes = 0;
+	int32 NumPoints = 0;
+};
+
 /**
  * Container for the traffic lane data associated to a specific registered ZoneGraph data.
  */
@@ -558,19 +732,27 @@ struct MASSTRAFFIC_API FMassTrafficZoneGraphData
 	void Reset()
 	{
 		DataHandle.Reset();
+		SourceKey = 0;
 		TrafficLaneDataArray.Reset();
 		TrafficLaneDataLookup.Reset();
+		LaneSegmentTable.Reset();
 	}
 
 	/* Handle of the storage the data was initialized from. */
 	FZoneGraphDataHandle DataHandle;
 
+	/* Key of the storage & lane settings the data was built from. @see UE::MassTraffic::GetLaneDataCacheKey */
+	uint32 SourceKey = 0;
+
 	/* Runtime data for traffic lanes */ 
 	TArray<FZoneGraphTrafficLaneData> TrafficLaneDataArray;
 
 	/* ZoneGraph lane index -> TrafficLaneDataArray entry. Array size matches ZoneGraph storage */   
 	TArray<FZoneGraphTrafficLaneData*> TrafficLaneDataLookup;
 
+	/* Interpolation data for all the storage's lanes, built along with the lane data (but not cached, as it's quick to build) */
+	FMassTrafficLaneSegmentTable LaneSegmentTable;
+
 	FORCEINLINE const FZoneGraphTrafficLaneData* GetTrafficLaneData(const FZoneGraphLaneHandle LaneHandle) const
 	{
 		return TrafficLaneDataLookup[LaneHandle.Index];
@@ -590,4 +772,92 @@ struct MASSTRAFFIC_API FMassTrafficZoneGraphData
 	{
 		return TrafficLaneDataLookup[LaneIndex];
 	}
+
+	/** Rebuilds every lane's NextLaneRoutes, once all the links between lanes are set. */
+	void BuildNextLaneRoutes()
+	{
+		for (FZoneGraphTrafficLaneData& TrafficLaneData : TrafficLaneDataArray)
+		{
+			TrafficLaneData.BuildNextLaneRoutes();
+		}
+	}
+};
+
+
+/**
+ * Fixed timestep simulation clock. (See UMassTrafficSettings::bFixedTimestep.)
+ *
+ * Accumulates frame time and converts it into whole FixedDeltaTime substeps to simulate this frame. Visualization
+ * interpolates between the vehicle transforms from before & after this frame's substeps using InterpolationAlpha, so
+ * what's rendered lags the simulation by up to one substep but moves smoothly at any frame rate.
+ */
+struct MASSTRAFFIC_API FMassTrafficSimulationClock
+{
+	/** Advances the clock by FrameDeltaTime, updating NumSubsteps & InterpolationAlpha. */
+	void Advance(const float FrameDeltaTime, const float InFixedDeltaTime, const int32 MaxSubsteps);
+
+	/** Resets the clock for variable timestep simulation, where every frame is a single step of FrameDeltaTime. */
+	void AdvanceVariable(const float FrameDeltaTime);
+
+	/** @return Number of steps an entity of LOD should take to integrate DeltaTime. */
+	int32 GetNumSteps(const float DeltaTime, const EMassLOD::Type LOD, const EMassLOD::Type MaxSubstepLOD) const;
+
+	/** @return The total simulation time to advance this frame. */
+	FORCEINLINE float GetDeltaTime() const
+	{
+		return bFixedTimestep ? NumSubsteps * FixedDeltaTime : VariableDeltaTime;
+	}
+
+	/** @return true if there's nothing to simulate this frame. */
+	FORCEINLINE bool IsPaused() const
+	{
+		return bFixedTimestep && NumSubsteps == 0;
+	}
+
+	/** @return The step transforms should be captured at for this frame's visualization to interpolate from. */
+	FORCEINLINE int64 GetInterpolationStartStep() const
+	{
+		return StepIndex - NumInterpolatedSubsteps;
+	}
+
+	/**
+	 * @return SimulatedTransform blended back towards PreviousTransform for visualization, if PreviousTransform was
+	 * captured at GetInterpolationStartStep().
+	 */
+	FTransform GetInterpolatedTransform(const FTransform& PreviousTransform, const int64 PreviousTransformStep, const FTransform& SimulatedTransform) const
+	{
+		if (!bFixedTimestep || InterpolationAlpha >= 1.0f || PreviousTransformStep != GetInterpolationStartStep())
+		{
+			return SimulatedTransform;
+		}
+
+		FTransform InterpolatedTransform;
+		InterpolatedTransform.Blend(PreviousTransform, SimulatedTransform, InterpolationAlpha);
+		return InterpolatedTransform;
+	}
+
+	bool bFixedTimestep = false;
+
+	// Total simulated time
+	double SimulationTime = 0.0;
+
+	// Total number of fixed timestep substeps simulated
+	int64 StepIndex = 0;
+
+	float FixedDeltaTime = 1.0f / 60.0f;
+
+	// Leftover frame time not yet simulated, always < FixedDeltaTime
+	float Accumulator = 0.0f;
+
+	// Number of FixedDeltaTime substeps to simulate this frame
+	int32 NumSubsteps = 0;
+
+	// Number of substeps simulated on the last frame that had any. Visualization interpolates across these.
+	int32 NumInterpolatedSubsteps = 1;
+
+	// Blend from the pre-substep transforms (0) to the current simulated transforms (1)
+	float InterpolationAlpha = 1.0f;
+
+private:
+	float VariableDeltaTime = 0.0f;
 };
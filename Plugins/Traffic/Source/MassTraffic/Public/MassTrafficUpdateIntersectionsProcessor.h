@@ -18,5 +18,32 @@ protected:
 	virtual void ConfigureQueries() override;
 	virtual void Execute(FMassEntityManager& EntityManager, FMassExecutionContext& Context) override;
 
+	/** Intersection waiting for its period deadline, i.e: the time it has to prepare to stop. See all INTERSECTIONDEADLINE. */
+	struct FWaitingIntersection
+	{
+		FMassEntityHandle Entity;
+
+		/** Counted down here, exactly as FMassTrafficIntersectionFragment::PeriodTimeRemaining would be, while waiting. */
+		FFloat16 PeriodTimeRemaining = 0.0f;
+	};
+
+	/** Intersection to fully update this frame. */
+	struct FIntersectionUpdate
+	{
+		FMassEntityHandle Entity;
+		struct FMassTrafficIntersectionFragment* IntersectionFragment = nullptr;
+#if WITH_MASSTRAFFIC_DEBUG
+		const struct FTransformFragment* TransformFragment = nullptr;
+		const FMassRepresentationLODFragment* RepresentationLODFragment = nullptr;
+#endif
+		bool bPeriodHasAnyOpenCrosswalkLanes = false;
+	};
+
 	FMassEntityQuery EntityQuery;
+
+	/** The intersections tagged with FMassTrafficIntersectionWaitingForPeriodDeadlineTag. */
+	TArray<FWaitingIntersection> WaitingIntersections;
+
+	/** Intersections to update this frame, kept to reuse its allocation. */
+	TArray<FIntersectionUpdate> IntersectionUpdates;
 };
@@ -123,6 +123,24 @@ MASSTRAFFIC_API bool PointIsNearSegment(
 	const float MaxDistance);
 
 
+/**
+ * Obstacle locations, hashed by location so that finding whether a point is near any of them only tests the obstacles
+ * in neighboring cells, rather than every obstacle.
+ */
+struct MASSTRAFFIC_API FObstacleExclusionGrid
+{
+	FObstacleExclusionGrid(TConstArrayView<FVector> InObstacleLocations, const float InExclusionRadius);
+
+	/** @return true if Location is closer than the exclusion radius to any obstacle. */
+	bool IsNearObstacle(const FVector& Location) const;
+
+private:
+	TArray<FVector> ObstacleLocations;
+	FMassTrafficBasicHGrid Grid;
+	float ExclusionRadius = 0.0f;
+};
+
+
 /** Get the interpolated speed limit in cm/s at DistanceAlongLane */
 FORCEINLINE float GetSpeedLimitAlongLane(const float Length, const float SpeedLimit, const float MinNextLaneSpeedLimit, const float DistanceAlongLane, const float CurrentSpeed, const float TimeToBlendFromLaneEnd = 2.0f)
 {
@@ -30,6 +30,12 @@ protected:
 private:
 	FMassEntityQuery EntityQuery_Conditional;
 
+	/** Rotates which lanes are validated, when only a sample are each frame. @see FMassTrafficValidationChunkFragment for vehicles */
+	uint32 ValidationFrame = 0;
+
+	/** Guards visual logging from lanes & chunks validated in parallel. */
+	FCriticalSection VisLogCriticalSection;
+
 	// Density debugging
 	bool bInitDensityDebug = true;
 	TArray<float> Densities;
@@ -4,6 +4,7 @@
 
 #include "MassTrafficProcessorBase.h"
 #include "MassTrafficFragments.h"
+#include "MassTrafficLaneReservations.h"
 #include "MassActorSubsystem.h"
 #include "MassTrafficVehicleControlProcessor.generated.h"
 
@@ -20,28 +21,56 @@ protected:
 	virtual void ConfigureQueries() override;
 	virtual void Execute(FMassEntityManager& EntitySubSystem, FMassExecutionContext& Context) override;
 	
-	void SimpleVehicleControl(
+	/**
+	 * Advances a simple vehicle by one step of DeltaTime.
+	 *
+	 * With Reservations, the vehicle only reads shared lane state & other vehicles, recording its changes to them into
+	 * Reservations instead. LaneLocationFragment should then be a copy of the vehicle's fragment, so other vehicles keep
+	 * seeing where it was at the start of the chunk loop, and reaching the end of the lane is returned rather than
+	 * moving the vehicle onto its next lane. Without Reservations, all changes are made immediately.
+	 *
+	 * @param bCantStopAtLaneExit The vehicle's current bCantStopAtLaneExit, which with Reservations isn't written to
+	 * VehicleControlFragment until they're applied. (See all CANTSTOPLANEEXIT.)
+	 * @return true if the vehicle has reached the end of its lane, and needs to be moved onto its next lane.
+	 */
+	bool SimpleVehicleControl(
 		FMassEntityManager& EntityManager,
 		UMassTrafficSubsystem& MassTrafficSubsystem,
-		FMassExecutionContext& Context,
-		const int32 EntityIndex,
+		const FMassEntityHandle VehicleEntity,
+		const EMassLOD::Type LOD,
 		const FAgentRadiusFragment& AgentRadiusFragment,
 		const FMassTrafficRandomFractionFragment& RandomFractionFragment,
 		const FTransformFragment& TransformFragment,
-		const struct FMassSimulationVariableTickFragment& VariableTickFragment,
+		const float DeltaTime,
 		FMassTrafficVehicleControlFragment& VehicleControlFragment,
+		bool& bCantStopAtLaneExit,
 		FMassTrafficVehicleLightsFragment& VehicleLightsFragment,
 		FMassZoneGraphLaneLocationFragment& LaneLocationFragment,
 		FMassTrafficLaneOffsetFragment& LaneOffsetFragment,
 		FMassTrafficObstacleAvoidanceFragment& AvoidanceFragment,
 		FMassTrafficVehicleLaneChangeFragment* LaneChangeFragment,
-		const FMassTrafficNextVehicleFragment& NextVehicleFragment, const bool bVisLog = false) const;
+		FMassTrafficNextVehicleFragment& NextVehicleFragment,
+		FMassTrafficLaneReservationBuffer* Reservations,
+		const bool bVisLog = false) const;
+
+	/**
+	 * Moves a simple vehicle that reached the end of its lane during the chunk loop onto its next lane, then advances
+	 * it by its NumRemainingSteps of StepDeltaTime.
+	 */
+	void MoveSimpleVehicleToNextLane(
+		FMassEntityManager& EntityManager,
+		UMassTrafficSubsystem& MassTrafficSubsystem,
+		const FMassEntityHandle VehicleEntity,
+		const EMassLOD::Type LOD,
+		const int32 NumRemainingSteps,
+		const float StepDeltaTime) const;
 
 	void PIDVehicleControl(
 		const FMassEntityManager& EntityManager,
-		const FMassExecutionContext& Context,
-		const int32 EntityIndex,
+		const FMassEntityHandle VehicleEntity,
+		const EMassLOD::Type LOD,
 		const FZoneGraphStorage& ZoneGraphStorage,
+		const struct FMassTrafficLaneSegmentTable* LaneSegmentTable,
 		const FMassTrafficObstacleAvoidanceFragment& AvoidanceFragment,
 		const FAgentRadiusFragment& AgentRadiusFragment,
 		const FMassTrafficRandomFractionFragment& RandomFractionFragment,
@@ -58,4 +87,6 @@ protected:
 
 	FMassEntityQuery SimpleVehicleControlEntityQuery_Conditional;
 	FMassEntityQuery PIDVehicleControlEntityQuery_Conditional;
+
+	FMassTrafficLaneReservations LaneReservations;
 };
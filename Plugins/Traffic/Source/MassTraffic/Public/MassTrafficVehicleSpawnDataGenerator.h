@@ -64,12 +64,29 @@ public:
 	UPROPERTY(BlueprintReadWrite, EditAnywhere)
 	float ObstacleExclusionRadius = 5000.0f;
 
+	/**
+	 * Cache generated lane spawn points on disk, keyed on the ZoneGraph data, seed & spacing settings, so repeated
+	 * generation on unchanged ZoneGraph data skips straight to filtering & shuffling them. Only applies when seeded,
+	 * either by RandomSeed or UMassTrafficSettings::RandomSeed.
+	 */
+	UPROPERTY(BlueprintReadWrite, EditAnywhere)
+	bool bCacheSpawnPoints = true;
+
 	/** Generate "Count" number of SpawnPoints and return as a list of position
 	 * @param Count of point to generate
 	 * @param FinishedGeneratingSpawnPointsDelegate is the callback to call once the generation is done
 	 */
 	virtual void Generate(UObject& QueryOwner, TConstArrayView<FMassSpawnedEntityType> EntityTypes, int32 Count, FFinishedGeneratingSpawnDataSignature& FinishedGeneratingSpawnPointsDelegate) const override;
 
+	/**
+	 * Finds non-overlapping spawn points along all the lanes passing LaneFilter, for each of Spacings.
+	 *
+	 * Lanes are processed in parallel, each with its own random substream seeded from RandomStream's current seed &
+	 * the lane index, so the same ZoneGraph data, seed & settings always produce the same points regardless of thread
+	 * scheduling. RandomStream itself is only advanced when shuffling the points.
+	 *
+	 * LaneFilterFunction & LaneLocationFilterFunction are called from worker threads, so must be thread safe.
+	 */
 	static bool FindNonOverlappingLanePoints(
 		const FZoneGraphStorage& ZoneGraphStorage,
 		const FZoneGraphTagFilter& LaneFilter,
@@ -3,6 +3,7 @@
 #pragma once
 
 #include "MassRepresentationProcessor.h"
+#include "MassTrafficActorUpdateBatch.h"
 #include "MassTrafficFragments.h"
 
 #include "MassTrafficVehicleVisualizationProcessor.generated.h"
@@ -112,7 +113,8 @@ public:
 };
 
 /**
- * Custom visualization updates for TrafficVehicle
+ * Custom visualization updates for TrafficVehicle. Instanced vehicles are bucketed into cells (see
+ * FMassTrafficMovingInstances) unless MassTraffic.StaticInstances is off.
  */
  UCLASS()
 class MASSTRAFFIC_API UMassTrafficVehicleUpdateCustomVisualizationProcessor : public UMassProcessor
@@ -130,6 +132,8 @@ protected:
 
 	FMassEntityQuery EntityQuery;
 
+	FMassTrafficActorUpdateBatch ActorUpdateBatch;
+
 #if WITH_MASSTRAFFIC_DEBUG
 	FMassEntityQuery DebugEntityQuery;
 	TWeakObjectPtr<UObject> LogOwner;
@@ -4,12 +4,16 @@
 #include "MassTrafficZoneGraphDataModifier.h"
 
 #include "MassTrafficEditor.h"
+#include "MassTrafficSettings.h"
 #include "WorldPartition/WorldPartition.h"
 #include "Misc/ScopedSlowTask.h"
 #include "DrawDebugHelpers.h"
 #include "ZoneGraphSubsystem.h"
 #include "Spatial/PointHashGrid3.h"
 #include "Engine/World.h"
+#include "Async/ParallelFor.h"
+#include "Components/StaticMeshComponent.h"
+#include "HAL/FileManager.h"
 
 static const float BigZ = 1000000.0f;
 
@@ -90,40 +94,172 @@ void AMassTrafficZoneGraphDataModifier::SnapZoneGraphDataToGround()
 	{
 		FZoneGraphStorage& ZoneGraphStorage = ZoneGraphData->GetStorageMutable();
 
-		FScopedSlowTask SlowTask(ZoneGraphStorage.Lanes.Num(), NSLOCTEXT("MassTraffic", "SnapZoneGraphDataToGround",
-			"Snapping Zone Graph lane points to geometry..."));
-		SlowTask.MakeDialog(true);
-
 		FZoneGraphTagFilter ZoneGraphTagFilter;
 		{
 			ZoneGraphTagFilter.AnyTags = GroundSnapIncludeTags;
 			ZoneGraphTagFilter.NotTags = GroundSnapExcludeTags;
 		}
 
-		int32 MissCount = 0;
-		for (const FZoneLaneData& ZoneLaneData : ZoneGraphStorage.Lanes)
+		// Gather all the points to snap.
+		TArray<int32> PointIndices;
+		TArray<int32> PointLaneIndices;
+		for (int32 LaneIndex = 0; LaneIndex < ZoneGraphStorage.Lanes.Num(); LaneIndex++)
 		{
-			SlowTask.EnterProgressFrame();
-			if (SlowTask.ShouldCancel())
+			const FZoneLaneData& ZoneLaneData = ZoneGraphStorage.Lanes[LaneIndex];
+			if (ZoneGraphTagFilter.Pass(ZoneLaneData.Tags))
 			{
-				break;
+				for (int32 PointIndex = ZoneLaneData.PointsBegin; PointIndex < ZoneLaneData.PointsEnd; PointIndex++)
+				{
+					PointIndices.Add(PointIndex);
+					PointLaneIndices.Add(LaneIndex);
+				}
 			}
+		}
 
-			if (ZoneGraphTagFilter.Pass(ZoneLaneData.Tags))
+		// Load traces from previous snaps of this Zone Graph data, unless they're already loaded.
+		const uint32 SettingsHash = GetGroundSnapSettingsHash();
+		const FString CacheFilename = UE::MassTraffic::GetGroundSnapCacheFilename(*GetDefault<UMassTrafficSettings>(), ZoneGraphData->GetPathName());
+		if (bGroundSnapUseCache && (SettingsHash != GroundSnapCacheSettingsHash || CacheFilename != GroundSnapCacheFilename))
+		{
+			UE::MassTraffic::LoadGroundSnapCache(CacheFilename, SettingsHash, GroundSnapCache);
+			GroundSnapCacheSettingsHash = SettingsHash;
+			GroundSnapCacheFilename = CacheFilename;
+		}
+
+		// Points are traced from where they were before snapping, which for points that have already been snapped by a
+		// cached trace is the point that trace was made from. This way re-snapping without rebuilding the Zone Graph
+		// first still finds its cached traces, and gives the same results as snapping freshly built points.
+		TArray<FVector> SourcePoints;
+		SourcePoints.SetNumUninitialized(PointIndices.Num());
+		for (int32 RequestIndex = 0; RequestIndex < PointIndices.Num(); RequestIndex++)
+		{
+			const FVector& LanePoint = ZoneGraphStorage.LanePoints[PointIndices[RequestIndex]];
+			const UE::MassTraffic::FGroundSnapCacheEntry* CacheEntry = bGroundSnapUseCache ? GroundSnapCache.Find(FIntPoint(PointLaneIndices[RequestIndex], PointIndices[RequestIndex])) : nullptr;
+			SourcePoints[RequestIndex] = CacheEntry && CacheEntry->SnappedPoint == LanePoint ? CacheEntry->SourcePoint : LanePoint;
+		}
+
+		TArray<FGroundSnapTrace> Traces;
+		Traces.SetNum(PointIndices.Num());
+
+		// Indices into PointIndices, for the points that need tracing.
+		TArray<int32> TraceIndices;
+		TraceIndices.Reserve(PointIndices.Num());
+
+		// Reuse cached traces for points whose source location, and surrounding geometry, haven't changed.
+		TArray<uint32> PointGeometryHashes;
+		if (bGroundSnapUseCache && GroundSnapCacheCellSize > 0.0f)
+		{
+			TMap<FIntVector, int32> CellIndices;
+			TArray<FIntVector> Cells;
+			TArray<int32> PointCellIndices;
+			PointCellIndices.SetNumUninitialized(PointIndices.Num());
+			for (int32 RequestIndex = 0; RequestIndex < PointIndices.Num(); RequestIndex++)
 			{
-				for (int32 PointIndex = ZoneLaneData.PointsBegin; PointIndex < ZoneLaneData.PointsEnd; PointIndex++)
+				const FVector& SourcePoint = SourcePoints[RequestIndex];
+				const FIntVector Cell(
+					FMath::FloorToInt(SourcePoint.X / GroundSnapCacheCellSize),
+					FMath::FloorToInt(SourcePoint.Y / GroundSnapCacheCellSize),
+					FMath::FloorToInt(SourcePoint.Z / GroundSnapCacheCellSize));
+				int32* CellIndex = CellIndices.Find(Cell);
+				PointCellIndices[RequestIndex] = CellIndex ? *CellIndex : CellIndices.Add(Cell, Cells.Add(Cell));
+			}
+
+			TArray<uint32> CellGeometryHashes;
+			CellGeometryHashes.SetNumUninitialized(Cells.Num());
+			ParallelFor(Cells.Num(), [&](int32 CellIndex)
+			{
+				CellGeometryHashes[CellIndex] = GetGroundSnapGeometryHash(World, Cells[CellIndex]);
+			}, /*bForceSingleThread*/!bGroundSnapParallel);
+
+			PointGeometryHashes.SetNumUninitialized(PointIndices.Num());
+			for (int32 RequestIndex = 0; RequestIndex < PointIndices.Num(); RequestIndex++)
+			{
+				const uint32 GeometryHash = CellGeometryHashes[PointCellIndices[RequestIndex]];
+				PointGeometryHashes[RequestIndex] = GeometryHash;
+
+				const UE::MassTraffic::FGroundSnapCacheEntry* CacheEntry = GroundSnapCache.Find(FIntPoint(PointLaneIndices[RequestIndex], PointIndices[RequestIndex]));
+				if (CacheEntry && CacheEntry->SourcePoint == SourcePoints[RequestIndex] && CacheEntry->GeometryHash == GeometryHash)
 				{
-					FVector& LanePoint = ZoneGraphStorage.LanePoints[PointIndex];
-					FVector& LaneUpVector = ZoneGraphStorage.LaneUpVectors[PointIndex];
-					FVector& LaneTangentVector = ZoneGraphStorage.LaneTangentVectors[PointIndex];
-					const bool bHit = SnapPointToGround(World, LanePoint, LaneUpVector, LaneTangentVector);
-					if (!bHit)
-					{
-						++MissCount;
-					}
+					Traces[RequestIndex].bHit = CacheEntry->bHit;
+					Traces[RequestIndex].ImpactPoint = CacheEntry->ImpactPoint;
+					Traces[RequestIndex].ImpactNormal = CacheEntry->ImpactNormal;
+				}
+				else
+				{
+					TraceIndices.Add(RequestIndex);
 				}
 			}
 		}
+		else
+		{
+			for (int32 RequestIndex = 0; RequestIndex < PointIndices.Num(); RequestIndex++)
+			{
+				TraceIndices.Add(RequestIndex);
+			}
+		}
+
+		// Trace the remaining points in batches, so progress can be shown and cancelled in between.
+		{
+			FScopedSlowTask SlowTask(TraceIndices.Num(), NSLOCTEXT("MassTraffic", "SnapZoneGraphDataToGround",
+				"Snapping Zone Graph lane points to geometry..."));
+			SlowTask.MakeDialog(true);
+
+			const int32 BatchSize = FMath::Max(GroundSnapBatchSize, 1);
+			for (int32 BatchBegin = 0; BatchBegin < TraceIndices.Num(); BatchBegin += BatchSize)
+			{
+				const int32 BatchEnd = FMath::Min(BatchBegin + BatchSize, TraceIndices.Num());
+
+				SlowTask.EnterProgressFrame(BatchEnd - BatchBegin);
+				if (SlowTask.ShouldCancel())
+				{
+					// Nothing has been written back yet, so the Zone Graph is left as it was.
+					UE_LOG(LogMassTrafficEditor, Warning, TEXT("%s - Cancelled. No Zone Graph points were snapped."), ANSI_TO_TCHAR(__FUNCTION__));
+					return;
+				}
+
+				ParallelFor(BatchEnd - BatchBegin, [&](int32 BatchIndex)
+				{
+					const int32 RequestIndex = TraceIndices[BatchBegin + BatchIndex];
+					Traces[RequestIndex] = TracePointToGround(World, SourcePoints[RequestIndex]);
+				}, /*bForceSingleThread*/!bGroundSnapParallel);
+			}
+		}
+
+		// Write all the results back, remembering each trace along with the point it snapped.
+		int32 MissCount = 0;
+		for (int32 RequestIndex = 0; RequestIndex < PointIndices.Num(); RequestIndex++)
+		{
+			const int32 PointIndex = PointIndices[RequestIndex];
+			FVector& LanePoint = ZoneGraphStorage.LanePoints[PointIndex];
+			FVector& LaneUpVector = ZoneGraphStorage.LaneUpVectors[PointIndex];
+			const FVector& LaneTangentVector = ZoneGraphStorage.LaneTangentVectors[PointIndex];
+			const FGroundSnapTrace& Trace = Traces[RequestIndex];
+			LanePoint = SourcePoints[RequestIndex];
+			ApplyGroundSnapTrace(World, Trace, LanePoint, LaneUpVector, LaneTangentVector);
+			if (!Trace.bHit)
+			{
+				++MissCount;
+			}
+
+			if (!PointGeometryHashes.IsEmpty())
+			{
+				UE::MassTraffic::FGroundSnapCacheEntry& CacheEntry = GroundSnapCache.FindOrAdd(FIntPoint(PointLaneIndices[RequestIndex], PointIndex));
+				CacheEntry.SourcePoint = SourcePoints[RequestIndex];
+				CacheEntry.SnappedPoint = LanePoint;
+				CacheEntry.ImpactPoint = Trace.ImpactPoint;
+				CacheEntry.ImpactNormal = Trace.ImpactNormal;
+				CacheEntry.GeometryHash = PointGeometryHashes[RequestIndex];
+				CacheEntry.bHit = Trace.bHit;
+			}
+		}
+
+		if (!PointGeometryHashes.IsEmpty())
+		{
+			UE::MassTraffic::SaveGroundSnapCache(GroundSnapCacheFilename, GroundSnapCacheSettingsHash, GroundSnapCache);
+		}
+
+		UE_LOG(LogMassTrafficEditor, Display, TEXT("%s - Traced %d of %d Zone Graph points, the rest were unchanged since the last snap."),
+			ANSI_TO_TCHAR(__FUNCTION__), TraceIndices.Num(), PointIndices.Num());
 
 		if (MissCount > 0)
 		{
@@ -145,38 +281,66 @@ void AMassTrafficZoneGraphDataModifier::SnapZoneGraphDataToGround()
 }
 
 
-bool AMassTrafficZoneGraphDataModifier::SnapPointToGround(UWorld* World, FVector& Point, FVector& UpVector, FVector& TangentVector)
+void AMassTrafficZoneGraphDataModifier::ClearGroundSnapCache()
+{
+	GroundSnapCache.Empty();
+	GroundSnapCacheSettingsHash = 0;
+	GroundSnapCacheFilename.Reset();
+
+	if (ZoneGraphData)
+	{
+		IFileManager::Get().Delete(*UE::MassTraffic::GetGroundSnapCacheFilename(*GetDefault<UMassTrafficSettings>(), ZoneGraphData->GetPathName()), false, false, true);
+	}
+}
+
+
+AMassTrafficZoneGraphDataModifier::FGroundSnapTrace AMassTrafficZoneGraphDataModifier::TracePointToGround(const UWorld* World, const FVector& Point) const
 {
 	const FVector TraceStart(Point.X, Point.Y, Point.Z + TraceStartZOffset);
 	const FVector TraceEnd(Point.X, Point.Y, Point.Z + TraceEndZOffset);
 	FHitResult TraceHitResult;
-	bool bHit = false;
+	FGroundSnapTrace Trace;
 	if (TraceType == EMassTrafficZoneGraphModifierTraceType::Line)
 	{
-		bHit = World->LineTraceSingleByChannel(TraceHitResult, TraceStart, TraceEnd, GroundSnapTraceCollisionChannel, CollisionQueryParams);
+		Trace.bHit = World->LineTraceSingleByChannel(TraceHitResult, TraceStart, TraceEnd, GroundSnapTraceCollisionChannel, CollisionQueryParams);
 	}
 	else if (TraceType == EMassTrafficZoneGraphModifierTraceType::Sphere)
 	{
-		bHit = World->SweepSingleByChannel(TraceHitResult, TraceStart, TraceEnd, FQuat::Identity,
+		Trace.bHit = World->SweepSingleByChannel(TraceHitResult, TraceStart, TraceEnd, FQuat::Identity,
 			GroundSnapTraceCollisionChannel, CollisionShape, CollisionQueryParams);
 	}
 
+	if (Trace.bHit)
+	{
+		Trace.ImpactPoint = TraceHitResult.ImpactPoint;
+		Trace.ImpactNormal = TraceHitResult.ImpactNormal;
+	}
+
+	return Trace;
+}
+
+
+void AMassTrafficZoneGraphDataModifier::ApplyGroundSnapTrace(UWorld* World, const FGroundSnapTrace& Trace, FVector& Point, FVector& UpVector, const FVector& TangentVector) const
+{
+	const FVector TraceStart(Point.X, Point.Y, Point.Z + TraceStartZOffset);
+	const FVector TraceEnd(Point.X, Point.Y, Point.Z + TraceEndZOffset);
+
 	if (bTraceDebugDrawTrace)
 	{
 		DrawDebugLine(World, TraceStart, TraceEnd, FColor::Silver, false, DebugLifetime, 0, 0.5f * DebugThickness);
 	}
 
-	if (bHit)
+	if (Trace.bHit)
 	{
 		const FVector PointOrig = Point;
 		
 		if (bSnapPointZ)
 		{
-			Point.Z = TraceHitResult.ImpactPoint.Z + /*optional*/TraceFinalZOffset;
+			Point.Z = Trace.ImpactPoint.Z + /*optional*/TraceFinalZOffset;
 		}
 		if (bSnapPointUpVector)
 		{
-			UpVector = TraceHitResult.ImpactNormal;
+			UpVector = Trace.ImpactNormal;
 			if (bForceUpVectorPositiveZ && UpVector.Z < 0.0f)
 			{
 				UpVector *= -1.0f;
@@ -190,15 +354,13 @@ bool AMassTrafficZoneGraphDataModifier::SnapPointToGround(UWorld* World, FVector
 		{
 			DrawDebugDirectionalArrow(World, PointOrig, Point, 10.0f * DebugThickness, FColor::Green, false, DebugLifetime, 0, DebugThickness);
 
-			DrawDebugLine(World, TraceHitResult.ImpactPoint, Point, FColor::Cyan, false, DebugLifetime, 0, DebugThickness / 2.0f);
+			DrawDebugLine(World, Trace.ImpactPoint, Point, FColor::Cyan, false, DebugLifetime, 0, DebugThickness / 2.0f);
 
 			if (bSnapPointUpVector)
 			{
 				DrawDebugDirectionalArrow(World, Point, Point + UpVector * DebugUpVectorScale, 5.0f * DebugThickness, FColor::Yellow, false, DebugLifetime, 0, DebugThickness);
 			}
 		}
-	
-		return true;
 	}
 	else
 	{
@@ -215,9 +377,58 @@ bool AMassTrafficZoneGraphDataModifier::SnapPointToGround(UWorld* World, FVector
 			const FVector TraceDebugEnd(TraceEnd.X, TraceEnd.Y, TraceEndZOffset > 0.0f ? BigZ : -BigZ);	
 			DrawDebugLine(World, TraceDebugEnd, TraceEnd, FColor::Yellow, false, DebugLifetime, 0, DebugThickness);
 		}
+	}
+}
+
+
+uint32 AMassTrafficZoneGraphDataModifier::GetGroundSnapSettingsHash() const
+{
+	uint32 Hash = GetTypeHash(static_cast<uint8>(TraceType));
+	Hash = HashCombine(Hash, GetTypeHash(TraceSphereRadius));
+	Hash = HashCombine(Hash, GetTypeHash(TraceStartZOffset));
+	Hash = HashCombine(Hash, GetTypeHash(TraceEndZOffset));
+	Hash = HashCombine(Hash, GetTypeHash(static_cast<uint8>(GroundSnapTraceComplex)));
+	Hash = HashCombine(Hash, GetTypeHash(static_cast<uint8>(GroundSnapTraceCollisionChannel)));
+	Hash = HashCombine(Hash, GetTypeHash(GroundSnapCacheCellSize));
+	return Hash;
+}
+
 
-		return false;
+uint32 AMassTrafficZoneGraphDataModifier::GetGroundSnapGeometryHash(const UWorld* World, const FIntVector& Cell) const
+{
+	// Grow the cell by as far as traces from points inside it can reach.
+	const float TraceRadius = TraceType == EMassTrafficZoneGraphModifierTraceType::Sphere ? TraceSphereRadius : 0.0f;
+	const float TraceReachZ = FMath::Max(FMath::Abs(TraceStartZOffset), FMath::Abs(TraceEndZOffset));
+	const FVector CellCenter = (FVector(Cell) + 0.5f) * GroundSnapCacheCellSize;
+	const FVector OverlapExtent = FVector(0.5f * GroundSnapCacheCellSize) + FVector(TraceRadius, TraceRadius, TraceRadius + TraceReachZ);
+
+	TArray<FOverlapResult> Overlaps;
+	World->OverlapMultiByChannel(Overlaps, CellCenter, FQuat::Identity, GroundSnapTraceCollisionChannel, FCollisionShape::MakeBox(OverlapExtent), CollisionQueryParams);
+
+	TArray<uint32, TInlineAllocator<64>> ComponentHashes;
+	for (const FOverlapResult& Overlap : Overlaps)
+	{
+		const UPrimitiveComponent* Component = Overlap.GetComponent();
+		if (!Component)
+		{
+			continue;
+		}
+
+		const FMatrix ComponentMatrix = Component->GetComponentTransform().ToMatrixWithScale();
+		// Hashed by path rather than pointer, so the hash is stable across editor sessions.
+		uint32 ComponentHash = FCrc::MemCrc32(&ComponentMatrix.M, sizeof(ComponentMatrix.M), GetTypeHash(Component->GetPathName()));
+		ComponentHash = HashCombine(ComponentHash, GetTypeHash(Component->Bounds.Origin));
+		ComponentHash = HashCombine(ComponentHash, GetTypeHash(Component->Bounds.BoxExtent));
+		if (const UStaticMeshComponent* StaticMeshComponent = Cast<UStaticMeshComponent>(Component))
+		{
+			ComponentHash = HashCombine(ComponentHash, GetTypeHash(GetPathNameSafe(StaticMeshComponent->GetStaticMesh())));
+		}
+		ComponentHashes.Add(ComponentHash);
 	}
+
+	// Overlaps aren't returned in any particular order.
+	ComponentHashes.Sort();
+	return FCrc::MemCrc32(ComponentHashes.GetData(), ComponentHashes.Num() * sizeof(uint32));
 }
 
 
@@ -3,6 +3,7 @@
 
 #include "CollisionShape.h"
 #include "CollisionQueryParams.h"
+#include "MassTrafficLaneDataCache.h"
 #include "ZoneGraphData.h"
 #include "EditorUtilityActor.h"
 #include "ZoneGraphTypes.h"
@@ -82,11 +83,39 @@ public:
 
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Snap to Ground")
 	TEnumAsByte<ECollisionChannel> GroundSnapTraceCollisionChannel = ECollisionChannel::ECC_WorldStatic; 
+
+	/**
+	 * Trace lane points across worker threads, GroundSnapBatchSize points at a time.
+	 * Trace debug drawing is still done on the game thread, once each batch is complete.
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Snap to Ground")
+	bool bGroundSnapParallel = true;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Snap to Ground")
+	int32 GroundSnapBatchSize = 8192;
+
+	/**
+	 * Reuse ground traces from previous snaps for lane points whose position, and the collision geometry around them,
+	 * haven't changed. Geometry is compared per GroundSnapCacheCellSize cell, by the transforms and bounds of the
+	 * components found there, so moving anything in a cell retraces all the points in it.
+	 * Traces are saved per ZoneGraph data alongside the traffic lane data cache (see
+	 * UMassTrafficSettings::LaneDataCacheDirectory), so they're reused across editor sessions too.
+	 * Collision edits that don't change a component's transform or bounds (e.g. sculpting landscape) aren't detected -
+	 * use ClearGroundSnapCache after those.
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Snap to Ground")
+	bool bGroundSnapUseCache = true;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Snap to Ground")
+	float GroundSnapCacheCellSize = 5000.0f;
 	
 
 	UFUNCTION(BlueprintCallable, Category="Snap to Ground")
 	void SnapZoneGraphDataToGround();
 
+	UFUNCTION(BlueprintCallable, Category="Snap to Ground")
+	void ClearGroundSnapCache();
+
 	
 	/** Zone Graph Tag to use for Zone Shapes that are for intersections. */
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Tagging")
@@ -135,8 +164,29 @@ private:
 	FCollisionQueryParams CollisionQueryParams;
 	FCollisionShape CollisionShape;
 
-	/** Vectors are input, and modified in place. */
-	bool SnapPointToGround(UWorld* World, FVector& Point, FVector& UpVector, FVector& TangentVector);
+	struct FGroundSnapTrace
+	{
+		bool bHit = false;
+		FVector ImpactPoint = FVector::ZeroVector;
+		FVector ImpactNormal = FVector::UpVector;
+	};
+
+	/** Ground traces loaded from, and saved to, GroundSnapCacheFilename. Only valid for GroundSnapCacheSettingsHash. */
+	UE::MassTraffic::FGroundSnapCache GroundSnapCache;
+	FString GroundSnapCacheFilename;
+	uint32 GroundSnapCacheSettingsHash = 0;
+
+	/** Traces down to the ground below Point. Only reads from the world, so is safe to call from worker threads. */
+	FGroundSnapTrace TracePointToGround(const UWorld* World, const FVector& Point) const;
+
+	/** Applies a ground trace to the point. Vectors are input, and modified in place. */
+	void ApplyGroundSnapTrace(UWorld* World, const FGroundSnapTrace& Trace, FVector& Point, FVector& UpVector, const FVector& TangentVector) const;
+
+	/** Hash of the trace settings, which all cached ground traces depend on. */
+	uint32 GetGroundSnapSettingsHash() const;
+
+	/** Hash of the collision geometry that could affect ground traces for points within Cell. */
+	uint32 GetGroundSnapGeometryHash(const UWorld* World, const FIntVector& Cell) const;
 	
 	bool IsPointNearActorLocation(const FVector& Point) const;
 
@@ -17,6 +17,8 @@ void AClock::BeginPlay()
 	Super::BeginPlay();
 	
 	BeginTime = FPlatformTime::Seconds();
+	SimulationHours = 0.0;
+	SunYaw = Sun ? Sun->GetActorRotation().Yaw : 0.0;
 	
 }
 
@@ -34,11 +36,14 @@ void AClock::Tick(float DeltaTime)
 
 	if (HasChanged)
 	{
-		BeginTime = FPlatformTime::Seconds() - CurrentHours;
+		SetElapsedHours(CurrentHours);
 		HasChanged = false;
 	}
 
-	CurrentTime = FTimespan(FTimespan::FromHours(FPlatformTime::Seconds() - BeginTime));
+	if (UseSimulationTime)
+		SimulationHours += SimulationHoursPerFrame;
+
+	CurrentTime = FTimespan(FTimespan::FromHours(GetElapsedHours()));
 	CurrentDays = CurrentTime.GetDays();
 	CurrentMinutes = CurrentTime.GetMinutes();
 	
@@ -48,9 +53,30 @@ void AClock::Tick(float DeltaTime)
 	{
 		CurrentHours = TmpHours;
 		TmpHours = -1.f;
-		BeginTime = FPlatformTime::Seconds() - CurrentHours;
+		SetElapsedHours(CurrentHours);
 	}
 	CurrentTime = FTimespan(CurrentDays, CurrentHours, CurrentMinutes, 0);
+
+	if (UseSimulationTime && DriveSunRotation && Sun)
+		Sun->SetActorRotation(GetSunRotation());
+}
+
+FRotator AClock::GetSunRotation() const
+{
+	const double DayFraction = FMath::Fmod(CurrentTime.GetTotalHours(), 24.0) / 24.0;
+
+	return FRotator(90.0 - DayFraction * 360.0, SunYaw, 0.0);
+}
+
+double AClock::GetElapsedHours() const
+{
+	return UseSimulationTime ? SimulationHours : FPlatformTime::Seconds() - BeginTime;
+}
+
+void AClock::SetElapsedHours(double Hours)
+{
+	BeginTime = FPlatformTime::Seconds() - Hours;
+	SimulationHours = Hours;
 }
 
 // Called to bind functionality to input
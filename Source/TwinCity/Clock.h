@@ -51,6 +51,18 @@ public:
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Clock")
 	FTimespan			CurrentTime;
 
+	// Advance time by a fixed step every frame rather than with the wall clock, so captures are repeatable whatever the frame rate
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Clock")
+	bool				UseSimulationTime = false;
+
+	// In game hours time advances by every frame, when UseSimulationTime is set
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Clock", meta=(EditCondition="UseSimulationTime"))
+	double				SimulationHoursPerFrame = 1.0 / 60.0;
+
+	// In game hours elapsed since BeginPlay, when UseSimulationTime is set
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category="Clock")
+	double				SimulationHours = 0.0;
+
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Sky")
   	ADirectionalLight	*LightSource;
 
@@ -60,6 +72,24 @@ public:
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Sky")
   	float				TurnRate;
 
+	// Rotate Sun to GetSunRotation() every frame while UseSimulationTime is set, turn off to rotate it some other way.
+	// With the wall clock the sun is left to Blueprints (see TurnRate / LightSource)
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Sky")
+	bool				DriveSunRotation = true;
+
+	// Sun's rotation for CurrentTime - straight down at noon, level at 6 and 18, keeping the heading Sun was placed with
+	UFUNCTION(BlueprintPure, Category="Sky")
+	FRotator			GetSunRotation() const;
+
 	FTimespan TmpTime;
 
+private:
+
+	// Sun's yaw at BeginPlay - read once, as rotations past straight down come back from the actor with yaw flipped
+	double				SunYaw = 0.0;
+
+	// In game hours elapsed, from the wall clock or the simulation time
+	double				GetElapsedHours() const;
+	void				SetElapsedHours(double Hours);
+
 };
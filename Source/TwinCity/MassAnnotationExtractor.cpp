@@ -0,0 +1,203 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "MassAnnotationExtractor.h"
+#include "Async/ParallelFor.h"
+#include "Kismet/GameplayStatics.h"
+#include "MassCommonFragments.h"
+#include "MassCrowdFragments.h"
+#include "MassEntityManager.h"
+#include "MassEntitySubsystem.h"
+#include "MassExecutionContext.h"
+#include "MassTrafficFragments.h"
+
+DECLARE_CYCLE_STAT(TEXT("Extract Mass Annotations"), STAT_ExtractMassAnnotations, STATGROUP_Game);
+
+namespace MassAnnotationExtractor
+{
+    struct FChunk
+    {
+        TConstArrayView<FMassEntityHandle>      Entities;
+        TConstArrayView<FTransformFragment>     TransformFragments;
+        TConstArrayView<FAgentRadiusFragment>   RadiusFragments;
+        bool                                    bIsVehicle = false;
+    };
+
+    static void GatherChunks(FMassEntityQuery &Query, FMassEntityManager &EntityManager, bool bIsVehicle, TArray<FChunk> &OutChunks)
+    {
+        FMassExecutionContext ExecutionContext(EntityManager.AsShared(), 0.f);
+        Query.ForEachEntityChunk(EntityManager, ExecutionContext, [&OutChunks, bIsVehicle](FMassExecutionContext &Context)
+        {
+            FChunk &Chunk = OutChunks.AddDefaulted_GetRef();
+            Chunk.Entities = Context.GetEntities();
+            Chunk.TransformFragments = Context.GetFragmentView<FTransformFragment>();
+            Chunk.RadiusFragments = Context.GetFragmentView<FAgentRadiusFragment>();
+            Chunk.bIsVehicle = bIsVehicle;
+        });
+    }
+
+    /** @return false if the box is entirely behind the camera or off screen. */
+    static bool ProjectBox(FTransform const &Transform, FBox const &LocalBox, FMatrix const &ViewProjectionMatrix, FIntPoint ImageSize, FVector2D &OutMin, FVector2D &OutMax)
+    {
+        OutMin = FVector2D(TNumericLimits<double>::Max());
+        OutMax = FVector2D(TNumericLimits<double>::Lowest());
+
+        bool bAnyInFront = false;
+        for (int32 Corner = 0; Corner < 8; ++Corner)
+        {
+            FVector const LocalCorner((Corner & 1) ? LocalBox.Max.X : LocalBox.Min.X, (Corner & 2) ? LocalBox.Max.Y : LocalBox.Min.Y, (Corner & 4) ? LocalBox.Max.Z : LocalBox.Min.Z);
+            FVector4 const ClipCorner = ViewProjectionMatrix.TransformFVector4(FVector4(Transform.TransformPosition(LocalCorner), 1.f));
+
+            // Corners behind the camera don't project anywhere meaningful, so only the ones in front bound the agent
+            if (ClipCorner.W <= UE_KINDA_SMALL_NUMBER)
+            {
+                continue;
+            }
+            bAnyInFront = true;
+
+            FVector2D const ScreenCorner(
+                (ClipCorner.X / ClipCorner.W * 0.5 + 0.5) * ImageSize.X,
+                (0.5 - ClipCorner.Y / ClipCorner.W * 0.5) * ImageSize.Y);
+            OutMin = FVector2D::Min(OutMin, ScreenCorner);
+            OutMax = FVector2D::Max(OutMax, ScreenCorner);
+        }
+
+        if (!bAnyInFront)
+        {
+            return false;
+        }
+
+        OutMin = FVector2D::Max(OutMin, FVector2D::ZeroVector);
+        OutMax = FVector2D::Min(OutMax, FVector2D(ImageSize));
+        return OutMin.X < OutMax.X && OutMin.Y < OutMax.Y;
+    }
+}
+
+FMassAnnotationExtractor::FMassAnnotationExtractor()
+{
+    VehicleQuery.AddTagRequirement<FMassTrafficVehicleTag>(EMassFragmentPresence::Any);
+    VehicleQuery.AddTagRequirement<FMassTrafficParkedVehicleTag>(EMassFragmentPresence::Any);
+    VehicleQuery.AddRequirement<FTransformFragment>(EMassFragmentAccess::ReadOnly);
+    VehicleQuery.AddRequirement<FAgentRadiusFragment>(EMassFragmentAccess::ReadOnly, EMassFragmentPresence::Optional);
+
+    PedestrianQuery.AddTagRequirement<FMassCrowdTag>(EMassFragmentPresence::All);
+    PedestrianQuery.AddRequirement<FTransformFragment>(EMassFragmentAccess::ReadOnly);
+    PedestrianQuery.AddRequirement<FAgentRadiusFragment>(EMassFragmentAccess::ReadOnly, EMassFragmentPresence::Optional);
+}
+
+void	FMassAnnotationExtractor::Extract(FMassEntityManager &EntityManager, FMinimalViewInfo const &View, FIntPoint ImageSize, FMassAnnotationSettings const &Settings, TArray<FMassAgentAnnotation> &OutAnnotations)
+{
+    using namespace MassAnnotationExtractor;
+
+    SCOPE_CYCLE_COUNTER(STAT_ExtractMassAnnotations);
+
+    OutAnnotations.Reset();
+    if (ImageSize.X <= 0 || ImageSize.Y <= 0)
+    {
+        return;
+    }
+
+    // Project for the captured image, whatever the camera's own aspect ratio
+    FMinimalViewInfo ImageView = View;
+    ImageView.AspectRatio = static_cast<float>(ImageSize.X) / ImageSize.Y;
+    FMatrix ViewMatrix;
+    FMatrix ProjectionMatrix;
+    FMatrix ViewProjectionMatrix;
+    UGameplayStatics::GetViewProjectionMatrix(ImageView, ViewMatrix, ProjectionMatrix, ViewProjectionMatrix);
+
+    TArray<FChunk> Chunks;
+    GatherChunks(VehicleQuery, EntityManager, /*bIsVehicle*/true, Chunks);
+    GatherChunks(PedestrianQuery, EntityManager, /*bIsVehicle*/false, Chunks);
+
+    double const MaxDistanceSquared = Settings.MaxDistance > 0.f ? FMath::Square(Settings.MaxDistance) : TNumericLimits<double>::Max();
+    double const LyingPedestrianMaxUpZ = FMath::Cos(FMath::DegreesToRadians(Settings.LyingPedestrianMinTilt));
+
+    // Each chunk fills its own annotations, which are then appended in chunk order so the results don't depend on threading
+    TArray<TArray<FMassAgentAnnotation>> ChunkAnnotations;
+    ChunkAnnotations.SetNum(Chunks.Num());
+    ParallelFor(Chunks.Num(), [&](int32 ChunkIndex)
+    {
+        FChunk const &Chunk = Chunks[ChunkIndex];
+        TArray<FMassAgentAnnotation> &Annotations = ChunkAnnotations[ChunkIndex];
+
+        float const Height = Chunk.bIsVehicle ? Settings.VehicleHeight : Settings.PedestrianHeight;
+        float const DefaultRadius = Chunk.bIsVehicle ? Settings.DefaultVehicleRadius : Settings.DefaultPedestrianRadius;
+
+        for (int32 EntityIndex = 0; EntityIndex < Chunk.Entities.Num(); ++EntityIndex)
+        {
+            FTransform const &Transform = Chunk.TransformFragments[EntityIndex].GetTransform();
+            double const DistanceSquared = FVector::DistSquared(Transform.GetLocation(), View.Location);
+            if (DistanceSquared > MaxDistanceSquared)
+            {
+                continue;
+            }
+
+            float const Radius = Chunk.RadiusFragments.Num() > 0 ? Chunk.RadiusFragments[EntityIndex].Radius : DefaultRadius;
+            FBox const LocalBox(FVector(-Radius, -Radius, 0.f), FVector(Radius, Radius, Height));
+
+            FVector2D ScreenMin;
+            FVector2D ScreenMax;
+            if (!ProjectBox(Transform, LocalBox, ViewProjectionMatrix, ImageSize, ScreenMin, ScreenMax))
+            {
+                continue;
+            }
+
+            FMassAgentAnnotation &Annotation = Annotations.AddDefaulted_GetRef();
+            Annotation.EntityIndex = Chunk.Entities[EntityIndex].Index;
+            Annotation.ScreenMin = ScreenMin;
+            Annotation.ScreenMax = ScreenMax;
+            Annotation.Distance = FMath::Sqrt(DistanceSquared);
+            if (Chunk.bIsVehicle)
+            {
+                Annotation.Type = EMassAgentAnnotationType::Vehicle;
+            }
+            else
+            {
+                bool const bIsLying = Transform.GetUnitAxis(EAxis::Z).Z < LyingPedestrianMaxUpZ;
+                Annotation.Type = bIsLying ? EMassAgentAnnotationType::LyingPedestrian : EMassAgentAnnotationType::Pedestrian;
+            }
+        }
+    });
+
+    for (TArray<FMassAgentAnnotation> const &Annotations : ChunkAnnotations)
+    {
+        OutAnnotations.Append(Annotations);
+    }
+}
+
+void	FMassAnnotationExtractor::FillMetaDatas(TArray<FMassAgentAnnotation> const &Annotations, FMassAnnotationSettings const &Settings, FMetaDatasStruct &MetaDatas)
+{
+    MetaDatas.VehiclesNb = 0;
+    MetaDatas.Peds.Reset();
+    MetaDatas.LyingPeds.Reset();
+
+    FString const PedestrianRGB = FString::Printf(TEXT("%d,%d,%d"), Settings.PedestrianColor.R, Settings.PedestrianColor.G, Settings.PedestrianColor.B);
+
+    for (FMassAgentAnnotation const &Annotation : Annotations)
+    {
+        if (Annotation.Type == EMassAgentAnnotationType::Vehicle)
+        {
+            ++MetaDatas.VehiclesNb;
+            continue;
+        }
+
+        TMap<int, FString> &Peds = Annotation.Type == EMassAgentAnnotationType::LyingPedestrian ? MetaDatas.LyingPeds : MetaDatas.Peds;
+        Peds.Add(Annotation.EntityIndex, PedestrianRGB);
+    }
+}
+
+void	UMassAnnotationLibrary::ExtractMassAnnotations(UObject const *WorldContextObject, FMinimalViewInfo const &View, FIntPoint ImageSize, FMassAnnotationSettings const &Settings, TArray<FMassAgentAnnotation> &Annotations, FMetaDatasStruct &MetaDatas)
+{
+    Annotations.Reset();
+
+    UWorld *World = GEngine->GetWorldFromContextObject(WorldContextObject, EGetWorldErrorMode::LogAndReturnNull);
+    UMassEntitySubsystem *EntitySubsystem = World ? World->GetSubsystem<UMassEntitySubsystem>() : nullptr;
+    if (EntitySubsystem == nullptr)
+    {
+        return;
+    }
+
+    // A new extractor per call, as its queries cache archetype handles that are only valid for one entity manager
+    FMassAnnotationExtractor Extractor;
+    Extractor.Extract(EntitySubsystem->GetMutableEntityManager(), View, ImageSize, Settings, Annotations);
+    FMassAnnotationExtractor::FillMetaDatas(Annotations, Settings, MetaDatas);
+}
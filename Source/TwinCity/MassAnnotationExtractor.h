@@ -0,0 +1,122 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Camera/CameraTypes.h"
+#include "Kismet/BlueprintFunctionLibrary.h"
+#include "MassEntityQuery.h"
+#include "MyBlueprintFunctionLibrary.h"
+#include "MassAnnotationExtractor.generated.h"
+
+struct FMassEntityManager;
+
+UENUM(BlueprintType)
+enum class EMassAgentAnnotationType : uint8
+{
+	Vehicle,
+	Pedestrian,
+	LyingPedestrian
+};
+
+/** A Mass agent in view of the capture camera. */
+USTRUCT(BlueprintType)
+struct FMassAgentAnnotation
+{
+	GENERATED_USTRUCT_BODY()
+
+	public:
+
+		UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Annotation")
+		int	EntityIndex = INDEX_NONE;
+
+		UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Annotation")
+		EMassAgentAnnotationType	Type = EMassAgentAnnotationType::Vehicle;
+
+		// Agent's projected bounds, in pixels from the top left of the image, clamped to the image
+		UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Annotation")
+		FVector2D	ScreenMin = { 0.f, 0.f };
+
+		UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Annotation")
+		FVector2D	ScreenMax = { 0.f, 0.f };
+
+		// From the camera to the agent's location
+		UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Annotation")
+		float	Distance = 0.f;
+};
+
+USTRUCT(BlueprintType)
+struct FMassAnnotationSettings
+{
+	GENERATED_USTRUCT_BODY()
+
+	public:
+
+		// Agents are annotated with a box this high, and as wide and long as their radius (or the default radius if they don't have one)
+		UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Annotation")
+		float	VehicleHeight = 150.f;
+
+		UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Annotation")
+		float	DefaultVehicleRadius = 200.f;
+
+		UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Annotation")
+		float	PedestrianHeight = 180.f;
+
+		UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Annotation")
+		float	DefaultPedestrianRadius = 40.f;
+
+		// Pedestrians tilted further than this from upright, in degrees, are lying down
+		UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Annotation")
+		float	LyingPedestrianMinTilt = 60.f;
+
+		// Agents further than this from the camera aren't annotated, 0 for no limit
+		UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Annotation")
+		float	MaxDistance = 0.f;
+
+		// Pedestrians' colour in the semantic capture, written as their RGB in the metadatas' Peds & LyingPeds
+		UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Annotation")
+		FColor	PedestrianColor = FColor(220, 20, 60);
+};
+
+/**
+ * Finds the traffic vehicles & crowd pedestrians in view of a capture camera, straight from their Mass fragments, so
+ * agents represented by instanced static meshes or not represented at all are annotated as well as actors.
+ *
+ * Fragment views are gathered per chunk on the calling thread, then chunks are projected in parallel. Agents are
+ * projected as boxes around their transform - occlusion isn't taken into account. Must be called outside of Mass
+ * processing, e.g. from the game thread when a frame is captured.
+ */
+class TWINCITY_API FMassAnnotationExtractor
+{
+public:
+
+	FMassAnnotationExtractor();
+
+	void	Extract(FMassEntityManager &EntityManager, FMinimalViewInfo const &View, FIntPoint ImageSize, FMassAnnotationSettings const &Settings, TArray<FMassAgentAnnotation> &OutAnnotations);
+
+	/**
+	 * Sets VehiclesNb, Peds & LyingPeds from Annotations. Peds & LyingPeds are keyed by entity index, with the
+	 * pedestrian's RGB as "R,G,B". Screen bounds are only in Annotations, so the metadatas keep their layout.
+	 */
+	static void	FillMetaDatas(TArray<FMassAgentAnnotation> const &Annotations, FMassAnnotationSettings const &Settings, FMetaDatasStruct &MetaDatas);
+
+private:
+
+	FMassEntityQuery	VehicleQuery;
+	FMassEntityQuery	PedestrianQuery;
+};
+
+UCLASS()
+class TWINCITY_API UMassAnnotationLibrary : public UBlueprintFunctionLibrary
+{
+	GENERATED_BODY()
+
+	public:
+
+		/**
+		 * Fills MetaDatas' VehiclesNb, Peds & LyingPeds with the Mass agents in View, as captured at ImageSize, and
+		 * returns every agent's screen bounds in Annotations. @see FMassAnnotationExtractor
+		 */
+		UFUNCTION(BlueprintCallable, Category="MetaDatas", meta=(WorldContext="WorldContextObject"))
+		static void	ExtractMassAnnotations(UObject const *WorldContextObject, FMinimalViewInfo const &View, FIntPoint ImageSize, FMassAnnotationSettings const &Settings, TArray<FMassAgentAnnotation> &Annotations, UPARAM(ref) FMetaDatasStruct &MetaDatas);
+};
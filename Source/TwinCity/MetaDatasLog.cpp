@@ -0,0 +1,277 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "MetaDatasLog.h"
+#include "HAL/FileManager.h"
+#include "HAL/PlatformFileManager.h"
+#include "Misc/FileHelper.h"
+#include "Serialization/MemoryReader.h"
+
+DEFINE_LOG_CATEGORY(LogMetaDatasLog);
+
+namespace MetaDatasLog
+{
+    static constexpr uint32 LogMagic = 0x4C4D4354;    // 'TCML'
+    static constexpr uint32 IndexMagic = 0x494D4354;  // 'TCMI'
+
+    /** Bump whenever the frame layout in SerializeFrame changes. */
+    static constexpr uint32 Version = 3;
+
+    static constexpr int64 HeaderSize = sizeof(uint32) * 2;
+
+    static FString GetIndexPath(FString const &LogPath)
+    {
+        return LogPath + TEXT(".idx");
+    }
+
+    static void SerializeHeader(FArchive &Ar, uint32 Magic)
+    {
+        uint32 FileVersion = Version;
+        Ar << Magic;
+        Ar << FileVersion;
+    }
+
+    static bool ReadHeader(FArchive &Ar, uint32 ExpectedMagic)
+    {
+        uint32 Magic = 0;
+        uint32 FileVersion = 0;
+        Ar << Magic;
+        Ar << FileVersion;
+        return !Ar.IsError() && Magic == ExpectedMagic && FileVersion == Version;
+    }
+
+    static void SerializeFrame(FArchive &Ar, FString &FilePath, FMetaDatasStruct &MetaDatas)
+    {
+        Ar << FilePath;
+        Ar << MetaDatas.District;
+        Ar << MetaDatas.Hour;
+        Ar << MetaDatas.Day;
+        Ar << MetaDatas.Month;
+        Ar << MetaDatas.Year;
+        Ar << MetaDatas.Weather;
+        Ar << MetaDatas.CameraRotation;
+        Ar << MetaDatas.CameraLocation;
+        Ar << MetaDatas.VehiclesNb;
+        Ar << MetaDatas.Peds;
+        Ar << MetaDatas.LyingPeds;
+    }
+
+    /**
+     * Reads the frame offsets from an index, dropping a partially written last entry.
+     * @return false if the index doesn't exist or isn't a capture log index.
+     */
+    static bool ReadIndex(FString const &IndexPath, TArray64<int64> &OutFrameOffsets)
+    {
+        OutFrameOffsets.Reset();
+
+        TArray64<uint8> IndexData;
+        if (!FFileHelper::LoadFileToArray(IndexData, *IndexPath, FILEREAD_Silent))
+        {
+            return false;
+        }
+
+        FMemoryReader64 IndexReader(IndexData);
+        if (!ReadHeader(IndexReader, IndexMagic))
+        {
+            return false;
+        }
+
+        OutFrameOffsets.SetNumUninitialized((IndexData.Num() - HeaderSize) / sizeof(int64));
+        IndexReader.Serialize(OutFrameOffsets.GetData(), OutFrameOffsets.Num() * sizeof(int64));
+        return !IndexReader.IsError();
+    }
+
+    /**
+     * Finds how many of FrameOffsets' frames are complete in the log, e.g: after a crash left either file part
+     * written. Only the last frames can be incomplete, as both files are only ever appended to.
+     * @return The number of complete frames, with the log size they take up in OutLogSize.
+     */
+    static int64 FindNumCompleteFrames(FArchive &LogReader, TConstArrayView64<int64> FrameOffsets, int64 &OutLogSize)
+    {
+        const int64 LogSize = LogReader.TotalSize();
+        for (int64 NumFrames = FrameOffsets.Num(); NumFrames > 0; --NumFrames)
+        {
+            const int64 Offset = FrameOffsets[NumFrames - 1];
+            const int64 PreviousEnd = NumFrames > 1 ? FrameOffsets[NumFrames - 2] : HeaderSize;
+            if (Offset < PreviousEnd || Offset >= LogSize)
+            {
+                continue;
+            }
+
+            FString FilePath;
+            FMetaDatasStruct MetaDatas;
+            LogReader.Seek(Offset);
+            SerializeFrame(LogReader, FilePath, MetaDatas);
+            if (!LogReader.IsError() && LogReader.Tell() <= LogSize)
+            {
+                OutLogSize = LogReader.Tell();
+                return NumFrames;
+            }
+
+            LogReader.ClearError();
+        }
+
+        OutLogSize = HeaderSize;
+        return 0;
+    }
+
+    static bool TruncateFile(FString const &Path, int64 Size)
+    {
+        TUniquePtr<IFileHandle> FileHandle(FPlatformFileManager::Get().GetPlatformFile().OpenWrite(*Path, /*bAppend*/true, /*bAllowRead*/true));
+        return FileHandle.IsValid() && FileHandle->Truncate(Size);
+    }
+
+    /**
+     * Truncates an existing log & its index to their complete frames, so appending carries on from a consistent state.
+     * @return Number of frames in the log, or INDEX_NONE if there isn't a valid log & index to append to.
+     */
+    static int64 GetNumExistingFrames(FString const &LogPath)
+    {
+        IFileManager &FileManager = IFileManager::Get();
+
+        TArray64<int64> FrameOffsets;
+        if (!ReadIndex(GetIndexPath(LogPath), FrameOffsets))
+        {
+            return INDEX_NONE;
+        }
+
+        int64 NumFrames = 0;
+        int64 LogSize = 0;
+        {
+            TUniquePtr<FArchive> LogReader(FileManager.CreateFileReader(*LogPath, FILEREAD_Silent));
+            if (!LogReader.IsValid() || !ReadHeader(*LogReader, LogMagic))
+            {
+                return INDEX_NONE;
+            }
+
+            NumFrames = FindNumCompleteFrames(*LogReader, FrameOffsets, LogSize);
+        }
+
+        const int64 IndexSize = HeaderSize + NumFrames * sizeof(int64);
+        if (NumFrames != FrameOffsets.Num() || LogSize != FileManager.FileSize(*LogPath) || IndexSize != FileManager.FileSize(*GetIndexPath(LogPath)))
+        {
+            UE_LOG(LogMetaDatasLog, Warning, TEXT("Capture log %s has %lld of %lld frames complete, truncating it to them"), *LogPath, NumFrames, FrameOffsets.Num());
+            if (!TruncateFile(LogPath, LogSize) || !TruncateFile(GetIndexPath(LogPath), IndexSize))
+            {
+                UE_LOG(LogMetaDatasLog, Error, TEXT("Couldn't truncate capture log %s"), *LogPath);
+                return INDEX_NONE;
+            }
+        }
+
+        return NumFrames;
+    }
+}
+
+FMetaDatasLogWriter::~FMetaDatasLogWriter()
+{
+    Close();
+}
+
+bool	FMetaDatasLogWriter::Open(FString const &InLogPath)
+{
+    Close();
+
+    IFileManager &FileManager = IFileManager::Get();
+    const int64 NumExistingFrames = MetaDatasLog::GetNumExistingFrames(InLogPath);
+    const uint32 WriteFlags = NumExistingFrames != INDEX_NONE ? FILEWRITE_Append : FILEWRITE_None;
+
+    LogArchive.Reset(FileManager.CreateFileWriter(*InLogPath, WriteFlags));
+    IndexArchive.Reset(FileManager.CreateFileWriter(*MetaDatasLog::GetIndexPath(InLogPath), WriteFlags));
+    if (!LogArchive.IsValid() || !IndexArchive.IsValid())
+    {
+        UE_LOG(LogMetaDatasLog, Warning, TEXT("Couldn't open capture log %s for writing"), *InLogPath);
+        LogArchive.Reset();
+        IndexArchive.Reset();
+        return false;
+    }
+
+    LogPath = InLogPath;
+    if (NumExistingFrames != INDEX_NONE)
+    {
+        NumFrames = NumExistingFrames;
+        UE_LOG(LogMetaDatasLog, Log, TEXT("Appending to capture log %s after %lld frames"), *LogPath, NumFrames);
+    }
+    else
+    {
+        NumFrames = 0;
+        MetaDatasLog::SerializeHeader(*LogArchive, MetaDatasLog::LogMagic);
+        MetaDatasLog::SerializeHeader(*IndexArchive, MetaDatasLog::IndexMagic);
+    }
+
+    return true;
+}
+
+void	FMetaDatasLogWriter::Close()
+{
+    // Index last, so it never refers to frames that aren't in the log
+    LogArchive.Reset();
+    IndexArchive.Reset();
+    LogPath.Reset();
+    NumFrames = 0;
+}
+
+int64	FMetaDatasLogWriter::Append(FString const &FilePath, FMetaDatasStruct const &MetaDatas)
+{
+    check(IsOpen());
+
+    int64 Offset = LogArchive->Tell();
+
+    // Only saving, so neither is modified
+    MetaDatasLog::SerializeFrame(*LogArchive, const_cast<FString &>(FilePath), const_cast<FMetaDatasStruct &>(MetaDatas));
+    *IndexArchive << Offset;
+
+    return NumFrames++;
+}
+
+void	FMetaDatasLogWriter::Flush()
+{
+    if (IsOpen())
+    {
+        LogArchive->Flush();
+        IndexArchive->Flush();
+    }
+}
+
+bool	FMetaDatasLogReader::Open(FString const &LogPath)
+{
+    LogArchive.Reset();
+    FrameOffsets.Reset();
+
+    if (!MetaDatasLog::ReadIndex(MetaDatasLog::GetIndexPath(LogPath), FrameOffsets))
+    {
+        UE_LOG(LogMetaDatasLog, Error, TEXT("%s is missing, isn't a capture log index, or is from another version"), *MetaDatasLog::GetIndexPath(LogPath));
+        return false;
+    }
+
+    LogArchive.Reset(IFileManager::Get().CreateFileReader(*LogPath));
+    if (!LogArchive.IsValid() || !MetaDatasLog::ReadHeader(*LogArchive, MetaDatasLog::LogMagic))
+    {
+        UE_LOG(LogMetaDatasLog, Error, TEXT("%s isn't a capture log, or is from another version"), *LogPath);
+        LogArchive.Reset();
+        FrameOffsets.Reset();
+        return false;
+    }
+
+    // Only read the frames that were completely written, e.g: if the capture crashed
+    int64 LogSize = 0;
+    const int64 NumFrames = MetaDatasLog::FindNumCompleteFrames(*LogArchive, FrameOffsets, LogSize);
+    if (NumFrames != FrameOffsets.Num() || LogSize != LogArchive->TotalSize())
+    {
+        UE_LOG(LogMetaDatasLog, Warning, TEXT("Capture log %s has %lld of %lld frames complete, only reading those"), *LogPath, NumFrames, FrameOffsets.Num());
+        FrameOffsets.SetNum(NumFrames);
+    }
+
+    return true;
+}
+
+bool	FMetaDatasLogReader::ReadFrame(int64 FrameNumber, FString &OutFilePath, FMetaDatasStruct &OutMetaDatas)
+{
+    if (!LogArchive.IsValid() || !FrameOffsets.IsValidIndex(FrameNumber))
+    {
+        return false;
+    }
+
+    LogArchive->Seek(FrameOffsets[FrameNumber]);
+    MetaDatasLog::SerializeFrame(*LogArchive, OutFilePath, OutMetaDatas);
+
+    return !LogArchive->IsError();
+}
@@ -0,0 +1,66 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "MyBlueprintFunctionLibrary.h"
+
+TWINCITY_API DECLARE_LOG_CATEGORY_EXTERN(LogMetaDatasLog, Log, All);
+
+/**
+ * Capture log - every captured frame's FMetaDatasStruct appended to a single binary file, instead of one json file per
+ * frame. Enabled by setting TwinCity.MetaDatas.CaptureLog to the log's path.
+ *
+ * The log file holds the frames back to back, each with the json file path it would otherwise have been written to.
+ * A sidecar index file (the log path + ".idx") holds every frame's offset into the log, so frames can be read back by
+ * their number, which is the order they were captured in. Both files are appended to when reopened, so a capture can
+ * be resumed, after truncating them to their complete frames if a capture was interrupted mid-frame.
+ * UMetaDatasLogExportCommandlet converts a log back to per-frame json files.
+ */
+
+/** Appends frames to a capture log. Not thread safe, FMetaDatasWriter only uses it from one thread at a time. */
+class TWINCITY_API FMetaDatasLogWriter
+{
+public:
+
+	~FMetaDatasLogWriter();
+
+	/** Opens the log at LogPath for appending, creating it if needed. */
+	bool	Open(FString const &LogPath);
+	void	Close();
+	bool	IsOpen() const { return LogArchive.IsValid(); }
+
+	FString const	&GetLogPath() const { return LogPath; }
+
+	/** Appends a frame that would have been written to FilePath. @return The frame's number. */
+	int64	Append(FString const &FilePath, FMetaDatasStruct const &MetaDatas);
+
+	/** Flushes appended frames to disk. */
+	void	Flush();
+
+private:
+
+	FString					LogPath;
+	TUniquePtr<FArchive>	LogArchive;
+	TUniquePtr<FArchive>	IndexArchive;
+	int64					NumFrames = 0;
+};
+
+/** Reads frames back from a capture log, in any order. */
+class TWINCITY_API FMetaDatasLogReader
+{
+public:
+
+	/** Opens the log at LogPath & loads its index, skipping any incomplete frames at its end. */
+	bool	Open(FString const &LogPath);
+
+	int64	GetNumFrames() const { return FrameOffsets.Num(); }
+
+	/** Reads frame FrameNumber, and the json file path it was captured for. */
+	bool	ReadFrame(int64 FrameNumber, FString &OutFilePath, FMetaDatasStruct &OutMetaDatas);
+
+private:
+
+	TUniquePtr<FArchive>	LogArchive;
+	TArray64<int64>			FrameOffsets;
+};
@@ -0,0 +1,72 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "MetaDatasLogExportCommandlet.h"
+#include "JsonObjectConverter.h"
+#include "MetaDatasLog.h"
+#include "Misc/Paths.h"
+
+UMetaDatasLogExportCommandlet::UMetaDatasLogExportCommandlet()
+{
+    IsClient = false;
+    IsEditor = false;
+    IsServer = false;
+    LogToConsole = true;
+}
+
+int32	UMetaDatasLogExportCommandlet::Main(FString const &Params)
+{
+    FString LogPath;
+    if (!FParse::Value(*Params, TEXT("Log="), LogPath))
+    {
+        UE_LOG(LogMetaDatasLog, Error, TEXT("Usage: -run=MetaDatasLogExport -Log=<capture log> [-OutputDir=<dir>] [-First=<frame>] [-Count=<frames>]"));
+        return 1;
+    }
+
+    FString OutputDir;
+    FParse::Value(*Params, TEXT("OutputDir="), OutputDir);
+
+    FMetaDatasLogReader Reader;
+    if (!Reader.Open(LogPath))
+    {
+        return 1;
+    }
+
+    int64 First = 0;
+    int64 Count = Reader.GetNumFrames();
+    FParse::Value(*Params, TEXT("First="), First);
+    FParse::Value(*Params, TEXT("Count="), Count);
+    First = FMath::Clamp<int64>(First, 0, Reader.GetNumFrames());
+    const int64 End = FMath::Clamp<int64>(First + Count, First, Reader.GetNumFrames());
+
+    UE_LOG(LogMetaDatasLog, Display, TEXT("Exporting frames %lld to %lld of %lld from %s"), First, End, Reader.GetNumFrames(), *LogPath);
+
+    int32 NumErrors = 0;
+    for (int64 FrameNumber = First; FrameNumber < End; ++FrameNumber)
+    {
+        FString FilePath;
+        FMetaDatasStruct MetaDatas;
+        if (!Reader.ReadFrame(FrameNumber, FilePath, MetaDatas))
+        {
+            UE_LOG(LogMetaDatasLog, Error, TEXT("Couldn't read frame %lld"), FrameNumber);
+            ++NumErrors;
+            continue;
+        }
+
+        if (!OutputDir.IsEmpty())
+        {
+            FilePath = FPaths::Combine(OutputDir, FPaths::GetCleanFilename(FilePath));
+        }
+
+        // Same conversion as UMyBlueprintFunctionLibrary::WriteStructToJsonFile, so the files are identical
+        TSharedPtr<FJsonObject> JsonObject = FJsonObjectConverter::UStructToJsonObject(MetaDatas);
+        if (JsonObject == nullptr)
+        {
+            ++NumErrors;
+            continue;
+        }
+
+        UMyBlueprintFunctionLibrary::WriteMetaDatasToFile(FilePath, JsonObject);
+    }
+
+    return NumErrors > 0 ? 1 : 0;
+}
@@ -0,0 +1,29 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "MetaDatasLogExportCommandlet.generated.h"
+
+/**
+ * Exports a capture log back to a json file per frame, exactly as they'd have been written without the log.
+ *
+ *	UnrealEditor-Cmd TwinCity.uproject -run=MetaDatasLogExport -Log=<capture log> [-OutputDir=<dir>] [-First=<frame>] [-Count=<frames>]
+ *
+ * Frames are written to the path they were captured for, or under OutputDir with the same file name if it's given.
+ * @see FMetaDatasLogWriter
+ */
+UCLASS()
+class TWINCITY_API UMetaDatasLogExportCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+	public:
+
+		UMetaDatasLogExportCommandlet();
+
+		//~ Begin UCommandlet Interface
+		virtual int32	Main(FString const &Params) override;
+		//~ End UCommandlet Interface
+};
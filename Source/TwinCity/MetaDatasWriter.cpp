@@ -0,0 +1,205 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "MetaDatasWriter.h"
+#include "HAL/Event.h"
+#include "HAL/IConsoleManager.h"
+#include "HAL/PlatformProcess.h"
+#include "HAL/RunnableThread.h"
+#include "JsonObjectConverter.h"
+
+static bool GMetaDatasAsyncWrites = true;
+static FAutoConsoleVariableRef CVarMetaDatasAsyncWrites(
+    TEXT("TwinCity.MetaDatas.AsyncWrites"),
+    GMetaDatasAsyncWrites,
+    TEXT("Write capture metadata files on a background thread rather than the game thread."));
+
+static int32 GMetaDatasMaxPendingWrites = 64;
+static FAutoConsoleVariableRef CVarMetaDatasMaxPendingWrites(
+    TEXT("TwinCity.MetaDatas.MaxPendingWrites"),
+    GMetaDatasMaxPendingWrites,
+    TEXT("Number of capture metadata files that can wait to be written before the game thread blocks on the disk."));
+
+static FString GMetaDatasCaptureLog;
+static FAutoConsoleVariableRef CVarMetaDatasCaptureLog(
+    TEXT("TwinCity.MetaDatas.CaptureLog"),
+    GMetaDatasCaptureLog,
+    TEXT("When set, capture metadata is appended to this single binary capture log rather than written to a json file per frame."));
+
+static TUniquePtr<FMetaDatasWriter> GMetaDatasWriter;
+
+FMetaDatasWriter::FMetaDatasWriter()
+{
+    if (!FPlatformProcess::SupportsMultithreading())
+    {
+        return;
+    }
+
+    WorkEvent = FPlatformProcess::GetSynchEventFromPool(false);
+    WriteDoneEvent = FPlatformProcess::GetSynchEventFromPool(false);
+    Thread = FRunnableThread::Create(this, TEXT("MetaDatasWriter"), 0, TPri_BelowNormal);
+}
+
+FMetaDatasWriter::~FMetaDatasWriter()
+{
+    if (Thread != nullptr)
+    {
+        Flush();
+        Thread->Kill(true);
+        delete Thread;
+        Thread = nullptr;
+    }
+
+    if (WorkEvent != nullptr)
+    {
+        FPlatformProcess::ReturnSynchEventToPool(WorkEvent);
+        WorkEvent = nullptr;
+    }
+
+    if (WriteDoneEvent != nullptr)
+    {
+        FPlatformProcess::ReturnSynchEventToPool(WriteDoneEvent);
+        WriteDoneEvent = nullptr;
+    }
+}
+
+FMetaDatasWriter&	FMetaDatasWriter::Get()
+{
+    if (!GMetaDatasWriter.IsValid())
+    {
+        GMetaDatasWriter = MakeUnique<FMetaDatasWriter>();
+    }
+
+    return *GMetaDatasWriter;
+}
+
+void	FMetaDatasWriter::Shutdown()
+{
+    GMetaDatasWriter.Reset();
+}
+
+void	FMetaDatasWriter::Enqueue(FString const FilePath, FMetaDatasStruct const &MetaDatas)
+{
+    if (Thread == nullptr || !GMetaDatasAsyncWrites)
+    {
+        // Keep the order files are written in, in case some were queued before async writes were turned off
+        Flush();
+        Write({ FilePath, MetaDatas, GMetaDatasCaptureLog });
+        CaptureLog.Flush();
+        return;
+    }
+
+    CriticalSection.Lock();
+
+    // Back-pressure - wait for the writer thread to catch up rather than letting the queue grow without bound
+    while (PendingWrites.Num() + NumWritesInProgress >= FMath::Max(GMetaDatasMaxPendingWrites, 1))
+    {
+        CriticalSection.Unlock();
+        WorkEvent->Trigger();
+        WriteDoneEvent->Wait(10);
+        CriticalSection.Lock();
+    }
+
+    PendingWrites.Add({ FilePath, MetaDatas, GMetaDatasCaptureLog });
+    CriticalSection.Unlock();
+
+    WorkEvent->Trigger();
+}
+
+void	FMetaDatasWriter::Flush()
+{
+    if (Thread == nullptr)
+    {
+        return;
+    }
+
+    for (;;)
+    {
+        {
+            FScopeLock Lock(&CriticalSection);
+            if (PendingWrites.Num() + NumWritesInProgress == 0)
+            {
+                return;
+            }
+        }
+
+        WorkEvent->Trigger();
+        WriteDoneEvent->Wait(10);
+    }
+}
+
+uint32	FMetaDatasWriter::Run()
+{
+    TArray<FPendingWrite> Batch;
+
+    while (!bStopping)
+    {
+        WorkEvent->Wait();
+
+        // Take everything that's pending at once, so the game thread only contends for the lock once per batch
+        {
+            FScopeLock Lock(&CriticalSection);
+            Batch = MoveTemp(PendingWrites);
+            NumWritesInProgress = Batch.Num();
+        }
+
+        for (int32 Index = 0; Index < Batch.Num(); ++Index)
+        {
+            Write(Batch[Index]);
+
+            // Flush the capture log before the last write counts as done, as Flush & synchronous writes use the log
+            // on the game thread as soon as no writes are in progress
+            if (Index == Batch.Num() - 1)
+            {
+                CaptureLog.Flush();
+            }
+
+            {
+                FScopeLock Lock(&CriticalSection);
+                --NumWritesInProgress;
+            }
+            WriteDoneEvent->Trigger();
+        }
+
+        Batch.Reset();
+    }
+
+    return 0;
+}
+
+void	FMetaDatasWriter::Stop()
+{
+    bStopping = true;
+    WorkEvent->Trigger();
+}
+
+void	FMetaDatasWriter::Write(FPendingWrite const &PendingWrite)
+{
+    if (!PendingWrite.CaptureLogPath.IsEmpty() && PendingWrite.CaptureLogPath != FailedCaptureLogPath)
+    {
+        if (CaptureLog.GetLogPath() == PendingWrite.CaptureLogPath || CaptureLog.Open(PendingWrite.CaptureLogPath))
+        {
+            CaptureLog.Append(PendingWrite.FilePath, PendingWrite.MetaDatas);
+            return;
+        }
+
+        // Don't lose the capture - write json files instead, without retrying the log for every frame
+        UE_LOG(LogMetaDatasLog, Warning, TEXT("Couldn't open capture log %s, writing capture metadata to json files instead"), *PendingWrite.CaptureLogPath);
+        FailedCaptureLogPath = PendingWrite.CaptureLogPath;
+    }
+    else if (PendingWrite.CaptureLogPath.IsEmpty())
+    {
+        // Retry the failed log if it's set again later
+        FailedCaptureLogPath.Reset();
+    }
+
+    CaptureLog.Close();
+
+    TSharedPtr<FJsonObject> JsonObject = FJsonObjectConverter::UStructToJsonObject(PendingWrite.MetaDatas);
+
+    if (JsonObject == nullptr)
+    {
+        return;
+    }
+
+    UMyBlueprintFunctionLibrary::WriteMetaDatasToFile(PendingWrite.FilePath, JsonObject);
+}
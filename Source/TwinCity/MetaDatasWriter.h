@@ -0,0 +1,81 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HAL/Runnable.h"
+#include "MetaDatasLog.h"
+#include "MyBlueprintFunctionLibrary.h"
+
+class FEvent;
+class FRunnableThread;
+
+/**
+ * Writes capture metadata files on a background thread, so the game thread doesn't wait on the disk for every
+ * captured frame.
+ *
+ * Writes are done in the order they were enqueued, through the same conversion as
+ * UMyBlueprintFunctionLibrary::WriteMetaDatasToFile, so files are identical to synchronously written ones. At most
+ * TwinCity.MetaDatas.MaxPendingWrites files can be waiting to be written, after which Enqueue blocks until the disk
+ * catches up. Pending writes are flushed when the module shuts down.
+ *
+ * When TwinCity.MetaDatas.CaptureLog is set, frames are appended to that capture log instead of being written to
+ * their own json files. If the log can't be opened, frames are written to json files as if it wasn't set.
+ * @see FMetaDatasLogWriter
+ */
+class TWINCITY_API FMetaDatasWriter : public FRunnable
+{
+public:
+
+	FMetaDatasWriter();
+	virtual ~FMetaDatasWriter() override;
+
+	/** @return The writer used by UMyBlueprintFunctionLibrary, created on first use. */
+	static FMetaDatasWriter&	Get();
+
+	/** Flushes and destroys the writer, if it was ever created. */
+	static void	Shutdown();
+
+	/** Queues MetaDatas to be written to FilePath, blocking if too many writes are already pending. */
+	void	Enqueue(FString const FilePath, FMetaDatasStruct const &MetaDatas);
+
+	/** Blocks until every write enqueued so far is on disk. */
+	void	Flush();
+
+	// FRunnable interface
+	virtual uint32	Run() override;
+	virtual void	Stop() override;
+
+private:
+
+	struct FPendingWrite
+	{
+		FString				FilePath;
+		FMetaDatasStruct	MetaDatas;
+
+		/** TwinCity.MetaDatas.CaptureLog when this was enqueued. */
+		FString				CaptureLogPath;
+	};
+
+	void	Write(FPendingWrite const &PendingWrite);
+
+	/** Only used by whichever thread is writing. */
+	FMetaDatasLogWriter		CaptureLog;
+
+	/** Last capture log that couldn't be opened, so it's not retried every frame. Only used by whichever thread is writing. */
+	FString					FailedCaptureLogPath;
+
+	/** Guards PendingWrites & NumWritesInProgress. */
+	FCriticalSection		CriticalSection;
+	TArray<FPendingWrite>	PendingWrites;
+	int32					NumWritesInProgress = 0;
+
+	/** Wakes the writer thread when there are pending writes, or it's stopping. */
+	FEvent					*WorkEvent = nullptr;
+
+	/** Triggered by the writer thread every time a file is written. */
+	FEvent					*WriteDoneEvent = nullptr;
+
+	FRunnableThread			*Thread = nullptr;
+	TAtomic<bool>			bStopping { false };
+};
@@ -3,17 +3,16 @@
 #include "MyBlueprintFunctionLibrary.h"
 #include "Serialization/JsonSerializer.h"
 #include "JsonObjectConverter.h"
+#include "MetaDatasWriter.h"
 
 void	UMyBlueprintFunctionLibrary::WriteStructToJsonFile(FString const FilePath, FMetaDatasStruct Struct)
 {
-    TSharedPtr<FJsonObject> JsonObject = FJsonObjectConverter::UStructToJsonObject(Struct);
+    FMetaDatasWriter::Get().Enqueue(FilePath, Struct);
+}
 
-    if (JsonObject == nullptr)
-    {
-        return;
-    }
-    
-    WriteMetaDatasToFile(FilePath, JsonObject);
+void	UMyBlueprintFunctionLibrary::FlushMetaDatasFiles()
+{
+    FMetaDatasWriter::Get().Flush();
 }
 
 void	UMyBlueprintFunctionLibrary::WriteMetaDatasToFile(FString const FilePath, TSharedPtr<FJsonObject> JsonObject)
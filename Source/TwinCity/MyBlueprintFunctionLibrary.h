@@ -61,8 +61,13 @@ class TWINCITY_API UMyBlueprintFunctionLibrary : public UBlueprintFunctionLibrar
 
 	public:
 
+		/** Queues Struct to be written to FilePath as json on a background thread. @see FMetaDatasWriter */
 		UFUNCTION(BlueprintCallable, Category="MetaDatas")
 		static void	WriteStructToJsonFile(FString const FilePath, FMetaDatasStruct Struct);
+
+		/** Blocks until every file queued by WriteStructToJsonFile is written, e.g. at the end of a capture. */
+		UFUNCTION(BlueprintCallable, Category="MetaDatas")
+		static void	FlushMetaDatasFiles();
 	
 		static void	WriteMetaDatasToFile(FString const FilePath, TSharedPtr<FJsonObject> JsonObject);
 	
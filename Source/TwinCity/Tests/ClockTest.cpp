@@ -0,0 +1,119 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Misc/AutomationTest.h"
+
+#include "Clock.h"
+#include "Components/SceneComponent.h"
+#include "Engine/Engine.h"
+#include "Engine/World.h"
+
+namespace ClockTest
+{
+	struct FClockFrame
+	{
+		int32	Day = 0;
+		int32	Hour = 0;
+		FVector	SunDirection = FVector::ZeroVector;
+	};
+
+	static constexpr int32 NumFrames = 400;
+	static constexpr double StartHours = 6.0;
+	static constexpr double HoursPerFrame = 0.0625;
+
+	// Spawns a movable actor for a clock to drive as its Sun
+	static AActor *SpawnSun(UWorld *World)
+	{
+		AActor *Sun = World->SpawnActor<AActor>();
+		USceneComponent *SunRoot = NewObject<USceneComponent>(Sun);
+		Sun->SetRootComponent(SunRoot);
+		SunRoot->RegisterComponent();
+		return Sun;
+	}
+
+	// Runs a clock in simulation time for NumFrames frames, with a movable Sun for it to drive, recording the time and the
+	// direction Sun actually ended up facing every frame
+	static TArray<FClockFrame> RunClock(UWorld *World)
+	{
+		AActor *Sun = SpawnSun(World);
+
+		AClock *Clock = World->SpawnActor<AClock>();
+		Clock->Sun = Sun;
+		Clock->IsTimePassing = true;
+		Clock->UseSimulationTime = true;
+		Clock->SimulationHoursPerFrame = HoursPerFrame;
+		Clock->CurrentHours = StartHours;
+		Clock->TmpHours = StartHours;
+
+		TArray<FClockFrame> Frames;
+		for (int32 Frame = 0; Frame < NumFrames; ++Frame)
+		{
+			Clock->Tick(1.f / 60.f);
+			Frames.Add({ static_cast<int32>(Clock->CurrentDays), static_cast<int32>(Clock->CurrentHours), Sun->GetActorForwardVector() });
+		}
+
+		Clock->Destroy();
+		Sun->Destroy();
+		return Frames;
+	}
+
+	// Ticks a clock on the wall clock, returning the rotation of its Sun afterwards, which it should leave to Blueprints
+	static FRotator RunWallClock(UWorld *World, FRotator const &SunRotation)
+	{
+		AActor *Sun = SpawnSun(World);
+		Sun->SetActorRotation(SunRotation);
+
+		AClock *Clock = World->SpawnActor<AClock>();
+		Clock->Sun = Sun;
+		Clock->IsTimePassing = true;
+		for (int32 Frame = 0; Frame < 10; ++Frame)
+		{
+			Clock->Tick(1.f / 60.f);
+		}
+
+		FRotator const Rotation = Sun->GetActorRotation();
+		Clock->Destroy();
+		Sun->Destroy();
+		return Rotation;
+	}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FClockSimulationTimeTest, "TwinCity.Clock.SimulationTime", EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+// A clock in simulation time must advance a fixed step every frame, and turn the sun it drives to the right angle for
+// the time of day - rising level at 6, straight down at noon, setting level at 18 and straight up at midnight
+bool FClockSimulationTimeTest::RunTest(FString const &Parameters)
+{
+	UWorld *World = UWorld::CreateWorld(EWorldType::Game, /*bInformEngineOfWorld*/false);
+	FWorldContext &WorldContext = GEngine->CreateNewWorldContext(EWorldType::Game);
+	WorldContext.SetCurrentWorld(World);
+
+	TArray<ClockTest::FClockFrame> const Frames = ClockTest::RunClock(World);
+	FRotator const WallClockSunRotation(-30.0, 45.0, 0.0);
+	FRotator const WallClockSunRotationAfter = ClockTest::RunWallClock(World, WallClockSunRotation);
+
+	GEngine->DestroyWorldContext(World);
+	World->DestroyWorld(false);
+
+	// Set to StartHours on the first frame, then HoursPerFrame every frame after
+	for (int32 Frame = 1; Frame < ClockTest::NumFrames; ++Frame)
+	{
+		double const Hours = ClockTest::StartHours + Frame * ClockTest::HoursPerFrame;
+		if (Frames[Frame].Day != FMath::FloorToInt(Hours / 24.0) || Frames[Frame].Hour != FMath::FloorToInt(FMath::Fmod(Hours, 24.0)))
+		{
+			AddError(FString::Printf(TEXT("Frame %d is day %d hour %d, expected %.4f hours"), Frame, Frames[Frame].Day, Frames[Frame].Hour, Hours));
+			return false;
+		}
+	}
+
+	double const Tolerance = 1e-3;
+	TestTrue(TEXT("Sun at 9"), Frames[48].SunDirection.Equals(FVector(UE_DOUBLE_HALF_SQRT_2, 0.0, -UE_DOUBLE_HALF_SQRT_2), Tolerance));
+	TestTrue(TEXT("Sun at noon"), Frames[96].SunDirection.Equals(FVector(0.0, 0.0, -1.0), Tolerance));
+	TestTrue(TEXT("Sun at 18"), Frames[192].SunDirection.Equals(FVector(-1.0, 0.0, 0.0), Tolerance));
+	TestTrue(TEXT("Sun at midnight"), Frames[288].SunDirection.Equals(FVector(0.0, 0.0, 1.0), Tolerance));
+	TestTrue(TEXT("Sun at 6 the next day"), Frames[384].SunDirection.Equals(FVector(1.0, 0.0, 0.0), Tolerance));
+	TestEqual(TEXT("Day at 6 the next day"), Frames[384].Day, 1);
+
+	TestTrue(TEXT("Sun left alone on the wall clock"), WallClockSunRotationAfter.Equals(WallClockSunRotation, 1e-3));
+
+	return true;
+}
@@ -0,0 +1,180 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Misc/AutomationTest.h"
+
+#include "MassAnnotationExtractor.h"
+#include "Engine/Engine.h"
+#include "Engine/World.h"
+#include "HAL/PlatformTime.h"
+#include "MassCommonFragments.h"
+#include "MassCrowdFragments.h"
+#include "MassEntityManager.h"
+#include "MassTrafficFragments.h"
+
+namespace MassAnnotationExtractorTest
+{
+	// Camera at the origin looking down +X, with a 90 degree FOV onto a square image, so a point at X = D, Y = Y, Z = Z
+	// projects to pixel (500 + 500 * Y / D, 500 - 500 * Z / D)
+	static constexpr int32 ImageSize = 1000;
+
+	static FMinimalViewInfo MakeView()
+	{
+		FMinimalViewInfo View;
+		View.Location = FVector::ZeroVector;
+		View.Rotation = FRotator::ZeroRotator;
+		View.FOV = 90.f;
+		return View;
+	}
+
+	struct FTestWorld
+	{
+		UWorld								*World = nullptr;
+		TSharedPtr<FMassEntityManager>		EntityManager;
+		FMassArchetypeHandle				VehicleArchetype;
+		FMassArchetypeHandle				PedestrianArchetype;
+
+		FTestWorld()
+		{
+			World = UWorld::CreateWorld(EWorldType::Game, /*bInformEngineOfWorld*/false);
+			FWorldContext &WorldContext = GEngine->CreateNewWorldContext(EWorldType::Game);
+			WorldContext.SetCurrentWorld(World);
+
+			EntityManager = MakeShareable(new FMassEntityManager(World));
+			EntityManager->Initialize();
+			VehicleArchetype = EntityManager->CreateArchetype({ FTransformFragment::StaticStruct(), FAgentRadiusFragment::StaticStruct(), FMassTrafficVehicleTag::StaticStruct() });
+			PedestrianArchetype = EntityManager->CreateArchetype({ FTransformFragment::StaticStruct(), FAgentRadiusFragment::StaticStruct(), FMassCrowdTag::StaticStruct() });
+		}
+
+		~FTestWorld()
+		{
+			EntityManager->Deinitialize();
+			EntityManager.Reset();
+			GEngine->DestroyWorldContext(World);
+			World->DestroyWorld(false);
+		}
+
+		FMassEntityHandle AddAgent(bool bIsVehicle, FTransform const &Transform, float Radius)
+		{
+			FMassEntityHandle const Entity = EntityManager->CreateEntity(bIsVehicle ? VehicleArchetype : PedestrianArchetype);
+			EntityManager->GetFragmentDataChecked<FTransformFragment>(Entity).SetTransform(Transform);
+			EntityManager->GetFragmentDataChecked<FAgentRadiusFragment>(Entity).Radius = Radius;
+			return Entity;
+		}
+	};
+
+	static FMassAgentAnnotation const *FindAnnotation(TArray<FMassAgentAnnotation> const &Annotations, FMassEntityHandle Entity)
+	{
+		return Annotations.FindByPredicate([Entity](FMassAgentAnnotation const &Annotation) { return Annotation.EntityIndex == Entity.Index; });
+	}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FMassAnnotationExtractorTest, "TwinCity.MassAnnotations.Projection", EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+// Extracts annotations for synthetic vehicles & pedestrians around the camera, checking their projected bounds & types,
+// and that agents behind the camera or off screen are left out
+bool FMassAnnotationExtractorTest::RunTest(FString const &Parameters)
+{
+	using namespace MassAnnotationExtractorTest;
+
+	FTestWorld TestWorld;
+	FMassAnnotationSettings Settings;
+	Settings.VehicleHeight = 150.f;
+	Settings.PedestrianHeight = 180.f;
+
+	// Box from X = 900 to 1100, Y = -100 to 100, Z = -75 to 75, so its near face spans 500 +/- 500 * 100 / 900 across
+	// and 500 +/- 500 * 75 / 900 down
+	FMassEntityHandle const Vehicle = TestWorld.AddAgent(/*bIsVehicle*/true, FTransform(FVector(1000.f, 0.f, -75.f)), 100.f);
+	FMassEntityHandle const Pedestrian = TestWorld.AddAgent(/*bIsVehicle*/false, FTransform(FVector(500.f, 250.f, -90.f)), 30.f);
+	FMassEntityHandle const LyingPedestrian = TestWorld.AddAgent(/*bIsVehicle*/false, FTransform(FRotator(90.f, 0.f, 0.f), FVector(800.f, -200.f, -100.f)), 30.f);
+	FMassEntityHandle const BehindCamera = TestWorld.AddAgent(/*bIsVehicle*/false, FTransform(FVector(-500.f, 0.f, 0.f)), 30.f);
+	FMassEntityHandle const OffScreen = TestWorld.AddAgent(/*bIsVehicle*/true, FTransform(FVector(100.f, 5000.f, 0.f)), 100.f);
+
+	FMassAnnotationExtractor Extractor;
+	TArray<FMassAgentAnnotation> Annotations;
+	Extractor.Extract(*TestWorld.EntityManager, MakeView(), FIntPoint(ImageSize), Settings, Annotations);
+
+	TestEqual(TEXT("Number of annotations"), Annotations.Num(), 3);
+	TestNull(TEXT("Agent behind the camera"), FindAnnotation(Annotations, BehindCamera));
+	TestNull(TEXT("Agent off screen"), FindAnnotation(Annotations, OffScreen));
+
+	FMassAgentAnnotation const *VehicleAnnotation = FindAnnotation(Annotations, Vehicle);
+	if (TestNotNull(TEXT("Vehicle annotation"), VehicleAnnotation))
+	{
+		TestEqual(TEXT("Vehicle type"), VehicleAnnotation->Type, EMassAgentAnnotationType::Vehicle);
+		TestEqual(TEXT("Vehicle min X"), VehicleAnnotation->ScreenMin.X, 500.0 - 500.0 * 100.0 / 900.0, 0.01);
+		TestEqual(TEXT("Vehicle max X"), VehicleAnnotation->ScreenMax.X, 500.0 + 500.0 * 100.0 / 900.0, 0.01);
+		TestEqual(TEXT("Vehicle min Y"), VehicleAnnotation->ScreenMin.Y, 500.0 - 500.0 * 75.0 / 900.0, 0.01);
+		TestEqual(TEXT("Vehicle max Y"), VehicleAnnotation->ScreenMax.Y, 500.0 + 500.0 * 75.0 / 900.0, 0.01);
+		TestEqual(TEXT("Vehicle distance"), VehicleAnnotation->Distance, static_cast<float>(FVector(1000.f, 0.f, -75.f).Size()), 0.01f);
+	}
+
+	FMassAgentAnnotation const *PedestrianAnnotation = FindAnnotation(Annotations, Pedestrian);
+	if (TestNotNull(TEXT("Pedestrian annotation"), PedestrianAnnotation))
+	{
+		TestEqual(TEXT("Pedestrian type"), PedestrianAnnotation->Type, EMassAgentAnnotationType::Pedestrian);
+
+		// Box from X = 470 to 530, Y = 220 to 280, Z = -90 to 90 - its left edge is furthest in along the far face
+		TestEqual(TEXT("Pedestrian min X"), PedestrianAnnotation->ScreenMin.X, 500.0 + 500.0 * 220.0 / 530.0, 0.01);
+		TestEqual(TEXT("Pedestrian max X"), PedestrianAnnotation->ScreenMax.X, 500.0 + 500.0 * 280.0 / 470.0, 0.01);
+		TestEqual(TEXT("Pedestrian min Y"), PedestrianAnnotation->ScreenMin.Y, 500.0 - 500.0 * 90.0 / 470.0, 0.01);
+		TestEqual(TEXT("Pedestrian max Y"), PedestrianAnnotation->ScreenMax.Y, 500.0 + 500.0 * 90.0 / 470.0, 0.01);
+	}
+
+	FMassAgentAnnotation const *LyingPedestrianAnnotation = FindAnnotation(Annotations, LyingPedestrian);
+	if (TestNotNull(TEXT("Lying pedestrian annotation"), LyingPedestrianAnnotation))
+	{
+		TestEqual(TEXT("Lying pedestrian type"), LyingPedestrianAnnotation->Type, EMassAgentAnnotationType::LyingPedestrian);
+		TestTrue(TEXT("Lying pedestrian is wider than tall"),
+			LyingPedestrianAnnotation->ScreenMax.X - LyingPedestrianAnnotation->ScreenMin.X > LyingPedestrianAnnotation->ScreenMax.Y - LyingPedestrianAnnotation->ScreenMin.Y);
+	}
+
+	// Peds left over from a previous frame are replaced by the ones in view
+	FMetaDatasStruct MetaDatas;
+	MetaDatas.Peds.Add(BehindCamera.Index, TEXT("0,0,0"));
+	Settings.PedestrianColor = FColor(255, 0, 0);
+	FMassAnnotationExtractor::FillMetaDatas(Annotations, Settings, MetaDatas);
+	TestEqual(TEXT("Number of vehicles"), MetaDatas.VehiclesNb, 1);
+	TestEqual(TEXT("Number of peds"), MetaDatas.Peds.Num(), 1);
+	TestEqual(TEXT("Number of lying peds"), MetaDatas.LyingPeds.Num(), 1);
+	TestEqual(TEXT("Ped keyed by entity index, with its RGB"), MetaDatas.Peds.FindRef(Pedestrian.Index), FString(TEXT("255,0,0")));
+	TestEqual(TEXT("Lying ped keyed by entity index, with its RGB"), MetaDatas.LyingPeds.FindRef(LyingPedestrian.Index), FString(TEXT("255,0,0")));
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FMassAnnotationExtractorBenchmark, "TwinCity.Benchmark.MassAnnotations", EAutomationTestFlags::EditorContext | EAutomationTestFlags::PerfFilter)
+
+// Times extracting annotations for 50k agents scattered around the camera
+bool FMassAnnotationExtractorBenchmark::RunTest(FString const &Parameters)
+{
+	using namespace MassAnnotationExtractorTest;
+
+	static constexpr int32 NumAgents = 50000;
+	static constexpr int32 NumFrames = 20;
+
+	FTestWorld TestWorld;
+	FRandomStream RandomStream(12345);
+	for (int32 AgentIndex = 0; AgentIndex < NumAgents; ++AgentIndex)
+	{
+		FVector const Location(RandomStream.FRandRange(-20000.f, 20000.f), RandomStream.FRandRange(-20000.f, 20000.f), 0.f);
+		TestWorld.AddAgent(/*bIsVehicle*/AgentIndex % 4 == 0, FTransform(FRotator(0.f, RandomStream.FRandRange(0.f, 360.f), 0.f), Location), 50.f);
+	}
+
+	FMassAnnotationExtractor Extractor;
+	FMassAnnotationSettings const Settings;
+	FMinimalViewInfo View = MakeView();
+	View.Location = FVector(0.f, 0.f, 1000.f);
+	View.Rotation = FRotator(-30.f, 0.f, 0.f);
+
+	TArray<FMassAgentAnnotation> Annotations;
+	double const StartTime = FPlatformTime::Seconds();
+	for (int32 Frame = 0; Frame < NumFrames; ++Frame)
+	{
+		Extractor.Extract(*TestWorld.EntityManager, View, FIntPoint(1920, 1080), Settings, Annotations);
+	}
+	double const Milliseconds = (FPlatformTime::Seconds() - StartTime) * 1000.0 / NumFrames;
+
+	AddInfo(FString::Printf(TEXT("%d agents, %d annotated: %.2fms per frame"), NumAgents, Annotations.Num(), Milliseconds));
+
+	return true;
+}
@@ -0,0 +1,124 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Misc/AutomationTest.h"
+
+#include "MetaDatasLogExportCommandlet.h"
+#include "MetaDatasWriter.h"
+#include "HAL/FileManager.h"
+#include "HAL/IConsoleManager.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+
+namespace MetaDatasLogTest
+{
+	static constexpr int32 NumFrames = 20;
+
+	static FMetaDatasStruct MakeFrame(int32 Frame)
+	{
+		FMetaDatasStruct MetaDatas;
+		MetaDatas.District = FString::Printf(TEXT("District %d"), Frame % 3);
+		MetaDatas.Hour = Frame % 24;
+		MetaDatas.Day = 1 + Frame % 28;
+		MetaDatas.Month = 1 + Frame % 12;
+		MetaDatas.Year = 2024;
+		MetaDatas.Weather = Frame % 2 ? TEXT("Rain") : TEXT("Clear");
+		MetaDatas.CameraRotation = FRotator(-10.0 - Frame, Frame * 7.5, 0.0);
+		MetaDatas.CameraLocation = FVector(Frame * 100.25, Frame * -50.5, 1500.0);
+		MetaDatas.VehiclesNb = Frame * 3;
+		for (int32 Ped = 0; Ped < Frame % 5; ++Ped)
+		{
+			MetaDatas.Peds.Add(Frame * 10 + Ped, FString::Printf(TEXT("%d,%d"), Frame * 13 % 1920, Ped * 37 % 1080));
+		}
+		if (Frame % 4 == 0)
+		{
+			MetaDatas.LyingPeds.Add(Frame * 10 + 9, FString::Printf(TEXT("%d,%d"), Frame * 7 % 1920, Frame * 11 % 1080));
+		}
+		return MetaDatas;
+	}
+
+	static FString GetFramePath(FString const &Directory, int32 Frame)
+	{
+		return FPaths::Combine(Directory, FString::Printf(TEXT("Frame_%04d.json"), Frame));
+	}
+
+	// Writes every frame through a FMetaDatasWriter, as captures do, with TwinCity.MetaDatas.CaptureLog set to CaptureLog
+	static void WriteFrames(FString const &Directory, FString const &CaptureLog)
+	{
+		IConsoleVariable *CaptureLogVariable = IConsoleManager::Get().FindConsoleVariable(TEXT("TwinCity.MetaDatas.CaptureLog"));
+		FString const PreviousCaptureLog = CaptureLogVariable->GetString();
+		CaptureLogVariable->Set(*CaptureLog);
+
+		{
+			FMetaDatasWriter Writer;
+			for (int32 Frame = 0; Frame < NumFrames; ++Frame)
+			{
+				Writer.Enqueue(GetFramePath(Directory, Frame), MakeFrame(Frame));
+			}
+			Writer.Flush();
+		}
+
+		CaptureLogVariable->Set(*PreviousCaptureLog);
+	}
+
+	// Checks every frame's file in Directory is byte identical to the one in ExpectedDirectory
+	static bool TestFramesEqual(FAutomationTestBase &Test, FString const &What, FString const &ExpectedDirectory, FString const &Directory)
+	{
+		for (int32 Frame = 0; Frame < NumFrames; ++Frame)
+		{
+			TArray<uint8> Expected;
+			TArray<uint8> Actual;
+			if (!FFileHelper::LoadFileToArray(Expected, *GetFramePath(ExpectedDirectory, Frame)) || !FFileHelper::LoadFileToArray(Actual, *GetFramePath(Directory, Frame)))
+			{
+				Test.AddError(FString::Printf(TEXT("%s - frame %d missing"), *What, Frame));
+				return false;
+			}
+
+			if (Actual != Expected)
+			{
+				Test.AddError(FString::Printf(TEXT("%s - frame %d differs from the json writer's"), *What, Frame));
+				return false;
+			}
+		}
+		return true;
+	}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FMetaDatasLogRoundTripTest, "TwinCity.MetaDatas.CaptureLogRoundTrip", EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+// Writes frames to json files, then to a capture log exported back to json files with MetaDatasLogExport, which must be
+// byte identical. Then sets the capture log to a path that can't be opened, which must fall back to the json files
+bool FMetaDatasLogRoundTripTest::RunTest(FString const &Parameters)
+{
+	using namespace MetaDatasLogTest;
+
+	FString const Directory = FPaths::Combine(FPaths::ProjectSavedDir(), TEXT("Automation"), TEXT("MetaDatasLogTest"));
+	FString const JsonDirectory = FPaths::Combine(Directory, TEXT("Json"));
+	FString const CapturedDirectory = FPaths::Combine(Directory, TEXT("Captured"));
+	FString const ExportedDirectory = FPaths::Combine(Directory, TEXT("Exported"));
+	FString const FallbackDirectory = FPaths::Combine(Directory, TEXT("Fallback"));
+	FString const LogPath = FPaths::Combine(Directory, TEXT("Capture.log"));
+
+	IFileManager &FileManager = IFileManager::Get();
+	FileManager.DeleteDirectory(*Directory, /*RequireExists*/false, /*Tree*/true);
+
+	WriteFrames(JsonDirectory, TEXT(""));
+
+	// Capture log round trip
+	WriteFrames(CapturedDirectory, LogPath);
+	TestFalse(TEXT("Json files written while capturing to the log"), FileManager.FileExists(*GetFramePath(CapturedDirectory, 0)));
+
+	UMetaDatasLogExportCommandlet *Commandlet = NewObject<UMetaDatasLogExportCommandlet>();
+	int32 const ExportResult = Commandlet->Main(FString::Printf(TEXT("-Log=\"%s\" -OutputDir=\"%s\""), *LogPath, *ExportedDirectory));
+	TestEqual(TEXT("Export result"), ExportResult, 0);
+	TestFramesEqual(*this, TEXT("Exported"), JsonDirectory, ExportedDirectory);
+
+	// A directory can't be opened as a capture log
+	AddExpectedError(TEXT("for writing"), EAutomationExpectedErrorFlags::Contains, 1);
+	AddExpectedError(TEXT("writing capture metadata to json files instead"), EAutomationExpectedErrorFlags::Contains, 1);
+	WriteFrames(FallbackDirectory, JsonDirectory);
+	TestFramesEqual(*this, TEXT("Fallback"), JsonDirectory, FallbackDirectory);
+
+	FileManager.DeleteDirectory(*Directory, /*RequireExists*/false, /*Tree*/true);
+
+	return true;
+}
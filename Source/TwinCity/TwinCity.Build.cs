@@ -8,6 +8,8 @@ public class TwinCity : ModuleRules
 	{
 		PCHUsage = PCHUsageMode.UseExplicitOrSharedPCHs;
 
-		PublicDependencyModuleNames.AddRange(new string[] { "Core", "CoreUObject", "Engine", "InputCore", "HeadMountedDisplay", "Json", "JsonUtilities" });
+		PublicDependencyModuleNames.AddRange(new string[] { "Core", "CoreUObject", "Engine", "InputCore", "HeadMountedDisplay", "Json", "JsonUtilities", "MassEntity" });
+
+		PrivateDependencyModuleNames.AddRange(new string[] { "MassCommon", "MassCrowd", "MassTraffic" });
 	}
 }
@@ -1,7 +1,28 @@
 // Copyright Epic Games, Inc. All Rights Reserved.
 
 #include "TwinCity.h"
+#include "MetaDatasWriter.h"
+#include "Misc/CoreDelegates.h"
 #include "Modules/ModuleManager.h"
 
-IMPLEMENT_PRIMARY_GAME_MODULE( FDefaultGameModuleImpl, TwinCity, "TwinCity" );
+class FTwinCityModule : public FDefaultGameModuleImpl
+{
+public:
+	virtual void StartupModule() override
+	{
+		// Make sure every captured frame's metadata makes it to disk, while the engine is still around to convert it
+		EnginePreExitHandle = FCoreDelegates::OnEnginePreExit.AddStatic(&FMetaDatasWriter::Shutdown);
+	}
+
+	virtual void ShutdownModule() override
+	{
+		FCoreDelegates::OnEnginePreExit.Remove(EnginePreExitHandle);
+		FMetaDatasWriter::Shutdown();
+	}
+
+private:
+	FDelegateHandle EnginePreExitHandle;
+};
+
+IMPLEMENT_PRIMARY_GAME_MODULE( FTwinCityModule, TwinCity, "TwinCity" );
  
\ No newline at end of file